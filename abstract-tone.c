@@ -28,65 +28,128 @@
 #include "pcc.h"
 #include "abstract-tone.h"
 #include "wave_utils.h"
+#include "wave-reader.h"
+#include "file-source.h"
+#include "tone-generator.h"
+#include "debug_helpers.h"
+
+/*!
+ * @brief Longest tone name that is kept, including the terminating NULL.
+ */
+#define TONE_NAME_SIZE (260)
+
+/*!
+ * @brief Signal synthesized in place of the sin250Hz.wav resource where there are no resources.
+ * @details TONE_GENERATOR_WAVE_SECONDS of it are a whole number of periods, so the image loops without a click.
+ */
+#define EMBEDDED_TONE_SPEC "sine:250"
+
+/*!
+ * @brief Sampling rate of the sin250Hz.wav resource.
+ */
+#define EMBEDDED_TONE_SAMPLE_RATE (8000)
 
 /*!
  * @brief The container for tone.
  */
 struct abstract_tone {
     tone_type_t e_type_; /*!< Type of the tone */
-    P_MASTER_RIFF_CONST mriff_; /*!< Pointer to the WAV file first bytes */
-    TCHAR name_[MAX_PATH+1]; /*!< Tone name - this is only valid for WAV-like tone */
-    HANDLE hf_; /*!< Tone file handle - this is only valid for WAV-like tone */
-    HANDLE mapping_;  /*!< Tone file mapping  - this is only valid for WAV-like tone */
+    struct wave_reader * p_reader_; /*!< Reader of the tone data: over the file, the resource or the image. */
+    struct wave_reader * p_mapped_; /*!< Reader over the mapped file, opened by abstract_tone_get_wave_data() if p_reader_ does not map the file. */
+    void * p_image_; /*!< WAV image of the synthesized signal - this is only valid for generated and, except on Windows, embedded tones */
+    char name_[TONE_NAME_SIZE]; /*!< Tone name - this is only valid for WAV-like and generated tone */
 };
 
 static void destroy_tone_impl(struct abstract_tone * p_tone)
 {
-    if (EXTERNAL_WAV_TONE == p_tone->e_type_ && p_tone->mriff_)
-        UnmapViewOfFile(p_tone->mriff_);
-    if (NULL != p_tone->mapping_)
-        CloseHandle(p_tone->mapping_);
-    if (INVALID_HANDLE_VALUE != p_tone->hf_)
-        CloseHandle(p_tone->hf_);
+    wave_reader_close(p_tone->p_mapped_);
+    wave_reader_close(p_tone->p_reader_);
+    free(p_tone->p_image_);
 }
 
-struct abstract_tone * abstract_tone_create(tone_type_t eType, LPCTSTR psz_tone_name)
+/*!
+ * @brief Renders TONE_GENERATOR_WAVE_SECONDS of the described signal as an in-memory WAV image.
+ * @param[in] psz_spec description of the signal, see tone_generator_parse().
+ * @param[in] sample_rate sampling rate of the image, or 0 to keep the one of the description.
+ * @param[in] channels number of channels of the image, or 0 to keep the one of the description.
+ * @param[out] p_size this location will be written with the size of the image.
+ * @return returns the image, or NULL if the description is malformed.
+ */
+static void * generate_tone(char const * psz_spec, unsigned int sample_rate, unsigned int channels, size_t * p_size)
 {
-    struct abstract_tone * retval = (struct abstract_tone *)HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(struct abstract_tone));
+    struct tone_generator_config config;
+    struct tone_generator * p_generator;
+    void * p_image = NULL;
+    if (!tone_generator_parse(&config, psz_spec))
+        return NULL;
+    if (0 != sample_rate)
+        config.sample_rate_ = sample_rate;
+    if (0 != channels)
+        config.channels_ = channels;
+    p_generator = tone_generator_create(&config);
+    if (NULL != p_generator)
+    {
+        p_image = tone_generator_render_wave(p_generator, TONE_GENERATOR_WAVE_SECONDS * config.sample_rate_, p_size);
+        tone_generator_destroy(p_generator);
+    }
+    return p_image;
+}
+
+/*!
+ * @brief Opens the reader of the embedded tone.
+ * @details On Windows this is the WAV resource of the given name. Elsewhere the same sine is synthesized.
+ */
+static struct wave_reader * open_embedded_tone(struct abstract_tone * p_tone, char const * psz_tone_name)
+{
+#if defined WIN32
+    P_MASTER_RIFF_CONST p_riff = NULL;
+    if (LoadWavFromResoure(&p_riff, NULL, psz_tone_name))
+        return wave_reader_open_memory(p_riff, p_riff->cksize_ + 8);
+    return NULL;
+#else
+    size_t size;
+    (void)psz_tone_name;
+    p_tone->p_image_ = generate_tone(EMBEDDED_TONE_SPEC, EMBEDDED_TONE_SAMPLE_RATE, 1, &size);
+    return NULL != p_tone->p_image_ ? wave_reader_open_memory(p_tone->p_image_, size) : NULL;
+#endif
+}
+
+struct abstract_tone * abstract_tone_create(tone_type_t eType, char const * psz_tone_name)
+{
+    struct abstract_tone * retval = (struct abstract_tone *)calloc(1, sizeof(struct abstract_tone));
+    size_t size;
     assert(retval);
     if (retval)
     {
-        retval->hf_ = INVALID_HANDLE_VALUE;
         retval->e_type_ = eType;
         switch (eType)
         {
             case EXTERNAL_WAV_TONE :
-                retval->hf_ = CreateFile(psz_tone_name, GENERIC_READ, 0, (LPSECURITY_ATTRIBUTES) NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, (HANDLE) NULL);
-                assert(INVALID_HANDLE_VALUE != retval->hf_);
-                retval->mapping_ = CreateFileMapping(retval->hf_, NULL, PAGE_READONLY, 0, 0, NULL);
-                assert(NULL != retval->mapping_);
-                retval->mriff_ = (P_MASTER_RIFF_CONST)MapViewOfFile(retval->mapping_, FILE_MAP_READ, 0, 0, 0);
-                assert(retval->mriff_);
-                if (retval->mriff_)
-                {
-                    StringCchCopy(retval->name_, MAX_PATH+1, psz_tone_name);
-                    return retval;
-                }
+                /* Read with the strategy that suits its size, only abstract_tone_get_wave_data() needs the file mapped. */
+                retval->p_reader_ = wave_reader_open(psz_tone_name, FILE_SOURCE_AUTO);
                 break;
             case EMBEDDED_TEST_TONE:
-                if (LoadWavFromResoure(&retval->mriff_, NULL, psz_tone_name))
-                    return retval;
-                assert(0);
+                retval->p_reader_ = open_embedded_tone(retval, psz_tone_name);
+                assert(retval->p_reader_);
+                break;
+            case GENERATED_TONE:
+                retval->p_image_ = generate_tone(psz_tone_name, 0, 0, &size);
+                if (NULL != retval->p_image_)
+                    retval->p_reader_ = wave_reader_open_memory(retval->p_image_, size);
                 break;
             default:
                 assert(0);
                 break;
         }
-        if (retval)
+        if (NULL != retval->p_reader_)
         {
-            destroy_tone_impl(retval);
+            if (EMBEDDED_TEST_TONE != eType)
+                snprintf(retval->name_, sizeof(retval->name_), "%s", psz_tone_name);
+            return retval;
         }
-        HeapFree(GetProcessHeap(), 0, retval);
+        debug_log_warning(DEBUG_CATEGORY_AUDIO, "%s %4.4u : cannot create tone %d", __FILE__, __LINE__, eType);
+        destroy_tone_impl(retval);
+        free(retval);
         retval = NULL;
     }
     return retval;
@@ -95,7 +158,7 @@ struct abstract_tone * abstract_tone_create(tone_type_t eType, LPCTSTR psz_tone_
 void abstract_tone_destroy(struct abstract_tone * p_tone)
 {
     destroy_tone_impl(p_tone);
-    HeapFree(GetProcessHeap(), 0, p_tone);
+    free(p_tone);
 }
 
 #if defined DEBUG
@@ -105,40 +168,60 @@ tone_type_t abstract_tone_get_type(struct abstract_tone * p_tone)
 }
 #endif
 
+struct wave_reader_format const * abstract_tone_get_format(struct abstract_tone const * p_tone)
+{
+    return wave_reader_get_format(p_tone->p_reader_);
+}
+
+struct wave_reader * abstract_tone_get_reader(struct abstract_tone * p_tone)
+{
+    return p_tone->p_reader_;
+}
+
 void const * abstract_tone_get_wave_data(struct abstract_tone const * p_tone, size_t * p_data_size)
 {
+    struct wave_reader const * p_reader;
     assert(p_tone);
-    *p_data_size = get_wave_data_size(p_tone->mriff_);
-    return get_wave_data(p_tone->mriff_);
+    p_reader = p_tone->p_reader_;
+    if (NULL == wave_reader_get_data(p_reader) && EXTERNAL_WAV_TONE == p_tone->e_type_)
+    {
+        /* The mapping is a cache, it does not change what the tone is. */
+        struct abstract_tone * p_mutable = (struct abstract_tone *)p_tone;
+        if (NULL == p_mutable->p_mapped_)
+            p_mutable->p_mapped_ = wave_reader_open(p_tone->name_, FILE_SOURCE_MMAP);
+        p_reader = p_mutable->p_mapped_;
+    }
+    if (NULL == p_reader || NULL == wave_reader_get_data(p_reader))
+    {
+        *p_data_size = 0;
+        return NULL;
+    }
+    *p_data_size = (size_t)(wave_reader_get_frames_count(p_reader) * wave_reader_get_format(p_reader)->block_align_);
+    return wave_reader_get_data(p_reader);
 }
 
-size_t abstract_tone_dump(struct abstract_tone const * p_tone, LPTSTR pszBuffer, size_t size)
+size_t abstract_tone_dump(struct abstract_tone const * p_tone, char * pszBuffer, size_t size)
 {
-    HRESULT hr = S_OK;
-    size_t retval = 0;
+    struct wave_reader_format const * p_format = wave_reader_get_format(p_tone->p_reader_);
+    int written = 0;
     switch (p_tone->e_type_)
     {
         case EMBEDDED_TEST_TONE:
             break;
         case EXTERNAL_WAV_TONE :
-            hr = StringCchPrintf(pszBuffer, size, "%s", p_tone->name_);
-            if (SUCCEEDED(hr))
-            {
-                hr = StringCchLength(pszBuffer, size, &retval); 
-            }
-            assert(SUCCEEDED(hr));
-            pszBuffer += retval;
-            *pszBuffer = _T('\n');
-            pszBuffer++;
+        case GENERATED_TONE :
+            written = snprintf(pszBuffer, size, "%s\n", p_tone->name_);
             break;
         default:
             assert(0);
             break;
     }
-    if (SUCCEEDED(hr))
+    if (written >= 0 && (size_t)written < size)
     {
-        //dump_pcmwaveformat(pszBuffer, size, abstract_tone_get_pcmwaveformat(p_tone));
-    } 
-    return retval;
+        int rest = snprintf(pszBuffer + written, size - written, "%u Hz, %u channels, %u bits\n",
+            p_format->sample_rate_, p_format->channels_, p_format->bits_per_sample_);
+        if (rest > 0)
+            written += rest;
+    }
+    return min((size_t)written, size > 0 ? size - 1 : 0);
 }
-
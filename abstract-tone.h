@@ -33,10 +33,10 @@ extern "C" {
 #endif
 
 #include <stddef.h>
-#include <tchar.h>
 
 struct abstract_tone;
-struct PCMWAVEFORMAT; /* defined int <mmsystem.h> and <mmreg.h> from WINDOWS SDK */
+struct wave_reader;
+struct wave_reader_format;
 
 /*! 
  * @brief Type of the tone to be created.
@@ -44,17 +44,23 @@ struct PCMWAVEFORMAT; /* defined int <mmsystem.h> and <mmreg.h> from WINDOWS SDK
 typedef enum eToneType {
     EMBEDDED_TEST_TONE = 0, /*!< Indicates that the tone embedded in the resource shall be created. */
     EXTERNAL_WAV_TONE = 1,  /*!< Indicates that the custom WAV tone shall be created.*/
+    GENERATED_TONE = 2,     /*!< Indicates that the tone shall be synthesized, the name is the signal description given to tone_generator_parse().*/
 } tone_type_t;
 
 /*!
  * @brief Tones factory.
- * @details Creates a tone.
+ * @details Creates a tone. All the tones are read through a wave_reader. The external WAV file is opened with
+ * FILE_SOURCE_AUTO, so only a file below FILE_SOURCE_MMAP_LIMIT is memory mapped, a larger one is streamed and gets
+ * mapped only if abstract_tone_get_wave_data() asks for it. The embedded and the generated tones are WAV images kept
+ * in memory. On Windows the embedded tone is the
+ * resource given by name. Elsewhere there are no resources, so it is the 250 Hz sine that sin250Hz.wav holds,
+ * synthesized by the tone generator, and the name is ignored.
  * @param[in] eType Type of the tone to be created.
- * @param[in] psz_tone_name Tone specific creation data.
- * @return returns a handle to the abstract tone.
+ * @param[in] psz_tone_name Tone specific creation data: resource name, path of the WAV file or signal description.
+ * @return returns a handle to the abstract tone, or NULL if the tone could not be created.
  * @sa abstract_tone_destroy
  */
-struct abstract_tone * abstract_tone_create(tone_type_t eType, LPCTSTR psz_tone_name);
+struct abstract_tone * abstract_tone_create(tone_type_t eType, char const * psz_tone_name);
 
 /*!
  * @brief Destroys a tone.
@@ -80,17 +86,28 @@ tone_type_t abstract_tone_get_type(struct abstract_tone * p_tone);
 #endif
 
 /*!
- * @brief Returns the PCMWAVEFORMAT structure for the tone.
- * @param[in] p_tone tone for which PCMWAVEFORMAT structure is to be retrieved.
- * @return retuns
+ * @brief Returns the format of the tone.
+ * @param[in] p_tone tone for which the format is to be retrieved.
+ * @return returns the format, valid as long as the tone.
  */
-PCMWAVEFORMAT const * abstract_tone_get_pcmwaveformat(struct abstract_tone const * p_tone);
+struct wave_reader_format const * abstract_tone_get_format(struct abstract_tone const * p_tone);
+
+/*!
+ * @brief Returns the reader of the tone.
+ * @details The reader belongs to the tone, it must not be closed. It lets the tone be sent in packets, converted
+ * and sought the same way whatever its type.
+ * @param[in] p_tone handle of the tone.
+ * @return returns the reader, valid as long as the tone.
+ */
+struct wave_reader * abstract_tone_get_reader(struct abstract_tone * p_tone);
 
 /*!
  * @brief Returns the pointer to tone data.
- * @details Const-correct variant of the abstract_tone_get_wave_data routine.
+ * @details Const-correct variant of the abstract_tone_get_wave_data routine. A WAV file too big to have been mapped
+ * when the tone was created, see FILE_SOURCE_MMAP_LIMIT, is mapped on the first call and stays mapped with the tone.
  * @param[in] p_tone handle of the tone, for which data is to be returned.
  * @param[in,out] p_data_size Pointer to the caller allocated memory, which will be written with size of the array returned as function value.
+ * That is the size of the whole frames of the data chunk, or 0 if there is no data.
  * @return Pointer to the first byte of the tone data.
  * @sa abstract_tone_get_wave_data
  */
@@ -98,13 +115,13 @@ const void * abstract_tone_get_wave_data(struct abstract_tone const * p_tone, si
 
 /*!
  * @brief Dumps the tone details into caller's provided buffer.
- * @details <b>Fill me</b>
+ * @details Writes the name of the tone, if it has one, and its format, one per line.
  * @param[in] p_tone handle of the tone, for which data is to be returned.
  * @param[in] pszBuffer caller's allocated buffer into which tone details will be dump.
  * @param[in] size size of the buffer, measured in number of characters, that the caller's buffer can hold, including terminating NULL. 
  * @return returns number of characters written into the buffer.
  */
-size_t abstract_tone_dump(struct abstract_tone const * p_tone, LPTSTR pszBuffer, size_t size);
+size_t abstract_tone_dump(struct abstract_tone const * p_tone, char * pszBuffer, size_t size);
 
 #if defined __cplusplus
 }
@@ -0,0 +1,589 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file audio-codec.c
+ * @brief Audio payload codecs.
+ * @details G.711 follows the reference implementation, IMA ADPCM uses the standard step tables. The 24-bit and dithered conversions use SSE2 where available (SSSE3 for the 24-bit shuffles), with scalar tails.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include "audio-codec.h"
+
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#   define AUDIO_CODEC_SSE2
+#   include <emmintrin.h>
+#   if defined __SSSE3__ || defined __AVX__
+#       define AUDIO_CODEC_SSSE3
+#       include <tmmintrin.h>
+#   endif
+#endif
+
+/*!
+ * @brief Bias added to the magnitude before the mu-law segment is found.
+ */
+#define ULAW_BIAS (0x84)
+
+/*!
+ * @brief Largest magnitude that can be mu-law encoded.
+ */
+#define ULAW_CLIP (32635)
+
+/*!
+ * @brief Upper bounds of the A-law segments, for the 13-bit magnitude.
+ */
+static int16_t const g_alaw_segment_end[8] = {
+    0x1f, 0x3f, 0x7f, 0xff, 0x1ff, 0x3ff, 0x7ff, 0xfff
+};
+
+/*!
+ * @brief IMA ADPCM step index adjustments, indexed with the 4-bit code.
+ */
+static int8_t const g_ima_index_table[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8,
+    -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+/*!
+ * @brief IMA ADPCM quantizer step sizes.
+ */
+static int16_t const g_ima_step_table[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+    19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+    130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+    337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+    876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+    2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+    5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+static uint8_t linear_to_ulaw(int16_t pcm)
+{
+    int32_t sample = pcm;
+    int32_t sign = 0;
+    int32_t exponent = 7;
+    int32_t mask;
+    if (sample < 0)
+    {
+        sign = 0x80;
+        sample = -sample;
+    }
+    if (sample > ULAW_CLIP)
+        sample = ULAW_CLIP;
+    sample += ULAW_BIAS;
+    for (mask = 0x4000; exponent > 0 && !(sample & mask); mask >>= 1)
+        --exponent;
+    return (uint8_t)~(sign | (exponent << 4) | ((sample >> (exponent + 3)) & 0x0f));
+}
+
+static int16_t ulaw_to_linear(uint8_t code)
+{
+    int32_t sample;
+    code = (uint8_t)~code;
+    sample = ((((int32_t)code & 0x0f) << 3) + ULAW_BIAS) << ((code >> 4) & 0x07);
+    sample -= ULAW_BIAS;
+    return (int16_t)((code & 0x80) ? -sample : sample);
+}
+
+static uint8_t linear_to_alaw(int16_t pcm)
+{
+    int32_t sample = pcm >> 3;
+    int32_t mask;
+    int32_t segment;
+    int32_t code;
+    if (sample >= 0)
+        mask = 0xd5;
+    else
+    {
+        mask = 0x55;
+        sample = -sample - 1;
+    }
+    for (segment = 0; segment < 8 && sample > g_alaw_segment_end[segment]; ++segment)
+        ;
+    if (segment >= 8)
+        return (uint8_t)(0x7f ^ mask);
+    code = segment << 4;
+    if (segment < 2)
+        code |= (sample >> 1) & 0x0f;
+    else
+        code |= (sample >> segment) & 0x0f;
+    return (uint8_t)(code ^ mask);
+}
+
+static int16_t alaw_to_linear(uint8_t code)
+{
+    int32_t sample;
+    int32_t segment;
+    code ^= 0x55;
+    sample = (code & 0x0f) << 4;
+    segment = (code & 0x70) >> 4;
+    switch (segment)
+    {
+        case 0:
+            sample += 8;
+            break;
+        case 1:
+            sample += 0x108;
+            break;
+        default:
+            sample += 0x108;
+            sample <<= segment - 1;
+            break;
+    }
+    return (int16_t)((code & 0x80) ? sample : -sample);
+}
+
+static int32_t ima_clamp_index(int32_t index)
+{
+    return index < 0 ? 0 : (index > 88 ? 88 : index);
+}
+
+static int32_t ima_clamp_sample(int32_t sample)
+{
+    return sample < -32768 ? -32768 : (sample > 32767 ? 32767 : sample);
+}
+
+static uint8_t ima_encode_sample(struct audio_codec_state * p_state, int16_t sample)
+{
+    int32_t diff = (int32_t)sample - p_state->predictor_;
+    int32_t step = g_ima_step_table[p_state->index_];
+    int32_t vpdiff = step >> 3;
+    uint8_t code = 0;
+    if (diff < 0)
+    {
+        code = 8;
+        diff = -diff;
+    }
+    if (diff >= step)
+    {
+        code |= 4;
+        diff -= step;
+        vpdiff += step;
+    }
+    step >>= 1;
+    if (diff >= step)
+    {
+        code |= 2;
+        diff -= step;
+        vpdiff += step;
+    }
+    step >>= 1;
+    if (diff >= step)
+    {
+        code |= 1;
+        vpdiff += step;
+    }
+    p_state->predictor_ = ima_clamp_sample(p_state->predictor_ + ((code & 8) ? -vpdiff : vpdiff));
+    p_state->index_ = ima_clamp_index(p_state->index_ + g_ima_index_table[code]);
+    return code;
+}
+
+static int16_t ima_decode_sample(struct audio_codec_state * p_state, uint8_t code)
+{
+    int32_t step = g_ima_step_table[p_state->index_];
+    int32_t vpdiff = step >> 3;
+    if (code & 4)
+        vpdiff += step;
+    if (code & 2)
+        vpdiff += step >> 1;
+    if (code & 1)
+        vpdiff += step >> 2;
+    p_state->predictor_ = ima_clamp_sample(p_state->predictor_ + ((code & 8) ? -vpdiff : vpdiff));
+    p_state->index_ = ima_clamp_index(p_state->index_ + g_ima_index_table[code]);
+    return (int16_t)p_state->predictor_;
+}
+
+static size_t ima_encode(struct audio_codec_state * p_state, int16_t const * p_samples, size_t samples_count, uint8_t * p_output)
+{
+    size_t idx;
+    uint16_t predictor = (uint16_t)(int16_t)p_state->predictor_;
+    p_output[0] = (uint8_t)(predictor & 0xff);
+    p_output[1] = (uint8_t)(predictor >> 8);
+    p_output[2] = (uint8_t)p_state->index_;
+    p_output[3] = 0;
+    p_output += AUDIO_CODEC_IMA_ADPCM_HEADER_SIZE;
+    for (idx = 0; idx + 1 < samples_count; idx += 2)
+    {
+        uint8_t low = ima_encode_sample(p_state, p_samples[idx]);
+        uint8_t high = ima_encode_sample(p_state, p_samples[idx + 1]);
+        *p_output++ = (uint8_t)(low | (high << 4));
+    }
+    if (idx < samples_count)
+        *p_output++ = ima_encode_sample(p_state, p_samples[idx]);
+    return AUDIO_CODEC_IMA_ADPCM_HEADER_SIZE + (samples_count + 1) / 2;
+}
+
+static size_t ima_decode(uint8_t const * p_payload, size_t payload_size, int16_t * p_samples, size_t samples_count)
+{
+    struct audio_codec_state state;
+    size_t idx;
+    size_t written = 0;
+    if (payload_size < AUDIO_CODEC_IMA_ADPCM_HEADER_SIZE || p_payload[2] > 88)
+        return 0;
+    state.predictor_ = (int16_t)(uint16_t)(p_payload[0] | (p_payload[1] << 8));
+    state.index_ = p_payload[2];
+    for (idx = AUDIO_CODEC_IMA_ADPCM_HEADER_SIZE; idx < payload_size && written < samples_count; ++idx)
+    {
+        p_samples[written++] = ima_decode_sample(&state, p_payload[idx] & 0x0f);
+        /* For an odd count, the high nibble of the last byte is padding. */
+        if (written < samples_count)
+            p_samples[written++] = ima_decode_sample(&state, p_payload[idx] >> 4);
+    }
+    return written;
+}
+
+char const * audio_codec_get_name(unsigned int codec)
+{
+    switch (codec)
+    {
+        case AUDIO_CODEC_PCM16:
+            return "pcm";
+        case AUDIO_CODEC_ULAW:
+            return "ulaw";
+        case AUDIO_CODEC_ALAW:
+            return "alaw";
+        case AUDIO_CODEC_IMA_ADPCM:
+            return "adpcm";
+        default:
+            return NULL;
+    }
+}
+
+int audio_codec_from_name(char const * psz_name, unsigned int * p_codec)
+{
+    unsigned int codec;
+    for (codec = AUDIO_CODEC_PCM16; codec <= AUDIO_CODEC_IMA_ADPCM; ++codec)
+    {
+        if (0 == strcmp(psz_name, audio_codec_get_name(codec)))
+        {
+            *p_codec = codec;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+size_t audio_codec_get_encoded_size(unsigned int codec, size_t samples_count)
+{
+    switch (codec)
+    {
+        case AUDIO_CODEC_PCM16:
+            return samples_count * sizeof(int16_t);
+        case AUDIO_CODEC_ULAW:
+        case AUDIO_CODEC_ALAW:
+            return samples_count;
+        case AUDIO_CODEC_IMA_ADPCM:
+            return AUDIO_CODEC_IMA_ADPCM_HEADER_SIZE + (samples_count + 1) / 2;
+        default:
+            return 0;
+    }
+}
+
+size_t audio_codec_encode(unsigned int codec, struct audio_codec_state * p_state, int16_t const * p_samples, size_t samples_count, uint8_t * p_output, size_t output_size)
+{
+    size_t idx;
+    size_t needed = audio_codec_get_encoded_size(codec, samples_count);
+    if (0 == needed || needed > output_size)
+        return 0;
+    switch (codec)
+    {
+        case AUDIO_CODEC_PCM16:
+            CopyMemory(p_output, p_samples, needed);
+            return needed;
+        case AUDIO_CODEC_ULAW:
+            for (idx = 0; idx < samples_count; ++idx)
+                p_output[idx] = linear_to_ulaw(p_samples[idx]);
+            return needed;
+        case AUDIO_CODEC_ALAW:
+            for (idx = 0; idx < samples_count; ++idx)
+                p_output[idx] = linear_to_alaw(p_samples[idx]);
+            return needed;
+        case AUDIO_CODEC_IMA_ADPCM:
+            if (NULL == p_state)
+                return 0;
+            return ima_encode(p_state, p_samples, samples_count, p_output);
+        default:
+            return 0;
+    }
+}
+
+size_t audio_codec_decode(unsigned int codec, uint8_t const * p_payload, size_t payload_size, int16_t * p_samples, size_t samples_count)
+{
+    size_t idx;
+    switch (codec)
+    {
+        case AUDIO_CODEC_PCM16:
+            samples_count = min(samples_count, payload_size / sizeof(int16_t));
+            CopyMemory(p_samples, p_payload, samples_count * sizeof(int16_t));
+            return samples_count;
+        case AUDIO_CODEC_ULAW:
+            samples_count = min(samples_count, payload_size);
+            for (idx = 0; idx < samples_count; ++idx)
+                p_samples[idx] = ulaw_to_linear(p_payload[idx]);
+            return samples_count;
+        case AUDIO_CODEC_ALAW:
+            samples_count = min(samples_count, payload_size);
+            for (idx = 0; idx < samples_count; ++idx)
+                p_samples[idx] = alaw_to_linear(p_payload[idx]);
+            return samples_count;
+        case AUDIO_CODEC_IMA_ADPCM:
+            return ima_decode(p_payload, payload_size, p_samples, samples_count);
+        default:
+            return 0;
+    }
+}
+
+void audio_codec_int16_to_float(int16_t const * p_samples, float * p_output, size_t samples_count)
+{
+    size_t idx;
+    for (idx = 0; idx < samples_count; ++idx)
+        p_output[idx] = (float)p_samples[idx] * (1.0f / 32768.0f);
+}
+
+void audio_codec_float_to_int16(float const * p_samples, int16_t * p_output, size_t samples_count)
+{
+    size_t idx;
+    for (idx = 0; idx < samples_count; ++idx)
+    {
+        float sample = p_samples[idx] * 32768.0f;
+        p_output[idx] = (int16_t)(sample >= 32767.0f ? 32767 : (sample <= -32768.0f ? -32768 : (int)sample));
+    }
+}
+
+/*!
+ * @brief Multiplier of the dither noise generator.
+ */
+#define DITHER_LCG_A (1664525u)
+
+/*!
+ * @brief Increment of the dither noise generator.
+ */
+#define DITHER_LCG_C (1013904223u)
+
+/*!
+ * @brief Places the 24-bit sample at p in the top 24 bits of a 32-bit one.
+ */
+#define INT24_TO_INT32(p) ((int32_t)(((uint32_t)(p)[0] << 8) | ((uint32_t)(p)[1] << 16) | ((uint32_t)(p)[2] << 24)))
+
+#if defined AUDIO_CODEC_SSE2
+/*!
+ * @brief Multiplier of the dither noise generator, 8 steps at once.
+ */
+#define DITHER_LCG_A8 (3934847009u)
+
+/*!
+ * @brief Increment of the dither noise generator, 8 steps at once.
+ */
+#define DITHER_LCG_C8 (2748932008u)
+
+/*!
+ * @brief Samples that must remain in the buffer for load_int24(), which reads 16 bytes for 4 samples with SSSE3.
+ */
+#if defined AUDIO_CODEC_SSSE3
+#   define INT24_LOAD_SPAN (6)
+#else
+#   define INT24_LOAD_SPAN (4)
+#endif
+
+/*!
+ * @brief Multiplies 32-bit lanes modulo 2^32, which SSE2 lacks an instruction for.
+ */
+static __m128i mullo_epi32(__m128i a, __m128i b)
+{
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+/*!
+ * @brief Loads 4 24-bit samples into the top 24 bits of 4 32-bit lanes.
+ */
+static __m128i load_int24(uint8_t const * p_samples)
+{
+#if defined AUDIO_CODEC_SSSE3
+    __m128i const shuffle = _mm_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+    return _mm_shuffle_epi8(_mm_loadu_si128((__m128i const *)p_samples), shuffle);
+#else
+    return _mm_setr_epi32(INT24_TO_INT32(p_samples), INT24_TO_INT32(p_samples + 3), INT24_TO_INT32(p_samples + 6), INT24_TO_INT32(p_samples + 9));
+#endif
+}
+
+/*!
+ * @brief Stores the top 24 bits of 4 32-bit lanes as 12 bytes.
+ */
+static void store_int24(uint8_t * p_output, __m128i samples)
+{
+#if defined AUDIO_CODEC_SSSE3
+    __m128i const shuffle = _mm_setr_epi8(1, 2, 3, 5, 6, 7, 9, 10, 11, 13, 14, 15, -1, -1, -1, -1);
+    __m128i packed = _mm_shuffle_epi8(samples, shuffle);
+    int32_t tail = _mm_cvtsi128_si32(_mm_srli_si128(packed, 8));
+    _mm_storel_epi64((__m128i *)p_output, packed);
+    memcpy(p_output + 8, &tail, sizeof(tail));
+#else
+    uint32_t values[4];
+    unsigned int lane;
+    _mm_storeu_si128((__m128i *)values, samples);
+    for (lane = 0; lane < 4; ++lane)
+    {
+        p_output[3*lane] = (uint8_t)(values[lane] >> 8);
+        p_output[3*lane + 1] = (uint8_t)(values[lane] >> 16);
+        p_output[3*lane + 2] = (uint8_t)(values[lane] >> 24);
+    }
+#endif
+}
+#endif
+
+void audio_codec_float_to_int16_dither(float const * p_samples, int16_t * p_output, size_t samples_count, uint32_t * p_dither)
+{
+    uint32_t state = *p_dither;
+    size_t idx = 0;
+#if defined AUDIO_CODEC_SSE2
+    /* Lane k follows samples k, k + 4, ..., so it runs the generator 8 steps at a time. The output is the same as
+     * the scalar loop's. */
+    if (samples_count >= 4)
+    {
+        uint32_t first[4];
+        uint32_t second[4];
+        unsigned int lane;
+        __m128i const a8 = _mm_set1_epi32((int)DITHER_LCG_A8);
+        __m128i const c8 = _mm_set1_epi32((int)DITHER_LCG_C8);
+        __m128 const scale = _mm_set1_ps(1.0f / 16777216.0f);
+        __m128 const gain = _mm_set1_ps(32768.0f);
+        __m128 const one = _mm_set1_ps(1.0f);
+        __m128 const high = _mm_set1_ps(32767.0f);
+        __m128 const low = _mm_set1_ps(-32768.0f);
+        __m128i state1;
+        __m128i state2;
+        __m128i last;
+        for (lane = 0; lane < 4; ++lane)
+        {
+            state = state * DITHER_LCG_A + DITHER_LCG_C;
+            first[lane] = state;
+            state = state * DITHER_LCG_A + DITHER_LCG_C;
+            second[lane] = state;
+        }
+        state1 = _mm_loadu_si128((__m128i const *)first);
+        state2 = _mm_loadu_si128((__m128i const *)second);
+        last = state2;
+        for (; idx + 4 <= samples_count; idx += 4)
+        {
+            __m128 noise = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(state1, 8)), scale);
+            __m128 sample;
+            __m128i rounded;
+            noise = _mm_add_ps(noise, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(state2, 8)), scale));
+            sample = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&p_samples[idx]), gain), noise), one);
+            rounded = _mm_cvtps_epi32(_mm_max_ps(_mm_min_ps(sample, high), low));
+            _mm_storel_epi64((__m128i *)&p_output[idx], _mm_packs_epi32(rounded, rounded));
+            last = state2;
+            state1 = _mm_add_epi32(mullo_epi32(state1, a8), c8);
+            state2 = _mm_add_epi32(mullo_epi32(state2, a8), c8);
+        }
+        state = (uint32_t)_mm_cvtsi128_si32(_mm_shuffle_epi32(last, _MM_SHUFFLE(3, 3, 3, 3)));
+    }
+#endif
+    for (; idx < samples_count; ++idx)
+    {
+        float sample;
+        float noise;
+        /* The sum of two uniform values in [0, 1) has a triangular distribution around 1. */
+        state = state * DITHER_LCG_A + DITHER_LCG_C;
+        noise = (float)(state >> 8) * (1.0f / 16777216.0f);
+        state = state * DITHER_LCG_A + DITHER_LCG_C;
+        noise += (float)(state >> 8) * (1.0f / 16777216.0f);
+        sample = p_samples[idx] * 32768.0f + noise - 1.0f;
+        sample = sample >= 32767.0f ? 32767.0f : (sample <= -32768.0f ? -32768.0f : sample);
+        p_output[idx] = (int16_t)lrintf(sample);
+    }
+    *p_dither = state;
+}
+
+void audio_codec_int24_to_int32(uint8_t const * p_samples, int32_t * p_output, size_t samples_count)
+{
+    size_t idx = 0;
+#if defined AUDIO_CODEC_SSE2
+    for (; idx + INT24_LOAD_SPAN <= samples_count; idx += 4)
+        _mm_storeu_si128((__m128i *)&p_output[idx], load_int24(&p_samples[3*idx]));
+#endif
+    for (; idx < samples_count; ++idx)
+        p_output[idx] = INT24_TO_INT32(&p_samples[3*idx]);
+}
+
+void audio_codec_int32_to_int24(int32_t const * p_samples, uint8_t * p_output, size_t samples_count)
+{
+    size_t idx = 0;
+#if defined AUDIO_CODEC_SSE2
+    for (; idx + 4 <= samples_count; idx += 4)
+        store_int24(&p_output[3*idx], _mm_loadu_si128((__m128i const *)&p_samples[idx]));
+#endif
+    for (; idx < samples_count; ++idx)
+    {
+        uint32_t sample = (uint32_t)p_samples[idx];
+        p_output[3*idx] = (uint8_t)(sample >> 8);
+        p_output[3*idx + 1] = (uint8_t)(sample >> 16);
+        p_output[3*idx + 2] = (uint8_t)(sample >> 24);
+    }
+}
+
+void audio_codec_int24_to_float(uint8_t const * p_samples, float * p_output, size_t samples_count)
+{
+    size_t idx = 0;
+#if defined AUDIO_CODEC_SSE2
+    __m128 const scale = _mm_set1_ps(1.0f / 2147483648.0f);
+    for (; idx + INT24_LOAD_SPAN <= samples_count; idx += 4)
+        _mm_storeu_ps(&p_output[idx], _mm_mul_ps(_mm_cvtepi32_ps(load_int24(&p_samples[3*idx])), scale));
+#endif
+    for (; idx < samples_count; ++idx)
+        p_output[idx] = (float)INT24_TO_INT32(&p_samples[3*idx]) * (1.0f / 2147483648.0f);
+}
+
+void audio_codec_float_to_int24(float const * p_samples, uint8_t * p_output, size_t samples_count)
+{
+    size_t idx = 0;
+#if defined AUDIO_CODEC_SSE2
+    __m128 const gain = _mm_set1_ps(8388608.0f);
+    __m128 const high = _mm_set1_ps(8388607.0f);
+    __m128 const low = _mm_set1_ps(-8388608.0f);
+    for (; idx + 4 <= samples_count; idx += 4)
+    {
+        __m128 sample = _mm_mul_ps(_mm_loadu_ps(&p_samples[idx]), gain);
+        __m128i value = _mm_cvttps_epi32(_mm_max_ps(_mm_min_ps(sample, high), low));
+        store_int24(&p_output[3*idx], _mm_slli_epi32(value, 8));
+    }
+#endif
+    for (; idx < samples_count; ++idx)
+    {
+        float sample = p_samples[idx] * 8388608.0f;
+        int32_t value = (int32_t)(sample >= 8388607.0f ? 8388607.0f : (sample <= -8388608.0f ? -8388608.0f : sample));
+        p_output[3*idx] = (uint8_t)value;
+        p_output[3*idx + 1] = (uint8_t)(value >> 8);
+        p_output[3*idx + 2] = (uint8_t)(value >> 16);
+    }
+}
+
+void audio_codec_int32_to_float(int32_t const * p_samples, float * p_output, size_t samples_count)
+{
+    size_t idx;
+    for (idx = 0; idx < samples_count; ++idx)
+        p_output[idx] = (float)p_samples[idx] * (1.0f / 2147483648.0f);
+}
@@ -0,0 +1,196 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+
+/**
+ * @file audio-codec.h
+ * @brief Audio payload codecs.
+ * @details G.711 mu-law and A-law, and IMA ADPCM, used by the transcoder and the receivers.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+#if !defined AUDIO_CODEC_H_3B8E1F52_6C0D_4A97_B2E4_71D95A08C6F3
+#define AUDIO_CODEC_H_3B8E1F52_6C0D_4A97_B2E4_71D95A08C6F3
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+#include "std-int.h"
+#include <stddef.h>
+
+/*!
+ * @brief Payload is 16-bit signed PCM, in the host byte order of the sender.
+ */
+#define AUDIO_CODEC_PCM16 (0)
+
+/*!
+ * @brief Payload is G.711 mu-law, one byte per sample.
+ */
+#define AUDIO_CODEC_ULAW (1)
+
+/*!
+ * @brief Payload is G.711 A-law, one byte per sample.
+ */
+#define AUDIO_CODEC_ALAW (2)
+
+/*!
+ * @brief Payload is a single IMA ADPCM block, 4 bits per sample.
+ * @details The block starts with a 4-byte header: the initial predictor (16 bits, little endian),
+ * the initial step index and a zero byte. The 4-bit codes follow, the first sample in the low nibble.
+ */
+#define AUDIO_CODEC_IMA_ADPCM (3)
+
+/*!
+ * @brief Size of the IMA ADPCM block header, in bytes.
+ */
+#define AUDIO_CODEC_IMA_ADPCM_HEADER_SIZE (4)
+
+/*!
+ * @brief State of the IMA ADPCM encoder, carried over from one block to another.
+ */
+struct audio_codec_state {
+    int32_t predictor_; /*!< Last predicted sample. */
+    int32_t index_; /*!< Index into the step table. */
+};
+
+/*!
+ * @brief Returns the name of the codec.
+ * @param[in] codec one of the AUDIO_CODEC_* values.
+ * @return returns the name, or NULL if the codec is not known.
+ */
+char const * audio_codec_get_name(unsigned int codec);
+
+/*!
+ * @brief Finds a codec by its name.
+ * @param[in] psz_name one of "pcm", "ulaw", "alaw" or "adpcm".
+ * @param[out] p_codec this will be written with one of the AUDIO_CODEC_* values.
+ * @return returns non-zero on success, 0 if the name is not known.
+ */
+int audio_codec_from_name(char const * psz_name, unsigned int * p_codec);
+
+/*!
+ * @brief Returns the number of bytes needed to encode the given number of samples.
+ * @param[in] codec one of the AUDIO_CODEC_* values.
+ * @param[in] samples_count number of samples.
+ * @return returns the size of the encoded payload.
+ */
+size_t audio_codec_get_encoded_size(unsigned int codec, size_t samples_count);
+
+/*!
+ * @brief Encodes 16-bit samples.
+ * @param[in] codec one of the AUDIO_CODEC_* values.
+ * @param[in,out] p_state encoder state, used by the IMA ADPCM only. May be NULL for the other codecs.
+ * @param[in] p_samples samples to encode.
+ * @param[in] samples_count number of samples to encode.
+ * @param[out] p_output encoded payload will be written here.
+ * @param[in] output_size size of the buffer indicated by p_output.
+ * @return returns number of bytes written, 0 if the codec is not known or the buffer is too small.
+ */
+size_t audio_codec_encode(unsigned int codec, struct audio_codec_state * p_state, int16_t const * p_samples, size_t samples_count, uint8_t * p_output, size_t output_size);
+
+/*!
+ * @brief Decodes the payload into 16-bit samples.
+ * @param[in] codec one of the AUDIO_CODEC_* values.
+ * @param[in] p_payload encoded payload.
+ * @param[in] payload_size number of bytes in the payload.
+ * @param[out] p_samples decoded samples will be written here.
+ * @param[in] samples_count maximum number of samples that can be written. For IMA ADPCM, pass the exact count when it is
+ * odd, as the last byte then carries a padding nibble that cannot be told apart from a sample.
+ * @return returns number of samples decoded, 0 if the codec is not known or the payload is malformed.
+ */
+size_t audio_codec_decode(unsigned int codec, uint8_t const * p_payload, size_t payload_size, int16_t * p_samples, size_t samples_count);
+
+/*!
+ * @brief Converts 16-bit samples to floats in the [-1, 1) range.
+ * @param[in] p_samples samples to convert.
+ * @param[out] p_output converted samples will be written here.
+ * @param[in] samples_count number of samples to convert.
+ */
+void audio_codec_int16_to_float(int16_t const * p_samples, float * p_output, size_t samples_count);
+
+/*!
+ * @brief Converts floats in the [-1, 1) range to 16-bit samples.
+ * @details Samples out of the range are clipped.
+ * @param[in] p_samples samples to convert.
+ * @param[out] p_output converted samples will be written here.
+ * @param[in] samples_count number of samples to convert.
+ */
+void audio_codec_float_to_int16(float const * p_samples, int16_t * p_output, size_t samples_count);
+
+/*!
+ * @brief Converts floats in the [-1, 1) range to 16-bit samples, with triangular dither.
+ * @details One LSB of triangular noise is added before the rounding, so that the quantisation error of quiet
+ * passages does not follow the signal. Samples out of the range are clipped.
+ * @param[in] p_samples samples to convert.
+ * @param[out] p_output converted samples will be written here.
+ * @param[in] samples_count number of samples to convert.
+ * @param[in,out] p_dither state of the noise generator, any value but 0 to start with.
+ */
+void audio_codec_float_to_int16_dither(float const * p_samples, int16_t * p_output, size_t samples_count, uint32_t * p_dither);
+
+/*!
+ * @brief Converts packed 24-bit little endian samples to 32-bit samples.
+ * @details The samples are left justified, i.e. the lowest byte of each output sample is 0.
+ * @param[in] p_samples samples to convert, 3 bytes each.
+ * @param[out] p_output converted samples will be written here.
+ * @param[in] samples_count number of samples to convert.
+ */
+void audio_codec_int24_to_int32(uint8_t const * p_samples, int32_t * p_output, size_t samples_count);
+
+/*!
+ * @brief Converts 32-bit samples to packed 24-bit little endian samples.
+ * @details The lowest byte of each sample is dropped.
+ * @param[in] p_samples samples to convert.
+ * @param[out] p_output converted samples will be written here, 3 bytes each.
+ * @param[in] samples_count number of samples to convert.
+ */
+void audio_codec_int32_to_int24(int32_t const * p_samples, uint8_t * p_output, size_t samples_count);
+
+/*!
+ * @brief Converts packed 24-bit little endian samples to floats in the [-1, 1) range.
+ * @param[in] p_samples samples to convert, 3 bytes each.
+ * @param[out] p_output converted samples will be written here.
+ * @param[in] samples_count number of samples to convert.
+ */
+void audio_codec_int24_to_float(uint8_t const * p_samples, float * p_output, size_t samples_count);
+
+/*!
+ * @brief Converts floats in the [-1, 1) range to packed 24-bit little endian samples.
+ * @details Samples out of the range are clipped.
+ * @param[in] p_samples samples to convert.
+ * @param[out] p_output converted samples will be written here, 3 bytes each.
+ * @param[in] samples_count number of samples to convert.
+ */
+void audio_codec_float_to_int24(float const * p_samples, uint8_t * p_output, size_t samples_count);
+
+/*!
+ * @brief Converts 32-bit samples to floats in the [-1, 1) range.
+ * @param[in] p_samples samples to convert.
+ * @param[out] p_output converted samples will be written here.
+ * @param[in] samples_count number of samples to convert.
+ */
+void audio_codec_int32_to_float(int32_t const * p_samples, float * p_output, size_t samples_count);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* AUDIO_CODEC_H_3B8E1F52_6C0D_4A97_B2E4_71D95A08C6F3 */
@@ -0,0 +1,359 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file audio-mixer.c
+ * @brief Receiver side conference mixer implementation.
+ * @details The mixing kernels use SSE2 where available, with a scalar fallback.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include "audio-mixer.h"
+#include "jitter-buffer.h"
+
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#   define AUDIO_MIXER_SSE2
+#   include <emmintrin.h>
+#endif
+
+/*!
+ * @brief Number of samples mixed in one go.
+ * @details The accumulator and the scratch buffers are that long, so that they stay in the L1 cache.
+ */
+#define MIX_CHUNK (256)
+
+/*!
+ * @brief Number of fractional bits of the fixed point gain.
+ */
+#define GAIN_FRAC_BITS (14)
+
+/*!
+ * @brief The unity gain, in the fixed point format.
+ */
+#define GAIN_Q14_UNITY (1 << GAIN_FRAC_BITS)
+
+/*!
+ * @brief Describes a single mixer input.
+ */
+struct audio_mixer_source {
+    uint32_t ssrc_; /*!< Identifier of the source. */
+    int active_; /*!< Non-zero if this slot is in use. */
+    uint16_t auto_seq_; /*!< Next sequence number to give to a packet that carries none. */
+    int16_t gain_q14_; /*!< Source gain, fixed point with 14 fractional bits. */
+    unsigned int idle_rounds_; /*!< Number of mixing rounds this source had no data for. */
+    struct jitter_buffer * jb_; /*!< Source's own jitter buffer. */
+};
+
+/*!
+ * @brief The mixer.
+ */
+struct audio_mixer {
+    unsigned int max_sources_; /*!< Number of source slots. */
+    unsigned int active_count_; /*!< Number of slots in use. */
+    unsigned int last_hit_; /*!< Index of the source that was looked up most recently. */
+    struct audio_mixer_source * sources_; /*!< Source slots. */
+    int32_t acc_[MIX_CHUNK]; /*!< Accumulator. */
+    int16_t scratch_[MIX_CHUNK]; /*!< Samples read from a single source. */
+};
+
+struct audio_mixer * audio_mixer_create(unsigned int max_sources, uint8_t jitter_level, size_t max_packet_samples, unsigned int prefill)
+{
+    struct audio_mixer * p_mixer;
+    unsigned int idx;
+    if (0 == max_sources)
+        return NULL;
+    p_mixer = (struct audio_mixer *)calloc(1, sizeof(struct audio_mixer));
+    if (NULL == p_mixer)
+        return NULL;
+    p_mixer->max_sources_ = max_sources;
+    p_mixer->sources_ = (struct audio_mixer_source *)calloc(max_sources, sizeof(struct audio_mixer_source));
+    if (NULL == p_mixer->sources_)
+    {
+        audio_mixer_destroy(p_mixer);
+        return NULL;
+    }
+    /* All the jitter buffers are created up front, so that no allocation happens on the data path. */
+    for (idx = 0; idx < max_sources; ++idx)
+    {
+        p_mixer->sources_[idx].jb_ = jitter_buffer_create(jitter_level, max_packet_samples, prefill);
+        if (NULL == p_mixer->sources_[idx].jb_)
+        {
+            audio_mixer_destroy(p_mixer);
+            return NULL;
+        }
+    }
+    return p_mixer;
+}
+
+void audio_mixer_destroy(struct audio_mixer * p_mixer)
+{
+    if (NULL != p_mixer)
+    {
+        unsigned int idx;
+        if (NULL != p_mixer->sources_)
+        {
+            for (idx = 0; idx < p_mixer->max_sources_; ++idx)
+                jitter_buffer_destroy(p_mixer->sources_[idx].jb_);
+            free(p_mixer->sources_);
+        }
+        free(p_mixer);
+    }
+}
+
+static struct audio_mixer_source * find_source(struct audio_mixer * p_mixer, uint32_t ssrc)
+{
+    unsigned int idx;
+    struct audio_mixer_source * p_source = &p_mixer->sources_[p_mixer->last_hit_];
+    if (p_source->active_ && p_source->ssrc_ == ssrc)
+        return p_source;
+    for (idx = 0; idx < p_mixer->max_sources_; ++idx)
+    {
+        p_source = &p_mixer->sources_[idx];
+        if (p_source->active_ && p_source->ssrc_ == ssrc)
+        {
+            p_mixer->last_hit_ = idx;
+            return p_source;
+        }
+    }
+    return NULL;
+}
+
+static struct audio_mixer_source * find_or_add_source(struct audio_mixer * p_mixer, uint32_t ssrc)
+{
+    unsigned int idx;
+    struct audio_mixer_source * p_source = find_source(p_mixer, ssrc);
+    if (NULL != p_source)
+        return p_source;
+    for (idx = 0; idx < p_mixer->max_sources_; ++idx)
+    {
+        p_source = &p_mixer->sources_[idx];
+        if (!p_source->active_)
+        {
+            jitter_buffer_reset(p_source->jb_);
+            p_source->ssrc_ = ssrc;
+            p_source->active_ = 1;
+            p_source->auto_seq_ = 0;
+            p_source->gain_q14_ = GAIN_Q14_UNITY;
+            p_source->idle_rounds_ = 0;
+            ++p_mixer->active_count_;
+            p_mixer->last_hit_ = idx;
+            return p_source;
+        }
+    }
+    return NULL;
+}
+
+int audio_mixer_push(struct audio_mixer * p_mixer, uint32_t ssrc, uint16_t seq, int16_t const * p_samples, size_t samples_count)
+{
+    return audio_mixer_push_at(p_mixer, ssrc, seq, p_samples, samples_count, 0);
+}
+
+int audio_mixer_push_at(struct audio_mixer * p_mixer, uint32_t ssrc, uint16_t seq, int16_t const * p_samples, size_t samples_count, uint64_t arrival_time)
+{
+    struct audio_mixer_source * p_source = find_or_add_source(p_mixer, ssrc);
+    if (NULL == p_source)
+        return 0;
+    return jitter_buffer_put_at(p_source->jb_, seq, p_samples, samples_count, arrival_time);
+}
+
+int audio_mixer_push_unsequenced(struct audio_mixer * p_mixer, uint32_t source_key, int16_t const * p_samples, size_t samples_count)
+{
+    struct audio_mixer_source * p_source = find_or_add_source(p_mixer, source_key);
+    if (NULL == p_source)
+        return 0;
+    return jitter_buffer_put(p_source->jb_, p_source->auto_seq_++, p_samples, samples_count);
+}
+
+int audio_mixer_set_gain(struct audio_mixer * p_mixer, uint32_t ssrc, float gain)
+{
+    struct audio_mixer_source * p_source = find_source(p_mixer, ssrc);
+    float q14;
+    if (NULL == p_source)
+        return 0;
+    q14 = gain * GAIN_Q14_UNITY;
+    if (q14 < 0.0f)
+        q14 = 0.0f;
+    if (q14 > 32767.0f)
+        q14 = 32767.0f;
+    p_source->gain_q14_ = (int16_t)(q14 + 0.5f);
+    return 1;
+}
+
+size_t audio_mixer_get_available(struct audio_mixer const * p_mixer)
+{
+    unsigned int idx;
+    size_t result = 0;
+    for (idx = 0; idx < p_mixer->max_sources_; ++idx)
+    {
+        if (p_mixer->sources_[idx].active_)
+        {
+            size_t available = jitter_buffer_get_available(p_mixer->sources_[idx].jb_);
+            if (available > result)
+                result = available;
+        }
+    }
+    return result;
+}
+
+void audio_mixer_set_residency_histogram(struct audio_mixer * p_mixer, struct latency_histogram * p_histogram)
+{
+    unsigned int idx;
+    for (idx = 0; idx < p_mixer->max_sources_; ++idx)
+        jitter_buffer_set_residency_histogram(p_mixer->sources_[idx].jb_, p_histogram);
+}
+
+unsigned int audio_mixer_get_sources_count(struct audio_mixer const * p_mixer)
+{
+    return p_mixer->active_count_;
+}
+
+unsigned int audio_mixer_get_stats(struct audio_mixer const * p_mixer, struct audio_mixer_source_stats * p_stats, unsigned int max_count)
+{
+    unsigned int idx;
+    unsigned int count = 0;
+    for (idx = 0; idx < p_mixer->max_sources_ && count < max_count; ++idx)
+    {
+        struct audio_mixer_source const * p_source = &p_mixer->sources_[idx];
+        if (p_source->active_)
+        {
+            p_stats[count].ssrc_ = p_source->ssrc_;
+            p_stats[count].buffered_ = jitter_buffer_get_available(p_source->jb_);
+            p_stats[count].lost_ = jitter_buffer_get_lost(p_source->jb_);
+            p_stats[count].dropped_ = jitter_buffer_get_dropped(p_source->jb_);
+            p_stats[count].underruns_ = jitter_buffer_get_underruns(p_source->jb_);
+            ++count;
+        }
+    }
+    return count;
+}
+
+/*!
+ * @brief Adds the samples, scaled by the gain, to the accumulator.
+ */
+static void accumulate(int32_t * p_acc, int16_t const * p_samples, size_t count, int16_t gain_q14)
+{
+    size_t idx = 0;
+    if (GAIN_Q14_UNITY == gain_q14)
+    {
+#if defined AUDIO_MIXER_SSE2
+        __m128i const zero = _mm_setzero_si128();
+        for (; idx + 8 <= count; idx += 8)
+        {
+            __m128i s = _mm_loadu_si128((__m128i const *)&p_samples[idx]);
+            __m128i sign = _mm_cmpgt_epi16(zero, s);
+            __m128i * p_a = (__m128i *)&p_acc[idx];
+            _mm_storeu_si128(p_a, _mm_add_epi32(_mm_loadu_si128(p_a), _mm_unpacklo_epi16(s, sign)));
+            _mm_storeu_si128(p_a + 1, _mm_add_epi32(_mm_loadu_si128(p_a + 1), _mm_unpackhi_epi16(s, sign)));
+        }
+#endif
+        for (; idx < count; ++idx)
+            p_acc[idx] += p_samples[idx];
+    }
+    else
+    {
+#if defined AUDIO_MIXER_SSE2
+        __m128i const gain = _mm_set1_epi16(gain_q14);
+        for (; idx + 8 <= count; idx += 8)
+        {
+            __m128i s = _mm_loadu_si128((__m128i const *)&p_samples[idx]);
+            __m128i lo = _mm_mullo_epi16(s, gain);
+            __m128i hi = _mm_mulhi_epi16(s, gain);
+            __m128i * p_a = (__m128i *)&p_acc[idx];
+            _mm_storeu_si128(p_a, _mm_add_epi32(_mm_loadu_si128(p_a), _mm_srai_epi32(_mm_unpacklo_epi16(lo, hi), GAIN_FRAC_BITS)));
+            _mm_storeu_si128(p_a + 1, _mm_add_epi32(_mm_loadu_si128(p_a + 1), _mm_srai_epi32(_mm_unpackhi_epi16(lo, hi), GAIN_FRAC_BITS)));
+        }
+#endif
+        for (; idx < count; ++idx)
+            p_acc[idx] += ((int32_t)p_samples[idx] * gain_q14) >> GAIN_FRAC_BITS;
+    }
+}
+
+/*!
+ * @brief Converts the accumulator back to 16-bit samples, with saturation.
+ */
+static void saturate(int16_t * p_output, int32_t const * p_acc, size_t count)
+{
+    size_t idx = 0;
+#if defined AUDIO_MIXER_SSE2
+    for (; idx + 8 <= count; idx += 8)
+    {
+        __m128i a0 = _mm_loadu_si128((__m128i const *)&p_acc[idx]);
+        __m128i a1 = _mm_loadu_si128((__m128i const *)&p_acc[idx + 4]);
+        _mm_storeu_si128((__m128i *)&p_output[idx], _mm_packs_epi32(a0, a1));
+    }
+#endif
+    for (; idx < count; ++idx)
+    {
+        int32_t value = p_acc[idx];
+        if (value > INT16_MAX)
+            value = INT16_MAX;
+        else if (value < INT16_MIN)
+            value = INT16_MIN;
+        p_output[idx] = (int16_t)value;
+    }
+}
+
+unsigned int audio_mixer_mix(struct audio_mixer * p_mixer, int16_t * p_output, size_t count)
+{
+    return audio_mixer_mix_at(p_mixer, p_output, count, 0);
+}
+
+unsigned int audio_mixer_mix_at(struct audio_mixer * p_mixer, int16_t * p_output, size_t count, uint64_t playout_time)
+{
+    unsigned int idx;
+    unsigned int contributed = 0;
+    size_t offset;
+    for (idx = 0; idx < p_mixer->max_sources_; ++idx)
+    {
+        struct audio_mixer_source * p_source = &p_mixer->sources_[idx];
+        if (p_source->active_ && 0 == jitter_buffer_get_available(p_source->jb_))
+        {
+            /* Sources that have gone silent for long enough make room for the new ones. */
+            if (++p_source->idle_rounds_ > AUDIO_MIXER_IDLE_ROUNDS)
+            {
+                p_source->active_ = 0;
+                --p_mixer->active_count_;
+            }
+        }
+        else if (p_source->active_)
+        {
+            p_source->idle_rounds_ = 0;
+            ++contributed;
+        }
+    }
+    for (offset = 0; offset < count; offset += MIX_CHUNK)
+    {
+        size_t chunk = min(count - offset, (size_t)MIX_CHUNK);
+        ZeroMemory(p_mixer->acc_, chunk * sizeof(int32_t));
+        for (idx = 0; idx < p_mixer->max_sources_; ++idx)
+        {
+            struct audio_mixer_source * p_source = &p_mixer->sources_[idx];
+            if (p_source->active_ && 0 == p_source->idle_rounds_)
+            {
+                if (jitter_buffer_read_at(p_source->jb_, p_mixer->scratch_, chunk, playout_time) > 0)
+                    accumulate(p_mixer->acc_, p_mixer->scratch_, chunk, p_source->gain_q14_);
+            }
+        }
+        saturate(&p_output[offset], p_mixer->acc_, chunk);
+    }
+    return contributed;
+}
@@ -0,0 +1,188 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+
+/**
+ * @file audio-mixer.h
+ * @brief Receiver side conference mixer.
+ * @details Every source has its own jitter buffer. The sources are scaled with per source gains and summed with saturation.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+#if !defined AUDIO_MIXER_H_9B0F2E6D_41C3_4A85_B7D2_6E93C1A05F48
+#define AUDIO_MIXER_H_9B0F2E6D_41C3_4A85_B7D2_6E93C1A05F48
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+#include "std-int.h"
+#include <stddef.h>
+
+/*!
+ * @brief Forward declaration.
+ */
+struct audio_mixer;
+
+/*!
+ * @brief Forward declaration.
+ */
+struct latency_histogram;
+
+/*!
+ * @brief Gain value that leaves the source samples unchanged.
+ */
+#define AUDIO_MIXER_UNITY_GAIN (1.0f)
+
+/*!
+ * @brief Number of mixing rounds without any data after which a source is forgotten.
+ */
+#define AUDIO_MIXER_IDLE_ROUNDS (256)
+
+/*!
+ * @brief State of a single mixer input.
+ */
+struct audio_mixer_source_stats {
+    uint32_t ssrc_; /*!< Identifier of the source. */
+    size_t buffered_; /*!< Number of samples ready for the playout. */
+    uint32_t lost_; /*!< Number of packets skipped during the playout. */
+    uint32_t dropped_; /*!< Number of late or duplicated packets. */
+    uint32_t underruns_; /*!< Number of times the playout ran out of data. */
+};
+
+/*!
+ * @brief Creates the mixer.
+ * @param[in] max_sources maximum number of simultaneously active sources.
+ * @param[in] jitter_level exponent of the number of packets each per source jitter buffer can hold.
+ * @param[in] max_packet_samples maximum number of samples a single packet can carry.
+ * @param[in] prefill number of packets each source buffers before its playout starts.
+ * @return returns a handle to the mixer, or NULL if creation failed.
+ * @sa audio_mixer_destroy
+ */
+struct audio_mixer * audio_mixer_create(unsigned int max_sources, uint8_t jitter_level, size_t max_packet_samples, unsigned int prefill);
+
+/*!
+ * @brief Destroys the mixer and all its sources.
+ * @param[in] p_mixer a handle to the mixer obtained via call to audio_mixer_create.
+ */
+void audio_mixer_destroy(struct audio_mixer * p_mixer);
+
+/*!
+ * @brief Puts a packet of a given source into the mixer.
+ * @details If the source is not known yet, it is created.
+ * @param[in] p_mixer a handle to the mixer.
+ * @param[in] ssrc identifier of the source.
+ * @param[in] seq sequence number of the packet.
+ * @param[in] p_samples 16-bit PCM samples carried by the packet.
+ * @param[in] samples_count number of samples.
+ * @return returns non-zero if the packet was accepted. Returns 0 if it was dropped, either by the source's jitter buffer
+ * or because there is no room for a new source.
+ */
+int audio_mixer_push(struct audio_mixer * p_mixer, uint32_t ssrc, uint16_t seq, int16_t const * p_samples, size_t samples_count);
+
+/*!
+ * @brief Puts a packet of a given source into the mixer and remembers when it arrived.
+ * @details Same as audio_mixer_push, see jitter_buffer_put_at.
+ * @param[in] p_mixer a handle to the mixer.
+ * @param[in] ssrc identifier of the source.
+ * @param[in] seq sequence number of the packet.
+ * @param[in] p_samples 16-bit PCM samples carried by the packet.
+ * @param[in] samples_count number of samples.
+ * @param[in] arrival_time arrival time of the packet, in nanoseconds. 0 means unknown.
+ * @return returns non-zero if the packet was accepted, 0 otherwise.
+ */
+int audio_mixer_push_at(struct audio_mixer * p_mixer, uint32_t ssrc, uint16_t seq, int16_t const * p_samples, size_t samples_count, uint64_t arrival_time);
+
+/*!
+ * @brief Puts a packet that carries no sequence number into the mixer.
+ * @details This is for the senders that do not prepend the packet header. Such packets are played in the arrival order.
+ * @param[in] p_mixer a handle to the mixer.
+ * @param[in] source_key anything that tells the sources apart, e.g. hash of the source address.
+ * @param[in] p_samples 16-bit PCM samples carried by the packet.
+ * @param[in] samples_count number of samples.
+ * @return returns non-zero if the packet was accepted, 0 otherwise.
+ */
+int audio_mixer_push_unsequenced(struct audio_mixer * p_mixer, uint32_t source_key, int16_t const * p_samples, size_t samples_count);
+
+/*!
+ * @brief Sets the gain of a given source.
+ * @param[in] p_mixer a handle to the mixer.
+ * @param[in] ssrc identifier of the source.
+ * @param[in] gain linear gain, from 0.0 to 2.0. Values outside that range are clamped.
+ * @return returns non-zero on success, 0 if there is no such source.
+ */
+int audio_mixer_set_gain(struct audio_mixer * p_mixer, uint32_t ssrc, float gain);
+
+/*!
+ * @brief Returns number of samples that can be mixed right now.
+ * @details This is the greatest number of samples that is available from any single source.
+ * @param[in] p_mixer a handle to the mixer.
+ * @return number of samples that can be mixed.
+ */
+size_t audio_mixer_get_available(struct audio_mixer const * p_mixer);
+
+/*!
+ * @brief Mixes all the active sources into a single output stream.
+ * @details The sources are scaled with their gains and summed with saturation. Sources that have
+ * no data for this round contribute silence.
+ * @param[in] p_mixer a handle to the mixer.
+ * @param[out] p_output this buffer will be written with the mixed samples.
+ * @param[in] count number of samples to mix.
+ * @return returns number of sources that contributed data to this round.
+ */
+unsigned int audio_mixer_mix(struct audio_mixer * p_mixer, int16_t * p_output, size_t count);
+
+/*!
+ * @brief Mixes all the active sources and measures how long the packets played out stayed in the jitter buffers.
+ * @details Same as audio_mixer_mix, see jitter_buffer_read_at.
+ * @param[in] p_mixer a handle to the mixer.
+ * @param[out] p_output this buffer will be written with the mixed samples.
+ * @param[in] count number of samples to mix.
+ * @param[in] playout_time current time, in the same clock and unit as the arrival times.
+ * @return returns number of sources that contributed data to this round.
+ */
+unsigned int audio_mixer_mix_at(struct audio_mixer * p_mixer, int16_t * p_output, size_t count, uint64_t playout_time);
+
+/*!
+ * @brief Sets the histogram in which the jitter buffer residency of the packets of all the sources is recorded.
+ * @param[in] p_mixer a handle to the mixer.
+ * @param[in] p_histogram the histogram, or NULL to stop the measurement. It has to outlive the mixer.
+ */
+void audio_mixer_set_residency_histogram(struct audio_mixer * p_mixer, struct latency_histogram * p_histogram);
+
+/*!
+ * @brief Returns number of currently active sources.
+ */
+unsigned int audio_mixer_get_sources_count(struct audio_mixer const * p_mixer);
+
+/*!
+ * @brief Returns the state of all the active sources.
+ * @param[in] p_mixer a handle to the mixer.
+ * @param[out] p_stats this array will be written with the state of the sources.
+ * @param[in] max_count number of entries in the p_stats array.
+ * @return returns number of entries written.
+ */
+unsigned int audio_mixer_get_stats(struct audio_mixer const * p_mixer, struct audio_mixer_source_stats * p_stats, unsigned int max_count);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* AUDIO_MIXER_H_9B0F2E6D_41C3_4A85_B7D2_6E93C1A05F48 */
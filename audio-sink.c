@@ -0,0 +1,198 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file audio-sink.c
+ * @brief Portable audio output, the implementation.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include "audio-sink.h"
+#include "debug_helpers.h"
+#include "perf-counter-itf.h"
+#include "wave-reader.h"
+
+/*!
+ * @brief What the sinks of each type do with the samples.
+ */
+struct audio_sink_ops {
+    int (*write_)(struct audio_sink * p_sink, int16_t const * p_samples, size_t size); /*!< Writes size bytes of samples. */
+    void (*close_)(struct audio_sink * p_sink); /*!< Releases what the type of the sink holds. */
+};
+
+/*!
+ * @brief The sink.
+ */
+struct audio_sink {
+    struct audio_sink_ops const * p_ops_; /*!< Type of the sink. */
+    struct audio_sink_config config_; /*!< The device. */
+    audio_sink_clock_t clock_; /*!< The clock the emulated device plays by. */
+    void * p_clock_context_; /*!< Passed to clock_. */
+    FILE * fp_; /*!< The WAV file - this is only valid for AUDIO_SINK_WAV. */
+    uint64_t written_; /*!< Number of frames written so far. */
+    uint64_t start_written_; /*!< Number of frames written before the emulated device last started to play. */
+    uint64_t start_time_; /*!< When the emulated device last started to play, in nanoseconds. */
+    int started_; /*!< Non-zero while the emulated device plays. */
+    uint64_t underruns_; /*!< Number of times the emulated device ran out of frames. */
+};
+
+static uint64_t monotonic_clock(void * p_context)
+{
+    return perf_counter_get_monotonic_ns();
+}
+
+/*!
+ * @brief Returns number of frames the emulated device has played since it last started.
+ */
+static uint64_t get_played(struct audio_sink const * p_sink, uint64_t now)
+{
+    return (now - p_sink->start_time_) / 1000 * p_sink->config_.sample_rate_ / 1000000;
+}
+
+static int null_write(struct audio_sink * p_sink, int16_t const * p_samples, size_t size)
+{
+    return 1;
+}
+
+static void null_close(struct audio_sink * p_sink)
+{
+}
+
+/*!
+ * @brief Writes the canonical header, with the sizes of the frames written so far.
+ */
+static int wave_write_header(struct audio_sink * p_sink)
+{
+    uint8_t header[WAVE_READER_HEADER_SIZE];
+    wave_reader_make_header(header, p_sink->config_.sample_rate_, p_sink->config_.channels_, p_sink->written_);
+    return 0 == fseek(p_sink->fp_, 0, SEEK_SET) && 1 == fwrite(header, sizeof(header), 1, p_sink->fp_);
+}
+
+static int wave_write(struct audio_sink * p_sink, int16_t const * p_samples, size_t size)
+{
+    return 1 == fwrite(p_samples, size, 1, p_sink->fp_);
+}
+
+static void wave_close(struct audio_sink * p_sink)
+{
+    if (!wave_write_header(p_sink))
+        debug_log_error(DEBUG_CATEGORY_AUDIO, "%s %4.4u : cannot complete the WAV file %d", __FILE__, __LINE__, errno);
+    fclose(p_sink->fp_);
+}
+
+static struct audio_sink_ops const g_null_ops = { &null_write, &null_close };
+
+static struct audio_sink_ops const g_wave_ops = { &wave_write, &wave_close };
+
+struct audio_sink * audio_sink_open(int type, char const * psz_path, struct audio_sink_config const * p_config)
+{
+    struct audio_sink * p_sink;
+    if (0 == p_config->sample_rate_ || 0 == p_config->channels_ || p_config->channels_ > UINT16_MAX / sizeof(int16_t) || 0 == p_config->period_frames_)
+        return NULL;
+    p_sink = (struct audio_sink *)calloc(1, sizeof(struct audio_sink));
+    if (NULL == p_sink)
+        return NULL;
+    p_sink->config_ = *p_config;
+    p_sink->clock_ = &monotonic_clock;
+    switch (type)
+    {
+        case AUDIO_SINK_NULL:
+            p_sink->p_ops_ = &g_null_ops;
+            return p_sink;
+        case AUDIO_SINK_WAV:
+            p_sink->p_ops_ = &g_wave_ops;
+            p_sink->fp_ = fopen(psz_path, "wb");
+            /* The header is written again with the sizes on close. */
+            if (NULL != p_sink->fp_ && wave_write_header(p_sink))
+                return p_sink;
+            debug_log_error(DEBUG_CATEGORY_AUDIO, "%s %4.4u : cannot create %s %d", __FILE__, __LINE__, psz_path, errno);
+            if (NULL != p_sink->fp_)
+                fclose(p_sink->fp_);
+            break;
+        default:
+            assert(0);
+            break;
+    }
+    free(p_sink);
+    return NULL;
+}
+
+void audio_sink_set_clock(struct audio_sink * p_sink, audio_sink_clock_t clock, void * p_context)
+{
+    p_sink->clock_ = clock;
+    p_sink->p_clock_context_ = p_context;
+}
+
+struct audio_sink_config const * audio_sink_get_config(struct audio_sink const * p_sink)
+{
+    return &p_sink->config_;
+}
+
+int audio_sink_write_period(struct audio_sink * p_sink, int16_t const * p_samples)
+{
+    uint64_t now = p_sink->clock_(p_sink->p_clock_context_);
+    if (p_sink->started_ && get_played(p_sink, now) >= p_sink->written_ - p_sink->start_written_)
+    {
+        /* Everything has been played by now, so the device stopped somewhere in between. */
+        p_sink->started_ = 0;
+        ++p_sink->underruns_;
+    }
+    if (!p_sink->started_)
+    {
+        p_sink->started_ = 1;
+        p_sink->start_time_ = now;
+        p_sink->start_written_ = p_sink->written_;
+    }
+    if (!p_sink->p_ops_->write_(p_sink, p_samples, p_sink->config_.period_frames_ * p_sink->config_.channels_ * sizeof(int16_t)))
+        return 0;
+    p_sink->written_ += p_sink->config_.period_frames_;
+    return 1;
+}
+
+uint64_t audio_sink_get_latency(struct audio_sink * p_sink)
+{
+    uint64_t queued, played;
+    if (!p_sink->started_)
+        return 0;
+    queued = p_sink->written_ - p_sink->start_written_;
+    played = get_played(p_sink, p_sink->clock_(p_sink->p_clock_context_));
+    return played < queued ? queued - played : 0;
+}
+
+uint64_t audio_sink_get_frames_written(struct audio_sink const * p_sink)
+{
+    return p_sink->written_;
+}
+
+uint64_t audio_sink_get_underruns(struct audio_sink const * p_sink)
+{
+    return p_sink->underruns_;
+}
+
+void audio_sink_close(struct audio_sink * p_sink)
+{
+    if (NULL != p_sink)
+    {
+        p_sink->p_ops_->close_(p_sink);
+        free(p_sink);
+    }
+}
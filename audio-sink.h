@@ -0,0 +1,132 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+
+/**
+ * @file audio-sink.h
+ * @brief Portable audio output.
+ * @details A sink is what the playout writes the mixed periods to, so that the pipeline does not depend on DirectSound. There is a null sink for benchmarks and a WAV file sink for recording.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+#if !defined AUDIO_SINK_H_50043958_32C9_4FC4_A735_819A547E25E4
+#define AUDIO_SINK_H_50043958_32C9_4FC4_A735_819A547E25E4
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+#include "std-int.h"
+#include <stddef.h>
+
+/*!
+ * @brief The samples are dropped. Meant for benchmarks and for profiling the pipeline in front of the sink.
+ */
+#define AUDIO_SINK_NULL (0)
+
+/*!
+ * @brief The samples are recorded into a 16-bit PCM WAV file.
+ */
+#define AUDIO_SINK_WAV (1)
+
+/*!
+ * @brief Describes the device the sink stands for.
+ */
+struct audio_sink_config {
+    unsigned int sample_rate_; /*!< Sampling rate, in Hz. */
+    unsigned int channels_; /*!< Number of interleaved channels. */
+    unsigned int period_frames_; /*!< Number of frames written at a time. */
+    unsigned int periods_count_; /*!< Number of periods the device buffers, i.e. the playout latency it is run at. */
+};
+
+/*!
+ * @brief Forward declaration.
+ */
+struct audio_sink;
+
+/*!
+ * @brief Returns the time of the clock the emulated device plays by, in nanoseconds.
+ * @param[in] p_context the context given to audio_sink_set_clock.
+ */
+typedef uint64_t (*audio_sink_clock_t)(void * p_context);
+
+/*!
+ * @brief Opens the sink.
+ * @details Neither of the sinks has a hardware clock, so both emulate one: the device starts to play with the first
+ * period written and then plays sample_rate_ frames per second. When it runs out of frames, it stops and starts over
+ * with the next period, which is counted as an underrun.
+ * @param[in] type one of the AUDIO_SINK_* types.
+ * @param[in] psz_path path of the file to be written, ignored by AUDIO_SINK_NULL.
+ * @param[in] p_config the device.
+ * @return returns a handle to the sink, or NULL if the file could not be created or the configuration is invalid.
+ */
+struct audio_sink * audio_sink_open(int type, char const * psz_path, struct audio_sink_config const * p_config);
+
+/*!
+ * @brief Replaces the clock the emulated device plays by, which is perf_counter_get_monotonic_ns() by default.
+ * @details Lets the tests step the device by hand. Must be called before the first period is written.
+ * @param[in] p_sink a handle to the sink.
+ * @param[in] clock the clock.
+ * @param[in] p_context passed to the clock.
+ */
+void audio_sink_set_clock(struct audio_sink * p_sink, audio_sink_clock_t clock, void * p_context);
+
+/*!
+ * @brief Returns the configuration the sink was opened with.
+ */
+struct audio_sink_config const * audio_sink_get_config(struct audio_sink const * p_sink);
+
+/*!
+ * @brief Writes a single period.
+ * @param[in] p_sink a handle to the sink.
+ * @param[in] p_samples period_frames_ frames of interleaved samples.
+ * @return returns non-zero on success, 0 if the samples could not be written.
+ */
+int audio_sink_write_period(struct audio_sink * p_sink, int16_t const * p_samples);
+
+/*!
+ * @brief Returns the latency of the device.
+ * @param[in] p_sink a handle to the sink.
+ * @return returns number of frames written, but not played yet.
+ */
+uint64_t audio_sink_get_latency(struct audio_sink * p_sink);
+
+/*!
+ * @brief Returns number of frames written so far.
+ */
+uint64_t audio_sink_get_frames_written(struct audio_sink const * p_sink);
+
+/*!
+ * @brief Returns number of times the device ran out of frames.
+ */
+uint64_t audio_sink_get_underruns(struct audio_sink const * p_sink);
+
+/*!
+ * @brief Closes the sink.
+ * @details The WAV file is completed, i.e. the sizes are written into its header.
+ * @param[in] p_sink a handle to the sink obtained via call to audio_sink_open.
+ */
+void audio_sink_close(struct audio_sink * p_sink);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* AUDIO_SINK_H_50043958_32C9_4FC4_A735_819A547E25E4 */
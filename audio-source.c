@@ -0,0 +1,280 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file audio-source.c
+ * @brief Portable audio capture, the implementation.
+ * @details The blocks are delivered by a pthread, paced with absolute CLOCK_MONOTONIC deadlines.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include <pthread.h>
+#include "audio-source.h"
+#include "abstract-tone.h"
+#include "wave-reader.h"
+#include "wave_utils.h"
+#include "tone-generator.h"
+#include "audio-codec.h"
+#include "thread-sched.h"
+#include "debug_helpers.h"
+#include "perf-counter-itf.h"
+
+/*!
+ * @brief The source.
+ */
+struct audio_source {
+    struct audio_source_config config_; /*!< How the blocks are delivered. */
+    void * p_context_; /*!< Passed to the routine. */
+    audio_source_routine_t p_routine_; /*!< Receives the blocks. */
+    struct abstract_tone * p_tone_; /*!< The tone - this is only valid for the sources created with audio_source_create_tone. */
+    struct wave_reader * p_reader_; /*!< Reader of the tone - as above. */
+    int convert_; /*!< Non-zero if the samples of the tone are not 16-bit PCM. */
+    struct tone_generator * p_generator_; /*!< The signal - this is only valid for the sources created with audio_source_create_generator. */
+    unsigned int sample_rate_; /*!< Sampling rate of the blocks. */
+    unsigned int channels_; /*!< Number of channels of the blocks. */
+    int16_t * p_block_; /*!< The block being delivered. */
+    float * p_floats_; /*!< The block before the conversion, if convert_ is set. */
+    struct audio_source_stats stats_; /*!< What has been delivered so far. */
+    pthread_t thread_; /*!< The capture thread. */
+    int started_; /*!< Non-zero while the capture thread runs. */
+    volatile int stop_; /*!< Tells the capture thread to finish. */
+};
+
+static struct audio_source * create_source(struct audio_source_config const * p_config, void * p_context, audio_source_routine_t p_routine)
+{
+    struct audio_source * p_source;
+    if (0 == p_config->block_frames_)
+        return NULL;
+    p_source = (struct audio_source *)calloc(1, sizeof(struct audio_source));
+    if (NULL != p_source)
+    {
+        p_source->config_ = *p_config;
+        p_source->p_context_ = p_context;
+        p_source->p_routine_ = p_routine;
+    }
+    return p_source;
+}
+
+/*!
+ * @brief Allocates the block, once the number of channels is known.
+ */
+static int allocate_block(struct audio_source * p_source)
+{
+    size_t samples = (size_t)p_source->config_.block_frames_ * p_source->channels_;
+    p_source->p_block_ = (int16_t *)malloc(samples * sizeof(int16_t));
+    if (p_source->convert_)
+        p_source->p_floats_ = (float *)malloc(samples * sizeof(float));
+    return NULL != p_source->p_block_ && (!p_source->convert_ || NULL != p_source->p_floats_);
+}
+
+struct audio_source * audio_source_create_tone(tone_type_t e_type, char const * psz_tone_name, struct audio_source_config const * p_config,
+        void * p_context, audio_source_routine_t p_routine)
+{
+    struct audio_source * p_source = create_source(p_config, p_context, p_routine);
+    struct wave_reader_format const * p_format;
+    if (NULL == p_source)
+        return NULL;
+    p_source->p_tone_ = abstract_tone_create(e_type, psz_tone_name);
+    if (NULL != p_source->p_tone_)
+    {
+        p_source->p_reader_ = abstract_tone_get_reader(p_source->p_tone_);
+        p_format = wave_reader_get_format(p_source->p_reader_);
+        p_source->sample_rate_ = p_format->sample_rate_;
+        p_source->channels_ = p_format->channels_;
+        p_source->convert_ = !(WAVE_FORMAT_PCM == p_format->sub_format_ && 16 == p_format->bits_per_sample_);
+        if ((!p_source->convert_ || wave_reader_format_is_convertible(p_format)) && 0 != p_source->sample_rate_ && allocate_block(p_source))
+            return p_source;
+    }
+    audio_source_destroy(p_source);
+    return NULL;
+}
+
+struct audio_source * audio_source_create_generator(char const * psz_spec, struct audio_source_config const * p_config,
+        void * p_context, audio_source_routine_t p_routine)
+{
+    struct audio_source * p_source = create_source(p_config, p_context, p_routine);
+    struct tone_generator_config config;
+    if (NULL == p_source)
+        return NULL;
+    if (tone_generator_parse(&config, psz_spec))
+    {
+        /* The sequence tone changes its frequency with each block, as it does with each packet. */
+        config.packet_frames_ = p_config->block_frames_;
+        p_source->p_generator_ = tone_generator_create(&config);
+    }
+    if (NULL != p_source->p_generator_)
+    {
+        p_source->sample_rate_ = config.sample_rate_;
+        p_source->channels_ = config.channels_;
+        if (allocate_block(p_source))
+            return p_source;
+    }
+    audio_source_destroy(p_source);
+    return NULL;
+}
+
+unsigned int audio_source_get_sample_rate(struct audio_source const * p_source)
+{
+    return p_source->sample_rate_;
+}
+
+unsigned int audio_source_get_channels(struct audio_source const * p_source)
+{
+    return p_source->channels_;
+}
+
+/*!
+ * @brief Reads the next block of the tone, starting it over at its end if it loops.
+ * @return returns number of frames read, 0 at the end of the tone.
+ */
+static size_t read_tone(struct audio_source * p_source)
+{
+    size_t frames = 0;
+    unsigned int attempt;
+    /* The second attempt is after the tone has been started over. */
+    for (attempt = 0; attempt < 2 && 0 == frames; ++attempt)
+    {
+        if (p_source->convert_)
+        {
+            frames = wave_reader_read_float(p_source->p_reader_, p_source->p_floats_, p_source->config_.block_frames_);
+            audio_codec_float_to_int16(p_source->p_floats_, p_source->p_block_, frames * p_source->channels_);
+        }
+        else
+            frames = wave_reader_read_frames(p_source->p_reader_, p_source->p_block_, p_source->config_.block_frames_);
+        if (0 == frames && p_source->config_.loop_)
+            wave_reader_seek(p_source->p_reader_, 0);
+        else
+            break;
+    }
+    return frames;
+}
+
+/*!
+ * @brief Delivers the blocks until told to stop, until the tone ends or until max_blocks have been delivered.
+ */
+static uint64_t deliver_blocks(struct audio_source * p_source, uint64_t max_blocks)
+{
+    uint64_t start = perf_counter_get_monotonic_ns();
+    uint64_t delivered = 0;
+    uint64_t block_ns = (uint64_t)p_source->config_.block_frames_ * 1000000000ULL / p_source->sample_rate_;
+    uint64_t start_frames = p_source->stats_.frames_;
+    while (delivered < max_blocks && !p_source->stop_)
+    {
+        size_t frames;
+        if (NULL != p_source->p_generator_)
+        {
+            tone_generator_fill(p_source->p_generator_, p_source->p_block_, p_source->config_.block_frames_);
+            frames = p_source->config_.block_frames_;
+        }
+        else
+            frames = read_tone(p_source);
+        if (0 == frames)
+            break;
+        if (AUDIO_SOURCE_REALTIME == p_source->config_.pacing_)
+        {
+            /* A block is captured once its last frame has been, and the deadlines are absolute, so that the time
+             * taken by the routine does not add up. */
+            uint64_t due = start + (p_source->stats_.frames_ - start_frames + frames) * 1000000000ULL / p_source->sample_rate_;
+            uint64_t now = perf_counter_get_monotonic_ns();
+            if (now < due)
+            {
+                struct timespec wake;
+                wake.tv_sec = (time_t)(due / 1000000000ULL);
+                wake.tv_nsec = (long)(due % 1000000000ULL);
+                while (EINTR == clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, NULL))
+                    ;
+            }
+            else
+            {
+                if (now - due > p_source->stats_.max_lateness_)
+                    p_source->stats_.max_lateness_ = now - due;
+                if (now - due >= block_ns)
+                    ++p_source->stats_.late_;
+            }
+        }
+        (*p_source->p_routine_)(p_source->p_context_, p_source->p_block_, frames * p_source->channels_ * sizeof(int16_t));
+        ++p_source->stats_.blocks_;
+        p_source->stats_.frames_ += frames;
+        ++delivered;
+    }
+    return delivered;
+}
+
+uint64_t audio_source_run(struct audio_source * p_source, uint64_t max_blocks)
+{
+    assert(!p_source->started_);
+    return deliver_blocks(p_source, max_blocks);
+}
+
+static void * capture_thread(void * p_param)
+{
+    struct thread_sched_result sched;
+    /* 'MCAST_SCHED_CAPTURE=fifo:80@2' puts the thread on the real time policy, as the sound card drivers do with theirs. */
+    thread_sched_apply_from_env(THREAD_ROLE_CAPTURE, &sched);
+    deliver_blocks((struct audio_source *)p_param, UINT64_MAX);
+    return NULL;
+}
+
+int audio_source_start(struct audio_source * p_source)
+{
+    int result;
+    if (p_source->started_)
+        return 0;
+    p_source->stop_ = 0;
+    result = pthread_create(&p_source->thread_, NULL, &capture_thread, p_source);
+    if (0 != result)
+    {
+        debug_log_error(DEBUG_CATEGORY_AUDIO, "%s %4.4u : no capture thread %d", __FILE__, __LINE__, result);
+        return 0;
+    }
+    p_source->started_ = 1;
+    return 1;
+}
+
+int audio_source_stop(struct audio_source * p_source)
+{
+    if (!p_source->started_)
+        return 0;
+    p_source->stop_ = 1;
+    pthread_join(p_source->thread_, NULL);
+    p_source->started_ = 0;
+    return 1;
+}
+
+void audio_source_get_stats(struct audio_source const * p_source, struct audio_source_stats * p_stats)
+{
+    *p_stats = p_source->stats_;
+}
+
+void audio_source_destroy(struct audio_source * p_source)
+{
+    if (NULL != p_source)
+    {
+        audio_source_stop(p_source);
+        if (NULL != p_source->p_tone_)
+            abstract_tone_destroy(p_source->p_tone_);
+        tone_generator_destroy(p_source->p_generator_);
+        free(p_source->p_floats_);
+        free(p_source->p_block_);
+        free(p_source);
+    }
+}
@@ -0,0 +1,159 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+
+/**
+ * @file audio-source.h
+ * @brief Portable audio capture.
+ * @details A source delivers blocks of samples to the same kind of routine the DirectSound recorder does, from a tone or a generated signal instead of a sound card, so that the sender's processing can be run and load tested on any box.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+#if !defined AUDIO_SOURCE_H_4D0EF2F9_708F_4F97_A0D4_486B2A3B17F2
+#define AUDIO_SOURCE_H_4D0EF2F9_708F_4F97_A0D4_486B2A3B17F2
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+#include "std-int.h"
+#include <stddef.h>
+#include "abstract-tone.h"
+
+/*!
+ * @brief Receives the captured blocks.
+ * @details The same contract as the SEND_ROUTINE of the DirectSound recorder, so that the routines written for the
+ * recorder, e.g. mcast_send_data_packet(), can be given to the source unchanged.
+ * @param[in] p_context the context given when the source was created.
+ * @param[in] data interleaved 16-bit samples of the block, valid only during the call.
+ * @param[in] data_size size of the block, in bytes.
+ */
+typedef void (*audio_source_routine_t)(void * p_context, void * data, size_t data_size);
+
+/*!
+ * @brief The blocks are delivered at the pace a sound card would capture them.
+ */
+#define AUDIO_SOURCE_REALTIME (0)
+
+/*!
+ * @brief The blocks are delivered as fast as the routine takes them, for benchmarks and load tests.
+ */
+#define AUDIO_SOURCE_AS_FAST_AS_POSSIBLE (1)
+
+/*!
+ * @brief How the blocks are delivered.
+ */
+struct audio_source_config {
+    unsigned int block_frames_; /*!< Number of frames in each block. */
+    int pacing_; /*!< Either AUDIO_SOURCE_REALTIME or AUDIO_SOURCE_AS_FAST_AS_POSSIBLE. */
+    int loop_; /*!< If non-zero, the tone starts over when it ends. The generated signals never end. */
+};
+
+/*!
+ * @brief What the source has delivered so far.
+ */
+struct audio_source_stats {
+    uint64_t blocks_; /*!< Number of blocks delivered. */
+    uint64_t frames_; /*!< Number of frames delivered. */
+    uint64_t late_; /*!< Number of blocks delivered a whole block or more after they were due, AUDIO_SOURCE_REALTIME only. */
+    uint64_t max_lateness_; /*!< Longest delay of a block past the time it was due, in nanoseconds, AUDIO_SOURCE_REALTIME only. */
+};
+
+/*!
+ * @brief Forward declaration.
+ */
+struct audio_source;
+
+/*!
+ * @brief Creates the source that captures a tone.
+ * @details The samples are converted to 16 bits if the tone has other ones.
+ * @param[in] e_type type of the tone, see abstract_tone_create.
+ * @param[in] psz_tone_name tone specific creation data, see abstract_tone_create.
+ * @param[in] p_config how the blocks are delivered.
+ * @param[in] p_context passed to the routine.
+ * @param[in] p_routine receives the blocks.
+ * @return returns a handle to the source, or NULL if the tone could not be created, or has samples that cannot be converted.
+ */
+struct audio_source * audio_source_create_tone(tone_type_t e_type, char const * psz_tone_name, struct audio_source_config const * p_config,
+        void * p_context, audio_source_routine_t p_routine);
+
+/*!
+ * @brief Creates the source that captures a generated signal.
+ * @details Unlike the GENERATED_TONE, the signal is generated block by block, so it never repeats.
+ * @param[in] psz_spec description of the signal, see tone_generator_parse.
+ * @param[in] p_config how the blocks are delivered.
+ * @param[in] p_context passed to the routine.
+ * @param[in] p_routine receives the blocks.
+ * @return returns a handle to the source, or NULL if the description is malformed.
+ */
+struct audio_source * audio_source_create_generator(char const * psz_spec, struct audio_source_config const * p_config,
+        void * p_context, audio_source_routine_t p_routine);
+
+/*!
+ * @brief Returns the sampling rate of the blocks, in Hz.
+ */
+unsigned int audio_source_get_sample_rate(struct audio_source const * p_source);
+
+/*!
+ * @brief Returns the number of interleaved channels of the blocks.
+ */
+unsigned int audio_source_get_channels(struct audio_source const * p_source);
+
+/*!
+ * @brief Delivers the blocks from the calling thread.
+ * @details Must not be called while the source is started.
+ * @param[in] p_source a handle to the source.
+ * @param[in] max_blocks number of blocks to deliver.
+ * @return returns number of blocks delivered, fewer than max_blocks only if the tone has ended.
+ */
+uint64_t audio_source_run(struct audio_source * p_source, uint64_t max_blocks);
+
+/*!
+ * @brief Starts the capture thread, which delivers the blocks until stopped or until the tone ends.
+ * @param[in] p_source a handle to the source.
+ * @return returns non zero on success, 0 otherwise.
+ */
+int audio_source_start(struct audio_source * p_source);
+
+/*!
+ * @brief Stops the capture thread.
+ * @details Returns when the thread has finished, so that the routine is not called any more.
+ * @param[in] p_source a handle to the source.
+ * @return returns non zero on success, 0 if the source was not started.
+ */
+int audio_source_stop(struct audio_source * p_source);
+
+/*!
+ * @brief Returns what the source has delivered so far.
+ * @details The counters are updated by the capture thread, so they are exact only when the source is not started.
+ */
+void audio_source_get_stats(struct audio_source const * p_source, struct audio_source_stats * p_stats);
+
+/*!
+ * @brief Destroys the source, stopping it first if it is started.
+ * @param[in] p_source a handle to the source obtained via call to audio_source_create_tone or audio_source_create_generator.
+ */
+void audio_source_destroy(struct audio_source * p_source);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* AUDIO_SOURCE_H_4D0EF2F9_708F_4F97_A0D4_486B2A3B17F2 */
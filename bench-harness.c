@@ -0,0 +1,92 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file bench-harness.c
+ * @brief Micro benchmark harness.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include "bench-harness.h"
+#include "perf-counter-itf.h"
+
+static int compare_doubles(void const * p_left, void const * p_right)
+{
+    double left = *(double const *)p_left;
+    double right = *(double const *)p_right;
+    return left < right ? -1 : (left > right ? 1 : 0);
+}
+
+static void summarize(double * p_samples, unsigned int count, struct bench_result * p_result)
+{
+    unsigned int idx;
+    double sum = 0.0;
+    double squares = 0.0;
+    qsort(p_samples, count, sizeof(double), &compare_doubles);
+    for (idx = 0; idx < count; ++idx)
+        sum += p_samples[idx];
+    p_result->mean_ns_ = sum / count;
+    for (idx = 0; idx < count; ++idx)
+        squares += (p_samples[idx] - p_result->mean_ns_) * (p_samples[idx] - p_result->mean_ns_);
+    p_result->stddev_ns_ = count > 1 ? sqrt(squares / (count - 1)) : 0.0;
+    p_result->min_ns_ = p_samples[0];
+    p_result->max_ns_ = p_samples[count - 1];
+    p_result->median_ns_ = 0 == count % 2 ? (p_samples[count / 2 - 1] + p_samples[count / 2]) / 2.0 : p_samples[count / 2];
+}
+
+int bench_run(struct bench_options const * p_options, struct bench_case const * p_case, struct bench_result * p_result)
+{
+    static double samples[BENCH_MAX_REPETITIONS];
+    struct bench_result result;
+    unsigned int repetitions = min(max(p_options->repetitions_, 1u), (unsigned int)BENCH_MAX_REPETITIONS);
+    unsigned int idx;
+    for (idx = 0; idx < p_options->warmup_; ++idx)
+    {
+        if (!(*p_case->function_)(p_case->p_context_, p_case->iterations_))
+            break;
+    }
+    for (idx = 0; idx < repetitions; ++idx)
+    {
+        uint64_t start = perf_counter_get_monotonic_ns();
+        if (!(*p_case->function_)(p_case->p_context_, p_case->iterations_))
+            break;
+        samples[idx] = (double)(perf_counter_get_monotonic_ns() - start) / p_case->iterations_;
+    }
+    if (idx < repetitions)
+    {
+        fprintf(p_options->fp_output_, "{\"name\":\"%s\",\"params\":\"%s\",\"error\":\"failed\"}\n", p_case->psz_name_, p_case->psz_params_);
+        return 0;
+    }
+    summarize(samples, repetitions, &result);
+    fprintf(p_options->fp_output_, "{\"name\":\"%s\",\"params\":\"%s\",\"iterations\":%u,\"repetitions\":%u,"
+            "\"min_ns\":%.2f,\"median_ns\":%.2f,\"mean_ns\":%.2f,\"stddev_ns\":%.2f,\"max_ns\":%.2f",
+            p_case->psz_name_, p_case->psz_params_, p_case->iterations_, repetitions,
+            result.min_ns_, result.median_ns_, result.mean_ns_, result.stddev_ns_, result.max_ns_);
+    /* The throughput is given for the median, as that is the least disturbed by the outliers. */
+    if (0 != p_case->bytes_ && result.median_ns_ > 0.0)
+        fprintf(p_options->fp_output_, ",\"mb_per_s\":%.2f", (double)p_case->bytes_ * 1000.0 / result.median_ns_);
+    fprintf(p_options->fp_output_, "}\n");
+    fflush(p_options->fp_output_);
+    if (NULL != p_result)
+        *p_result = result;
+    return 1;
+}
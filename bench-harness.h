@@ -0,0 +1,99 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+
+/**
+ * @file bench-harness.h
+ * @brief Micro benchmark harness.
+ * @details Runs a case with warm up and repetitions, and writes the summary as JSON lines, so that the runs can be compared with each other.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+#if !defined BENCH_HARNESS_H_9E21B5D7_4C80_4F3A_A61E_8B0D27F3C594
+#define BENCH_HARNESS_H_9E21B5D7_4C80_4F3A_A61E_8B0D27F3C594
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+#include <stdio.h>
+#include <stddef.h>
+
+/*!
+ * @brief Maximum number of measured repetitions of a single case.
+ */
+#define BENCH_MAX_REPETITIONS (1000)
+
+/*!
+ * @brief Runs the benchmarked operation the given number of times.
+ * @param[in] p_context context of the case.
+ * @param[in] iterations number of times to run the operation.
+ * @return returns non-zero on success, 0 if the operation failed. A failed case is reported, but not measured.
+ */
+typedef int (*BENCH_FUNCTION)(void * p_context, unsigned int iterations);
+
+/*!
+ * @brief Describes a single benchmark case.
+ */
+struct bench_case {
+    char const * psz_name_; /*!< Name of the case, e.g. "fifo". */
+    char const * psz_params_; /*!< Parameters of the case, e.g. "size=1024". */
+    BENCH_FUNCTION function_; /*!< The operation. */
+    void * p_context_; /*!< Passed to the operation. */
+    unsigned int iterations_; /*!< Number of operations timed together as a single repetition. */
+    size_t bytes_; /*!< Number of bytes a single operation processes, 0 if the throughput makes no sense. */
+};
+
+/*!
+ * @brief How the cases are run.
+ */
+struct bench_options {
+    unsigned int warmup_; /*!< Number of repetitions run before the measurement. */
+    unsigned int repetitions_; /*!< Number of measured repetitions, at most BENCH_MAX_REPETITIONS. */
+    FILE * fp_output_; /*!< Where the results go. */
+};
+
+/*!
+ * @brief Summary of the measured repetitions, per a single operation.
+ */
+struct bench_result {
+    double min_ns_; /*!< Fastest repetition. */
+    double median_ns_; /*!< Median repetition. */
+    double mean_ns_; /*!< Average of the repetitions. */
+    double stddev_ns_; /*!< Standard deviation of the repetitions. */
+    double max_ns_; /*!< Slowest repetition. */
+};
+
+/*!
+ * @brief Runs the case and writes its summary as a single JSON line.
+ * @details The warm up repetitions are run first and discarded. Then each repetition times case's iterations_
+ * operations, and the summary is computed over the per operation times of all the repetitions.
+ * @param[in] p_options how to run the case.
+ * @param[in] p_case the case.
+ * @param[out] p_result if not NULL, this structure will be written with the summary.
+ * @return returns non-zero on success, 0 if the case failed.
+ */
+int bench_run(struct bench_options const * p_options, struct bench_case const * p_case, struct bench_result * p_result);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* BENCH_HARNESS_H_9E21B5D7_4C80_4F3A_A61E_8B0D27F3C594 */
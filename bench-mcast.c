@@ -0,0 +1,691 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file bench-mcast.c
+ * @brief Benchmarks of the buffers, the sample conversions, the resampling and the socket I/O.
+ * @details Each case is written as a single JSON line. Run with 'make bench'.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include <getopt.h>
+#include "bench-harness.h"
+#include "circular-buffer-uint8.h"
+#include "audio-codec.h"
+#include "resampler.h"
+#include "mcast-packet.h"
+#include "file-source.h"
+#include "tone-generator.h"
+#include "audio-source.h"
+
+#if !defined BENCH_CFLAGS
+/*!
+ * @brief Compiler flags the benchmark was built with, recorded with the results.
+ */
+#   define BENCH_CFLAGS "unknown"
+#endif
+
+/*!
+ * @brief Number of samples converted or resampled by a single operation.
+ */
+#define BENCH_BLOCK (1024)
+
+/*!
+ * @brief Number of datagrams sent, and then received, by a single loopback operation.
+ */
+#define BENCH_UDP_BURST (32)
+
+/*!
+ * @brief Size of a single loopback datagram.
+ */
+#define BENCH_UDP_SIZE (1024)
+
+/*!
+ * @brief Path of the file the file source cases read. It is created, and removed, by the benchmark.
+ */
+#define BENCH_FILE_PATH "bench-mcast-file-source.dat"
+
+/*!
+ * @brief Size of the file the file source cases read.
+ */
+#define BENCH_FILE_SIZE (16 * 1024 * 1024)
+
+/*!
+ * @brief Number of bytes taken from the file source at a time, about what a single packet takes.
+ */
+#define BENCH_FILE_STEP (4096)
+
+/*!
+ * @brief Stands for mapping the whole file with MAP_POPULATE, the way the sender used to, in the startup case.
+ */
+#define BENCH_FILE_POPULATE (-1)
+
+/*!
+ * @brief Number of generators filled by a single operation of the channels case, i.e. the streams of a load test.
+ */
+#define BENCH_TONE_CHANNELS (1000)
+
+/*!
+ * @brief Number of frames each of the generators fills in the channels case, i.e. a single packet.
+ */
+#define BENCH_TONE_FRAMES (256)
+
+/*!
+ * @brief Number of frames of each block captured by the audio source case, i.e. a single packet of the sender.
+ */
+#define BENCH_SOURCE_FRAMES (256)
+
+static struct fifo_context {
+    struct fifo_circular_buffer * p_fifo_; /*!< The queue. */
+    uint32_t size_; /*!< Number of bytes pushed, then fetched, by a single operation. */
+} g_fifo;
+
+static uint8_t g_bytes[4096];
+static int16_t g_samples[BENCH_BLOCK];
+static float g_floats[BENCH_BLOCK];
+static uint8_t g_packed[3 * BENCH_BLOCK];
+static float g_resampled[8 * BENCH_BLOCK]; /* Room for the upsampling from 8000 to 48000. */
+
+static int bench_fifo(void * p_context, unsigned int iterations)
+{
+    struct fifo_context * p_fifo = (struct fifo_context *)p_context;
+    unsigned int idx;
+    for (idx = 0; idx < iterations; ++idx)
+    {
+        uint32_t count = p_fifo->size_;
+        fifo_circular_buffer_push_item(p_fifo->p_fifo_, g_bytes, p_fifo->size_);
+        fifo_circular_buffer_fetch_item(p_fifo->p_fifo_, g_bytes, &count);
+        if (count != p_fifo->size_)
+            return 0;
+    }
+    return 1;
+}
+
+static int bench_int16_to_float(void * p_context, unsigned int iterations)
+{
+    unsigned int idx;
+    for (idx = 0; idx < iterations; ++idx)
+        audio_codec_int16_to_float(g_samples, g_floats, BENCH_BLOCK);
+    return 1;
+}
+
+static int bench_float_to_int16(void * p_context, unsigned int iterations)
+{
+    unsigned int idx;
+    for (idx = 0; idx < iterations; ++idx)
+        audio_codec_float_to_int16(g_floats, g_samples, BENCH_BLOCK);
+    return 1;
+}
+
+static int bench_float_to_int16_dither(void * p_context, unsigned int iterations)
+{
+    uint32_t dither = 1;
+    unsigned int idx;
+    for (idx = 0; idx < iterations; ++idx)
+        audio_codec_float_to_int16_dither(g_floats, g_samples, BENCH_BLOCK, &dither);
+    return 1;
+}
+
+static int bench_int24_to_float(void * p_context, unsigned int iterations)
+{
+    unsigned int idx;
+    for (idx = 0; idx < iterations; ++idx)
+        audio_codec_int24_to_float(g_packed, g_floats, BENCH_BLOCK);
+    return 1;
+}
+
+static int bench_float_to_int24(void * p_context, unsigned int iterations)
+{
+    unsigned int idx;
+    for (idx = 0; idx < iterations; ++idx)
+        audio_codec_float_to_int24(g_floats, g_packed, BENCH_BLOCK);
+    return 1;
+}
+
+static int bench_resample(void * p_context, unsigned int iterations)
+{
+    struct resampler * p_resampler = (struct resampler *)p_context;
+    unsigned int idx;
+    for (idx = 0; idx < iterations; ++idx)
+        resampler_process(p_resampler, g_floats, BENCH_BLOCK, g_resampled, COUNTOF_ARRAY(g_resampled));
+    return 1;
+}
+
+static int bench_packet(void * p_context, unsigned int iterations)
+{
+    struct mcast_packet_header header;
+    struct mcast_packet_header decoded;
+    unsigned int idx;
+    ZeroMemory(&header, sizeof(header));
+    header.version_ = MCAST_PACKET_VERSION;
+    header.ssrc_ = 0x12345678;
+    for (idx = 0; idx < iterations; ++idx)
+    {
+        uint64_t send_time;
+        ++header.seq_;
+        if (0 == mcast_packet_header_encode_timed(&header, idx, g_bytes, sizeof(g_bytes))
+                || 0 == mcast_packet_header_decode(&decoded, g_bytes, sizeof(g_bytes))
+                || !mcast_packet_header_get_send_time(&decoded, g_bytes, &send_time))
+            return 0;
+    }
+    return 1;
+}
+
+/*!
+ * @brief A pair of sockets connected over the loopback interface.
+ */
+static struct udp_context {
+    int sender_; /*!< Sends the datagrams. */
+    int receiver_; /*!< Receives the datagrams. */
+} g_udp;
+
+static int bench_udp(void * p_context, unsigned int iterations)
+{
+    struct udp_context * p_udp = (struct udp_context *)p_context;
+    unsigned int idx;
+    for (idx = 0; idx < iterations; ++idx)
+    {
+        unsigned int datagram;
+        for (datagram = 0; datagram < BENCH_UDP_BURST; ++datagram)
+        {
+            if (BENCH_UDP_SIZE != send(p_udp->sender_, g_bytes, BENCH_UDP_SIZE, 0))
+                return 0;
+        }
+        for (datagram = 0; datagram < BENCH_UDP_BURST; ++datagram)
+        {
+            if (BENCH_UDP_SIZE != recv(p_udp->receiver_, g_bytes, sizeof(g_bytes), 0))
+                return 0;
+        }
+    }
+    return 1;
+}
+
+static int bench_sine_libm(void * p_context, unsigned int iterations)
+{
+    static double phase;
+    double const increment = 440.0 / 44100.0;
+    unsigned int idx;
+    for (idx = 0; idx < iterations; ++idx)
+    {
+        unsigned int sample;
+        for (sample = 0; sample < BENCH_BLOCK; ++sample)
+        {
+            g_floats[sample] = 0.5f * sinf((float)(2.0 * M_PI * phase));
+            phase += increment;
+            phase -= floor(phase);
+        }
+    }
+    return 1;
+}
+
+static int bench_tone(void * p_context, unsigned int iterations)
+{
+    unsigned int idx;
+    for (idx = 0; idx < iterations; ++idx)
+        tone_generator_fill_float((struct tone_generator *)p_context, g_floats, BENCH_BLOCK);
+    return 1;
+}
+
+static int bench_tone_channels(void * p_context, unsigned int iterations)
+{
+    struct tone_generator ** pp_generators = (struct tone_generator **)p_context;
+    unsigned int idx;
+    for (idx = 0; idx < iterations; ++idx)
+    {
+        unsigned int channel;
+        for (channel = 0; channel < BENCH_TONE_CHANNELS; ++channel)
+            tone_generator_fill(pp_generators[channel], g_samples, BENCH_TONE_FRAMES);
+    }
+    return 1;
+}
+
+/*!
+ * @brief Runs the case unless the filter excludes it.
+ */
+/*!
+ * @brief Sends the captured block as the sender would, except that the datagram is only built.
+ */
+static void packetize_block(void * p_context, void * data, size_t data_size)
+{
+    struct mcast_packet_header * p_header = (struct mcast_packet_header *)p_context;
+    size_t offset;
+    ++p_header->seq_;
+    offset = mcast_packet_header_encode_timed(p_header, p_header->seq_, g_bytes, sizeof(g_bytes));
+    if (0 != offset && offset + data_size <= sizeof(g_bytes))
+        memcpy(&g_bytes[offset], data, data_size);
+    p_header->timestamp_ += BENCH_SOURCE_FRAMES;
+}
+
+static int bench_audio_source(void * p_context, unsigned int iterations)
+{
+    return iterations == audio_source_run((struct audio_source *)p_context, iterations);
+}
+
+static int run(struct bench_options const * p_options, char const * psz_filter, struct bench_case const * p_case)
+{
+    if (NULL != psz_filter && NULL == strstr(p_case->psz_name_, psz_filter))
+        return 1;
+    return bench_run(p_options, p_case, NULL);
+}
+
+/*!
+ * @brief Opens the file and takes its first bytes, i.e. what the sender does before the first packet.
+ */
+static int bench_file_startup(void * p_context, unsigned int iterations)
+{
+    int const strategy = *(int const *)p_context;
+    unsigned int idx;
+    for (idx = 0; idx < iterations; ++idx)
+    {
+        if (BENCH_FILE_POPULATE == strategy)
+        {
+            int fd = open(BENCH_FILE_PATH, O_RDONLY);
+            void * p_map = fd >= 0 ? mmap(NULL, BENCH_FILE_SIZE, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0) : MAP_FAILED;
+            if (fd >= 0)
+                close(fd);
+            if (MAP_FAILED == p_map)
+                return 0;
+            g_bytes[0] ^= *(uint8_t const *)p_map;
+            munmap(p_map, BENCH_FILE_SIZE);
+        }
+        else
+        {
+            size_t size;
+            struct file_source * p_source = file_source_open(BENCH_FILE_PATH, strategy);
+            uint8_t const * p_bytes = NULL != p_source ? (uint8_t const *)file_source_get(p_source, 0, BENCH_FILE_STEP, &size) : NULL;
+            if (NULL == p_bytes)
+            {
+                file_source_close(p_source);
+                return 0;
+            }
+            g_bytes[0] ^= p_bytes[0];
+            file_source_close(p_source);
+        }
+    }
+    return 1;
+}
+
+/*!
+ * @brief Takes the whole file from the source, touching a byte of each step so that the pages are really read.
+ */
+static int stream_file(struct file_source * p_source)
+{
+    uint64_t offset = 0;
+    while (offset < BENCH_FILE_SIZE)
+    {
+        size_t size;
+        uint8_t const * p_bytes = (uint8_t const *)file_source_get(p_source, offset, BENCH_FILE_STEP, &size);
+        if (NULL == p_bytes)
+            return 0;
+        g_bytes[0] ^= p_bytes[size - 1];
+        offset += size;
+    }
+    return 1;
+}
+
+static int bench_file_stream(void * p_context, unsigned int iterations)
+{
+    struct file_source * p_source = (struct file_source *)p_context;
+    unsigned int idx;
+    for (idx = 0; idx < iterations; ++idx)
+    {
+        if (!stream_file(p_source))
+            return 0;
+    }
+    return 1;
+}
+
+/*!
+ * @brief Returns the resident set size of the process, in kB.
+ */
+static unsigned long get_rss_kb(void)
+{
+    unsigned long pages = 0;
+    unsigned long resident = 0;
+    FILE * fp = fopen("/proc/self/statm", "r");
+    if (NULL != fp)
+    {
+        if (2 != fscanf(fp, "%lu %lu", &pages, &resident))
+            resident = 0;
+        fclose(fp);
+    }
+    return resident * (unsigned long)(sysconf(_SC_PAGESIZE) / 1024);
+}
+
+static int write_bench_file(void)
+{
+    unsigned int idx;
+    int result = 1;
+    FILE * fp = fopen(BENCH_FILE_PATH, "wb");
+    if (NULL == fp)
+        return 0;
+    for (idx = 0; idx < sizeof(g_bytes); ++idx)
+        g_bytes[idx] = (uint8_t)idx;
+    for (idx = 0; idx < BENCH_FILE_SIZE / sizeof(g_bytes) && result; ++idx)
+        result = 1 == fwrite(g_bytes, sizeof(g_bytes), 1, fp);
+    return 0 == fclose(fp) && result;
+}
+
+/*!
+ * @brief Runs the startup and the streaming cases of the strategy, then writes how much the resident set grew.
+ */
+static int run_file_source(struct bench_options const * p_options, char const * psz_filter, int strategy)
+{
+    static int strategies[] = { FILE_SOURCE_AUTO, FILE_SOURCE_MMAP, FILE_SOURCE_READAHEAD, FILE_SOURCE_PREAD };
+    struct bench_case bench;
+    struct file_source * p_source;
+    unsigned long rss_base;
+    unsigned long rss_open;
+    char params[128];
+    int result;
+    snprintf(params, sizeof(params), "strategy=%s,size=%u", file_source_get_strategy_name(strategy), BENCH_FILE_SIZE);
+    bench.psz_name_ = "file_source_startup";
+    bench.psz_params_ = params;
+    bench.function_ = &bench_file_startup;
+    bench.p_context_ = &strategies[strategy];
+    bench.iterations_ = 1;
+    bench.bytes_ = 0;
+    result = run(p_options, psz_filter, &bench);
+    if (NULL != psz_filter && NULL == strstr("file_source_stream", psz_filter))
+        return result;
+    rss_base = get_rss_kb();
+    p_source = file_source_open(BENCH_FILE_PATH, strategy);
+    if (NULL == p_source)
+        return 0;
+    rss_open = get_rss_kb();
+    bench.psz_name_ = "file_source_stream";
+    bench.function_ = &bench_file_stream;
+    bench.p_context_ = p_source;
+    bench.bytes_ = BENCH_FILE_SIZE;
+    result = bench_run(p_options, &bench, NULL) && result;
+    /* Measured with the source still open, i.e. with whatever it keeps after the whole file went through it. The
+     * resident set may also shrink meanwhile, hence the signed deltas. */
+    fprintf(p_options->fp_output_, "{\"name\":\"file_source_rss\",\"params\":\"%s\",\"rss_open_kb\":%ld,\"rss_streamed_kb\":%ld}\n",
+            params, (long)rss_open - (long)rss_base, (long)get_rss_kb() - (long)rss_base);
+    file_source_close(p_source);
+    return result;
+}
+
+static int udp_open(struct udp_context * p_udp)
+{
+    struct sockaddr_in address;
+    socklen_t address_size = sizeof(address);
+    struct timeval timeout = { 1, 0 };
+    p_udp->receiver_ = socket(AF_INET, SOCK_DGRAM, 0);
+    p_udp->sender_ = socket(AF_INET, SOCK_DGRAM, 0);
+    if (p_udp->receiver_ < 0 || p_udp->sender_ < 0)
+        return 0;
+    ZeroMemory(&address, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    /* A lost datagram fails the case instead of hanging it. */
+    return 0 == setsockopt(p_udp->receiver_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout))
+        && 0 == bind(p_udp->receiver_, (struct sockaddr const *)&address, sizeof(address))
+        && 0 == getsockname(p_udp->receiver_, (struct sockaddr *)&address, &address_size)
+        && 0 == connect(p_udp->sender_, (struct sockaddr const *)&address, sizeof(address));
+}
+
+static void udp_close(struct udp_context * p_udp)
+{
+    if (p_udp->sender_ >= 0)
+        close(p_udp->sender_);
+    if (p_udp->receiver_ >= 0)
+        close(p_udp->receiver_);
+}
+
+/*!
+ * @brief Runs the tone generator cases: each kind of signal, the libm sine for comparison, and one packet of each of
+ * many distinct mono streams, as a load test would send them.
+ */
+static int run_tone_generator(struct bench_options const * p_options, char const * psz_filter)
+{
+    static char const * const signals[] = { "sine:440", "multi:440:660:880:1100", "sweep:100:8000:5", "pink", "seq:1000:250" };
+    static struct tone_generator * generators[BENCH_TONE_CHANNELS];
+    struct bench_case bench;
+    char params[128];
+    struct tone_generator_config config;
+    unsigned int idx;
+    int failed = 0;
+    snprintf(params, sizeof(params), "samples=%u", BENCH_BLOCK);
+    bench.psz_name_ = "sine_libm";
+    bench.psz_params_ = params;
+    bench.function_ = &bench_sine_libm;
+    bench.p_context_ = NULL;
+    bench.iterations_ = 100;
+    bench.bytes_ = BENCH_BLOCK * sizeof(float);
+    failed |= !run(p_options, psz_filter, &bench);
+    for (idx = 0; idx < COUNTOF_ARRAY(signals); ++idx)
+    {
+        struct tone_generator * p_generator = NULL;
+        if (tone_generator_parse(&config, signals[idx]))
+            p_generator = tone_generator_create(&config);
+        if (NULL == p_generator)
+            return 0;
+        snprintf(params, sizeof(params), "signal=%s,samples=%u", signals[idx], BENCH_BLOCK);
+        bench.psz_name_ = "tone_generator";
+        bench.function_ = &bench_tone;
+        bench.p_context_ = p_generator;
+        failed |= !run(p_options, psz_filter, &bench);
+        tone_generator_destroy(p_generator);
+    }
+    /* Each stream has its own frequency, so that they are all distinct. */
+    tone_generator_parse(&config, "sine:100");
+    config.channels_ = 1;
+    for (idx = 0; idx < BENCH_TONE_CHANNELS; ++idx)
+    {
+        config.frequencies_[0] = 100.0f + (float)idx;
+        generators[idx] = tone_generator_create(&config);
+        if (NULL == generators[idx])
+            failed = 1;
+    }
+    snprintf(params, sizeof(params), "channels=%u,frames=%u", BENCH_TONE_CHANNELS, BENCH_TONE_FRAMES);
+    bench.psz_name_ = "tone_generator_channels";
+    bench.function_ = &bench_tone_channels;
+    bench.p_context_ = generators;
+    bench.iterations_ = 1;
+    bench.bytes_ = BENCH_TONE_CHANNELS * BENCH_TONE_FRAMES * sizeof(int16_t);
+    if (!failed)
+        failed |= !run(p_options, psz_filter, &bench);
+    for (idx = 0; idx < BENCH_TONE_CHANNELS; ++idx)
+        tone_generator_destroy(generators[idx]);
+    return !failed;
+}
+
+static void usage(char const * psz_name)
+{
+    fprintf(stderr, "Usage: %s [-w warmup] [-r repetitions] [-f filter] [-o output]\n"
+            "  -w  number of repetitions discarded before the measurement, default 5\n"
+            "  -r  number of measured repetitions, default 50\n"
+            "  -f  runs only the cases whose name contains the filter\n"
+            "  -o  writes the results to the file instead of the standard output\n", psz_name);
+}
+
+int main(int argc, char ** argv)
+{
+    static unsigned int const fifo_sizes[] = { 64, 256, 1024, 4096 };
+    static unsigned int const rates[][2] = { { 44100, 8000 }, { 44100, 16000 }, { 48000, 44100 }, { 8000, 44100 } };
+    struct bench_options options;
+    struct bench_case bench;
+    char params[128];
+    char const * psz_filter = NULL;
+    int populate = BENCH_FILE_POPULATE;
+    int failed = 0;
+    int option;
+    unsigned int idx;
+    options.warmup_ = 5;
+    options.repetitions_ = 50;
+    options.fp_output_ = stdout;
+    while (-1 != (option = getopt(argc, argv, "w:r:f:o:h")))
+    {
+        switch (option)
+        {
+            case 'w':
+                options.warmup_ = (unsigned int)strtoul(optarg, NULL, 10);
+                break;
+            case 'r':
+                options.repetitions_ = (unsigned int)strtoul(optarg, NULL, 10);
+                break;
+            case 'f':
+                psz_filter = optarg;
+                break;
+            case 'o':
+                options.fp_output_ = fopen(optarg, "a");
+                if (NULL == options.fp_output_)
+                {
+                    fprintf(stderr, "%4.4u %s : %s %d %s\n", __LINE__, __FILE__, optarg, errno, strerror(errno));
+                    return EXIT_FAILURE;
+                }
+                break;
+            default:
+                usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    for (idx = 0; idx < BENCH_BLOCK; ++idx)
+    {
+        g_samples[idx] = (int16_t)(16000.0 * sin(2.0 * M_PI * 440.0 * idx / 44100.0));
+        g_floats[idx] = g_samples[idx] / 32768.0f;
+    }
+    /* Everything needed to tell apart the runs made on different machines, builds or revisions. */
+    fprintf(options.fp_output_, "{\"name\":\"meta\",\"time\":%lu,\"cflags\":\"%s\",\"resampler\":\"%s\",\"warmup\":%u,\"repetitions\":%u}\n",
+            (unsigned long)time(NULL), BENCH_CFLAGS, resampler_get_engine_name(), options.warmup_, options.repetitions_);
+
+    g_fifo.p_fifo_ = circular_buffer_create_with_size(16);
+    for (idx = 0; idx < COUNTOF_ARRAY(fifo_sizes) && NULL != g_fifo.p_fifo_; ++idx)
+    {
+        g_fifo.size_ = fifo_sizes[idx];
+        snprintf(params, sizeof(params), "size=%u", fifo_sizes[idx]);
+        bench.psz_name_ = "fifo_push_fetch";
+        bench.psz_params_ = params;
+        bench.function_ = &bench_fifo;
+        bench.p_context_ = &g_fifo;
+        bench.iterations_ = 1000;
+        bench.bytes_ = fifo_sizes[idx];
+        failed |= !run(&options, psz_filter, &bench);
+    }
+    fifo_circular_buffer_delete(g_fifo.p_fifo_);
+
+    snprintf(params, sizeof(params), "samples=%u", BENCH_BLOCK);
+    bench.psz_name_ = "int16_to_float";
+    bench.psz_params_ = params;
+    bench.function_ = &bench_int16_to_float;
+    bench.p_context_ = NULL;
+    bench.iterations_ = 1000;
+    bench.bytes_ = BENCH_BLOCK * sizeof(int16_t);
+    failed |= !run(&options, psz_filter, &bench);
+    bench.psz_name_ = "float_to_int16";
+    bench.function_ = &bench_float_to_int16;
+    failed |= !run(&options, psz_filter, &bench);
+    bench.psz_name_ = "float_to_int16_dither";
+    bench.function_ = &bench_float_to_int16_dither;
+    failed |= !run(&options, psz_filter, &bench);
+    audio_codec_float_to_int24(g_floats, g_packed, BENCH_BLOCK);
+    bench.psz_name_ = "int24_to_float";
+    bench.function_ = &bench_int24_to_float;
+    bench.bytes_ = sizeof(g_packed);
+    failed |= !run(&options, psz_filter, &bench);
+    bench.psz_name_ = "float_to_int24";
+    bench.function_ = &bench_float_to_int24;
+    failed |= !run(&options, psz_filter, &bench);
+
+    for (idx = 0; idx < COUNTOF_ARRAY(rates); ++idx)
+    {
+        struct resampler * p_resampler = resampler_create(rates[idx][0], rates[idx][1]);
+        if (NULL == p_resampler)
+            continue;
+        snprintf(params, sizeof(params), "engine=%s,in=%u,out=%u,samples=%u",
+                resampler_get_engine_name(), rates[idx][0], rates[idx][1], BENCH_BLOCK);
+        bench.psz_name_ = "resample";
+        bench.psz_params_ = params;
+        bench.function_ = &bench_resample;
+        bench.p_context_ = p_resampler;
+        bench.iterations_ = 20;
+        bench.bytes_ = BENCH_BLOCK * sizeof(float);
+        failed |= !run(&options, psz_filter, &bench);
+        resampler_destroy(p_resampler);
+    }
+
+    bench.psz_name_ = "packet_encode_decode";
+    bench.psz_params_ = "timed";
+    bench.function_ = &bench_packet;
+    bench.p_context_ = NULL;
+    bench.iterations_ = 10000;
+    bench.bytes_ = 0;
+    failed |= !run(&options, psz_filter, &bench);
+
+    failed |= !run_tone_generator(&options, psz_filter);
+
+    {
+        /* Captured as fast as possible, so that the cost of the capture and of building the packets is measured. */
+        struct audio_source_config config = { BENCH_SOURCE_FRAMES, AUDIO_SOURCE_AS_FAST_AS_POSSIBLE, 0 };
+        struct mcast_packet_header header;
+        struct audio_source * p_source = audio_source_create_generator("multi:440:660", &config, &header, &packetize_block);
+        ZeroMemory(&header, sizeof(header));
+        header.version_ = MCAST_PACKET_VERSION;
+        header.ssrc_ = 0x12345678;
+        snprintf(params, sizeof(params), "signal=multi:440:660,frames=%u", BENCH_SOURCE_FRAMES);
+        bench.psz_name_ = "audio_source_packetize";
+        bench.psz_params_ = params;
+        bench.function_ = &bench_audio_source;
+        bench.p_context_ = p_source;
+        bench.iterations_ = 100;
+        bench.bytes_ = BENCH_SOURCE_FRAMES * 2 * sizeof(int16_t);
+        failed |= NULL == p_source || !run(&options, psz_filter, &bench);
+        audio_source_destroy(p_source);
+    }
+
+    if (write_bench_file())
+    {
+        /* The file was just written, so all the cases read it from the page cache. */
+        bench.psz_name_ = "file_source_startup";
+        bench.psz_params_ = "strategy=populate";
+        bench.function_ = &bench_file_startup;
+        bench.p_context_ = &populate;
+        bench.iterations_ = 1;
+        bench.bytes_ = 0;
+        failed |= !run(&options, psz_filter, &bench);
+        failed |= !run_file_source(&options, psz_filter, FILE_SOURCE_MMAP);
+        failed |= !run_file_source(&options, psz_filter, FILE_SOURCE_READAHEAD);
+        failed |= !run_file_source(&options, psz_filter, FILE_SOURCE_PREAD);
+    }
+    else
+        fprintf(stderr, "%4.4u %s : %d %s\n", __LINE__, __FILE__, errno, strerror(errno));
+    unlink(BENCH_FILE_PATH);
+
+    if (udp_open(&g_udp))
+    {
+        snprintf(params, sizeof(params), "burst=%u,size=%u", BENCH_UDP_BURST, BENCH_UDP_SIZE);
+        bench.psz_name_ = "udp_loopback";
+        bench.psz_params_ = params;
+        bench.function_ = &bench_udp;
+        bench.p_context_ = &g_udp;
+        bench.iterations_ = 10;
+        bench.bytes_ = BENCH_UDP_BURST * BENCH_UDP_SIZE;
+        failed |= !run(&options, psz_filter, &bench);
+    }
+    else
+        fprintf(stderr, "%4.4u %s : %d %s\n", __LINE__, __FILE__, errno, strerror(errno));
+    udp_close(&g_udp);
+    if (stdout != options.fp_output_)
+        fclose(options.fp_output_);
+    return failed ? EXIT_FAILURE : 0;
+}
@@ -132,17 +132,26 @@ int debug_outputln_bufferedA(const char * formatString, ...)
 
 #	include <syslog.h>
 #	include <string.h>
+#	include <pthread.h>
 
+/*!
+ * @brief Formats the line and writes it, with its new line, in a single call.
+ * @details The line is formatted on the stack, so that the calls from different threads do not share a buffer, and
+ * the single fputs() keeps their lines from interleaving. Lines that do not fit are cut short.
+ */
 static int debug_outputlnA_impl(const char * formatString, va_list args)
 {
+	char line[OUTPUT_BUFFER_LEN + 1];
 	int chars_printed;
-	chars_printed = vsnprintf(g_outputBuffer, OUTPUT_BUFFER_LEN, formatString, args);
-	if (chars_printed>0)
-    {
-		fprintf(stderr, "%s", g_outputBuffer);
-		return 1;
-    }
-	return 0;
+	size_t length;
+	chars_printed = vsnprintf(line, OUTPUT_BUFFER_LEN, formatString, args);
+	if (chars_printed < 0)
+		return 0;
+	length = min((size_t)chars_printed, (size_t)OUTPUT_BUFFER_LEN - 1);
+	line[length++] = '\n';
+	line[length] = '\0';
+	fputs(line, stderr);
+	return 1;
 }
 
 void debug_output_flush(void)
@@ -184,13 +193,531 @@ int debug_outputln_bufferedA(const char * formatString, ...)
 }
 
 
+
+/*!
+ * @brief Number of records in each per thread ring. Must be a power of 2.
+ */
+#define ASYNC_RING_RECORDS (128)
+
+/*!
+ * @brief Maximum number of arguments a single asynchronous record can carry.
+ */
+#define ASYNC_MAX_ARGS (16)
+
+/*!
+ * @brief Number of bytes each record has for copies of its string arguments.
+ */
+#define ASYNC_STRINGS_SIZE (OUTPUT_BUFFER_LEN)
+
+/*!
+ * @brief How long the writer thread sleeps when all the rings are empty, in nanoseconds.
+ */
+#define ASYNC_IDLE_SLEEP_NS (1000000)
+
+/*!
+ * @brief Type of a captured argument.
+ */
+enum async_arg_type {
+    ASYNC_ARG_SIGNED,
+    ASYNC_ARG_UNSIGNED,
+    ASYNC_ARG_DOUBLE,
+    ASYNC_ARG_POINTER,
+    ASYNC_ARG_STRING
+};
+
+/*!
+ * @brief A single captured argument.
+ */
+struct async_arg {
+    enum async_arg_type type_; /*!< Tells which member of the union below is valid. */
+    union {
+        intmax_t signed_; /*!< Value of any signed integer. */
+        uintmax_t unsigned_; /*!< Value of any unsigned integer, including characters. */
+        double double_; /*!< Value of a floating point number. */
+        void const * pointer_; /*!< Value of a pointer. */
+        size_t string_offset_; /*!< Offset of the string copy in async_record::strings_. */
+    } u_;
+};
+
+/*!
+ * @brief A log record, as written by the producer.
+ * @details The producer only captures the arguments, formatting is left to the writer thread. The format string
+ * is expected to be a literal, so only the pointer to it is kept. If format_ is NULL, the strings_ member
+ * holds the already formatted text.
+ */
+struct async_record {
+    char const * format_; /*!< Format string of the record. */
+    unsigned int args_count_; /*!< Number of valid entries in args_. */
+    size_t strings_used_; /*!< Number of bytes of strings_ in use. */
+    struct async_arg args_[ASYNC_MAX_ARGS]; /*!< Captured arguments, in the order they are used by the format. */
+    char strings_[ASYNC_STRINGS_SIZE]; /*!< Copies of the string arguments. */
+};
+
+/*!
+ * @brief Single producer, single consumer ring of records.
+ * @details Each producing thread owns one ring, the writer thread is the only consumer of all of them.
+ * When the owning thread exits, the ring is released and may be claimed by another thread.
+ */
+struct async_ring {
+    unsigned int head_; /*!< Free running index of the next record to consume. Written by the consumer only. */
+    unsigned int tail_; /*!< Free running index of the next free record. Written by the producer only. */
+    int owned_; /*!< Non-zero if some thread produces into this ring. */
+    uint64_t dropped_; /*!< Number of records dropped because the ring was full. Written by the producer only. */
+    struct async_ring * next_; /*!< Next ring on the list of all rings. */
+    struct async_record records_[ASYNC_RING_RECORDS]; /*!< The records. */
+};
+
+/*!
+ * @brief List of all the rings ever created. Rings are only ever prepended to it.
+ */
+static struct async_ring * g_async_rings;
+
+/*!
+ * @brief Non-zero if the writer thread is running and debug_outputlnA is asynchronous.
+ */
+static int g_async_running;
+
+/*!
+ * @brief Non-zero if the writer thread is to exit.
+ */
+static int g_async_stop;
+
+/*!
+ * @brief The writer thread.
+ */
+static pthread_t g_async_thread;
+
+/*!
+ * @brief Ensures that the ring of an exiting thread is released.
+ */
+static pthread_key_t g_async_key;
+
+/*!
+ * @brief Makes sure g_async_key is created once.
+ */
+static pthread_once_t g_async_key_once = PTHREAD_ONCE_INIT;
+
+/*!
+ * @brief Ring of the calling thread.
+ */
+static THREAD_LOCAL struct async_ring * g_async_ring;
+
+static void async_release_ring(void * p_param)
+{
+    struct async_ring * p_ring = (struct async_ring *)p_param;
+    __atomic_store_n(&p_ring->owned_, 0, __ATOMIC_RELEASE);
+}
+
+static void async_create_key(void)
+{
+    pthread_key_create(&g_async_key, &async_release_ring);
+}
+
+/*!
+ * @brief Returns the ring of the calling thread, claims or creates one if needed.
+ */
+static struct async_ring * async_get_ring(void)
+{
+    struct async_ring * p_ring = g_async_ring;
+    if (NULL != p_ring)
+        return p_ring;
+    for (p_ring = __atomic_load_n(&g_async_rings, __ATOMIC_ACQUIRE); NULL != p_ring; p_ring = p_ring->next_)
+    {
+        int expected = 0;
+        if (__atomic_compare_exchange_n(&p_ring->owned_, &expected, 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+            break;
+    }
+    if (NULL == p_ring)
+    {
+        p_ring = (struct async_ring *)calloc(1, sizeof(struct async_ring));
+        if (NULL == p_ring)
+            return NULL;
+        p_ring->owned_ = 1;
+        p_ring->next_ = __atomic_load_n(&g_async_rings, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&g_async_rings, &p_ring->next_, p_ring, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+            ;
+    }
+    pthread_once(&g_async_key_once, &async_create_key);
+    pthread_setspecific(g_async_key, p_ring);
+    g_async_ring = p_ring;
+    return p_ring;
+}
+
+/*!
+ * @brief Copies a string argument into the record.
+ * @return returns non-zero on success, 0 if there is no room left for the string.
+ */
+static int async_put_string(struct async_record * p_record, struct async_arg * p_arg, char const * psz_string, int precision)
+{
+    size_t length;
+    if (NULL == psz_string)
+        psz_string = "(null)";
+    length = precision >= 0 ? strnlen(psz_string, (size_t)precision) : strlen(psz_string);
+    if (p_record->strings_used_ + length + 1 > ASYNC_STRINGS_SIZE)
+        return 0;
+    p_arg->type_ = ASYNC_ARG_STRING;
+    p_arg->u_.string_offset_ = p_record->strings_used_;
+    CopyMemory(&p_record->strings_[p_record->strings_used_], psz_string, length);
+    p_record->strings_[p_record->strings_used_ + length] = '\0';
+    p_record->strings_used_ += length + 1;
+    return 1;
+}
+
+/*!
+ * @brief Captures the arguments of the format into the record.
+ * @details Walks the format the same way printf does, and fetches each argument with the type the conversion
+ * expects. Strings are copied, as they may not outlive the call.
+ * @return returns non-zero on success, 0 if the format uses a conversion that is not supported, or has too many
+ * or too long arguments.
+ */
+static int async_capture(struct async_record * p_record, char const * psz_format, va_list args)
+{
+    char const * p = psz_format;
+    p_record->format_ = psz_format;
+    p_record->args_count_ = 0;
+    p_record->strings_used_ = 0;
+    while (NULL != (p = strchr(p, '%')))
+    {
+        int precision = -1;
+        char length = 0;
+        struct async_arg * p_arg;
+        ++p;
+        if ('%' == *p)
+        {
+            ++p;
+            continue;
+        }
+        p += strspn(p, "-+ #0'");
+        if ('*' == *p)
+        {
+            if (p_record->args_count_ >= ASYNC_MAX_ARGS)
+                return 0;
+            p_arg = &p_record->args_[p_record->args_count_++];
+            p_arg->type_ = ASYNC_ARG_SIGNED;
+            p_arg->u_.signed_ = va_arg(args, int);
+            ++p;
+        }
+        else
+            p += strspn(p, "0123456789");
+        if ('.' == *p)
+        {
+            ++p;
+            if ('*' == *p)
+            {
+                if (p_record->args_count_ >= ASYNC_MAX_ARGS)
+                    return 0;
+                precision = va_arg(args, int);
+                p_arg = &p_record->args_[p_record->args_count_++];
+                p_arg->type_ = ASYNC_ARG_SIGNED;
+                p_arg->u_.signed_ = precision;
+                ++p;
+            }
+            else
+            {
+                precision = atoi(p);
+                p += strspn(p, "0123456789");
+            }
+        }
+        /* Only the last letter of the length modifier matters, except for 'll' and 'hh'. */
+        while ('\0' != *p && NULL != strchr("hljztL", *p))
+        {
+            length = (length == *p) ? (char)(*p - 'a' + 'A') : *p;
+            ++p;
+        }
+        if (p_record->args_count_ >= ASYNC_MAX_ARGS)
+            return 0;
+        p_arg = &p_record->args_[p_record->args_count_++];
+        switch (*p)
+        {
+            case 'd':
+            case 'i':
+                p_arg->type_ = ASYNC_ARG_SIGNED;
+                switch (length)
+                {
+                    case 'l': p_arg->u_.signed_ = va_arg(args, long); break;
+                    case 'L': p_arg->u_.signed_ = va_arg(args, long long); break;
+                    case 'j': p_arg->u_.signed_ = va_arg(args, intmax_t); break;
+                    case 'z': p_arg->u_.signed_ = va_arg(args, ssize_t); break;
+                    case 't': p_arg->u_.signed_ = va_arg(args, ptrdiff_t); break;
+                    default: p_arg->u_.signed_ = va_arg(args, int); break;
+                }
+                break;
+            case 'o':
+            case 'u':
+            case 'x':
+            case 'X':
+                p_arg->type_ = ASYNC_ARG_UNSIGNED;
+                switch (length)
+                {
+                    case 'l': p_arg->u_.unsigned_ = va_arg(args, unsigned long); break;
+                    case 'L': p_arg->u_.unsigned_ = va_arg(args, unsigned long long); break;
+                    case 'j': p_arg->u_.unsigned_ = va_arg(args, uintmax_t); break;
+                    case 'z': p_arg->u_.unsigned_ = va_arg(args, size_t); break;
+                    case 't': p_arg->u_.unsigned_ = va_arg(args, ptrdiff_t); break;
+                    default: p_arg->u_.unsigned_ = va_arg(args, unsigned int); break;
+                }
+                break;
+            case 'c':
+                if (0 != length)
+                    return 0;
+                p_arg->type_ = ASYNC_ARG_SIGNED;
+                p_arg->u_.signed_ = va_arg(args, int);
+                break;
+            case 'e':
+            case 'E':
+            case 'f':
+            case 'F':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+                if ('L' == length)
+                    return 0;
+                p_arg->type_ = ASYNC_ARG_DOUBLE;
+                p_arg->u_.double_ = va_arg(args, double);
+                break;
+            case 'p':
+                p_arg->type_ = ASYNC_ARG_POINTER;
+                p_arg->u_.pointer_ = va_arg(args, void *);
+                break;
+            case 's':
+                if (0 != length || !async_put_string(p_record, p_arg, va_arg(args, char const *), precision))
+                    return 0;
+                break;
+            default:
+                return 0;
+        }
+        ++p;
+    }
+    return 1;
+}
+
+/*!
+ * @brief Formats the record.
+ * @details Each conversion is formatted separately, with the captured argument cast back to the type the conversion expects.
+ * @return returns number of characters written, excluding the terminating null.
+ */
+static size_t async_format(struct async_record const * p_record, char * p_buffer, size_t buffer_size)
+{
+    char const * p = p_record->format_;
+    unsigned int arg_idx = 0;
+    size_t used = 0;
+    if (NULL == p)
+        return (size_t)snprintf(p_buffer, buffer_size, "%s", p_record->strings_);
+    while ('\0' != *p && used + 1 < buffer_size)
+    {
+        char spec[32];
+        size_t spec_length = 0;
+        char length = 0;
+        int written;
+        struct async_arg const * p_arg;
+        if ('%' != *p)
+        {
+            p_buffer[used++] = *p++;
+            continue;
+        }
+        if ('%' == p[1])
+        {
+            p_buffer[used++] = '%';
+            p += 2;
+            continue;
+        }
+        /* Rebuild the conversion, with '*' replaced by the captured values. */
+        spec[spec_length++] = *p++;
+        while ('\0' != *p && NULL == strchr("diouxXceEfFgGaAps", *p) && spec_length + 12 < sizeof(spec))
+        {
+            if ('*' == *p)
+                spec_length += (size_t)sprintf(&spec[spec_length], "%d", (int)p_record->args_[arg_idx++].u_.signed_);
+            else
+            {
+                if (NULL != strchr("hljztL", *p))
+                    length = (length == *p) ? (char)(*p - 'a' + 'A') : *p;
+                spec[spec_length++] = *p;
+            }
+            ++p;
+        }
+        spec[spec_length++] = *p;
+        spec[spec_length] = '\0';
+        p_arg = &p_record->args_[arg_idx++];
+        switch (p_arg->type_)
+        {
+            case ASYNC_ARG_SIGNED:
+                switch (length)
+                {
+                    case 'l': written = snprintf(&p_buffer[used], buffer_size - used, spec, (long)p_arg->u_.signed_); break;
+                    case 'L': written = snprintf(&p_buffer[used], buffer_size - used, spec, (long long)p_arg->u_.signed_); break;
+                    case 'j': written = snprintf(&p_buffer[used], buffer_size - used, spec, p_arg->u_.signed_); break;
+                    case 'z': written = snprintf(&p_buffer[used], buffer_size - used, spec, (ssize_t)p_arg->u_.signed_); break;
+                    case 't': written = snprintf(&p_buffer[used], buffer_size - used, spec, (ptrdiff_t)p_arg->u_.signed_); break;
+                    default: written = snprintf(&p_buffer[used], buffer_size - used, spec, (int)p_arg->u_.signed_); break;
+                }
+                break;
+            case ASYNC_ARG_UNSIGNED:
+                switch (length)
+                {
+                    case 'l': written = snprintf(&p_buffer[used], buffer_size - used, spec, (unsigned long)p_arg->u_.unsigned_); break;
+                    case 'L': written = snprintf(&p_buffer[used], buffer_size - used, spec, (unsigned long long)p_arg->u_.unsigned_); break;
+                    case 'j': written = snprintf(&p_buffer[used], buffer_size - used, spec, p_arg->u_.unsigned_); break;
+                    case 'z': written = snprintf(&p_buffer[used], buffer_size - used, spec, (size_t)p_arg->u_.unsigned_); break;
+                    case 't': written = snprintf(&p_buffer[used], buffer_size - used, spec, (ptrdiff_t)p_arg->u_.unsigned_); break;
+                    default: written = snprintf(&p_buffer[used], buffer_size - used, spec, (unsigned int)p_arg->u_.unsigned_); break;
+                }
+                break;
+            case ASYNC_ARG_DOUBLE:
+                written = snprintf(&p_buffer[used], buffer_size - used, spec, p_arg->u_.double_);
+                break;
+            case ASYNC_ARG_POINTER:
+                written = snprintf(&p_buffer[used], buffer_size - used, spec, p_arg->u_.pointer_);
+                break;
+            default:
+                written = snprintf(&p_buffer[used], buffer_size - used, spec, &p_record->strings_[p_arg->u_.string_offset_]);
+                break;
+        }
+        if (written < 0)
+            break;
+        used = min(used + (size_t)written, buffer_size - 1);
+        ++p;
+    }
+    p_buffer[used] = '\0';
+    return used;
+}
+
+/*!
+ * @brief Formats and writes all the records the rings hold.
+ * @return returns number of records written.
+ */
+static unsigned int async_drain(void)
+{
+    static char line[OUTPUT_BUFFER_LEN + 1];
+    static uint64_t dropped_reported;
+    unsigned int count = 0;
+    uint64_t dropped = 0;
+    struct async_ring * p_ring;
+    for (p_ring = __atomic_load_n(&g_async_rings, __ATOMIC_ACQUIRE); NULL != p_ring; p_ring = p_ring->next_)
+    {
+        unsigned int tail = __atomic_load_n(&p_ring->tail_, __ATOMIC_ACQUIRE);
+        unsigned int head = p_ring->head_;
+        for (; head != tail; ++head, ++count)
+        {
+            size_t length = async_format(&p_ring->records_[head % ASYNC_RING_RECORDS], line, sizeof(line) - 1);
+            line[length++] = '\n';
+            fwrite(line, 1, length, stderr);
+        }
+        __atomic_store_n(&p_ring->head_, head, __ATOMIC_RELEASE);
+        dropped += __atomic_load_n(&p_ring->dropped_, __ATOMIC_RELAXED);
+    }
+    if (dropped != dropped_reported)
+    {
+        fprintf(stderr, "%s %4.4u : %llu records dropped\n", __FILE__, __LINE__, (unsigned long long)(dropped - dropped_reported));
+        dropped_reported = dropped;
+    }
+    if (0 != count)
+        fflush(stderr);
+    return count;
+}
+
+static void * async_writer_routine(void * p_param)
+{
+    struct timespec const idle = { 0, ASYNC_IDLE_SLEEP_NS };
+    while (!__atomic_load_n(&g_async_stop, __ATOMIC_ACQUIRE))
+    {
+        if (0 == async_drain())
+            nanosleep(&idle, NULL);
+    }
+    async_drain();
+    return NULL;
+}
+
+/*!
+ * @brief Puts a record into the ring of the calling thread.
+ * @details If the ring is full, the record is dropped. If the arguments cannot be captured, the record is formatted
+ * right away, so that nothing is lost.
+ */
+static int async_put(char const * psz_format, va_list args)
+{
+    struct async_ring * p_ring = async_get_ring();
+    struct async_record * p_record;
+    unsigned int tail;
+    va_list args_copy;
+    if (NULL == p_ring)
+        return 0;
+    tail = p_ring->tail_;
+    if (tail - __atomic_load_n(&p_ring->head_, __ATOMIC_ACQUIRE) >= ASYNC_RING_RECORDS)
+    {
+        __atomic_store_n(&p_ring->dropped_, p_ring->dropped_ + 1, __ATOMIC_RELAXED);
+        return 0;
+    }
+    p_record = &p_ring->records_[tail % ASYNC_RING_RECORDS];
+    va_copy(args_copy, args);
+    if (!async_capture(p_record, psz_format, args_copy))
+    {
+        p_record->format_ = NULL;
+        vsnprintf(p_record->strings_, ASYNC_STRINGS_SIZE, psz_format, args);
+    }
+    va_end(args_copy);
+    __atomic_store_n(&p_ring->tail_, tail + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+int debug_output_async_start(void)
+{
+    int result;
+    if (g_async_running)
+        return 1;
+    g_async_stop = 0;
+    result = pthread_create(&g_async_thread, NULL, &async_writer_routine, NULL);
+    if (0 != result)
+    {
+        fprintf(stderr, "%s %4.4u : %d %s\n", __FILE__, __LINE__, result, strerror(result));
+        return 0;
+    }
+    __atomic_store_n(&g_async_running, 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+void debug_output_async_stop(void)
+{
+    if (g_async_running)
+    {
+        __atomic_store_n(&g_async_running, 0, __ATOMIC_RELEASE);
+        __atomic_store_n(&g_async_stop, 1, __ATOMIC_RELEASE);
+        pthread_join(g_async_thread, NULL);
+    }
+}
+
+uint64_t debug_output_async_get_dropped(void)
+{
+    uint64_t dropped = 0;
+    struct async_ring * p_ring;
+    for (p_ring = __atomic_load_n(&g_async_rings, __ATOMIC_ACQUIRE); NULL != p_ring; p_ring = p_ring->next_)
+        dropped += __atomic_load_n(&p_ring->dropped_, __ATOMIC_RELAXED);
+    return dropped;
+}
+
 #endif
 
+unsigned int g_debug_categories = DEBUG_CATEGORY_ALL;
+
+void debug_set_categories(unsigned int categories)
+{
+	g_debug_categories = categories;
+}
+
+unsigned int debug_get_categories(void)
+{
+	return g_debug_categories;
+}
+
 int debug_outputlnA(const char * formatString, ...)
 {
 	int retval;
 	va_list args;
 	va_start(args, formatString);
+#if !defined WIN32
+	if (__atomic_load_n(&g_async_running, __ATOMIC_ACQUIRE))
+		retval = async_put(formatString, args);
+	else
+#endif
 	retval = debug_outputlnA_impl(formatString, args);
 	va_end(args);
 	return retval;
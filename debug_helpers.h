@@ -34,6 +34,18 @@
 extern "C" {
 #endif 
 
+#include "std-int.h"
+
+/*!
+ * @brief Lets the compiler check the arguments against the format.
+ * @details This matters even more for the asynchronous output, which fetches the arguments with the types the format tells.
+ */
+#if defined __GNUC__
+#   define DEBUG_PRINTF_FORMAT(format_idx, first_arg_idx) __attribute__((format(printf, format_idx, first_arg_idx)))
+#else
+#   define DEBUG_PRINTF_FORMAT(format_idx, first_arg_idx)
+#endif
+
 /*!
  * @brief Outputs a formated text into the debug window, appends a newline.
  * @details The debug window is the one to which we write using OutputDebugString. 
@@ -42,7 +54,7 @@ extern "C" {
  * @param[in] formatString
  * @return
  */
-int debug_outputlnA(const char * formatString, ...);
+int debug_outputlnA(const char * formatString, ...) DEBUG_PRINTF_FORMAT(1, 2);
 
 int debug_outputlnW(const wchar_t * formatString, ...);
 
@@ -73,6 +85,169 @@ int debug_outputln_bufferedW(const wchar_t * formatString, ...);
 
 #define debug_outputln debug_outputlnA
 
+/*!
+ * @brief Most detailed messages, e.g. entering and leaving states.
+ */
+#define DEBUG_LEVEL_TRACE (0)
+
+/*!
+ * @brief Messages that help diagnosing the setup, e.g. addresses being bound.
+ */
+#define DEBUG_LEVEL_DEBUG (1)
+
+/*!
+ * @brief Normal but significant events.
+ */
+#define DEBUG_LEVEL_INFO (2)
+
+/*!
+ * @brief Something unexpected happened, but the operation goes on.
+ */
+#define DEBUG_LEVEL_WARNING (3)
+
+/*!
+ * @brief The operation failed.
+ */
+#define DEBUG_LEVEL_ERROR (4)
+
+/*!
+ * @brief Level above all the others, disables logging entirely.
+ */
+#define DEBUG_LEVEL_NONE (5)
+
+/*!
+ * @brief Messages below this level are not compiled in at all.
+ * @details Override with e.g. -DDEBUG_LEVEL_THRESHOLD=0 to get the trace messages.
+ */
+#if !defined DEBUG_LEVEL_THRESHOLD
+#   if defined NDEBUG
+#       define DEBUG_LEVEL_THRESHOLD DEBUG_LEVEL_WARNING
+#   else
+#       define DEBUG_LEVEL_THRESHOLD DEBUG_LEVEL_DEBUG
+#   endif
+#endif
+
+/*!
+ * @brief Sockets setup, joining and leaving the groups.
+ */
+#define DEBUG_CATEGORY_NETWORK (1u << 0)
+
+/*!
+ * @brief Sender state machine.
+ */
+#define DEBUG_CATEGORY_SENDER (1u << 1)
+
+/*!
+ * @brief Receiver state machine.
+ */
+#define DEBUG_CATEGORY_RECEIVER (1u << 2)
+
+/*!
+ * @brief Audio capture, playout and processing.
+ */
+#define DEBUG_CATEGORY_AUDIO (1u << 3)
+
+/*!
+ * @brief All the categories.
+ */
+#define DEBUG_CATEGORY_ALL (~0u)
+
+/*!
+ * @brief Enables and disables the categories at run time.
+ * @details All the categories are enabled by default.
+ * @param[in] categories bitwise or of the DEBUG_CATEGORY_* values to enable. All the other ones are disabled.
+ */
+void debug_set_categories(unsigned int categories);
+
+/*!
+ * @brief Returns the bitwise or of the DEBUG_CATEGORY_* values that are enabled.
+ */
+unsigned int debug_get_categories(void);
+
+#if defined WIN32
+/* The variable lives in the DLL, so it is read through the function. */
+#   define DEBUG_CATEGORY_ENABLED(category) (0 != (debug_get_categories() & (category)))
+#else
+/*!
+ * @brief Enabled categories. Use debug_set_categories to change it.
+ */
+extern unsigned int g_debug_categories;
+#   define DEBUG_CATEGORY_ENABLED(category) (0 != (g_debug_categories & (category)))
+#endif
+
+/*!
+ * @brief Writes the message if its category is enabled.
+ */
+#define DEBUG_LOG(category, ...) do { if (DEBUG_CATEGORY_ENABLED(category)) debug_outputln(__VA_ARGS__); } while (0)
+
+/*!
+ * @brief Does nothing; the arguments are not evaluated.
+ */
+#define DEBUG_LOG_NOTHING(category, ...) do { } while (0)
+
+/*!
+ * @brief Level aware logging macros.
+ * @details Each takes the category, then the format and the arguments, as debug_outputln does. The ones below
+ * DEBUG_LEVEL_THRESHOLD expand to nothing, so they cost nothing, not even the arguments evaluation. The remaining
+ * ones cost a single branch on the category when it is disabled at run time.
+ */
+#if DEBUG_LEVEL_THRESHOLD <= DEBUG_LEVEL_TRACE
+#   define debug_log_trace DEBUG_LOG
+#else
+#   define debug_log_trace DEBUG_LOG_NOTHING
+#endif
+
+#if DEBUG_LEVEL_THRESHOLD <= DEBUG_LEVEL_DEBUG
+#   define debug_log_debug DEBUG_LOG
+#else
+#   define debug_log_debug DEBUG_LOG_NOTHING
+#endif
+
+#if DEBUG_LEVEL_THRESHOLD <= DEBUG_LEVEL_INFO
+#   define debug_log_info DEBUG_LOG
+#else
+#   define debug_log_info DEBUG_LOG_NOTHING
+#endif
+
+#if DEBUG_LEVEL_THRESHOLD <= DEBUG_LEVEL_WARNING
+#   define debug_log_warning DEBUG_LOG
+#else
+#   define debug_log_warning DEBUG_LOG_NOTHING
+#endif
+
+#if DEBUG_LEVEL_THRESHOLD <= DEBUG_LEVEL_ERROR
+#   define debug_log_error DEBUG_LOG
+#else
+#   define debug_log_error DEBUG_LOG_NOTHING
+#endif
+
+#if !defined WIN32
+
+/*!
+ * @brief Makes debug_outputlnA asynchronous.
+ * @details Starts the background writer thread. From now on, debug_outputlnA only captures the format pointer and
+ * the arguments into a lock-free ring owned by the calling thread, and the writer thread formats and writes them to the
+ * stderr, each followed by a newline. The format string must therefore be a literal, or at least must outlive the call.
+ * String arguments are copied. A call never blocks: if the ring of the calling thread is full, the record is dropped
+ * and counted, see debug_output_async_get_dropped.
+ * @return returns non-zero on success, 0 if the writer thread could not be started.
+ * @sa debug_output_async_stop
+ */
+int debug_output_async_start(void);
+
+/*!
+ * @brief Writes all the pending records, stops the writer thread and makes debug_outputlnA synchronous again.
+ * @attention Records put by other threads while this function executes may be lost.
+ */
+void debug_output_async_stop(void);
+
+/*!
+ * @brief Returns number of records dropped so far, because the ring of the calling thread was full.
+ */
+uint64_t debug_output_async_get_dropped(void);
+
+#endif
+
 #if defined __cplusplus
 }
 #endif 
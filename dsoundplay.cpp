@@ -68,6 +68,7 @@
 #include "input-buffer.h"
 #include "receiver-settings.h"
 #include "perf-counter-itf.h"
+#include "trace-recorder.h"
 #include "dsbcaps-utils.h"
 
 /*!
@@ -101,8 +102,7 @@ typedef struct dxaudio_player_thread_information_block {
     LPDIRECTSOUNDBUFFER8 p_secondary_sound_buffer_; /*!< The DirectSound secondary buffer. */
     volatile e_player_state_t e_state_;
     HANDLE wait_objects_array_[3+NOTIFY_OBJECTS_COUNT]; /*!< Handles of the notification marks plus 3 events for start, stop, and exit */
-    struct perf_counter * counter1_;
-    _int64 total, avg, freq;
+    struct perf_counter * counter1_; /*!< Measures how long it takes to fetch a chunk from the fifo queue. */
     DSBPOSITIONNOTIFY notification_array_[NOTIFY_OBJECTS_COUNT];
     struct dsound_data * p_dsound_data;
     LPDIRECTSOUNDBUFFER p_primary_sound_buffer_; /*!< The DirectSound primary buffer. */
@@ -338,9 +338,10 @@ error:
  * @param[in] p_buffer - pointer to the secondary buffer into which data will be replayed.
  * @param[in] p_fifo - pointer to the FIFO queue from which data will be fetched.
  * @param[in] idx - index of the part of the DirectSound chunk into which copy data.
+ * @param[in] p_counter - performance counter that measures the fetch from the FIFO queue.
  * @return returns S_OK on success, any other result indicates a failure.
  */
-static HRESULT fill_buffer(LPDIRECTSOUNDBUFFER8 p_buffer, fifo_circular_buffer * p_fifo, size_t idx)
+static HRESULT fill_buffer(LPDIRECTSOUNDBUFFER8 p_buffer, fifo_circular_buffer * p_fifo, size_t idx, struct perf_counter * p_counter)
 {
     LPVOID lpvWrite1;
     DWORD dwLength1;
@@ -361,7 +362,11 @@ static HRESULT fill_buffer(LPDIRECTSOUNDBUFFER8 p_buffer, fifo_circular_buffer *
         /* Copy as many items as you can, no more than chunk size, into the buffer */
         if (fifo_circular_buffer_get_items_count(p_fifo)>0)
         {
+            perf_counter_mark_before(p_counter);
+            TRACE_BEGIN("fifo fetch");
             fifo_circular_buffer_fetch_item(p_fifo, (uint8_t*)lpvWrite1, &size);
+            TRACE_END("fifo fetch");
+            perf_counter_mark_after(p_counter);
         }
         hr = p_buffer->Unlock(lpvWrite1, dwLength1, NULL, 0);
     }
@@ -408,6 +413,8 @@ static dxaudio_player_thread_information_block_t * create_player_thread_informat
         }
         p_player->p_dsound_data = p_data;
         p_player->fifo_ = p_data->fifo_;
+        p_player->counter1_ = perf_counter_create();
+        assert(NULL != p_player->counter1_);
         init_ds_data(p_data->hWnd_, &p_data->receiver_settings_.wfex_, p_player); 
         return p_player;
     }
@@ -513,7 +520,7 @@ static DWORD WINAPI dxaudio_player_thread(void * p_param)
                                             if (SUCCEEDED(hr))
                                             {
                                                 fill_buffer(p_tib->p_secondary_sound_buffer_, 
-                                                    p_tib->fifo_, (idx - 3 + 1)%2);
+                                                    p_tib->fifo_, (idx - 3 + 1)%2, p_tib->counter1_);
                                             }
                                             else
                                             {
@@ -538,6 +545,8 @@ static DWORD WINAPI dxaudio_player_thread(void * p_param)
             {
                 ::CloseHandle(p_tib->wait_objects_array_[idx]);
             }
+            perf_counter_dump(p_tib->counter1_, "fifo fetch");
+            perf_counter_destroy(p_tib->counter1_);
             ::HeapFree(GetProcessHeap(), 0, p_tib);
         }
         ::CoUninitialize();
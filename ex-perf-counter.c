@@ -87,7 +87,7 @@ static struct x_y {
 int main(int argc, char ** argv)
 {
 	struct perf_counter *  counter;
-	_int64 total, avg, freq;
+	int64_t total, avg, freq;
 	size_t idx;
     /* Create the performance counter object */
 	counter = perf_counter_create();
@@ -110,6 +110,8 @@ int main(int argc, char ** argv)
 	}
     /* Get total time and average it takes to execute the code segment between calls to perf_counter_mark_before and perf_counter_mark_end */
 	perf_counter_get_duration(counter, &total, &avg);
+    /* Write the minimum, mean, percentiles and maximum to the debug output */
+    perf_counter_dump(counter, "bessel");
     /* Destroy the performance counter object */
 	perf_counter_destroy(counter);
     /* Display results */
@@ -0,0 +1,373 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file file-source.c
+ * @brief Sequential reader of large files.
+ * @details The strategy is picked by the size of the file: small files are mapped, bigger ones are read with the kernel told to read ahead, and the biggest ones are read through a pool of small buffers.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include "file-source.h"
+#include "debug_helpers.h"
+
+/*!
+ * @brief A buffer the file is read into.
+ */
+struct file_source_buffer {
+    uint64_t offset_; /*!< Offset of the first byte of the buffer in the file. */
+    size_t size_; /*!< Number of valid bytes. */
+    unsigned int used_; /*!< When the buffer was last handed out, the least recently used one is filled next. */
+    uint8_t * p_data_; /*!< The bytes. */
+};
+
+/*!
+ * @brief The source.
+ */
+struct file_source {
+    int strategy_; /*!< One of the FILE_SOURCE_* strategies, but FILE_SOURCE_AUTO. */
+    uint64_t size_; /*!< Size of the file. */
+    uint8_t const * p_map_; /*!< The file, if mapped or given in the memory. */
+    int owns_map_; /*!< Non-zero if p_map_ was mapped by the source, 0 if it was given. */
+#if defined WIN32
+    HANDLE hf_; /*!< The file. */
+    HANDLE mapping_; /*!< Mapping of the file. */
+#else
+    int fd_; /*!< The file, -1 once mapped. */
+#endif
+    uint64_t advised_; /*!< End of the range the kernel was told to read ahead. */
+    uint64_t dropped_; /*!< End of the range dropped, always on a page boundary. */
+    unsigned int tick_; /*!< Incremented each time a buffer is handed out. */
+    unsigned int buffers_count_; /*!< Number of buffers used. */
+    size_t buffer_size_; /*!< Size of each buffer. */
+    struct file_source_buffer buffers_[FILE_SOURCE_BUFFERS_COUNT]; /*!< The buffers. */
+};
+
+static char const * const g_strategy_names[] = { "auto", "mmap", "readahead", "pread" };
+
+static size_t read_at(struct file_source * p_source, uint64_t offset, void * p_buffer, size_t size)
+{
+    if (offset >= p_source->size_)
+        return 0;
+    size = (size_t)min((uint64_t)size, p_source->size_ - offset);
+    if (NULL != p_source->p_map_)
+    {
+        CopyMemory(p_buffer, &p_source->p_map_[offset], size);
+        return size;
+    }
+    else
+    {
+#if defined WIN32
+        OVERLAPPED overlapped;
+        DWORD read = 0;
+        ZeroMemory(&overlapped, sizeof(overlapped));
+        overlapped.Offset = (DWORD)offset;
+        overlapped.OffsetHigh = (DWORD)(offset >> 32);
+        if (!ReadFile(p_source->hf_, p_buffer, (DWORD)size, &read, &overlapped))
+        {
+            debug_log_error(DEBUG_CATEGORY_AUDIO, "%s %4.4u : %lu", __FILE__, __LINE__, GetLastError());
+            return 0;
+        }
+        return read;
+#else
+        size_t done = 0;
+        while (done < size)
+        {
+            ssize_t result = pread(p_source->fd_, (uint8_t *)p_buffer + done, size - done, (off_t)(offset + done));
+            if (result <= 0)
+            {
+                if (result < 0 && EINTR == errno)
+                    continue;
+                if (result < 0)
+                    debug_log_error(DEBUG_CATEGORY_AUDIO, "%s %4.4u : %d %s", __FILE__, __LINE__, errno, strerror(errno));
+                break;
+            }
+            done += (size_t)result;
+        }
+        return done;
+#endif
+    }
+}
+
+/*!
+ * @brief Keeps the kernel a window ahead of the reads, and drops what is more than a window behind them.
+ */
+static void follow(struct file_source * p_source, uint64_t offset)
+{
+#if !defined WIN32
+    uint64_t const page_mask = (uint64_t)sysconf(_SC_PAGESIZE) - 1;
+    uint64_t end;
+    if (NULL != p_source->p_map_ && !p_source->owns_map_)
+        return;
+    if (offset < p_source->dropped_)
+    {
+        /* Went back, e.g. to loop the file. */
+        p_source->dropped_ = offset & ~page_mask;
+        p_source->advised_ = offset;
+    }
+    if (offset + FILE_SOURCE_WINDOW > p_source->advised_ && p_source->advised_ < p_source->size_)
+    {
+        uint64_t start = max(p_source->advised_, offset) & ~page_mask;
+        end = min(p_source->size_, offset + 2 * FILE_SOURCE_WINDOW);
+        switch (p_source->strategy_)
+        {
+            case FILE_SOURCE_MMAP:
+                madvise((void *)&p_source->p_map_[start], (size_t)(end - start), MADV_WILLNEED);
+                break;
+            case FILE_SOURCE_READAHEAD:
+                readahead(p_source->fd_, (off64_t)start, (size_t)(end - start));
+                break;
+            default:
+                posix_fadvise(p_source->fd_, (off_t)start, (off_t)(end - start), POSIX_FADV_WILLNEED);
+                break;
+        }
+        p_source->advised_ = end;
+    }
+    if (offset > p_source->dropped_ + 2 * FILE_SOURCE_WINDOW)
+    {
+        end = (offset - FILE_SOURCE_WINDOW) & ~page_mask;
+        switch (p_source->strategy_)
+        {
+            case FILE_SOURCE_MMAP:
+                /* The mapping is private and read only, so the dropped pages are simply read again if needed. */
+                madvise((void *)&p_source->p_map_[p_source->dropped_], (size_t)(end - p_source->dropped_), MADV_DONTNEED);
+                break;
+            case FILE_SOURCE_PREAD:
+                posix_fadvise(p_source->fd_, (off_t)p_source->dropped_, (off_t)(end - p_source->dropped_), POSIX_FADV_DONTNEED);
+                break;
+            default:
+                /* The files read ahead are small enough to stay in the page cache while looped. */
+                break;
+        }
+        p_source->dropped_ = end;
+    }
+#endif
+}
+
+static struct file_source * source_create(int strategy, uint64_t size)
+{
+    struct file_source * p_source = (struct file_source *)calloc(1, sizeof(struct file_source));
+    if (NULL == p_source)
+        return NULL;
+#if defined WIN32
+    p_source->hf_ = INVALID_HANDLE_VALUE;
+#else
+    p_source->fd_ = -1;
+#endif
+    p_source->size_ = size;
+    if (FILE_SOURCE_AUTO == strategy)
+    {
+        if (size <= FILE_SOURCE_MMAP_LIMIT)
+            strategy = FILE_SOURCE_MMAP;
+        else if (size <= FILE_SOURCE_READAHEAD_LIMIT)
+            strategy = FILE_SOURCE_READAHEAD;
+        else
+            strategy = FILE_SOURCE_PREAD;
+    }
+    p_source->strategy_ = strategy;
+    if (FILE_SOURCE_READAHEAD == strategy || FILE_SOURCE_PREAD == strategy)
+    {
+        unsigned int idx;
+        p_source->buffers_count_ = FILE_SOURCE_READAHEAD == strategy ? 1 : FILE_SOURCE_BUFFERS_COUNT;
+        p_source->buffer_size_ = FILE_SOURCE_READAHEAD == strategy ? FILE_SOURCE_WINDOW : FILE_SOURCE_BUFFER_SIZE;
+        for (idx = 0; idx < p_source->buffers_count_; ++idx)
+        {
+            p_source->buffers_[idx].p_data_ = (uint8_t *)malloc(p_source->buffer_size_);
+            if (NULL == p_source->buffers_[idx].p_data_)
+            {
+                file_source_close(p_source);
+                return NULL;
+            }
+        }
+    }
+    return p_source;
+}
+
+struct file_source * file_source_open(char const * psz_path, int strategy)
+{
+    struct file_source * p_source;
+#if defined WIN32
+    LARGE_INTEGER size;
+    HANDLE hf = CreateFileA(psz_path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (INVALID_HANDLE_VALUE == hf || !GetFileSizeEx(hf, &size))
+    {
+        debug_log_error(DEBUG_CATEGORY_AUDIO, "%s %4.4u : %s %lu", __FILE__, __LINE__, psz_path, GetLastError());
+        if (INVALID_HANDLE_VALUE != hf)
+            CloseHandle(hf);
+        return NULL;
+    }
+    p_source = source_create(strategy, (uint64_t)size.QuadPart);
+    if (NULL == p_source)
+    {
+        CloseHandle(hf);
+        return NULL;
+    }
+    p_source->hf_ = hf;
+    if (FILE_SOURCE_MMAP == p_source->strategy_ && 0 != p_source->size_)
+    {
+        p_source->mapping_ = CreateFileMapping(hf, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (NULL != p_source->mapping_)
+            p_source->p_map_ = (uint8_t const *)MapViewOfFile(p_source->mapping_, FILE_MAP_READ, 0, 0, 0);
+        p_source->owns_map_ = 1;
+    }
+#else
+    struct stat st_file;
+    int fd = open(psz_path, O_RDONLY);
+    if (fd < 0 || 0 != fstat(fd, &st_file))
+    {
+        debug_log_error(DEBUG_CATEGORY_AUDIO, "%s %4.4u : %s %d %s", __FILE__, __LINE__, psz_path, errno, strerror(errno));
+        if (fd >= 0)
+            close(fd);
+        return NULL;
+    }
+    p_source = source_create(strategy, (uint64_t)st_file.st_size);
+    if (NULL == p_source)
+    {
+        close(fd);
+        return NULL;
+    }
+    p_source->fd_ = fd;
+    if (FILE_SOURCE_MMAP == p_source->strategy_ && 0 != p_source->size_)
+    {
+        /* No MAP_POPULATE, the pages are read in as the reads get to them. */
+        void * p_map = mmap(NULL, (size_t)p_source->size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (MAP_FAILED != p_map)
+        {
+            madvise(p_map, (size_t)p_source->size_, MADV_SEQUENTIAL);
+            p_source->p_map_ = (uint8_t const *)p_map;
+            p_source->owns_map_ = 1;
+        }
+        close(fd);
+        p_source->fd_ = -1;
+    }
+    else
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    if (FILE_SOURCE_MMAP == p_source->strategy_ && NULL == p_source->p_map_ && 0 != p_source->size_)
+    {
+        debug_log_error(DEBUG_CATEGORY_AUDIO, "%s %4.4u : cannot map %s", __FILE__, __LINE__, psz_path);
+        file_source_close(p_source);
+        return NULL;
+    }
+    /* Opened for every tone and capture, hence trace rather than debug. */
+    debug_log_trace(DEBUG_CATEGORY_AUDIO, "%s %4.4u : %s %llu bytes, %s", __FILE__, __LINE__, psz_path,
+            (unsigned long long)p_source->size_, file_source_get_strategy_name(p_source->strategy_));
+    return p_source;
+}
+
+struct file_source * file_source_open_memory(void const * p_data, size_t data_size)
+{
+    struct file_source * p_source = source_create(FILE_SOURCE_MMAP, data_size);
+    if (NULL != p_source)
+        p_source->p_map_ = (uint8_t const *)p_data;
+    return p_source;
+}
+
+void file_source_close(struct file_source * p_source)
+{
+    if (NULL != p_source)
+    {
+        unsigned int idx;
+#if defined WIN32
+        if (p_source->owns_map_ && NULL != p_source->p_map_)
+            UnmapViewOfFile(p_source->p_map_);
+        if (NULL != p_source->mapping_)
+            CloseHandle(p_source->mapping_);
+        if (INVALID_HANDLE_VALUE != p_source->hf_)
+            CloseHandle(p_source->hf_);
+#else
+        if (p_source->owns_map_ && NULL != p_source->p_map_)
+            munmap((void *)p_source->p_map_, (size_t)p_source->size_);
+        if (p_source->fd_ >= 0)
+            close(p_source->fd_);
+#endif
+        for (idx = 0; idx < FILE_SOURCE_BUFFERS_COUNT; ++idx)
+            free(p_source->buffers_[idx].p_data_);
+        free(p_source);
+    }
+}
+
+int file_source_get_strategy(struct file_source const * p_source)
+{
+    return p_source->strategy_;
+}
+
+char const * file_source_get_strategy_name(int strategy)
+{
+    return strategy >= 0 && strategy < (int)COUNTOF_ARRAY(g_strategy_names) ? g_strategy_names[strategy] : "unknown";
+}
+
+uint64_t file_source_get_size(struct file_source const * p_source)
+{
+    return p_source->size_;
+}
+
+void const * file_source_get_mapping(struct file_source const * p_source)
+{
+    return p_source->p_map_;
+}
+
+void const * file_source_get(struct file_source * p_source, uint64_t offset, size_t size, size_t * p_size)
+{
+    struct file_source_buffer * p_buffer = NULL;
+    unsigned int idx;
+    *p_size = 0;
+    if (offset >= p_source->size_ || 0 == size)
+        return NULL;
+    size = (size_t)min((uint64_t)size, p_source->size_ - offset);
+    if (NULL != p_source->p_map_)
+    {
+        follow(p_source, offset);
+        *p_size = size;
+        return &p_source->p_map_[offset];
+    }
+    size = min(size, p_source->buffer_size_);
+    for (idx = 0; idx < p_source->buffers_count_; ++idx)
+    {
+        struct file_source_buffer * p_idx = &p_source->buffers_[idx];
+        if (offset >= p_idx->offset_ && offset + size <= p_idx->offset_ + p_idx->size_)
+        {
+            p_buffer = p_idx;
+            break;
+        }
+        if (NULL == p_buffer || p_idx->used_ < p_buffer->used_)
+            p_buffer = p_idx;
+    }
+    if (idx == p_source->buffers_count_)
+    {
+        /* Not in any of the buffers, the least recently used one is filled from the offset. */
+        follow(p_source, offset);
+        p_buffer->offset_ = offset;
+        p_buffer->size_ = read_at(p_source, offset, p_buffer->p_data_, (size_t)min((uint64_t)p_source->buffer_size_, p_source->size_ - offset));
+        if (0 == p_buffer->size_)
+            return NULL;
+        size = min(size, p_buffer->size_);
+    }
+    p_buffer->used_ = ++p_source->tick_;
+    *p_size = size;
+    return &p_buffer->p_data_[offset - p_buffer->offset_];
+}
+
+size_t file_source_read(struct file_source * p_source, uint64_t offset, void * p_buffer, size_t size)
+{
+    return read_at(p_source, offset, p_buffer, size);
+}
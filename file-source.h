@@ -0,0 +1,169 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+
+/**
+ * @file file-source.h
+ * @brief Sequential reader of large files.
+ * @details Hides whether the file is mapped or read, and keeps the memory used by a long file from growing with the part of it already consumed.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+#if !defined FILE_SOURCE_H_3A6F897B_E5B4_4531_8827_EA203464E029
+#define FILE_SOURCE_H_3A6F897B_E5B4_4531_8827_EA203464E029
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+#include "std-int.h"
+#include <stddef.h>
+
+/*!
+ * @brief The strategy is picked by the size of the file, see FILE_SOURCE_MMAP_LIMIT and FILE_SOURCE_READAHEAD_LIMIT.
+ */
+#define FILE_SOURCE_AUTO (0)
+
+/*!
+ * @brief The file is mapped lazily, i.e. without MAP_POPULATE. The kernel is told to read ahead a window in front
+ * of the reads, and the pages more than a window behind them are dropped from the mapping.
+ */
+#define FILE_SOURCE_MMAP (1)
+
+/*!
+ * @brief The file is read with pread into a single window, and the kernel is told to read the next window into the
+ * page cache with readahead.
+ */
+#define FILE_SOURCE_READAHEAD (2)
+
+/*!
+ * @brief The file is read with pread into a small pool of buffers, and the pages behind the reads are dropped from
+ * the page cache.
+ */
+#define FILE_SOURCE_PREAD (3)
+
+/*!
+ * @brief Size of the window the kernel is told to read ahead, and of the read buffer of FILE_SOURCE_READAHEAD.
+ */
+#define FILE_SOURCE_WINDOW (256 * 1024)
+
+/*!
+ * @brief Size of each buffer of the FILE_SOURCE_PREAD pool.
+ */
+#define FILE_SOURCE_BUFFER_SIZE (64 * 1024)
+
+/*!
+ * @brief Number of buffers of the FILE_SOURCE_PREAD pool. The bytes handed out stay valid until this many other
+ * buffers are filled.
+ */
+#define FILE_SOURCE_BUFFERS_COUNT (4)
+
+/*!
+ * @brief FILE_SOURCE_AUTO maps the files up to this size.
+ */
+#define FILE_SOURCE_MMAP_LIMIT (64 * 1024 * 1024)
+
+/*!
+ * @brief FILE_SOURCE_AUTO reads the files up to this size with FILE_SOURCE_READAHEAD, and bigger ones with FILE_SOURCE_PREAD.
+ */
+#define FILE_SOURCE_READAHEAD_LIMIT (1024 * 1024 * 1024)
+
+/*!
+ * @brief Forward declaration.
+ */
+struct file_source;
+
+/*!
+ * @brief Opens the file.
+ * @param[in] psz_path path of the file.
+ * @param[in] strategy one of the FILE_SOURCE_* strategies.
+ * @return returns a handle to the source, or NULL if the file could not be opened.
+ */
+struct file_source * file_source_open(char const * psz_path, int strategy);
+
+/*!
+ * @brief Wraps the bytes already in the memory, e.g. a loaded resource.
+ * @details The strategy of the source is FILE_SOURCE_MMAP, but nothing is ever dropped.
+ * @param[in] p_data the bytes, must outlive the source.
+ * @param[in] data_size number of bytes.
+ * @return returns a handle to the source, or NULL if out of memory.
+ */
+struct file_source * file_source_open_memory(void const * p_data, size_t data_size);
+
+/*!
+ * @brief Closes the source.
+ * @param[in] p_source a handle to the source obtained via call to file_source_open or file_source_open_memory.
+ */
+void file_source_close(struct file_source * p_source);
+
+/*!
+ * @brief Returns the strategy used, never FILE_SOURCE_AUTO.
+ * @param[in] p_source a handle to the source.
+ */
+int file_source_get_strategy(struct file_source const * p_source);
+
+/*!
+ * @brief Returns name of the strategy, e.g. "mmap".
+ * @param[in] strategy one of the FILE_SOURCE_* strategies.
+ */
+char const * file_source_get_strategy_name(int strategy);
+
+/*!
+ * @brief Returns size of the file.
+ * @param[in] p_source a handle to the source.
+ */
+uint64_t file_source_get_size(struct file_source const * p_source);
+
+/*!
+ * @brief Returns the whole file.
+ * @param[in] p_source a handle to the source.
+ * @return returns the mapping, or NULL unless the strategy is FILE_SOURCE_MMAP.
+ */
+void const * file_source_get_mapping(struct file_source const * p_source);
+
+/*!
+ * @brief Returns the bytes at the given offset, without copying them if possible.
+ * @details This is the way to go through the file front to back: the read ahead and the dropping of the consumed
+ * pages follow the offsets asked for here.
+ * @param[in] p_source a handle to the source.
+ * @param[in] offset offset of the first byte.
+ * @param[in] size number of bytes wanted.
+ * @param[out] p_size this will be written with the number of bytes returned. Fewer than wanted are returned at
+ * the end of the file, or when they do not fit into a single buffer.
+ * @return returns a pointer to the bytes, or NULL at the end of the file or on error.
+ */
+void const * file_source_get(struct file_source * p_source, uint64_t offset, size_t size, size_t * p_size);
+
+/*!
+ * @brief Copies the bytes at the given offset.
+ * @details Meant for the small reads at random offsets, e.g. of the headers. The read ahead is not affected.
+ * @param[in] p_source a handle to the source.
+ * @param[in] offset offset of the first byte.
+ * @param[out] p_buffer this buffer will be written with the bytes.
+ * @param[in] size number of bytes to copy.
+ * @return returns number of bytes copied, fewer than size only at the end of the file or on error.
+ */
+size_t file_source_read(struct file_source * p_source, uint64_t offset, void * p_buffer, size_t size);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* FILE_SOURCE_H_3A6F897B_E5B4_4531_8827_EA203464E029 */
@@ -0,0 +1,269 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file jitter-buffer.c
+ * @brief Per source jitter buffer implementation.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include "jitter-buffer.h"
+#include "latency-histogram.h"
+
+/*!
+ * @brief Describes a single packet slot.
+ */
+struct jitter_slot {
+    uint16_t seq_; /*!< Sequence number of the packet held in this slot. */
+    uint16_t valid_; /*!< Non-zero if the slot holds a packet that has not been played out yet. */
+    uint32_t count_; /*!< Number of samples in this slot. */
+    uint64_t arrival_time_; /*!< Arrival time of the packet, 0 if unknown. */
+    int16_t * samples_; /*!< Samples of this slot. Points into the jitter_buffer::samples_ array. */
+};
+
+/*!
+ * @brief The jitter buffer.
+ * @details The packets are stored in a table of 2^level slots, indexed with lower bits of the sequence number.
+ * Therefore, putting a packet and finding the next one to play are both constant time operations.
+ */
+struct jitter_buffer {
+    uint32_t slots_count_; /*!< Number of slots, always a power of 2. */
+    size_t max_samples_; /*!< Maximum number of samples a single slot can hold. */
+    unsigned int prefill_; /*!< Number of packets to buffer before the playout starts. */
+    int synced_; /*!< Non-zero if the next_seq_ has been initialized with the first received packet. */
+    int started_; /*!< Non-zero if the playout has been started at least once. */
+    int playing_; /*!< Non-zero if the playout is in progress, zero if buffer is prefilling. */
+    uint16_t next_seq_; /*!< Sequence number of the packet to be played out next. */
+    uint16_t newest_seq_; /*!< Highest sequence number received so far. */
+    size_t read_offset_; /*!< Number of samples of the next_seq_ packet already played out. */
+    unsigned int packets_; /*!< Number of occupied slots. */
+    size_t buffered_samples_; /*!< Total number of samples in the occupied slots. */
+    uint32_t lost_; /*!< Number of packets skipped during the playout. */
+    uint32_t dropped_; /*!< Number of late or duplicated packets. */
+    uint32_t underruns_; /*!< Number of times the playout ran out of data. */
+    struct latency_histogram * residency_; /*!< If not NULL, the time each packet spent in the buffer is recorded here. */
+    struct jitter_slot * slots_; /*!< Packet slots. */
+    int16_t * samples_; /*!< Storage for the slots samples. */
+};
+
+struct jitter_buffer * jitter_buffer_create(uint8_t level, size_t max_samples, unsigned int prefill)
+{
+    struct jitter_buffer * p_jb;
+    uint32_t idx;
+    if (level < 1 || level > 15 || 0 == max_samples || prefill > (1u << level))
+        return NULL;
+    p_jb = (struct jitter_buffer *)calloc(1, sizeof(struct jitter_buffer));
+    if (NULL == p_jb)
+        return NULL;
+    p_jb->slots_count_ = 1u << level;
+    p_jb->max_samples_ = max_samples;
+    p_jb->prefill_ = prefill ? prefill : 1;
+    p_jb->slots_ = (struct jitter_slot *)calloc(p_jb->slots_count_, sizeof(struct jitter_slot));
+    p_jb->samples_ = (int16_t *)malloc(p_jb->slots_count_ * max_samples * sizeof(int16_t));
+    if (NULL == p_jb->slots_ || NULL == p_jb->samples_)
+    {
+        jitter_buffer_destroy(p_jb);
+        return NULL;
+    }
+    for (idx = 0; idx < p_jb->slots_count_; ++idx)
+        p_jb->slots_[idx].samples_ = p_jb->samples_ + idx * max_samples;
+    return p_jb;
+}
+
+void jitter_buffer_destroy(struct jitter_buffer * p_jb)
+{
+    if (NULL != p_jb)
+    {
+        free(p_jb->slots_);
+        free(p_jb->samples_);
+        free(p_jb);
+    }
+}
+
+void jitter_buffer_reset(struct jitter_buffer * p_jb)
+{
+    uint32_t idx;
+    for (idx = 0; idx < p_jb->slots_count_; ++idx)
+        p_jb->slots_[idx].valid_ = 0;
+    p_jb->synced_ = 0;
+    p_jb->started_ = 0;
+    p_jb->playing_ = 0;
+    p_jb->read_offset_ = 0;
+    p_jb->packets_ = 0;
+    p_jb->buffered_samples_ = 0;
+    p_jb->lost_ = 0;
+    p_jb->dropped_ = 0;
+    p_jb->underruns_ = 0;
+}
+
+/*!
+ * @brief Removes the packet that is to be played next and advances the playout point.
+ * @details If there is no such packet, then the packet is accounted as lost.
+ */
+static void jitter_buffer_skip_next(struct jitter_buffer * p_jb)
+{
+    struct jitter_slot * p_slot = &p_jb->slots_[p_jb->next_seq_ & (p_jb->slots_count_ - 1)];
+    if (p_slot->valid_ && p_slot->seq_ == p_jb->next_seq_)
+    {
+        p_slot->valid_ = 0;
+        --p_jb->packets_;
+        p_jb->buffered_samples_ -= p_slot->count_;
+    }
+    else
+    {
+        ++p_jb->lost_;
+    }
+    ++p_jb->next_seq_;
+    p_jb->read_offset_ = 0;
+}
+
+int jitter_buffer_put(struct jitter_buffer * p_jb, uint16_t seq, int16_t const * p_samples, size_t samples_count)
+{
+    return jitter_buffer_put_at(p_jb, seq, p_samples, samples_count, 0);
+}
+
+int jitter_buffer_put_at(struct jitter_buffer * p_jb, uint16_t seq, int16_t const * p_samples, size_t samples_count, uint64_t arrival_time)
+{
+    struct jitter_slot * p_slot;
+    int16_t diff;
+    if (0 == samples_count || samples_count > p_jb->max_samples_)
+    {
+        ++p_jb->dropped_;
+        return 0;
+    }
+    if (!p_jb->synced_)
+    {
+        p_jb->next_seq_ = seq;
+        p_jb->newest_seq_ = seq;
+        p_jb->synced_ = 1;
+    }
+    diff = (int16_t)(seq - p_jb->next_seq_);
+    if (diff < 0)
+    {
+        /* Before the playout starts, the packets that were reordered in the network may still
+         * move the playout point backwards. Once the playout started, such packets are simply late.
+         */
+        if (p_jb->started_ || (uint16_t)(p_jb->newest_seq_ - seq) >= p_jb->slots_count_)
+        {
+            ++p_jb->dropped_;
+            return 0;
+        }
+        p_jb->next_seq_ = seq;
+        diff = 0;
+    }
+    /* Make room for the packet, if it's too far ahead of the playout point. */
+    for (; (uint16_t)diff >= p_jb->slots_count_; --diff)
+    {
+        jitter_buffer_skip_next(p_jb);
+    }
+    p_slot = &p_jb->slots_[seq & (p_jb->slots_count_ - 1)];
+    if (p_slot->valid_)
+    {
+        assert(p_slot->seq_ == seq);
+        ++p_jb->dropped_;
+        return 0;
+    }
+    CopyMemory(p_slot->samples_, p_samples, samples_count * sizeof(int16_t));
+    p_slot->seq_ = seq;
+    p_slot->count_ = (uint32_t)samples_count;
+    p_slot->arrival_time_ = arrival_time;
+    p_slot->valid_ = 1;
+    ++p_jb->packets_;
+    p_jb->buffered_samples_ += samples_count;
+    if ((int16_t)(seq - p_jb->newest_seq_) > 0)
+        p_jb->newest_seq_ = seq;
+    if (!p_jb->playing_ && p_jb->packets_ >= p_jb->prefill_)
+    {
+        p_jb->playing_ = 1;
+        p_jb->started_ = 1;
+    }
+    return 1;
+}
+
+size_t jitter_buffer_get_available(struct jitter_buffer const * p_jb)
+{
+    if (!p_jb->playing_)
+        return 0;
+    return p_jb->buffered_samples_ - p_jb->read_offset_;
+}
+
+size_t jitter_buffer_read(struct jitter_buffer * p_jb, int16_t * p_samples, size_t count)
+{
+    return jitter_buffer_read_at(p_jb, p_samples, count, 0);
+}
+
+size_t jitter_buffer_read_at(struct jitter_buffer * p_jb, int16_t * p_samples, size_t count, uint64_t playout_time)
+{
+    size_t produced = 0;
+    if (p_jb->playing_)
+    {
+        while (produced < count && p_jb->packets_ > 0)
+        {
+            struct jitter_slot * p_slot = &p_jb->slots_[p_jb->next_seq_ & (p_jb->slots_count_ - 1)];
+            if (p_slot->valid_ && p_slot->seq_ == p_jb->next_seq_)
+            {
+                size_t chunk = min(p_slot->count_ - p_jb->read_offset_, count - produced);
+                if (0 == p_jb->read_offset_ && NULL != p_jb->residency_ && 0 != playout_time
+                        && 0 != p_slot->arrival_time_ && playout_time >= p_slot->arrival_time_)
+                    latency_histogram_record(p_jb->residency_, playout_time - p_slot->arrival_time_);
+                CopyMemory(&p_samples[produced], &p_slot->samples_[p_jb->read_offset_], chunk * sizeof(int16_t));
+                produced += chunk;
+                p_jb->read_offset_ += chunk;
+                if (p_jb->read_offset_ == p_slot->count_)
+                    jitter_buffer_skip_next(p_jb);
+            }
+            else
+            {
+                /* There is newer data in the buffer, so the packet we wait for is considered lost. */
+                jitter_buffer_skip_next(p_jb);
+            }
+        }
+        if (produced < count)
+        {
+            ++p_jb->underruns_;
+            p_jb->playing_ = 0;
+        }
+    }
+    if (produced < count)
+        ZeroMemory(&p_samples[produced], (count - produced) * sizeof(int16_t));
+    return produced;
+}
+
+void jitter_buffer_set_residency_histogram(struct jitter_buffer * p_jb, struct latency_histogram * p_histogram)
+{
+    p_jb->residency_ = p_histogram;
+}
+
+uint32_t jitter_buffer_get_lost(struct jitter_buffer const * p_jb)
+{
+    return p_jb->lost_;
+}
+
+uint32_t jitter_buffer_get_dropped(struct jitter_buffer const * p_jb)
+{
+    return p_jb->dropped_;
+}
+
+uint32_t jitter_buffer_get_underruns(struct jitter_buffer const * p_jb)
+{
+    return p_jb->underruns_;
+}
@@ -0,0 +1,154 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+
+/**
+ * @file jitter-buffer.h
+ * @brief Per source jitter buffer.
+ * @details Reorders the packets by their sequence number, conceals losses with silence and absorbs the network jitter.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+#if !defined JITTER_BUFFER_H_3C8E51A0_6B2F_4D7A_9E44_0F1A6C2B8D57
+#define JITTER_BUFFER_H_3C8E51A0_6B2F_4D7A_9E44_0F1A6C2B8D57
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+#include "std-int.h"
+#include <stddef.h>
+
+/*!
+ * @brief Forward declaration.
+ */
+struct jitter_buffer;
+
+/*!
+ * @brief Forward declaration.
+ */
+struct latency_histogram;
+
+/*!
+ * @brief Creates a jitter buffer.
+ * @param[in] level exponent of the number of packet slots. The buffer holds at most 2^level packets.
+ * @param[in] max_samples maximum number of 16-bit samples a single packet may carry.
+ * @param[in] prefill number of packets that have to be buffered before the playout starts.
+ * @return returns a handle to the jitter buffer, or NULL if creation failed.
+ * @sa jitter_buffer_destroy
+ */
+struct jitter_buffer * jitter_buffer_create(uint8_t level, size_t max_samples, unsigned int prefill);
+
+/*!
+ * @brief Destroys the jitter buffer.
+ * @param[in] p_jb a handle to the jitter buffer obtained via call to jitter_buffer_create.
+ */
+void jitter_buffer_destroy(struct jitter_buffer * p_jb);
+
+/*!
+ * @brief Drops all the buffered packets and clears the counters.
+ * @details After the reset, the jitter buffer behaves as if it has just been created.
+ * @param[in] p_jb a handle to the jitter buffer.
+ */
+void jitter_buffer_reset(struct jitter_buffer * p_jb);
+
+/*!
+ * @brief Puts a packet into the jitter buffer.
+ * @details Packets that arrive too late (already played out) and duplicates are dropped. A packet that is
+ * too far ahead of the playout point pushes the playout point forward, i.e. the oldest packets are dropped.
+ * @param[in] p_jb a handle to the jitter buffer.
+ * @param[in] seq sequence number of the packet.
+ * @param[in] p_samples packet payload.
+ * @param[in] samples_count number of samples in the payload.
+ * @return returns non-zero if the packet was accepted, 0 if it was dropped.
+ */
+int jitter_buffer_put(struct jitter_buffer * p_jb, uint16_t seq, int16_t const * p_samples, size_t samples_count);
+
+/*!
+ * @brief Puts a packet into the jitter buffer and remembers when it arrived.
+ * @details Same as jitter_buffer_put, but the arrival time is kept with the packet, so that the time the packet
+ * spends in the buffer can be measured when it is played out.
+ * @param[in] p_jb a handle to the jitter buffer.
+ * @param[in] seq sequence number of the packet.
+ * @param[in] p_samples packet payload.
+ * @param[in] samples_count number of samples in the payload.
+ * @param[in] arrival_time arrival time of the packet, in nanoseconds. 0 means unknown.
+ * @return returns non-zero if the packet was accepted, 0 if it was dropped.
+ */
+int jitter_buffer_put_at(struct jitter_buffer * p_jb, uint16_t seq, int16_t const * p_samples, size_t samples_count, uint64_t arrival_time);
+
+/*!
+ * @brief Returns number of samples that can be read without an underrun.
+ * @param[in] p_jb a handle to the jitter buffer.
+ * @return returns number of samples that are ready for the playout. Returns 0 if the buffer is still prefilling.
+ */
+size_t jitter_buffer_get_available(struct jitter_buffer const * p_jb);
+
+/*!
+ * @brief Reads samples from the jitter buffer, in the sequence number order.
+ * @details Missing packets are skipped if there is newer data behind them. If there is not enough data,
+ * the remaining part of the output is filled with silence and the buffer starts to prefill again.
+ * @param[in] p_jb a handle to the jitter buffer.
+ * @param[out] p_samples buffer that will be written with samples.
+ * @param[in] count number of samples to write.
+ * @return returns number of samples that came from the received packets. The remaining samples are silence.
+ */
+size_t jitter_buffer_read(struct jitter_buffer * p_jb, int16_t * p_samples, size_t count);
+
+/*!
+ * @brief Reads samples from the jitter buffer and measures the residency of the packets played out.
+ * @details Same as jitter_buffer_read. For each packet whose playout starts with this call and whose arrival time
+ * is known, the difference between the playout time and the arrival time is recorded in the residency histogram.
+ * @param[in] p_jb a handle to the jitter buffer.
+ * @param[out] p_samples buffer that will be written with samples.
+ * @param[in] count number of samples to write.
+ * @param[in] playout_time current time, in the same clock and unit as the arrival times.
+ * @return returns number of samples that came from the received packets. The remaining samples are silence.
+ * @sa jitter_buffer_set_residency_histogram
+ */
+size_t jitter_buffer_read_at(struct jitter_buffer * p_jb, int16_t * p_samples, size_t count, uint64_t playout_time);
+
+/*!
+ * @brief Sets the histogram in which the residency of the played out packets is recorded.
+ * @param[in] p_jb a handle to the jitter buffer.
+ * @param[in] p_histogram the histogram, or NULL to stop the measurement. It has to outlive the jitter buffer.
+ */
+void jitter_buffer_set_residency_histogram(struct jitter_buffer * p_jb, struct latency_histogram * p_histogram);
+
+/*!
+ * @brief Returns number of packets that have never been received, but should have been.
+ */
+uint32_t jitter_buffer_get_lost(struct jitter_buffer const * p_jb);
+
+/*!
+ * @brief Returns number of packets that were dropped, because they arrived too late or were duplicated.
+ */
+uint32_t jitter_buffer_get_dropped(struct jitter_buffer const * p_jb);
+
+/*!
+ * @brief Returns number of times the playout ran out of data.
+ */
+uint32_t jitter_buffer_get_underruns(struct jitter_buffer const * p_jb);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* JITTER_BUFFER_H_3C8E51A0_6B2F_4D7A_9E44_0F1A6C2B8D57 */
@@ -0,0 +1,120 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file latency-histogram.c
+ * @brief Log-linear latency histogram.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include "latency-histogram.h"
+
+/*!
+ * @brief Returns the position of the most significant bit set.
+ * @param[in] value the value, must not be 0.
+ */
+static unsigned int get_msb(uint64_t value)
+{
+    unsigned int msb = 0;
+    unsigned int shift;
+    for (shift = 32; shift > 0; shift >>= 1)
+    {
+        if (value >> shift)
+        {
+            value >>= shift;
+            msb += shift;
+        }
+    }
+    return msb;
+}
+
+static unsigned int get_bucket_index(uint64_t value)
+{
+    unsigned int msb;
+    if (value < LATENCY_HISTOGRAM_SUB_COUNT)
+        return (unsigned int)value;
+    msb = get_msb(value);
+    return (msb - LATENCY_HISTOGRAM_SUB_BITS + 1) * LATENCY_HISTOGRAM_SUB_COUNT
+        + (unsigned int)(value >> (msb - LATENCY_HISTOGRAM_SUB_BITS)) - LATENCY_HISTOGRAM_SUB_COUNT;
+}
+
+/*!
+ * @brief Returns the middle of the range of values counted by the given bucket.
+ */
+static uint64_t get_bucket_value(unsigned int index)
+{
+    unsigned int group = index / LATENCY_HISTOGRAM_SUB_COUNT;
+    uint64_t lowest;
+    uint64_t width;
+    if (0 == group)
+        return index;
+    width = (uint64_t)1 << (group - 1);
+    lowest = (uint64_t)(LATENCY_HISTOGRAM_SUB_COUNT + index % LATENCY_HISTOGRAM_SUB_COUNT) << (group - 1);
+    return lowest + (width - 1) / 2;
+}
+
+void latency_histogram_reset(struct latency_histogram * p_histogram)
+{
+    ZeroMemory(p_histogram, sizeof(struct latency_histogram));
+}
+
+void latency_histogram_record(struct latency_histogram * p_histogram, uint64_t value)
+{
+    if (0 == p_histogram->count_ || value < p_histogram->min_)
+        p_histogram->min_ = value;
+    if (value > p_histogram->max_)
+        p_histogram->max_ = value;
+    ++p_histogram->count_;
+    p_histogram->sum_ += value;
+    ++p_histogram->buckets_[get_bucket_index(value)];
+}
+
+uint64_t latency_histogram_get_percentile(struct latency_histogram const * p_histogram, double percentile)
+{
+    uint64_t rank;
+    uint64_t seen = 0;
+    unsigned int idx;
+    if (0 == p_histogram->count_)
+        return 0;
+    rank = (uint64_t)ceil(percentile * p_histogram->count_ / 100.0);
+    rank = max(rank, (uint64_t)1);
+    if (rank >= p_histogram->count_)
+        return p_histogram->max_;
+    for (idx = 0; idx < LATENCY_HISTOGRAM_BUCKETS; ++idx)
+    {
+        seen += p_histogram->buckets_[idx];
+        if (seen >= rank)
+        {
+            uint64_t value = get_bucket_value(idx);
+            value = max(value, p_histogram->min_);
+            return min(value, p_histogram->max_);
+        }
+    }
+    return p_histogram->max_;
+}
+
+uint64_t latency_histogram_get_mean(struct latency_histogram const * p_histogram)
+{
+    if (0 == p_histogram->count_)
+        return 0;
+    return p_histogram->sum_ / p_histogram->count_;
+}
@@ -0,0 +1,102 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+
+/**
+ * @file latency-histogram.h
+ * @brief Log-linear latency histogram.
+ * @details Fixed size histogram that reports percentiles of the measured durations with a bounded relative error.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+#if !defined LATENCY_HISTOGRAM_H_3F6A1C8E_52D7_4B90_A1E4_7C0D9B2E6F13
+#define LATENCY_HISTOGRAM_H_3F6A1C8E_52D7_4B90_A1E4_7C0D9B2E6F13
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+#include "std-int.h"
+
+/*!
+ * @brief Number of bits of the value kept below its most significant bit.
+ * @details Each power of 2 range is split into 2 to power that number equal buckets, so the relative error of
+ * a reported value is below 1/16.
+ */
+#define LATENCY_HISTOGRAM_SUB_BITS (4)
+
+/*!
+ * @brief Number of buckets in each power of 2 range.
+ */
+#define LATENCY_HISTOGRAM_SUB_COUNT (1 << LATENCY_HISTOGRAM_SUB_BITS)
+
+/*!
+ * @brief Number of buckets needed to cover all the 64-bit values.
+ */
+#define LATENCY_HISTOGRAM_BUCKETS ((64 - LATENCY_HISTOGRAM_SUB_BITS + 1) * LATENCY_HISTOGRAM_SUB_COUNT)
+
+/*!
+ * @brief Log-linear histogram of the measured durations.
+ * @details Values below LATENCY_HISTOGRAM_SUB_COUNT are counted exactly, larger values fall into buckets whose width
+ * grows with the value. Recording a value is a constant time operation that never allocates.
+ */
+struct latency_histogram {
+    uint64_t count_; /*!< Number of values recorded. */
+    uint64_t sum_; /*!< Sum of all the values recorded. */
+    uint64_t min_; /*!< Smallest value recorded. */
+    uint64_t max_; /*!< Largest value recorded. */
+    uint32_t buckets_[LATENCY_HISTOGRAM_BUCKETS]; /*!< Number of values recorded in each bucket. */
+};
+
+/*!
+ * @brief Removes all the values from the histogram.
+ * @param[in,out] p_histogram the histogram.
+ */
+void latency_histogram_reset(struct latency_histogram * p_histogram);
+
+/*!
+ * @brief Records a single value.
+ * @param[in,out] p_histogram the histogram.
+ * @param[in] value the value, in any unit, as long as it is the same for all the values.
+ */
+void latency_histogram_record(struct latency_histogram * p_histogram, uint64_t value);
+
+/*!
+ * @brief Returns the value below which the given percent of recorded values lie.
+ * @param[in] p_histogram the histogram.
+ * @param[in] percentile the percentile, from 0 to 100, e.g. 99.9.
+ * @return returns the middle of the bucket the percentile falls into, clamped to the recorded minimum and maximum.
+ * The 100th percentile is the recorded maximum.
+ * Returns 0 if nothing has been recorded yet.
+ */
+uint64_t latency_histogram_get_percentile(struct latency_histogram const * p_histogram, double percentile);
+
+/*!
+ * @brief Returns the mean of the recorded values.
+ * @param[in] p_histogram the histogram.
+ * @return returns the mean, or 0 if nothing has been recorded yet.
+ */
+uint64_t latency_histogram_get_mean(struct latency_histogram const * p_histogram);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* LATENCY_HISTOGRAM_H_3F6A1C8E_52D7_4B90_A1E4_7C0D9B2E6F13 */
@@ -0,0 +1,131 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file latency-probe.c
+ * @brief End-to-end latency probe.
+ * @details Collects the network transit and the jitter buffer residency distributions of the packets that carry their send time.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include "latency-probe.h"
+#include "latency-histogram.h"
+#include "debug_helpers.h"
+
+/*!
+ * @brief Number of 100ns intervals between 1-Jan-1601 and 1-Jan-1970.
+ */
+#define FILETIME_UNIX_EPOCH (116444736000000000ULL)
+
+/*!
+ * @brief The probe.
+ */
+struct latency_probe {
+    uint64_t skewed_; /*!< Number of packets that arrived before their send time. */
+    struct latency_histogram transit_; /*!< Network transit times. */
+    struct latency_histogram residency_; /*!< Jitter buffer residency times. */
+};
+
+uint64_t latency_probe_get_time(void)
+{
+#if defined WIN32
+    FILETIME now;
+    ULARGE_INTEGER value;
+    GetSystemTimeAsFileTime(&now);
+    value.LowPart = now.dwLowDateTime;
+    value.HighPart = now.dwHighDateTime;
+    return (value.QuadPart - FILETIME_UNIX_EPOCH) * 100;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+#endif
+}
+
+struct latency_probe * latency_probe_create(void)
+{
+    struct latency_probe * p_probe = (struct latency_probe *)calloc(1, sizeof(struct latency_probe));
+    if (NULL != p_probe)
+        latency_probe_reset(p_probe);
+    return p_probe;
+}
+
+void latency_probe_destroy(struct latency_probe * p_probe)
+{
+    free(p_probe);
+}
+
+void latency_probe_record_transit(struct latency_probe * p_probe, uint64_t send_time, uint64_t arrival_time)
+{
+    if (arrival_time >= send_time)
+        latency_histogram_record(&p_probe->transit_, arrival_time - send_time);
+    else
+        ++p_probe->skewed_;
+}
+
+struct latency_histogram const * latency_probe_get_transit(struct latency_probe const * p_probe)
+{
+    return &p_probe->transit_;
+}
+
+struct latency_histogram * latency_probe_get_residency(struct latency_probe * p_probe)
+{
+    return &p_probe->residency_;
+}
+
+uint64_t latency_probe_get_skewed(struct latency_probe const * p_probe)
+{
+    return p_probe->skewed_;
+}
+
+/*!
+ * @brief Prints a single distribution, in microseconds.
+ */
+static void dump_histogram(struct latency_histogram const * p_histogram, char const * psz_name)
+{
+    if (0 != p_histogram->count_)
+    {
+        debug_outputln("%s %4.4u : %s n:%lu min:%.1f mean:%.1f p50:%.1f p99:%.1f p99.9:%.1f max:%.1f [us]", __FILE__, __LINE__, psz_name,
+                (unsigned long)p_histogram->count_,
+                p_histogram->min_ / 1000.0,
+                latency_histogram_get_mean(p_histogram) / 1000.0,
+                latency_histogram_get_percentile(p_histogram, 50.0) / 1000.0,
+                latency_histogram_get_percentile(p_histogram, 99.0) / 1000.0,
+                latency_histogram_get_percentile(p_histogram, 99.9) / 1000.0,
+                p_histogram->max_ / 1000.0);
+    }
+}
+
+void latency_probe_dump(struct latency_probe const * p_probe)
+{
+    dump_histogram(&p_probe->transit_, "transit");
+    dump_histogram(&p_probe->residency_, "residency");
+    if (0 != p_probe->skewed_)
+        debug_outputln("%s %4.4u : skewed:%lu", __FILE__, __LINE__, (unsigned long)p_probe->skewed_);
+}
+
+void latency_probe_reset(struct latency_probe * p_probe)
+{
+    p_probe->skewed_ = 0;
+    latency_histogram_reset(&p_probe->transit_);
+    latency_histogram_reset(&p_probe->residency_);
+}
@@ -0,0 +1,111 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+
+/**
+ * @file latency-probe.h
+ * @brief End-to-end latency probe.
+ * @details Collects the network transit and the jitter buffer residency distributions of the packets that carry their send time.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+#if !defined LATENCY_PROBE_H_8A2D4F61_C37B_4E05_9D18_5B6E0A7C3F92
+#define LATENCY_PROBE_H_8A2D4F61_C37B_4E05_9D18_5B6E0A7C3F92
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+#include "std-int.h"
+
+/*!
+ * @brief Forward declaration.
+ */
+struct latency_probe;
+
+/*!
+ * @brief Forward declaration.
+ */
+struct latency_histogram;
+
+/*!
+ * @brief Returns the wall clock time, in nanoseconds since the Unix epoch.
+ * @details This is the clock the senders stamp the packets with. Transit times are meaningful only if the clocks
+ * of the sender and the receiver are synchronized, e.g. with PTP, or when both run on the same host.
+ */
+uint64_t latency_probe_get_time(void);
+
+/*!
+ * @brief Creates the probe.
+ * @return returns a handle to the probe, or NULL if creation failed.
+ * @sa latency_probe_destroy
+ */
+struct latency_probe * latency_probe_create(void);
+
+/*!
+ * @brief Destroys the probe.
+ * @param[in] p_probe a handle to the probe obtained via call to latency_probe_create.
+ */
+void latency_probe_destroy(struct latency_probe * p_probe);
+
+/*!
+ * @brief Records the network transit time of a single packet.
+ * @details Packets that seem to arrive before they were sent are not recorded, but counted as skewed, as that
+ * tells that the clocks are not synchronized well enough.
+ * @param[in] p_probe a handle to the probe.
+ * @param[in] send_time send time carried by the packet, in nanoseconds.
+ * @param[in] arrival_time arrival time of the packet, as returned by latency_probe_get_time.
+ */
+void latency_probe_record_transit(struct latency_probe * p_probe, uint64_t send_time, uint64_t arrival_time);
+
+/*!
+ * @brief Returns the histogram of the network transit times, in nanoseconds.
+ */
+struct latency_histogram const * latency_probe_get_transit(struct latency_probe const * p_probe);
+
+/*!
+ * @brief Returns the histogram of the jitter buffer residency times, in nanoseconds.
+ * @details The probe does not measure the residency itself, the histogram is to be handed over to the mixer.
+ * @sa audio_mixer_set_residency_histogram
+ */
+struct latency_histogram * latency_probe_get_residency(struct latency_probe * p_probe);
+
+/*!
+ * @brief Returns number of packets that arrived before their send time.
+ */
+uint64_t latency_probe_get_skewed(struct latency_probe const * p_probe);
+
+/*!
+ * @brief Prints both distributions to the debug output.
+ * @param[in] p_probe a handle to the probe.
+ */
+void latency_probe_dump(struct latency_probe const * p_probe);
+
+/*!
+ * @brief Removes all the values from both distributions.
+ * @param[in] p_probe a handle to the probe.
+ */
+void latency_probe_reset(struct latency_probe * p_probe);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* LATENCY_PROBE_H_8A2D4F61_C37B_4E05_9D18_5B6E0A7C3F92 */
@@ -0,0 +1,473 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file mcast-loopback-linux.c
+ * @brief End to end throughput and latency harness.
+ * @details Runs the sending and the receiving pipeline in one process over the multicast loopback of the host, drives a number of synthetic streams at a fixed rate and reports the delivered throughput, loss, jitter and latency percentiles.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include <getopt.h>
+#include <pthread.h>
+#include "mcast-settings.h"
+#include "mcast_setup.h"
+#include "mcast-packet.h"
+#include "audio-mixer.h"
+#include "latency-histogram.h"
+#include "latency-probe.h"
+#include "stream-stats.h"
+#include "net-impair.h"
+#include "tone-generator.h"
+#include "debug_helpers.h"
+
+#define MCAST_GROUP_ADDRESS "239.0.0.1"
+#define MCAST_PORT_NUMBER (25000)
+#define MAX_PACKET_SIZE (2048)
+#define JITTER_LEVEL (4)
+#define JITTER_PREFILL (2)
+#define MIX_BLOCK (256)
+
+/*!
+ * @brief Synchronization source of the first synthetic stream, the next streams take the following values.
+ */
+#define FIRST_SSRC (0x4c4f0000)
+
+/*!
+ * @brief How long the receiver keeps going after the last datagram was sent, in milliseconds.
+ */
+#define DRAIN_TIME_MS (200)
+
+/*!
+ * @brief Run parameters.
+ */
+struct loopback_config {
+    struct mcast_settings settings_; /*!< Group and port both sides use. */
+    unsigned int streams_; /*!< Number of synthetic streams. */
+    unsigned int rate_; /*!< Packets per second sent on each stream. */
+    unsigned int payload_size_; /*!< Number of PCM bytes in each packet. */
+    unsigned int duration_; /*!< How long the streams are sent, in seconds. */
+};
+
+/*!
+ * @brief Per stream state of the receiver.
+ */
+struct loopback_stream {
+    int has_previous_; /*!< Non-zero once a packet has been received. */
+    uint64_t previous_send_; /*!< Send time of the last packet received. */
+    uint64_t previous_arrival_; /*!< Arrival time of the last packet received. */
+    double jitter_; /*!< Interarrival jitter, in nanoseconds, as defined by RFC 3550 section 6.4.1. */
+};
+
+/*!
+ * @brief State shared by the sender and the receiver thread.
+ */
+struct loopback {
+    struct loopback_config config_; /*!< Run parameters. */
+    struct mcast_connection sender_; /*!< Connection the streams are sent on. */
+    struct mcast_connection receiver_; /*!< Connection the streams are received on. */
+    struct net_impair * p_impair_; /*!< Impairs the sent datagrams, NULL if the network is to be left alone. */
+    uint64_t sent_packets_; /*!< Written by the sender thread only. */
+    uint64_t sent_bytes_; /*!< Written by the sender thread only. */
+    uint64_t send_errors_; /*!< Written by the sender thread only. */
+    uint64_t late_sends_; /*!< Number of send rounds that started more than a period late. */
+    int stop_; /*!< Set by the sender thread when the receiver is to exit. */
+    struct audio_mixer * p_mixer_; /*!< The receiving pipeline. */
+    struct latency_probe * p_probe_; /*!< Send to arrival times. */
+    struct stream_stats * p_stats_; /*!< Loss and reordering. */
+    struct stream_stats_writer * p_writer_; /*!< The receiver's writer of p_stats_. */
+    struct loopback_stream streams_[STREAM_STATS_MAX_STREAMS]; /*!< Indexed by ssrc - FIRST_SSRC. */
+    struct tone_generator * p_tones_[STREAM_STATS_MAX_STREAMS]; /*!< Signal of each stream, NULL if the stream sends the ramp. */
+};
+
+static uint8_t g_send_buffer[MAX_PACKET_SIZE];
+static uint8_t g_receive_buffer[MAX_PACKET_SIZE];
+static int16_t g_mixed[MIX_BLOCK];
+
+static void timespec_add_ns(struct timespec * p_time, uint64_t ns)
+{
+    ns += p_time->tv_nsec;
+    p_time->tv_sec += ns / 1000000000ULL;
+    p_time->tv_nsec = ns % 1000000000ULL;
+}
+
+static int64_t timespec_diff_ns(struct timespec const * p_later, struct timespec const * p_earlier)
+{
+    return (int64_t)(p_later->tv_sec - p_earlier->tv_sec) * 1000000000LL + (p_later->tv_nsec - p_earlier->tv_nsec);
+}
+
+/*!
+ * @brief Sleeps until the deadline, sending the delayed datagrams that fall due in the meantime.
+ * @details Both perf_counter_get_monotonic_ns, which the shim uses, and the deadlines are on CLOCK_MONOTONIC.
+ */
+static void wait_until(struct loopback * p_loopback, struct timespec const * p_deadline)
+{
+    uint64_t const deadline = (uint64_t)p_deadline->tv_sec * 1000000000ULL + (uint64_t)p_deadline->tv_nsec;
+    if (NULL != p_loopback->p_impair_)
+    {
+        uint64_t due;
+        while ((due = net_impair_get_next_due(p_loopback->p_impair_)) < deadline)
+        {
+            struct timespec wake = { (time_t)(due / 1000000000ULL), (long)(due % 1000000000ULL) };
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, NULL);
+            net_impair_flush(p_loopback->p_impair_, &p_loopback->sender_);
+        }
+    }
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, p_deadline, NULL);
+}
+
+/*!
+ * @brief Sends one packet of each stream per period, for the configured duration.
+ * @details The periods are counted from the start on an absolute clock, so the rate does not drift when a round
+ * is late. The samples are a ramp, their values do not matter for the measurement, unless a signal is to be generated
+ * for each stream.
+ */
+static void * sender_routine(void * p_param)
+{
+    struct loopback * p_loopback = (struct loopback *)p_param;
+    struct loopback_config const * p_config = &p_loopback->config_;
+    uint64_t const period = 1000000000ULL / p_config->rate_;
+    uint64_t const rounds = (uint64_t)p_config->rate_ * p_config->duration_;
+    uint16_t seq[STREAM_STATS_MAX_STREAMS] = { 0 };
+    struct timespec deadline;
+    uint64_t round;
+    unsigned int idx;
+    for (idx = 0; idx < MAX_PACKET_SIZE/sizeof(int16_t); ++idx)
+        ((int16_t *)g_send_buffer)[idx] = (int16_t)(idx * 64);
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    for (round = 0; round < rounds; ++round)
+    {
+        struct timespec now;
+        wait_until(p_loopback, &deadline);
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (timespec_diff_ns(&now, &deadline) > (int64_t)period)
+            ++p_loopback->late_sends_;
+        for (idx = 0; idx < p_config->streams_; ++idx)
+        {
+            struct mcast_packet_header header;
+            uint8_t packet[MAX_PACKET_SIZE];
+            size_t header_size;
+            ZeroMemory(&header, sizeof(header));
+            header.version_ = MCAST_PACKET_VERSION;
+            header.seq_ = seq[idx]++;
+            header.timestamp_ = (uint32_t)(round * p_config->payload_size_ / sizeof(int16_t));
+            header.ssrc_ = FIRST_SSRC + idx;
+            header_size = mcast_packet_header_encode_timed(&header, latency_probe_get_time(), packet, sizeof(packet));
+            if (NULL != p_loopback->p_tones_[idx])
+            {
+                int16_t samples[MAX_PACKET_SIZE/sizeof(int16_t)];
+                tone_generator_fill(p_loopback->p_tones_[idx], samples, p_config->payload_size_ / sizeof(int16_t));
+                CopyMemory(&packet[header_size], samples, p_config->payload_size_);
+            }
+            else
+                CopyMemory(&packet[header_size], g_send_buffer, p_config->payload_size_);
+            if (header_size + p_config->payload_size_ == net_impair_sendto(p_loopback->p_impair_, &p_loopback->sender_, packet, header_size + p_config->payload_size_))
+            {
+                ++p_loopback->sent_packets_;
+                p_loopback->sent_bytes_ += header_size + p_config->payload_size_;
+            }
+            else
+                ++p_loopback->send_errors_;
+        }
+        timespec_add_ns(&deadline, period);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    timespec_add_ns(&deadline, DRAIN_TIME_MS * 1000000ULL);
+    wait_until(p_loopback, &deadline);
+    __atomic_store_n(&p_loopback->stop_, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+/*!
+ * @brief Updates the interarrival jitter of the stream the packet belongs to.
+ */
+static void update_jitter(struct loopback * p_loopback, uint32_t ssrc, uint64_t send_time, uint64_t arrival_time)
+{
+    struct loopback_stream * p_stream;
+    if (ssrc - FIRST_SSRC >= p_loopback->config_.streams_)
+        return;
+    p_stream = &p_loopback->streams_[ssrc - FIRST_SSRC];
+    if (p_stream->has_previous_)
+    {
+        double transit_change = ((double)arrival_time - (double)p_stream->previous_arrival_)
+            - ((double)send_time - (double)p_stream->previous_send_);
+        p_stream->jitter_ += (fabs(transit_change) - p_stream->jitter_) / 16.0;
+    }
+    p_stream->has_previous_ = 1;
+    p_stream->previous_send_ = send_time;
+    p_stream->previous_arrival_ = arrival_time;
+}
+
+/*!
+ * @brief Receives the streams and feeds them through the mixer, the same way mcast-receiver does.
+ */
+static void * receiver_routine(void * p_param)
+{
+    struct loopback * p_loopback = (struct loopback *)p_param;
+    while (!__atomic_load_n(&p_loopback->stop_, __ATOMIC_ACQUIRE))
+    {
+        struct mcast_packet_header header;
+        size_t bytes_read;
+        size_t payload_offset;
+        uint64_t arrival_time;
+        uint64_t send_time;
+        if (mcast_is_new_data(&p_loopback->receiver_, 100) <= 0)
+            continue;
+        bytes_read = mcast_recvfrom(&p_loopback->receiver_, g_receive_buffer, sizeof(g_receive_buffer));
+        arrival_time = latency_probe_get_time();
+        if ((size_t)-1 == bytes_read)
+            continue;
+        payload_offset = mcast_packet_header_decode(&header, g_receive_buffer, bytes_read);
+        if (0 == payload_offset)
+            continue;
+        stream_stats_on_packet(p_loopback->p_writer_, header.ssrc_, header.seq_, bytes_read);
+        if (mcast_packet_header_get_send_time(&header, g_receive_buffer, &send_time))
+        {
+            latency_probe_record_transit(p_loopback->p_probe_, send_time, arrival_time);
+            update_jitter(p_loopback, header.ssrc_, send_time, arrival_time);
+        }
+        audio_mixer_push_at(p_loopback->p_mixer_, header.ssrc_, header.seq_, (int16_t const *)&g_receive_buffer[payload_offset],
+                (bytes_read - payload_offset)/sizeof(int16_t), arrival_time);
+        while (audio_mixer_get_available(p_loopback->p_mixer_) >= MIX_BLOCK)
+            audio_mixer_mix_at(p_loopback->p_mixer_, g_mixed, MIX_BLOCK, latency_probe_get_time());
+    }
+    return NULL;
+}
+
+/*!
+ * @brief Writes the results as a single JSON line, so that the runs of different revisions are easy to compare.
+ */
+static double report(FILE * fp, struct loopback const * p_loopback, double elapsed)
+{
+    struct stream_stats_stream streams[STREAM_STATS_MAX_STREAMS];
+    struct latency_histogram const * p_transit = latency_probe_get_transit(p_loopback->p_probe_);
+    unsigned int count = stream_stats_snapshot(p_loopback->p_stats_, streams, COUNTOF_ARRAY(streams));
+    uint64_t received_packets = 0;
+    uint64_t received_bytes = 0;
+    uint64_t reordered = 0;
+    double jitter_sum = 0.0;
+    double jitter_max = 0.0;
+    struct net_impair_stats impair;
+    double loss;
+    unsigned int idx;
+    ZeroMemory(&impair, sizeof(impair));
+    if (NULL != p_loopback->p_impair_)
+        net_impair_get_stats(p_loopback->p_impair_, &impair);
+    for (idx = 0; idx < count; ++idx)
+    {
+        received_packets += streams[idx].packets_;
+        received_bytes += streams[idx].bytes_;
+        reordered += streams[idx].reordered_;
+    }
+    for (idx = 0; idx < p_loopback->config_.streams_; ++idx)
+    {
+        jitter_sum += p_loopback->streams_[idx].jitter_;
+        jitter_max = max(jitter_max, p_loopback->streams_[idx].jitter_);
+    }
+    /* The tail losses are not visible in the sequence numbers, so the loss is counted against what was sent. */
+    loss = 0 == p_loopback->sent_packets_ ? 100.0
+        : 100.0 * (double)(p_loopback->sent_packets_ - min(received_packets, p_loopback->sent_packets_)) / p_loopback->sent_packets_;
+    fprintf(fp, "{\"name\":\"loopback\",\"streams\":%u,\"rate\":%u,\"payload\":%u,\"duration_s\":%.3f,"
+            "\"sent\":%llu,\"send_errors\":%llu,\"impaired_lost\":%llu,\"impaired_duplicated\":%llu,\"late_sends\":%llu,\"received\":%llu,\"reordered\":%llu,\"loss_pct\":%.3f,"
+            "\"mbit_per_s\":%.3f,\"jitter_mean_us\":%.3f,\"jitter_max_us\":%.3f,"
+            "\"latency_mean_us\":%.3f,\"latency_p50_us\":%.3f,\"latency_p99_us\":%.3f,\"latency_p999_us\":%.3f,\"latency_max_us\":%.3f}\n",
+            p_loopback->config_.streams_, p_loopback->config_.rate_, p_loopback->config_.payload_size_, elapsed,
+            (unsigned long long)p_loopback->sent_packets_,
+            (unsigned long long)p_loopback->send_errors_,
+            (unsigned long long)(impair.lost_ + impair.overflows_),
+            (unsigned long long)impair.duplicated_,
+            (unsigned long long)p_loopback->late_sends_,
+            (unsigned long long)received_packets,
+            (unsigned long long)reordered,
+            loss,
+            received_bytes * 8.0 / elapsed / 1e6,
+            jitter_sum / p_loopback->config_.streams_ / 1e3,
+            jitter_max / 1e3,
+            latency_histogram_get_mean(p_transit) / 1e3,
+            latency_histogram_get_percentile(p_transit, 50.0) / 1e3,
+            latency_histogram_get_percentile(p_transit, 99.0) / 1e3,
+            latency_histogram_get_percentile(p_transit, 99.9) / 1e3,
+            latency_histogram_get_percentile(p_transit, 100.0) / 1e3);
+    return loss;
+}
+
+static void usage(char const * psz_name)
+{
+    fprintf(stderr, "Usage: %s [-g group] [-p port] [-n streams] [-r rate] [-s size] [-d duration] [-l loss] [-i impairments] [-t signal]\n"
+            "  -g  multicast group, default " MCAST_GROUP_ADDRESS "\n"
+            "  -p  port, default %u\n"
+            "  -n  number of streams, default 4, at most %u\n"
+            "  -r  packets per second on each stream, default 50\n"
+            "  -s  PCM bytes in each packet, default 1024\n"
+            "  -d  duration in seconds, default 5\n"
+            "  -l  fails if more than the given percent of packets is lost\n"
+            "  -i  impairs the sent datagrams, e.g. seed=1,loss=2,jitter=5, see net_impair_parse\n"
+            "      defaults to the " NET_IMPAIR_VARIABLE " environment variable\n"
+            "  -t  sends a generated mono signal on each stream instead of the ramp, e.g. multi:440:660 or pink\n"
+            "      each stream has its own seed, and its tones 10 Hz above the previous stream's, see tone_generator_parse\n", psz_name, MCAST_PORT_NUMBER, STREAM_STATS_MAX_STREAMS);
+}
+
+int main(int argc, char ** argv)
+{
+    static struct loopback loopback;
+    struct loopback_config * p_config = &loopback.config_;
+    char const * psz_group = MCAST_GROUP_ADDRESS;
+    unsigned int port = MCAST_PORT_NUMBER;
+    double max_loss = 100.0;
+    pthread_t sender;
+    pthread_t receiver;
+    struct timespec start;
+    struct timespec stop;
+    struct net_impair_config impair;
+    int has_impair = 0;
+    char const * psz_tone = NULL;
+    unsigned int idx;
+    int option;
+    p_config->streams_ = 4;
+    p_config->rate_ = 50;
+    p_config->payload_size_ = 1024;
+    p_config->duration_ = 5;
+    while (-1 != (option = getopt(argc, argv, "g:p:n:r:s:d:l:i:t:h")))
+    {
+        switch (option)
+        {
+            case 'g':
+                psz_group = optarg;
+                break;
+            case 'p':
+                port = (unsigned int)strtoul(optarg, NULL, 10);
+                break;
+            case 'n':
+                p_config->streams_ = (unsigned int)strtoul(optarg, NULL, 10);
+                break;
+            case 'r':
+                p_config->rate_ = (unsigned int)strtoul(optarg, NULL, 10);
+                break;
+            case 's':
+                p_config->payload_size_ = (unsigned int)strtoul(optarg, NULL, 10);
+                break;
+            case 'd':
+                p_config->duration_ = (unsigned int)strtoul(optarg, NULL, 10);
+                break;
+            case 'l':
+                max_loss = strtod(optarg, NULL);
+                break;
+            case 'i':
+                has_impair = net_impair_parse(&impair, optarg);
+                if (!has_impair)
+                {
+                    fprintf(stderr, "%4.4u %s : bad impairments '%s'\n", __LINE__, __FILE__, optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 't':
+                psz_tone = optarg;
+                break;
+            default:
+                usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (0 == p_config->streams_ || p_config->streams_ > STREAM_STATS_MAX_STREAMS
+            || 0 == p_config->rate_ || p_config->rate_ > 1000000
+            || p_config->payload_size_ > MAX_PACKET_SIZE - MCAST_PACKET_HEADER_SIZE - 4 * MCAST_PACKET_SEND_TIME_WORDS
+            || 0 != p_config->payload_size_ % sizeof(int16_t)
+            || port > 0xffff)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    p_config->settings_.nTTL_ = 1;
+    if (!mcast_settings_set_group(&p_config->settings_, psz_group, (unsigned short)port)
+            || !mcast_settings_validate(&p_config->settings_))
+    {
+        fprintf(stderr, "%4.4u %s : bad group '%s'\n", __LINE__, __FILE__, psz_group);
+        return EXIT_FAILURE;
+    }
+    /* Both ends join the group, the datagrams reach the receiver through the multicast loopback of the host. */
+    if (!setup_multicast_indirect(&p_config->settings_, &loopback.receiver_)
+            || !setup_multicast_indirect(&p_config->settings_, &loopback.sender_))
+    {
+        fprintf(stderr, "%4.4u %s : cannot join %s:%u\n", __LINE__, __FILE__, psz_group, port);
+        return EXIT_FAILURE;
+    }
+    for (idx = 0; idx < p_config->streams_ && NULL != psz_tone; ++idx)
+    {
+        /* The signal runs at the rate the packets carry the samples, so it plays in real time. */
+        struct tone_generator_config tone;
+        if (tone_generator_parse(&tone, psz_tone))
+        {
+            unsigned int freq_idx;
+            tone.sample_rate_ = p_config->rate_ * (p_config->payload_size_ / sizeof(int16_t));
+            tone.channels_ = 1;
+            tone.seed_ += idx;
+            if (TONE_GENERATOR_SINE == tone.type_ || TONE_GENERATOR_MULTI == tone.type_)
+                for (freq_idx = 0; freq_idx < tone.tones_count_; ++freq_idx)
+                    tone.frequencies_[freq_idx] += 10.0f * idx;
+            loopback.p_tones_[idx] = tone_generator_create(&tone);
+        }
+        if (NULL == loopback.p_tones_[idx])
+        {
+            fprintf(stderr, "%4.4u %s : bad signal '%s' for stream %u\n", __LINE__, __FILE__, psz_tone, idx);
+            return EXIT_FAILURE;
+        }
+    }
+    loopback.p_mixer_ = audio_mixer_create(p_config->streams_, JITTER_LEVEL, MAX_PACKET_SIZE/sizeof(int16_t), JITTER_PREFILL);
+    loopback.p_probe_ = latency_probe_create();
+    loopback.p_stats_ = stream_stats_create();
+    loopback.p_impair_ = has_impair ? net_impair_create(&impair) : net_impair_create_from_env();
+    loopback.p_writer_ = NULL != loopback.p_stats_ ? stream_stats_add_writer(loopback.p_stats_) : NULL;
+    if (NULL == loopback.p_mixer_ || NULL == loopback.p_probe_ || NULL == loopback.p_writer_)
+    {
+        fprintf(stderr, "%4.4u %s : out of memory\n", __LINE__, __FILE__);
+        return EXIT_FAILURE;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (0 != pthread_create(&receiver, NULL, &receiver_routine, &loopback))
+        return EXIT_FAILURE;
+    if (0 != pthread_create(&sender, NULL, &sender_routine, &loopback))
+    {
+        __atomic_store_n(&loopback.stop_, 1, __ATOMIC_RELEASE);
+        pthread_join(receiver, NULL);
+        return EXIT_FAILURE;
+    }
+    pthread_join(sender, NULL);
+    pthread_join(receiver, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    /* The drain time is not part of the measured interval. */
+    if (report(stdout, &loopback, timespec_diff_ns(&stop, &start) / 1e9 - DRAIN_TIME_MS / 1e3) > max_loss)
+    {
+        fprintf(stderr, "%4.4u %s : loss above %.3f%%\n", __LINE__, __FILE__, max_loss);
+        option = EXIT_FAILURE;
+    }
+    else
+        option = 0;
+    for (idx = 0; idx < p_config->streams_; ++idx)
+        tone_generator_destroy(loopback.p_tones_[idx]);
+    net_impair_destroy(loopback.p_impair_);
+    stream_stats_destroy(loopback.p_stats_);
+    latency_probe_destroy(loopback.p_probe_);
+    audio_mixer_destroy(loopback.p_mixer_);
+    close_multicast(&loopback.sender_);
+    close_multicast(&loopback.receiver_);
+    return option;
+}
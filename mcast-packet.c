@@ -0,0 +1,159 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file mcast-packet.c
+ * @brief Audio datagram header encoding and decoding.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include "mcast-packet.h"
+
+/*!
+ * @brief First byte of every packet that carries the header.
+ */
+#define MCAST_PACKET_MAGIC_0 ('M')
+
+/*!
+ * @brief Second byte of every packet that carries the header.
+ */
+#define MCAST_PACKET_MAGIC_1 ('C')
+
+static void put_u16(uint8_t * p_dest, uint16_t value)
+{
+    p_dest[0] = (uint8_t)(value >> 8);
+    p_dest[1] = (uint8_t)(value);
+}
+
+static void put_u32(uint8_t * p_dest, uint32_t value)
+{
+    p_dest[0] = (uint8_t)(value >> 24);
+    p_dest[1] = (uint8_t)(value >> 16);
+    p_dest[2] = (uint8_t)(value >> 8);
+    p_dest[3] = (uint8_t)(value);
+}
+
+static uint16_t get_u16(uint8_t const * p_src)
+{
+    return (uint16_t)((p_src[0] << 8) | p_src[1]);
+}
+
+static uint32_t get_u32(uint8_t const * p_src)
+{
+    return ((uint32_t)p_src[0] << 24) | ((uint32_t)p_src[1] << 16) | ((uint32_t)p_src[2] << 8) | (uint32_t)p_src[3];
+}
+
+size_t mcast_packet_header_encode(struct mcast_packet_header const * p_header, uint8_t * p_buffer, size_t buffer_size)
+{
+    if (buffer_size < MCAST_PACKET_HEADER_SIZE)
+        return 0;
+    p_buffer[0] = MCAST_PACKET_MAGIC_0;
+    p_buffer[1] = MCAST_PACKET_MAGIC_1;
+    p_buffer[2] = p_header->version_;
+    p_buffer[3] = p_header->flags_;
+    put_u16(&p_buffer[4], p_header->seq_);
+    put_u16(&p_buffer[6], p_header->ext_words_);
+    put_u32(&p_buffer[8], p_header->timestamp_);
+    put_u32(&p_buffer[12], p_header->ssrc_);
+    return MCAST_PACKET_HEADER_SIZE;
+}
+
+size_t mcast_packet_header_decode(struct mcast_packet_header * p_header, uint8_t const * p_buffer, size_t buffer_size)
+{
+    size_t payload_offset;
+    if (buffer_size < MCAST_PACKET_HEADER_SIZE)
+        return 0;
+    if (MCAST_PACKET_MAGIC_0 != p_buffer[0] || MCAST_PACKET_MAGIC_1 != p_buffer[1] || MCAST_PACKET_VERSION != p_buffer[2])
+        return 0;
+    p_header->version_ = p_buffer[2];
+    p_header->flags_ = p_buffer[3];
+    p_header->seq_ = get_u16(&p_buffer[4]);
+    p_header->ext_words_ = get_u16(&p_buffer[6]);
+    p_header->reserved_ = 0;
+    p_header->timestamp_ = get_u32(&p_buffer[8]);
+    p_header->ssrc_ = get_u32(&p_buffer[12]);
+    payload_offset = MCAST_PACKET_HEADER_SIZE + 4*(size_t)p_header->ext_words_;
+    if (payload_offset > buffer_size)
+        return 0;
+    return payload_offset;
+}
+
+size_t mcast_packet_header_encode_timed(struct mcast_packet_header const * p_header, uint64_t send_time, uint8_t * p_buffer, size_t buffer_size)
+{
+    struct mcast_packet_header header = *p_header;
+    size_t const payload_offset = MCAST_PACKET_HEADER_SIZE + 4*MCAST_PACKET_SEND_TIME_WORDS;
+    if (buffer_size < payload_offset)
+        return 0;
+    header.flags_ |= MCAST_PACKET_FLAGS_SEND_TIME;
+    header.ext_words_ = MCAST_PACKET_SEND_TIME_WORDS;
+    mcast_packet_header_encode(&header, p_buffer, buffer_size);
+    put_u32(&p_buffer[MCAST_PACKET_HEADER_SIZE], (uint32_t)(send_time >> 32));
+    put_u32(&p_buffer[MCAST_PACKET_HEADER_SIZE + 4], (uint32_t)send_time);
+    return payload_offset;
+}
+
+int mcast_packet_header_get_send_time(struct mcast_packet_header const * p_header, uint8_t const * p_buffer, uint64_t * p_send_time)
+{
+    /* The decoder already made sure that all the extension words are within the datagram. */
+    if (0 == (p_header->flags_ & MCAST_PACKET_FLAGS_SEND_TIME) || p_header->ext_words_ < MCAST_PACKET_SEND_TIME_WORDS)
+        return 0;
+    *p_send_time = ((uint64_t)get_u32(&p_buffer[MCAST_PACKET_HEADER_SIZE]) << 32) | get_u32(&p_buffer[MCAST_PACKET_HEADER_SIZE + 4]);
+    return 1;
+}
+
+size_t mcast_packet_header_encode_stream(struct mcast_packet_header const * p_header, uint64_t send_time, uint32_t sample_rate, unsigned int channels, uint8_t * p_buffer, size_t buffer_size)
+{
+    struct mcast_packet_header header = *p_header;
+    size_t const payload_offset = MCAST_PACKET_HEADER_SIZE + 4*(MCAST_PACKET_SEND_TIME_WORDS + MCAST_PACKET_FORMAT_WORDS);
+    if (buffer_size < payload_offset)
+        return 0;
+    header.flags_ |= MCAST_PACKET_FLAGS_FORMAT;
+    mcast_packet_header_encode_timed(&header, send_time, p_buffer, buffer_size);
+    /* The timed encoder counted its own words only. */
+    put_u16(&p_buffer[6], MCAST_PACKET_SEND_TIME_WORDS + MCAST_PACKET_FORMAT_WORDS);
+    put_u32(&p_buffer[MCAST_PACKET_HEADER_SIZE + 4*MCAST_PACKET_SEND_TIME_WORDS], ((uint32_t)(channels & 0xff) << 24) | (sample_rate & 0xffffff));
+    return payload_offset;
+}
+
+int mcast_packet_header_get_format(struct mcast_packet_header const * p_header, uint8_t const * p_buffer, uint32_t * p_sample_rate, unsigned int * p_channels)
+{
+    size_t word = (0 != (p_header->flags_ & MCAST_PACKET_FLAGS_SEND_TIME)) ? MCAST_PACKET_SEND_TIME_WORDS : 0;
+    uint32_t format;
+    if (0 == (p_header->flags_ & MCAST_PACKET_FLAGS_FORMAT) || p_header->ext_words_ < word + MCAST_PACKET_FORMAT_WORDS)
+        return 0;
+    format = get_u32(&p_buffer[MCAST_PACKET_HEADER_SIZE + 4*word]);
+    *p_sample_rate = format & 0xffffff;
+    *p_channels = format >> 24;
+    return 0 != *p_sample_rate && 0 != *p_channels;
+}
+
+uint32_t mcast_packet_source_key(struct sockaddr_storage const * p_from)
+{
+    if (AF_INET6 == p_from->ss_family)
+    {
+        struct sockaddr_in6 const * p_from6 = (struct sockaddr_in6 const *)p_from;
+        uint32_t words[4];
+        memcpy(words, &p_from6->sin6_addr, sizeof(words));
+        return (words[0] ^ words[1] ^ words[2] ^ words[3]) * 2654435761u ^ p_from6->sin6_port;
+    }
+    return (uint32_t)((struct sockaddr_in const *)p_from)->sin_addr.s_addr * 2654435761u ^ ((struct sockaddr_in const *)p_from)->sin_port;
+}
@@ -0,0 +1,177 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+
+/**
+ * @file mcast-packet.h
+ * @brief Audio datagram header interface.
+ * @details Every datagram sent by the sender starts with a small, fixed size header. The header identifies the source (SSRC) and carries a sequence number and a media timestamp, so that the receiver can tell the senders apart and put the packets back in order.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+#if !defined MCAST_PACKET_H_5E1B7C22_9A3D_4F60_8C1E_2B7D4A9F0E13
+#define MCAST_PACKET_H_5E1B7C22_9A3D_4F60_8C1E_2B7D4A9F0E13
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+#include "std-int.h"
+#include <stddef.h>
+
+/*!
+ * @brief Current version of the packet header.
+ */
+#define MCAST_PACKET_VERSION (1)
+
+/*!
+ * @brief Size of the encoded packet header, in bytes.
+ * @details This is the size of the fixed part only. Header extensions, if any, follow it immediately.
+ */
+#define MCAST_PACKET_HEADER_SIZE (16)
+
+/*!
+ * @brief Lower bits of the flags_ field tell how the payload is encoded.
+ * @details See the AUDIO_CODEC_* values in audio-codec.h. Zero means 16-bit PCM, so the senders that
+ * do not care about codecs need not set anything.
+ */
+#define MCAST_PACKET_FLAGS_CODEC_MASK (0x0f)
+
+/*!
+ * @brief Set if the first extension words carry the send time of the packet.
+ * @details The send time is a 64-bit count of nanoseconds since the Unix epoch, taken from the sender's wall clock.
+ * Hosts whose clocks are disciplined with PTP or NTP can therefore compute the network transit time of each packet.
+ */
+#define MCAST_PACKET_FLAGS_SEND_TIME (0x10)
+
+/*!
+ * @brief Number of extension words taken by the send time.
+ */
+#define MCAST_PACKET_SEND_TIME_WORDS (2)
+
+/*!
+ * @brief Set if an extension word carries the format of the payload.
+ * @details The word follows the send time, if there is one. Its upper 8 bits are the number of channels and its lower
+ * 24 bits are the sampling rate, in Hz. The receivers set their playout up from it.
+ */
+#define MCAST_PACKET_FLAGS_FORMAT (0x20)
+
+/*!
+ * @brief Number of extension words taken by the format.
+ */
+#define MCAST_PACKET_FORMAT_WORDS (1)
+
+/*!
+ * @brief Describes a single audio datagram header.
+ * @details All the multi-byte fields are transmitted in the network byte order. The header is followed
+ * by optional extension words and then by the payload, 16-bit PCM unless the flags say otherwise.
+ */
+struct mcast_packet_header {
+    uint8_t version_; /*!< Header version, see MCAST_PACKET_VERSION. */
+    uint8_t flags_; /*!< Packet flags. */
+    uint16_t seq_; /*!< Sequence number, incremented by one with each packet sent by the source. */
+    uint16_t ext_words_; /*!< Number of 32-bit extension words that follow the fixed header. */
+    uint16_t reserved_; /*!< Reserved, must be 0. */
+    uint32_t timestamp_; /*!< Media timestamp, in sample frames, of the first sample in the payload. */
+    uint32_t ssrc_; /*!< Randomly chosen identifier of the source. */
+};
+
+/*!
+ * @brief Writes the packet header into the buffer.
+ * @param[in] p_header header to be encoded.
+ * @param[out] p_buffer buffer to which header will be written.
+ * @param[in] buffer_size size of the buffer indicated by p_buffer.
+ * @return returns number of bytes written, 0 if the buffer is too small.
+ */
+size_t mcast_packet_header_encode(struct mcast_packet_header const * p_header, uint8_t * p_buffer, size_t buffer_size);
+
+/*!
+ * @brief Reads the packet header from the buffer.
+ * @param[out] p_header this will be written with the decoded header.
+ * @param[in] p_buffer buffer with the received datagram.
+ * @param[in] buffer_size number of bytes in the datagram.
+ * @return returns offset of the payload, i.e. size of the header and all its extensions.
+ * Returns 0 if the datagram does not carry a valid header.
+ */
+size_t mcast_packet_header_decode(struct mcast_packet_header * p_header, uint8_t const * p_buffer, size_t buffer_size);
+
+/*!
+ * @brief Writes the packet header, followed by the send time extension, into the buffer.
+ * @details The MCAST_PACKET_FLAGS_SEND_TIME flag is set and the extension words count is adjusted in the encoded header,
+ * the p_header itself is left intact.
+ * @param[in] p_header header to be encoded.
+ * @param[in] send_time the send time, in nanoseconds since the Unix epoch.
+ * @param[out] p_buffer buffer to which header will be written.
+ * @param[in] buffer_size size of the buffer indicated by p_buffer.
+ * @return returns offset of the payload, i.e. number of bytes written, 0 if the buffer is too small.
+ */
+size_t mcast_packet_header_encode_timed(struct mcast_packet_header const * p_header, uint64_t send_time, uint8_t * p_buffer, size_t buffer_size);
+
+/*!
+ * @brief Reads the send time from the datagram.
+ * @param[in] p_header header of the datagram, as decoded by mcast_packet_header_decode.
+ * @param[in] p_buffer buffer with the received datagram.
+ * @param[out] p_send_time this will be written with the send time, in nanoseconds since the Unix epoch.
+ * @return returns non-zero if the datagram carries the send time, 0 otherwise.
+ */
+int mcast_packet_header_get_send_time(struct mcast_packet_header const * p_header, uint8_t const * p_buffer, uint64_t * p_send_time);
+
+/*!
+ * @brief Writes the packet header, followed by the send time and the format extensions, into the buffer.
+ * @details Both the MCAST_PACKET_FLAGS_SEND_TIME and the MCAST_PACKET_FLAGS_FORMAT flags are set, and the extension
+ * words count is adjusted in the encoded header, the p_header itself is left intact.
+ * @param[in] p_header header to be encoded.
+ * @param[in] send_time the send time, in nanoseconds since the Unix epoch.
+ * @param[in] sample_rate sampling rate of the payload, in Hz, below 2^24.
+ * @param[in] channels number of interleaved channels of the payload, from 1 to 255.
+ * @param[out] p_buffer buffer to which header will be written.
+ * @param[in] buffer_size size of the buffer indicated by p_buffer.
+ * @return returns offset of the payload, i.e. number of bytes written, 0 if the buffer is too small.
+ */
+size_t mcast_packet_header_encode_stream(struct mcast_packet_header const * p_header, uint64_t send_time, uint32_t sample_rate, unsigned int channels, uint8_t * p_buffer, size_t buffer_size);
+
+/*!
+ * @brief Reads the format of the payload from the datagram.
+ * @param[in] p_header header of the datagram, as decoded by mcast_packet_header_decode.
+ * @param[in] p_buffer buffer with the received datagram.
+ * @param[out] p_sample_rate this will be written with the sampling rate, in Hz.
+ * @param[out] p_channels this will be written with the number of channels.
+ * @return returns non-zero if the datagram carries a valid format, 0 otherwise.
+ */
+int mcast_packet_header_get_format(struct mcast_packet_header const * p_header, uint8_t const * p_buffer, uint32_t * p_sample_rate, unsigned int * p_channels);
+
+/*!
+ * @brief Forward declaration.
+ */
+struct sockaddr_storage;
+
+/*!
+ * @brief Returns the key the datagrams without the packet header are mixed by, in place of the SSRC.
+ * @details Tells apart the senders that do not prepend the packet header by their address and port.
+ * @param[in] p_from address of the sender, AF_INET or AF_INET6.
+ * @return returns the key of the sender.
+ */
+uint32_t mcast_packet_source_key(struct sockaddr_storage const * p_from);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* MCAST_PACKET_H_5E1B7C22_9A3D_4F60_8C1E_2B7D4A9F0E13 */
@@ -5,24 +5,72 @@
 #include "mcast-settings.h"
 #include "mcast_utils.h"
 #include "wave_utils.h"
+#include "mcast-packet.h"
+#include "audio-mixer.h"
+#include "audio-codec.h"
+#include "audio-sink.h"
+#include "playout-scheduler.h"
+#include "perf-counter-itf.h"
+#include "latency-probe.h"
+#include "stream-stats.h"
+#include "stats-server.h"
+#include "trace-recorder.h"
+#include "packet-capture.h"
+#include "thread-sched.h"
+#include "pipeline.h"
+#include "debug_helpers.h"
 
-#define INTEFACE_BIND_ADDRESS "0.0.0.0"
 #define MCAST_GROUP_ADDRESS "239.0.0.1"
 #define MCAST_PORT_NUMBER "25000"
 #define CHUNK_SIZE (1024)
 #define DEFAULT_TTL (5)
 #define DEFAULT_SLEEP_TIME ((1000000*1024)/8000)
+#define MAX_PACKET_SIZE (2048)
+#define MAX_SOURCES (32)
+#define JITTER_LEVEL (4)
+#define JITTER_PREFILL (2)
+#define MIX_BLOCK (256)
+#define LEGACY_SAMPLE_RATE (8000)
+#define PLAYOUT_PERIODS (4)
+#define NULL_SINK_NAME "null"
+#define STATS_SOCKET_PATH "/tmp/mcast-receiver.sock"
+#define DECODE_RING_SLOTS (64)
+#define MIX_RING_SLOTS (64)
 
-static uint8_t g_input_buffer[CHUNK_SIZE];
+/*!
+ * @brief A datagram, as received.
+ */
+struct received_datagram {
+    uint64_t arrival_time_; /*!< When the datagram was received, in nanoseconds of the latency probe's clock. */
+    struct sockaddr_storage from_; /*!< The sender. */
+    uint8_t data_[MAX_PACKET_SIZE]; /*!< The datagram. */
+};
+
+/*!
+ * @brief The samples of a datagram, as decoded.
+ */
+struct decoded_datagram {
+    uint64_t arrival_time_; /*!< When the datagram was received. */
+    uint32_t ssrc_; /*!< The source, either from the header or made up from the sender's address. */
+    uint16_t seq_; /*!< Sequence number of the packet, if the datagram had the header. */
+    int sequenced_; /*!< Non-zero if the datagram had the header. */
+    uint32_t sample_rate_; /*!< Sampling rate of the samples, 0 if the datagram did not tell. */
+    unsigned int channels_; /*!< Number of interleaved channels of the samples, 0 if the datagram did not tell. */
+    int16_t samples_[MAX_PACKET_SIZE/sizeof(int16_t)]; /*!< The samples. */
+};
+
+static struct received_datagram g_received;
+static int16_t g_mixed[MIX_BLOCK];
 
 static void dump_addrinfo(FILE * fp, struct addrinfo const * p_addr)
 {
     struct addrinfo const * p_idx = p_addr;
     for (; NULL != p_idx; p_idx = p_idx->ai_next)
     {
-        struct sockaddr_in const * p_sock_addr_in = (struct sockaddr_in const *)p_idx->ai_addr;
-        uint8_t const * in_addr = (uint8_t const *)&p_sock_addr_in->sin_addr;
-        printf("%hhu.%hhu.%hhu.%hhu\n", in_addr[0], in_addr[1], in_addr[2], in_addr[3]);
+        char host[NI_MAXHOST] = { 0 };
+        char port[NI_MAXSERV] = { 0 };
+        getnameinfo(p_idx->ai_addr, p_idx->ai_addrlen, host, sizeof(host), port, sizeof(port), NI_NUMERICHOST | NI_NUMERICSERV);
+        fprintf(fp, "%4.4u %s : %s %s\n", __LINE__, __FILE__, host, port);
     }
 }
 
@@ -45,11 +93,170 @@ static int set_reuse_addr(SOCKET s)
 
 volatile sig_atomic_t g_stop_processing;
 
+/*!
+ * @brief What the decode thread needs.
+ */
+struct decode {
+    struct latency_probe * p_probe_; /*!< Records the network transit time. */
+    struct stream_stats_writer * p_stats_; /*!< Where the packets received are counted. */
+};
+
+/*!
+ * @brief Decodes the header of the received datagram, and the payload into PCM.
+ * @details If the datagram carries its send time, the network transit time is recorded by the probe.
+ */
+static size_t decode_datagram(void * p_context, void const * p_input, size_t input_size, void * p_output)
+{
+    struct decode * p_decode = (struct decode *)p_context;
+    struct received_datagram const * p_received = (struct received_datagram const *)p_input;
+    struct decoded_datagram * p_decoded = (struct decoded_datagram *)p_output;
+    size_t data_size = input_size - offsetof(struct received_datagram, data_);
+    struct mcast_packet_header header;
+    size_t payload_offset = mcast_packet_header_decode(&header, p_received->data_, data_size);
+    size_t samples_count;
+    p_decoded->arrival_time_ = p_received->arrival_time_;
+    if (0 != payload_offset)
+    {
+        uint64_t send_time;
+        stream_stats_on_packet(p_decode->p_stats_, header.ssrc_, header.seq_, data_size);
+        if (mcast_packet_header_get_send_time(&header, p_received->data_, &send_time))
+            latency_probe_record_transit(p_decode->p_probe_, send_time, p_received->arrival_time_);
+        /* Streams from the transcoder carry compressed payloads, so those are expanded to PCM first. */
+        TRACE_BEGIN("decode");
+        samples_count = audio_codec_decode(header.flags_ & MCAST_PACKET_FLAGS_CODEC_MASK, &p_received->data_[payload_offset], data_size - payload_offset,
+                p_decoded->samples_, COUNTOF_ARRAY(p_decoded->samples_));
+        TRACE_END("decode");
+        p_decoded->ssrc_ = header.ssrc_;
+        p_decoded->seq_ = header.seq_;
+        p_decoded->sequenced_ = 1;
+        if (!mcast_packet_header_get_format(&header, p_received->data_, &p_decoded->sample_rate_, &p_decoded->channels_))
+            p_decoded->sample_rate_ = p_decoded->channels_ = 0;
+    }
+    else
+    {
+        p_decoded->ssrc_ = mcast_packet_source_key(&p_received->from_);
+        stream_stats_on_unsequenced(p_decode->p_stats_, p_decoded->ssrc_, data_size);
+        samples_count = data_size/sizeof(int16_t);
+        memcpy(p_decoded->samples_, p_received->data_, samples_count * sizeof(int16_t));
+        p_decoded->sequenced_ = 0;
+        p_decoded->sample_rate_ = p_decoded->channels_ = 0;
+    }
+    return 0 != samples_count ? offsetof(struct decoded_datagram, samples_) + samples_count * sizeof(int16_t) : 0;
+}
+
+/*!
+ * @brief What the mixer is fed with.
+ */
+struct mix {
+    struct audio_mixer * p_mixer_; /*!< The jitter buffers of the sources. */
+    struct perf_counter * p_push_counter_; /*!< Measures the pushing. */
+    uint32_t sample_rate_; /*!< Sampling rate of the stream, 0 until the first datagram. */
+    unsigned int channels_; /*!< Number of channels of the stream, 0 until the first datagram. */
+    uint64_t mismatched_; /*!< Number of datagrams dropped because their format was not the stream's. */
+};
+
+/*!
+ * @brief Puts the decoded samples into the mixer.
+ */
+static size_t push_decoded(void * p_context, void const * p_input, size_t input_size, void * p_output)
+{
+    struct mix * p_mix = (struct mix *)p_context;
+    struct decoded_datagram const * p_decoded = (struct decoded_datagram const *)p_input;
+    size_t samples_count = (input_size - offsetof(struct decoded_datagram, samples_))/sizeof(int16_t);
+    uint32_t sample_rate = p_decoded->sample_rate_;
+    unsigned int channels = p_decoded->channels_;
+    if (0 == sample_rate)
+    {
+        /* The senders that do not tell the format send mono at 8 kHz. */
+        sample_rate = LEGACY_SAMPLE_RATE;
+        channels = 1;
+    }
+    /* The first datagram sets the format up, the mixer cannot mix different ones. */
+    if (0 == p_mix->sample_rate_)
+    {
+        p_mix->sample_rate_ = sample_rate;
+        p_mix->channels_ = channels;
+    }
+    else if (sample_rate != p_mix->sample_rate_ || channels != p_mix->channels_)
+    {
+        ++p_mix->mismatched_;
+        return 0;
+    }
+    perf_counter_mark_before(p_mix->p_push_counter_);
+    TRACE_BEGIN("fifo push");
+    if (p_decoded->sequenced_)
+        audio_mixer_push_at(p_mix->p_mixer_, p_decoded->ssrc_, p_decoded->seq_, p_decoded->samples_, samples_count, p_decoded->arrival_time_);
+    else
+        audio_mixer_push_unsequenced(p_mix->p_mixer_, p_decoded->ssrc_, p_decoded->samples_, samples_count);
+    TRACE_END("fifo push");
+    perf_counter_mark_after(p_mix->p_push_counter_);
+    return 0;
+}
+
+/*!
+ * @brief Reports the state of the sources' jitter buffers.
+ */
+static void update_fifo_stats(struct audio_mixer const * p_mixer, struct stream_stats_writer * p_stats)
+{
+    struct audio_mixer_source_stats sources[MAX_SOURCES];
+    unsigned int count = audio_mixer_get_stats(p_mixer, sources, COUNTOF_ARRAY(sources));
+    unsigned int idx;
+    for (idx = 0; idx < count; ++idx)
+        stream_stats_set_fifo(p_stats, sources[idx].ssrc_, sources[idx].buffered_, sources[idx].underruns_);
+}
+
+/*!
+ * @brief What the playout pulls the periods from.
+ */
+struct playout {
+    struct audio_mixer * p_mixer_; /*!< The jitter buffers of the sources. */
+    struct stream_stats_writer * p_stats_; /*!< Where the state of the jitter buffers is reported to. */
+    struct perf_counter * p_mix_counter_; /*!< Measures the mixing. */
+    unsigned int channels_; /*!< Number of interleaved channels of the stream. */
+};
+
+/*!
+ * @brief Mixes the next period, when the playout clock asks for it.
+ */
+static size_t pull_period(void * p_context, int16_t * p_samples, size_t frames)
+{
+    struct playout * p_playout = (struct playout *)p_context;
+    /* The mixer counts the samples of all the channels. */
+    if (audio_mixer_get_available(p_playout->p_mixer_) < frames * p_playout->channels_)
+        return 0;
+    perf_counter_mark_before(p_playout->p_mix_counter_);
+    TRACE_BEGIN("fifo fetch");
+    audio_mixer_mix_at(p_playout->p_mixer_, p_samples, frames * p_playout->channels_, latency_probe_get_time());
+    TRACE_END("fifo fetch");
+    perf_counter_mark_after(p_playout->p_mix_counter_);
+    update_fifo_stats(p_playout->p_mixer_, p_playout->p_stats_);
+    return frames;
+}
+
+/*!
+ * @brief Reports how the playout went.
+ */
+static void dump_playout(struct playout_scheduler const * p_scheduler, struct audio_sink const * p_sink)
+{
+    struct playout_scheduler_stats stats;
+    playout_scheduler_get_stats(p_scheduler, &stats);
+    fprintf(stderr, "%4.4u %s : periods %llu underruns %llu late %llu max latency %llu device underruns %llu\n", __LINE__, __func__,
+        (unsigned long long)stats.periods_, (unsigned long long)stats.underruns_, (unsigned long long)stats.late_,
+        (unsigned long long)stats.max_latency_, (unsigned long long)audio_sink_get_underruns(p_sink));
+}
+
 static void sigint_handle(int signal)
 {
     g_stop_processing = 1;
 }
 
+volatile sig_atomic_t g_dump_trace;
+
+static void sigusr1_handle(int signal)
+{
+    g_dump_trace = 1;
+}
+
 int main(int argc, char ** argv)
 {
     int result;
@@ -57,73 +264,264 @@ int main(int argc, char ** argv)
     struct addrinfo * p_group_address;
     struct addrinfo * p_iface_address;
     struct addrinfo a_hints;
+    struct audio_mixer * p_mixer;
+    FILE * fp_output = NULL;
+    struct audio_sink * p_sink = NULL;
+    struct playout_scheduler * p_scheduler = NULL;
+    char const * psz_sink = NULL;
+    struct playout playout;
+    struct decode decode;
+    struct mix mix;
+    struct pipeline * p_pipeline;
+    struct pipeline_stage_config stages[2] = {
+        { "decode", &decode_datagram, &decode, sizeof(struct received_datagram), PIPELINE_THREAD, DECODE_RING_SLOTS, PIPELINE_DROP, THREAD_ROLE_RECEIVE },
+        { "mix", &push_decoded, &mix, sizeof(struct decoded_datagram), PIPELINE_EXTERNAL, MIX_RING_SLOTS, PIPELINE_DROP, -1 },
+    };
+    ssize_t bytes_read = 0;
+    struct sockaddr_storage recv_from_data;
+    socklen_t recv_from_length = sizeof(recv_from_data);
+    struct perf_counter * p_push_counter = perf_counter_create();
+    struct perf_counter * p_mix_counter = perf_counter_create();
+    struct latency_probe * p_probe = latency_probe_create();
+    struct stream_stats * p_stream_stats = stream_stats_create();
+    struct stream_stats_writer * p_stats_writer;
+    struct stats_server * p_stats_server;
+    char const * psz_group = MCAST_GROUP_ADDRESS;
+    char const * psz_port = MCAST_PORT_NUMBER;
+    char const * psz_trace = trace_recorder_enable_from_env();
+    /* 'MCAST_CAPTURE=path' appends every datagram received to the capture file, see mcast-replay. */
+    struct packet_capture_writer * p_capture = packet_capture_writer_open_from_env();
+    SOCKET s;
     memset(&a_hints, 0, sizeof(a_hints));
-    SOCKET s = socket(AF_INET, SOCK_DGRAM, 0);
-    assert(s>=0); 
-    a_hints.ai_family = AF_INET;
+    memset(&recv_from_data, 0, sizeof(recv_from_data));
+    /* Arguments: [output file|null|-] [source|-] [group] [port]. An output file ending with .wav is played out to,
+     * as is 'null'. The group may be IPv4, or IPv6 with an optional %scope. */
+    if (argc > 3)
+        psz_group = argv[3];
+    if (argc > 4)
+        psz_port = argv[4];
+    a_hints.ai_family = AF_UNSPEC;
     a_hints.ai_protocol = 0;
     a_hints.ai_socktype = SOCK_DGRAM;
-    result = getaddrinfo(MCAST_GROUP_ADDRESS, MCAST_PORT_NUMBER, &a_hints, &p_group_address);
+    result = getaddrinfo(psz_group, psz_port, &a_hints, &p_group_address);
     assert(0 == result);
     dump_addrinfo(stderr, p_group_address);
+    s = socket(p_group_address->ai_family, SOCK_DGRAM, 0);
+    assert(s>=0); 
+    /* Wildcard address of the group's family, i.e. either 0.0.0.0 or ::. */
+    a_hints.ai_family = p_group_address->ai_family;
     a_hints.ai_flags = AI_PASSIVE;
-    result = getaddrinfo(INTEFACE_BIND_ADDRESS, MCAST_PORT_NUMBER, &a_hints, &p_iface_address);
+    result = getaddrinfo(NULL, psz_port, &a_hints, &p_iface_address);
     assert(0 == result);
     result = set_reuse_addr(s);
     assert(0 == result);
     dump_addrinfo(stderr, p_iface_address);
-    result = join_mcast_group_set_ttl(s, p_group_address, p_iface_address, DEFAULT_TTL);
+    if (argc > 2 && 0 != strcmp(argv[2], "-"))
+    {
+        /* Source specific join: only the datagrams of the given sender are received. */
+        struct addrinfo * p_source_address;
+        a_hints.ai_flags = AI_NUMERICHOST;
+        result = getaddrinfo(argv[2], NULL, &a_hints, &p_source_address);
+        assert(0 == result);
+        result = join_mcast_source_group_set_ttl(s, p_group_address, p_iface_address, p_source_address->ai_addr, DEFAULT_TTL);
+        freeaddrinfo(p_source_address);
+    }
+    else
+    {
+        result = join_mcast_group_set_ttl(s, p_group_address, p_iface_address, DEFAULT_TTL);
+    }
     assert(0 == result);
+    if (NULL != p_capture && !packet_capture_enable_timestamps(s))
+        fprintf(stderr, "%4.4u %s : no kernel timestamps %d %s\n", __LINE__, __FILE__, errno, strerror(errno));
     {
         struct sigaction query_action;
         memset(&query_action, 0, sizeof(query_action));
         query_action.sa_handler = &sigint_handle;
-        if (sigaction (SIGINT, NULL, &query_action) < 0)
+        if (sigaction (SIGINT, &query_action, NULL) < 0)
             exit(EXIT_FAILURE);
             /* sigaction returns -1 in case of error. */
+        query_action.sa_handler = &sigusr1_handle;
+        if (sigaction (SIGUSR1, &query_action, NULL) < 0)
+            exit(EXIT_FAILURE);
+    }
+    /* Logging from the data path must not stall it, so the messages are written by a background thread. */
+    debug_output_async_start();
+    p_mixer = audio_mixer_create(MAX_SOURCES, JITTER_LEVEL, MAX_PACKET_SIZE/sizeof(int16_t), JITTER_PREFILL);
+    assert(NULL != p_mixer);
+    assert(NULL != p_probe);
+    audio_mixer_set_residency_histogram(p_mixer, latency_probe_get_residency(p_probe));
+    assert(NULL != p_stream_stats);
+    p_stats_writer = stream_stats_add_writer(p_stream_stats);
+    /* The counters are still kept if the socket cannot be set up, they are just not served. */
+    p_stats_server = stats_server_create(p_stream_stats, STATS_SOCKET_PATH);
+    if (argc > 1 && (0 == strcmp(argv[1], NULL_SINK_NAME) || (strlen(argv[1]) > 4 && 0 == strcmp(argv[1] + strlen(argv[1]) - 4, ".wav"))))
+    {
+        /* 'null', or a WAV file: the mixed samples are pulled at the pace of the emulated sound card, as they would be
+         * by DirectSound. The card is opened once the first datagram tells the format of the stream. */
+        psz_sink = argv[1];
+    }
+    else if (argc > 1 && 0 != strcmp(argv[1], "-"))
+    {
+        /* Mixed samples are written as raw 16-bit PCM. Use '-' to skip the file and give the source address only. */
+        fp_output = fopen(argv[1], "wb");
+        assert(NULL != fp_output);
+    }
+    /* The main thread receives the datagrams and the decode thread decodes them, so a slow codec never holds the
+     * socket up. The decoded samples come back to the main thread, which owns the mixer. */
+    decode.p_probe_ = p_probe;
+    decode.p_stats_ = stream_stats_add_writer(p_stream_stats);
+    mix.p_mixer_ = p_mixer;
+    mix.p_push_counter_ = p_push_counter;
+    mix.sample_rate_ = 0;
+    mix.channels_ = 0;
+    mix.mismatched_ = 0;
+    p_pipeline = pipeline_create(stages, COUNTOF_ARRAY(stages));
+    assert(NULL != p_pipeline);
+    /* Once the helper threads run, so that they do not inherit the real time policy. The same thread receives and,
+     * if there is a sink, plays out, in which case it is scheduled as the playout one, whose deadlines are harder. */
+    {
+        struct thread_sched_result sched;
+        int role = NULL != psz_sink ? THREAD_ROLE_PLAYOUT : THREAD_ROLE_RECEIVE;
+        thread_sched_lock_memory_from_env();
+        thread_sched_apply_from_env(role, &sched);
+        thread_sched_dump(stderr, role, &sched);
     }
     while (!g_stop_processing)
     {
-        ssize_t bytes_read;
-        struct sockaddr recv_from_data;
-        socklen_t recv_from_length = sizeof(recv_from_data);
         struct timeval select_timeout = { 1, 0 };
+        int max_fd = max(s, pipeline_get_fd(p_pipeline));
+        if (g_dump_trace)
+        {
+            /* 'kill -USR1' dumps the trace recorded so far, 'MCAST_TRACE=path' must be set for anything to be recorded. */
+            g_dump_trace = 0;
+            if (NULL != psz_trace)
+                trace_recorder_dump(psz_trace);
+        }
         FD_ZERO(&read_fd);
         FD_SET(s, &read_fd);
-        result = select(s+1, &read_fd, NULL, NULL, &select_timeout); 
+        FD_SET(pipeline_get_fd(p_pipeline), &read_fd);
+        if (NULL != p_scheduler)
+        {
+            FD_SET(playout_scheduler_get_fd(p_scheduler), &read_fd);
+            max_fd = max(max_fd, playout_scheduler_get_fd(p_scheduler));
+        }
+        result = select(max_fd + 1, &read_fd, NULL, NULL, &select_timeout); 
         switch (result)
         {
             case -1:
                 break;
             case 0: 
                 fprintf(stdout, "%4.4u %s : Timeout\n", __LINE__, __func__);
+                if (NULL != p_capture)
+                    packet_capture_writer_flush(p_capture);
                 break;
             default:
+                /* The decoded samples go into the mixer first, so that the period played out has the latest ones. */
+                if (FD_ISSET(pipeline_get_fd(p_pipeline), &read_fd))
+                    pipeline_service(p_pipeline);
+                if (NULL != psz_sink && NULL == p_scheduler && 0 != mix.sample_rate_)
+                {
+                    /* A period has the same number of samples whatever the format, which the jitter buffers hold. */
+                    struct audio_sink_config config;
+                    config.sample_rate_ = mix.sample_rate_;
+                    config.channels_ = mix.channels_;
+                    config.period_frames_ = max(MIX_BLOCK / mix.channels_, 1u);
+                    config.periods_count_ = PLAYOUT_PERIODS;
+                    fprintf(stderr, "%4.4u %s : playout %u Hz %u channels\n", __LINE__, __func__, config.sample_rate_, config.channels_);
+                    p_sink = audio_sink_open(0 == strcmp(psz_sink, NULL_SINK_NAME) ? AUDIO_SINK_NULL : AUDIO_SINK_WAV, psz_sink, &config);
+                    assert(NULL != p_sink);
+                    playout.p_mixer_ = p_mixer;
+                    playout.p_stats_ = p_stats_writer;
+                    playout.p_mix_counter_ = p_mix_counter;
+                    playout.channels_ = mix.channels_;
+                    p_scheduler = playout_scheduler_create(p_sink, &pull_period, &playout);
+                    assert(NULL != p_scheduler);
+                }
+                if (NULL != p_scheduler && FD_ISSET(playout_scheduler_get_fd(p_scheduler), &read_fd))
+                    playout_scheduler_service(p_scheduler);
                 if (FD_ISSET(s, &read_fd))
                 {
-                    bytes_read = recvfrom(s, 
-                        &g_input_buffer[0], 
-                        sizeof(g_input_buffer), 
-                        0, 
-                        &recv_from_data, 
-                        &recv_from_length);  
+                    uint64_t arrival_time = 0;
+                    recv_from_length = sizeof(recv_from_data);
+                    TRACE_BEGIN("receive");
+                    if (NULL != p_capture)
+                        bytes_read = packet_capture_recvfrom(s, &g_received.data_[0], sizeof(g_received.data_), &recv_from_data, &recv_from_length, &arrival_time);
+                    else
+                        bytes_read = recvfrom(s, 
+                            &g_received.data_[0], 
+                            sizeof(g_received.data_), 
+                            0, 
+                            (struct sockaddr *)&recv_from_data, 
+                            &recv_from_length);  
+                    TRACE_END("receive");
                     if (bytes_read >= 0)
                     {
-                        fprintf(stdout, "%4.4u %s : %u %s %u %2.2hhx %2.2hhx..\n", __LINE__, __func__, bytes_read, 
-                                inet_ntoa((((struct sockaddr_in *)&recv_from_data)->sin_addr)),
-                                ntohs((((struct sockaddr_in *)&recv_from_data)->sin_port)),
-                                g_input_buffer[0], 
-                                g_input_buffer[1]
-                               );
+                        if (NULL != p_capture)
+                            packet_capture_writer_append(p_capture, arrival_time, &recv_from_data, &g_received.data_[0], (size_t)bytes_read);
+                        else
+                            arrival_time = latency_probe_get_time();
+                        g_received.arrival_time_ = arrival_time;
+                        memcpy(&g_received.from_, &recv_from_data, sizeof(recv_from_data));
+                        pipeline_push(p_pipeline, &g_received, offsetof(struct received_datagram, data_) + (size_t)bytes_read);
                     }
                     else
                     {
                         fprintf(stderr, "%4.4u %s : %d %s\n", __LINE__, __func__, errno, strerror(errno));
                     }
                 }
+                while (NULL == psz_sink && audio_mixer_get_available(p_mixer) >= MIX_BLOCK)
+                {
+                    unsigned int sources;
+                    perf_counter_mark_before(p_mix_counter);
+                    TRACE_BEGIN("fifo fetch");
+                    sources = audio_mixer_mix_at(p_mixer, g_mixed, MIX_BLOCK, latency_probe_get_time());
+                    TRACE_END("fifo fetch");
+                    perf_counter_mark_after(p_mix_counter);
+                    update_fifo_stats(p_mixer, p_stats_writer);
+                    if (NULL != fp_output)
+                        fwrite(g_mixed, sizeof(g_mixed[0]), MIX_BLOCK, fp_output);
+                    else
+                    {
+                        /* The last datagram received, not necessarily the one that has been mixed. */
+                        char host[NI_MAXHOST] = { 0 };
+                        char port[NI_MAXSERV] = { 0 };
+                        getnameinfo((struct sockaddr const *)&recv_from_data, recv_from_length, host, sizeof(host), port, sizeof(port), NI_NUMERICHOST | NI_NUMERICSERV);
+                        fprintf(stdout, "%4.4u %s : %u %zd %s %s\n", __LINE__, __func__, sources, bytes_read, host, port);
+                    }
+                }
                 break;
         }
     }
+    /* The datagrams already received are still decoded, and put into the mixer for the statistics. */
+    pipeline_stop(p_pipeline);
+    pipeline_service(p_pipeline);
+    pipeline_dump(stderr, p_pipeline);
+    pipeline_destroy(p_pipeline);
+    perf_counter_dump(p_push_counter, "push");
+    perf_counter_dump(p_mix_counter, "mix");
+    if (0 != mix.mismatched_)
+        fprintf(stderr, "%4.4u %s : %llu datagrams not in the stream's %u Hz %u channels\n", __LINE__, __func__,
+            (unsigned long long)mix.mismatched_, mix.sample_rate_, mix.channels_);
+    if (NULL != p_scheduler)
+        dump_playout(p_scheduler, p_sink);
+    latency_probe_dump(p_probe);
+    if (NULL != psz_trace)
+        trace_recorder_dump(psz_trace);
+    packet_capture_writer_close(p_capture);
+    perf_counter_destroy(p_mix_counter);
+    perf_counter_destroy(p_push_counter);
+    if (NULL != fp_output)
+        fclose(fp_output);
+    playout_scheduler_destroy(p_scheduler);
+    audio_sink_close(p_sink);
+    audio_mixer_destroy(p_mixer);
+    latency_probe_destroy(p_probe);
+    stats_server_destroy(p_stats_server);
+    stream_stats_destroy(p_stream_stats);
+    close(s);
+    freeaddrinfo(p_iface_address);
+    freeaddrinfo(p_group_address);
+    debug_output_async_stop();
     return 0;
 }
 
@@ -38,6 +38,11 @@
 #include "dsoundplay.h"
 #include "circular-buffer-uint8.h"
 #include "wave_utils.h"
+#include "mcast-packet.h"
+#include "audio-mixer.h"
+#include "audio-codec.h"
+#include "perf-counter-itf.h"
+#include "trace-recorder.h"
 
 /*!
  * @brief The multicast receiver object.
@@ -47,7 +52,8 @@ struct mcast_receiver {
     receiver_state_t state_; /*!< Receiver's current state. */
     DSOUNDPLAY player_; /*!< Pointer to the data player buffer */
     struct mcast_connection * conn_; /*!< Pointer to the multicast connection object */
-    struct fifo_circular_buffer * fifo_; /*!< Pointer to the jitter buffer */
+    struct fifo_circular_buffer * fifo_; /*!< Pointer to the buffer from which the player takes the mixed samples. */
+    struct audio_mixer * mixer_; /*!< Mixes all the senders that talk to the multicast group. */
     HANDLE hStopEvent_;/*!< The receiver's stop event. When this event is signalled via SetEvent() call, the receiver thread exits. */
     HANDLE hStopEventThread_;/*!< The receiver's stop event. When this event is signalled via SetEvent() call, the receiver thread exits. */
     HANDLE hRcvThread_; /*!< Handle to the receiver's thread */
@@ -59,6 +65,47 @@ struct mcast_receiver {
  */
 #define DEFAULT_UDP_PACKET_CHUNK (2048)
 
+/*!
+ * @brief Maximum number of senders that can be heard simultaneously.
+ */
+#define RECEIVER_MAX_SOURCES (32)
+
+/*!
+ * @brief Each sender's jitter buffer holds up to 2^RECEIVER_JITTER_LEVEL packets.
+ */
+#define RECEIVER_JITTER_LEVEL (4)
+
+/*!
+ * @brief Number of packets each sender's jitter buffer collects before its playout starts.
+ */
+#define RECEIVER_JITTER_PREFILL (2)
+
+/*!
+ * @brief Number of samples that are mixed and handed to the player at once.
+ */
+#define RECEIVER_MIX_BLOCK (256)
+
+/*!
+ * @brief Puts a received datagram into the mixer.
+ * @details Datagrams that carry the packet header are ordered by the sequence number, 
+ * the ones that do not are played in the arrival order, each sender as a source of its own.
+ */
+static void receiver_push_datagram(struct mcast_receiver * p_receiver, uint8_t const * p_data, size_t data_size, struct sockaddr_storage const * p_from)
+{
+    struct mcast_packet_header header;
+    size_t payload_offset = mcast_packet_header_decode(&header, p_data, data_size);
+    if (0 != payload_offset)
+    {
+        int16_t decoded[DEFAULT_UDP_PACKET_CHUNK/sizeof(int16_t)];
+        size_t samples_count = audio_codec_decode(header.flags_ & MCAST_PACKET_FLAGS_CODEC_MASK, &p_data[payload_offset], data_size - payload_offset,
+                decoded, COUNTOF_ARRAY(decoded));
+        if (0 != samples_count)
+            audio_mixer_push(p_receiver->mixer_, header.ssrc_, header.seq_, decoded, samples_count);
+    }
+    else
+        audio_mixer_push_unsequenced(p_receiver->mixer_, mcast_packet_source_key(p_from), (int16_t const *)p_data, data_size/sizeof(int16_t));
+}
+
 /**
  * @brief Entry point of the Multicast receiver thread 
  * @details The PCM data is being received from the multicast group via this thread. The thread
@@ -71,15 +118,20 @@ static DWORD WINAPI ReceiverThreadProc(LPVOID param)
     uint32_t stop = 0;
     struct mcast_receiver * p_receiver;
     uint8_t * p_data;
+    int16_t mixed[RECEIVER_MIX_BLOCK];
     size_t req_count;
     DWORD dwWaitTimeout;
     int bytes_recevied;
     DWORD dwWaitResult;
     socklen_t sock_addr_size;
+    struct sockaddr_storage from;
+    struct perf_counter * p_fifo_counter = perf_counter_create();
     p_receiver = (struct mcast_receiver*)param;
     assert(p_receiver);
+    assert(p_fifo_counter);
     assert(p_receiver->conn_);
     assert(p_receiver->fifo_);
+    assert(p_receiver->mixer_);
     sock_addr_size  = sizeof(struct sockaddr_in);
     p_data = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, DEFAULT_UDP_PACKET_CHUNK);
     req_count = DEFAULT_UDP_PACKET_CHUNK;
@@ -88,21 +140,34 @@ static DWORD WINAPI ReceiverThreadProc(LPVOID param)
     {
         for (;mcast_is_new_data(p_receiver->conn_, dwWaitTimeout);)
         {
+            TRACE_BEGIN("receive");
             do { 
                 /* Receive data from the socket until you receiving this WSAMSGSIZE error
                  * It is a non-blocking socket, so this call may well yield WSAEWOULDBLOCK - indicating that there
                  * is nothing to receive. We ignore those errors.
                  */
-                bytes_recevied = mcast_recvfrom(p_receiver->conn_, p_data, req_count);
+                bytes_recevied = mcast_recvfrom_source(p_receiver->conn_, p_data, req_count, &from);
                 if (SOCKET_ERROR != bytes_recevied)
                 {
                     req_count = bytes_recevied;
-                    fifo_circular_buffer_push_item(p_receiver->fifo_, &p_data[0], req_count);
+                    receiver_push_datagram(p_receiver, &p_data[0], req_count, &from);
                     break;
                 }
                 p_data = HeapReAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, p_data, req_count + DEFAULT_UDP_PACKET_CHUNK);
                 req_count += DEFAULT_UDP_PACKET_CHUNK;
             } while (WSAGetLastError() == WSAEMSGSIZE);
+            TRACE_END("receive");
+        }
+        while (audio_mixer_get_available(p_receiver->mixer_) >= RECEIVER_MIX_BLOCK)
+        {
+            TRACE_BEGIN("mix");
+            audio_mixer_mix(p_receiver->mixer_, mixed, RECEIVER_MIX_BLOCK);
+            TRACE_END("mix");
+            perf_counter_mark_before(p_fifo_counter);
+            TRACE_BEGIN("fifo push");
+            fifo_circular_buffer_push_item(p_receiver->fifo_, (uint8_t const *)&mixed[0], sizeof(mixed));
+            TRACE_END("fifo push");
+            perf_counter_mark_after(p_fifo_counter);
         }
         dwWaitResult = WaitForSingleObject(p_receiver->hStopEventThread_, 0);
         switch (dwWaitResult)
@@ -113,13 +178,15 @@ static DWORD WINAPI ReceiverThreadProc(LPVOID param)
             case WAIT_FAILED:
                 stop = 1; /* Yes, break omission is intentional. */
             default:
-                debug_outputln("%s %4.4u : %8.8x", __FILE__, __LINE__, dwWaitResult);
+                debug_log_warning(DEBUG_CATEGORY_RECEIVER, "%s %4.4u : %8.8x", __FILE__, __LINE__, dwWaitResult);
                 break;
         }
     }
     CloseHandle(p_receiver->hStopEventThread_);
     p_receiver->hStopEventThread_ = NULL;
     HeapFree(GetProcessHeap(), 0, p_data);
+    perf_counter_dump(p_fifo_counter, "fifo push");
+    perf_counter_destroy(p_fifo_counter);
     return 0;
 }
 
@@ -290,6 +357,8 @@ struct mcast_receiver * receiver_create(struct receiver_settings const * p_setti
     assert(p_settings);
     receiver_settings_copy(&p_receiver->settings_, p_settings);
     p_receiver->fifo_ = circular_buffer_create_with_size((uint8_t)p_settings->circular_buffer_level_);
+    p_receiver->mixer_ = audio_mixer_create(RECEIVER_MAX_SOURCES, RECEIVER_JITTER_LEVEL, DEFAULT_UDP_PACKET_CHUNK/sizeof(int16_t), RECEIVER_JITTER_PREFILL);
+    assert(p_receiver->mixer_);
     return p_receiver;
 }
 
@@ -298,6 +367,7 @@ int receiver_destroy(struct mcast_receiver * p_receiver)
     assert(RECEIVER_INITIAL == p_receiver->state_);
     if (RECEIVER_INITIAL == p_receiver->state_);
     {
+        audio_mixer_destroy(p_receiver->mixer_);
         HeapFree(GetProcessHeap(), 0, p_receiver);
         return 1;
     }
@@ -328,7 +398,7 @@ void handle_play(struct mcast_receiver * p_receiver, HWND hMainWnd)
                 return;
             }
     }
-    debug_outputln("%s %4.4u", __FILE__, __LINE__);
+    debug_log_trace(DEBUG_CATEGORY_RECEIVER, "%s %4.4u", __FILE__, __LINE__);
 }
 
 void handle_stop(struct mcast_receiver * p_receiver)
@@ -358,7 +428,7 @@ void handle_stop(struct mcast_receiver * p_receiver)
         default:
             break;
     }
-    debug_outputln("%s %4.4u", __FILE__, __LINE__);
+    debug_log_trace(DEBUG_CATEGORY_RECEIVER, "%s %4.4u", __FILE__, __LINE__);
 }
 
 void handle_rcvstart(struct mcast_receiver * p_receiver)
@@ -383,7 +453,7 @@ void handle_rcvstart(struct mcast_receiver * p_receiver)
         default:
             break;
     }
-    debug_outputln("%s %4.4u", __FILE__, __LINE__);
+    debug_log_trace(DEBUG_CATEGORY_RECEIVER, "%s %4.4u", __FILE__, __LINE__);
 }
 
 void handle_rcvstop(struct mcast_receiver * p_receiver)
@@ -408,7 +478,7 @@ void handle_rcvstop(struct mcast_receiver * p_receiver)
         default:
             break;
     }
-    debug_outputln("%s %4.4u", __FILE__, __LINE__);
+    debug_log_trace(DEBUG_CATEGORY_RECEIVER, "%s %4.4u", __FILE__, __LINE__);
 }
 
 void handle_mcastjoin(struct mcast_receiver * p_receiver)
@@ -433,7 +503,7 @@ void handle_mcastjoin(struct mcast_receiver * p_receiver)
         default:
             break;
     }
-    debug_outputln("%s %4.4u", __FILE__, __LINE__);
+    debug_log_trace(DEBUG_CATEGORY_RECEIVER, "%s %4.4u", __FILE__, __LINE__);
 }
 
 void handle_mcastleave(struct mcast_receiver * p_receiver)
@@ -456,7 +526,7 @@ void handle_mcastleave(struct mcast_receiver * p_receiver)
         default:
             break;
     }
-    debug_outputln("%s %4.4u", __FILE__, __LINE__);
+    debug_log_trace(DEBUG_CATEGORY_RECEIVER, "%s %4.4u", __FILE__, __LINE__);
     return;
 }
 
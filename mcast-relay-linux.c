@@ -0,0 +1,117 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file mcast-relay-linux.c
+ * @brief Multicast relay for Linux.
+ * @details Reads the stream table given on the command line and relays the streams until interrupted.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include "mcast-relay.h"
+#include "debug_helpers.h"
+
+/*!
+ * @brief How often the counters are printed, in seconds.
+ */
+#define STATS_INTERVAL_SEC (10)
+
+volatile sig_atomic_t g_stop_processing;
+
+static void sigint_handle(int signal)
+{
+    g_stop_processing = 1;
+}
+
+static void dump_stats(FILE * fp, struct mcast_relay const * p_relay, struct mcast_relay_table const * p_table)
+{
+    unsigned int idx, jdx;
+    for (idx = 0; idx < p_table->streams_count_; ++idx)
+    {
+        for (jdx = 0; jdx < p_table->streams_[idx].destinations_count_; ++jdx)
+        {
+            struct mcast_relay_stats stats;
+            if (mcast_relay_get_stats(p_relay, idx, jdx, &stats))
+            {
+                char group[MCAST_SETTINGS_ADDRESS_LENGTH] = { 0 };
+                mcast_settings_format_address(&p_table->streams_[idx].destinations_[jdx].settings_.mcast_addr_, group, sizeof(group));
+                fprintf(fp, "%4.4u %s : %s -> %s %hu rcv:%llu snt:%llu drp:%llu trc:%llu\n", __LINE__, __FILE__,
+                        p_table->streams_[idx].name_,
+                        group,
+                        mcast_settings_get_port(&p_table->streams_[idx].destinations_[jdx].settings_),
+                        (unsigned long long)stats.received_,
+                        (unsigned long long)stats.sent_,
+                        (unsigned long long)stats.dropped_,
+                        (unsigned long long)stats.truncated_);
+            }
+        }
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    struct mcast_relay_table table;
+    struct mcast_relay * p_relay;
+    time_t last_dump;
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s <stream-table-file>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (!mcast_relay_table_load(&table, argv[1]))
+    {
+        fprintf(stderr, "%4.4u %s : cannot load the stream table from '%s'\n", __LINE__, __FILE__, argv[1]);
+        return EXIT_FAILURE;
+    }
+    p_relay = mcast_relay_create(&table);
+    if (NULL == p_relay)
+    {
+        fprintf(stderr, "%4.4u %s : cannot set up the relay\n", __LINE__, __FILE__);
+        return EXIT_FAILURE;
+    }
+    {
+        struct sigaction query_action;
+        memset(&query_action, 0, sizeof(query_action));
+        query_action.sa_handler = &sigint_handle;
+        if (sigaction (SIGINT, &query_action, NULL) < 0)
+            exit(EXIT_FAILURE);
+    }
+    debug_output_async_start();
+    last_dump = time(NULL);
+    while (!g_stop_processing)
+    {
+        if (mcast_relay_run_once(p_relay, 1000) < 0)
+        {
+            fprintf(stderr, "%4.4u %s : %d %s\n", __LINE__, __FILE__, errno, strerror(errno));
+            break;
+        }
+        if (time(NULL) - last_dump >= STATS_INTERVAL_SEC)
+        {
+            dump_stats(stderr, p_relay, &table);
+            last_dump = time(NULL);
+        }
+    }
+    dump_stats(stderr, p_relay, &table);
+    mcast_relay_destroy(p_relay);
+    debug_output_async_stop();
+    return 0;
+}
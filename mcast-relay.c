@@ -0,0 +1,530 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file mcast-relay.c
+ * @brief Multicast relay implementation.
+ * @details Datagrams are received with recvmmsg() into a per stream ring and sent with sendmmsg() straight from that ring, each destination with its own cursor and token bucket.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include <poll.h>
+#include <ctype.h>
+#include "mcast-relay.h"
+#include "mcast_setup.h"
+#include "debug_helpers.h"
+#include "perf-counter-itf.h"
+
+/*!
+ * @brief Maximum size of the relayed datagram. Larger ones would be cut short, so they are dropped.
+ */
+#define RELAY_MAX_DATAGRAM (2048)
+
+/*!
+ * @brief Number of datagram slots in each stream's ring. Must be a power of 2.
+ */
+#define RELAY_RING_SLOTS (256)
+
+/*!
+ * @brief Maximum number of datagrams received or sent with a single system call.
+ */
+#define RELAY_BATCH (32)
+
+/*!
+ * @brief For how long a paced destination may send at full speed, in nanoseconds.
+ */
+#define RELAY_BURST_NS (20000000ULL)
+
+/*!
+ * @brief A single received datagram.
+ */
+struct relay_slot {
+    uint32_t length_; /*!< Number of bytes in the datagram. */
+    uint8_t data_[RELAY_MAX_DATAGRAM]; /*!< The datagram. */
+};
+
+/*!
+ * @brief Runtime state of a destination.
+ * @details Every destination has its own read cursor into the stream's ring, so the destinations
+ * are paced independently and a slow one never holds back the others.
+ */
+struct relay_destination {
+    struct mcast_connection conn_; /*!< Connection to the destination group. */
+    int connected_; /*!< Non-zero if conn_ has been set up. */
+    uint32_t rate_; /*!< Maximum rate, bytes per second, 0 if not paced. */
+    int64_t tokens_; /*!< Number of bytes that can be sent right now. */
+    int64_t bucket_size_; /*!< Maximum number of tokens. */
+    uint64_t refill_ns_; /*!< Time when the tokens were last refilled. */
+    uint32_t cursor_; /*!< Free running index of the next slot to send. */
+    struct mcast_relay_stats stats_; /*!< Counters. */
+    struct mmsghdr msgs_[RELAY_BATCH]; /*!< Message headers for the sendmmsg() call. */
+    struct iovec iovs_[RELAY_BATCH]; /*!< Those point straight into the ring slots. */
+};
+
+/*!
+ * @brief Runtime state of a stream.
+ */
+struct relay_stream {
+    struct mcast_connection conn_; /*!< Connection to the source group. */
+    int connected_; /*!< Non-zero if conn_ has been set up. */
+    uint32_t head_; /*!< Free running index of the next slot to receive into. */
+    uint64_t received_; /*!< Number of datagrams received. */
+    uint64_t truncated_; /*!< Number of datagrams dropped, because they did not fit a slot. */
+    unsigned int destinations_count_; /*!< Number of destinations. */
+    struct relay_destination * destinations_; /*!< Destinations. */
+    struct relay_slot * slots_; /*!< The ring. */
+    struct mmsghdr msgs_[RELAY_BATCH]; /*!< Message headers for the recvmmsg() call. */
+    struct iovec iovs_[RELAY_BATCH]; /*!< Those point straight into the ring slots. */
+};
+
+/*!
+ * @brief The relay.
+ */
+struct mcast_relay {
+    unsigned int streams_count_; /*!< Number of streams. */
+    struct relay_stream * streams_; /*!< Streams. */
+    struct pollfd * poll_fds_; /*!< One entry per stream, for the poll() call. */
+};
+
+static int parse_settings(struct mcast_settings * p_settings, char * psz_group, unsigned int port, int ttl)
+{
+    char * p_comma = strchr(psz_group, ',');
+    ZeroMemory(p_settings, sizeof(struct mcast_settings));
+    p_settings->bindAddr_ = NULL;
+    p_settings->nTTL_ = ttl;
+    if (NULL != p_comma)
+    {
+        /* The 'source,group' form asks for a source specific join. */
+        *p_comma = '\0';
+        if (!mcast_settings_set_source(p_settings, psz_group) || !mcast_settings_is_source_specific(p_settings))
+            return 0;
+        psz_group = p_comma + 1;
+    }
+    if (port > 0xffff || !mcast_settings_set_group(p_settings, psz_group, (unsigned short)port))
+        return 0;
+    return mcast_settings_validate(p_settings);
+}
+
+static struct mcast_relay_stream * find_or_add_stream(struct mcast_relay_table * p_table, char const * psz_name)
+{
+    unsigned int idx;
+    struct mcast_relay_stream * p_stream;
+    for (idx = 0; idx < p_table->streams_count_; ++idx)
+        if (0 == strcmp(p_table->streams_[idx].name_, psz_name))
+            return &p_table->streams_[idx];
+    if (p_table->streams_count_ >= MCAST_RELAY_MAX_STREAMS)
+        return NULL;
+    p_stream = &p_table->streams_[p_table->streams_count_++];
+    ZeroMemory(p_stream, sizeof(struct mcast_relay_stream));
+    snprintf(p_stream->name_, sizeof(p_stream->name_), "%s", psz_name);
+    return p_stream;
+}
+
+static int parse_line(struct mcast_relay_table * p_table, char const * p_line, unsigned int line_no)
+{
+    char name[MCAST_RELAY_NAME_LENGTH];
+    char direction[8];
+    char group[2 * MCAST_SETTINGS_ADDRESS_LENGTH];
+    unsigned int port;
+    int ttl = 0;
+    unsigned int rate_kbps = 0;
+    int fields;
+    struct mcast_relay_stream * p_stream;
+    while (isspace((unsigned char)*p_line))
+        ++p_line;
+    if ('\0' == *p_line || '#' == *p_line)
+        return 1;
+    fields = sscanf(p_line, "%31s %7s %127s %u %d %u", name, direction, group, &port, &ttl, &rate_kbps);
+    if (fields < 4)
+    {
+        debug_outputln("%s %4.4u : line %u: too few columns", __FILE__, __LINE__, line_no);
+        return 0;
+    }
+    p_stream = find_or_add_stream(p_table, name);
+    if (NULL == p_stream)
+    {
+        debug_outputln("%s %4.4u : line %u: too many streams", __FILE__, __LINE__, line_no);
+        return 0;
+    }
+    if (0 == strcmp(direction, "in"))
+    {
+        if (p_stream->has_source_ || !parse_settings(&p_stream->source_, group, port, ttl))
+        {
+            debug_outputln("%s %4.4u : line %u: bad source of '%s'", __FILE__, __LINE__, line_no, name);
+            return 0;
+        }
+        p_stream->has_source_ = 1;
+    }
+    else if (0 == strcmp(direction, "out"))
+    {
+        struct mcast_relay_destination * p_destination;
+        if (p_stream->destinations_count_ >= MCAST_RELAY_MAX_DESTINATIONS || fields < 5)
+        {
+            debug_outputln("%s %4.4u : line %u: bad destination of '%s'", __FILE__, __LINE__, line_no, name);
+            return 0;
+        }
+        p_destination = &p_stream->destinations_[p_stream->destinations_count_];
+        if (!parse_settings(&p_destination->settings_, group, port, ttl))
+        {
+            debug_outputln("%s %4.4u : line %u: bad destination of '%s'", __FILE__, __LINE__, line_no, name);
+            return 0;
+        }
+        /* In bytes per second, the rate must fit 32 bits, so that the token refill does not overflow. */
+        if (rate_kbps > UINT32_MAX / (1000 / 8))
+        {
+            debug_outputln("%s %4.4u : line %u: rate %u of '%s' too high", __FILE__, __LINE__, line_no, rate_kbps, name);
+            return 0;
+        }
+        p_destination->rate_ = rate_kbps * (1000 / 8);
+        ++p_stream->destinations_count_;
+    }
+    else
+    {
+        debug_outputln("%s %4.4u : line %u: unknown direction '%s'", __FILE__, __LINE__, line_no, direction);
+        return 0;
+    }
+    return 1;
+}
+
+int mcast_relay_table_parse(struct mcast_relay_table * p_table, char const * p_text)
+{
+    unsigned int line_no = 1;
+    unsigned int idx;
+    ZeroMemory(p_table, sizeof(struct mcast_relay_table));
+    while (NULL != p_text && '\0' != *p_text)
+    {
+        char line[256];
+        char const * p_eol = strchr(p_text, '\n');
+        size_t length = (NULL != p_eol) ? (size_t)(p_eol - p_text) : strlen(p_text);
+        if (length >= sizeof(line))
+            return 0;
+        CopyMemory(line, p_text, length);
+        line[length] = '\0';
+        if (!parse_line(p_table, line, line_no))
+            return 0;
+        p_text = (NULL != p_eol) ? p_eol + 1 : NULL;
+        ++line_no;
+    }
+    for (idx = 0; idx < p_table->streams_count_; ++idx)
+    {
+        if (!p_table->streams_[idx].has_source_ || 0 == p_table->streams_[idx].destinations_count_)
+        {
+            debug_outputln("%s %4.4u : stream '%s' needs one 'in' and at least one 'out' entry", __FILE__, __LINE__, p_table->streams_[idx].name_);
+            return 0;
+        }
+    }
+    return p_table->streams_count_ > 0;
+}
+
+int mcast_relay_table_load(struct mcast_relay_table * p_table, char const * psz_file_name)
+{
+    FILE * fp;
+    char * p_text;
+    long size;
+    int result = 0;
+    fp = fopen(psz_file_name, "r");
+    if (NULL == fp)
+        return 0;
+    if (0 == fseek(fp, 0, SEEK_END) && (size = ftell(fp)) >= 0 && 0 == fseek(fp, 0, SEEK_SET))
+    {
+        p_text = (char *)malloc((size_t)size + 1);
+        if (NULL != p_text)
+        {
+            p_text[fread(p_text, 1, (size_t)size, fp)] = '\0';
+            result = mcast_relay_table_parse(p_table, p_text);
+            free(p_text);
+        }
+    }
+    fclose(fp);
+    return result;
+}
+
+struct mcast_relay * mcast_relay_create(struct mcast_relay_table const * p_table)
+{
+    struct mcast_relay * p_relay;
+    unsigned int idx, jdx;
+    p_relay = (struct mcast_relay *)calloc(1, sizeof(struct mcast_relay));
+    if (NULL == p_relay)
+        return NULL;
+    p_relay->streams_ = (struct relay_stream *)calloc(p_table->streams_count_, sizeof(struct relay_stream));
+    p_relay->poll_fds_ = (struct pollfd *)calloc(p_table->streams_count_, sizeof(struct pollfd));
+    if (NULL == p_relay->streams_ || NULL == p_relay->poll_fds_)
+        goto cleanup;
+    p_relay->streams_count_ = p_table->streams_count_;
+    for (idx = 0; idx < p_table->streams_count_; ++idx)
+    {
+        struct mcast_relay_stream const * p_entry = &p_table->streams_[idx];
+        struct relay_stream * p_stream = &p_relay->streams_[idx];
+        p_stream->slots_ = (struct relay_slot *)malloc(RELAY_RING_SLOTS * sizeof(struct relay_slot));
+        p_stream->destinations_ = (struct relay_destination *)calloc(p_entry->destinations_count_, sizeof(struct relay_destination));
+        if (NULL == p_stream->slots_ || NULL == p_stream->destinations_)
+            goto cleanup;
+        p_stream->destinations_count_ = p_entry->destinations_count_;
+        if (!setup_multicast_indirect(&p_entry->source_, &p_stream->conn_))
+        {
+            debug_outputln("%s %4.4u : cannot join source of '%s'", __FILE__, __LINE__, p_entry->name_);
+            goto cleanup;
+        }
+        p_stream->connected_ = 1;
+        p_relay->poll_fds_[idx].fd = p_stream->conn_.socket_;
+        p_relay->poll_fds_[idx].events = POLLIN;
+        for (jdx = 0; jdx < p_entry->destinations_count_; ++jdx)
+        {
+            struct relay_destination * p_destination = &p_stream->destinations_[jdx];
+            /* Send only: a destination that joined its group would feed the relay its own output. */
+            if (!setup_multicast_sender(&p_entry->destinations_[jdx].settings_, &p_destination->conn_))
+            {
+                debug_outputln("%s %4.4u : cannot set up destination %u of '%s'", __FILE__, __LINE__, jdx, p_entry->name_);
+                goto cleanup;
+            }
+            p_destination->connected_ = 1;
+            p_destination->rate_ = p_entry->destinations_[jdx].rate_;
+            p_destination->bucket_size_ = max((int64_t)(p_destination->rate_ * RELAY_BURST_NS / 1000000000ULL), (int64_t)RELAY_MAX_DATAGRAM);
+            p_destination->tokens_ = p_destination->bucket_size_;
+            p_destination->refill_ns_ = perf_counter_get_monotonic_ns();
+        }
+    }
+    return p_relay;
+cleanup:
+    mcast_relay_destroy(p_relay);
+    return NULL;
+}
+
+void mcast_relay_destroy(struct mcast_relay * p_relay)
+{
+    unsigned int idx, jdx;
+    if (NULL == p_relay)
+        return;
+    if (NULL != p_relay->streams_)
+    {
+        for (idx = 0; idx < p_relay->streams_count_; ++idx)
+        {
+            struct relay_stream * p_stream = &p_relay->streams_[idx];
+            if (NULL != p_stream->destinations_)
+            {
+                for (jdx = 0; jdx < p_stream->destinations_count_; ++jdx)
+                    if (p_stream->destinations_[jdx].connected_)
+                        close_multicast(&p_stream->destinations_[jdx].conn_);
+                free(p_stream->destinations_);
+            }
+            if (p_stream->connected_)
+                close_multicast(&p_stream->conn_);
+            free(p_stream->slots_);
+        }
+        free(p_relay->streams_);
+    }
+    free(p_relay->poll_fds_);
+    free(p_relay);
+}
+
+/*!
+ * @brief Receives all pending datagrams of the stream into its ring.
+ * @details Destinations that lag more than the ring size behind lose their oldest datagrams.
+ * @return returns number of received datagrams.
+ */
+static int relay_receive(struct relay_stream * p_stream)
+{
+    int total = 0;
+    for (;;)
+    {
+        int idx, received;
+        int batch;
+        unsigned int jdx;
+        uint32_t max_backlog = 0;
+        for (jdx = 0; jdx < p_stream->destinations_count_; ++jdx)
+            max_backlog = max(max_backlog, p_stream->head_ - p_stream->destinations_[jdx].cursor_);
+        if (max_backlog >= RELAY_RING_SLOTS)
+        {
+            /* The ring is full: the destinations that lag the most lose their oldest datagrams. */
+            for (jdx = 0; jdx < p_stream->destinations_count_; ++jdx)
+            {
+                struct relay_destination * p_destination = &p_stream->destinations_[jdx];
+                uint32_t backlog = p_stream->head_ + RELAY_BATCH - p_destination->cursor_;
+                if (backlog > RELAY_RING_SLOTS)
+                {
+                    p_destination->stats_.dropped_ += backlog - RELAY_RING_SLOTS;
+                    p_destination->cursor_ += backlog - RELAY_RING_SLOTS;
+                }
+            }
+            batch = RELAY_BATCH;
+        }
+        else
+        {
+            batch = (int)min((uint32_t)RELAY_BATCH, RELAY_RING_SLOTS - max_backlog);
+        }
+        for (idx = 0; idx < batch; ++idx)
+        {
+            struct relay_slot * p_slot = &p_stream->slots_[(p_stream->head_ + idx) & (RELAY_RING_SLOTS - 1)];
+            p_stream->iovs_[idx].iov_base = p_slot->data_;
+            p_stream->iovs_[idx].iov_len = sizeof(p_slot->data_);
+            ZeroMemory(&p_stream->msgs_[idx].msg_hdr, sizeof(struct msghdr));
+            p_stream->msgs_[idx].msg_hdr.msg_iov = &p_stream->iovs_[idx];
+            p_stream->msgs_[idx].msg_hdr.msg_iovlen = 1;
+        }
+        received = recvmmsg(p_stream->conn_.socket_, p_stream->msgs_, batch, MSG_DONTWAIT, NULL);
+        if (received <= 0)
+            break;
+        {
+            /* A datagram that did not fit its slot has been cut short, so it is dropped, and the ones after it move
+             * up to close the gap. */
+            int kept = 0;
+            for (idx = 0; idx < received; ++idx)
+            {
+                struct relay_slot * p_slot = &p_stream->slots_[(p_stream->head_ + idx) & (RELAY_RING_SLOTS - 1)];
+                if (0 != (p_stream->msgs_[idx].msg_hdr.msg_flags & MSG_TRUNC))
+                {
+                    ++p_stream->truncated_;
+                    continue;
+                }
+                p_slot->length_ = p_stream->msgs_[idx].msg_len;
+                if (kept != idx)
+                {
+                    struct relay_slot * p_kept = &p_stream->slots_[(p_stream->head_ + kept) & (RELAY_RING_SLOTS - 1)];
+                    p_kept->length_ = p_slot->length_;
+                    memcpy(p_kept->data_, p_slot->data_, p_slot->length_);
+                }
+                ++kept;
+            }
+            p_stream->head_ += kept;
+            p_stream->received_ += kept;
+            total += kept;
+        }
+        if (received < batch)
+            break;
+    }
+    return total;
+}
+
+/*!
+ * @brief Sends as many of the pending datagrams as the destination's pacing allows.
+ * @return returns number of nanoseconds after which the destination can send again, 0 if there is nothing to wait for.
+ */
+static uint64_t relay_flush(struct relay_stream * p_stream, struct relay_destination * p_destination, uint64_t now_ns)
+{
+    if (0 != p_destination->rate_)
+    {
+        uint64_t elapsed_ns = min(now_ns - p_destination->refill_ns_, 1000000000ULL);
+        p_destination->tokens_ += (int64_t)(elapsed_ns * p_destination->rate_ / 1000000000ULL);
+        p_destination->tokens_ = min(p_destination->tokens_, p_destination->bucket_size_);
+    }
+    p_destination->refill_ns_ = now_ns;
+    while (p_destination->cursor_ != p_stream->head_)
+    {
+        int count = 0;
+        int sent;
+        int64_t budget = p_destination->tokens_;
+        uint32_t pending = p_stream->head_ - p_destination->cursor_;
+        struct sockaddr * p_to = p_destination->conn_.multiAddr_->ai_addr;
+        socklen_t to_length = p_destination->conn_.multiAddr_->ai_addrlen;
+        for (; count < RELAY_BATCH && (uint32_t)count < pending; ++count)
+        {
+            struct relay_slot * p_slot = &p_stream->slots_[(p_destination->cursor_ + count) & (RELAY_RING_SLOTS - 1)];
+            if (0 != p_destination->rate_)
+            {
+                if (budget < (int64_t)p_slot->length_)
+                    break;
+                budget -= p_slot->length_;
+            }
+            p_destination->iovs_[count].iov_base = p_slot->data_;
+            p_destination->iovs_[count].iov_len = p_slot->length_;
+            ZeroMemory(&p_destination->msgs_[count].msg_hdr, sizeof(struct msghdr));
+            p_destination->msgs_[count].msg_hdr.msg_name = p_to;
+            p_destination->msgs_[count].msg_hdr.msg_namelen = to_length;
+            p_destination->msgs_[count].msg_hdr.msg_iov = &p_destination->iovs_[count];
+            p_destination->msgs_[count].msg_hdr.msg_iovlen = 1;
+        }
+        if (0 == count)
+        {
+            struct relay_slot * p_slot = &p_stream->slots_[p_destination->cursor_ & (RELAY_RING_SLOTS - 1)];
+            return (uint64_t)(p_slot->length_ - p_destination->tokens_) * 1000000000ULL / p_destination->rate_ + 1;
+        }
+        sent = sendmmsg(p_destination->conn_.socket_, p_destination->msgs_, count, MSG_DONTWAIT);
+        if (sent < 0)
+        {
+            if (EAGAIN == errno || EWOULDBLOCK == errno)
+                return 1000000ULL;
+            /* Anything else is not going to get better by retrying, so the datagram is dropped. */
+            debug_outputln("%s %4.4u : %d %s", __FILE__, __LINE__, errno, strerror(errno));
+            ++p_destination->cursor_;
+            ++p_destination->stats_.dropped_;
+            continue;
+        }
+        if (0 != p_destination->rate_)
+        {
+            int idx;
+            for (idx = 0; idx < sent; ++idx)
+                p_destination->tokens_ -= p_destination->iovs_[idx].iov_len;
+        }
+        p_destination->cursor_ += sent;
+        p_destination->stats_.sent_ += sent;
+        if (sent < count)
+            return 1000000ULL;
+    }
+    return 0;
+}
+
+int mcast_relay_run_once(struct mcast_relay * p_relay, int timeout_ms)
+{
+    unsigned int idx, jdx;
+    int result;
+    int total = 0;
+    uint64_t now_ns;
+    uint64_t wait_ns = (uint64_t)timeout_ms * 1000000ULL;
+    /* Pending paced datagrams shorten the wait. */
+    now_ns = perf_counter_get_monotonic_ns();
+    for (idx = 0; idx < p_relay->streams_count_; ++idx)
+    {
+        struct relay_stream * p_stream = &p_relay->streams_[idx];
+        for (jdx = 0; jdx < p_stream->destinations_count_; ++jdx)
+        {
+            uint64_t next_ns = relay_flush(p_stream, &p_stream->destinations_[jdx], now_ns);
+            if (0 != next_ns)
+                wait_ns = min(wait_ns, next_ns);
+        }
+    }
+    result = poll(p_relay->poll_fds_, p_relay->streams_count_, (int)((wait_ns + 999999ULL) / 1000000ULL));
+    if (result < 0)
+        return EINTR == errno ? 0 : -1;
+    for (idx = 0; idx < p_relay->streams_count_; ++idx)
+    {
+        if (p_relay->poll_fds_[idx].revents & POLLIN)
+            total += relay_receive(&p_relay->streams_[idx]);
+    }
+    now_ns = perf_counter_get_monotonic_ns();
+    for (idx = 0; idx < p_relay->streams_count_; ++idx)
+    {
+        struct relay_stream * p_stream = &p_relay->streams_[idx];
+        for (jdx = 0; jdx < p_stream->destinations_count_; ++jdx)
+            relay_flush(p_stream, &p_stream->destinations_[jdx], now_ns);
+    }
+    return total;
+}
+
+int mcast_relay_get_stats(struct mcast_relay const * p_relay, unsigned int stream, unsigned int destination, struct mcast_relay_stats * p_stats)
+{
+    if (stream >= p_relay->streams_count_ || destination >= p_relay->streams_[stream].destinations_count_)
+        return 0;
+    *p_stats = p_relay->streams_[stream].destinations_[destination].stats_;
+    p_stats->received_ = p_relay->streams_[stream].received_;
+    p_stats->truncated_ = p_relay->streams_[stream].truncated_;
+    return 1;
+}
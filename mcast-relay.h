@@ -0,0 +1,164 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+
+/**
+ * @file mcast-relay.h
+ * @brief Multicast relay.
+ * @details Receives streams from their source groups and re-publishes each one to several destination groups.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+#if !defined MCAST_RELAY_H_5E2B7C14_9A03_4F6D_8C21_B47E0D93A6F1
+#define MCAST_RELAY_H_5E2B7C14_9A03_4F6D_8C21_B47E0D93A6F1
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+#include "std-int.h"
+#include "mcast-settings.h"
+
+/*!
+ * @brief Maximum number of streams a single relay handles.
+ */
+#define MCAST_RELAY_MAX_STREAMS (16)
+
+/*!
+ * @brief Maximum number of groups a single stream is re-published to.
+ */
+#define MCAST_RELAY_MAX_DESTINATIONS (16)
+
+/*!
+ * @brief Maximum length of the stream name, including the terminating NUL.
+ */
+#define MCAST_RELAY_NAME_LENGTH (32)
+
+/*!
+ * @brief Describes a group to which the stream is re-published.
+ */
+struct mcast_relay_destination {
+    struct mcast_settings settings_; /*!< Group, port and TTL of the destination. */
+    uint32_t rate_; /*!< Maximum outgoing rate, in bytes per second. 0 means that sending is not paced. */
+};
+
+/*!
+ * @brief Describes a single relayed stream.
+ */
+struct mcast_relay_stream {
+    char name_[MCAST_RELAY_NAME_LENGTH]; /*!< Name of the stream, as given in the stream table. */
+    int has_source_; /*!< Non-zero if the source group has been given. */
+    struct mcast_settings source_; /*!< Group and port the stream is received from. */
+    unsigned int destinations_count_; /*!< Number of valid entries in the destinations_ array. */
+    struct mcast_relay_destination destinations_[MCAST_RELAY_MAX_DESTINATIONS]; /*!< Groups the stream is re-published to. */
+};
+
+/*!
+ * @brief The stream table.
+ * @details The stream table is a text, one entry per line. Empty lines and the lines that start with '#' are ignored.
+ * Each entry has the following columns, separated with white space:
+ * @code
+ * # name    direction  group       port   ttl  rate[kbit/s]
+ * voice     in         239.0.0.1   25000  1
+ * voice     out        239.1.0.1   25000  16   256
+ * voice     out        239.192.0.1 25002  32
+ * @endcode
+ * Each stream has exactly one 'in' entry and at least one 'out' entry. The 'ttl' column of the 'in' entry is ignored.
+ * The 'rate' column is optional; if it is absent or 0, the destination is not paced.
+ * The group of the 'in' entry may be written as 'source,group', for example 10.1.2.3,232.1.1.1; the source group
+ * is then joined source specific, and datagrams from any other sender are dropped by the kernel.
+ * Groups may be IPv6 addresses as well, with an optional scope, for example ff02::1%eth0. For IPv6 the 'ttl' column
+ * is the hop limit.
+ */
+struct mcast_relay_table {
+    unsigned int streams_count_; /*!< Number of valid entries in the streams_ array. */
+    struct mcast_relay_stream streams_[MCAST_RELAY_MAX_STREAMS]; /*!< The streams. */
+};
+
+/*!
+ * @brief Per destination counters.
+ */
+struct mcast_relay_stats {
+    uint64_t received_; /*!< Number of datagrams received from the stream's source group. */
+    uint64_t sent_; /*!< Number of datagrams sent to the destination group. */
+    uint64_t dropped_; /*!< Number of datagrams not sent, because the destination could not keep up. */
+    uint64_t truncated_; /*!< Number of datagrams received from the stream's source group, but not relayed, because they were too large. */
+};
+
+/*!
+ * @brief Forward declaration.
+ */
+struct mcast_relay;
+
+/*!
+ * @brief Parses the stream table.
+ * @param[out] p_table this structure will be written with the parsed table.
+ * @param[in] p_text text of the stream table.
+ * @return returns non-zero on success, 0 if the table is malformed.
+ */
+int mcast_relay_table_parse(struct mcast_relay_table * p_table, char const * p_text);
+
+/*!
+ * @brief Reads the stream table from the file.
+ * @param[out] p_table this structure will be written with the parsed table.
+ * @param[in] psz_file_name name of the file that holds the stream table.
+ * @return returns non-zero on success, 0 otherwise.
+ */
+int mcast_relay_table_load(struct mcast_relay_table * p_table, char const * psz_file_name);
+
+/*!
+ * @brief Creates the relay.
+ * @details Joins all the source groups and sets up all the destination connections.
+ * @param[in] p_table the stream table.
+ * @return returns a handle to the relay, or NULL if creation failed.
+ */
+struct mcast_relay * mcast_relay_create(struct mcast_relay_table const * p_table);
+
+/*!
+ * @brief Performs one round of relaying.
+ * @details Waits at most timeout_ms milliseconds for new data, receives all pending datagrams in batches and
+ * sends whatever the pacing of each destination allows. The datagrams are sent directly from the receive buffers.
+ * @param[in] p_relay a handle to the relay.
+ * @param[in] timeout_ms maximum time to wait for new data, in milliseconds.
+ * @return returns number of datagrams received, or -1 on error.
+ */
+int mcast_relay_run_once(struct mcast_relay * p_relay, int timeout_ms);
+
+/*!
+ * @brief Returns the counters of a given destination.
+ * @param[in] p_relay a handle to the relay.
+ * @param[in] stream index of the stream in the stream table.
+ * @param[in] destination index of the destination within the stream.
+ * @param[out] p_stats this structure will be written with the counters.
+ * @return returns non-zero on success, 0 if there is no such destination.
+ */
+int mcast_relay_get_stats(struct mcast_relay const * p_relay, unsigned int stream, unsigned int destination, struct mcast_relay_stats * p_stats);
+
+/*!
+ * @brief Leaves all the groups and destroys the relay.
+ * @param[in] p_relay a handle to the relay obtained via call to mcast_relay_create.
+ */
+void mcast_relay_destroy(struct mcast_relay * p_relay);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* MCAST_RELAY_H_5E2B7C14_9A03_4F6D_8C21_B47E0D93A6F1 */
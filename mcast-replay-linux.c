@@ -0,0 +1,233 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file mcast-replay-linux.c
+ * @brief Replays a capture file to a multicast group.
+ * @details Sends the datagrams recorded by mcast-receiver (MCAST_CAPTURE) either with their original timing, sped up, or as fast as possible.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include <getopt.h>
+#include "mcast-settings.h"
+#include "mcast_setup.h"
+#include "packet-capture.h"
+#include "debug_helpers.h"
+
+#define MCAST_GROUP_ADDRESS "239.0.0.1"
+#define MCAST_PORT_NUMBER (25000)
+
+/*!
+ * @brief Longest wait between two datagrams, in nanoseconds.
+ * @details A longer gap in the capture, e.g. the receiver was suspended, or its clock was stepped, is cut to this.
+ */
+#define MAX_GAP_NS (1000000000ULL)
+
+volatile sig_atomic_t g_stop_processing;
+
+static void sigint_handle(int signal)
+{
+    g_stop_processing = 1;
+}
+
+static void usage(char const * psz_name)
+{
+    fprintf(stderr, "Usage: %s [-g group] [-p port] [-t ttl] [-a] [-x speed] [-n loops] [-l] capture\n"
+            "  -g  group to send to, default " MCAST_GROUP_ADDRESS "\n"
+            "      IPv6 addresses may carry a scope, e.g. ff02::1%%eth0\n"
+            "  -p  port to send to, default %u\n"
+            "  -t  TTL, default 1\n"
+            "  -a  sends as fast as possible instead of with the original timing\n"
+            "  -x  speeds the original timing up by the factor, e.g. 2 plays twice as fast\n"
+            "  -n  number of times the capture is sent, default 1\n"
+            "  -l  lists the records instead of sending them\n", psz_name, MCAST_PORT_NUMBER);
+}
+
+static void list_records(FILE * fp, struct packet_capture_reader * p_reader)
+{
+    struct packet_capture_record const * p_record;
+    uint8_t const * p_data;
+    uint64_t first = 0;
+    unsigned int count = 0;
+    while (NULL != (p_record = packet_capture_reader_next(p_reader, &p_data)))
+    {
+        struct sockaddr_storage source;
+        char host[NI_MAXHOST] = "-";
+        if (packet_capture_record_is_session(p_record))
+        {
+            /* The offsets count from the start of the session, the clock of the previous one means nothing here. */
+            fprintf(fp, "session %llu.%9.9llu\n",
+                    (unsigned long long)(p_record->timestamp_ / 1000000000ULL),
+                    (unsigned long long)(p_record->timestamp_ % 1000000000ULL));
+            first = p_record->timestamp_;
+            continue;
+        }
+        if (0 == count && 0 == first)
+            first = p_record->timestamp_;
+        if (packet_capture_record_get_source(p_record, &source))
+            mcast_settings_format_address(&source, host, sizeof(host));
+        fprintf(fp, "%u %llu.%9.9llu +%.6f %s %u %u\n", count,
+                (unsigned long long)(p_record->timestamp_ / 1000000000ULL),
+                (unsigned long long)(p_record->timestamp_ % 1000000000ULL),
+                ((int64_t)(p_record->timestamp_ - first)) / 1e9, host, ntohs(p_record->port_), p_record->size_);
+        ++count;
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    struct mcast_settings settings;
+    struct mcast_connection conn;
+    struct packet_capture_reader * p_reader;
+    char const * psz_group = MCAST_GROUP_ADDRESS;
+    unsigned int port = MCAST_PORT_NUMBER;
+    unsigned int loops = 1;
+    unsigned int loop;
+    double speed = 1.0;
+    int as_fast = 0;
+    int list = 0;
+    int option;
+    uint64_t sent = 0;
+    uint64_t bytes = 0;
+    struct timespec start;
+    struct timespec stop;
+    ZeroMemory(&settings, sizeof(settings));
+    settings.nTTL_ = 1;
+    while (-1 != (option = getopt(argc, argv, "g:p:t:ax:n:lh")))
+    {
+        switch (option)
+        {
+            case 'g':
+                psz_group = optarg;
+                break;
+            case 'p':
+                port = (unsigned int)strtoul(optarg, NULL, 10);
+                break;
+            case 't':
+                settings.nTTL_ = (int)strtoul(optarg, NULL, 10);
+                break;
+            case 'a':
+                as_fast = 1;
+                break;
+            case 'x':
+                speed = strtod(optarg, NULL);
+                break;
+            case 'n':
+                loops = (unsigned int)strtoul(optarg, NULL, 10);
+                break;
+            case 'l':
+                list = 1;
+                break;
+            default:
+                usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (optind + 1 != argc || port > 0xffff || speed <= 0.0)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    p_reader = packet_capture_reader_open(argv[optind]);
+    if (NULL == p_reader)
+    {
+        fprintf(stderr, "%4.4u %s : cannot read '%s'\n", __LINE__, __FILE__, argv[optind]);
+        return EXIT_FAILURE;
+    }
+    if (list)
+    {
+        list_records(stdout, p_reader);
+        packet_capture_reader_close(p_reader);
+        return 0;
+    }
+    if (!mcast_settings_set_group(&settings, psz_group, (unsigned short)port)
+            || !mcast_settings_validate(&settings)
+            || !setup_multicast_indirect(&settings, &conn))
+    {
+        fprintf(stderr, "%4.4u %s : cannot send to %s:%u\n", __LINE__, __FILE__, psz_group, port);
+        packet_capture_reader_close(p_reader);
+        return EXIT_FAILURE;
+    }
+    {
+        struct sigaction query_action;
+        memset(&query_action, 0, sizeof(query_action));
+        query_action.sa_handler = &sigint_handle;
+        if (sigaction (SIGINT, &query_action, NULL) < 0)
+            exit(EXIT_FAILURE);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (loop = 0; loop < loops && !g_stop_processing; ++loop)
+    {
+        struct packet_capture_record const * p_record;
+        uint8_t const * p_data;
+        uint64_t previous = 0;
+        uint64_t offset = 0;
+        struct timespec session_start;
+        clock_gettime(CLOCK_MONOTONIC, &session_start);
+        packet_capture_reader_rewind(p_reader);
+        while (!g_stop_processing && NULL != (p_record = packet_capture_reader_next(p_reader, &p_data)))
+        {
+            if (packet_capture_record_is_session(p_record))
+            {
+                /* The timestamps of two sessions are unrelated, the time between them is not waited for. */
+                clock_gettime(CLOCK_MONOTONIC, &session_start);
+                previous = p_record->timestamp_;
+                offset = 0;
+                continue;
+            }
+            if (0 == previous)
+                previous = p_record->timestamp_;
+            if (!as_fast)
+            {
+                /* Each datagram goes out one recorded gap after the one before, the gaps add up to an offset on an
+                 * absolute clock so the time spent sending does not accumulate. A gap that goes backwards, because
+                 * the receiver stamped with a wall clock that was stepped, counts as none. */
+                uint64_t gap = p_record->timestamp_ > previous ? p_record->timestamp_ - previous : 0;
+                struct timespec due = session_start;
+                uint64_t nsec;
+                offset += (uint64_t)(min(gap, MAX_GAP_NS) / speed);
+                nsec = offset + due.tv_nsec;
+                due.tv_sec += nsec / 1000000000ULL;
+                due.tv_nsec = nsec % 1000000000ULL;
+                while (EINTR == clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &due, NULL) && !g_stop_processing)
+                    ;
+            }
+            previous = p_record->timestamp_;
+            if (p_record->size_ == mcast_sendto(&conn, p_data, p_record->size_))
+            {
+                ++sent;
+                bytes += p_record->size_;
+            }
+            else
+                fprintf(stderr, "%4.4u %s : %d %s\n", __LINE__, __FILE__, errno, strerror(errno));
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    {
+        double elapsed = (stop.tv_sec - start.tv_sec) + (stop.tv_nsec - start.tv_nsec) / 1e9;
+        fprintf(stderr, "%4.4u %s : sent %llu datagrams, %llu bytes in %.3f s, %.1f datagrams/s\n", __LINE__, __FILE__,
+                (unsigned long long)sent, (unsigned long long)bytes, elapsed, elapsed > 0.0 ? sent / elapsed : 0.0);
+    }
+    close_multicast(&conn);
+    packet_capture_reader_close(p_reader);
+    return 0;
+}
@@ -4,14 +4,31 @@
 #include "mcast-settings.h"
 #include "mcast_utils.h"
 #include "wave_utils.h"
+#include "wave-reader.h"
+#include "packet-index.h"
+#include "abstract-tone.h"
+#include "tone-generator.h"
+#include "audio-codec.h"
+#include "mcast-packet.h"
+#include "perf-counter-itf.h"
+#include "latency-probe.h"
+#include "stream-stats.h"
+#include "stats-server.h"
+#include "trace-recorder.h"
+#include "thread-sched.h"
+#include "pipeline.h"
+#include "debug_helpers.h"
 
-#define INTEFACE_BIND_ADDRESS "0.0.0.0"
 #define MCAST_GROUP_ADDRESS "239.0.0.1"
 #define MCAST_PORT_NUMBER "25000"
 #define FILE_TO_SEND_NAME "play.wav"
+#define EMBEDDED_TONE_NAME "embedded"
+#define WAV_TONE_PREFIX "wav:"
 #define DEFAULT_TTL (2)
 #define CHUNK_SIZE (1024)
-#define DEFAULT_SLEEP_TIME ((useconds_t)((1000000*1024)/16000))
+#define PACKET_HEADER_SIZE (MCAST_PACKET_HEADER_SIZE + 4*(MCAST_PACKET_SEND_TIME_WORDS + MCAST_PACKET_FORMAT_WORDS))
+#define STATS_SOCKET_PATH "/tmp/mcast-sender.sock"
+#define SEND_RING_SLOTS (8)
 
 volatile sig_atomic_t g_stop_processing;
 
@@ -20,88 +37,128 @@ static void dump_addrinfo(FILE * fp, struct addrinfo const * p_addr)
     struct addrinfo const * p_idx = p_addr;
     for (; NULL != p_idx; p_idx = p_idx->ai_next)
     {
-        struct sockaddr_in const * p_sock_addr_in = (struct sockaddr_in const *)p_idx->ai_addr;
-        uint8_t const * in_addr = (uint8_t const *)&p_sock_addr_in->sin_addr;
-        printf("%hhu.%hhu.%hhu.%hhu\n", in_addr[0], in_addr[1], in_addr[2], in_addr[3]);
+        char host[NI_MAXHOST] = { 0 };
+        char port[NI_MAXSERV] = { 0 };
+        getnameinfo(p_idx->ai_addr, p_idx->ai_addrlen, host, sizeof(host), port, sizeof(port), NI_NUMERICHOST | NI_NUMERICSERV);
+        fprintf(fp, "%4.4u %s : %s %s\n", __LINE__, __FILE__, host, port);
     }
 }
 
-static void dump_wave(FILE * fp, struct master_riff_chunk const * p_header)
+static void dump_wave(FILE * fp, struct wave_reader const * p_reader)
 {
-    wav_format_chunk_2_t const * p_wave_format_chunk;
-    plainwaveformat_t const * p_plainwave;
-    wav_subchunk_t const * p_subchunk;
-    p_wave_format_chunk = &p_header->format_chunk_2_;
-    p_plainwave = &p_wave_format_chunk->plain_wav_;
-    p_subchunk = &p_plainwave->subchunk_;
-
-    fprintf(fp, "%4.4u %s : %c%c%c%c %u\n", __LINE__, __FILE__,
-            p_header->ckid_[0],
-            p_header->ckid_[1],
-            p_header->ckid_[2],
-            p_header->ckid_[3],
-            p_header->cksize_);
-
-    fprintf(fp, "%4.4u %s : %c%c%c%c %c%c%c %u\n", __LINE__, __FILE__,
-            p_wave_format_chunk->waveid_[0],
-            p_wave_format_chunk->waveid_[1],
-            p_wave_format_chunk->waveid_[2],
-            p_wave_format_chunk->waveid_[3],
-            p_wave_format_chunk->ckid_[0],
-            p_wave_format_chunk->ckid_[1],
-            p_wave_format_chunk->ckid_[2],
-            p_wave_format_chunk->cksize_ 
+    struct wave_reader_format const * p_format = wave_reader_get_format(p_reader);
+    fprintf(fp, "%4.4u %s : 0x%4.4hx 0x%4.4hx %hu 0x%8.8x %u %u %hu %hu/%hu %llu\n", __LINE__, __FILE__,
+            p_format->format_tag_,
+            p_format->sub_format_,
+            p_format->channels_,
+            p_format->channel_mask_,
+            p_format->sample_rate_,
+            p_format->byte_rate_,
+            p_format->block_align_,
+            p_format->valid_bits_per_sample_,
+            p_format->bits_per_sample_,
+            (unsigned long long)wave_reader_get_frames_count(p_reader)
            );
+}
 
-    fprintf(fp, "%4.4u %s : 0x%4.4hx %hu %u %u %hu\n", __LINE__, __FILE__, 
-            p_plainwave->wavFormat_.wFormatTag,
-            p_plainwave->wavFormat_.nChannels,
-            p_plainwave->wavFormat_.nSamplesPerSec,
-            p_plainwave->wavFormat_.nAvgBytesPerSec,
-            p_plainwave->wavFormat_.nBlockAlign
-           );
+/*!
+ * @brief Reads the next frames as 16-bit samples.
+ * @details 16-bit PCM is copied as it is. Anything else, e.g. 24-bit or float, is converted through floats and
+ * dithered down to 16 bits.
+ * @return returns number of frames read.
+ */
+static size_t read_int16(struct wave_reader * p_reader, uint8_t * p_output, size_t max_frames, uint32_t * p_dither)
+{
+    static float samples[CHUNK_SIZE / sizeof(int16_t)];
+    static int16_t converted[CHUNK_SIZE / sizeof(int16_t)];
+    struct wave_reader_format const * p_format = wave_reader_get_format(p_reader);
+    size_t frames;
+    if (WAVE_FORMAT_PCM == p_format->sub_format_ && 2 * p_format->channels_ == p_format->block_align_)
+        return wave_reader_read_frames(p_reader, p_output, max_frames);
+    assert(max_frames * p_format->channels_ <= COUNTOF_ARRAY(samples));
+    frames = wave_reader_read_float(p_reader, samples, max_frames);
+    audio_codec_float_to_int16_dither(samples, converted, frames * p_format->channels_, p_dither);
+    memcpy(p_output, converted, frames * p_format->channels_ * sizeof(int16_t));
+    return frames;
+}
 
-    fprintf(fp, "%4.4u %s : 0x%4.4hx %hu %u %u %hu\n", __LINE__, __FILE__, 
-            p_plainwave->wavFormat_.wFormatTag,
-            p_plainwave->wavFormat_.nChannels,
-            p_plainwave->wavFormat_.nSamplesPerSec,
-            p_plainwave->wavFormat_.nAvgBytesPerSec,
-            p_plainwave->wavFormat_.nBlockAlign
-           );
+/*!
+ * @brief Takes the samples of the next packet either from the generator, if there is one, or from the file.
+ * @return returns number of frames read.
+ */
+static size_t read_packet(struct wave_reader * p_reader, struct tone_generator * p_generator, uint8_t * p_output, size_t max_frames, uint32_t * p_dither)
+{
+    static int16_t generated[CHUNK_SIZE / sizeof(int16_t)];
+    if (NULL == p_generator)
+        return read_int16(p_reader, p_output, max_frames, p_dither);
+    assert(max_frames * tone_generator_get_config(p_generator)->channels_ <= COUNTOF_ARRAY(generated));
+    tone_generator_fill(p_generator, generated, max_frames);
+    memcpy(p_output, generated, max_frames * tone_generator_get_config(p_generator)->channels_ * sizeof(int16_t));
+    return max_frames;
+}
 
-    fprintf(fp, "%4.4u %s : %c%c%c%c 0x%8.8x 0x%4.4hx 0x%4.4hx ..\n", __LINE__, __FILE__, 
-            p_subchunk->subchunkId_[0],
-            p_subchunk->subchunkId_[1],
-            p_subchunk->subchunkId_[2],
-            p_subchunk->subchunkId_[3],
-            p_subchunk->subchunk_size_,
-            p_subchunk->samples16_[0],
-            p_subchunk->samples16_[1]
-           );
+/*!
+ * @brief A chunk of samples, as captured.
+ * @details The capture thread numbers the chunks, so that a chunk dropped because the send thread fell behind leaves a
+ * gap in the sequence numbers and the timestamps, as a lost packet would.
+ */
+struct captured_chunk {
+    uint16_t seq_; /*!< Sequence number of the packet the chunk goes out in. */
+    uint32_t timestamp_; /*!< Media timestamp, in sample frames, of the first frame of the chunk. */
+    uint8_t samples_[CHUNK_SIZE]; /*!< The interleaved samples. */
+};
 
-    //    fprintf(fp, "%4.4u %s : %8.8hx\n", __LINE__, __FILE__, p_header->format_chunk_.wavefmt_.wFormatTag);
-}
+/*!
+ * @brief What the send thread needs, shared by its packetize and send stages.
+ */
+struct sender {
+    SOCKET s_; /*!< The socket the packets are sent to. */
+    struct addrinfo const * p_group_address_; /*!< Address of the group. */
+    struct mcast_packet_header header_; /*!< Header of the packet being sent. */
+    uint32_t sample_rate_; /*!< Sampling rate of the samples sent, in Hz. */
+    unsigned int channels_; /*!< Number of interleaved channels of the samples sent. */
+    struct stream_stats_writer * p_stats_; /*!< Where the packets sent are counted. */
+    struct perf_counter * p_send_counter_; /*!< Measures the sendto. */
+};
 
-const int8_t * get_samples_buffer(struct master_riff_chunk const * p_header)
+/*!
+ * @brief Prepends the header to the captured samples.
+ */
+static size_t packetize_chunk(void * p_context, void const * p_input, size_t input_size, void * p_output)
 {
-    wav_format_chunk_2_t const * p_wave_format_chunk;
-    plainwaveformat_t const * p_plainwave;
-    wav_subchunk_t const * p_subchunk;
-    p_wave_format_chunk = &p_header->format_chunk_2_;
-    p_plainwave = &p_wave_format_chunk->plain_wav_;
-    p_subchunk = &p_plainwave->subchunk_;
-    return &p_subchunk->samples8_[0];
+    struct sender * p_sender = (struct sender *)p_context;
+    struct captured_chunk const * p_chunk = (struct captured_chunk const *)p_input;
+    size_t samples_size = input_size - offsetof(struct captured_chunk, samples_);
+    size_t payload_offset;
+    TRACE_BEGIN("packetize");
+    p_sender->header_.seq_ = p_chunk->seq_;
+    p_sender->header_.timestamp_ = p_chunk->timestamp_;
+    /* Each packet carries its send time, so that the receivers can measure the end-to-end latency, and its format, so
+     * that they can play it out. The send stage runs inline, right after this one. */
+    payload_offset = mcast_packet_header_encode_stream(&p_sender->header_, latency_probe_get_time(), p_sender->sample_rate_, p_sender->channels_,
+            (uint8_t *)p_output, PACKET_HEADER_SIZE + CHUNK_SIZE);
+    memcpy((uint8_t *)p_output + payload_offset, p_chunk->samples_, samples_size);
+    TRACE_END("packetize");
+    return payload_offset + samples_size;
 }
 
-size_t get_samples_buffer_size(struct master_riff_chunk const * p_header)
+/*!
+ * @brief Sends the packet to the group.
+ */
+static size_t send_packet(void * p_context, void const * p_input, size_t input_size, void * p_output)
 {
-    wav_format_chunk_2_t const * p_wave_format_chunk;
-    plainwaveformat_t const * p_plainwave;
-    wav_subchunk_t const * p_subchunk;
-    p_wave_format_chunk = &p_header->format_chunk_2_;
-    p_plainwave = &p_wave_format_chunk->plain_wav_;
-    p_subchunk = &p_plainwave->subchunk_;
-    return p_subchunk->subchunk_size_;
+    struct sender * p_sender = (struct sender *)p_context;
+    ssize_t bytes_written;
+    perf_counter_mark_before(p_sender->p_send_counter_);
+    TRACE_BEGIN("sendto");
+    bytes_written = sendto(p_sender->s_, p_input, input_size, 0, p_sender->p_group_address_->ai_addr, p_sender->p_group_address_->ai_addrlen);
+    TRACE_END("sendto");
+    perf_counter_mark_after(p_sender->p_send_counter_);
+    if (bytes_written < 0)
+        debug_log_error(DEBUG_CATEGORY_SENDER, "%s %4.4u : %d %s", __FILE__, __LINE__, errno, strerror(errno));
+    else
+        stream_stats_on_packet(p_sender->p_stats_, p_sender->header_.ssrc_, p_sender->header_.seq_, (size_t)bytes_written);
+    return 0;
 }
 
 static void sigint_handle(int signal)
@@ -109,75 +166,253 @@ static void sigint_handle(int signal)
     g_stop_processing = 1;
 }
 
+volatile sig_atomic_t g_dump_trace;
+
+static void sigusr1_handle(int signal)
+{
+    g_dump_trace = 1;
+}
+
 int main(int argc, char ** argv)
 {
-    uint8_t const * p_file;
-    struct stat st_file;
+    struct abstract_tone * p_tone = NULL;
+    struct wave_reader * p_reader = NULL;
+    tone_type_t tone_type = EXTERNAL_WAV_TONE;
+    char const * psz_file = FILE_TO_SEND_NAME;
+    struct packet_index * p_index = NULL;
+    struct tone_generator * p_generator = NULL;
+    uint64_t packet_idx = 0;
+    uint64_t packets_count;
+    unsigned int channels;
+    uint32_t sample_rate;
+    size_t chunk_frames;
+    uint64_t period_ns;
+    uint64_t deadline;
+    uint32_t dither = 1;
     int result;
     struct addrinfo * p_group_address;
     struct addrinfo * p_iface_address;
     struct addrinfo a_hints;
+    struct sender sender;
+    struct captured_chunk chunk;
+    struct pipeline * p_pipeline;
+    struct perf_counter * p_send_counter = perf_counter_create();
+    struct perf_counter * p_period_counter = perf_counter_create();
+    struct stream_stats * p_stream_stats = stream_stats_create();
+    struct stream_stats_writer * p_stats_writer;
+    struct stats_server * p_stats_server;
+    struct pipeline_stage_config stages[2] = {
+        { "packetize", &packetize_chunk, &sender, sizeof(struct captured_chunk), PIPELINE_THREAD, SEND_RING_SLOTS, PIPELINE_DROP, THREAD_ROLE_SEND },
+        { "send", &send_packet, &sender, PACKET_HEADER_SIZE + CHUNK_SIZE, PIPELINE_INLINE, 0, PIPELINE_BLOCK, -1 },
+    };
+    char const * psz_group = MCAST_GROUP_ADDRESS;
+    char const * psz_port = MCAST_PORT_NUMBER;
+    char const * psz_trace = trace_recorder_enable_from_env();
+    SOCKET s;
     memset(&a_hints, 0, sizeof(a_hints));
-    SOCKET s = socket(AF_INET, SOCK_DGRAM, 0);
-    assert(s>=0); 
-    a_hints.ai_family = AF_INET;
+    memset(&sender, 0, sizeof(sender));
+    /* Optional arguments: group (IPv4, or IPv6 with an optional %scope), port, the packet to start from and the tone.
+     * The tone is either "embedded", "wav:" followed by the path of the file to send instead of play.wav, or the signal
+     * to generate, e.g. "sweep:100:8000:5", see tone_generator_parse. */
+    if (argc > 1)
+        psz_group = argv[1];
+    if (argc > 2)
+        psz_port = argv[2];
+    if (argc > 3)
+        packet_idx = strtoull(argv[3], NULL, 10);
+    a_hints.ai_family = AF_UNSPEC;
     a_hints.ai_protocol = 0;
     a_hints.ai_socktype = SOCK_DGRAM;
-    result = getaddrinfo(MCAST_GROUP_ADDRESS, MCAST_PORT_NUMBER, &a_hints, &p_group_address);
+    result = getaddrinfo(psz_group, psz_port, &a_hints, &p_group_address);
     assert(0 == result);
     dump_addrinfo(stderr, p_group_address);
+    s = socket(p_group_address->ai_family, SOCK_DGRAM, 0);
+    assert(s>=0); 
+    /* Wildcard address of the group's family, i.e. either 0.0.0.0 or ::. */
+    a_hints.ai_family = p_group_address->ai_family;
     a_hints.ai_flags = AI_PASSIVE;
-    result = getaddrinfo("0.0.0.0", NULL, &a_hints, &p_iface_address);
+    result = getaddrinfo(NULL, "0", &a_hints, &p_iface_address);
     assert(0 == result);
     dump_addrinfo(stderr, p_iface_address);
     fprintf(stderr, "%4.4u %s : %d\n", __LINE__, __FILE__, result);
     result = join_mcast_group_set_ttl(s, p_group_address, p_iface_address, DEFAULT_TTL); 
     assert(0 == result);
+    if (argc > 4 && 0 == strcmp(argv[4], EMBEDDED_TONE_NAME))
     {
-        int fd;
-        fd = open(FILE_TO_SEND_NAME, O_RDONLY);
-        assert(fd >= 0);
-        result = fstat(fd, &st_file);
-        assert(0 == result);
-        p_file = mmap(NULL, st_file.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
-        close(fd);
+        tone_type = EMBEDDED_TEST_TONE;
+        psz_file = argv[4];
+    }
+    else if (argc > 4 && 0 == strncmp(argv[4], WAV_TONE_PREFIX, strlen(WAV_TONE_PREFIX)))
+        psz_file = argv[4] + strlen(WAV_TONE_PREFIX);
+    else if (argc > 4)
+    {
+        /* The generated signal has no end, and no index, so it always starts from its beginning. */
+        struct tone_generator_config tone;
+        if (tone_generator_parse(&tone, argv[4]))
+        {
+            tone.packet_frames_ = CHUNK_SIZE / (tone.channels_ * sizeof(int16_t));
+            p_generator = tone_generator_create(&tone);
+        }
+        if (NULL == p_generator)
+        {
+            fprintf(stderr, "%4.4u %s : bad signal '%s'\n", __LINE__, __FILE__, argv[4]);
+            return EXIT_FAILURE;
+        }
+        fprintf(stdout, "%4.4u %s : %s %u %u\n", __LINE__, __FILE__, argv[4], tone.channels_, tone.sample_rate_);
+        channels = tone.channels_;
+        sample_rate = tone.sample_rate_;
+        chunk_frames = tone.packet_frames_;
+        packets_count = UINT64_MAX;
+        packet_idx = 0;
+    }
+    if (NULL == p_generator)
+    {
+        /* The file is mapped, and the pages that have been sent can be dropped, so the size does not matter. */
+        p_tone = abstract_tone_create(tone_type, EXTERNAL_WAV_TONE == tone_type ? psz_file : NULL);
+        if (NULL == p_tone)
+        {
+            fprintf(stderr, "%4.4u %s : cannot read %s\n", __LINE__, __FILE__, psz_file);
+            return EXIT_FAILURE;
+        }
+        p_reader = abstract_tone_get_reader(p_tone);
+        dump_wave(stdout, p_reader);
+        if (!wave_reader_format_is_convertible(wave_reader_get_format(p_reader)))
+        {
+            fprintf(stderr, "%4.4u %s : unsupported samples in %s\n", __LINE__, __FILE__, psz_file);
+            return EXIT_FAILURE;
+        }
+        /* The packets always carry 16-bit samples, whatever the file has. */
+        chunk_frames = CHUNK_SIZE / (wave_reader_get_format(p_reader)->channels_ * sizeof(int16_t));
+        assert(chunk_frames > 0);
+        /* Built on the first run and kept beside the file, so that any packet can be started from straight away.
+         * The embedded tone has no file, and is short, so its index is built every time. */
+        if (EMBEDDED_TEST_TONE == tone_type)
+            p_index = packet_index_build(p_reader, (uint32_t)chunk_frames);
+        else
+            p_index = packet_index_open(psz_file, p_reader, (uint32_t)chunk_frames);
+        if (NULL == p_index || 0 == packet_index_get_count(p_index))
+        {
+            fprintf(stderr, "%4.4u %s : no packets in %s\n", __LINE__, __FILE__, psz_file);
+            return EXIT_FAILURE;
+        }
+        channels = wave_reader_get_format(p_reader)->channels_;
+        sample_rate = wave_reader_get_format(p_reader)->sample_rate_;
+        packets_count = packet_index_get_count(p_index);
+        if (packet_idx >= packets_count)
+            packet_idx = 0;
     }
-    struct master_riff_chunk const * p_header = (struct master_riff_chunk const *)p_file; 
-    dump_wave(stdout, p_header);
     {
         struct sigaction query_action;
         memset(&query_action, 0, sizeof(query_action));
         query_action.sa_handler = &sigint_handle;
-        if (sigaction (SIGINT, NULL, &query_action) < 0)
+        if (sigaction (SIGINT, &query_action, NULL) < 0)
             exit(EXIT_FAILURE);
             /* sigaction returns -1 in case of error. */
+        query_action.sa_handler = &sigusr1_handle;
+        if (sigaction (SIGUSR1, &query_action, NULL) < 0)
+            exit(EXIT_FAILURE);
+    }
+    debug_output_async_start();
+    assert(NULL != p_stream_stats);
+    p_stats_writer = stream_stats_add_writer(p_stream_stats);
+    p_stats_server = stats_server_create(p_stream_stats, STATS_SOCKET_PATH);
+    /* The main thread captures, i.e. reads and paces the samples as a sound card would, and the send thread
+     * packetizes and sends them, so a slow sendto never holds the capture up. If the send thread falls behind by
+     * more than the ring, the packets are dropped rather than the capture stalled. */
+    ZeroMemory(&chunk, sizeof(chunk));
+    sender.s_ = s;
+    sender.p_group_address_ = p_group_address;
+    sender.header_.version_ = MCAST_PACKET_VERSION;
+    sender.header_.ssrc_ = (uint32_t)getpid() ^ (uint32_t)time(NULL);
+    sender.p_stats_ = stream_stats_add_writer(p_stream_stats);
+    sender.p_send_counter_ = p_send_counter;
+    sender.sample_rate_ = sample_rate;
+    sender.channels_ = channels;
+    p_pipeline = pipeline_create(stages, COUNTOF_ARRAY(stages));
+    assert(NULL != p_pipeline);
+    /* Once the helper threads run, so that they do not inherit the real time policy. 'MCAST_MLOCK=1' and
+     * 'MCAST_SCHED_CAPTURE=fifo:80@2' keep the pacing loop off the page faults and the other tasks, the send thread
+     * is scheduled by 'MCAST_SCHED_SEND'. */
+    {
+        struct thread_sched_result sched;
+        thread_sched_lock_memory_from_env();
+        thread_sched_apply_from_env(THREAD_ROLE_CAPTURE, &sched);
+        thread_sched_dump(stderr, THREAD_ROLE_CAPTURE, &sched);
     }
+    /* A packet is due once the sound card would have captured all of its frames. The deadlines are absolute, so that
+     * the time taken by the loop itself does not add up, and the stream runs at its nominal rate. */
+    period_ns = (uint64_t)chunk_frames * 1000000000ULL / sample_rate;
+    deadline = perf_counter_get_monotonic_ns();
     while (!g_stop_processing)
     {
-        int8_t const * p_buffer;
-        useconds_t sleep_time_usec = DEFAULT_SLEEP_TIME;
-        ssize_t bytes_written;
-        size_t idx = 0;
-        p_buffer = get_samples_buffer(p_header);
-        size_t samples_buffer_size = get_samples_buffer_size(p_header);
-        fprintf(stderr, "%4.4u %s : %u \n", __LINE__, __FILE__, samples_buffer_size);
-        for (; idx < samples_buffer_size / CHUNK_SIZE; ++idx)
+        fprintf(stderr, "%4.4u %s : %llu/%llu\n", __LINE__, __FILE__,
+                (unsigned long long)packet_idx, (unsigned long long)packets_count);
+        if (NULL != p_index)
+            wave_reader_seek(p_reader, packet_index_get(p_index, packet_idx)->timestamp_);
+        for (; packet_idx < packets_count && !g_stop_processing; ++packet_idx)
         {
-            int8_t const * p_buffer_to_send = p_buffer + CHUNK_SIZE*idx;
-            bytes_written = sendto(s, p_buffer_to_send, 
-                    CHUNK_SIZE, 0, p_group_address->ai_addr, p_group_address->ai_addrlen); 
-            if (bytes_written < 0)
+            /* The period counter covers the whole iteration, so it shows how steady the pacing is. */
+            if (g_dump_trace)
             {
-                fprintf(stderr, "%4.4u %s : %d %s\n", __LINE__, __FILE__, errno, strerror(errno));
+                g_dump_trace = 0;
+                if (NULL != psz_trace)
+                    trace_recorder_dump(psz_trace);
+            }
+            perf_counter_mark_before(p_period_counter);
+            TRACE_BEGIN("capture packet");
+            if (chunk_frames != read_packet(p_reader, p_generator, &chunk.samples_[0], chunk_frames, &dither))
+            {
+                TRACE_END("capture packet");
+                fprintf(stderr, "%4.4u %s : short read at packet %llu\n", __LINE__, __FILE__, (unsigned long long)packet_idx);
+                packet_idx = packets_count;
                 break;
             }
-            else
+            pipeline_push(p_pipeline, &chunk, offsetof(struct captured_chunk, samples_) + chunk_frames * channels * sizeof(int16_t));
+            /* Numbered whether or not the send thread took the chunk. */
+            ++chunk.seq_;
+            chunk.timestamp_ += (uint32_t)chunk_frames;
+            TRACE_END("capture packet");
+            deadline += period_ns;
+            {
+                struct timespec wake;
+                wake.tv_sec = (time_t)(deadline / 1000000000ULL);
+                wake.tv_nsec = (long)(deadline % 1000000000ULL);
+                while (EINTR == clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, NULL) && !g_stop_processing)
+                    ;
+            }
+            perf_counter_mark_after(p_period_counter);
             {
-                //fprintf(stderr, "%4.4u %s : %d %p\n", __LINE__, __FILE__, bytes_written, p_buffer_to_send);
+                /* The lateness is how far past its deadline the packet went, on the same clock as the deadline. The
+                 * scheduler always wakes up a bit late, so only the packets that missed a whole period count. */
+                uint64_t now = perf_counter_get_monotonic_ns();
+                uint64_t lateness = now > deadline ? now - deadline : 0;
+                stream_stats_on_lateness(p_stats_writer, sender.header_.ssrc_, lateness >= period_ns ? lateness : 0);
             }
-            usleep(sleep_time_usec);
         }
+        perf_counter_dump(p_period_counter, "period");
+        if (packet_idx >= packets_count)
+            packet_idx = 0;
     }
+    /* The packets already captured are still sent. */
+    pipeline_stop(p_pipeline);
+    perf_counter_dump(p_send_counter, "send");
+    pipeline_dump(stderr, p_pipeline);
+    pipeline_destroy(p_pipeline);
+    /* Passing this number as the third argument resumes the stream where it stopped. */
+    fprintf(stderr, "%4.4u %s : stopped at packet %llu\n", __LINE__, __FILE__, (unsigned long long)packet_idx);
+    if (NULL != psz_trace)
+        trace_recorder_dump(psz_trace);
+    perf_counter_destroy(p_period_counter);
+    perf_counter_destroy(p_send_counter);
+    stats_server_destroy(p_stats_server);
+    stream_stats_destroy(p_stream_stats);
+    tone_generator_destroy(p_generator);
+    packet_index_destroy(p_index);
+    if (NULL != p_tone)
+        abstract_tone_destroy(p_tone);
     close(s);
+    freeaddrinfo(p_iface_address);
+    freeaddrinfo(p_group_address);
+    debug_output_async_stop();
     return 0;
 }
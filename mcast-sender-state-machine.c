@@ -43,6 +43,8 @@
 #include "dsound-recorder.h"
 #include "recorder-settings.h"
 #include "soxr-lsr.h"
+#include "mcast-packet.h"
+#include "trace-recorder.h"
 
 /*!
  * @brief Maximum number of payload bytes that will fit a single 100BaseT Ethernet packet.
@@ -67,6 +69,12 @@ struct mcast_sender {
     struct circular_buffer_uint16 * p_circular_buffer_;
     /** @brief */
     recorder_settings_t rec_settings_;
+    /** @brief Identifies this sender to the receivers that mix several senders. */
+    uint32_t ssrc_;
+    /** @brief Sequence number of the next packet. */
+    uint16_t seq_;
+    /** @brief Media timestamp of the next packet, in samples. */
+    uint32_t timestamp_;
 };
 
 /**
@@ -109,6 +117,7 @@ static void mcast_send_data_packet(void * p_context, void * data, size_t data_si
     static float f_temp_input_samples[1024];
     static float f_temp_output_samples[1024];
     static uint16_t output_samples[1024];
+    static uint8_t packet[MCAST_PACKET_HEADER_SIZE + sizeof(output_samples)];
     static struct SRC_DATA conversion_params;
 
     size_t idx;
@@ -116,6 +125,7 @@ static void mcast_send_data_packet(void * p_context, void * data, size_t data_si
     int16_t const * input_samples;
     int error;
 
+    TRACE_BEGIN("sender callback");
     p_sender = (struct mcast_sender *)p_context;
     input_samples = (int16_t const *)data;
 
@@ -127,14 +137,26 @@ static void mcast_send_data_packet(void * p_context, void * data, size_t data_si
     conversion_params.input_frames = idx;
     conversion_params.output_frames = COUNTOF_ARRAY(f_temp_output_samples);
     conversion_params.src_ratio = OUTPUT_SAMPLING_FREQ/INPUT_SAMPLING_FREQ;
+    TRACE_BEGIN("resample");
     error = src_simple(&conversion_params, SRC_SINC_FASTEST, 1);
+    TRACE_END("resample");
     if (0 == error)
     {
+        struct mcast_packet_header header;
         /* Get back the samples */
         for (idx = 0; idx < COUNTOF_ARRAY(output_samples) && idx < (size_t)conversion_params.output_frames_gen; ++idx)
             output_samples[idx] = (int16_t)f_temp_output_samples[idx];
-        mcast_sendto(p_sender->conn_, output_samples, (size_t)conversion_params.output_frames_gen*sizeof(int16_t));
+        ZeroMemory(&header, sizeof(header));
+        header.version_ = MCAST_PACKET_VERSION;
+        header.seq_ = p_sender->seq_++;
+        header.timestamp_ = p_sender->timestamp_;
+        header.ssrc_ = p_sender->ssrc_;
+        p_sender->timestamp_ += (uint32_t)idx;
+        mcast_packet_header_encode(&header, packet, sizeof(packet));
+        CopyMemory(&packet[MCAST_PACKET_HEADER_SIZE], output_samples, idx*sizeof(int16_t));
+        mcast_sendto(p_sender->conn_, packet, MCAST_PACKET_HEADER_SIZE + idx*sizeof(int16_t));
     }
+    TRACE_END("sender callback");
 #else
     struct mcast_sender * p_sender;
     p_sender = (struct mcast_sender *)p_context;
@@ -219,7 +241,7 @@ int sender_handle_mcastjoin(struct mcast_sender * p_sender)
             assert(0);
             break;
     }
-    debug_outputln("%s %4.4u", __FILE__, __LINE__);
+    debug_log_trace(DEBUG_CATEGORY_SENDER, "%s %4.4u", __FILE__, __LINE__);
     return 0;
 }
 
@@ -239,13 +261,13 @@ int sender_handle_mcastleave(struct mcast_sender * p_sender)
             assert(0);
             break;
     }
-    debug_outputln("%s %4.4u", __FILE__, __LINE__);
+    debug_log_trace(DEBUG_CATEGORY_SENDER, "%s %4.4u", __FILE__, __LINE__);
     return 0;
 }
 
 int sender_handle_startrecording(struct mcast_sender * p_sender)
 {
-    debug_outputln("%4.4u %s", __LINE__, __FILE__);
+    debug_log_trace(DEBUG_CATEGORY_SENDER, "%s %4.4u", __FILE__, __LINE__);
     if (NULL == p_sender->p_circular_buffer_)
     {
        p_sender->p_circular_buffer_ = circular_buffer_uint16_create_with_size(16);
@@ -271,7 +293,7 @@ int sender_handle_startrecording(struct mcast_sender * p_sender)
 
 int sender_handle_stoprecording(struct mcast_sender * p_sender)
 {
-    debug_outputln("%4.4u %s", __LINE__, __FILE__);
+    debug_log_trace(DEBUG_CATEGORY_SENDER, "%s %4.4u", __FILE__, __LINE__);
     if (sender_handle_stopsending_internal(p_sender))
     {
         p_sender->state_= SENDER_MCAST_JOINED;
@@ -291,6 +313,7 @@ struct mcast_sender * sender_create(struct sender_settings * p_settings)
     struct mcast_sender * p_sender = (struct mcast_sender *)HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(struct mcast_sender));
     p_sender->state_= SENDER_INITIAL;
     sender_settings_copy(&p_sender->settings_, p_settings);
+    p_sender->ssrc_ = GetTickCount() ^ (GetCurrentProcessId() << 16);
     return p_sender;
 }
 
@@ -302,13 +325,13 @@ void sender_destroy(struct mcast_sender * p_sender)
         {
             /* case fall through (no 'break') is intentional. */
             case SENDER_SENDING:
-                debug_outputln("%4.4u %s", __LINE__, __FILE__);
+                debug_log_trace(DEBUG_CATEGORY_SENDER, "%s %4.4u", __FILE__, __LINE__);
                 sender_handle_stoprecording(p_sender);
             case SENDER_MCAST_JOINED:
-                debug_outputln("%4.4u %s", __LINE__, __FILE__);
+                debug_log_trace(DEBUG_CATEGORY_SENDER, "%s %4.4u", __FILE__, __LINE__);
                 sender_handle_mcastleave_internal(p_sender);
             case SENDER_INITIAL:
-                debug_outputln("%4.4u %s", __LINE__, __FILE__);
+                debug_log_trace(DEBUG_CATEGORY_SENDER, "%s %4.4u", __FILE__, __LINE__);
                 HeapFree(GetProcessHeap(), 0, p_sender);
                 break;
             default:
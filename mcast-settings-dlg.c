@@ -74,6 +74,11 @@ static const struct mcast_range {
  */
 #define TEXT_LIMIT (5)
 
+/*!
+ * @brief The IP address control edits IPv4 groups only.
+ */
+#define SETTINGS_IN4_ADDR(p_settings) ((struct sockaddr_in *)&(p_settings)->mcast_addr_)
+
 /*!
  * @brief Buffer for characters typed in the port control.
  */
@@ -96,9 +101,9 @@ static void data_to_controls(struct mcast_settings const * p_settings)
     size_t index;
     unsigned long ipaddr_host_order;
     uint8_t ip_addr[4];
-    StringCchPrintf(port_buffer, 8, "%hu", ntohs(p_settings->mcast_addr_.sin_port));
+    StringCchPrintf(port_buffer, 8, "%hu", mcast_settings_get_port(p_settings));
     SetWindowText(g_ipport_edit_ctrl, port_buffer);
-    ipaddr_host_order = ntohl(g_settings.mcast_addr_.sin_addr.s_addr);
+    ipaddr_host_order = ntohl(SETTINGS_IN4_ADDR(&g_settings)->sin_addr.s_addr);
     ip_addr[0] = (uint8_t)(0xff & (ipaddr_host_order >> 24));
     ip_addr[1] = (uint8_t)(0xff & (ipaddr_host_order >> 16));
     ip_addr[2] = (uint8_t)(0xff & (ipaddr_host_order >> 8));
@@ -137,9 +142,11 @@ static int controls_to_data(struct mcast_settings * p_settings)
      */
     if (result<=0 || port_host_order > USHRT_MAX)
         goto error;
-    p_settings->mcast_addr_.sin_port = htons((unsigned short)port_host_order);
     SendMessage(g_ipaddr_ctrl, IPM_GETADDRESS, (WPARAM)0, (LPARAM)&address);
-    p_settings->mcast_addr_.sin_addr.s_addr = htonl(address);
+    ZeroMemory(&p_settings->mcast_addr_, sizeof(p_settings->mcast_addr_));
+    SETTINGS_IN4_ADDR(p_settings)->sin_family = AF_INET;
+    SETTINGS_IN4_ADDR(p_settings)->sin_addr.s_addr = htonl(address);
+    mcast_settings_set_port(p_settings, (unsigned short)port_host_order);
     return 1;
 error:
     return 0;
@@ -213,7 +220,7 @@ static INT_PTR CALLBACK McastSettingsProc(HWND hDlg, UINT uMessage, WPARAM wPara
                 case IPN_FIELDCHANGED:
                     p_nm_ipaddr = (NMIPADDRESS*)p_nmhdr; 
                     mcast_settings_copy(&settings_copy_for_ip, &g_settings);
-                    ipaddr = ntohl(settings_copy_for_ip.mcast_addr_.sin_addr.s_addr);
+                    ipaddr = ntohl(SETTINGS_IN4_ADDR(&settings_copy_for_ip)->sin_addr.s_addr);
                     switch (p_nm_ipaddr->iField)
                     {
                         case 0:
@@ -231,7 +238,7 @@ static INT_PTR CALLBACK McastSettingsProc(HWND hDlg, UINT uMessage, WPARAM wPara
                         default:
                             break;
                     }
-                    settings_copy_for_ip.mcast_addr_.sin_addr.s_addr = htonl(ipaddr);
+                    SETTINGS_IN4_ADDR(&settings_copy_for_ip)->sin_addr.s_addr = htonl(ipaddr);
                     if (mcast_settings_validate(&settings_copy_for_ip))
                     {
                         mcast_settings_copy(&g_settings, &settings_copy_for_ip);
@@ -248,9 +255,9 @@ static INT_PTR CALLBACK McastSettingsProc(HWND hDlg, UINT uMessage, WPARAM wPara
                     switch (p_nm_updown->hdr.idFrom)
                     {
                         case IDC_PORT_SPIN:
-                            port = ntohs(settings_copy_for_spins.mcast_addr_.sin_port);
+                            port = mcast_settings_get_port(&settings_copy_for_spins);
                             port -= p_nm_updown->iDelta;
-                            settings_copy_for_spins.mcast_addr_.sin_port = htons(port);
+                            mcast_settings_set_port(&settings_copy_for_spins, port);
                             break;
                         default:
                             break;
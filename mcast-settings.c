@@ -27,7 +27,7 @@
  */
 #include "pcc.h"
 #include "mcast-settings.h"
-#include "debug_helpers.H"
+#include "debug_helpers.h"
 
 /*!
  * @brief Default multicast group IPv4 address.
@@ -49,18 +49,150 @@
  */
 #define DEFAULT_TTL (8)
 
-static struct mcast_settings g_default_settings;
+/*!
+ * @brief Parses a numeric IPv4 or IPv6 address, with the optional IPv6 scope.
+ */
+static int parse_numeric_address(struct sockaddr_storage * p_addr, char const * psz_host)
+{
+    struct addrinfo hints;
+    struct addrinfo * p_info;
+    int result;
+    ZeroMemory(&hints, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    hints.ai_flags = AI_NUMERICHOST;
+    result = getaddrinfo(psz_host, NULL, &hints, &p_info);
+    if (0 != result)
+    {
+        debug_outputln("%s %4.4u : '%s' %d", __FILE__, __LINE__, psz_host, result);
+        return 0;
+    }
+    ZeroMemory(p_addr, sizeof(struct sockaddr_storage));
+    CopyMemory(p_addr, p_info->ai_addr, min((size_t)p_info->ai_addrlen, sizeof(struct sockaddr_storage)));
+    freeaddrinfo(p_info);
+    return 1;
+}
 
 int mcast_settings_get_default(struct mcast_settings * p_target)
 {
-	unsigned long net_addr = inet_addr(DEFAULT_MCASTADDRV4);
     p_target->bindAddr_ = NULL;
     p_target->nTTL_ = DEFAULT_TTL;
-	memcpy(&p_target->mcast_addr_.sin_addr, &net_addr, sizeof(unsigned long));
-	p_target->mcast_addr_.sin_port = htons(DEFAULT_MCASTPORT);
+    ZeroMemory(&p_target->source_addr_, sizeof(p_target->source_addr_));
+    return mcast_settings_set_group(p_target, DEFAULT_MCASTADDRV4, DEFAULT_MCASTPORT);
+}
+
+int mcast_settings_set_group(struct mcast_settings * p_settings, char const * psz_group, unsigned short port)
+{
+    if (!parse_numeric_address(&p_settings->mcast_addr_, psz_group))
+        return 0;
+    mcast_settings_set_port(p_settings, port);
+    return 1;
+}
+
+int mcast_settings_set_source(struct mcast_settings * p_settings, char const * psz_source)
+{
+    if (NULL == psz_source)
+    {
+        ZeroMemory(&p_settings->source_addr_, sizeof(p_settings->source_addr_));
+        return 1;
+    }
+    return parse_numeric_address(&p_settings->source_addr_, psz_source);
+}
+
+unsigned short mcast_settings_get_port(struct mcast_settings const * p_settings)
+{
+    switch (p_settings->mcast_addr_.ss_family)
+    {
+        case AF_INET:
+            return ntohs(((struct sockaddr_in const *)&p_settings->mcast_addr_)->sin_port);
+        case AF_INET6:
+            return ntohs(((struct sockaddr_in6 const *)&p_settings->mcast_addr_)->sin6_port);
+        default:
+            return 0;
+    }
+}
+
+void mcast_settings_set_port(struct mcast_settings * p_settings, unsigned short port)
+{
+    switch (p_settings->mcast_addr_.ss_family)
+    {
+        case AF_INET:
+            ((struct sockaddr_in *)&p_settings->mcast_addr_)->sin_port = htons(port);
+            break;
+        case AF_INET6:
+            ((struct sockaddr_in6 *)&p_settings->mcast_addr_)->sin6_port = htons(port);
+            break;
+        default:
+            break;
+    }
+}
+
+int mcast_settings_get_address_size(struct sockaddr_storage const * p_addr)
+{
+    switch (p_addr->ss_family)
+    {
+        case AF_INET:
+            return sizeof(struct sockaddr_in);
+        case AF_INET6:
+            return sizeof(struct sockaddr_in6);
+        default:
+            return 0;
+    }
+}
+
+int mcast_settings_format_address(struct sockaddr_storage const * p_addr, char * p_buffer, size_t buffer_size)
+{
+    int result;
+    if (0 == mcast_settings_get_address_size(p_addr))
+        return 0;
+    result = getnameinfo((struct sockaddr const *)p_addr, mcast_settings_get_address_size(p_addr), p_buffer, buffer_size, NULL, 0, NI_NUMERICHOST);
+    if (0 != result)
+    {
+        debug_outputln("%s %4.4u : %d", __FILE__, __LINE__, result);
+        return 0;
+    }
     return 1;
 }
 
+char const * mcast_settings_scan_host(char const * psz_text, char * p_host, size_t host_size)
+{
+    char const * p_end;
+    char const * p_next;
+    if ('[' == *psz_text)
+    {
+        ++psz_text;
+        p_end = strchr(psz_text, ']');
+        if (NULL == p_end)
+            return NULL;
+        p_next = p_end + 1;
+    }
+    else
+    {
+        p_end = strchr(psz_text, ':');
+        if (NULL == p_end)
+            p_end = psz_text + strlen(psz_text);
+        p_next = p_end;
+    }
+    if (p_end == psz_text || (size_t)(p_end - psz_text) >= host_size)
+        return NULL;
+    CopyMemory(p_host, psz_text, p_end - psz_text);
+    p_host[p_end - psz_text] = '\0';
+    return p_next;
+}
+
+int mcast_settings_is_source_specific(struct mcast_settings const * p_settings)
+{
+    switch (p_settings->source_addr_.ss_family)
+    {
+        case AF_INET:
+            return INADDR_ANY != ((struct sockaddr_in const *)&p_settings->source_addr_)->sin_addr.s_addr;
+        case AF_INET6:
+            return !IN6_IS_ADDR_UNSPECIFIED(&((struct sockaddr_in6 const *)&p_settings->source_addr_)->sin6_addr);
+        default:
+            return 0;
+    }
+}
+
 /*! 
  * @brief Minimum IPv4 multicast group address.
  */
@@ -73,18 +205,56 @@ int mcast_settings_get_default(struct mcast_settings * p_target)
 
 int mcast_settings_validate(struct mcast_settings const * p_settings)
 {
-    unsigned short port = ntohs(p_settings->mcast_addr_.sin_port);
-    unsigned long addr  = ntohl(p_settings->mcast_addr_.sin_addr.s_addr); 
+    unsigned short port = mcast_settings_get_port(p_settings);
     if (port < 1024)
     {
         debug_outputln("%s %4.4u : %p %5.5hu", __FILE__, __LINE__, p_settings, (unsigned short)port);
         return 0;
     }
-    if (addr < MIN_MCAST_ADDR || addr > MAX_MCAST_ADDR)
+    if (AF_INET == p_settings->mcast_addr_.ss_family)
+    {
+        unsigned long addr = ntohl(((struct sockaddr_in const *)&p_settings->mcast_addr_)->sin_addr.s_addr);
+        if (addr < MIN_MCAST_ADDR || addr > MAX_MCAST_ADDR)
+        {
+            debug_outputln("%s %4.4u : %p %8.8lx ", __FILE__, __LINE__, p_settings, addr);
+            return 0;
+        }
+    }
+    else if (AF_INET6 == p_settings->mcast_addr_.ss_family)
     {
-        debug_outputln("%s %4.4u : %p %8.8x ", __FILE__, __LINE__, p_settings, addr);
+        if (!IN6_IS_ADDR_MULTICAST(&((struct sockaddr_in6 const *)&p_settings->mcast_addr_)->sin6_addr))
+        {
+            debug_outputln("%s %4.4u : %p", __FILE__, __LINE__, p_settings);
+            return 0;
+        }
+    }
+    else
+    {
+        debug_outputln("%s %4.4u : %p %d", __FILE__, __LINE__, p_settings, p_settings->mcast_addr_.ss_family);
         return 0;
     }
+    if (mcast_settings_is_source_specific(p_settings))
+    {
+        if (p_settings->source_addr_.ss_family != p_settings->mcast_addr_.ss_family)
+        {
+            debug_outputln("%s %4.4u : %p %d", __FILE__, __LINE__, p_settings, p_settings->source_addr_.ss_family);
+            return 0;
+        }
+        if (AF_INET == p_settings->source_addr_.ss_family)
+        {
+            unsigned long source = ntohl(((struct sockaddr_in const *)&p_settings->source_addr_)->sin_addr.s_addr);
+            if ((source >= MIN_MCAST_ADDR && source <= MAX_MCAST_ADDR) || INADDR_BROADCAST == source)
+            {
+                debug_outputln("%s %4.4u : %p %8.8lx ", __FILE__, __LINE__, p_settings, source);
+                return 0;
+            }
+        }
+        else if (IN6_IS_ADDR_MULTICAST(&((struct sockaddr_in6 const *)&p_settings->source_addr_)->sin6_addr))
+        {
+            debug_outputln("%s %4.4u : %p", __FILE__, __LINE__, p_settings);
+            return 0;
+        }
+    }
     return 1;
 }
 
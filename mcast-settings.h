@@ -39,16 +39,87 @@ extern "C" {
 #	include <sys/socket.h>	
 #	include <netdb.h>	
 #endif
+#include <stddef.h>
+
+/*!
+ * @brief Size of a buffer that holds any numeric address accepted by the settings, including the IPv6 scope suffix.
+ */
+#define MCAST_SETTINGS_ADDRESS_LENGTH (64)
 
 /*!
  * @brief Configuration of the multicast connection.
  */
 struct mcast_settings {
     char * bindAddr_; /*!< Name of the interface to bind to */
-	int nTTL_; /*!< The 'Time To Live' parameter to set on the socket. */
-	struct sockaddr_in mcast_addr_; /*!< IPv4 address and port of the multicast group */
+	int nTTL_; /*!< The 'Time To Live' (IPv4) or 'Hop Limit' (IPv6) parameter to set on the socket. */
+	struct sockaddr_storage mcast_addr_; /*!< IPv4 or IPv6 address and port of the multicast group. IPv6 addresses carry the scope ID. */
+	struct sockaddr_storage source_addr_; /*!< Address of the only sender accepted. AF_UNSPEC family or the unspecified address means any sender. */
 };
 
+/*!
+ * @brief Sets the multicast group address and port.
+ * @param[in,out] p_settings settings to be written.
+ * @param[in] psz_group numeric IPv4 or IPv6 address. IPv6 addresses may have the scope appended, e.g. ff02::1%eth0.
+ * @param[in] port port number, in host order.
+ * @return returns non-zero on success, 0 if the address cannot be parsed.
+ */
+int mcast_settings_set_group(struct mcast_settings * p_settings, char const * psz_group, unsigned short port);
+
+/*!
+ * @brief Sets the address of the only sender accepted.
+ * @param[in,out] p_settings settings to be written.
+ * @param[in] psz_source numeric IPv4 or IPv6 address, or NULL to accept any sender.
+ * @return returns non-zero on success, 0 if the address cannot be parsed.
+ */
+int mcast_settings_set_source(struct mcast_settings * p_settings, char const * psz_source);
+
+/*!
+ * @brief Returns the multicast group port, in host order.
+ * @param[in] p_settings settings to be read.
+ */
+unsigned short mcast_settings_get_port(struct mcast_settings const * p_settings);
+
+/*!
+ * @brief Sets the multicast group port.
+ * @param[in,out] p_settings settings to be written. The group address must be set before.
+ * @param[in] port port number, in host order.
+ */
+void mcast_settings_set_port(struct mcast_settings * p_settings, unsigned short port);
+
+/*!
+ * @brief Returns the length of the address held in the storage, as expected by the sockets API.
+ * @param[in] p_addr the address.
+ * @return returns the size of the family specific structure, or 0 for an unknown family.
+ */
+int mcast_settings_get_address_size(struct sockaddr_storage const * p_addr);
+
+/*!
+ * @brief Formats the address as a numeric string, without the port.
+ * @param[in] p_addr the address.
+ * @param[out] p_buffer this buffer will be written with the NUL terminated address.
+ * @param[in] buffer_size size of the buffer, MCAST_SETTINGS_ADDRESS_LENGTH is always enough.
+ * @return returns non-zero on success, 0 otherwise.
+ */
+int mcast_settings_format_address(struct sockaddr_storage const * p_addr, char * p_buffer, size_t buffer_size);
+
+/*!
+ * @brief Extracts the host part from a 'host:rest' description.
+ * @details IPv6 addresses must be enclosed in square brackets, e.g. [ff12::1]:25000, so that their colons are
+ * not mistaken for the separator.
+ * @param[in] psz_text the description.
+ * @param[out] p_host this buffer will be written with the NUL terminated host, without the brackets.
+ * @param[in] host_size size of the host buffer.
+ * @return returns pointer to the character following the host, or NULL if the description is malformed.
+ */
+char const * mcast_settings_scan_host(char const * psz_text, char * p_host, size_t host_size);
+
+/*!
+ * @brief Tells whether the settings ask for a source specific join.
+ * @param[in] p_settings settings to be checked.
+ * @return returns non-zero if only one sender is to be received from, 0 if any sender is accepted.
+ */
+int mcast_settings_is_source_specific(struct mcast_settings const * p_settings);
+
 /*!
  * @brief Returns default multicast settings. 
  * @param[in,out] p_target pointer to the settings structure. This structure will be written with the default settings.
@@ -58,7 +129,8 @@ int mcast_settings_get_default(struct mcast_settings * p_target);
 
 /*!
  * @brief Validates, if settings are correct.
- * @details Invalid multicast settings are for example those, which has a non multicast IPv4 address.
+ * @details Invalid multicast settings are for example those, which has a non multicast IPv4 or IPv6 address, or a multicast
+ * or broadcast source address, or a source address of a different family than the group.
  * @param[in] p_settings settings to be check for validity. 
  * @return returns non-zero on success, 0 otherwise.
  */
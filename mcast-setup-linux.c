@@ -41,14 +41,13 @@
 #include "mcast_utils.h"
 #include "resolve.h"
 #include "debug_helpers.h"
-
-extern int debug_outputln(const char * format_string, ...);
+#include "trace-recorder.h"
 
 static void dump_addrinfo(struct addrinfo const * p_info, const char * file, unsigned int line)
 {
     char host[NI_MAXHOST] = { 0 };
     FormatAddress(p_info->ai_addr, p_info->ai_addrlen, host, NI_MAXHOST);
-    debug_outputln("%s %4.4u : flg:%d fam:%d sot:%d pro:%d can:%s hst:'%15s' nxt:%p", file, line,
+    debug_log_debug(DEBUG_CATEGORY_NETWORK, "%s %4.4u : flg:%d fam:%d sot:%d pro:%d can:%s hst:'%15s' nxt:%p", file, line,
         p_info->ai_flags,
         p_info->ai_family,
         p_info->ai_socktype,
@@ -73,27 +72,50 @@ static int set_reuse_addr(SOCKET s)
 static void dump_locally_bound_socket(SOCKET s, const char * file, unsigned int line)
 {
     int rc;
-    struct sockaddr_in local_bind = { 0 };
+    struct sockaddr_storage local_bind = { 0 };
     socklen_t local_data_len = sizeof(local_bind);
     rc = getsockname(s, (struct sockaddr*)&local_bind, &local_data_len);
     if (SOCKET_ERROR != rc)
     {
-        debug_outputln("%s %4.4u : %s:%u", file, line, inet_ntoa(local_bind.sin_addr), ntohs(local_bind.sin_port));
+        char host[NI_MAXHOST] = { 0 };
+        FormatAddress((struct sockaddr*)&local_bind, local_data_len, host, NI_MAXHOST);
+        debug_log_debug(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %s", file, line, host);
     }
     else
     {
-        debug_outputln("%s %4.4u : %u", file, line, rc);
+        debug_log_error(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %d", file, line, rc);
     }
 }
 
-static int setup_multicast_impl(char * bindAddr, unsigned int nTTL, char * p_multicast_addr, char * p_port, struct mcast_connection * p_mcast_conn)
+/*!
+ * @brief Restricts the socket to the groups it has joined itself.
+ * @details By default Linux delivers to a socket bound to the wildcard address datagrams of every group that any
+ * other socket of the host has joined on the same port. A relay that listens on one group and sends to another
+ * group on the same port would then read back its own output.
+ */
+static int set_multicast_all_off(SOCKET s, int af)
+{
+    int optval = 0;
+    int rc = 0;
+#if defined IP_MULTICAST_ALL
+    if (AF_INET == af)
+        rc = setsockopt(s, IPPROTO_IP, IP_MULTICAST_ALL, (char *)&optval, sizeof(optval));
+#endif
+#if defined IPV6_MULTICAST_ALL
+    if (AF_INET6 == af)
+        rc = setsockopt(s, IPPROTO_IPV6, IPV6_MULTICAST_ALL, (char *)&optval, sizeof(optval));
+#endif
+    return SOCKET_ERROR != rc;
+}
+
+static int setup_multicast_impl(char * bindAddr, unsigned int nTTL, char * p_multicast_addr, char * p_port, struct sockaddr const * p_source, struct mcast_connection * p_mcast_conn)
 {
 	int rc;
-    debug_outputln("%s %d : %s %s %s", __FILE__, __LINE__, bindAddr, p_multicast_addr, p_port);
+    debug_log_debug(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %s %s %s", __FILE__, __LINE__, bindAddr, p_multicast_addr, p_port);
 	p_mcast_conn->multiAddr_ 	= ResolveAddressWithFlags(p_multicast_addr, p_port, AF_UNSPEC, SOCK_DGRAM, IPPROTO_UDP, AI_PASSIVE);
 	if (NULL == p_mcast_conn->multiAddr_)
 	{
-		debug_outputln("%s %5.5d : %10.10d %8.8x", __FILE__, __LINE__, get_last_socket_error(), get_last_socket_error());
+		debug_log_error(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %10.10lu %8.8lx", __FILE__, __LINE__, get_last_socket_error(), get_last_socket_error());
 		goto cleanup;
 	}
     dump_addrinfo(p_mcast_conn->multiAddr_, __FILE__, __LINE__);
@@ -101,7 +123,7 @@ static int setup_multicast_impl(char * bindAddr, unsigned int nTTL, char * p_mul
 	p_mcast_conn->bindAddr_ 	= ResolveAddressWithFlags(bindAddr, p_port, p_mcast_conn->multiAddr_->ai_family, p_mcast_conn->multiAddr_->ai_socktype, p_mcast_conn->multiAddr_->ai_protocol, AI_PASSIVE);
 	if (NULL == p_mcast_conn->bindAddr_)
 	{
-		debug_outputln("%s %5.5d : %10.10d %8.8x", __FILE__, __LINE__, get_last_socket_error(), get_last_socket_error());
+		debug_log_error(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %10.10lu %8.8lx", __FILE__, __LINE__, get_last_socket_error(), get_last_socket_error());
 		goto cleanup;
 	}
     dump_addrinfo(p_mcast_conn->bindAddr_, __FILE__, __LINE__);
@@ -112,51 +134,127 @@ static int setup_multicast_impl(char * bindAddr, unsigned int nTTL, char * p_mul
 	p_mcast_conn->socket_ 		= socket(p_mcast_conn->multiAddr_->ai_family, p_mcast_conn->multiAddr_->ai_socktype, p_mcast_conn->multiAddr_->ai_protocol);
 	if (p_mcast_conn->socket_ == INVALID_SOCKET)
 	{
-		debug_outputln("%s %5.5d : %10.10d %8.8x", __FILE__, __LINE__, get_last_socket_error(), get_last_socket_error());
+		debug_log_error(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %10.10lu %8.8lx", __FILE__, __LINE__, get_last_socket_error(), get_last_socket_error());
 		goto cleanup;
 	}
     if (!set_reuse_addr(p_mcast_conn->socket_))
     {
-        debug_outputln("%s %5.5d : %10.10d %8.8x", __FILE__, __LINE__, get_last_socket_error(), get_last_socket_error());
+        debug_log_error(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %10.10lu %8.8lx", __FILE__, __LINE__, get_last_socket_error(), get_last_socket_error());
         goto cleanup;
     }
-	rc = bind(p_mcast_conn->socket_, p_mcast_conn->bindAddr_->ai_addr, (int) p_mcast_conn->bindAddr_->ai_addrlen);
+    if (!set_multicast_all_off(p_mcast_conn->socket_, p_mcast_conn->multiAddr_->ai_family))
+    {
+        /* Older kernels do not know the option, the socket still works. */
+        debug_log_warning(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %10.10lu %8.8lx", __FILE__, __LINE__, get_last_socket_error(), get_last_socket_error());
+    }
+	// Bind to the interface and join the multicast group. Unlike on WIN32, the join_mcast_group_set_ttl() 
+	// binds the socket by itself, so the socket must not be bound before.
+    rc = join_mcast_source_group_set_ttl(p_mcast_conn->socket_, p_mcast_conn->multiAddr_, p_mcast_conn->bindAddr_, p_source, nTTL);
 	if (rc == SOCKET_ERROR)
 	{
-		debug_outputln("%s %5.5d : %10.10d %8.8x", __FILE__, __LINE__, get_last_socket_error(), get_last_socket_error());
+		debug_log_error(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %10.10lu %8.8lx", __FILE__, __LINE__, get_last_socket_error(), get_last_socket_error());
 		goto cleanup;
 	}
     dump_locally_bound_socket(p_mcast_conn->socket_, __FILE__, __LINE__);
-	// Join the multicast group if specified
-    rc = join_mcast_group_set_ttl(p_mcast_conn->socket_, p_mcast_conn->multiAddr_, p_mcast_conn->bindAddr_, nTTL);
 	return 1;
 cleanup:
 	return 0;
 }
 
-static int setup_multicast_addr(char * bindAddr, uint8_t nTTL, struct sockaddr_in const * p_in_addr, struct mcast_connection * p_mcast_conn)
+static int setup_multicast_addr(char * bindAddr, uint8_t nTTL, struct sockaddr_storage const * p_addr, struct sockaddr const * p_source, struct mcast_connection * p_mcast_conn)
 {
-    char port[8];
+    char host[NI_MAXHOST];
+    char port[NI_MAXSERV];
     int result;
-    char * inet_addr;
-    inet_addr = inet_ntoa(p_in_addr->sin_addr); 
-#if defined WIN32
-    StringCchPrintf(port, 8, "%d", ntohs(p_in_addr->sin_port));
-#else
-    snprintf(port, 8, "%d", ntohs(p_in_addr->sin_port));
-#endif
-    result = setup_multicast_impl(bindAddr, nTTL, inet_addr, port, p_mcast_conn);
+    /* The numeric host keeps the IPv6 scope, so that resolving it back gives the same interface. */
+    result = getnameinfo((struct sockaddr const *)p_addr, mcast_settings_get_address_size(p_addr), host, sizeof(host), port, sizeof(port), NI_NUMERICHOST | NI_NUMERICSERV);
+    if (0 != result)
+    {
+        debug_log_error(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %d", __FILE__, __LINE__, result);
+        return 0;
+    }
+    result = setup_multicast_impl(bindAddr, nTTL, host, port, p_source, p_mcast_conn);
     return result;
 }
 
 int setup_multicast_indirect(struct mcast_settings const * p_settings, struct mcast_connection * p_conn)
 {
-    return setup_multicast_addr(p_settings->bindAddr_, p_settings->nTTL_, &p_settings->mcast_addr_, p_conn);
+    struct sockaddr_storage source;
+    struct sockaddr const * p_source = NULL;
+    if (mcast_settings_is_source_specific(p_settings))
+    {
+        CopyMemory(&source, &p_settings->source_addr_, sizeof(source));
+        if (AF_INET6 == source.ss_family)
+            ((struct sockaddr_in6 *)&source)->sin6_port = 0;
+        else
+            ((struct sockaddr_in *)&source)->sin_port = 0;
+        p_source = (struct sockaddr const *)&source;
+    }
+    return setup_multicast_addr(p_settings->bindAddr_, p_settings->nTTL_, &p_settings->mcast_addr_, p_source, p_conn);
+}
+
+int setup_multicast_sender(struct mcast_settings const * p_settings, struct mcast_connection * p_conn)
+{
+    char host[NI_MAXHOST];
+    char port[NI_MAXSERV];
+    int result;
+    ZeroMemory(p_conn, sizeof(struct mcast_connection));
+    p_conn->socket_ = INVALID_SOCKET;
+    result = getnameinfo((struct sockaddr const *)&p_settings->mcast_addr_, mcast_settings_get_address_size(&p_settings->mcast_addr_), host, sizeof(host), port, sizeof(port), NI_NUMERICHOST | NI_NUMERICSERV);
+    if (0 != result)
+    {
+        debug_log_error(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %d", __FILE__, __LINE__, result);
+        goto cleanup;
+    }
+    p_conn->multiAddr_ = ResolveAddressWithFlags(host, port, AF_UNSPEC, SOCK_DGRAM, IPPROTO_UDP, 0);
+    if (NULL == p_conn->multiAddr_)
+    {
+        debug_log_error(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %10.10lu %8.8lx", __FILE__, __LINE__, get_last_socket_error(), get_last_socket_error());
+        goto cleanup;
+    }
+    dump_addrinfo(p_conn->multiAddr_, __FILE__, __LINE__);
+    /* Port 0: the socket gets an ephemeral port, so it never shares the group port with a receiving socket. */
+    p_conn->bindAddr_ = ResolveAddressWithFlags(p_settings->bindAddr_, "0", p_conn->multiAddr_->ai_family, p_conn->multiAddr_->ai_socktype, p_conn->multiAddr_->ai_protocol, AI_PASSIVE);
+    if (NULL == p_conn->bindAddr_)
+    {
+        debug_log_error(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %10.10lu %8.8lx", __FILE__, __LINE__, get_last_socket_error(), get_last_socket_error());
+        goto cleanup;
+    }
+    p_conn->socket_ = socket(p_conn->multiAddr_->ai_family, p_conn->multiAddr_->ai_socktype, p_conn->multiAddr_->ai_protocol);
+    if (INVALID_SOCKET == p_conn->socket_)
+    {
+        debug_log_error(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %10.10lu %8.8lx", __FILE__, __LINE__, get_last_socket_error(), get_last_socket_error());
+        goto cleanup;
+    }
+    if (SOCKET_ERROR == bind(p_conn->socket_, p_conn->bindAddr_->ai_addr, p_conn->bindAddr_->ai_addrlen)
+        || (NULL != p_settings->bindAddr_ && SOCKET_ERROR == SetSendInterface(p_conn->socket_, p_conn->bindAddr_))
+        || SOCKET_ERROR == SetMulticastTtl(p_conn->socket_, p_conn->multiAddr_->ai_family, p_settings->nTTL_)
+        || SOCKET_ERROR == SetMulticastLoopBack(p_conn->socket_, p_conn->multiAddr_->ai_family, 0))
+    {
+        debug_log_error(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %10.10lu %8.8lx", __FILE__, __LINE__, get_last_socket_error(), get_last_socket_error());
+        goto cleanup;
+    }
+    dump_locally_bound_socket(p_conn->socket_, __FILE__, __LINE__);
+    return 1;
+cleanup:
+    if (INVALID_SOCKET != p_conn->socket_)
+        closesocket(p_conn->socket_);
+    if (NULL != p_conn->bindAddr_)
+        freeaddrinfo(p_conn->bindAddr_);
+    if (NULL != p_conn->multiAddr_)
+        freeaddrinfo(p_conn->multiAddr_);
+    ZeroMemory(p_conn, sizeof(struct mcast_connection));
+    p_conn->socket_ = INVALID_SOCKET;
+    return 0;
 }
 
 size_t mcast_sendto_flags(struct mcast_connection * p_conn, void const * p_data, size_t data_size, int flags)
 {
-    return sendto(p_conn->socket_, (const void *)p_data, data_size, flags, p_conn->multiAddr_->ai_addr, (int) p_conn->multiAddr_->ai_addrlen);
+    size_t result;
+    TRACE_BEGIN("mcast_sendto");
+    result = sendto(p_conn->socket_, (const void *)p_data, data_size, flags, p_conn->multiAddr_->ai_addr, (int) p_conn->multiAddr_->ai_addrlen);
+    TRACE_END("mcast_sendto");
+    return result;
 }
 
 size_t mcast_sendto(struct mcast_connection * p_conn, void const * p_data, size_t data_size)
@@ -185,10 +283,10 @@ int mcast_is_new_data(struct mcast_connection * p_conn, size_t dwTimeoutMs)
         timeout.tv_usec = (dwTimeoutMs - 1000*(dwTimeoutMs/1000))*1000;
         p_timeout = &timeout; 
     }
-    result = select(0 /* This parameter is ignored in WINSOCK */, &read_sel, NULL, NULL, p_timeout);
+    result = select(p_conn->socket_ + 1, &read_sel, NULL, NULL, p_timeout);
     if (SOCKET_ERROR == result)
     {
-        debug_outputln("%s %u : %u", __FILE__, __LINE__, get_last_socket_error());
+        debug_log_error(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %lu", __FILE__, __LINE__, get_last_socket_error());
     }
     return result;
 }
@@ -198,6 +296,13 @@ size_t mcast_recvfrom(struct mcast_connection * p_conn, void * p_data, size_t da
     return mcast_recvfrom_flags(p_conn, p_data, data_size, 0);
 }
 
+size_t mcast_recvfrom_source(struct mcast_connection * p_conn, void * p_data, size_t data_size, struct sockaddr_storage * p_from)
+{
+    socklen_t from_length = sizeof(struct sockaddr_storage);
+    ZeroMemory(p_from, sizeof(struct sockaddr_storage));
+    return recvfrom(p_conn->socket_, p_data, data_size, 0, (struct sockaddr *)p_from, &from_length);
+}
+
 int close_multicast(struct mcast_connection * p_mcast_conn)
 {
     if (NULL != p_mcast_conn)
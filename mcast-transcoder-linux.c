@@ -0,0 +1,194 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file mcast-transcoder-linux.c
+ * @brief Transcoding multicast relay for Linux.
+ * @details Transcodes the input group to the output groups given on the command line until interrupted.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include <getopt.h>
+#include "mcast-transcoder.h"
+#include "debug_helpers.h"
+#include "trace-recorder.h"
+
+/*!
+ * @brief How often the counters are printed, in seconds.
+ */
+#define STATS_INTERVAL_SEC (10)
+
+volatile sig_atomic_t g_stop_processing;
+
+static void sigint_handle(int signal)
+{
+    g_stop_processing = 1;
+}
+
+volatile sig_atomic_t g_dump_trace;
+
+static void sigusr1_handle(int signal)
+{
+    g_dump_trace = 1;
+}
+
+static void usage(char const * psz_name)
+{
+    fprintf(stderr, "Usage: %s -i group:port[:source] [-r rate] [-c channels] [-t threads] -o group:port:rate:codec[:ttl] [-o ...]\n"
+            "  -i  group and port of the input PCM stream, and optionally the only sender to accept\n"
+            "      IPv6 addresses go in square brackets, e.g. [ff02::1%%eth0]:25000\n"
+            "  -r  sampling rate of the input, default 44100\n"
+            "  -c  number of channels of the input, default 2\n"
+            "  -t  number of worker threads, default 0 (no workers)\n"
+            "  -o  output group, port, rate and codec (pcm, ulaw, alaw or adpcm)\n", psz_name);
+}
+
+static int parse_input(struct mcast_settings * p_settings, char const * psz_text)
+{
+    char group[MCAST_SETTINGS_ADDRESS_LENGTH];
+    char source[MCAST_SETTINGS_ADDRESS_LENGTH];
+    unsigned int port;
+    int consumed = 0;
+    ZeroMemory(p_settings, sizeof(struct mcast_settings));
+    psz_text = mcast_settings_scan_host(psz_text, group, sizeof(group));
+    if (NULL == psz_text || 1 != sscanf(psz_text, ":%u%n", &port, &consumed) || port > 0xffff)
+        return 0;
+    p_settings->nTTL_ = 1;
+    if (!mcast_settings_set_group(p_settings, group, (unsigned short)port))
+        return 0;
+    psz_text += consumed;
+    if (':' == *psz_text)
+    {
+        psz_text = mcast_settings_scan_host(psz_text + 1, source, sizeof(source));
+        if (NULL == psz_text || '\0' != *psz_text || !mcast_settings_set_source(p_settings, source))
+            return 0;
+    }
+    else if ('\0' != *psz_text)
+        return 0;
+    return mcast_settings_validate(p_settings);
+}
+
+static void dump_stats(FILE * fp, struct mcast_transcoder const * p_transcoder)
+{
+    struct mcast_transcoder_stats stats;
+    mcast_transcoder_get_stats(p_transcoder, &stats);
+    fprintf(fp, "%4.4u %s : rcv:%llu rej:%llu snt:%llu\n", __LINE__, __FILE__,
+            (unsigned long long)stats.received_,
+            (unsigned long long)stats.rejected_,
+            (unsigned long long)stats.sent_);
+}
+
+int main(int argc, char ** argv)
+{
+    struct mcast_transcoder_config config;
+    struct mcast_transcoder * p_transcoder;
+    int has_input = 0;
+    int option;
+    time_t last_dump;
+    char const * psz_trace = trace_recorder_enable_from_env();
+    ZeroMemory(&config, sizeof(config));
+    config.input_rate_ = 44100;
+    config.input_channels_ = 2;
+    while (-1 != (option = getopt(argc, argv, "i:r:c:t:o:h")))
+    {
+        switch (option)
+        {
+            case 'i':
+                has_input = parse_input(&config.input_, optarg);
+                if (!has_input)
+                {
+                    fprintf(stderr, "%4.4u %s : bad input '%s'\n", __LINE__, __FILE__, optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'r':
+                config.input_rate_ = (unsigned int)strtoul(optarg, NULL, 10);
+                break;
+            case 'c':
+                config.input_channels_ = (unsigned int)strtoul(optarg, NULL, 10);
+                break;
+            case 't':
+                config.threads_count_ = (unsigned int)strtoul(optarg, NULL, 10);
+                break;
+            case 'o':
+                if (config.outputs_count_ >= MCAST_TRANSCODER_MAX_OUTPUTS
+                        || !mcast_transcoder_parse_output(&config.outputs_[config.outputs_count_], optarg))
+                {
+                    fprintf(stderr, "%4.4u %s : bad output '%s'\n", __LINE__, __FILE__, optarg);
+                    return EXIT_FAILURE;
+                }
+                ++config.outputs_count_;
+                break;
+            default:
+                usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (!has_input || 0 == config.outputs_count_)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    p_transcoder = mcast_transcoder_create(&config);
+    if (NULL == p_transcoder)
+    {
+        fprintf(stderr, "%4.4u %s : cannot set up the transcoder\n", __LINE__, __FILE__);
+        return EXIT_FAILURE;
+    }
+    {
+        struct sigaction query_action;
+        memset(&query_action, 0, sizeof(query_action));
+        query_action.sa_handler = &sigint_handle;
+        if (sigaction (SIGINT, &query_action, NULL) < 0)
+            exit(EXIT_FAILURE);
+        query_action.sa_handler = &sigusr1_handle;
+        if (sigaction (SIGUSR1, &query_action, NULL) < 0)
+            exit(EXIT_FAILURE);
+    }
+    debug_output_async_start();
+    last_dump = time(NULL);
+    while (!g_stop_processing)
+    {
+        if (mcast_transcoder_run_once(p_transcoder, 1000) < 0)
+        {
+            fprintf(stderr, "%4.4u %s : %d %s\n", __LINE__, __FILE__, errno, strerror(errno));
+            break;
+        }
+        if (g_dump_trace)
+        {
+            g_dump_trace = 0;
+            if (NULL != psz_trace)
+                trace_recorder_dump(psz_trace);
+        }
+        if (time(NULL) - last_dump >= STATS_INTERVAL_SEC)
+        {
+            dump_stats(stderr, p_transcoder);
+            last_dump = time(NULL);
+        }
+    }
+    dump_stats(stderr, p_transcoder);
+    mcast_transcoder_destroy(p_transcoder);
+    if (NULL != psz_trace)
+        trace_recorder_dump(psz_trace);
+    debug_output_async_stop();
+    return 0;
+}
@@ -0,0 +1,394 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file mcast-transcoder.c
+ * @brief Transcoding multicast relay.
+ * @details Receives a high rate PCM stream and re-publishes lower rate, codec compressed variants of it on separate groups.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include <poll.h>
+#include "mcast-transcoder.h"
+#include "mcast_setup.h"
+#include "mcast-packet.h"
+#include "latency-probe.h"
+#include "audio-codec.h"
+#include "resampler.h"
+#include "thread-pool.h"
+#include "debug_helpers.h"
+#include "trace-recorder.h"
+
+/*!
+ * @brief Maximum size of the received datagram.
+ */
+#define TRANSCODER_MAX_DATAGRAM (8192)
+
+/*!
+ * @brief Maximum number of samples, all channels together, decoded from a single datagram.
+ */
+#define TRANSCODER_MAX_SAMPLES (TRANSCODER_MAX_DATAGRAM)
+
+/*!
+ * @brief One resampled variant of the input, shared by all the outputs with the same rate.
+ */
+struct transcoder_rate {
+    struct mcast_transcoder * p_transcoder_; /*!< Owner, for the worker tasks. */
+    unsigned int rate_; /*!< Sampling rate, in Hz. */
+    struct resampler * p_resampler_; /*!< NULL if the rate is that of the input. */
+    float * buffer_; /*!< Resampled samples. */
+    size_t buffer_size_; /*!< Capacity of buffer_, in samples. */
+    float const * samples_; /*!< Result of the last pass, either buffer_ or the downmixed input. */
+    size_t count_; /*!< Number of samples in samples_. */
+};
+
+/*!
+ * @brief Runtime state of an output.
+ */
+struct transcoder_output {
+    struct mcast_transcoder * p_transcoder_; /*!< Owner, for the worker tasks. */
+    struct transcoder_rate * p_rate_; /*!< Where the samples come from. */
+    unsigned int codec_; /*!< One of the AUDIO_CODEC_* values. */
+    struct audio_codec_state codec_state_; /*!< Encoder state. */
+    struct mcast_connection conn_; /*!< Connection to the output group. */
+    int connected_; /*!< Non-zero if conn_ has been set up. */
+    uint16_t seq_; /*!< Sequence number of the next datagram. */
+    uint32_t timestamp_; /*!< Timestamp of the next datagram, at the output rate. */
+    uint64_t sent_; /*!< Number of datagrams sent. */
+    int16_t * pcm_; /*!< Scratch buffer for the samples to be encoded. */
+    uint8_t * packet_; /*!< Scratch buffer for the datagram. */
+    size_t packet_size_; /*!< Capacity of packet_. */
+};
+
+/*!
+ * @brief The transcoder.
+ */
+struct mcast_transcoder {
+    unsigned int input_rate_; /*!< Sampling rate of the input. */
+    unsigned int input_channels_; /*!< Number of channels of the input. */
+    struct mcast_connection conn_; /*!< Connection to the input group. */
+    int connected_; /*!< Non-zero if conn_ has been set up. */
+    struct thread_pool * p_pool_; /*!< Workers. */
+    uint32_t ssrc_; /*!< Source identifier of the datagram being transcoded. */
+    uint64_t send_time_; /*!< Send time of the datagram being transcoded, or when it was received if it carries none. */
+    struct mcast_transcoder_stats stats_; /*!< Counters, the sent_ one is summed from the outputs on demand. */
+    unsigned int rates_count_; /*!< Number of distinct output rates. */
+    struct transcoder_rate rates_[MCAST_TRANSCODER_MAX_OUTPUTS]; /*!< Distinct output rates. */
+    unsigned int outputs_count_; /*!< Number of outputs. */
+    struct transcoder_output outputs_[MCAST_TRANSCODER_MAX_OUTPUTS]; /*!< Outputs. */
+    int16_t decoded_[TRANSCODER_MAX_SAMPLES]; /*!< Decoded input, all channels. */
+    float mono_[TRANSCODER_MAX_SAMPLES]; /*!< Decoded input, downmixed to mono. */
+    size_t mono_count_; /*!< Number of samples in mono_. */
+    uint8_t datagram_[TRANSCODER_MAX_DATAGRAM]; /*!< Receive buffer. */
+};
+
+int mcast_transcoder_parse_output(struct mcast_transcoder_output * p_output, char const * psz_text)
+{
+    char group[MCAST_SETTINGS_ADDRESS_LENGTH];
+    char codec[16];
+    unsigned int port;
+    int ttl = 1;
+    int fields;
+    ZeroMemory(p_output, sizeof(struct mcast_transcoder_output));
+    psz_text = mcast_settings_scan_host(psz_text, group, sizeof(group));
+    if (NULL == psz_text)
+        return 0;
+    fields = sscanf(psz_text, ":%u:%u:%15[^:]:%d", &port, &p_output->rate_, codec, &ttl);
+    if (fields < 3 || port > 0xffff || 0 == p_output->rate_)
+        return 0;
+    if (!audio_codec_from_name(codec, &p_output->codec_))
+        return 0;
+    p_output->settings_.bindAddr_ = NULL;
+    p_output->settings_.nTTL_ = ttl;
+    if (!mcast_settings_set_group(&p_output->settings_, group, (unsigned short)port))
+        return 0;
+    return mcast_settings_validate(&p_output->settings_);
+}
+
+static struct transcoder_rate * find_or_add_rate(struct mcast_transcoder * p_transcoder, unsigned int rate)
+{
+    unsigned int idx;
+    struct transcoder_rate * p_rate;
+    for (idx = 0; idx < p_transcoder->rates_count_; ++idx)
+        if (p_transcoder->rates_[idx].rate_ == rate)
+            return &p_transcoder->rates_[idx];
+    p_rate = &p_transcoder->rates_[p_transcoder->rates_count_];
+    p_rate->p_transcoder_ = p_transcoder;
+    p_rate->rate_ = rate;
+    if (rate != p_transcoder->input_rate_)
+    {
+        p_rate->p_resampler_ = resampler_create(p_transcoder->input_rate_, rate);
+        if (NULL == p_rate->p_resampler_)
+            return NULL;
+        p_rate->buffer_size_ = resampler_get_output_size(p_rate->p_resampler_, TRANSCODER_MAX_SAMPLES);
+        p_rate->buffer_ = (float *)malloc(p_rate->buffer_size_ * sizeof(float));
+        if (NULL == p_rate->buffer_)
+            return NULL;
+    }
+    ++p_transcoder->rates_count_;
+    return p_rate;
+}
+
+/*!
+ * @brief Tells if both addresses name the same group and port.
+ */
+static int is_same_group(struct sockaddr_storage const * p_left, struct sockaddr_storage const * p_right)
+{
+    if (p_left->ss_family != p_right->ss_family)
+        return 0;
+    if (AF_INET6 == p_left->ss_family)
+    {
+        struct sockaddr_in6 const * p_left6 = (struct sockaddr_in6 const *)p_left;
+        struct sockaddr_in6 const * p_right6 = (struct sockaddr_in6 const *)p_right;
+        return p_left6->sin6_port == p_right6->sin6_port && 0 == memcmp(&p_left6->sin6_addr, &p_right6->sin6_addr, sizeof(struct in6_addr));
+    }
+    return ((struct sockaddr_in const *)p_left)->sin_port == ((struct sockaddr_in const *)p_right)->sin_port
+        && ((struct sockaddr_in const *)p_left)->sin_addr.s_addr == ((struct sockaddr_in const *)p_right)->sin_addr.s_addr;
+}
+
+struct mcast_transcoder * mcast_transcoder_create(struct mcast_transcoder_config const * p_config)
+{
+    struct mcast_transcoder * p_transcoder;
+    unsigned int idx;
+    if (0 == p_config->input_rate_ || 0 == p_config->input_channels_ || p_config->input_channels_ > MCAST_TRANSCODER_MAX_CHANNELS
+            || 0 == p_config->outputs_count_ || p_config->outputs_count_ > MCAST_TRANSCODER_MAX_OUTPUTS)
+        return NULL;
+    for (idx = 0; idx < p_config->outputs_count_; ++idx)
+    {
+        /* The transcoder would decode its own output again. */
+        if (is_same_group(&p_config->outputs_[idx].settings_.mcast_addr_, &p_config->input_.mcast_addr_))
+        {
+            debug_outputln("%s %4.4u : output %u is the input group", __FILE__, __LINE__, idx);
+            return NULL;
+        }
+    }
+    p_transcoder = (struct mcast_transcoder *)calloc(1, sizeof(struct mcast_transcoder));
+    if (NULL == p_transcoder)
+        return NULL;
+    p_transcoder->input_rate_ = p_config->input_rate_;
+    p_transcoder->input_channels_ = p_config->input_channels_;
+    for (idx = 0; idx < p_config->outputs_count_; ++idx)
+    {
+        struct mcast_transcoder_output const * p_entry = &p_config->outputs_[idx];
+        struct transcoder_output * p_output = &p_transcoder->outputs_[idx];
+        size_t samples_count;
+        ++p_transcoder->outputs_count_;
+        p_output->p_transcoder_ = p_transcoder;
+        p_output->codec_ = p_entry->codec_;
+        p_output->p_rate_ = find_or_add_rate(p_transcoder, p_entry->rate_);
+        if (NULL == p_output->p_rate_)
+        {
+            debug_outputln("%s %4.4u : cannot resample %u -> %u", __FILE__, __LINE__, p_config->input_rate_, p_entry->rate_);
+            goto cleanup;
+        }
+        samples_count = (NULL != p_output->p_rate_->p_resampler_) ? p_output->p_rate_->buffer_size_ : TRANSCODER_MAX_SAMPLES;
+        p_output->pcm_ = (int16_t *)malloc(samples_count * sizeof(int16_t));
+        p_output->packet_size_ = MCAST_PACKET_HEADER_SIZE + 4 * (MCAST_PACKET_SEND_TIME_WORDS + MCAST_PACKET_FORMAT_WORDS)
+            + audio_codec_get_encoded_size(p_entry->codec_, samples_count);
+        p_output->packet_ = (uint8_t *)malloc(p_output->packet_size_);
+        if (NULL == p_output->pcm_ || NULL == p_output->packet_)
+            goto cleanup;
+        if (!setup_multicast_sender(&p_entry->settings_, &p_output->conn_))
+        {
+            debug_outputln("%s %4.4u : cannot set up output %u", __FILE__, __LINE__, idx);
+            goto cleanup;
+        }
+        p_output->connected_ = 1;
+    }
+    if (!setup_multicast_indirect(&p_config->input_, &p_transcoder->conn_))
+    {
+        debug_outputln("%s %4.4u : cannot join the input group", __FILE__, __LINE__);
+        goto cleanup;
+    }
+    p_transcoder->connected_ = 1;
+    p_transcoder->p_pool_ = thread_pool_create(p_config->threads_count_);
+    if (NULL == p_transcoder->p_pool_)
+        goto cleanup;
+    return p_transcoder;
+cleanup:
+    mcast_transcoder_destroy(p_transcoder);
+    return NULL;
+}
+
+void mcast_transcoder_destroy(struct mcast_transcoder * p_transcoder)
+{
+    unsigned int idx;
+    if (NULL == p_transcoder)
+        return;
+    thread_pool_destroy(p_transcoder->p_pool_);
+    if (p_transcoder->connected_)
+        close_multicast(&p_transcoder->conn_);
+    for (idx = 0; idx < p_transcoder->outputs_count_; ++idx)
+    {
+        struct transcoder_output * p_output = &p_transcoder->outputs_[idx];
+        if (p_output->connected_)
+            close_multicast(&p_output->conn_);
+        free(p_output->packet_);
+        free(p_output->pcm_);
+    }
+    for (idx = 0; idx < p_transcoder->rates_count_; ++idx)
+    {
+        resampler_destroy(p_transcoder->rates_[idx].p_resampler_);
+        free(p_transcoder->rates_[idx].buffer_);
+    }
+    free(p_transcoder);
+}
+
+/*!
+ * @brief Worker task: resamples the downmixed input to one of the output rates.
+ */
+static void resample_task(void * p_argument)
+{
+    struct transcoder_rate * p_rate = (struct transcoder_rate *)p_argument;
+    struct mcast_transcoder * p_transcoder = p_rate->p_transcoder_;
+    if (NULL == p_rate->p_resampler_)
+    {
+        p_rate->samples_ = p_transcoder->mono_;
+        p_rate->count_ = p_transcoder->mono_count_;
+    }
+    else
+    {
+        p_rate->samples_ = p_rate->buffer_;
+        p_rate->count_ = resampler_process(p_rate->p_resampler_, p_transcoder->mono_, p_transcoder->mono_count_, p_rate->buffer_, p_rate->buffer_size_);
+    }
+}
+
+/*!
+ * @brief Worker task: encodes the resampled samples and sends them to one of the outputs.
+ */
+static void encode_task(void * p_argument)
+{
+    struct transcoder_output * p_output = (struct transcoder_output *)p_argument;
+    struct transcoder_rate const * p_rate = p_output->p_rate_;
+    struct mcast_packet_header header;
+    size_t payload_offset;
+    size_t payload_size;
+    if (0 == p_rate->count_)
+        return;
+    audio_codec_float_to_int16(p_rate->samples_, p_output->pcm_, p_rate->count_);
+    ZeroMemory(&header, sizeof(header));
+    header.version_ = MCAST_PACKET_VERSION;
+    header.flags_ = (uint8_t)(p_output->codec_ & MCAST_PACKET_FLAGS_CODEC_MASK);
+    header.seq_ = p_output->seq_;
+    header.timestamp_ = p_output->timestamp_;
+    header.ssrc_ = p_output->p_transcoder_->ssrc_;
+    /* The receivers play out the rate the packets carry, the output rate is not that of the input. */
+    payload_offset = mcast_packet_header_encode_stream(&header, p_output->p_transcoder_->send_time_, p_rate->rate_, 1,
+            p_output->packet_, p_output->packet_size_);
+    payload_size = audio_codec_encode(p_output->codec_, &p_output->codec_state_, p_output->pcm_, p_rate->count_,
+            p_output->packet_ + payload_offset, p_output->packet_size_ - payload_offset);
+    if (0 == payload_size)
+        return;
+    ++p_output->seq_;
+    p_output->timestamp_ += (uint32_t)p_rate->count_;
+    if (payload_offset + payload_size == mcast_sendto(&p_output->conn_, p_output->packet_, payload_offset + payload_size))
+        ++p_output->sent_;
+}
+
+static int decode_input(struct mcast_transcoder * p_transcoder, uint8_t const * p_datagram, size_t datagram_size)
+{
+    struct mcast_packet_header header;
+    size_t offset;
+    size_t samples_count;
+    size_t frames_count;
+    size_t idx;
+    unsigned int channel;
+    unsigned int codec = AUDIO_CODEC_PCM16;
+    float const scale = 1.0f / (32768.0f * p_transcoder->input_channels_);
+    offset = mcast_packet_header_decode(&header, p_datagram, datagram_size);
+    /* The outputs keep the send time of the input, so that the receivers measure the latency end to end. */
+    if (0 == offset || !mcast_packet_header_get_send_time(&header, p_datagram, &p_transcoder->send_time_))
+        p_transcoder->send_time_ = latency_probe_get_time();
+    if (0 != offset)
+    {
+        codec = header.flags_ & MCAST_PACKET_FLAGS_CODEC_MASK;
+        p_transcoder->ssrc_ = header.ssrc_;
+    }
+    samples_count = audio_codec_decode(codec, p_datagram + offset, datagram_size - offset, p_transcoder->decoded_, TRANSCODER_MAX_SAMPLES);
+    frames_count = samples_count / p_transcoder->input_channels_;
+    if (0 == frames_count)
+        return 0;
+    for (idx = 0; idx < frames_count; ++idx)
+    {
+        int32_t sum = 0;
+        int16_t const * p_frame = &p_transcoder->decoded_[idx * p_transcoder->input_channels_];
+        for (channel = 0; channel < p_transcoder->input_channels_; ++channel)
+            sum += p_frame[channel];
+        p_transcoder->mono_[idx] = (float)sum * scale;
+    }
+    p_transcoder->mono_count_ = frames_count;
+    return 1;
+}
+
+int mcast_transcoder_process(struct mcast_transcoder * p_transcoder, uint8_t const * p_datagram, size_t datagram_size)
+{
+    unsigned int idx;
+    if (!decode_input(p_transcoder, p_datagram, datagram_size))
+    {
+        ++p_transcoder->stats_.rejected_;
+        return 0;
+    }
+    /* Each rate is resampled once, no matter how many outputs use it. */
+    for (idx = 0; idx < p_transcoder->rates_count_; ++idx)
+        thread_pool_submit(p_transcoder->p_pool_, &resample_task, &p_transcoder->rates_[idx]);
+    thread_pool_wait(p_transcoder->p_pool_);
+    for (idx = 0; idx < p_transcoder->outputs_count_; ++idx)
+        thread_pool_submit(p_transcoder->p_pool_, &encode_task, &p_transcoder->outputs_[idx]);
+    thread_pool_wait(p_transcoder->p_pool_);
+    return 1;
+}
+
+int mcast_transcoder_run_once(struct mcast_transcoder * p_transcoder, int timeout_ms)
+{
+    struct pollfd poll_fd;
+    int total = 0;
+    int result;
+    poll_fd.fd = p_transcoder->conn_.socket_;
+    poll_fd.events = POLLIN;
+    poll_fd.revents = 0;
+    result = poll(&poll_fd, 1, timeout_ms);
+    if (result < 0)
+        return EINTR == errno ? 0 : -1;
+    if (0 == result)
+        return 0;
+    for (;;)
+    {
+        ssize_t received = recv(p_transcoder->conn_.socket_, p_transcoder->datagram_, sizeof(p_transcoder->datagram_), MSG_DONTWAIT);
+        if (received <= 0)
+            break;
+        ++p_transcoder->stats_.received_;
+        ++total;
+        TRACE_BEGIN("transcode");
+        mcast_transcoder_process(p_transcoder, p_transcoder->datagram_, (size_t)received);
+        TRACE_END("transcode");
+    }
+    return total;
+}
+
+void mcast_transcoder_get_stats(struct mcast_transcoder const * p_transcoder, struct mcast_transcoder_stats * p_stats)
+{
+    unsigned int idx;
+    *p_stats = p_transcoder->stats_;
+    p_stats->sent_ = 0;
+    for (idx = 0; idx < p_transcoder->outputs_count_; ++idx)
+        p_stats->sent_ += p_transcoder->outputs_[idx].sent_;
+}
@@ -0,0 +1,142 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+
+/**
+ * @file mcast-transcoder.h
+ * @brief Transcoding multicast relay.
+ * @details Receives a high rate PCM stream and re-publishes lower rate, codec compressed variants of it on separate groups.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+#if !defined MCAST_TRANSCODER_H_6D0E4B27_81A9_4F3C_9B56_E2C7A4190D8B
+#define MCAST_TRANSCODER_H_6D0E4B27_81A9_4F3C_9B56_E2C7A4190D8B
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+#include "std-int.h"
+#include <stddef.h>
+#include "mcast-settings.h"
+
+/*!
+ * @brief Maximum number of groups a single transcoder publishes to.
+ */
+#define MCAST_TRANSCODER_MAX_OUTPUTS (16)
+
+/*!
+ * @brief Maximum number of channels of the input stream.
+ */
+#define MCAST_TRANSCODER_MAX_CHANNELS (8)
+
+/*!
+ * @brief Describes a single transcoded variant of the input stream.
+ */
+struct mcast_transcoder_output {
+    struct mcast_settings settings_; /*!< Group, port and TTL of the output. */
+    unsigned int rate_; /*!< Sampling rate of the output, in Hz. The output is always mono. */
+    unsigned int codec_; /*!< One of the AUDIO_CODEC_* values. */
+};
+
+/*!
+ * @brief Transcoder configuration.
+ */
+struct mcast_transcoder_config {
+    struct mcast_settings input_; /*!< Group and port the input stream is received from. */
+    unsigned int input_rate_; /*!< Sampling rate of the input stream, in Hz. */
+    unsigned int input_channels_; /*!< Number of interleaved channels of the input stream. */
+    unsigned int threads_count_; /*!< Number of worker threads. 0 means that everything is done by the calling thread. */
+    unsigned int outputs_count_; /*!< Number of valid entries in the outputs_ array. */
+    struct mcast_transcoder_output outputs_[MCAST_TRANSCODER_MAX_OUTPUTS]; /*!< The outputs. */
+};
+
+/*!
+ * @brief Transcoder counters.
+ */
+struct mcast_transcoder_stats {
+    uint64_t received_; /*!< Number of datagrams received from the input group. */
+    uint64_t rejected_; /*!< Number of received datagrams that could not be decoded. */
+    uint64_t sent_; /*!< Number of datagrams sent, summed over all the outputs. */
+};
+
+/*!
+ * @brief Forward declaration.
+ */
+struct mcast_transcoder;
+
+/*!
+ * @brief Parses the output description.
+ * @details The description has the form group:port:rate:codec[:ttl], for example 239.1.0.1:25000:8000:ulaw or
+ * [ff12::1]:25000:8000:ulaw. IPv6 groups are enclosed in square brackets and may carry a scope, e.g. [ff02::1%eth0].
+ * The codec is one of the names accepted by audio_codec_from_name(). TTL defaults to 1.
+ * @param[out] p_output this structure will be written with the parsed description.
+ * @param[in] psz_text the description.
+ * @return returns non-zero on success, 0 if the description is malformed.
+ */
+int mcast_transcoder_parse_output(struct mcast_transcoder_output * p_output, char const * psz_text);
+
+/*!
+ * @brief Creates the transcoder.
+ * @details Joins the input group, sets up all the output connections, creates one resampler per distinct output rate
+ * and starts the worker threads. The outputs are send only, and none of them may use the input group and port.
+ * @param[in] p_config the configuration.
+ * @return returns a handle to the transcoder, or NULL if creation failed.
+ */
+struct mcast_transcoder * mcast_transcoder_create(struct mcast_transcoder_config const * p_config);
+
+/*!
+ * @brief Transcodes a single datagram of the input stream and sends it to all the outputs.
+ * @details The input is decoded and downmixed once. Then each distinct output rate is resampled as a separate task,
+ * and finally each output is encoded and sent as a separate task. The call returns when all the tasks are done.
+ * @param[in] p_transcoder a handle to the transcoder.
+ * @param[in] p_datagram the received datagram.
+ * @param[in] datagram_size number of bytes in the datagram.
+ * @return returns non-zero on success, 0 if the datagram could not be decoded.
+ */
+int mcast_transcoder_process(struct mcast_transcoder * p_transcoder, uint8_t const * p_datagram, size_t datagram_size);
+
+/*!
+ * @brief Performs one round of transcoding.
+ * @details Waits at most timeout_ms milliseconds for new data, then transcodes all pending datagrams.
+ * @param[in] p_transcoder a handle to the transcoder.
+ * @param[in] timeout_ms maximum time to wait for new data, in milliseconds.
+ * @return returns number of datagrams received, or -1 on error.
+ */
+int mcast_transcoder_run_once(struct mcast_transcoder * p_transcoder, int timeout_ms);
+
+/*!
+ * @brief Returns the counters.
+ * @param[in] p_transcoder a handle to the transcoder.
+ * @param[out] p_stats this structure will be written with the counters.
+ */
+void mcast_transcoder_get_stats(struct mcast_transcoder const * p_transcoder, struct mcast_transcoder_stats * p_stats);
+
+/*!
+ * @brief Stops the worker threads, leaves all the groups and destroys the transcoder.
+ * @param[in] p_transcoder a handle to the transcoder obtained via call to mcast_transcoder_create.
+ */
+void mcast_transcoder_destroy(struct mcast_transcoder * p_transcoder);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* MCAST_TRANSCODER_H_6D0E4B27_81A9_4F3C_9B56_E2C7A4190D8B */
@@ -41,12 +41,13 @@
 #include "mcast_utils.h"
 #include "resolve.h"
 #include "debug_helpers.h"
+#include "trace-recorder.h"
 
 static void dump_addrinfo(struct addrinfo const * p_info, const char * file, unsigned int line)
 {
     char host[NI_MAXHOST] = { 0 };
     FormatAddress(p_info->ai_addr, p_info->ai_addrlen, host, NI_MAXHOST);
-    debug_outputln("%s %4.4u : flg:%d fam:%d sot:%d pro:%d can:%s hst:'%15s' nxt:%p", file, line,
+    debug_log_debug(DEBUG_CATEGORY_NETWORK, "%s %4.4u : flg:%d fam:%d sot:%d pro:%d can:%s hst:'%15s' nxt:%p", file, line,
         p_info->ai_flags,
         p_info->ai_family,
         p_info->ai_socktype,
@@ -71,27 +72,29 @@ static int set_reuse_addr(SOCKET s)
 static void dump_locally_bound_socket(SOCKET s, const char * file, unsigned int line)
 {
     int rc;
-    struct sockaddr_in local_bind = { 0 };
+    struct sockaddr_storage local_bind = { 0 };
     socklen_t local_data_len = sizeof(local_bind);
     rc = getsockname(s, (struct sockaddr*)&local_bind, &local_data_len);
     if (SOCKET_ERROR != rc)
     {
-        debug_outputln("%s %4.4u : %s:%u", file, line, inet_ntoa(local_bind.sin_addr), ntohs(local_bind.sin_port));
+        char host[NI_MAXHOST] = { 0 };
+        FormatAddress((struct sockaddr*)&local_bind, local_data_len, host, NI_MAXHOST);
+        debug_log_debug(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %s", file, line, host);
     }
     else
     {
-        debug_outputln("%s %4.4u : %u", file, line, rc);
+        debug_log_error(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %d", file, line, rc);
     }
 }
 
-static int setup_multicast_impl(char * bindAddr, unsigned int nTTL, char * p_multicast_addr, char * p_port, struct mcast_connection * p_mcast_conn)
+static int setup_multicast_impl(char * bindAddr, unsigned int nTTL, char * p_multicast_addr, char * p_port, struct sockaddr const * p_source, struct mcast_connection * p_mcast_conn)
 {
 	int rc;
-    debug_outputln("%s %4.4u : %s %s %s %3.3u", __FILE__, __LINE__, bindAddr, p_multicast_addr, p_port, nTTL);
+    debug_log_debug(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %s %s %s %3.3u", __FILE__, __LINE__, bindAddr, p_multicast_addr, p_port, nTTL);
 	p_mcast_conn->multiAddr_ 	= ResolveAddressWithFlags(p_multicast_addr, p_port, AF_UNSPEC, SOCK_DGRAM, IPPROTO_UDP, AI_PASSIVE);
 	if (NULL == p_mcast_conn->multiAddr_)
 	{
-		debug_outputln("%s %4.4u : %10.10d %8.8x", __FILE__, __LINE__, WSAGetLastError(), WSAGetLastError());
+		debug_log_error(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %10.10d %8.8x", __FILE__, __LINE__, WSAGetLastError(), WSAGetLastError());
 		goto cleanup;
 	}
     dump_addrinfo(p_mcast_conn->multiAddr_, __FILE__, __LINE__);
@@ -99,7 +102,7 @@ static int setup_multicast_impl(char * bindAddr, unsigned int nTTL, char * p_mul
 	p_mcast_conn->bindAddr_ 	= ResolveAddressWithFlags(bindAddr, p_port, p_mcast_conn->multiAddr_->ai_family, p_mcast_conn->multiAddr_->ai_socktype, p_mcast_conn->multiAddr_->ai_protocol, AI_PASSIVE);
 	if (NULL == p_mcast_conn->bindAddr_)
 	{
-		debug_outputln("%s %4.4u : %10.10d %8.8x", __FILE__, __LINE__, WSAGetLastError(), WSAGetLastError());
+		debug_log_error(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %10.10d %8.8x", __FILE__, __LINE__, WSAGetLastError(), WSAGetLastError());
 		goto cleanup;
 	}
     dump_addrinfo(p_mcast_conn->bindAddr_, __FILE__, __LINE__);
@@ -110,19 +113,19 @@ static int setup_multicast_impl(char * bindAddr, unsigned int nTTL, char * p_mul
 	p_mcast_conn->socket_ 		= socket(p_mcast_conn->multiAddr_->ai_family, p_mcast_conn->multiAddr_->ai_socktype, p_mcast_conn->multiAddr_->ai_protocol);
 	if (p_mcast_conn->socket_ == INVALID_SOCKET)
 	{
-		debug_outputln("%s %4.4u : %10.10d %8.8x", __FILE__, __LINE__, WSAGetLastError(), WSAGetLastError());
+		debug_log_error(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %10.10d %8.8x", __FILE__, __LINE__, WSAGetLastError(), WSAGetLastError());
 		goto cleanup;
 	}
     if (!set_reuse_addr(p_mcast_conn->socket_))
     {
-        debug_outputln("%s %4.4u : %10.10d %8.8x", __FILE__, __LINE__, WSAGetLastError(), WSAGetLastError());
+        debug_log_error(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %10.10d %8.8x", __FILE__, __LINE__, WSAGetLastError(), WSAGetLastError());
         goto cleanup;
     }
 	// Join the multicast group if specified
-    rc = join_mcast_group_set_ttl(p_mcast_conn->socket_, p_mcast_conn->multiAddr_, p_mcast_conn->bindAddr_, nTTL);
+    rc = join_mcast_source_group_set_ttl(p_mcast_conn->socket_, p_mcast_conn->multiAddr_, p_mcast_conn->bindAddr_, p_source, nTTL);
 	if (rc == SOCKET_ERROR)
 	{
-		debug_outputln("%s %4.4u : %10.10d %8.8x", __FILE__, __LINE__, WSAGetLastError(), WSAGetLastError());
+		debug_log_error(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %10.10d %8.8x", __FILE__, __LINE__, WSAGetLastError(), WSAGetLastError());
 		goto cleanup;
 	}
     dump_locally_bound_socket(p_mcast_conn->socket_, __FILE__, __LINE__);
@@ -131,23 +134,45 @@ cleanup:
 	return 0;
 }
 
-static int setup_multicast_addr(char * bindAddr, uint8_t nTTL, struct sockaddr_in const * p_in_addr, struct mcast_connection * p_mcast_conn)
+static int setup_multicast_addr(char * bindAddr, uint8_t nTTL, struct sockaddr_storage const * p_addr, struct sockaddr const * p_source, struct mcast_connection * p_mcast_conn)
 {
-    char port[8];
+    char host[NI_MAXHOST];
+    char port[NI_MAXSERV];
     int result;
-    StringCchPrintf(port, 8, "%d", ntohs(p_in_addr->sin_port));
-    result = setup_multicast_impl(bindAddr, nTTL, inet_ntoa(p_in_addr->sin_addr), port, p_mcast_conn);
+    /* The numeric host keeps the IPv6 scope, so that resolving it back gives the same interface. */
+    result = getnameinfo((struct sockaddr const *)p_addr, mcast_settings_get_address_size(p_addr), host, sizeof(host), port, sizeof(port), NI_NUMERICHOST | NI_NUMERICSERV);
+    if (0 != result)
+    {
+        debug_log_error(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %d", __FILE__, __LINE__, result);
+        return 0;
+    }
+    result = setup_multicast_impl(bindAddr, nTTL, host, port, p_source, p_mcast_conn);
     return result;
 }
 
 int setup_multicast_indirect(struct mcast_settings const * p_settings, struct mcast_connection * p_conn)
 {
-    return setup_multicast_addr(p_settings->bindAddr_, p_settings->nTTL_, &p_settings->mcast_addr_, p_conn);
+    struct sockaddr_storage source;
+    struct sockaddr const * p_source = NULL;
+    if (mcast_settings_is_source_specific(p_settings))
+    {
+        CopyMemory(&source, &p_settings->source_addr_, sizeof(source));
+        if (AF_INET6 == source.ss_family)
+            ((struct sockaddr_in6 *)&source)->sin6_port = 0;
+        else
+            ((struct sockaddr_in *)&source)->sin_port = 0;
+        p_source = (struct sockaddr const *)&source;
+    }
+    return setup_multicast_addr(p_settings->bindAddr_, p_settings->nTTL_, &p_settings->mcast_addr_, p_source, p_conn);
 }
 
 size_t mcast_sendto_flags(struct mcast_connection * p_conn, void const * p_data, size_t data_size, int flags)
 {
-    return sendto(p_conn->socket_, (const void *)p_data, data_size, flags, p_conn->multiAddr_->ai_addr, (int) p_conn->multiAddr_->ai_addrlen);
+    size_t result;
+    TRACE_BEGIN("mcast_sendto");
+    result = sendto(p_conn->socket_, (const void *)p_data, data_size, flags, p_conn->multiAddr_->ai_addr, (int) p_conn->multiAddr_->ai_addrlen);
+    TRACE_END("mcast_sendto");
+    return result;
 }
 
 size_t mcast_sendto(struct mcast_connection * p_conn, void const * p_data, size_t data_size)
@@ -179,7 +204,7 @@ int mcast_is_new_data(struct mcast_connection * p_conn, size_t dwTimeoutMs)
     result = select(0 /* This parameter is ignored in WINSOCK */, &read_sel, NULL, NULL, p_timeout);
     if (SOCKET_ERROR == result)
     {
-        debug_outputln("%s %u : %u", __FILE__, __LINE__, WSAGetLastError());
+        debug_log_error(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %d", __FILE__, __LINE__, WSAGetLastError());
     }
     return result;
 }
@@ -189,6 +214,13 @@ size_t mcast_recvfrom(struct mcast_connection * p_conn, void * p_data, size_t da
     return mcast_recvfrom_flags(p_conn, p_data, data_size, 0);
 }
 
+size_t mcast_recvfrom_source(struct mcast_connection * p_conn, void * p_data, size_t data_size, struct sockaddr_storage * p_from)
+{
+    socklen_t from_length = sizeof(struct sockaddr_storage);
+    ZeroMemory(p_from, sizeof(struct sockaddr_storage));
+    return recvfrom(p_conn->socket_, p_data, data_size, 0, (struct sockaddr *)p_from, &from_length);
+}
+
 int close_multicast(struct mcast_connection * p_mcast_conn)
 {
     if (NULL != p_mcast_conn)
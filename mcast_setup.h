@@ -48,12 +48,27 @@ struct mcast_connection {
 
 /*!
  * @brief Setup the multicast connection with given parameters.
+ * @details If the settings name a source address, the group is joined source specific, so that the datagrams of all
+ * the other senders are dropped before they reach the socket.
  * @param[in] p_settings contains all the multicast connection related settings.
  * @param[out] p_conn this memory location will be written with active multicast connection upon successful exit.
  * @return returns non-zero on success, 0 otherwise.
  */
 int setup_multicast_indirect(struct mcast_settings const * p_settings, struct mcast_connection * p_conn);
 
+#if !defined WIN32
+/*!
+ * @brief Setup a send only connection to the multicast group.
+ * @details Unlike setup_multicast_indirect(), the group is not joined and the socket is bound to an ephemeral port,
+ * so that the socket never receives anything. The loopback of the sent datagrams is disabled, so that the sockets
+ * of this host that listen on the group do not see them either. Only implemented for Linux, by mcast-setup-linux.c.
+ * @param[in] p_settings contains all the multicast connection related settings, the source address is ignored.
+ * @param[out] p_conn this memory location will be written with active multicast connection upon successful exit.
+ * @return returns non-zero on success, 0 otherwise.
+ */
+int setup_multicast_sender(struct mcast_settings const * p_settings, struct mcast_connection * p_conn);
+#endif
+
 /*!
  * @brief Sends data over the socket.
  * @param[in] p_conn describes the connection.
@@ -92,6 +107,17 @@ size_t mcast_recvfrom(struct mcast_connection * p_conn, void * p_data, size_t da
  */
 size_t mcast_recvfrom_flags(struct mcast_connection * p_conn, void * p_data, size_t data_size, int flags);
 
+/*!
+ * @brief Receives a datagram, and tells who sent it.
+ * @details Unlike mcast_recvfrom, the address of the group kept in the connection is left intact.
+ * @param[in] p_conn describes the connection.
+ * @param[in] p_data pointer to the data to be received.
+ * @param[in] data_size number of bytes that p_data indicated buffer can accomodate.
+ * @param[out] p_from this will be written with the address of the sender.
+ * @return returns number of bytes received.
+ */
+size_t mcast_recvfrom_source(struct mcast_connection * p_conn, void * p_data, size_t data_size, struct sockaddr_storage * p_from);
+
 /*!
  * @brief Checks if there is some data to receive on the socket. 
  * @details This is some more friendly wrapper for the BSD select() call.
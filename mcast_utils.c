@@ -14,9 +14,17 @@
 #include "compiler_defs.h"
 
 int join_mcast_group_set_ttl(SOCKET s, struct addrinfo const * group, struct addrinfo const * iface, int ttl)
+{
+    return join_mcast_source_group_set_ttl(s, group, iface, NULL, ttl);
+}
+
+int join_mcast_source_group_set_ttl(SOCKET s, struct addrinfo const * group, struct addrinfo const * iface, struct sockaddr const * source, int ttl)
 {
     struct ip_mreq   mreqv4;
     struct ipv6_mreq mreqv6;
+    struct ip_mreq_source mreqsrcv4;
+    struct group_source_req gsreq;
+    unsigned int     if_index;
     char            *optval=NULL;
     int              optlevel = 0,
                      option = 0,
@@ -25,7 +33,7 @@ int join_mcast_group_set_ttl(SOCKET s, struct addrinfo const * group, struct add
     rc = bind(s, iface->ai_addr, iface->ai_addrlen);
     if (rc < 0)
     {
-        debug_outputln("%4.4u %10.10s : %d %8.8x\n", __LINE__, __FILE__, rc, get_last_socket_error());
+        debug_log_error(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %d %8.8lx", __FILE__, __LINE__, rc, get_last_socket_error());
         goto error;
     }
     switch (group->ai_family)
@@ -33,15 +41,34 @@ int join_mcast_group_set_ttl(SOCKET s, struct addrinfo const * group, struct add
         case AF_INET: /* IPv4 */
             /* Join Multicast group */
             optlevel = IPPROTO_IP;
-            option   = IP_ADD_MEMBERSHIP;
-            optval   = (char *)& mreqv4;
-            optlen   = sizeof(mreqv4);
-            mreqv4.imr_multiaddr.s_addr = ((LPSOCKADDR_IN )group->ai_addr)->sin_addr.s_addr;
-            mreqv4.imr_interface.s_addr = ((LPSOCKADDR_IN )iface->ai_addr)->sin_addr.s_addr;
-            rc = setsockopt(s, optlevel, option, (const char *)&mreqv4, optlen);
+            if (NULL != source)
+            {
+                /* Source specific join: the kernel drops datagrams from all the other senders. */
+                if (AF_INET != source->sa_family)
+                {
+                    rc = SOCKET_ERROR;
+                    goto error;
+                }
+                option   = IP_ADD_SOURCE_MEMBERSHIP;
+                optval   = (char *)& mreqsrcv4;
+                optlen   = sizeof(mreqsrcv4);
+                ZeroMemory(&mreqsrcv4, sizeof(mreqsrcv4));
+                mreqsrcv4.imr_multiaddr.s_addr = ((LPSOCKADDR_IN )group->ai_addr)->sin_addr.s_addr;
+                mreqsrcv4.imr_interface.s_addr = ((LPSOCKADDR_IN )iface->ai_addr)->sin_addr.s_addr;
+                mreqsrcv4.imr_sourceaddr.s_addr = ((LPSOCKADDR_IN )source)->sin_addr.s_addr;
+            }
+            else
+            {
+                option   = IP_ADD_MEMBERSHIP;
+                optval   = (char *)& mreqv4;
+                optlen   = sizeof(mreqv4);
+                mreqv4.imr_multiaddr.s_addr = ((LPSOCKADDR_IN )group->ai_addr)->sin_addr.s_addr;
+                mreqv4.imr_interface.s_addr = ((LPSOCKADDR_IN )iface->ai_addr)->sin_addr.s_addr;
+            }
+            rc = setsockopt(s, optlevel, option, optval, optlen);
             if (SOCKET_ERROR == rc)
             {
-                debug_outputln("%4.4u %10.10s : %8.8x", __LINE__, __FILE__, get_last_socket_error());
+                debug_log_error(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %8.8lx", __FILE__, __LINE__, get_last_socket_error());
                 goto error;
             }
             /* Set send interface */
@@ -51,7 +78,7 @@ int join_mcast_group_set_ttl(SOCKET s, struct addrinfo const * group, struct add
             rc = setsockopt(s, optlevel, option, optval, optlen);
             if (SOCKET_ERROR == rc)
             {
-                debug_outputln("%4.4u %10.10s : %8.8x", __LINE__, __FILE__, get_last_socket_error());
+                debug_log_error(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %8.8lx", __FILE__, __LINE__, get_last_socket_error());
                 goto error;
             }
             /* Set outgoing TTL */
@@ -66,26 +93,49 @@ int join_mcast_group_set_ttl(SOCKET s, struct addrinfo const * group, struct add
             break;
         case AF_INET6: /* IPv6 */
             optlevel = IPPROTO_IPV6;
-            // Setup the v6 option values and ipv6_mreq structure
-            option   = IPV6_ADD_MEMBERSHIP;
-            optval   = (char *) &mreqv6;
-            optlen   = sizeof(mreqv6);
-            mreqv6.ipv6mr_multiaddr = ((LPSOCKADDR_IN6 )group->ai_addr)->sin6_addr;
-            mreqv6.ipv6mr_interface = ((LPSOCKADDR_IN6 )iface->ai_addr)->sin6_scope_id;
-            rc = setsockopt(s, optlevel, option, (const char *)&mreqv6, optlen);
+            /* Link and interface local groups carry their own scope, e.g. ff02::1%eth0. */
+            if_index = ((LPSOCKADDR_IN6 )iface->ai_addr)->sin6_scope_id;
+            if (0 == if_index)
+                if_index = ((LPSOCKADDR_IN6 )group->ai_addr)->sin6_scope_id;
+            if (NULL != source)
+            {
+                // There is no IPv6 specific source join, the protocol independent one is used instead
+                if (AF_INET6 != source->sa_family)
+                {
+                    rc = SOCKET_ERROR;
+                    goto error;
+                }
+                option   = MCAST_JOIN_SOURCE_GROUP;
+                optval   = (char *) &gsreq;
+                optlen   = sizeof(gsreq);
+                ZeroMemory(&gsreq, sizeof(gsreq));
+                gsreq.gsr_interface = if_index;
+                CopyMemory(&gsreq.gsr_group, group->ai_addr, sizeof(struct sockaddr_in6));
+                CopyMemory(&gsreq.gsr_source, source, sizeof(struct sockaddr_in6));
+            }
+            else
+            {
+                // Setup the v6 option values and ipv6_mreq structure
+                option   = IPV6_ADD_MEMBERSHIP;
+                optval   = (char *) &mreqv6;
+                optlen   = sizeof(mreqv6);
+                mreqv6.ipv6mr_multiaddr = ((LPSOCKADDR_IN6 )group->ai_addr)->sin6_addr;
+                mreqv6.ipv6mr_interface = if_index;
+            }
+            rc = setsockopt(s, optlevel, option, optval, optlen);
             if (SOCKET_ERROR == rc)
             {
-                debug_outputln("%4.4u %10.10s : %8.8x", __LINE__, __FILE__, get_last_socket_error());
+                debug_log_error(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %8.8lx", __FILE__, __LINE__, get_last_socket_error());
                 goto error;
             }
             // Setup the v6 option values
             option   = IPV6_MULTICAST_IF;
-            optval   = (char *) &((LPSOCKADDR_IN6 )iface->ai_addr)->sin6_scope_id;
-            optlen   = sizeof(((LPSOCKADDR_IN6 )iface->ai_addr)->sin6_scope_id);
+            optval   = (char *) &if_index;
+            optlen   = sizeof(if_index);
             rc = setsockopt(s, optlevel, option, optval, optlen);
             if (SOCKET_ERROR == rc)
             {
-                debug_outputln("%4.4u %10.10s : %8.8x", __LINE__, __FILE__, get_last_socket_error());
+                debug_log_error(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %8.8lx", __FILE__, __LINE__, get_last_socket_error());
                 goto error;
             }
             // Set the options for V6
@@ -95,7 +145,7 @@ int join_mcast_group_set_ttl(SOCKET s, struct addrinfo const * group, struct add
             rc = setsockopt(s, optlevel, option, optval, optlen);
             if (SOCKET_ERROR == rc)
             {
-                debug_outputln("%4.4u %10.10s : %8.8x", __LINE__, __FILE__, get_last_socket_error());
+                debug_log_error(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %8.8lx", __FILE__, __LINE__, get_last_socket_error());
                 goto error;
             }
             break;
@@ -103,10 +153,10 @@ int join_mcast_group_set_ttl(SOCKET s, struct addrinfo const * group, struct add
             rc = SOCKET_ERROR;
             break;
     }
-    debug_outputln("%4.4u %s : %d\n", __LINE__, __FILE__, rc);
+    debug_log_debug(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %d", __FILE__, __LINE__, rc);
     return rc;
 error:
-    debug_outputln("%4.4u %10.10s : %8.8x", __LINE__, __FILE__, get_last_socket_error());
+    debug_log_error(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %8.8lx", __FILE__, __LINE__, get_last_socket_error());
     return rc;
 }
 
@@ -146,7 +196,7 @@ int JoinMulticastGroup(SOCKET s, struct addrinfo const *group, struct addrinfo c
     }
     else
     {
-        debug_outputln("%s %4.4u : %d\n", group->ai_family);
+        debug_log_error(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %d", __FILE__, __LINE__, group->ai_family);
         rc = SOCKET_ERROR;
     }
     if (rc != SOCKET_ERROR)
@@ -155,7 +205,7 @@ int JoinMulticastGroup(SOCKET s, struct addrinfo const *group, struct addrinfo c
         rc = setsockopt(s, optlevel, option, optval, optlen);
         if (rc == SOCKET_ERROR)
         {
-            debug_outputln("%s %4.4u : %d\n", get_last_socket_error());
+            debug_log_error(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %lu", __FILE__, __LINE__, get_last_socket_error());
         }
     }
     return rc;
@@ -188,7 +238,7 @@ int SetSendInterface(SOCKET s, struct addrinfo const *iface)
     }
     else
     {
-        debug_outputln("%s %4.4u : %d\n", iface->ai_family);
+        debug_log_error(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %d", __FILE__, __LINE__, iface->ai_family);
         rc = SOCKET_ERROR;
     }
 
@@ -199,7 +249,7 @@ int SetSendInterface(SOCKET s, struct addrinfo const *iface)
         rc = setsockopt(s, optlevel, option, optval, optlen);
         if (rc == SOCKET_ERROR)
         {
-            debug_outputln("%s %4.4u : %d\n", get_last_socket_error());
+            debug_log_error(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %lu", __FILE__, __LINE__, get_last_socket_error());
         }
     }
     return rc;
@@ -233,7 +283,7 @@ int SetMulticastTtl(SOCKET s, int af, uint8_t ub_ttl)
     }
     else
     {
-        debug_outputln("%s %4.4u : %d\n", af);
+        debug_log_error(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %d", __FILE__, __LINE__, af);
         rc = SOCKET_ERROR;
     }
     if (rc != SOCKET_ERROR)
@@ -242,7 +292,7 @@ int SetMulticastTtl(SOCKET s, int af, uint8_t ub_ttl)
         rc = setsockopt(s, optlevel, option, optval, optlen);
         if (rc == SOCKET_ERROR)
         {
-            debug_outputln("%s %4.4u : %d\n", get_last_socket_error());
+            debug_log_error(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %lu", __FILE__, __LINE__, get_last_socket_error());
         }
     }
     return rc;
@@ -275,7 +325,7 @@ int SetMulticastLoopBack(SOCKET s, int af, int loopval)
     }
     else
     {
-        debug_outputln("%s %4.4u : %d\n", af);
+        debug_log_error(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %d", __FILE__, __LINE__, af);
         rc = SOCKET_ERROR;
     }
     if (rc != SOCKET_ERROR)
@@ -284,7 +334,7 @@ int SetMulticastLoopBack(SOCKET s, int af, int loopval)
         rc = setsockopt(s, optlevel, option, optval, optlen);
         if (rc == SOCKET_ERROR)
         {
-            debug_outputln("%s %4.4u : %d\n", get_last_socket_error());
+            debug_log_error(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %lu", __FILE__, __LINE__, get_last_socket_error());
         }
     }
     return rc;
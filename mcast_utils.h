@@ -29,6 +29,19 @@ extern "C" {
  */
 int join_mcast_group_set_ttl(SOCKET s, struct addrinfo const * group, struct addrinfo const * iface, int ttl);
 
+/*!
+ * @brief Source specific multicast registration and Time-To-Live setup
+ * @details Works like join_mcast_group_set_ttl(), but only the datagrams sent by the given source are delivered.
+ * The join uses IP_ADD_SOURCE_MEMBERSHIP for IPv4 and MCAST_JOIN_SOURCE_GROUP for IPv6, so unwanted senders are
+ * filtered by the kernel (and by IGMPv3/MLDv2 capable routers), not by the application.
+ * @param[in] s socket for which the outgoing interface is to be set.
+ * @param[in] group - multicast group address.
+ * @param[in] iface - network interface address. This network interface wil be used for multicast group communication.
+ * @param[in] source - unicast address of the sender, of the same family as the group. NULL means any source.
+ * @param[in] ttl - TTL value to be set.
+ */
+int join_mcast_source_group_set_ttl(SOCKET s, struct addrinfo const * group, struct addrinfo const * iface, struct sockaddr const * source, int ttl);
+
 /*!
  * @details This function joins the multicast socket on the specified multicast 
  * group. The structures for IPv4 and IPv6 multicast joins are slightly
@@ -0,0 +1,334 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file net-impair.c
+ * @brief Seeded network impairment shim.
+ * @details Datagrams are held in a binary heap ordered by their due time; a single SplitMix64 generator drives all the random decisions.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include "net-impair.h"
+#include "mcast_setup.h"
+#include "debug_helpers.h"
+#include "perf-counter-itf.h"
+
+/*!
+ * @brief Default time a reordered datagram is held back, in nanoseconds.
+ */
+#define DEFAULT_REORDER_GAP (10000000ULL)
+
+/*!
+ * @brief A datagram held back.
+ */
+struct net_impair_slot {
+    uint64_t due_; /*!< When the datagram is to be released. */
+    uint64_t order_; /*!< Submission order, breaks the ties between equal due times. */
+    size_t size_; /*!< Number of bytes in data_. */
+    uint8_t data_[NET_IMPAIR_MAX_PACKET]; /*!< The datagram. */
+};
+
+/*!
+ * @brief The shim.
+ */
+struct net_impair {
+    struct net_impair_config config_; /*!< The impairments. */
+    uint64_t random_; /*!< State of the random generator. */
+    int bad_state_; /*!< Non-zero if the Gilbert-Elliott model is in the bad state. */
+    uint64_t order_; /*!< Number of copies queued so far. */
+    struct net_impair_stats stats_; /*!< Counters. */
+    unsigned int count_; /*!< Number of datagrams held back. */
+    unsigned int heap_[NET_IMPAIR_MAX_QUEUED]; /*!< Indices of the used slots, as a binary min-heap on the due time. */
+    unsigned int free_[NET_IMPAIR_MAX_QUEUED]; /*!< Indices of the free slots, the first NET_IMPAIR_MAX_QUEUED - count_ are valid. */
+    struct net_impair_slot slots_[NET_IMPAIR_MAX_QUEUED]; /*!< Storage of the datagrams. */
+};
+
+/*!
+ * @brief SplitMix64, small and fast, and gives the same sequence on every platform.
+ */
+static uint64_t next_random(struct net_impair * p_impair)
+{
+    uint64_t value = (p_impair->random_ += 0x9e3779b97f4a7c15ULL);
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
+
+/*!
+ * @brief Returns a number uniformly distributed in [0, 1).
+ */
+static double next_uniform(struct net_impair * p_impair)
+{
+    return (double)(next_random(p_impair) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static int slot_before(struct net_impair const * p_impair, unsigned int left, unsigned int right)
+{
+    struct net_impair_slot const * p_left = &p_impair->slots_[left];
+    struct net_impair_slot const * p_right = &p_impair->slots_[right];
+    return p_left->due_ < p_right->due_ || (p_left->due_ == p_right->due_ && p_left->order_ < p_right->order_);
+}
+
+static void sift_up(struct net_impair * p_impair, unsigned int position)
+{
+    while (position > 0)
+    {
+        unsigned int parent = (position - 1) / 2;
+        unsigned int swap;
+        if (!slot_before(p_impair, p_impair->heap_[position], p_impair->heap_[parent]))
+            break;
+        swap = p_impair->heap_[position];
+        p_impair->heap_[position] = p_impair->heap_[parent];
+        p_impair->heap_[parent] = swap;
+        position = parent;
+    }
+}
+
+static void sift_down(struct net_impair * p_impair, unsigned int position)
+{
+    for (;;)
+    {
+        unsigned int smallest = position;
+        unsigned int child = 2 * position + 1;
+        unsigned int swap;
+        if (child < p_impair->count_ && slot_before(p_impair, p_impair->heap_[child], p_impair->heap_[smallest]))
+            smallest = child;
+        if (child + 1 < p_impair->count_ && slot_before(p_impair, p_impair->heap_[child + 1], p_impair->heap_[smallest]))
+            smallest = child + 1;
+        if (smallest == position)
+            break;
+        swap = p_impair->heap_[position];
+        p_impair->heap_[position] = p_impair->heap_[smallest];
+        p_impair->heap_[smallest] = swap;
+        position = smallest;
+    }
+}
+
+static unsigned int enqueue(struct net_impair * p_impair, void const * p_data, size_t data_size, uint64_t due)
+{
+    struct net_impair_slot * p_slot;
+    unsigned int index;
+    if (p_impair->count_ >= NET_IMPAIR_MAX_QUEUED || data_size > NET_IMPAIR_MAX_PACKET)
+    {
+        ++p_impair->stats_.overflows_;
+        return 0;
+    }
+    index = p_impair->free_[NET_IMPAIR_MAX_QUEUED - p_impair->count_ - 1];
+    p_slot = &p_impair->slots_[index];
+    p_slot->due_ = due;
+    p_slot->order_ = p_impair->order_++;
+    p_slot->size_ = data_size;
+    CopyMemory(p_slot->data_, p_data, data_size);
+    p_impair->heap_[p_impair->count_] = index;
+    sift_up(p_impair, p_impair->count_++);
+    return 1;
+}
+
+int net_impair_parse(struct net_impair_config * p_config, char const * psz_text)
+{
+    char text[256];
+    char * psz_item;
+    char * psz_next;
+    ZeroMemory(p_config, sizeof(struct net_impair_config));
+    if (strlen(psz_text) >= sizeof(text))
+        return 0;
+    strcpy(text, psz_text);
+    for (psz_item = text; NULL != psz_item; psz_item = psz_next)
+    {
+        double first, second = -1.0, third = 0.0, fourth = 100.0;
+        unsigned long long seed;
+        int consumed = 0;
+        psz_next = strchr(psz_item, ',');
+        if (NULL != psz_next)
+            *psz_next++ = '\0';
+        if ('\0' == *psz_item)
+            continue;
+        if (1 == sscanf(psz_item, "seed=%llu%n", &seed, &consumed) && '\0' == psz_item[consumed])
+            p_config->seed_ = seed;
+        else if (1 == sscanf(psz_item, "loss=%lf%n", &first, &consumed) && '\0' == psz_item[consumed])
+            p_config->loss_ = first / 100.0;
+        else if (sscanf(psz_item, "ge=%lf:%lf%n:%lf:%lf%n", &first, &second, &consumed, &third, &fourth, &consumed) >= 2
+                && '\0' == psz_item[consumed])
+        {
+            p_config->ge_enter_bad_ = first / 100.0;
+            p_config->ge_leave_bad_ = second / 100.0;
+            p_config->ge_loss_good_ = third / 100.0;
+            p_config->ge_loss_bad_ = fourth / 100.0;
+        }
+        else if (1 == sscanf(psz_item, "dup=%lf%n", &first, &consumed) && '\0' == psz_item[consumed])
+            p_config->duplicate_ = first / 100.0;
+        else if (sscanf(psz_item, "reorder=%lf%n:%lf%n", &first, &consumed, &second, &consumed) >= 1 && '\0' == psz_item[consumed])
+        {
+            p_config->reorder_ = first / 100.0;
+            p_config->reorder_gap_ = second < 0.0 ? DEFAULT_REORDER_GAP : (uint64_t)(second * 1e6);
+        }
+        else if (1 == sscanf(psz_item, "delay=%lf%n", &first, &consumed) && '\0' == psz_item[consumed] && first >= 0.0)
+            p_config->delay_ = (uint64_t)(first * 1e6);
+        else if (1 == sscanf(psz_item, "jitter=%lf%n", &first, &consumed) && '\0' == psz_item[consumed] && first >= 0.0)
+            p_config->jitter_ = (uint64_t)(first * 1e6);
+        else
+        {
+            debug_log_warning(DEBUG_CATEGORY_NETWORK, "%s %4.4u : bad impairment '%s'", __FILE__, __LINE__, psz_item);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+struct net_impair * net_impair_create(struct net_impair_config const * p_config)
+{
+    struct net_impair * p_impair = (struct net_impair *)calloc(1, sizeof(struct net_impair));
+    unsigned int idx;
+    if (NULL == p_impair)
+        return NULL;
+    CopyMemory(&p_impair->config_, p_config, sizeof(struct net_impair_config));
+    p_impair->random_ = p_config->seed_;
+    for (idx = 0; idx < NET_IMPAIR_MAX_QUEUED; ++idx)
+        p_impair->free_[idx] = idx;
+    return p_impair;
+}
+
+struct net_impair * net_impair_create_from_env(void)
+{
+    struct net_impair_config config;
+    char const * psz_text = getenv(NET_IMPAIR_VARIABLE);
+    if (NULL == psz_text || !net_impair_parse(&config, psz_text))
+        return NULL;
+    debug_log_info(DEBUG_CATEGORY_NETWORK, "%s %4.4u : impairing the datagrams with '%s'", __FILE__, __LINE__, psz_text);
+    return net_impair_create(&config);
+}
+
+void net_impair_destroy(struct net_impair * p_impair)
+{
+    free(p_impair);
+}
+
+unsigned int net_impair_submit(struct net_impair * p_impair, void const * p_data, size_t data_size, uint64_t now)
+{
+    struct net_impair_config const * p_config = &p_impair->config_;
+    /* The same number of random values is drawn for every datagram, so changing one impairment does not
+     * change which datagrams the other impairments hit. */
+    double const loss = next_uniform(p_impair);
+    double const transition = next_uniform(p_impair);
+    double const state_loss = next_uniform(p_impair);
+    double const duplicate = next_uniform(p_impair);
+    double const reorder = next_uniform(p_impair);
+    double const jitter[2] = { next_uniform(p_impair), next_uniform(p_impair) };
+    int lost = loss < p_config->loss_;
+    unsigned int copies = 1;
+    unsigned int queued = 0;
+    unsigned int idx;
+    ++p_impair->stats_.submitted_;
+    if (p_config->ge_enter_bad_ > 0.0)
+    {
+        if (transition < (p_impair->bad_state_ ? p_config->ge_leave_bad_ : p_config->ge_enter_bad_))
+            p_impair->bad_state_ = !p_impair->bad_state_;
+        lost |= state_loss < (p_impair->bad_state_ ? p_config->ge_loss_bad_ : p_config->ge_loss_good_);
+    }
+    if (lost)
+    {
+        ++p_impair->stats_.lost_;
+        return 0;
+    }
+    if (duplicate < p_config->duplicate_)
+    {
+        ++p_impair->stats_.duplicated_;
+        copies = 2;
+    }
+    if (reorder < p_config->reorder_)
+        ++p_impair->stats_.reordered_;
+    for (idx = 0; idx < copies; ++idx)
+    {
+        uint64_t due = now + p_config->delay_ + (uint64_t)(jitter[idx] * p_config->jitter_);
+        if (reorder < p_config->reorder_)
+            due += p_config->reorder_gap_;
+        queued += enqueue(p_impair, p_data, data_size, due);
+    }
+    return queued;
+}
+
+size_t net_impair_release(struct net_impair * p_impair, uint64_t now, void * p_buffer, size_t buffer_size)
+{
+    struct net_impair_slot const * p_slot;
+    size_t size;
+    if (0 == p_impair->count_ || p_impair->slots_[p_impair->heap_[0]].due_ > now)
+        return 0;
+    p_slot = &p_impair->slots_[p_impair->heap_[0]];
+    size = min(p_slot->size_, buffer_size);
+    CopyMemory(p_buffer, p_slot->data_, size);
+    p_impair->free_[NET_IMPAIR_MAX_QUEUED - p_impair->count_] = p_impair->heap_[0];
+    p_impair->heap_[0] = p_impair->heap_[--p_impair->count_];
+    sift_down(p_impair, 0);
+    ++p_impair->stats_.released_;
+    return size;
+}
+
+uint64_t net_impair_get_next_due(struct net_impair const * p_impair)
+{
+    return 0 == p_impair->count_ ? UINT64_MAX : p_impair->slots_[p_impair->heap_[0]].due_;
+}
+
+void net_impair_get_stats(struct net_impair const * p_impair, struct net_impair_stats * p_stats)
+{
+    CopyMemory(p_stats, &p_impair->stats_, sizeof(struct net_impair_stats));
+}
+
+size_t net_impair_sendto(struct net_impair * p_impair, struct mcast_connection * p_conn, void const * p_data, size_t data_size)
+{
+    if (NULL == p_impair)
+        return mcast_sendto(p_conn, p_data, data_size);
+    net_impair_submit(p_impair, p_data, data_size, perf_counter_get_monotonic_ns());
+    net_impair_flush(p_impair, p_conn);
+    return data_size;
+}
+
+unsigned int net_impair_flush(struct net_impair * p_impair, struct mcast_connection * p_conn)
+{
+    uint8_t buffer[NET_IMPAIR_MAX_PACKET];
+    uint64_t const now = perf_counter_get_monotonic_ns();
+    unsigned int count = 0;
+    size_t size;
+    while (0 != (size = net_impair_release(p_impair, now, buffer, sizeof(buffer))))
+    {
+        if (size != mcast_sendto(p_conn, buffer, size))
+            debug_log_warning(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %lu", __FILE__, __LINE__, get_last_socket_error());
+        ++count;
+    }
+    return count;
+}
+
+size_t net_impair_recvfrom(struct net_impair * p_impair, struct mcast_connection * p_conn, void * p_data, size_t data_size)
+{
+    uint8_t buffer[NET_IMPAIR_MAX_PACKET];
+    size_t size;
+    if (NULL == p_impair)
+        return mcast_recvfrom(p_conn, p_data, data_size);
+    while (mcast_is_new_data(p_conn, 0) > 0)
+    {
+        size = mcast_recvfrom(p_conn, buffer, sizeof(buffer));
+        if ((size_t)-1 == size)
+            break;
+        net_impair_submit(p_impair, buffer, size, perf_counter_get_monotonic_ns());
+    }
+    size = net_impair_release(p_impair, perf_counter_get_monotonic_ns(), p_data, data_size);
+    return 0 == size ? (size_t)-1 : size;
+}
@@ -0,0 +1,205 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+
+/**
+ * @file net-impair.h
+ * @brief Seeded network impairment shim.
+ * @details Drops, duplicates, reorders and delays the datagrams between the socket calls of mcast_setup.h and the application, reproducibly, without root or tc netem.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+#if !defined NET_IMPAIR_H_8B2D5F14_C7E3_4A96_9F01_3E6A7C5D2B48
+#define NET_IMPAIR_H_8B2D5F14_C7E3_4A96_9F01_3E6A7C5D2B48
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+#include "std-int.h"
+#include <stddef.h>
+
+/*!
+ * @brief Maximum number of datagrams held back at the same time.
+ */
+#define NET_IMPAIR_MAX_QUEUED (1024)
+
+/*!
+ * @brief Maximum size of a datagram that passes through the shim.
+ */
+#define NET_IMPAIR_MAX_PACKET (2048)
+
+/*!
+ * @brief Name of the environment variable with the impairment description, see net_impair_parse.
+ */
+#define NET_IMPAIR_VARIABLE "MCAST_IMPAIR"
+
+/*!
+ * @brief Describes the impairments. All the probabilities are from 0 to 1, all the times are in nanoseconds.
+ * @details A zeroed structure describes a perfect network.
+ */
+struct net_impair_config {
+    uint64_t seed_; /*!< Seed of the random generator. Runs with the same seed and the same input impair the same datagrams. */
+    double loss_; /*!< Probability that a datagram is lost, independently of all the others. */
+    double ge_enter_bad_; /*!< Gilbert-Elliott model: probability of going from the good to the bad state. 0 disables the model. */
+    double ge_leave_bad_; /*!< Gilbert-Elliott model: probability of going from the bad to the good state. */
+    double ge_loss_good_; /*!< Gilbert-Elliott model: probability that a datagram is lost in the good state. */
+    double ge_loss_bad_; /*!< Gilbert-Elliott model: probability that a datagram is lost in the bad state. */
+    double duplicate_; /*!< Probability that a datagram is delivered twice. */
+    double reorder_; /*!< Probability that a datagram is held back by reorder_gap_, so that the following ones overtake it. */
+    uint64_t reorder_gap_; /*!< How long a reordered datagram is held back on top of its delay. */
+    uint64_t delay_; /*!< Fixed delay of all the datagrams. */
+    uint64_t jitter_; /*!< Each datagram is delayed by a further, uniformly distributed, 0 to jitter_. */
+};
+
+/*!
+ * @brief Counters of the shim.
+ */
+struct net_impair_stats {
+    uint64_t submitted_; /*!< Number of datagrams given to the shim. */
+    uint64_t lost_; /*!< Number of datagrams dropped by either of the loss models. */
+    uint64_t duplicated_; /*!< Number of extra copies made. */
+    uint64_t reordered_; /*!< Number of datagrams held back to be overtaken. */
+    uint64_t overflows_; /*!< Number of datagrams dropped because the queue was full or they were too large. */
+    uint64_t released_; /*!< Number of datagrams given back. */
+};
+
+/*!
+ * @brief Forward declaration.
+ */
+struct net_impair;
+
+/*!
+ * @brief Forward declaration.
+ */
+struct mcast_connection;
+
+/*!
+ * @brief Reads the impairment description.
+ * @details The description is a comma separated list of key=value pairs, with the probabilities given in percent
+ * and the times in milliseconds, for example "seed=7,loss=1,delay=20,jitter=5". The keys are:
+ * - seed=N
+ * - loss=P, the independent loss;
+ * - ge=P:R[:G:B], the Gilbert-Elliott loss: P is the chance to enter the bad state, R to leave it,
+ *   G and B the loss in the good and bad state, 0 and 100 by default;
+ * - dup=P;
+ * - reorder=P[:GAP], GAP is 10 ms by default;
+ * - delay=MS;
+ * - jitter=MS.
+ * @param[out] p_config this structure will be written with the description. Keys not given are zero.
+ * @param[in] psz_text the description.
+ * @return returns non-zero on success, 0 if the description is malformed.
+ */
+int net_impair_parse(struct net_impair_config * p_config, char const * psz_text);
+
+/*!
+ * @brief Creates the shim.
+ * @param[in] p_config the impairments.
+ * @return returns a handle to the shim, or NULL if creation failed.
+ * @sa net_impair_destroy
+ */
+struct net_impair * net_impair_create(struct net_impair_config const * p_config);
+
+/*!
+ * @brief Creates the shim from the NET_IMPAIR_VARIABLE environment variable.
+ * @return returns a handle to the shim, or NULL if the variable is not set, is malformed, or creation failed.
+ */
+struct net_impair * net_impair_create_from_env(void);
+
+/*!
+ * @brief Destroys the shim and all the datagrams still held back.
+ * @param[in] p_impair a handle to the shim obtained via call to net_impair_create.
+ */
+void net_impair_destroy(struct net_impair * p_impair);
+
+/*!
+ * @brief Gives a datagram to the shim.
+ * @details The datagram is either dropped, or queued once or twice to be released at its due time.
+ * @param[in] p_impair a handle to the shim.
+ * @param[in] p_data the datagram.
+ * @param[in] data_size size of the datagram.
+ * @param[in] now current time, in nanoseconds, on the same clock as given to net_impair_release.
+ * @return returns number of copies queued, i.e. 0, 1 or 2.
+ */
+unsigned int net_impair_submit(struct net_impair * p_impair, void const * p_data, size_t data_size, uint64_t now);
+
+/*!
+ * @brief Takes the next datagram that is due.
+ * @details The datagrams are released in the order of their due times, those with the same due time in the order
+ * they were submitted.
+ * @param[in] p_impair a handle to the shim.
+ * @param[in] now current time, in nanoseconds.
+ * @param[out] p_buffer this buffer will be written with the datagram.
+ * @param[in] buffer_size size of the buffer. A datagram larger than that is truncated.
+ * @return returns number of bytes written, or 0 if no datagram is due yet.
+ */
+size_t net_impair_release(struct net_impair * p_impair, uint64_t now, void * p_buffer, size_t buffer_size);
+
+/*!
+ * @brief Returns the due time of the datagram that is released next.
+ * @param[in] p_impair a handle to the shim.
+ * @return returns the due time, or UINT64_MAX if the shim holds no datagrams.
+ */
+uint64_t net_impair_get_next_due(struct net_impair const * p_impair);
+
+/*!
+ * @brief Returns the counters.
+ * @param[in] p_impair a handle to the shim.
+ * @param[out] p_stats this structure will be written with the counters.
+ */
+void net_impair_get_stats(struct net_impair const * p_impair, struct net_impair_stats * p_stats);
+
+/*!
+ * @brief Drop-in replacement for mcast_sendto.
+ * @details Submits the datagram, then sends all the datagrams that are due. Call net_impair_flush when there is
+ * nothing to send, so that the delayed datagrams still go out on time.
+ * @param[in] p_impair a handle to the shim, NULL sends the datagram directly.
+ * @param[in] p_conn the connection.
+ * @param[in] p_data the datagram.
+ * @param[in] data_size size of the datagram.
+ * @return returns data_size, even if the datagram was dropped, or what mcast_sendto returned if the sending failed.
+ */
+size_t net_impair_sendto(struct net_impair * p_impair, struct mcast_connection * p_conn, void const * p_data, size_t data_size);
+
+/*!
+ * @brief Sends all the datagrams that are due.
+ * @param[in] p_impair a handle to the shim.
+ * @param[in] p_conn the connection.
+ * @return returns number of datagrams sent.
+ */
+unsigned int net_impair_flush(struct net_impair * p_impair, struct mcast_connection * p_conn);
+
+/*!
+ * @brief Drop-in replacement for mcast_recvfrom.
+ * @details Submits everything that is waiting in the socket, then returns the next datagram that is due.
+ * Does not block.
+ * @param[in] p_impair a handle to the shim, NULL receives the datagram directly.
+ * @param[in] p_conn the connection.
+ * @param[out] p_data this buffer will be written with the datagram.
+ * @param[in] data_size size of the buffer.
+ * @return returns number of bytes written, or (size_t)-1 if no datagram is due yet.
+ */
+size_t net_impair_recvfrom(struct net_impair * p_impair, struct mcast_connection * p_conn, void * p_data, size_t data_size);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* NET_IMPAIR_H_8B2D5F14_C7E3_4A96_9F01_3E6A7C5D2B48 */
@@ -0,0 +1,379 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file packet-capture.c
+ * @brief Capture file of the received datagrams.
+ * @details The writer appends through a large stdio buffer, after cutting off a record left incomplete by the previous
+ * writer, and starts each session with a marker record. The reader maps the whole file and walks the records in place.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include "packet-capture.h"
+#include "debug_helpers.h"
+
+/*!
+ * @brief Size of the stdio buffer of the writer.
+ */
+#define WRITER_BUFFER_SIZE (64 * 1024)
+
+/*!
+ * @brief Rounds the size up to the record alignment.
+ */
+#define RECORD_ALIGN(size) (((size) + 7) & ~(size_t)7)
+
+/*!
+ * @brief The writer.
+ */
+struct packet_capture_writer {
+    FILE * fp_; /*!< The file, positioned after the last complete record. */
+    int session_pending_; /*!< Non-zero until the record that starts the session has been written. */
+    char buffer_[WRITER_BUFFER_SIZE]; /*!< The stdio buffer of fp_. */
+};
+
+/*!
+ * @brief The reader.
+ */
+struct packet_capture_reader {
+    uint8_t const * p_data_; /*!< The mapped file. */
+    size_t size_; /*!< Size of the mapped file. */
+    size_t offset_; /*!< Offset of the next record. */
+#if defined WIN32
+    HANDLE hf_; /*!< The file. */
+    HANDLE mapping_; /*!< Mapping of the file. */
+#endif
+};
+
+static int check_file_header(struct packet_capture_file_header const * p_header)
+{
+    return PACKET_CAPTURE_MAGIC == p_header->magic_
+        && PACKET_CAPTURE_VERSION == p_header->version_
+        && p_header->header_size_ >= sizeof(struct packet_capture_file_header)
+        && 0 == p_header->header_size_ % 8;
+}
+
+static int check_record(struct packet_capture_record const * p_record)
+{
+    return p_record->size_ <= PACKET_CAPTURE_MAX_DATAGRAM;
+}
+
+/*!
+ * @brief Finds the end of the last complete record and cuts off whatever follows it.
+ * @details A record whose datagram is complete, but whose padding is not, is padded, so that the next record is aligned.
+ * @return returns non-zero on success, 0 if the file could not be fixed.
+ */
+static int repair_tail(FILE * fp, char const * psz_path, long header_size)
+{
+    static uint8_t const padding[8] = { 0 };
+    struct packet_capture_record record;
+    long end = header_size;
+    long size;
+    if (0 != fseek(fp, 0, SEEK_END) || (size = ftell(fp)) < 0)
+        return 0;
+    while (size - end >= (long)sizeof(record))
+    {
+        if (0 != fseek(fp, end, SEEK_SET) || 1 != fread(&record, sizeof(record), 1, fp) || !check_record(&record))
+            break;
+        if (size - end - (long)sizeof(record) < (long)record.size_)
+            break;
+        end += (long)sizeof(record) + (long)RECORD_ALIGN(record.size_);
+    }
+    if (end > size)
+    {
+        if (0 != fseek(fp, size, SEEK_SET) || (size_t)(end - size) != fwrite(padding, 1, (size_t)(end - size), fp))
+            return 0;
+    }
+    else if (end != size)
+    {
+        debug_log_warning(DEBUG_CATEGORY_RECEIVER, "%s %4.4u : %s cut from %ld to %ld bytes", __FILE__, __LINE__, psz_path, size, end);
+        fflush(fp);
+#if defined WIN32
+        if (0 != _chsize_s(_fileno(fp), end))
+#else
+        if (0 != ftruncate(fileno(fp), end))
+#endif
+            return 0;
+    }
+    /* The reads and the writes of a "+" stream must be separated by a seek. */
+    return 0 == fseek(fp, end, SEEK_SET);
+}
+
+struct packet_capture_writer * packet_capture_writer_open(char const * psz_path)
+{
+    struct packet_capture_writer * p_writer = (struct packet_capture_writer *)calloc(1, sizeof(struct packet_capture_writer));
+    struct packet_capture_file_header header;
+    size_t read;
+    if (NULL == p_writer)
+        return NULL;
+    /* The existing records are kept, "w" would throw them away and "a" would not let the damaged tail be cut off. */
+    p_writer->fp_ = fopen(psz_path, "r+b");
+    if (NULL == p_writer->fp_ && ENOENT == errno)
+        p_writer->fp_ = fopen(psz_path, "w+b");
+    if (NULL == p_writer->fp_)
+    {
+        debug_log_error(DEBUG_CATEGORY_RECEIVER, "%s %4.4u : %s %d %s", __FILE__, __LINE__, psz_path, errno, strerror(errno));
+        free(p_writer);
+        return NULL;
+    }
+    setvbuf(p_writer->fp_, p_writer->buffer_, _IOFBF, sizeof(p_writer->buffer_));
+    read = fread(&header, 1, sizeof(header), p_writer->fp_);
+    if (0 == read)
+    {
+        rewind(p_writer->fp_);
+        ZeroMemory(&header, sizeof(header));
+        header.magic_ = PACKET_CAPTURE_MAGIC;
+        header.version_ = PACKET_CAPTURE_VERSION;
+        header.header_size_ = sizeof(header);
+        if (1 != fwrite(&header, sizeof(header), 1, p_writer->fp_) || 0 != fflush(p_writer->fp_))
+            read = 0;
+        else
+            read = sizeof(header);
+    }
+    else if (sizeof(header) != read || !check_file_header(&header) || !repair_tail(p_writer->fp_, psz_path, header.header_size_))
+        read = 0;
+    if (sizeof(header) != read)
+    {
+        debug_log_error(DEBUG_CATEGORY_RECEIVER, "%s %4.4u : %s is not a capture file", __FILE__, __LINE__, psz_path);
+        packet_capture_writer_close(p_writer);
+        return NULL;
+    }
+    p_writer->session_pending_ = 1;
+    return p_writer;
+}
+
+struct packet_capture_writer * packet_capture_writer_open_from_env(void)
+{
+    char const * psz_path = getenv(PACKET_CAPTURE_PATH_VARIABLE);
+    if (NULL == psz_path || '\0' == *psz_path)
+        return NULL;
+    return packet_capture_writer_open(psz_path);
+}
+
+int packet_capture_writer_append(struct packet_capture_writer * p_writer, uint64_t timestamp, struct sockaddr_storage const * p_from,
+        void const * p_data, size_t data_size)
+{
+    static uint8_t const padding[8] = { 0 };
+    struct packet_capture_record record;
+    if (p_writer->session_pending_)
+    {
+        ZeroMemory(&record, sizeof(record));
+        record.timestamp_ = timestamp;
+        record.family_ = PACKET_CAPTURE_FAMILY_SESSION;
+        if (1 != fwrite(&record, sizeof(record), 1, p_writer->fp_))
+            return 0;
+        p_writer->session_pending_ = 0;
+    }
+    ZeroMemory(&record, sizeof(record));
+    record.timestamp_ = timestamp;
+    record.size_ = (uint32_t)data_size;
+    if (NULL != p_from && AF_INET == p_from->ss_family)
+    {
+        struct sockaddr_in const * p_from4 = (struct sockaddr_in const *)p_from;
+        record.family_ = AF_INET;
+        record.port_ = p_from4->sin_port;
+        CopyMemory(record.address_, &p_from4->sin_addr, sizeof(p_from4->sin_addr));
+    }
+    else if (NULL != p_from && AF_INET6 == p_from->ss_family)
+    {
+        struct sockaddr_in6 const * p_from6 = (struct sockaddr_in6 const *)p_from;
+        record.family_ = AF_INET6;
+        record.port_ = p_from6->sin6_port;
+        CopyMemory(record.address_, &p_from6->sin6_addr, sizeof(p_from6->sin6_addr));
+    }
+    return 1 == fwrite(&record, sizeof(record), 1, p_writer->fp_)
+        && data_size == fwrite(p_data, 1, data_size, p_writer->fp_)
+        && RECORD_ALIGN(data_size) - data_size == fwrite(padding, 1, RECORD_ALIGN(data_size) - data_size, p_writer->fp_);
+}
+
+int packet_capture_writer_flush(struct packet_capture_writer * p_writer)
+{
+    return 0 == fflush(p_writer->fp_);
+}
+
+void packet_capture_writer_close(struct packet_capture_writer * p_writer)
+{
+    if (NULL != p_writer)
+    {
+        fclose(p_writer->fp_);
+        free(p_writer);
+    }
+}
+
+struct packet_capture_reader * packet_capture_reader_open(char const * psz_path)
+{
+    struct packet_capture_reader * p_reader = (struct packet_capture_reader *)calloc(1, sizeof(struct packet_capture_reader));
+    if (NULL == p_reader)
+        return NULL;
+#if defined WIN32
+    {
+        LARGE_INTEGER size;
+        p_reader->hf_ = CreateFileA(psz_path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (INVALID_HANDLE_VALUE != p_reader->hf_ && GetFileSizeEx(p_reader->hf_, &size) && size.QuadPart >= sizeof(struct packet_capture_file_header))
+        {
+            p_reader->size_ = (size_t)size.QuadPart;
+            p_reader->mapping_ = CreateFileMapping(p_reader->hf_, NULL, PAGE_READONLY, 0, 0, NULL);
+            if (NULL != p_reader->mapping_)
+                p_reader->p_data_ = (uint8_t const *)MapViewOfFile(p_reader->mapping_, FILE_MAP_READ, 0, 0, 0);
+        }
+    }
+#else
+    {
+        struct stat st_file;
+        int fd = open(psz_path, O_RDONLY);
+        if (fd >= 0 && 0 == fstat(fd, &st_file) && (size_t)st_file.st_size >= sizeof(struct packet_capture_file_header))
+        {
+            void * p_map = mmap(NULL, st_file.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (MAP_FAILED != p_map)
+            {
+                /* The records are read once, front to back. */
+                madvise(p_map, st_file.st_size, MADV_SEQUENTIAL);
+                p_reader->p_data_ = (uint8_t const *)p_map;
+                p_reader->size_ = (size_t)st_file.st_size;
+            }
+        }
+        if (fd >= 0)
+            close(fd);
+    }
+#endif
+    if (NULL == p_reader->p_data_ || !check_file_header((struct packet_capture_file_header const *)p_reader->p_data_))
+    {
+        debug_log_error(DEBUG_CATEGORY_RECEIVER, "%s %4.4u : %s is not a capture file", __FILE__, __LINE__, psz_path);
+        packet_capture_reader_close(p_reader);
+        return NULL;
+    }
+    packet_capture_reader_rewind(p_reader);
+    return p_reader;
+}
+
+struct packet_capture_record const * packet_capture_reader_next(struct packet_capture_reader * p_reader, uint8_t const ** pp_data)
+{
+    struct packet_capture_record const * p_record;
+    if (p_reader->size_ - p_reader->offset_ < sizeof(struct packet_capture_record))
+        return NULL;
+    p_record = (struct packet_capture_record const *)&p_reader->p_data_[p_reader->offset_];
+    if (!check_record(p_record) || p_reader->size_ - p_reader->offset_ - sizeof(struct packet_capture_record) < p_record->size_)
+        return NULL;
+    *pp_data = &p_reader->p_data_[p_reader->offset_ + sizeof(struct packet_capture_record)];
+    p_reader->offset_ = min(p_reader->size_, p_reader->offset_ + sizeof(struct packet_capture_record) + RECORD_ALIGN(p_record->size_));
+    return p_record;
+}
+
+void packet_capture_reader_rewind(struct packet_capture_reader * p_reader)
+{
+    p_reader->offset_ = ((struct packet_capture_file_header const *)p_reader->p_data_)->header_size_;
+}
+
+void packet_capture_reader_close(struct packet_capture_reader * p_reader)
+{
+    if (NULL != p_reader)
+    {
+#if defined WIN32
+        if (NULL != p_reader->p_data_)
+            UnmapViewOfFile(p_reader->p_data_);
+        if (NULL != p_reader->mapping_)
+            CloseHandle(p_reader->mapping_);
+        if (NULL != p_reader->hf_ && INVALID_HANDLE_VALUE != p_reader->hf_)
+            CloseHandle(p_reader->hf_);
+#else
+        if (NULL != p_reader->p_data_)
+            munmap((void *)p_reader->p_data_, p_reader->size_);
+#endif
+        free(p_reader);
+    }
+}
+
+int packet_capture_record_get_source(struct packet_capture_record const * p_record, struct sockaddr_storage * p_address)
+{
+    ZeroMemory(p_address, sizeof(struct sockaddr_storage));
+    if (AF_INET == p_record->family_)
+    {
+        struct sockaddr_in * p_address4 = (struct sockaddr_in *)p_address;
+        p_address4->sin_family = AF_INET;
+        p_address4->sin_port = p_record->port_;
+        CopyMemory(&p_address4->sin_addr, p_record->address_, sizeof(p_address4->sin_addr));
+        return 1;
+    }
+    if (AF_INET6 == p_record->family_)
+    {
+        struct sockaddr_in6 * p_address6 = (struct sockaddr_in6 *)p_address;
+        p_address6->sin6_family = AF_INET6;
+        p_address6->sin6_port = p_record->port_;
+        CopyMemory(&p_address6->sin6_addr, p_record->address_, sizeof(p_address6->sin6_addr));
+        return 1;
+    }
+    return 0;
+}
+
+int packet_capture_record_is_session(struct packet_capture_record const * p_record)
+{
+    return PACKET_CAPTURE_FAMILY_SESSION == p_record->family_;
+}
+
+#if !defined WIN32
+int packet_capture_enable_timestamps(int s)
+{
+    int enable = 1;
+    return 0 == setsockopt(s, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable));
+}
+
+ssize_t packet_capture_recvfrom(int s, void * p_data, size_t data_size, struct sockaddr_storage * p_from, socklen_t * p_from_length,
+        uint64_t * p_timestamp)
+{
+    union {
+        struct cmsghdr header_;
+        char buffer_[CMSG_SPACE(sizeof(struct timespec))];
+    } control;
+    struct iovec vector;
+    struct msghdr message;
+    struct cmsghdr * p_control;
+    ssize_t result;
+    vector.iov_base = p_data;
+    vector.iov_len = data_size;
+    ZeroMemory(&message, sizeof(message));
+    message.msg_name = p_from;
+    message.msg_namelen = *p_from_length;
+    message.msg_iov = &vector;
+    message.msg_iovlen = 1;
+    message.msg_control = control.buffer_;
+    message.msg_controllen = sizeof(control.buffer_);
+    result = recvmsg(s, &message, 0);
+    if (result < 0)
+        return result;
+    *p_from_length = message.msg_namelen;
+    for (p_control = CMSG_FIRSTHDR(&message); NULL != p_control; p_control = CMSG_NXTHDR(&message, p_control))
+    {
+        if (SOL_SOCKET == p_control->cmsg_level && SCM_TIMESTAMPNS == p_control->cmsg_type)
+        {
+            struct timespec stamp;
+            CopyMemory(&stamp, CMSG_DATA(p_control), sizeof(stamp));
+            *p_timestamp = (uint64_t)stamp.tv_sec * 1000000000ULL + (uint64_t)stamp.tv_nsec;
+            return result;
+        }
+    }
+    {
+        struct timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        *p_timestamp = (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+    }
+    return result;
+}
+#endif
@@ -0,0 +1,220 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+
+/**
+ * @file packet-capture.h
+ * @brief Capture file of the received datagrams.
+ * @details Append-only file of datagrams with their kernel arrival time and sender, laid out so that it can be mapped into the memory and walked in place.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+#if !defined PACKET_CAPTURE_H_E4A19C37_2B6D_4F85_8D0C_71F3B5A2E96D
+#define PACKET_CAPTURE_H_E4A19C37_2B6D_4F85_8D0C_71F3B5A2E96D
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+#include "std-int.h"
+#include <stddef.h>
+
+/*!
+ * @brief Name of the environment variable with the path of the capture file the receiver appends to.
+ */
+#define PACKET_CAPTURE_PATH_VARIABLE "MCAST_CAPTURE"
+
+/*!
+ * @brief First four bytes of a capture file. Written in the host byte order, so a file from a host of the other
+ * byte order is rejected rather than misread.
+ */
+#define PACKET_CAPTURE_MAGIC (0x5043434du)
+
+/*!
+ * @brief Version of the file layout.
+ */
+#define PACKET_CAPTURE_VERSION (1)
+
+/*!
+ * @brief Size of the address field of a record, enough for IPv6.
+ */
+#define PACKET_CAPTURE_ADDRESS_SIZE (16)
+
+/*!
+ * @brief Largest datagram a record may hold, anything larger means the file is damaged.
+ */
+#define PACKET_CAPTURE_MAX_DATAGRAM (65535)
+
+/*!
+ * @brief Value of the family_ field of the record that starts a capture session.
+ * @details Each time the writer opens the file, the first record it writes is an empty one with this family and the
+ * timestamp of the datagram that follows. The clocks of two sessions are unrelated, so the replay starts over at
+ * each such record instead of waiting for the time between the sessions.
+ */
+#define PACKET_CAPTURE_FAMILY_SESSION (0xffff)
+
+/*!
+ * @brief Header of the capture file.
+ */
+struct packet_capture_file_header {
+    uint32_t magic_; /*!< PACKET_CAPTURE_MAGIC. */
+    uint16_t version_; /*!< PACKET_CAPTURE_VERSION. */
+    uint16_t header_size_; /*!< Size of this header, the first record starts right after it. */
+};
+
+/*!
+ * @brief Header of a single captured datagram.
+ * @details The datagram follows the header, padded with zeros to a multiple of 8 bytes, so that every record
+ * header in a mapped file is naturally aligned.
+ */
+struct packet_capture_record {
+    uint64_t timestamp_; /*!< Arrival time, in nanoseconds since the Unix epoch, as stamped by the kernel. */
+    uint32_t size_; /*!< Number of bytes of the datagram. */
+    uint16_t family_; /*!< AF_INET or AF_INET6, the family of the sender's address. */
+    uint16_t port_; /*!< Sender's port, in the network byte order. */
+    uint8_t address_[PACKET_CAPTURE_ADDRESS_SIZE]; /*!< Sender's address, in the network byte order. IPv4 takes the first 4 bytes. */
+};
+
+/*!
+ * @brief Forward declaration.
+ */
+struct packet_capture_writer;
+
+/*!
+ * @brief Forward declaration.
+ */
+struct packet_capture_reader;
+
+/*!
+ * @brief Opens the capture file for appending. The file is created if it does not exist.
+ * @details A record cut short at the end of the file, e.g. because the last writer was killed, is cut off, so that
+ * the records appended follow the last complete one. The records appended make up a new session, see
+ * PACKET_CAPTURE_FAMILY_SESSION.
+ * @param[in] psz_path path of the file.
+ * @return returns a handle to the writer, or NULL if the file cannot be opened, or is not a capture file.
+ * @sa packet_capture_writer_close
+ */
+struct packet_capture_writer * packet_capture_writer_open(char const * psz_path);
+
+/*!
+ * @brief Opens the file given by the PACKET_CAPTURE_PATH_VARIABLE environment variable.
+ * @return returns a handle to the writer, or NULL if the variable is not set or the file cannot be opened.
+ */
+struct packet_capture_writer * packet_capture_writer_open_from_env(void);
+
+/*!
+ * @brief Appends a single datagram to the file.
+ * @details The records are buffered, they are guaranteed to be in the file only after packet_capture_writer_flush
+ * or packet_capture_writer_close.
+ * @param[in] p_writer a handle to the writer.
+ * @param[in] timestamp arrival time, in nanoseconds since the Unix epoch.
+ * @param[in] p_from sender's address, NULL if not known.
+ * @param[in] p_data the datagram.
+ * @param[in] data_size size of the datagram.
+ * @return returns non-zero on success, 0 if the writing failed.
+ */
+int packet_capture_writer_append(struct packet_capture_writer * p_writer, uint64_t timestamp, struct sockaddr_storage const * p_from,
+        void const * p_data, size_t data_size);
+
+/*!
+ * @brief Writes out the buffered records.
+ * @param[in] p_writer a handle to the writer.
+ * @return returns non-zero on success, 0 if the writing failed.
+ */
+int packet_capture_writer_flush(struct packet_capture_writer * p_writer);
+
+/*!
+ * @brief Writes out the buffered records and closes the file.
+ * @param[in] p_writer a handle to the writer obtained via call to packet_capture_writer_open.
+ */
+void packet_capture_writer_close(struct packet_capture_writer * p_writer);
+
+/*!
+ * @brief Maps the capture file into the memory.
+ * @param[in] psz_path path of the file.
+ * @return returns a handle to the reader, or NULL if the file cannot be mapped, or is not a capture file.
+ * @sa packet_capture_reader_close
+ */
+struct packet_capture_reader * packet_capture_reader_open(char const * psz_path);
+
+/*!
+ * @brief Returns the next record.
+ * @details A record cut short, e.g. because the writer was killed, ends the capture.
+ * @param[in] p_reader a handle to the reader.
+ * @param[out] pp_data this will be written with a pointer to the datagram, inside the mapped file.
+ * @return returns a pointer to the record header, inside the mapped file, or NULL if there are no more records.
+ */
+struct packet_capture_record const * packet_capture_reader_next(struct packet_capture_reader * p_reader, uint8_t const ** pp_data);
+
+/*!
+ * @brief Makes packet_capture_reader_next start again from the first record.
+ * @param[in] p_reader a handle to the reader.
+ */
+void packet_capture_reader_rewind(struct packet_capture_reader * p_reader);
+
+/*!
+ * @brief Unmaps the file.
+ * @param[in] p_reader a handle to the reader obtained via call to packet_capture_reader_open.
+ */
+void packet_capture_reader_close(struct packet_capture_reader * p_reader);
+
+/*!
+ * @brief Converts the sender's address of the record back to a socket address.
+ * @param[in] p_record the record.
+ * @param[out] p_address this structure will be written with the address.
+ * @return returns non-zero on success, 0 if the record does not carry the sender's address.
+ */
+int packet_capture_record_get_source(struct packet_capture_record const * p_record, struct sockaddr_storage * p_address);
+
+/*!
+ * @brief Tells if the record starts a capture session.
+ * @param[in] p_record the record.
+ * @return returns non-zero if the record starts a session, 0 if it is a datagram.
+ */
+int packet_capture_record_is_session(struct packet_capture_record const * p_record);
+
+#if !defined WIN32
+/*!
+ * @brief Asks the kernel to stamp the arrival time of each datagram received on the socket.
+ * @param[in] s the socket.
+ * @return returns non-zero on success, 0 on failure.
+ */
+int packet_capture_enable_timestamps(int s);
+
+/*!
+ * @brief Receives a single datagram along with its kernel arrival time.
+ * @details Falls back to the current time if the kernel did not stamp the datagram.
+ * @param[in] s the socket, see packet_capture_enable_timestamps.
+ * @param[out] p_data this buffer will be written with the datagram.
+ * @param[in] data_size size of the buffer.
+ * @param[out] p_from this structure will be written with the sender's address.
+ * @param[in,out] p_from_length size of the structure on input, size of the address on output.
+ * @param[out] p_timestamp this will be written with the arrival time, in nanoseconds since the Unix epoch.
+ * @return returns number of bytes received, or -1 on error, just like recvfrom.
+ */
+ssize_t packet_capture_recvfrom(int s, void * p_data, size_t data_size, struct sockaddr_storage * p_from, socklen_t * p_from_length,
+        uint64_t * p_timestamp);
+#endif
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* PACKET_CAPTURE_H_E4A19C37_2B6D_4F85_8D0C_71F3B5A2E96D */
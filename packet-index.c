@@ -0,0 +1,197 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file packet-index.c
+ * @brief Index of the packets of a prerecorded WAV file.
+ * @details The index is either built from the chunk layout, without reading the samples, or read from the sidecar file.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include "packet-index.h"
+#include "wave-reader.h"
+#include "debug_helpers.h"
+
+/*!
+ * @brief The index.
+ */
+struct packet_index {
+    struct packet_index_header header_; /*!< Counts and sizes, the source fields are filled in only when saved or loaded. */
+    struct packet_index_entry * p_entries_; /*!< The entries, header_.packets_count_ of them. */
+};
+
+static struct packet_index * index_create(uint64_t packets_count)
+{
+    struct packet_index * p_index = (struct packet_index *)calloc(1, sizeof(struct packet_index));
+    if (NULL == p_index)
+        return NULL;
+    /* The entry for the one past the last packet is never read, it just keeps malloc(0) out of the way. */
+    p_index->p_entries_ = (struct packet_index_entry *)malloc((size_t)(packets_count + 1) * sizeof(struct packet_index_entry));
+    if (NULL == p_index->p_entries_)
+    {
+        free(p_index);
+        return NULL;
+    }
+    p_index->header_.magic_ = PACKET_INDEX_MAGIC;
+    p_index->header_.version_ = PACKET_INDEX_VERSION;
+    p_index->header_.packets_count_ = packets_count;
+    return p_index;
+}
+
+static int get_source(char const * psz_source_path, struct packet_index_header * p_header)
+{
+    struct stat st_file;
+    if (0 != stat(psz_source_path, &st_file))
+        return 0;
+    p_header->source_size_ = (uint64_t)st_file.st_size;
+    p_header->source_mtime_ = (int64_t)st_file.st_mtime;
+    return 1;
+}
+
+struct packet_index * packet_index_build(struct wave_reader const * p_reader, uint32_t frames_per_packet)
+{
+    struct packet_index * p_index;
+    uint64_t const data_offset = wave_reader_get_data_offset(p_reader);
+    uint32_t const block_align = wave_reader_get_format(p_reader)->block_align_;
+    uint64_t packets_count;
+    uint64_t idx;
+    if (0 == frames_per_packet)
+        return NULL;
+    packets_count = wave_reader_get_frames_count(p_reader) / frames_per_packet;
+    p_index = index_create(packets_count);
+    if (NULL == p_index)
+        return NULL;
+    p_index->header_.frames_per_packet_ = frames_per_packet;
+    p_index->header_.block_align_ = block_align;
+    for (idx = 0; idx < packets_count; ++idx)
+    {
+        p_index->p_entries_[idx].timestamp_ = idx * frames_per_packet;
+        p_index->p_entries_[idx].offset_ = data_offset + idx * frames_per_packet * block_align;
+    }
+    return p_index;
+}
+
+int packet_index_save(struct packet_index const * p_index, char const * psz_path, char const * psz_source_path)
+{
+    struct packet_index_header header = p_index->header_;
+    size_t const count = (size_t)header.packets_count_;
+    FILE * fp;
+    int result;
+    if (!get_source(psz_source_path, &header))
+        return 0;
+    fp = fopen(psz_path, "wb");
+    if (NULL == fp)
+    {
+        debug_log_warning(DEBUG_CATEGORY_SENDER, "%s %4.4u : %s %d %s", __FILE__, __LINE__, psz_path, errno, strerror(errno));
+        return 0;
+    }
+    result = 1 == fwrite(&header, sizeof(header), 1, fp)
+        && count == fwrite(p_index->p_entries_, sizeof(struct packet_index_entry), count, fp);
+    result = 0 == fclose(fp) && result;
+    if (!result)
+        unlink(psz_path);
+    return result;
+}
+
+struct packet_index * packet_index_load(char const * psz_path, char const * psz_source_path, uint32_t frames_per_packet)
+{
+    struct packet_index_header header;
+    struct packet_index_header source;
+    struct packet_index * p_index = NULL;
+    FILE * fp = fopen(psz_path, "rb");
+    if (NULL == fp)
+        return NULL;
+    if (1 == fread(&header, sizeof(header), 1, fp)
+            && get_source(psz_source_path, &source)
+            && PACKET_INDEX_MAGIC == header.magic_
+            && PACKET_INDEX_VERSION == header.version_
+            && source.source_size_ == header.source_size_
+            && source.source_mtime_ == header.source_mtime_
+            && frames_per_packet == header.frames_per_packet_
+            && 0 != header.block_align_
+            && header.packets_count_ <= header.source_size_ / ((uint64_t)frames_per_packet * header.block_align_))
+    {
+        p_index = index_create(header.packets_count_);
+        if (NULL != p_index)
+        {
+            p_index->header_ = header;
+            if (header.packets_count_ != fread(p_index->p_entries_, sizeof(struct packet_index_entry), (size_t)header.packets_count_, fp))
+            {
+                packet_index_destroy(p_index);
+                p_index = NULL;
+            }
+        }
+    }
+    fclose(fp);
+    if (NULL == p_index)
+        debug_log_info(DEBUG_CATEGORY_SENDER, "%s %4.4u : %s is stale or malformed", __FILE__, __LINE__, psz_path);
+    return p_index;
+}
+
+struct packet_index * packet_index_open(char const * psz_source_path, struct wave_reader const * p_reader, uint32_t frames_per_packet)
+{
+    struct packet_index * p_index;
+    size_t const path_size = strlen(psz_source_path) + sizeof(PACKET_INDEX_SUFFIX);
+    char * psz_path = (char *)malloc(path_size);
+    if (NULL == psz_path)
+        return NULL;
+    snprintf(psz_path, path_size, "%s%s", psz_source_path, PACKET_INDEX_SUFFIX);
+    p_index = packet_index_load(psz_path, psz_source_path, frames_per_packet);
+    if (NULL == p_index)
+    {
+        p_index = packet_index_build(p_reader, frames_per_packet);
+        if (NULL != p_index && !packet_index_save(p_index, psz_path, psz_source_path))
+            debug_log_warning(DEBUG_CATEGORY_SENDER, "%s %4.4u : index kept in the memory only", __FILE__, __LINE__);
+    }
+    free(psz_path);
+    return p_index;
+}
+
+uint64_t packet_index_get_count(struct packet_index const * p_index)
+{
+    return p_index->header_.packets_count_;
+}
+
+uint32_t packet_index_get_frames_per_packet(struct packet_index const * p_index)
+{
+    return p_index->header_.frames_per_packet_;
+}
+
+struct packet_index_entry const * packet_index_get(struct packet_index const * p_index, uint64_t packet)
+{
+    return packet < p_index->header_.packets_count_ ? &p_index->p_entries_[packet] : NULL;
+}
+
+uint64_t packet_index_find(struct packet_index const * p_index, uint64_t timestamp)
+{
+    /* All the packets have the same number of frames. */
+    return min(timestamp / p_index->header_.frames_per_packet_, p_index->header_.packets_count_);
+}
+
+void packet_index_destroy(struct packet_index * p_index)
+{
+    if (NULL != p_index)
+    {
+        free(p_index->p_entries_);
+        free(p_index);
+    }
+}
@@ -0,0 +1,165 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+
+/**
+ * @file packet-index.h
+ * @brief Index of the packets of a prerecorded WAV file.
+ * @details Maps the packet number to the offset in the file and to the media time, so that the sender can start at any packet without walking the file. The index is cached beside the WAV file.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+#if !defined PACKET_INDEX_H_E6CD0D74_BD89_48AA_B5B1_A5EBB1E73A18
+#define PACKET_INDEX_H_E6CD0D74_BD89_48AA_B5B1_A5EBB1E73A18
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+#include "std-int.h"
+#include <stddef.h>
+
+/*!
+ * @brief First four bytes of an index file. Written in the host byte order, so a file from a host of the other
+ * byte order is rejected and built again.
+ */
+#define PACKET_INDEX_MAGIC (0x58444950u)
+
+/*!
+ * @brief Version of the file layout.
+ */
+#define PACKET_INDEX_VERSION (1)
+
+/*!
+ * @brief Appended to the path of the WAV file to get the path of its index.
+ */
+#define PACKET_INDEX_SUFFIX ".idx"
+
+/*!
+ * @brief Header of the index file, followed by the entries.
+ * @details The size and the modification time of the WAV file are kept, so that an index of an older version
+ * of the file is not used.
+ */
+struct packet_index_header {
+    uint32_t magic_; /*!< PACKET_INDEX_MAGIC. */
+    uint32_t version_; /*!< PACKET_INDEX_VERSION. */
+    uint64_t source_size_; /*!< Size of the WAV file. */
+    int64_t source_mtime_; /*!< Modification time of the WAV file, in seconds since the epoch. */
+    uint32_t frames_per_packet_; /*!< Number of frames in each packet. */
+    uint32_t block_align_; /*!< Size of a frame, in bytes. */
+    uint64_t packets_count_; /*!< Number of entries that follow. */
+};
+
+/*!
+ * @brief Describes a single packet.
+ */
+struct packet_index_entry {
+    uint64_t offset_; /*!< Offset of the first frame of the packet in the WAV file. */
+    uint64_t timestamp_; /*!< Media time of the packet, i.e. index of its first frame. */
+};
+
+/*!
+ * @brief Forward declaration.
+ */
+struct wave_reader;
+
+/*!
+ * @brief Forward declaration.
+ */
+struct packet_index;
+
+/*!
+ * @brief Builds the index in the memory.
+ * @details Only whole packets are indexed, the frames after the last one are left out.
+ * @param[in] p_reader the WAV file.
+ * @param[in] frames_per_packet number of frames in each packet.
+ * @return returns a handle to the index, or NULL if it could not be built.
+ */
+struct packet_index * packet_index_build(struct wave_reader const * p_reader, uint32_t frames_per_packet);
+
+/*!
+ * @brief Writes the index to a file.
+ * @param[in] p_index a handle to the index.
+ * @param[in] psz_path path of the file.
+ * @param[in] psz_source_path path of the WAV file the index was built from, to record its size and time.
+ * @return returns non-zero on success, 0 otherwise.
+ */
+int packet_index_save(struct packet_index const * p_index, char const * psz_path, char const * psz_source_path);
+
+/*!
+ * @brief Reads the index from a file.
+ * @details The index is rejected if the WAV file has changed since, or if it has a different number of frames per packet.
+ * @param[in] psz_path path of the file.
+ * @param[in] psz_source_path path of the WAV file the index was built from.
+ * @param[in] frames_per_packet number of frames in each packet.
+ * @return returns a handle to the index, or NULL if there is no usable index.
+ */
+struct packet_index * packet_index_load(char const * psz_path, char const * psz_source_path, uint32_t frames_per_packet);
+
+/*!
+ * @brief Reads the index kept beside the WAV file, or builds it and writes it there.
+ * @details The index is kept in the file named as the WAV file with PACKET_INDEX_SUFFIX appended. Failing to write
+ * it is not an error, the index is used from the memory.
+ * @param[in] psz_source_path path of the WAV file.
+ * @param[in] p_reader the WAV file.
+ * @param[in] frames_per_packet number of frames in each packet.
+ * @return returns a handle to the index, or NULL if it could not be built.
+ */
+struct packet_index * packet_index_open(char const * psz_source_path, struct wave_reader const * p_reader, uint32_t frames_per_packet);
+
+/*!
+ * @brief Returns number of packets.
+ * @param[in] p_index a handle to the index.
+ */
+uint64_t packet_index_get_count(struct packet_index const * p_index);
+
+/*!
+ * @brief Returns number of frames in each packet.
+ * @param[in] p_index a handle to the index.
+ */
+uint32_t packet_index_get_frames_per_packet(struct packet_index const * p_index);
+
+/*!
+ * @brief Returns the given packet.
+ * @param[in] p_index a handle to the index.
+ * @param[in] packet number of the packet.
+ * @return returns the entry, or NULL if there is no such packet.
+ */
+struct packet_index_entry const * packet_index_get(struct packet_index const * p_index, uint64_t packet);
+
+/*!
+ * @brief Finds the packet that plays at the given media time.
+ * @param[in] p_index a handle to the index.
+ * @param[in] timestamp media time, in frames.
+ * @return returns number of the packet, the number of packets if the time is past the last one.
+ */
+uint64_t packet_index_find(struct packet_index const * p_index, uint64_t timestamp);
+
+/*!
+ * @brief Destroys the index.
+ * @param[in] p_index a handle to the index obtained via call to packet_index_build, packet_index_load or packet_index_open.
+ */
+void packet_index_destroy(struct packet_index * p_index);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* PACKET_INDEX_H_E6CD0D74_BD89_48AA_B5B1_A5EBB1E73A18 */
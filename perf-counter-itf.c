@@ -29,100 +29,161 @@
 
 #include "pcc.h"
 #include "perf-counter-itf.h"
+#include "latency-histogram.h"
+#include "debug_helpers.h"
 
 /*!
- * @brief The exponent of the maximum number of items to be stored in the counter.
+ * @brief Number of back to back timer reads used to calibrate the overhead of the measurement.
  */
-#define MAX_PERF_ITEMS_LOG (7)
+#define CALIBRATION_ROUNDS (16)
 
 /*!
- * @brief The maximum number of items of items to be stored in the counter. This needs to be a power of 2.
+ * @brief Defines a complete performance meausrement. 
+ * @details Holds the timestamp of the last mark_before call, and the histogram of all the durations measured. 
+ * It holds the values of the overhead it take to perform the performance measurement itself. Finally, it has the frequence of the performance counter
+ * which is needed to calculate wall time it takes to execute the profiled code segment. 
  */
-#define MAX_PERF_ITEMS (2<<MAX_PERF_ITEMS_LOG)
+struct perf_counter {
+    int64_t before_; /*!< Timestamp taken <b>before</b> measured code segment. */
+    int64_t overhead_; /*!< Overhead of the performance measuerment. */
+    int64_t freq_; /*!< Frequence of the performance measurement timer. */
+    struct latency_histogram histogram_; /*!< Durations of all the measurements, in timer ticks. */
+};
 
 /*!
- * @brief Defines a single performance meausrement. 
- * @details Holds the performance counter measured before and after the profiled code segment. To get the duration it took to execute
- * the profiled code segment, subtract before_ from after_.
+ * @brief Reads the timer.
  */
-struct perf_data_item {
-    /*!
-     * @brief Timestamp taken <b>before</b> measured code segment.
-     */
-    _int64  before_; 
-    /*!
-     * @brief Timestamp taken <b>after</b> measured code segment.
-     */
-    _int64  after_;
-};
+static int64_t get_ticks(void)
+{
+#if defined WIN32
+    LARGE_INTEGER ticks;
+    QueryPerformanceCounter(&ticks);
+    return ticks.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+static int64_t get_frequency(void)
+{
+#if defined WIN32
+    LARGE_INTEGER freq;
+    QueryPerformanceFrequency(&freq);
+    return freq.QuadPart;
+#else
+    return 1000000000;
+#endif
+}
 
 /*!
- * @brief Defines a complete performance meausrement. 
- * @details Holds the performance counter values measured by all the calls that marked the beginning and the end of the measurement. 
- * It holds the values of the overhead it take to perform the performance measurement itself. Finally, it has the frequence of the performance counter
- * which is needed to calculate wall time it takes to execute the profiled code segment. 
+ * @brief Converts timer ticks to nanoseconds.
  */
-struct perf_counter {
-    size_t items_count_; /*!< Number of performence measurements. */
-    _int64 overhead_; /*!< Overhead of the performance measuerment. */
-    _int64 freq_; /*!< Frequence of the performance measurement timer. */
-    struct perf_data_item perf_table_[MAX_PERF_ITEMS]; /*!< Holds the performance measurements. */ 
-};
+static uint64_t ticks_to_ns(struct perf_counter const * p_counter, uint64_t ticks)
+{
+    return (uint64_t)((double)ticks * 1e9 / p_counter->freq_);
+}
 
 struct perf_counter * perf_counter_create(void)
 {
-    struct perf_counter * p_counter = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(struct perf_counter));
+    struct perf_counter * p_counter = (struct perf_counter *)calloc(1, sizeof(struct perf_counter));
     if (NULL != p_counter)
     {
-        _int64 before, after;
-        QueryPerformanceCounter((LARGE_INTEGER*)&before);
-        QueryPerformanceCounter((LARGE_INTEGER*)&after);
-        p_counter->overhead_ = after - before;
-        QueryPerformanceFrequency((LARGE_INTEGER*)&p_counter->freq_);
+        unsigned int idx;
+        p_counter->freq_ = get_frequency();
+        /* The smallest difference is the cost of the timer read itself, the larger ones include preemption. */
+        for (idx = 0; idx < CALIBRATION_ROUNDS; ++idx)
+        {
+            int64_t before = get_ticks();
+            int64_t after = get_ticks();
+            if (0 == idx || after - before < p_counter->overhead_)
+                p_counter->overhead_ = after - before;
+        }
     }
     return p_counter;
 }
 
 void perf_counter_destroy(struct perf_counter * p_perf_data)
 {
-    HeapFree(GetProcessHeap(), 0, p_perf_data);
+    free(p_perf_data);
 }
 
-_int64 perf_counter_get_freq(struct perf_counter * p_counter)
+uint64_t perf_counter_get_monotonic_ns(void)
+{
+#if defined WIN32
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER now;
+    if (0 == frequency.QuadPart)
+        QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&now);
+    /* Split, so that the multiplication does not overflow. */
+    return (uint64_t)(now.QuadPart / frequency.QuadPart) * 1000000000ULL
+        + (uint64_t)(now.QuadPart % frequency.QuadPart) * 1000000000ULL / (uint64_t)frequency.QuadPart;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+#endif
+}
+
+int64_t perf_counter_get_freq(struct perf_counter const * p_counter)
 {
     return p_counter->freq_;
 }
 
 void perf_counter_mark_before(struct perf_counter * p_counter)
 {
-    size_t item_idx = p_counter->items_count_ & (MAX_PERF_ITEMS-1);
-    assert(item_idx < MAX_PERF_ITEMS);
-    QueryPerformanceCounter((LARGE_INTEGER*)&p_counter->perf_table_[item_idx].before_);
+    p_counter->before_ = get_ticks();
 }
 
 void perf_counter_mark_after(struct perf_counter * p_counter)
 {
-    size_t item_idx = p_counter->items_count_ & (MAX_PERF_ITEMS-1);
-    assert(item_idx < MAX_PERF_ITEMS);
-    QueryPerformanceCounter((LARGE_INTEGER*)&p_counter->perf_table_[item_idx].after_);
-    ++p_counter->items_count_;
+    int64_t duration = get_ticks() - p_counter->before_ - p_counter->overhead_;
+    latency_histogram_record(&p_counter->histogram_, duration > 0 ? (uint64_t)duration : 0);
 }
 
-int perf_counter_get_duration(struct perf_counter * p_counter, _int64 * p_total, _int64 * p_avg)
+int perf_counter_get_duration(struct perf_counter const * p_counter, int64_t * p_total, int64_t * p_avg)
 {
-    size_t idx;
-    size_t items_count = p_counter->items_count_;
-    if (0 == items_count)
+    if (0 == p_counter->histogram_.count_)
         return 0;
-    if (p_counter->items_count_ > MAX_PERF_ITEMS) 
-        items_count = MAX_PERF_ITEMS;        
-    *p_total = 0;
-    *p_avg = 0;
-    for (idx = 0; idx < items_count; ++idx)
-    {
-        *p_total += p_counter->perf_table_[idx].after_ - p_counter->perf_table_[idx].before_ - p_counter->overhead_; 
-    }
-    *p_avg = *p_total/items_count;
+    *p_total = (int64_t)p_counter->histogram_.sum_;
+    *p_avg = (int64_t)latency_histogram_get_mean(&p_counter->histogram_);
     return 1;
 } 
 
+int perf_counter_get_stats(struct perf_counter const * p_counter, struct perf_counter_stats * p_stats)
+{
+    struct latency_histogram const * p_histogram = &p_counter->histogram_;
+    if (0 == p_histogram->count_)
+        return 0;
+    p_stats->count_ = p_histogram->count_;
+    p_stats->min_ = ticks_to_ns(p_counter, p_histogram->min_);
+    p_stats->mean_ = ticks_to_ns(p_counter, latency_histogram_get_mean(p_histogram));
+    p_stats->p50_ = ticks_to_ns(p_counter, latency_histogram_get_percentile(p_histogram, 50.0));
+    p_stats->p99_ = ticks_to_ns(p_counter, latency_histogram_get_percentile(p_histogram, 99.0));
+    p_stats->p999_ = ticks_to_ns(p_counter, latency_histogram_get_percentile(p_histogram, 99.9));
+    p_stats->max_ = ticks_to_ns(p_counter, p_histogram->max_);
+    return 1;
+}
+
+void perf_counter_dump(struct perf_counter const * p_counter, char const * psz_name)
+{
+    struct perf_counter_stats stats;
+    if (perf_counter_get_stats(p_counter, &stats))
+    {
+        debug_outputln("%s %4.4u : %s n:%lu min:%.1f mean:%.1f p50:%.1f p99:%.1f p99.9:%.1f max:%.1f [us]", __FILE__, __LINE__, psz_name,
+                (unsigned long)stats.count_,
+                stats.min_ / 1000.0,
+                stats.mean_ / 1000.0,
+                stats.p50_ / 1000.0,
+                stats.p99_ / 1000.0,
+                stats.p999_ / 1000.0,
+                stats.max_ / 1000.0);
+    }
+}
+
+void perf_counter_reset(struct perf_counter * p_counter)
+{
+    latency_histogram_reset(&p_counter->histogram_);
+}
@@ -7,7 +7,9 @@
  * instruction on how to use this functions:
  * \li Create a performance counter object.
  * \li In the piece of code you want to query performance of - call perf_counter_mark_before() before the timed piece of code execution and then perf_counter_mark_after() after the piece of code.
- * \li After this code has been executed enough number of times, call perf_counter_get_average_duration() to get average time (in clock ticks) it took to execute the code.
+ * \li After this code has been executed enough number of times, call perf_counter_get_duration() to get average time (in clock ticks) it took to execute the code,
+ * or perf_counter_get_stats() to get the distribution of the durations, in nanoseconds.
+ * On Windows the timer is QueryPerformanceCounter(), elsewhere it is clock_gettime(CLOCK_MONOTONIC).
  * @author T.Ostaszewski
  * @date 04-Jan-2012
  * @par License
@@ -37,14 +39,33 @@
 #if defined __cplusplus
 extern "C" {
 #endif
-#include <windows.h>
+#if defined WIN32
+#   include <windows.h>
+#endif
 #include <stdlib.h>
 #include <stddef.h>
+#include "std-int.h"
 
 struct perf_counter;
 
+/*!
+ * @brief Summary of the durations measured by the performance counter.
+ * @details All the durations are in nanoseconds, with the overhead of the measurement itself subtracted.
+ * The percentiles come from a log-linear histogram, so they are exact to within 1/16 of their value.
+ */
+struct perf_counter_stats {
+    uint64_t count_; /*!< Number of measurements. */
+    uint64_t min_; /*!< Shortest duration. */
+    uint64_t mean_; /*!< Average duration. */
+    uint64_t p50_; /*!< Median duration. */
+    uint64_t p99_; /*!< 99th percentile of the durations. */
+    uint64_t p999_; /*!< 99.9th percentile of the durations. */
+    uint64_t max_; /*!< Longest duration. */
+};
+
 /*!
  * @brief Creates a performance measurement object.
+ * @details The overhead of reading the timer is calibrated here, and is subtracted from each measurement.
  * @return On success, returns a handle to the performance measurement object. On failure, returns NULL.
  * @sa perf_counter_destroy
  */
@@ -60,6 +81,7 @@ void perf_counter_destroy(struct perf_counter * p_counter);
 /*!
  * @brief Marks the beginning of the measurement of the profiled code segment.
  * @param[in] p_counter handle to the performence measurement object, obtained via call to perf_counter_create().
+ * @attention The counter is not thread safe; each thread shall measure with its own counter.
  */
 void perf_counter_mark_before(struct perf_counter * p_counter);
 
@@ -80,7 +102,7 @@ void perf_counter_mark_after(struct perf_counter * p_counter);
  * via call to perf_counter_get_freq().
  * @sa perf_counter_get_freq
  */
-int perf_counter_get_duration(struct perf_counter * p_counter, _int64 * p_total, _int64 * p_avg);
+int perf_counter_get_duration(struct perf_counter const * p_counter, int64_t * p_total, int64_t * p_avg);
 
 /*!
  * @brief Returns the frequency of the timer used for performance measurement.
@@ -88,7 +110,36 @@ int perf_counter_get_duration(struct perf_counter * p_counter, _int64 * p_total,
  * @return returns the frequency of the timer used for performance measurement.
  * @sa perf_counter_get_duration
  */
-_int64 perf_counter_get_freq(struct perf_counter * p_counter);
+int64_t perf_counter_get_freq(struct perf_counter const * p_counter);
+
+/*!
+ * @brief Gets the minimum, mean, percentiles and maximum of the measured durations.
+ * @param[in] p_counter handle to the performence measurement object, obtained via call to perf_counter_create().
+ * @param[out] p_stats this structure will be written with the summary.
+ * @return Returns a non-zero value on success, 0 if no measurement has been taken yet.
+ */
+int perf_counter_get_stats(struct perf_counter const * p_counter, struct perf_counter_stats * p_stats);
+
+/*!
+ * @brief Writes the summary of the measured durations to the debug output, in microseconds.
+ * @param[in] p_counter handle to the performence measurement object, obtained via call to perf_counter_create().
+ * @param[in] psz_name name of the profiled code segment, to tell the lines apart.
+ */
+void perf_counter_dump(struct perf_counter const * p_counter, char const * psz_name);
+
+/*!
+ * @brief Discards all the measurements taken so far.
+ * @param[in] p_counter handle to the performence measurement object, obtained via call to perf_counter_create().
+ */
+void perf_counter_reset(struct perf_counter * p_counter);
+
+/*!
+ * @brief Returns the time of the timer the measurements are taken with, in nanoseconds.
+ * @details The timer is monotonic, so it does not jump when the wall clock is set, and its origin is arbitrary.
+ * On Linux this is CLOCK_MONOTONIC, so the values can be passed as clock_nanosleep() deadlines.
+ * @return returns the current time, in nanoseconds.
+ */
+uint64_t perf_counter_get_monotonic_ns(void);
 
 #if defined __cplusplus
 }
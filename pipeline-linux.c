@@ -0,0 +1,404 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file pipeline-linux.c
+ * @brief Multi-stage pipeline of the audio processing, the Linux implementation.
+ * @details The stages are linked by spsc rings, and the threads sleep on an eventfd when their ring is empty.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include "pipeline.h"
+#include "spsc-ring.h"
+#include "thread-sched.h"
+#include "debug_helpers.h"
+#include "perf-counter-itf.h"
+
+/*!
+ * @brief How long the producer sleeps while the ring is full, in nanoseconds.
+ */
+#define PIPELINE_BLOCK_SLEEP (100000)
+
+/*!
+ * @brief What precedes each message in the ring.
+ */
+struct pipeline_message {
+    uint64_t queued_; /*!< When the message was put into the ring, in nanoseconds of the monotonic clock. */
+    uint64_t size_; /*!< Size of the message that follows, in bytes. */
+};
+
+/*!
+ * @brief A single stage.
+ */
+struct pipeline_stage {
+    struct pipeline_stage_config config_; /*!< The description. */
+    struct spsc_ring * p_ring_; /*!< Feeds the stage, NULL for the inline stages. */
+    int wake_fd_; /*!< Signalled when a message is put into an empty ring, or when the thread is to stop. */
+    int waiting_; /*!< Non-zero while the consumer of the ring is about to sleep, or sleeps, on wake_fd_. */
+    int stop_; /*!< Tells the thread to finish, once the ring is empty. */
+    pthread_t thread_; /*!< The thread, PIPELINE_THREAD only. */
+    int started_; /*!< Non-zero once the thread is running. */
+    uint8_t * p_output_; /*!< Where the stage writes the messages for the next stage, if that one is inline. */
+    struct pipeline * p_pipeline_; /*!< The pipeline the stage belongs to. */
+    unsigned int index_; /*!< Index of the stage in the pipeline. */
+    struct pipeline_stage_stats stats_; /*!< What has been done so far. */
+};
+
+/*!
+ * @brief The pipeline.
+ */
+struct pipeline {
+    unsigned int stages_count_; /*!< Number of the stages. */
+    struct pipeline_stage stages_[PIPELINE_MAX_STAGES]; /*!< The stages. */
+};
+
+/*!
+ * @brief Wakes the consumer of the ring up, if it sleeps.
+ * @details The fences on both sides make sure that either the consumer sees the message, or the producer sees it waiting.
+ */
+static void wake_consumer(struct pipeline_stage * p_stage)
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&p_stage->waiting_, __ATOMIC_RELAXED))
+    {
+        uint64_t one = 1;
+        if (sizeof(one) != write(p_stage->wake_fd_, &one, sizeof(one)))
+            debug_log_warning(DEBUG_CATEGORY_AUDIO, "%s %4.4u : %s not woken %d %s", __FILE__, __LINE__, p_stage->config_.psz_name_, errno, strerror(errno));
+    }
+}
+
+/*!
+ * @brief Sleeps until there is a message in the ring, or the thread is to stop.
+ */
+static void wait_for_message(struct pipeline_stage * p_stage)
+{
+    __atomic_store_n(&p_stage->waiting_, 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (0 == spsc_ring_get_count(p_stage->p_ring_) && !__atomic_load_n(&p_stage->stop_, __ATOMIC_ACQUIRE))
+    {
+        uint64_t count;
+        while (sizeof(count) != read(p_stage->wake_fd_, &count, sizeof(count)) && EINTR == errno)
+            ;
+    }
+    __atomic_store_n(&p_stage->waiting_, 0, __ATOMIC_RELAXED);
+}
+
+/*!
+ * @brief Takes the slot of the ring the next message of the stage goes to, waiting for it or dropping the message as configured.
+ * @return returns the slot, or NULL if the message is to be dropped.
+ */
+static struct pipeline_message * acquire_slot(struct pipeline_stage * p_stage)
+{
+    struct pipeline_message * p_message = (struct pipeline_message *)spsc_ring_begin_write(p_stage->p_ring_);
+    if (NULL == p_message)
+    {
+        if (PIPELINE_DROP == p_stage->config_.overflow_)
+        {
+            ++p_stage->stats_.dropped_;
+            return NULL;
+        }
+        /* Rare enough for sleeping to do, so the consumer never has to signal the producer. */
+        ++p_stage->stats_.blocked_;
+        while (NULL == (p_message = (struct pipeline_message *)spsc_ring_begin_write(p_stage->p_ring_)))
+        {
+            struct timespec pause = { 0, PIPELINE_BLOCK_SLEEP };
+            nanosleep(&pause, NULL);
+        }
+    }
+    return p_message;
+}
+
+/*!
+ * @brief Puts the message written to the slot into the ring.
+ */
+static void commit_slot(struct pipeline_stage * p_stage, struct pipeline_message * p_message, size_t size)
+{
+    unsigned int queued;
+    p_message->queued_ = perf_counter_get_monotonic_ns();
+    p_message->size_ = size;
+    spsc_ring_commit_write(p_stage->p_ring_);
+    queued = spsc_ring_get_count(p_stage->p_ring_);
+    if (queued > p_stage->stats_.max_queued_)
+        p_stage->stats_.max_queued_ = queued;
+    wake_consumer(p_stage);
+}
+
+/*!
+ * @brief Runs the stage on a single message, and hands its output on.
+ * @param[in] queued when the message was put into the ring, or 0 if it has not been through one.
+ */
+static void run_stage(struct pipeline_stage * p_stage, void const * p_input, size_t input_size, uint64_t queued)
+{
+    struct pipeline_stage * p_next = NULL;
+    struct pipeline_message * p_message = NULL;
+    void * p_output = NULL;
+    uint64_t start = perf_counter_get_monotonic_ns();
+    size_t output_size;
+    if (0 != queued)
+        latency_histogram_record(&p_stage->stats_.wait_, start - queued);
+    if (p_stage->index_ + 1 < p_stage->p_pipeline_->stages_count_)
+    {
+        p_next = &p_stage->p_pipeline_->stages_[p_stage->index_ + 1];
+        if (PIPELINE_INLINE == p_next->config_.mode_)
+            p_output = p_stage->p_output_;
+        else
+        {
+            /* Written straight into the ring, so a full ring is known before anything is processed. */
+            p_message = acquire_slot(p_next);
+            if (NULL == p_message)
+                return;
+            p_output = p_message + 1;
+        }
+    }
+    /* Waiting for the slot is the stage after's fault, so it is left out of the service time. */
+    start = perf_counter_get_monotonic_ns();
+    output_size = (*p_stage->config_.process_)(p_stage->config_.p_context_, p_input, input_size, p_output);
+    latency_histogram_record(&p_stage->stats_.service_, perf_counter_get_monotonic_ns() - start);
+    ++p_stage->stats_.messages_;
+    assert(NULL == p_next || output_size <= p_next->config_.input_size_);
+    if (NULL == p_next || 0 == output_size)
+        return;
+    if (NULL == p_message)
+        run_stage(p_next, p_output, output_size, 0);
+    else
+        commit_slot(p_next, p_message, output_size);
+}
+
+/*!
+ * @brief Runs the stage on all the messages in its ring.
+ * @return returns number of the messages processed.
+ */
+static unsigned int drain_ring(struct pipeline_stage * p_stage)
+{
+    struct pipeline_message const * p_message;
+    unsigned int count = 0;
+    while (NULL != (p_message = (struct pipeline_message const *)spsc_ring_begin_read(p_stage->p_ring_)))
+    {
+        run_stage(p_stage, p_message + 1, (size_t)p_message->size_, p_message->queued_);
+        spsc_ring_commit_read(p_stage->p_ring_);
+        ++count;
+    }
+    return count;
+}
+
+static void * stage_thread(void * p_param)
+{
+    struct pipeline_stage * p_stage = (struct pipeline_stage *)p_param;
+    if (p_stage->config_.role_ >= 0)
+    {
+        struct thread_sched_result sched;
+        thread_sched_apply_from_env(p_stage->config_.role_, &sched);
+    }
+    for (;;)
+    {
+        drain_ring(p_stage);
+        /* Stopped only with the ring empty, and nothing is put into it once the stage before is stopped. */
+        if (__atomic_load_n(&p_stage->stop_, __ATOMIC_ACQUIRE) && 0 == spsc_ring_get_count(p_stage->p_ring_))
+            break;
+        wait_for_message(p_stage);
+    }
+    return NULL;
+}
+
+/*!
+ * @brief Checks that the stages can be put together.
+ */
+static int check_stages(struct pipeline_stage_config const * p_stages, unsigned int stages_count)
+{
+    unsigned int idx;
+    if (0 == stages_count || stages_count > PIPELINE_MAX_STAGES)
+        return 0;
+    for (idx = 0; idx < stages_count; ++idx)
+    {
+        struct pipeline_stage_config const * p_config = &p_stages[idx];
+        if (NULL == p_config->process_ || 0 == p_config->input_size_)
+            return 0;
+        if (PIPELINE_INLINE != p_config->mode_ && PIPELINE_THREAD != p_config->mode_ && PIPELINE_EXTERNAL != p_config->mode_)
+            return 0;
+        if (PIPELINE_EXTERNAL == p_config->mode_ && idx + 1 != stages_count)
+            return 0;
+    }
+    return 1;
+}
+
+struct pipeline * pipeline_create(struct pipeline_stage_config const * p_stages, unsigned int stages_count)
+{
+    struct pipeline * p_pipeline;
+    unsigned int idx;
+    if (!check_stages(p_stages, stages_count))
+        return NULL;
+    p_pipeline = (struct pipeline *)calloc(1, sizeof(struct pipeline));
+    if (NULL == p_pipeline)
+        return NULL;
+    p_pipeline->stages_count_ = stages_count;
+    for (idx = 0; idx < stages_count; ++idx)
+    {
+        struct pipeline_stage * p_stage = &p_pipeline->stages_[idx];
+        p_stage->config_ = p_stages[idx];
+        p_stage->p_pipeline_ = p_pipeline;
+        p_stage->index_ = idx;
+        p_stage->wake_fd_ = -1;
+        latency_histogram_reset(&p_stage->stats_.wait_);
+        latency_histogram_reset(&p_stage->stats_.service_);
+    }
+    for (idx = 0; idx < stages_count; ++idx)
+    {
+        struct pipeline_stage * p_stage = &p_pipeline->stages_[idx];
+        if (idx + 1 < stages_count && PIPELINE_INLINE == p_stages[idx + 1].mode_)
+        {
+            p_stage->p_output_ = (uint8_t *)malloc(p_stages[idx + 1].input_size_);
+            if (NULL == p_stage->p_output_)
+                break;
+        }
+        if (PIPELINE_INLINE != p_stage->config_.mode_)
+        {
+            p_stage->p_ring_ = spsc_ring_create(p_stage->config_.ring_slots_, sizeof(struct pipeline_message) + p_stage->config_.input_size_);
+            /* The external stage is serviced from a select loop, so its descriptor is signalled for every message. */
+            p_stage->wake_fd_ = eventfd(0, EFD_CLOEXEC | (PIPELINE_EXTERNAL == p_stage->config_.mode_ ? EFD_NONBLOCK : 0));
+            p_stage->waiting_ = PIPELINE_EXTERNAL == p_stage->config_.mode_;
+            if (NULL == p_stage->p_ring_ || p_stage->wake_fd_ < 0)
+            {
+                debug_log_error(DEBUG_CATEGORY_AUDIO, "%s %4.4u : no ring for %s %d %s", __FILE__, __LINE__, p_stage->config_.psz_name_, errno, strerror(errno));
+                break;
+            }
+        }
+    }
+    if (idx < stages_count)
+    {
+        pipeline_destroy(p_pipeline);
+        return NULL;
+    }
+    for (idx = 0; idx < stages_count; ++idx)
+    {
+        struct pipeline_stage * p_stage = &p_pipeline->stages_[idx];
+        int result;
+        if (PIPELINE_THREAD != p_stage->config_.mode_)
+            continue;
+        result = pthread_create(&p_stage->thread_, NULL, &stage_thread, p_stage);
+        if (0 != result)
+        {
+            debug_log_error(DEBUG_CATEGORY_AUDIO, "%s %4.4u : no thread for %s %d", __FILE__, __LINE__, p_stage->config_.psz_name_, result);
+            pipeline_destroy(p_pipeline);
+            return NULL;
+        }
+        p_stage->started_ = 1;
+    }
+    return p_pipeline;
+}
+
+int pipeline_push(struct pipeline * p_pipeline, void const * p_data, size_t data_size)
+{
+    struct pipeline_stage * p_stage = &p_pipeline->stages_[0];
+    struct pipeline_message * p_message;
+    assert(data_size <= p_stage->config_.input_size_);
+    if (PIPELINE_INLINE == p_stage->config_.mode_)
+    {
+        run_stage(p_stage, p_data, data_size, 0);
+        return 1;
+    }
+    p_message = acquire_slot(p_stage);
+    if (NULL == p_message)
+        return 0;
+    memcpy(p_message + 1, p_data, data_size);
+    commit_slot(p_stage, p_message, data_size);
+    return 1;
+}
+
+int pipeline_get_fd(struct pipeline const * p_pipeline)
+{
+    struct pipeline_stage const * p_stage = &p_pipeline->stages_[p_pipeline->stages_count_ - 1];
+    return PIPELINE_EXTERNAL == p_stage->config_.mode_ ? p_stage->wake_fd_ : -1;
+}
+
+unsigned int pipeline_service(struct pipeline * p_pipeline)
+{
+    struct pipeline_stage * p_stage = &p_pipeline->stages_[p_pipeline->stages_count_ - 1];
+    uint64_t count;
+    if (PIPELINE_EXTERNAL != p_stage->config_.mode_)
+        return 0;
+    /* Cleared first, so that a message put into the ring while it is drained signals the descriptor again. */
+    while (sizeof(count) == read(p_stage->wake_fd_, &count, sizeof(count)))
+        ;
+    return drain_ring(p_stage);
+}
+
+void pipeline_get_stats(struct pipeline const * p_pipeline, unsigned int stage, struct pipeline_stage_stats * p_stats)
+{
+    assert(stage < p_pipeline->stages_count_);
+    *p_stats = p_pipeline->stages_[stage].stats_;
+}
+
+void pipeline_dump(FILE * fp, struct pipeline const * p_pipeline)
+{
+    unsigned int idx;
+    for (idx = 0; idx < p_pipeline->stages_count_; ++idx)
+    {
+        struct pipeline_stage const * p_stage = &p_pipeline->stages_[idx];
+        struct pipeline_stage_stats const * p_stats = &p_stage->stats_;
+        fprintf(fp, "%4.4u %s : %s messages %llu dropped %llu blocked %llu queued %u wait us %llu/%llu/%llu service us %llu/%llu/%llu\n", __LINE__, __func__,
+                p_stage->config_.psz_name_, (unsigned long long)p_stats->messages_, (unsigned long long)p_stats->dropped_,
+                (unsigned long long)p_stats->blocked_, p_stats->max_queued_,
+                (unsigned long long)latency_histogram_get_percentile(&p_stats->wait_, 50.0) / 1000,
+                (unsigned long long)latency_histogram_get_percentile(&p_stats->wait_, 99.0) / 1000,
+                (unsigned long long)p_stats->wait_.max_ / 1000,
+                (unsigned long long)latency_histogram_get_percentile(&p_stats->service_, 50.0) / 1000,
+                (unsigned long long)latency_histogram_get_percentile(&p_stats->service_, 99.0) / 1000,
+                (unsigned long long)p_stats->service_.max_ / 1000);
+    }
+}
+
+void pipeline_stop(struct pipeline * p_pipeline)
+{
+    unsigned int idx;
+    for (idx = 0; idx < p_pipeline->stages_count_; ++idx)
+    {
+        struct pipeline_stage * p_stage = &p_pipeline->stages_[idx];
+        if (p_stage->started_)
+        {
+            uint64_t one = 1;
+            __atomic_store_n(&p_stage->stop_, 1, __ATOMIC_RELEASE);
+            if (sizeof(one) != write(p_stage->wake_fd_, &one, sizeof(one)))
+                debug_log_warning(DEBUG_CATEGORY_AUDIO, "%s %4.4u : %s not woken %d %s", __FILE__, __LINE__, p_stage->config_.psz_name_, errno, strerror(errno));
+            pthread_join(p_stage->thread_, NULL);
+            p_stage->started_ = 0;
+        }
+    }
+}
+
+void pipeline_destroy(struct pipeline * p_pipeline)
+{
+    unsigned int idx;
+    if (NULL == p_pipeline)
+        return;
+    pipeline_stop(p_pipeline);
+    for (idx = 0; idx < p_pipeline->stages_count_; ++idx)
+    {
+        struct pipeline_stage * p_stage = &p_pipeline->stages_[idx];
+        if (p_stage->wake_fd_ >= 0)
+            close(p_stage->wake_fd_);
+        spsc_ring_destroy(p_stage->p_ring_);
+        free(p_stage->p_output_);
+    }
+    free(p_pipeline);
+}
@@ -0,0 +1,175 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+
+/**
+ * @file pipeline.h
+ * @brief Multi-stage pipeline of the audio processing.
+ * @details The stages are functions, each one either run inline by the stage before it or on a thread of its own, fed by a lock-free ring. The rings are bounded, so a stage that falls behind either holds the one before it back or has the messages dropped, and each stage keeps the latency of its queue and of its processing.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+#if !defined PIPELINE_H_A95C1A7C_711B_490D_94B8_4D362457D1E3
+#define PIPELINE_H_A95C1A7C_711B_490D_94B8_4D362457D1E3
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+#include "std-int.h"
+#include <stddef.h>
+#include <stdio.h>
+#include "latency-histogram.h"
+
+/*!
+ * @brief Maximum number of stages of a pipeline.
+ */
+#define PIPELINE_MAX_STAGES (8)
+
+/*!
+ * @brief The stage runs on the thread of the stage before it, or on the thread that pushes, if it is the first one.
+ */
+#define PIPELINE_INLINE (0)
+
+/*!
+ * @brief The stage runs on a thread of its own, fed by a ring.
+ */
+#define PIPELINE_THREAD (1)
+
+/*!
+ * @brief The stage is fed by a ring, and runs on whatever thread calls pipeline_service. The last stage only.
+ */
+#define PIPELINE_EXTERNAL (2)
+
+/*!
+ * @brief If the ring is full, the producer waits for the stage to catch up.
+ */
+#define PIPELINE_BLOCK (0)
+
+/*!
+ * @brief If the ring is full, the message is dropped, so the producer never waits.
+ */
+#define PIPELINE_DROP (1)
+
+/*!
+ * @brief Processes a single message.
+ * @param[in] p_context the context of the stage.
+ * @param[in] p_input the message, valid only during the call.
+ * @param[in] input_size size of the message, in bytes.
+ * @param[out] p_output where the message for the next stage is to be written, input_size_ bytes of the next
+ * stage at most. NULL for the last stage.
+ * @return returns size of the message written to p_output, 0 if there is nothing for the next stage.
+ */
+typedef size_t (*pipeline_stage_t)(void * p_context, void const * p_input, size_t input_size, void * p_output);
+
+/*!
+ * @brief Describes a single stage.
+ */
+struct pipeline_stage_config {
+    char const * psz_name_; /*!< Name of the stage, for the reports. */
+    pipeline_stage_t process_; /*!< Processes the messages. */
+    void * p_context_; /*!< Passed to process_. */
+    size_t input_size_; /*!< Largest message the stage takes, in bytes. */
+    int mode_; /*!< One of PIPELINE_INLINE, PIPELINE_THREAD or PIPELINE_EXTERNAL. */
+    unsigned int ring_slots_; /*!< Number of messages the ring feeding the stage holds, a power of 2. Not used by the inline stages. */
+    int overflow_; /*!< Either PIPELINE_BLOCK or PIPELINE_DROP, what is done when the ring is full. Not used by the inline stages. */
+    int role_; /*!< One of the THREAD_ROLE_* values the thread of the stage is scheduled as, or -1. PIPELINE_THREAD only. */
+};
+
+/*!
+ * @brief What a stage has done so far.
+ */
+struct pipeline_stage_stats {
+    uint64_t messages_; /*!< Number of messages processed. */
+    uint64_t dropped_; /*!< Number of messages dropped because the ring was full. */
+    uint64_t blocked_; /*!< Number of messages the producer had to wait with because the ring was full. */
+    unsigned int max_queued_; /*!< Largest number of messages waiting in the ring. */
+    struct latency_histogram wait_; /*!< Time the messages spent in the ring, in nanoseconds. Empty for the inline stages. */
+    struct latency_histogram service_; /*!< Time process_ took, in nanoseconds. */
+};
+
+/*!
+ * @brief Forward declaration.
+ */
+struct pipeline;
+
+/*!
+ * @brief Creates the pipeline and starts the threads of its stages.
+ * @param[in] p_stages the stages, in the order the messages go through them.
+ * @param[in] stages_count number of the stages, up to PIPELINE_MAX_STAGES.
+ * @return returns a handle to the pipeline, or NULL if the stages are malformed or creation failed.
+ */
+struct pipeline * pipeline_create(struct pipeline_stage_config const * p_stages, unsigned int stages_count);
+
+/*!
+ * @brief Hands a message to the first stage.
+ * @details Must be called from a single thread only. If the first stage is inline, it is run before the call returns.
+ * @param[in] p_pipeline a handle to the pipeline.
+ * @param[in] p_data the message, copied.
+ * @param[in] data_size size of the message, input_size_ of the first stage at most.
+ * @return returns non zero if the message has been taken, 0 if it has been dropped.
+ */
+int pipeline_push(struct pipeline * p_pipeline, void const * p_data, size_t data_size);
+
+/*!
+ * @brief Returns the descriptor that becomes readable when the PIPELINE_EXTERNAL stage has messages to process.
+ * @return returns the descriptor, or -1 if the last stage is not PIPELINE_EXTERNAL.
+ */
+int pipeline_get_fd(struct pipeline const * p_pipeline);
+
+/*!
+ * @brief Runs the PIPELINE_EXTERNAL stage on all the messages that are waiting for it.
+ * @details Must be called from a single thread only.
+ * @return returns number of the messages processed.
+ */
+unsigned int pipeline_service(struct pipeline * p_pipeline);
+
+/*!
+ * @brief Returns what the given stage has done so far.
+ * @details The counters are updated by the threads of the stages, so they are exact only once the pipeline is stopped.
+ */
+void pipeline_get_stats(struct pipeline const * p_pipeline, unsigned int stage, struct pipeline_stage_stats * p_stats);
+
+/*!
+ * @brief Prints the messages, drops and latencies of all the stages.
+ */
+void pipeline_dump(FILE * fp, struct pipeline const * p_pipeline);
+
+/*!
+ * @brief Stops the threads of the stages.
+ * @details The threads are stopped in the order of the stages, each one once it has processed all the messages
+ * already in its ring, so nothing that has been taken is lost, save for the messages the PIPELINE_EXTERNAL stage
+ * has not been serviced for. A PIPELINE_EXTERNAL stage that is not serviced while the pipeline is stopped should
+ * therefore use PIPELINE_DROP. Nothing may be pushed once the pipeline is stopped.
+ * @param[in] p_pipeline a handle to the pipeline.
+ */
+void pipeline_stop(struct pipeline * p_pipeline);
+
+/*!
+ * @brief Stops the threads, if they are still running, and destroys the pipeline.
+ * @param[in] p_pipeline a handle to the pipeline obtained via call to pipeline_create.
+ */
+void pipeline_destroy(struct pipeline * p_pipeline);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* PIPELINE_H_A95C1A7C_711B_490D_94B8_4D362457D1E3 */
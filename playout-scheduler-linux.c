@@ -0,0 +1,139 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file playout-scheduler-linux.c
+ * @brief Pull-mode playout clock, the Linux implementation.
+ * @details The clock is a periodic timerfd.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include <sys/timerfd.h>
+#include "playout-scheduler.h"
+#include "audio-sink.h"
+#include "debug_helpers.h"
+
+/*!
+ * @brief The scheduler.
+ */
+struct playout_scheduler {
+    struct audio_sink * p_sink_; /*!< Where the periods are written to. */
+    playout_scheduler_pull_t pull_; /*!< Where the periods are pulled from. */
+    void * p_context_; /*!< Passed to pull_. */
+    int timer_fd_; /*!< The periodic timer, one tick per period. */
+    size_t period_samples_; /*!< Number of samples in a period, of all the channels. */
+    struct playout_scheduler_stats stats_; /*!< What has been done so far. */
+    int16_t * p_period_; /*!< The period being written. */
+};
+
+/*!
+ * @brief Pulls a single period and writes it to the sink.
+ */
+static void play_period(struct playout_scheduler * p_scheduler)
+{
+    size_t frames = audio_sink_get_config(p_scheduler->p_sink_)->period_frames_;
+    size_t channels = audio_sink_get_config(p_scheduler->p_sink_)->channels_;
+    size_t pulled = p_scheduler->pull_(p_scheduler->p_context_, p_scheduler->p_period_, frames);
+    uint64_t latency;
+    if (pulled < frames)
+    {
+        memset(&p_scheduler->p_period_[pulled * channels], 0, (frames - pulled) * channels * sizeof(int16_t));
+        ++p_scheduler->stats_.underruns_;
+    }
+    if (!audio_sink_write_period(p_scheduler->p_sink_, p_scheduler->p_period_))
+        debug_log_warning(DEBUG_CATEGORY_AUDIO, "%s %4.4u : period %llu not written", __FILE__, __LINE__, (unsigned long long)p_scheduler->stats_.periods_);
+    ++p_scheduler->stats_.periods_;
+    latency = audio_sink_get_latency(p_scheduler->p_sink_);
+    if (latency > p_scheduler->stats_.max_latency_)
+        p_scheduler->stats_.max_latency_ = latency;
+}
+
+struct playout_scheduler * playout_scheduler_create(struct audio_sink * p_sink, playout_scheduler_pull_t pull, void * p_context)
+{
+    struct audio_sink_config const * p_config = audio_sink_get_config(p_sink);
+    uint64_t period_ns = (uint64_t)p_config->period_frames_ * 1000000000ULL / p_config->sample_rate_;
+    struct itimerspec period;
+    unsigned int idx;
+    struct playout_scheduler * p_scheduler = (struct playout_scheduler *)calloc(1, sizeof(struct playout_scheduler));
+    if (NULL == p_scheduler)
+        return NULL;
+    p_scheduler->p_sink_ = p_sink;
+    p_scheduler->pull_ = pull;
+    p_scheduler->p_context_ = p_context;
+    p_scheduler->period_samples_ = (size_t)p_config->period_frames_ * p_config->channels_;
+    p_scheduler->p_period_ = (int16_t *)calloc(p_scheduler->period_samples_, sizeof(int16_t));
+    /* CLOCK_MONOTONIC, the clock the sinks emulate their devices with. */
+    p_scheduler->timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (NULL == p_scheduler->p_period_ || p_scheduler->timer_fd_ < 0)
+    {
+        debug_log_error(DEBUG_CATEGORY_AUDIO, "%s %4.4u : no timer %d %s", __FILE__, __LINE__, errno, strerror(errno));
+        playout_scheduler_destroy(p_scheduler);
+        return NULL;
+    }
+    /* The device starts with its buffer full of silence, as the sound cards do. */
+    for (idx = 0; idx < p_config->periods_count_; ++idx)
+        audio_sink_write_period(p_sink, p_scheduler->p_period_);
+    period.it_interval.tv_sec = (time_t)(period_ns / 1000000000ULL);
+    period.it_interval.tv_nsec = (long)(period_ns % 1000000000ULL);
+    period.it_value = period.it_interval;
+    if (0 != timerfd_settime(p_scheduler->timer_fd_, 0, &period, NULL))
+    {
+        debug_log_error(DEBUG_CATEGORY_AUDIO, "%s %4.4u : timer not set %d %s", __FILE__, __LINE__, errno, strerror(errno));
+        playout_scheduler_destroy(p_scheduler);
+        return NULL;
+    }
+    return p_scheduler;
+}
+
+int playout_scheduler_get_fd(struct playout_scheduler const * p_scheduler)
+{
+    return p_scheduler->timer_fd_;
+}
+
+unsigned int playout_scheduler_service(struct playout_scheduler * p_scheduler)
+{
+    uint64_t expirations = 0;
+    uint64_t idx;
+    if (sizeof(expirations) != read(p_scheduler->timer_fd_, &expirations, sizeof(expirations)))
+        return 0;
+    /* A period the device has already started to play cannot be skipped, the pipeline catches up instead. */
+    p_scheduler->stats_.late_ += expirations - 1;
+    for (idx = 0; idx < expirations; ++idx)
+        play_period(p_scheduler);
+    return (unsigned int)expirations;
+}
+
+void playout_scheduler_get_stats(struct playout_scheduler const * p_scheduler, struct playout_scheduler_stats * p_stats)
+{
+    *p_stats = p_scheduler->stats_;
+}
+
+void playout_scheduler_destroy(struct playout_scheduler * p_scheduler)
+{
+    if (NULL != p_scheduler)
+    {
+        if (p_scheduler->timer_fd_ >= 0)
+            close(p_scheduler->timer_fd_);
+        free(p_scheduler->p_period_);
+        free(p_scheduler);
+    }
+}
@@ -0,0 +1,109 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+
+/**
+ * @file playout-scheduler.h
+ * @brief Pull-mode playout clock.
+ * @details Emulates the clock of a sound card, so that the whole receive, jitter, decode and playout pipeline runs at the real-time pace without audio hardware.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+#if !defined PLAYOUT_SCHEDULER_H_222BD025_A66D_4E2A_91B8_6F1A27874C1D
+#define PLAYOUT_SCHEDULER_H_222BD025_A66D_4E2A_91B8_6F1A27874C1D
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+#include "std-int.h"
+#include <stddef.h>
+
+/*!
+ * @brief Forward declaration.
+ */
+struct audio_sink;
+
+/*!
+ * @brief Forward declaration.
+ */
+struct playout_scheduler;
+
+/*!
+ * @brief Pulls the next period from the pipeline, e.g. from the mixer.
+ * @param[in] p_context the context given to playout_scheduler_create.
+ * @param[out] p_samples this buffer will be written with the interleaved samples of the period.
+ * @param[in] frames number of frames of the period.
+ * @return returns number of frames written. The rest of the period is filled with silence and counted as an underrun.
+ */
+typedef size_t (*playout_scheduler_pull_t)(void * p_context, int16_t * p_samples, size_t frames);
+
+/*!
+ * @brief What the scheduler has done so far.
+ */
+struct playout_scheduler_stats {
+    uint64_t periods_; /*!< Number of periods written to the sink. */
+    uint64_t underruns_; /*!< Number of periods the pipeline could not fill completely. */
+    uint64_t late_; /*!< Number of ticks that had passed before the scheduler was serviced, i.e. more than one period was due at a time. */
+    uint64_t max_latency_; /*!< Largest latency of the sink seen after a period was written, in frames. */
+};
+
+/*!
+ * @brief Creates the scheduler.
+ * @details The scheduler stands for the clock of a sound card running in the pull mode, as the DirectSound
+ * notifications do on Windows: the sink is filled with periods_count_ periods of silence, and then a periodic timer
+ * fires once per period, each time pulling a single period from the pipeline and writing it to the sink.
+ * @param[in] p_sink the sink, see audio_sink_open. Its period and number of periods set the timer and the latency.
+ * @param[in] pull pulls the periods.
+ * @param[in] p_context passed to the pull routine.
+ * @return returns a handle to the scheduler, or NULL if the timer could not be created.
+ */
+struct playout_scheduler * playout_scheduler_create(struct audio_sink * p_sink, playout_scheduler_pull_t pull, void * p_context);
+
+/*!
+ * @brief Returns the descriptor that becomes readable when a period is due.
+ * @details Meant to be waited for with select() or poll(), together with the sockets.
+ */
+int playout_scheduler_get_fd(struct playout_scheduler const * p_scheduler);
+
+/*!
+ * @brief Writes all the periods that are due.
+ * @details Does not block, returns 0 at once if no period is due.
+ * @param[in] p_scheduler a handle to the scheduler.
+ * @return returns number of periods written.
+ */
+unsigned int playout_scheduler_service(struct playout_scheduler * p_scheduler);
+
+/*!
+ * @brief Returns what the scheduler has done so far.
+ */
+void playout_scheduler_get_stats(struct playout_scheduler const * p_scheduler, struct playout_scheduler_stats * p_stats);
+
+/*!
+ * @brief Destroys the scheduler. The sink is not closed.
+ * @param[in] p_scheduler a handle to the scheduler obtained via call to playout_scheduler_create.
+ */
+void playout_scheduler_destroy(struct playout_scheduler * p_scheduler);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* PLAYOUT_SCHEDULER_H_222BD025_A66D_4E2A_91B8_6F1A27874C1D */
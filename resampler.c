@@ -0,0 +1,249 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file resampler.c
+ * @brief Sampling rate converter.
+ * @details Uses libsoxr when built with HAVE_SOXR, a built-in polyphase filter otherwise.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include <math.h>
+#include "resampler.h"
+#include "debug_helpers.h"
+#include "trace-recorder.h"
+#if defined HAVE_SOXR
+#   include <soxr.h>
+#endif
+
+#if !defined M_PI
+#   define M_PI (3.14159265358979323846)
+#endif
+
+/*!
+ * @brief Number of filter taps per polyphase branch.
+ * @details That is also the number of input samples each output sample is computed from.
+ */
+#define RESAMPLER_TAPS (32)
+
+/*!
+ * @brief Number of input samples the resampler takes in one go.
+ */
+#define RESAMPLER_CHUNK (1024)
+
+/*!
+ * @brief Where the pass band ends, relative to the Nyquist frequency of the lower of both rates.
+ */
+#define RESAMPLER_PASSBAND (0.9)
+
+/*!
+ * @brief Describes the resampler.
+ * @details The built-in resampler is a polyphase windowed sinc filter. The rate ratio is reduced to L/M,
+ * the prototype filter is designed at L times the input rate and split into L branches of RESAMPLER_TAPS taps each.
+ * Each output sample advances the position by M, and the branch is picked with the position modulo L.
+ */
+struct resampler {
+#if defined HAVE_SOXR
+    soxr_t soxr_; /*!< The soxr resampler. */
+    double ratio_; /*!< Output rate divided by the input rate. */
+#else
+    unsigned int up_; /*!< Interpolation factor L. */
+    unsigned int down_; /*!< Decimation factor M. */
+    uint64_t position_; /*!< Position of the next output sample, in the units of 1/L input sample, relative to history_[0]. */
+    size_t count_; /*!< Number of valid samples in history_. */
+    float * coefficients_; /*!< Branch p is at coefficients_[p * RESAMPLER_TAPS], the taps are stored newest sample first. */
+    float history_[RESAMPLER_TAPS + RESAMPLER_CHUNK]; /*!< Input samples not consumed yet, preceded by RESAMPLER_TAPS - 1 past ones. */
+#endif
+};
+
+#if !defined HAVE_SOXR
+static unsigned int gcd(unsigned int a, unsigned int b)
+{
+    while (0 != b)
+    {
+        unsigned int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+static int design_filter(struct resampler * p_resampler)
+{
+    unsigned int length = p_resampler->up_ * RESAMPLER_TAPS;
+    double cutoff = 0.5 * RESAMPLER_PASSBAND / (double)max(p_resampler->up_, p_resampler->down_);
+    double center = (length - 1) / 2.0;
+    unsigned int idx;
+    p_resampler->coefficients_ = (float *)malloc(length * sizeof(float));
+    if (NULL == p_resampler->coefficients_)
+        return 0;
+    for (idx = 0; idx < length; ++idx)
+    {
+        double t = idx - center;
+        double sinc = (0.0 == t) ? 1.0 : sin(2.0 * M_PI * cutoff * t) / (2.0 * M_PI * cutoff * t);
+        double window = 0.42 - 0.5 * cos(2.0 * M_PI * idx / (length - 1)) + 0.08 * cos(4.0 * M_PI * idx / (length - 1));
+        /* Tap idx of the prototype belongs to branch idx % L, at the position idx / L. */
+        p_resampler->coefficients_[(idx % p_resampler->up_) * RESAMPLER_TAPS + idx / p_resampler->up_] =
+            (float)(2.0 * cutoff * p_resampler->up_ * sinc * window);
+    }
+    return 1;
+}
+#endif
+
+char const * resampler_get_engine_name(void)
+{
+#if defined HAVE_SOXR
+    return "soxr";
+#else
+    return "builtin";
+#endif
+}
+
+struct resampler * resampler_create(unsigned int input_rate, unsigned int output_rate)
+{
+    struct resampler * p_resampler;
+    if (0 == input_rate || 0 == output_rate)
+        return NULL;
+    p_resampler = (struct resampler *)calloc(1, sizeof(struct resampler));
+    if (NULL == p_resampler)
+        return NULL;
+#if defined HAVE_SOXR
+    {
+        soxr_error_t error = NULL;
+        p_resampler->ratio_ = (double)output_rate / input_rate;
+        p_resampler->soxr_ = soxr_create(input_rate, output_rate, 1, &error, NULL, NULL, NULL);
+        if (NULL != error)
+        {
+            debug_outputln("%s %4.4u : %s", __FILE__, __LINE__, error);
+            free(p_resampler);
+            return NULL;
+        }
+    }
+#else
+    {
+        unsigned int divisor = gcd(input_rate, output_rate);
+        p_resampler->up_ = output_rate / divisor;
+        p_resampler->down_ = input_rate / divisor;
+        /* Each output sample may skip at most RESAMPLER_TAPS - 1 input samples, or the history would not hold them. */
+        if (p_resampler->down_ > p_resampler->up_ * (RESAMPLER_TAPS - 1))
+        {
+            debug_outputln("%s %4.4u : ratio %u/%u is not supported", __FILE__, __LINE__, output_rate, input_rate);
+            free(p_resampler);
+            return NULL;
+        }
+        /* Start with RESAMPLER_TAPS - 1 samples of silence in the history. */
+        p_resampler->count_ = RESAMPLER_TAPS - 1;
+        p_resampler->position_ = (uint64_t)(RESAMPLER_TAPS - 1) * p_resampler->up_;
+        if (!design_filter(p_resampler))
+        {
+            free(p_resampler);
+            return NULL;
+        }
+    }
+#endif
+    return p_resampler;
+}
+
+size_t resampler_get_output_size(struct resampler const * p_resampler, size_t input_count)
+{
+#if defined HAVE_SOXR
+    return (size_t)(input_count * p_resampler->ratio_) + 2;
+#else
+    return (size_t)(((uint64_t)input_count * p_resampler->up_) / p_resampler->down_) + 2;
+#endif
+}
+
+#if !defined HAVE_SOXR
+static size_t process_chunk(struct resampler * p_resampler, float * p_output)
+{
+    size_t written = 0;
+    size_t consumed;
+    for (;;)
+    {
+        size_t newest = (size_t)(p_resampler->position_ / p_resampler->up_);
+        float const * p_taps;
+        float const * p_samples;
+        float sum = 0.0f;
+        unsigned int idx;
+        if (newest >= p_resampler->count_)
+            break;
+        p_taps = &p_resampler->coefficients_[(p_resampler->position_ % p_resampler->up_) * RESAMPLER_TAPS];
+        p_samples = &p_resampler->history_[newest];
+        for (idx = 0; idx < RESAMPLER_TAPS; ++idx)
+            sum += p_taps[idx] * p_samples[-(int)idx];
+        p_output[written++] = sum;
+        p_resampler->position_ += p_resampler->down_;
+    }
+    /* Keep the last RESAMPLER_TAPS - 1 samples before the next one needed. */
+    consumed = (size_t)(p_resampler->position_ / p_resampler->up_) - (RESAMPLER_TAPS - 1);
+    memmove(p_resampler->history_, &p_resampler->history_[consumed], (p_resampler->count_ - consumed) * sizeof(float));
+    p_resampler->count_ -= consumed;
+    p_resampler->position_ -= (uint64_t)consumed * p_resampler->up_;
+    return written;
+}
+#endif
+
+static size_t resample(struct resampler * p_resampler, float const * p_input, size_t input_count, float * p_output, size_t output_count)
+{
+#if defined HAVE_SOXR
+    size_t done = 0;
+    if (NULL != soxr_process(p_resampler->soxr_, p_input, input_count, NULL, p_output, output_count, &done))
+        return 0;
+    return done;
+#else
+    size_t written = 0;
+    if (output_count < resampler_get_output_size(p_resampler, input_count))
+        return 0;
+    while (input_count > 0)
+    {
+        size_t chunk = min(input_count, (size_t)RESAMPLER_CHUNK);
+        CopyMemory(&p_resampler->history_[p_resampler->count_], p_input, chunk * sizeof(float));
+        p_resampler->count_ += chunk;
+        p_input += chunk;
+        input_count -= chunk;
+        written += process_chunk(p_resampler, &p_output[written]);
+    }
+    return written;
+#endif
+}
+
+size_t resampler_process(struct resampler * p_resampler, float const * p_input, size_t input_count, float * p_output, size_t output_count)
+{
+    size_t result;
+    TRACE_BEGIN("resample");
+    result = resample(p_resampler, p_input, input_count, p_output, output_count);
+    TRACE_END("resample");
+    return result;
+}
+
+void resampler_destroy(struct resampler * p_resampler)
+{
+    if (NULL != p_resampler)
+    {
+#if defined HAVE_SOXR
+        soxr_delete(p_resampler->soxr_);
+#else
+        free(p_resampler->coefficients_);
+#endif
+        free(p_resampler);
+    }
+}
@@ -0,0 +1,88 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+
+/**
+ * @file resampler.h
+ * @brief Sampling rate converter.
+ * @details Uses libsoxr when built with HAVE_SOXR, a built-in polyphase filter otherwise.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+#if !defined RESAMPLER_H_C41A7E90_2B5F_4D13_9E68_0F3B6D21A8C7
+#define RESAMPLER_H_C41A7E90_2B5F_4D13_9E68_0F3B6D21A8C7
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+
+/*!
+ * @brief Forward declaration.
+ */
+struct resampler;
+
+/*!
+ * @brief Returns the name of the resampling engine the module was built with, either "builtin" or "soxr".
+ */
+char const * resampler_get_engine_name(void);
+
+/*!
+ * @brief Creates the resampler.
+ * @details The resampler works on a single channel of float samples. It keeps its history between the calls
+ * to resampler_process(), so the stream can be fed in pieces of any length.
+ * @param[in] input_rate sampling rate of the input, in Hz.
+ * @param[in] output_rate sampling rate of the output, in Hz.
+ * @return returns a handle to the resampler, or NULL if creation failed.
+ */
+struct resampler * resampler_create(unsigned int input_rate, unsigned int output_rate);
+
+/*!
+ * @brief Returns the maximum number of samples produced from the given number of input samples.
+ * @param[in] p_resampler a handle to the resampler.
+ * @param[in] input_count number of input samples.
+ * @return returns the number of output samples the output buffer must hold.
+ */
+size_t resampler_get_output_size(struct resampler const * p_resampler, size_t input_count);
+
+/*!
+ * @brief Resamples the input.
+ * @param[in] p_resampler a handle to the resampler.
+ * @param[in] p_input input samples.
+ * @param[in] input_count number of input samples.
+ * @param[out] p_output output samples will be written here.
+ * @param[in] output_count size of the buffer indicated by p_output, in samples. Must be at least
+ * what resampler_get_output_size() returns for input_count.
+ * @return returns number of samples written.
+ */
+size_t resampler_process(struct resampler * p_resampler, float const * p_input, size_t input_count, float * p_output, size_t output_count);
+
+/*!
+ * @brief Destroys the resampler.
+ * @param[in] p_resampler a handle to the resampler obtained via call to resampler_create.
+ */
+void resampler_destroy(struct resampler * p_resampler);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* RESAMPLER_H_C41A7E90_2B5F_4D13_9E68_0F3B6D21A8C7 */
@@ -0,0 +1,161 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file spsc-ring.c
+ * @brief Bounded lock-free single producer, single consumer ring, the implementation.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include "spsc-ring.h"
+
+/*!
+ * @brief Size of the cache line the indices of each side are aligned to.
+ */
+#define SPSC_RING_CACHE_LINE (64)
+
+#if defined _MSC_VER
+#   define SPSC_RING_ALIGNED __declspec(align(SPSC_RING_CACHE_LINE))
+#   define RING_LOAD_ACQUIRE(x) (*(volatile uint32_t const *)&(x))
+#   define RING_STORE_RELEASE(x, v) (*(volatile uint32_t *)&(x) = (v))
+#else
+#   define SPSC_RING_ALIGNED __attribute__((aligned(SPSC_RING_CACHE_LINE)))
+#   define RING_LOAD_ACQUIRE(x) __atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+#   define RING_STORE_RELEASE(x, v) __atomic_store_n(&(x), (v), __ATOMIC_RELEASE)
+#endif
+
+/*!
+ * @brief The indices owned by one side of the ring.
+ * @details Each side keeps a copy of the other side's index, and reloads it only when the copy says the ring is
+ * full, or empty, so that the cache line of the other side is not pulled in on each operation.
+ */
+struct SPSC_RING_ALIGNED spsc_ring_side {
+    uint32_t index_; /*!< Free running number of slots written, or read. Published with release semantics. */
+    uint32_t other_; /*!< The last seen index of the other side. Private to the side. */
+};
+
+/*!
+ * @brief The ring.
+ */
+struct spsc_ring {
+    struct spsc_ring_side producer_; /*!< Owned by the producer, index_ is the number of slots written. */
+    struct spsc_ring_side consumer_; /*!< Owned by the consumer, index_ is the number of slots read. */
+    uint32_t mask_; /*!< Number of slots less one. */
+    size_t slot_size_; /*!< Size of each slot, rounded up to the cache line. */
+    size_t requested_size_; /*!< Size of each slot, as given on creation. */
+    uint8_t * p_slots_; /*!< The slots. */
+};
+
+struct spsc_ring * spsc_ring_create(unsigned int slots_count, size_t slot_size)
+{
+    struct spsc_ring * p_ring;
+    if (0 == slots_count || 0 != (slots_count & (slots_count - 1)) || 0 == slot_size)
+        return NULL;
+#if defined WIN32
+    p_ring = (struct spsc_ring *)_aligned_malloc(sizeof(struct spsc_ring), SPSC_RING_CACHE_LINE);
+#else
+    if (0 != posix_memalign((void **)&p_ring, SPSC_RING_CACHE_LINE, sizeof(struct spsc_ring)))
+        p_ring = NULL;
+#endif
+    if (NULL == p_ring)
+        return NULL;
+    ZeroMemory(p_ring, sizeof(struct spsc_ring));
+    p_ring->mask_ = slots_count - 1;
+    p_ring->requested_size_ = slot_size;
+    /* Neighbouring slots never share a cache line, so the producer writing one does not disturb the consumer reading the other. */
+    p_ring->slot_size_ = (slot_size + SPSC_RING_CACHE_LINE - 1) & ~(size_t)(SPSC_RING_CACHE_LINE - 1);
+#if defined WIN32
+    p_ring->p_slots_ = (uint8_t *)_aligned_malloc(slots_count * p_ring->slot_size_, SPSC_RING_CACHE_LINE);
+#else
+    if (0 != posix_memalign((void **)&p_ring->p_slots_, SPSC_RING_CACHE_LINE, slots_count * p_ring->slot_size_))
+        p_ring->p_slots_ = NULL;
+#endif
+    if (NULL == p_ring->p_slots_)
+    {
+        spsc_ring_destroy(p_ring);
+        return NULL;
+    }
+    return p_ring;
+}
+
+void spsc_ring_destroy(struct spsc_ring * p_ring)
+{
+    if (NULL != p_ring)
+    {
+#if defined WIN32
+        _aligned_free(p_ring->p_slots_);
+        _aligned_free(p_ring);
+#else
+        free(p_ring->p_slots_);
+        free(p_ring);
+#endif
+    }
+}
+
+unsigned int spsc_ring_get_slots_count(struct spsc_ring const * p_ring)
+{
+    return p_ring->mask_ + 1;
+}
+
+size_t spsc_ring_get_slot_size(struct spsc_ring const * p_ring)
+{
+    return p_ring->requested_size_;
+}
+
+void * spsc_ring_begin_write(struct spsc_ring * p_ring)
+{
+    uint32_t written = p_ring->producer_.index_;
+    if (written - p_ring->producer_.other_ > p_ring->mask_)
+    {
+        p_ring->producer_.other_ = RING_LOAD_ACQUIRE(p_ring->consumer_.index_);
+        if (written - p_ring->producer_.other_ > p_ring->mask_)
+            return NULL;
+    }
+    return &p_ring->p_slots_[(written & p_ring->mask_) * p_ring->slot_size_];
+}
+
+void spsc_ring_commit_write(struct spsc_ring * p_ring)
+{
+    RING_STORE_RELEASE(p_ring->producer_.index_, p_ring->producer_.index_ + 1);
+}
+
+void * spsc_ring_begin_read(struct spsc_ring * p_ring)
+{
+    uint32_t read = p_ring->consumer_.index_;
+    if (read == p_ring->consumer_.other_)
+    {
+        p_ring->consumer_.other_ = RING_LOAD_ACQUIRE(p_ring->producer_.index_);
+        if (read == p_ring->consumer_.other_)
+            return NULL;
+    }
+    return &p_ring->p_slots_[(read & p_ring->mask_) * p_ring->slot_size_];
+}
+
+void spsc_ring_commit_read(struct spsc_ring * p_ring)
+{
+    RING_STORE_RELEASE(p_ring->consumer_.index_, p_ring->consumer_.index_ + 1);
+}
+
+unsigned int spsc_ring_get_count(struct spsc_ring const * p_ring)
+{
+    return RING_LOAD_ACQUIRE(p_ring->producer_.index_) - RING_LOAD_ACQUIRE(p_ring->consumer_.index_);
+}
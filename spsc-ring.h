@@ -0,0 +1,103 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+
+/**
+ * @file spsc-ring.h
+ * @brief Bounded lock-free single producer, single consumer ring.
+ * @details The ring hands fixed size slots from one thread to another without any locks and without copying: the producer writes straight into the slot and the consumer reads straight from it.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+#if !defined SPSC_RING_H_00D62094_B0B4_4CFE_91A9_F438ECEF4997
+#define SPSC_RING_H_00D62094_B0B4_4CFE_91A9_F438ECEF4997
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+#include "std-int.h"
+#include <stddef.h>
+
+/*!
+ * @brief Forward declaration.
+ */
+struct spsc_ring;
+
+/*!
+ * @brief Creates the ring.
+ * @param[in] slots_count number of slots, must be a power of 2.
+ * @param[in] slot_size size of each slot, in bytes.
+ * @return returns a handle to the ring, or NULL if the number of slots is not a power of 2 or creation failed.
+ */
+struct spsc_ring * spsc_ring_create(unsigned int slots_count, size_t slot_size);
+
+/*!
+ * @brief Destroys the ring.
+ * @details Neither the producer nor the consumer may be using the ring anymore.
+ */
+void spsc_ring_destroy(struct spsc_ring * p_ring);
+
+/*!
+ * @brief Returns the number of slots of the ring.
+ */
+unsigned int spsc_ring_get_slots_count(struct spsc_ring const * p_ring);
+
+/*!
+ * @brief Returns the size of each slot, in bytes.
+ */
+size_t spsc_ring_get_slot_size(struct spsc_ring const * p_ring);
+
+/*!
+ * @brief Returns the slot to be written next, the producer only.
+ * @details The slot is handed to the consumer only by spsc_ring_commit_write, until then the same slot is returned.
+ * @return returns the slot, or NULL if the ring is full.
+ */
+void * spsc_ring_begin_write(struct spsc_ring * p_ring);
+
+/*!
+ * @brief Hands the slot returned by spsc_ring_begin_write to the consumer, the producer only.
+ */
+void spsc_ring_commit_write(struct spsc_ring * p_ring);
+
+/*!
+ * @brief Returns the slot to be read next, the consumer only.
+ * @details The slot is handed back to the producer only by spsc_ring_commit_read, until then the same slot is returned.
+ * @return returns the slot, or NULL if the ring is empty.
+ */
+void * spsc_ring_begin_read(struct spsc_ring * p_ring);
+
+/*!
+ * @brief Hands the slot returned by spsc_ring_begin_read back to the producer, the consumer only.
+ */
+void spsc_ring_commit_read(struct spsc_ring * p_ring);
+
+/*!
+ * @brief Returns the number of slots written and not read yet.
+ * @details May be called by either side. The other side may change the number at any time, so it is exact only
+ * as far as the calling side's own operations are concerned.
+ */
+unsigned int spsc_ring_get_count(struct spsc_ring const * p_ring);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* SPSC_RING_H_00D62094_B0B4_4CFE_91A9_F438ECEF4997 */
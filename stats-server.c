@@ -0,0 +1,176 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file stats-server.c
+ * @brief Serves the stream counters over a UNIX domain socket.
+ * @details The serving thread only reads the counters, it never blocks the threads that update them.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include <pthread.h>
+#include <poll.h>
+#include <sys/un.h>
+#include "stats-server.h"
+#include "stream-stats.h"
+#include "debug_helpers.h"
+
+/*!
+ * @brief How often the server checks whether it is to stop, in milliseconds.
+ */
+#define STATS_SERVER_POLL_MS (200)
+
+/*!
+ * @brief How long the server waits for the client's request, in milliseconds.
+ */
+#define STATS_SERVER_REQUEST_MS (100)
+
+/*!
+ * @brief Size of the response buffer.
+ */
+#define STATS_SERVER_RESPONSE_SIZE (32768)
+
+/*!
+ * @brief The server.
+ */
+struct stats_server {
+    struct stream_stats const * p_stats_; /*!< The counters to serve. */
+    int socket_; /*!< The listening socket. */
+    int stop_; /*!< Non-zero if the thread is to exit. */
+    pthread_t thread_; /*!< The serving thread. */
+    struct sockaddr_un address_; /*!< Address the socket is bound to. */
+    char response_[STATS_SERVER_RESPONSE_SIZE]; /*!< The response being sent. */
+};
+
+/*!
+ * @brief Sends a single snapshot to the client.
+ */
+static void serve_client(struct stats_server * p_server, int client)
+{
+    char request[32] = { 0 };
+    struct pollfd pfd;
+    size_t length;
+    size_t sent = 0;
+    pfd.fd = client;
+    pfd.events = POLLIN;
+    /* A client that sends nothing, e.g. a plain 'socat - UNIX-CONNECT:...', gets the default format. */
+    if (poll(&pfd, 1, STATS_SERVER_REQUEST_MS) > 0)
+    {
+        ssize_t result = recv(client, request, sizeof(request) - 1, 0);
+        if (result < 0)
+            request[0] = '\0';
+    }
+    if (0 == strncmp(request, "prometheus", 10) || 0 == strncmp(request, "metrics", 7))
+        length = stream_stats_format_prometheus(p_server->p_stats_, p_server->response_, sizeof(p_server->response_));
+    else
+        length = stream_stats_format_json(p_server->p_stats_, p_server->response_, sizeof(p_server->response_));
+    while (sent < length)
+    {
+        ssize_t result = send(client, &p_server->response_[sent], length - sent, MSG_NOSIGNAL);
+        if (result <= 0)
+            break;
+        sent += (size_t)result;
+    }
+}
+
+static void * server_routine(void * p_param)
+{
+    struct stats_server * p_server = (struct stats_server *)p_param;
+    while (!__atomic_load_n(&p_server->stop_, __ATOMIC_RELAXED))
+    {
+        struct pollfd pfd;
+        pfd.fd = p_server->socket_;
+        pfd.events = POLLIN;
+        if (poll(&pfd, 1, STATS_SERVER_POLL_MS) > 0)
+        {
+            int client = accept(p_server->socket_, NULL, NULL);
+            if (client >= 0)
+            {
+                serve_client(p_server, client);
+                close(client);
+            }
+        }
+    }
+    return NULL;
+}
+
+struct stats_server * stats_server_create(struct stream_stats const * p_stats, char const * psz_path)
+{
+    struct stats_server * p_server;
+    struct stat st_path;
+    char const * psz_override = getenv(STATS_SERVER_PATH_VARIABLE);
+    int result;
+    if (NULL != psz_override && '\0' != *psz_override)
+        psz_path = psz_override;
+    if (strlen(psz_path) >= sizeof(p_server->address_.sun_path))
+    {
+        debug_log_error(DEBUG_CATEGORY_NETWORK, "%s %4.4u : path too long '%s'", __FILE__, __LINE__, psz_path);
+        return NULL;
+    }
+    p_server = (struct stats_server *)calloc(1, sizeof(struct stats_server));
+    if (NULL == p_server)
+        return NULL;
+    p_server->p_stats_ = p_stats;
+    p_server->address_.sun_family = AF_UNIX;
+    strcpy(p_server->address_.sun_path, psz_path);
+    p_server->socket_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (p_server->socket_ < 0)
+    {
+        debug_log_error(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %d %s", __FILE__, __LINE__, errno, strerror(errno));
+        free(p_server);
+        return NULL;
+    }
+    /* Only a socket is taken for the leftover of an earlier run, anything else at the path is left alone. */
+    if (0 == lstat(psz_path, &st_path) && S_ISSOCK(st_path.st_mode))
+        unlink(psz_path);
+    if (0 != bind(p_server->socket_, (struct sockaddr const *)&p_server->address_, sizeof(p_server->address_))
+            || 0 != listen(p_server->socket_, 4))
+    {
+        debug_log_error(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %s %d %s", __FILE__, __LINE__, psz_path, errno, strerror(errno));
+        close(p_server->socket_);
+        free(p_server);
+        return NULL;
+    }
+    result = pthread_create(&p_server->thread_, NULL, &server_routine, p_server);
+    if (0 != result)
+    {
+        debug_log_error(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %d %s", __FILE__, __LINE__, result, strerror(result));
+        close(p_server->socket_);
+        unlink(psz_path);
+        free(p_server);
+        return NULL;
+    }
+    debug_log_info(DEBUG_CATEGORY_NETWORK, "%s %4.4u : serving counters on %s", __FILE__, __LINE__, psz_path);
+    return p_server;
+}
+
+void stats_server_destroy(struct stats_server * p_server)
+{
+    if (NULL != p_server)
+    {
+        __atomic_store_n(&p_server->stop_, 1, __ATOMIC_RELAXED);
+        pthread_join(p_server->thread_, NULL);
+        close(p_server->socket_);
+        unlink(p_server->address_.sun_path);
+        free(p_server);
+    }
+}
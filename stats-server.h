@@ -0,0 +1,73 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+
+/**
+ * @file stats-server.h
+ * @brief Serves the stream counters over a UNIX domain socket.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+#if !defined STATS_SERVER_H_C1A86E4D_0B72_49F5_8E3A_62D5F907B1C4
+#define STATS_SERVER_H_C1A86E4D_0B72_49F5_8E3A_62D5F907B1C4
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * @brief Name of the environment variable that overrides the path of the socket.
+ */
+#define STATS_SERVER_PATH_VARIABLE "MCAST_STATS_SOCKET"
+
+/*!
+ * @brief Forward declaration.
+ */
+struct stats_server;
+
+/*!
+ * @brief Forward declaration.
+ */
+struct stream_stats;
+
+/*!
+ * @brief Starts serving the counters over a local UNIX domain socket.
+ * @details The server runs a thread of its own. Each connection gets a single snapshot of the counters and is closed.
+ * A client that sends "prometheus" or "metrics" gets the Prometheus text format, any other client gets JSON, e.g.
+ * @code echo prometheus | socat - UNIX-CONNECT:/tmp/mcast-receiver.sock @endcode
+ * @param[in] p_stats the counters to serve. They must outlive the server.
+ * @param[in] psz_path path of the socket, unless overridden by the STATS_SERVER_PATH_VARIABLE environment variable.
+ * Any file that exists at this path is removed.
+ * @return returns a handle to the server, or NULL if creation failed.
+ * @sa stats_server_destroy
+ */
+struct stats_server * stats_server_create(struct stream_stats const * p_stats, char const * psz_path);
+
+/*!
+ * @brief Stops the server and removes the socket.
+ * @param[in] p_server a handle to the server obtained via call to stats_server_create.
+ */
+void stats_server_destroy(struct stats_server * p_server);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* STATS_SERVER_H_C1A86E4D_0B72_49F5_8E3A_62D5F907B1C4 */
@@ -0,0 +1,370 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file stream-stats.c
+ * @brief Per-stream traffic counters.
+ * @details Each writer owns a cache line aligned block of counters. The readers sum the blocks up without taking any locks.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include "stream-stats.h"
+
+/*!
+ * @brief Size of the cache line the writer's counters are aligned to.
+ */
+#define STREAM_STATS_CACHE_LINE (64)
+
+#if defined _MSC_VER
+#   define STREAM_STATS_ALIGNED __declspec(align(STREAM_STATS_CACHE_LINE))
+#   define STATS_LOAD(x) (*(volatile uint64_t const *)&(x))
+#   define STATS_STORE(x, v) (*(volatile uint64_t *)&(x) = (v))
+#   define STATS_LOAD_ACQUIRE(x) (*(volatile uint32_t const *)&(x))
+#   define STATS_STORE_RELEASE(x, v) (*(volatile uint32_t *)&(x) = (v))
+#else
+#   define STREAM_STATS_ALIGNED __attribute__((aligned(STREAM_STATS_CACHE_LINE)))
+#   define STATS_LOAD(x) __atomic_load_n(&(x), __ATOMIC_RELAXED)
+#   define STATS_STORE(x, v) __atomic_store_n(&(x), (v), __ATOMIC_RELAXED)
+#   define STATS_LOAD_ACQUIRE(x) __atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+#   define STATS_STORE_RELEASE(x, v) __atomic_store_n(&(x), (v), __ATOMIC_RELEASE)
+#endif
+
+/*!
+ * @brief Counters of a single stream, as seen by a single writer.
+ * @details Only the owning writer modifies the counters, so a plain load followed by an atomic store is enough.
+ * Aligning each entry to the cache line keeps the readers from disturbing the neighbouring streams.
+ */
+struct STREAM_STATS_ALIGNED stream_stats_entry {
+    uint32_t ssrc_; /*!< Identifier of the stream. */
+    uint32_t in_use_; /*!< Non-zero once the entry is taken. Published after the ssrc_. */
+    uint64_t packets_; /*!< Number of packets seen. */
+    uint64_t bytes_; /*!< Number of bytes seen. */
+    uint64_t expected_; /*!< Number of packets expected from the sequence numbers. */
+    uint64_t sequenced_; /*!< Number of packets that carried the sequence number. */
+    uint64_t reordered_; /*!< Number of packets with a sequence number lower than the highest one. */
+    uint64_t fifo_fill_; /*!< Number of samples buffered. */
+    uint64_t underruns_; /*!< Number of playout underruns. */
+    uint64_t late_; /*!< Number of late pacing events. */
+    uint64_t lateness_max_; /*!< Largest lateness, in nanoseconds. */
+    uint64_t lateness_sum_; /*!< Sum of all the latenesses, in nanoseconds. */
+    uint32_t base_seq_; /*!< First extended sequence number seen. Private to the writer. */
+    uint32_t highest_seq_; /*!< Highest extended sequence number seen. Private to the writer. */
+    int seq_valid_; /*!< Non-zero once a sequence number has been seen. Private to the writer. */
+};
+
+/*!
+ * @brief Counters of a single writer.
+ */
+struct STREAM_STATS_ALIGNED stream_stats_writer {
+    unsigned int last_hit_; /*!< Index of the entry that was looked up most recently. */
+    struct stream_stats_entry entries_[STREAM_STATS_MAX_STREAMS]; /*!< The counters, one per stream. */
+};
+
+/*!
+ * @brief All the counters.
+ */
+struct stream_stats {
+    uint32_t writers_count_; /*!< Number of writers handed out. */
+    struct stream_stats_writer writers_[STREAM_STATS_MAX_WRITERS]; /*!< The writers. */
+};
+
+struct stream_stats * stream_stats_create(void)
+{
+    struct stream_stats * p_stats;
+#if defined WIN32
+    p_stats = (struct stream_stats *)_aligned_malloc(sizeof(struct stream_stats), STREAM_STATS_CACHE_LINE);
+#else
+    if (0 != posix_memalign((void **)&p_stats, STREAM_STATS_CACHE_LINE, sizeof(struct stream_stats)))
+        p_stats = NULL;
+#endif
+    if (NULL != p_stats)
+        ZeroMemory(p_stats, sizeof(struct stream_stats));
+    return p_stats;
+}
+
+void stream_stats_destroy(struct stream_stats * p_stats)
+{
+#if defined WIN32
+    _aligned_free(p_stats);
+#else
+    free(p_stats);
+#endif
+}
+
+struct stream_stats_writer * stream_stats_add_writer(struct stream_stats * p_stats)
+{
+#if defined _MSC_VER
+    uint32_t idx = (uint32_t)InterlockedIncrement((LONG volatile *)&p_stats->writers_count_) - 1;
+#else
+    uint32_t idx = __atomic_fetch_add(&p_stats->writers_count_, 1, __ATOMIC_RELAXED);
+#endif
+    if (idx >= STREAM_STATS_MAX_WRITERS)
+        return NULL;
+    return &p_stats->writers_[idx];
+}
+
+/*!
+ * @brief Finds the entry of the stream, takes a free one if the stream is new.
+ * @return returns the entry, or NULL if the stream is new and there are no free entries left.
+ */
+static struct stream_stats_entry * find_entry(struct stream_stats_writer * p_writer, uint32_t ssrc)
+{
+    unsigned int idx;
+    struct stream_stats_entry * p_entry = &p_writer->entries_[p_writer->last_hit_];
+    if (p_entry->in_use_ && ssrc == p_entry->ssrc_)
+        return p_entry;
+    for (idx = 0; idx < STREAM_STATS_MAX_STREAMS; ++idx)
+    {
+        p_entry = &p_writer->entries_[idx];
+        if (!p_entry->in_use_)
+        {
+            p_entry->ssrc_ = ssrc;
+            STATS_STORE_RELEASE(p_entry->in_use_, 1);
+        }
+        if (ssrc == p_entry->ssrc_)
+        {
+            p_writer->last_hit_ = idx;
+            return p_entry;
+        }
+    }
+    return NULL;
+}
+
+/*!
+ * @brief Adds to a counter owned by the calling writer.
+ */
+static void add(uint64_t * p_counter, uint64_t value)
+{
+    STATS_STORE(*p_counter, *p_counter + value);
+}
+
+void stream_stats_on_packet(struct stream_stats_writer * p_writer, uint32_t ssrc, uint16_t seq, size_t bytes)
+{
+    struct stream_stats_entry * p_entry = find_entry(p_writer, ssrc);
+    if (NULL != p_entry)
+    {
+        add(&p_entry->packets_, 1);
+        add(&p_entry->bytes_, bytes);
+        add(&p_entry->sequenced_, 1);
+        if (!p_entry->seq_valid_)
+        {
+            p_entry->seq_valid_ = 1;
+            p_entry->base_seq_ = seq;
+            p_entry->highest_seq_ = seq;
+        }
+        else
+        {
+            uint16_t delta = (uint16_t)(seq - (uint16_t)p_entry->highest_seq_);
+            /* Forward steps of less than half the sequence space advance the highest number, with the wrap around
+             * carried over into the upper 16 bits. Anything else is an older packet that came late. */
+            if (delta < 0x8000)
+                p_entry->highest_seq_ += delta;
+            else
+                add(&p_entry->reordered_, 1);
+        }
+        STATS_STORE(p_entry->expected_, (uint64_t)(p_entry->highest_seq_ - p_entry->base_seq_) + 1);
+    }
+}
+
+void stream_stats_on_unsequenced(struct stream_stats_writer * p_writer, uint32_t ssrc, size_t bytes)
+{
+    struct stream_stats_entry * p_entry = find_entry(p_writer, ssrc);
+    if (NULL != p_entry)
+    {
+        add(&p_entry->packets_, 1);
+        add(&p_entry->bytes_, bytes);
+    }
+}
+
+void stream_stats_set_fifo(struct stream_stats_writer * p_writer, uint32_t ssrc, size_t fill, uint32_t underruns)
+{
+    struct stream_stats_entry * p_entry = find_entry(p_writer, ssrc);
+    if (NULL != p_entry)
+    {
+        STATS_STORE(p_entry->fifo_fill_, (uint64_t)fill);
+        STATS_STORE(p_entry->underruns_, (uint64_t)underruns);
+    }
+}
+
+void stream_stats_on_lateness(struct stream_stats_writer * p_writer, uint32_t ssrc, uint64_t lateness)
+{
+    if (0 != lateness)
+    {
+        struct stream_stats_entry * p_entry = find_entry(p_writer, ssrc);
+        if (NULL != p_entry)
+        {
+            add(&p_entry->late_, 1);
+            add(&p_entry->lateness_sum_, lateness);
+            if (lateness > p_entry->lateness_max_)
+                STATS_STORE(p_entry->lateness_max_, lateness);
+        }
+    }
+}
+
+unsigned int stream_stats_snapshot(struct stream_stats const * p_stats, struct stream_stats_stream * p_streams, unsigned int max_count)
+{
+    unsigned int count = 0;
+    unsigned int writers_count = STATS_LOAD_ACQUIRE(p_stats->writers_count_);
+    unsigned int writer_idx;
+    if (writers_count > STREAM_STATS_MAX_WRITERS)
+        writers_count = STREAM_STATS_MAX_WRITERS;
+    for (writer_idx = 0; writer_idx < writers_count; ++writer_idx)
+    {
+        unsigned int idx;
+        for (idx = 0; idx < STREAM_STATS_MAX_STREAMS; ++idx)
+        {
+            struct stream_stats_entry const * p_entry = &p_stats->writers_[writer_idx].entries_[idx];
+            struct stream_stats_stream * p_stream;
+            unsigned int stream_idx;
+            uint64_t expected;
+            uint64_t sequenced;
+            uint64_t lateness_max;
+            if (!STATS_LOAD_ACQUIRE(p_entry->in_use_))
+                break;
+            for (stream_idx = 0; stream_idx < count && p_streams[stream_idx].ssrc_ != p_entry->ssrc_; ++stream_idx)
+                ;
+            if (stream_idx == count)
+            {
+                if (count == max_count)
+                    continue;
+                ZeroMemory(&p_streams[count], sizeof(struct stream_stats_stream));
+                p_streams[count].ssrc_ = p_entry->ssrc_;
+                ++count;
+            }
+            p_stream = &p_streams[stream_idx];
+            p_stream->packets_ += STATS_LOAD(p_entry->packets_);
+            p_stream->bytes_ += STATS_LOAD(p_entry->bytes_);
+            p_stream->reordered_ += STATS_LOAD(p_entry->reordered_);
+            p_stream->fifo_fill_ += STATS_LOAD(p_entry->fifo_fill_);
+            p_stream->underruns_ += STATS_LOAD(p_entry->underruns_);
+            p_stream->late_ += STATS_LOAD(p_entry->late_);
+            p_stream->lateness_sum_ += STATS_LOAD(p_entry->lateness_sum_);
+            lateness_max = STATS_LOAD(p_entry->lateness_max_);
+            if (lateness_max > p_stream->lateness_max_)
+                p_stream->lateness_max_ = lateness_max;
+            /* Duplicates are counted as received, so the difference may go negative. */
+            sequenced = STATS_LOAD(p_entry->sequenced_);
+            expected = STATS_LOAD(p_entry->expected_);
+            if (expected > sequenced)
+                p_stream->lost_ += expected - sequenced;
+        }
+    }
+    return count;
+}
+
+/*!
+ * @brief Appends the formatted text to the buffer.
+ * @return returns non-zero on success, 0 if the text did not fit.
+ */
+static int append(char * p_buffer, size_t buffer_size, size_t * p_length, char const * psz_format, ...)
+{
+    int result;
+    va_list args;
+    va_start(args, psz_format);
+    result = vsnprintf(p_buffer + *p_length, buffer_size - *p_length, psz_format, args);
+    va_end(args);
+    if (result < 0 || (size_t)result >= buffer_size - *p_length)
+        return 0;
+    *p_length += (size_t)result;
+    return 1;
+}
+
+size_t stream_stats_format_json(struct stream_stats const * p_stats, char * p_buffer, size_t buffer_size)
+{
+    struct stream_stats_stream streams[STREAM_STATS_MAX_STREAMS];
+    unsigned int count = stream_stats_snapshot(p_stats, streams, COUNTOF_ARRAY(streams));
+    unsigned int idx;
+    size_t length = 0;
+    if (!append(p_buffer, buffer_size, &length, "{\"streams\":["))
+        return 0;
+    for (idx = 0; idx < count; ++idx)
+    {
+        struct stream_stats_stream const * p_stream = &streams[idx];
+        if (!append(p_buffer, buffer_size, &length,
+                "%s{\"ssrc\":%lu,\"packets\":%llu,\"bytes\":%llu,\"lost\":%llu,\"reordered\":%llu,"
+                "\"fifo_fill\":%llu,\"underruns\":%llu,\"late\":%llu,\"lateness_max_ns\":%llu,\"lateness_sum_ns\":%llu}",
+                0 == idx ? "" : ",",
+                (unsigned long)p_stream->ssrc_,
+                (unsigned long long)p_stream->packets_,
+                (unsigned long long)p_stream->bytes_,
+                (unsigned long long)p_stream->lost_,
+                (unsigned long long)p_stream->reordered_,
+                (unsigned long long)p_stream->fifo_fill_,
+                (unsigned long long)p_stream->underruns_,
+                (unsigned long long)p_stream->late_,
+                (unsigned long long)p_stream->lateness_max_,
+                (unsigned long long)p_stream->lateness_sum_))
+            return 0;
+    }
+    if (!append(p_buffer, buffer_size, &length, "]}\n"))
+        return 0;
+    return length;
+}
+
+/*!
+ * @brief Describes a single Prometheus metric.
+ */
+struct prometheus_metric {
+    char const * psz_name_; /*!< Name of the metric. */
+    char const * psz_type_; /*!< Either counter or gauge. */
+    char const * psz_help_; /*!< Description of the metric. */
+    size_t offset_; /*!< Offset of the value within the stream_stats_stream structure. */
+};
+
+static struct prometheus_metric const g_metrics[] = {
+    { "mcast_packets_total", "counter", "Packets seen.", offsetof(struct stream_stats_stream, packets_) },
+    { "mcast_bytes_total", "counter", "Bytes seen.", offsetof(struct stream_stats_stream, bytes_) },
+    { "mcast_lost_packets_total", "counter", "Packets expected, but never seen.", offsetof(struct stream_stats_stream, lost_) },
+    { "mcast_reordered_packets_total", "counter", "Packets that came out of order.", offsetof(struct stream_stats_stream, reordered_) },
+    { "mcast_fifo_fill_samples", "gauge", "Samples buffered for the playout.", offsetof(struct stream_stats_stream, fifo_fill_) },
+    { "mcast_underruns_total", "counter", "Times the playout ran out of data.", offsetof(struct stream_stats_stream, underruns_) },
+    { "mcast_late_total", "counter", "Times the pacing was late.", offsetof(struct stream_stats_stream, late_) },
+    { "mcast_lateness_max_nanoseconds", "gauge", "Largest pacing lateness.", offsetof(struct stream_stats_stream, lateness_max_) },
+    { "mcast_lateness_nanoseconds_total", "counter", "Sum of all the pacing latenesses.", offsetof(struct stream_stats_stream, lateness_sum_) },
+};
+
+size_t stream_stats_format_prometheus(struct stream_stats const * p_stats, char * p_buffer, size_t buffer_size)
+{
+    struct stream_stats_stream streams[STREAM_STATS_MAX_STREAMS];
+    unsigned int count = stream_stats_snapshot(p_stats, streams, COUNTOF_ARRAY(streams));
+    unsigned int metric_idx;
+    size_t length = 0;
+    if (0 == buffer_size)
+        return 0;
+    p_buffer[0] = '\0';
+    for (metric_idx = 0; metric_idx < COUNTOF_ARRAY(g_metrics); ++metric_idx)
+    {
+        struct prometheus_metric const * p_metric = &g_metrics[metric_idx];
+        unsigned int idx;
+        if (!append(p_buffer, buffer_size, &length, "# HELP %s %s\n# TYPE %s %s\n",
+                p_metric->psz_name_, p_metric->psz_help_, p_metric->psz_name_, p_metric->psz_type_))
+            return 0;
+        for (idx = 0; idx < count; ++idx)
+        {
+            uint64_t value = *(uint64_t const *)((char const *)&streams[idx] + p_metric->offset_);
+            if (!append(p_buffer, buffer_size, &length, "%s{ssrc=\"%lu\"} %llu\n",
+                    p_metric->psz_name_, (unsigned long)streams[idx].ssrc_, (unsigned long long)value))
+                return 0;
+        }
+    }
+    return length;
+}
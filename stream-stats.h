@@ -0,0 +1,166 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+
+/**
+ * @file stream-stats.h
+ * @brief Per-stream traffic counters.
+ * @details Counters are kept per writer thread, in cache line aligned blocks, and summed up only when a snapshot is taken.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+#if !defined STREAM_STATS_H_3F7C1E92_5A04_4B8D_A6E3_9D21C84B0F57
+#define STREAM_STATS_H_3F7C1E92_5A04_4B8D_A6E3_9D21C84B0F57
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+#include "std-int.h"
+#include <stddef.h>
+
+/*!
+ * @brief Maximum number of streams each writer keeps the counters for.
+ */
+#define STREAM_STATS_MAX_STREAMS (32)
+
+/*!
+ * @brief Maximum number of threads that may update the counters.
+ */
+#define STREAM_STATS_MAX_WRITERS (8)
+
+/*!
+ * @brief Snapshot of the counters of a single stream, summed over all the writers.
+ */
+struct stream_stats_stream {
+    uint32_t ssrc_; /*!< Identifier of the stream. */
+    uint64_t packets_; /*!< Number of packets seen. */
+    uint64_t bytes_; /*!< Number of bytes seen. */
+    uint64_t lost_; /*!< Number of packets expected, but never seen. */
+    uint64_t reordered_; /*!< Number of packets that came after a packet with a higher sequence number. */
+    uint64_t fifo_fill_; /*!< Number of samples buffered for the playout, as last reported. */
+    uint64_t underruns_; /*!< Number of times the playout ran out of data, as last reported. */
+    uint64_t late_; /*!< Number of times the pacing was late. */
+    uint64_t lateness_max_; /*!< Largest lateness, in nanoseconds. */
+    uint64_t lateness_sum_; /*!< Sum of all the latenesses, in nanoseconds. */
+};
+
+/*!
+ * @brief Forward declaration.
+ */
+struct stream_stats;
+
+/*!
+ * @brief Forward declaration.
+ */
+struct stream_stats_writer;
+
+/*!
+ * @brief Creates the counters.
+ * @return returns a handle to the counters, or NULL if creation failed.
+ * @sa stream_stats_destroy
+ */
+struct stream_stats * stream_stats_create(void);
+
+/*!
+ * @brief Destroys the counters.
+ * @details No writer and no reader may be using the counters anymore.
+ * @param[in] p_stats a handle to the counters obtained via call to stream_stats_create.
+ */
+void stream_stats_destroy(struct stream_stats * p_stats);
+
+/*!
+ * @brief Gives the calling thread its own set of counters.
+ * @details Each thread that updates the counters must use a writer of its own. The writer is never shared
+ * with the other threads, so the updates need no locks and do not bounce cache lines between the cores.
+ * @param[in] p_stats a handle to the counters.
+ * @return returns a handle to the writer, or NULL if all STREAM_STATS_MAX_WRITERS writers are taken.
+ */
+struct stream_stats_writer * stream_stats_add_writer(struct stream_stats * p_stats);
+
+/*!
+ * @brief Accounts a single sequenced packet.
+ * @details Loss and reordering are derived from the sequence numbers the way RFC 3550 does it.
+ * @param[in] p_writer a handle to the writer.
+ * @param[in] ssrc identifier of the stream.
+ * @param[in] seq sequence number of the packet.
+ * @param[in] bytes size of the packet.
+ */
+void stream_stats_on_packet(struct stream_stats_writer * p_writer, uint32_t ssrc, uint16_t seq, size_t bytes);
+
+/*!
+ * @brief Accounts a single packet that carries no sequence number.
+ * @param[in] p_writer a handle to the writer.
+ * @param[in] ssrc identifier of the stream.
+ * @param[in] bytes size of the packet.
+ */
+void stream_stats_on_unsequenced(struct stream_stats_writer * p_writer, uint32_t ssrc, size_t bytes);
+
+/*!
+ * @brief Reports the state of the playout buffer of the stream.
+ * @param[in] p_writer a handle to the writer.
+ * @param[in] ssrc identifier of the stream.
+ * @param[in] fill number of samples buffered.
+ * @param[in] underruns number of times the playout ran out of data so far.
+ */
+void stream_stats_set_fifo(struct stream_stats_writer * p_writer, uint32_t ssrc, size_t fill, uint32_t underruns);
+
+/*!
+ * @brief Accounts a single late pacing event.
+ * @param[in] p_writer a handle to the writer.
+ * @param[in] ssrc identifier of the stream.
+ * @param[in] lateness how late the event was, in nanoseconds. Zero is ignored.
+ */
+void stream_stats_on_lateness(struct stream_stats_writer * p_writer, uint32_t ssrc, uint64_t lateness);
+
+/*!
+ * @brief Takes a snapshot of the counters.
+ * @details May be called from any thread, concurrently with the writers. Each counter is read atomically,
+ * but the counters are not read all at the same instant.
+ * @param[in] p_stats a handle to the counters.
+ * @param[out] p_streams this array will be written with the counters, one entry per stream.
+ * @param[in] max_count number of entries in the p_streams array.
+ * @return returns number of entries written.
+ */
+unsigned int stream_stats_snapshot(struct stream_stats const * p_stats, struct stream_stats_stream * p_streams, unsigned int max_count);
+
+/*!
+ * @brief Formats a snapshot of the counters as a JSON document.
+ * @param[in] p_stats a handle to the counters.
+ * @param[out] p_buffer this buffer will be written with the document, zero terminated.
+ * @param[in] buffer_size size of the buffer.
+ * @return returns length of the document, or 0 if the buffer is too small.
+ */
+size_t stream_stats_format_json(struct stream_stats const * p_stats, char * p_buffer, size_t buffer_size);
+
+/*!
+ * @brief Formats a snapshot of the counters in the Prometheus text exposition format.
+ * @param[in] p_stats a handle to the counters.
+ * @param[out] p_buffer this buffer will be written with the text, zero terminated.
+ * @param[in] buffer_size size of the buffer.
+ * @return returns length of the text, or 0 if the buffer is too small.
+ */
+size_t stream_stats_format_prometheus(struct stream_stats const * p_stats, char * p_buffer, size_t buffer_size);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* STREAM_STATS_H_3F7C1E92_5A04_4B8D_A6E3_9D21C84B0F57 */
@@ -0,0 +1,158 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file thread-pool.c
+ * @brief Worker thread pool.
+ * @details Fixed number of pthread workers fed from a bounded task queue.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include <pthread.h>
+#include "thread-pool.h"
+#include "debug_helpers.h"
+
+/*!
+ * @brief A queued task.
+ */
+struct thread_pool_entry {
+    THREAD_POOL_TASK task_; /*!< Task to execute. */
+    void * p_argument_; /*!< Argument to pass to the task. */
+};
+
+/*!
+ * @brief The pool.
+ */
+struct thread_pool {
+    pthread_mutex_t lock_; /*!< Protects all the members below. */
+    pthread_cond_t has_work_; /*!< Signalled when a task is queued, or when the pool is stopped. */
+    pthread_cond_t has_room_; /*!< Signalled when a task is taken from the queue. */
+    pthread_cond_t idle_; /*!< Signalled when the last pending task is finished. */
+    unsigned int head_; /*!< Free running index of the next task to take. */
+    unsigned int tail_; /*!< Free running index of the next free slot. */
+    unsigned int pending_; /*!< Number of tasks queued or executing. */
+    int stop_; /*!< Non-zero if the workers are to exit. */
+    unsigned int threads_count_; /*!< Number of worker threads started. */
+    pthread_t threads_[THREAD_POOL_MAX_THREADS]; /*!< The workers. */
+    struct thread_pool_entry tasks_[THREAD_POOL_MAX_TASKS]; /*!< The queue. */
+};
+
+static void * worker_routine(void * p_param)
+{
+    struct thread_pool * p_pool = (struct thread_pool *)p_param;
+    pthread_mutex_lock(&p_pool->lock_);
+    for (;;)
+    {
+        struct thread_pool_entry entry;
+        while (p_pool->head_ == p_pool->tail_ && !p_pool->stop_)
+            pthread_cond_wait(&p_pool->has_work_, &p_pool->lock_);
+        if (p_pool->head_ == p_pool->tail_)
+            break;
+        entry = p_pool->tasks_[p_pool->head_ % THREAD_POOL_MAX_TASKS];
+        ++p_pool->head_;
+        pthread_cond_signal(&p_pool->has_room_);
+        pthread_mutex_unlock(&p_pool->lock_);
+        (*entry.task_)(entry.p_argument_);
+        pthread_mutex_lock(&p_pool->lock_);
+        if (0 == --p_pool->pending_)
+            pthread_cond_broadcast(&p_pool->idle_);
+    }
+    pthread_mutex_unlock(&p_pool->lock_);
+    return NULL;
+}
+
+struct thread_pool * thread_pool_create(unsigned int threads_count)
+{
+    struct thread_pool * p_pool;
+    if (threads_count > THREAD_POOL_MAX_THREADS)
+        return NULL;
+    p_pool = (struct thread_pool *)calloc(1, sizeof(struct thread_pool));
+    if (NULL == p_pool)
+        return NULL;
+    pthread_mutex_init(&p_pool->lock_, NULL);
+    pthread_cond_init(&p_pool->has_work_, NULL);
+    pthread_cond_init(&p_pool->has_room_, NULL);
+    pthread_cond_init(&p_pool->idle_, NULL);
+    for (; p_pool->threads_count_ < threads_count; ++p_pool->threads_count_)
+    {
+        int result = pthread_create(&p_pool->threads_[p_pool->threads_count_], NULL, &worker_routine, p_pool);
+        if (0 != result)
+        {
+            debug_outputln("%s %4.4u : %d %s", __FILE__, __LINE__, result, strerror(result));
+            thread_pool_destroy(p_pool);
+            return NULL;
+        }
+    }
+    return p_pool;
+}
+
+int thread_pool_submit(struct thread_pool * p_pool, THREAD_POOL_TASK task, void * p_argument)
+{
+    if (0 == p_pool->threads_count_)
+    {
+        (*task)(p_argument);
+        return 1;
+    }
+    pthread_mutex_lock(&p_pool->lock_);
+    while (p_pool->tail_ - p_pool->head_ >= THREAD_POOL_MAX_TASKS && !p_pool->stop_)
+        pthread_cond_wait(&p_pool->has_room_, &p_pool->lock_);
+    if (p_pool->stop_)
+    {
+        pthread_mutex_unlock(&p_pool->lock_);
+        return 0;
+    }
+    p_pool->tasks_[p_pool->tail_ % THREAD_POOL_MAX_TASKS].task_ = task;
+    p_pool->tasks_[p_pool->tail_ % THREAD_POOL_MAX_TASKS].p_argument_ = p_argument;
+    ++p_pool->tail_;
+    ++p_pool->pending_;
+    pthread_cond_signal(&p_pool->has_work_);
+    pthread_mutex_unlock(&p_pool->lock_);
+    return 1;
+}
+
+void thread_pool_wait(struct thread_pool * p_pool)
+{
+    pthread_mutex_lock(&p_pool->lock_);
+    while (0 != p_pool->pending_)
+        pthread_cond_wait(&p_pool->idle_, &p_pool->lock_);
+    pthread_mutex_unlock(&p_pool->lock_);
+}
+
+void thread_pool_destroy(struct thread_pool * p_pool)
+{
+    if (NULL != p_pool)
+    {
+        unsigned int idx;
+        pthread_mutex_lock(&p_pool->lock_);
+        p_pool->stop_ = 1;
+        pthread_cond_broadcast(&p_pool->has_work_);
+        pthread_cond_broadcast(&p_pool->has_room_);
+        pthread_mutex_unlock(&p_pool->lock_);
+        for (idx = 0; idx < p_pool->threads_count_; ++idx)
+            pthread_join(p_pool->threads_[idx], NULL);
+        pthread_cond_destroy(&p_pool->idle_);
+        pthread_cond_destroy(&p_pool->has_room_);
+        pthread_cond_destroy(&p_pool->has_work_);
+        pthread_mutex_destroy(&p_pool->lock_);
+        free(p_pool);
+    }
+}
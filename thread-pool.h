@@ -0,0 +1,89 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+
+/**
+ * @file thread-pool.h
+ * @brief Worker thread pool.
+ * @details Fixed number of pthread workers fed from a bounded task queue.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+#if !defined THREAD_POOL_H_8F2D6A41_E753_4C0B_A19E_5D7C3B08F264
+#define THREAD_POOL_H_8F2D6A41_E753_4C0B_A19E_5D7C3B08F264
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * @brief Maximum number of the worker threads.
+ */
+#define THREAD_POOL_MAX_THREADS (64)
+
+/*!
+ * @brief Maximum number of tasks that can be submitted and not finished yet.
+ */
+#define THREAD_POOL_MAX_TASKS (256)
+
+/*!
+ * @brief A task to be executed by the worker thread.
+ */
+typedef void (*THREAD_POOL_TASK)(void * p_argument);
+
+/*!
+ * @brief Forward declaration.
+ */
+struct thread_pool;
+
+/*!
+ * @brief Creates the pool and starts the worker threads.
+ * @param[in] threads_count number of the worker threads. If 0, the tasks are executed by the thread that submits them.
+ * @return returns a handle to the pool, or NULL if creation failed.
+ */
+struct thread_pool * thread_pool_create(unsigned int threads_count);
+
+/*!
+ * @brief Queues the task for execution.
+ * @details If the queue is full, the call blocks until one of the queued tasks is taken by a worker.
+ * @param[in] p_pool a handle to the pool.
+ * @param[in] task the task to execute.
+ * @param[in] p_argument argument to pass to the task.
+ * @return returns non-zero on success, 0 otherwise.
+ */
+int thread_pool_submit(struct thread_pool * p_pool, THREAD_POOL_TASK task, void * p_argument);
+
+/*!
+ * @brief Waits until all the submitted tasks are finished.
+ * @param[in] p_pool a handle to the pool.
+ */
+void thread_pool_wait(struct thread_pool * p_pool);
+
+/*!
+ * @brief Finishes the queued tasks, stops the worker threads and destroys the pool.
+ * @param[in] p_pool a handle to the pool obtained via call to thread_pool_create.
+ */
+void thread_pool_destroy(struct thread_pool * p_pool);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* THREAD_POOL_H_8F2D6A41_E753_4C0B_A19E_5D7C3B08F264 */
@@ -0,0 +1,231 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file thread-sched-linux.c
+ * @brief Real time scheduling of the audio threads, the Linux implementation.
+ * @details Uses pthread_setschedparam, pthread_setaffinity_np and mlockall.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include "thread-sched.h"
+#include "debug_helpers.h"
+
+/*!
+ * @brief Names of the roles, indexed by the role.
+ */
+static char const * const g_role_names[THREAD_ROLE_COUNT] = { "CAPTURE", "SEND", "RECEIVE", "PLAYOUT" };
+
+/*!
+ * @brief Names of the policies, indexed by the policy.
+ */
+static char const * const g_policy_names[] = { "other", "fifo", "rr" };
+
+/*!
+ * @brief The system's policies, indexed by the policy.
+ */
+static int const g_policies[] = { SCHED_OTHER, SCHED_FIFO, SCHED_RR };
+
+int thread_sched_parse(struct thread_sched_config * p_config, char const * psz_text)
+{
+    char const * p_end = psz_text + strcspn(psz_text, ":@");
+    unsigned int idx;
+    p_config->policy_ = -1;
+    for (idx = 0; idx < sizeof(g_policy_names)/sizeof(g_policy_names[0]); ++idx)
+        if (strlen(g_policy_names[idx]) == (size_t)(p_end - psz_text) && 0 == strncmp(g_policy_names[idx], psz_text, p_end - psz_text))
+            p_config->policy_ = (int)idx;
+    if (p_config->policy_ < 0)
+        return 0;
+    p_config->priority_ = THREAD_SCHED_OTHER == p_config->policy_ ? 0 : THREAD_SCHED_DEFAULT_PRIORITY;
+    p_config->cpu_ = -1;
+    if (':' == *p_end)
+    {
+        char * p_number_end;
+        long priority = strtol(p_end + 1, &p_number_end, 10);
+        if (p_number_end == p_end + 1 || THREAD_SCHED_OTHER == p_config->policy_ || priority < 1 || priority > 99)
+            return 0;
+        p_config->priority_ = (int)priority;
+        p_end = p_number_end;
+    }
+    if ('@' == *p_end)
+    {
+        char * p_number_end;
+        long cpu = strtol(p_end + 1, &p_number_end, 10);
+        if (p_number_end == p_end + 1 || cpu < 0 || cpu >= CPU_SETSIZE)
+            return 0;
+        p_config->cpu_ = (int)cpu;
+        p_end = p_number_end;
+    }
+    return '\0' == *p_end;
+}
+
+char const * thread_sched_get_role_name(int role)
+{
+    return role >= 0 && role < THREAD_ROLE_COUNT ? g_role_names[role] : "?";
+}
+
+char const * thread_sched_get_policy_name(int policy)
+{
+    return policy >= 0 && policy < (int)(sizeof(g_policy_names)/sizeof(g_policy_names[0])) ? g_policy_names[policy] : "?";
+}
+
+/*!
+ * @brief Fills in the result with what the system reports for the calling thread.
+ */
+static void get_result(struct thread_sched_result * p_result)
+{
+    struct sched_param param;
+    cpu_set_t cpus;
+    int policy;
+    unsigned int idx;
+    memset(p_result, 0, sizeof(struct thread_sched_result));
+    p_result->cpu_ = -1;
+    if (0 == pthread_getschedparam(pthread_self(), &policy, &param))
+    {
+        for (idx = 0; idx < sizeof(g_policies)/sizeof(g_policies[0]); ++idx)
+            if (policy == g_policies[idx])
+                p_result->policy_ = (int)idx;
+        p_result->priority_ = param.sched_priority;
+    }
+    CPU_ZERO(&cpus);
+    if (0 == pthread_getaffinity_np(pthread_self(), sizeof(cpus), &cpus) && 1 == CPU_COUNT(&cpus))
+        for (idx = 0; idx < CPU_SETSIZE; ++idx)
+            if (CPU_ISSET(idx, &cpus))
+                p_result->cpu_ = (int)idx;
+}
+
+/*!
+ * @brief Sets the real time policy, lowering the priority to what RLIMIT_RTPRIO allows if it has to.
+ * @return returns 0 on success, including with the lowered priority, the error of the first attempt otherwise.
+ */
+static int set_policy(int policy, int priority)
+{
+    struct sched_param param;
+    struct rlimit limit;
+    int result;
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = priority;
+    result = pthread_setschedparam(pthread_self(), g_policies[policy], &param);
+    /* An unprivileged process may still be allowed the real time policies up to its limit. */
+    if (EPERM == result && 0 == getrlimit(RLIMIT_RTPRIO, &limit) && limit.rlim_cur > 0 && limit.rlim_cur < (rlim_t)priority)
+    {
+        param.sched_priority = (int)limit.rlim_cur;
+        if (0 == pthread_setschedparam(pthread_self(), g_policies[policy], &param))
+        {
+            debug_log_warning(DEBUG_CATEGORY_AUDIO, "%s %4.4u : priority %d lowered to %d", __FILE__, __LINE__, priority, param.sched_priority);
+            result = 0;
+        }
+    }
+    return result;
+}
+
+int thread_sched_apply(struct thread_sched_config const * p_config, struct thread_sched_result * p_result)
+{
+    int result;
+    if (p_config->cpu_ >= 0)
+    {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(p_config->cpu_, &cpus);
+        result = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        if (0 != result)
+            debug_log_warning(DEBUG_CATEGORY_AUDIO, "%s %4.4u : not pinned to cpu %d %d %s", __FILE__, __LINE__, p_config->cpu_, result, strerror(result));
+    }
+    if (THREAD_SCHED_OTHER != p_config->policy_)
+    {
+        result = set_policy(p_config->policy_, p_config->priority_);
+        if (0 != result)
+            debug_log_warning(DEBUG_CATEGORY_AUDIO, "%s %4.4u : no %s:%d %d %s", __FILE__, __LINE__,
+                    g_policy_names[p_config->policy_], p_config->priority_, result, strerror(result));
+    }
+    thread_sched_prefault_stack();
+    get_result(p_result);
+    return p_config->policy_ == p_result->policy_ && p_config->priority_ == p_result->priority_
+        && (p_config->cpu_ < 0 || p_config->cpu_ == p_result->cpu_);
+}
+
+int thread_sched_apply_from_env(int role, struct thread_sched_result * p_result)
+{
+    char name[sizeof(THREAD_SCHED_VARIABLE_PREFIX) + 16];
+    struct thread_sched_config config;
+    char const * psz_text;
+    int result;
+    snprintf(name, sizeof(name), "%s%s", THREAD_SCHED_VARIABLE_PREFIX, thread_sched_get_role_name(role));
+    psz_text = getenv(name);
+    if (NULL == psz_text)
+    {
+        get_result(p_result);
+        return 0;
+    }
+    if (!thread_sched_parse(&config, psz_text))
+    {
+        debug_log_warning(DEBUG_CATEGORY_AUDIO, "%s %4.4u : bad %s '%s'", __FILE__, __LINE__, name, psz_text);
+        get_result(p_result);
+        return 0;
+    }
+    result = thread_sched_apply(&config, p_result);
+    debug_log_info(DEBUG_CATEGORY_AUDIO, "%s %4.4u : %s asked for '%s', got %s:%d@%d", __FILE__, __LINE__, name, psz_text,
+            g_policy_names[p_result->policy_], p_result->priority_, p_result->cpu_);
+    return result;
+}
+
+void thread_sched_prefault_stack(void)
+{
+    /* volatile, so that the compiler does not drop the writes to an area that is never read. */
+    unsigned char volatile area[THREAD_SCHED_STACK_PREFAULT];
+    size_t idx;
+    for (idx = 0; idx < sizeof(area); idx += 512)
+        area[idx] = 0;
+}
+
+int thread_sched_lock_memory(void)
+{
+    if (0 != mlockall(MCL_CURRENT | MCL_FUTURE))
+    {
+        debug_log_warning(DEBUG_CATEGORY_AUDIO, "%s %4.4u : memory not locked %d %s", __FILE__, __LINE__, errno, strerror(errno));
+        return 0;
+    }
+    return 1;
+}
+
+int thread_sched_lock_memory_from_env(void)
+{
+    char const * psz_text = getenv(THREAD_SCHED_LOCK_VARIABLE);
+    int result;
+    if (NULL == psz_text || 0 == strcmp(psz_text, "0"))
+        return 0;
+    result = thread_sched_lock_memory();
+    debug_log_info(DEBUG_CATEGORY_AUDIO, "%s %4.4u : memory %s", __FILE__, __LINE__, result ? "locked" : "not locked");
+    return result;
+}
+
+void thread_sched_dump(FILE * fp, int role, struct thread_sched_result const * p_result)
+{
+    fprintf(fp, "%s %s:%d", thread_sched_get_role_name(role), thread_sched_get_policy_name(p_result->policy_), p_result->priority_);
+    if (p_result->cpu_ >= 0)
+        fprintf(fp, "@%d", p_result->cpu_);
+    fprintf(fp, "\n");
+}
@@ -0,0 +1,185 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+
+/**
+ * @file thread-sched.h
+ * @brief Real time scheduling of the audio threads.
+ * @details The capture, send, receive and playout threads are put on SCHED_FIFO or SCHED_RR, pinned to their cores and have their stacks prefaulted, with the memory of the process locked, so that neither the scheduler nor the page faults add to their latency.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+#if !defined THREAD_SCHED_H_5021DAAC_0771_45EF_B485_2AF3F90C2D35
+#define THREAD_SCHED_H_5021DAAC_0771_45EF_B485_2AF3F90C2D35
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+#include "std-int.h"
+#include <stddef.h>
+#include <stdio.h>
+
+/*!
+ * @brief Prefix of the environment variables with the scheduling of each thread, e.g. MCAST_SCHED_SEND, see thread_sched_parse.
+ */
+#define THREAD_SCHED_VARIABLE_PREFIX "MCAST_SCHED_"
+
+/*!
+ * @brief Name of the environment variable that locks the memory of the process, if it is set to anything but 0.
+ */
+#define THREAD_SCHED_LOCK_VARIABLE "MCAST_MLOCK"
+
+/*!
+ * @brief The thread that captures the samples, or reads them from a file.
+ */
+#define THREAD_ROLE_CAPTURE (0)
+
+/*!
+ * @brief The thread that paces and sends the packets.
+ */
+#define THREAD_ROLE_SEND (1)
+
+/*!
+ * @brief The thread that receives the packets.
+ */
+#define THREAD_ROLE_RECEIVE (2)
+
+/*!
+ * @brief The thread that feeds the sound card.
+ */
+#define THREAD_ROLE_PLAYOUT (3)
+
+/*!
+ * @brief Number of the roles.
+ */
+#define THREAD_ROLE_COUNT (4)
+
+/*!
+ * @brief The default time sharing policy, SCHED_OTHER.
+ */
+#define THREAD_SCHED_OTHER (0)
+
+/*!
+ * @brief Real time, first in first out, SCHED_FIFO.
+ */
+#define THREAD_SCHED_FIFO (1)
+
+/*!
+ * @brief Real time, round robin, SCHED_RR.
+ */
+#define THREAD_SCHED_RR (2)
+
+/*!
+ * @brief Priority of the real time policies if none is given.
+ */
+#define THREAD_SCHED_DEFAULT_PRIORITY (50)
+
+/*!
+ * @brief Number of bytes of the stack that are touched, so that the thread does not take page faults later on.
+ */
+#define THREAD_SCHED_STACK_PREFAULT (64*1024)
+
+/*!
+ * @brief How a thread is to be scheduled.
+ */
+struct thread_sched_config {
+    int policy_; /*!< One of THREAD_SCHED_OTHER, THREAD_SCHED_FIFO or THREAD_SCHED_RR. */
+    int priority_; /*!< Real time priority, 0 for THREAD_SCHED_OTHER. */
+    int cpu_; /*!< The core the thread is pinned to, or -1 if it may run on any. */
+};
+
+/*!
+ * @brief How a thread has been scheduled, which may be less than asked for if the process lacks the privileges.
+ */
+struct thread_sched_result {
+    int policy_; /*!< One of THREAD_SCHED_OTHER, THREAD_SCHED_FIFO or THREAD_SCHED_RR. */
+    int priority_; /*!< Real time priority, 0 for THREAD_SCHED_OTHER. */
+    int cpu_; /*!< The only core the thread may run on, or -1 if it may run on more than one. */
+};
+
+/*!
+ * @brief Parses the scheduling of a thread.
+ * @details The text is the policy, i.e. 'other', 'fifo' or 'rr', followed by an optional ':priority' and an
+ * optional '@cpu', e.g. 'fifo:80@2' or 'other@1'.
+ * @param[out] p_config the scheduling.
+ * @param[in] psz_text the text.
+ * @return returns non zero on success, 0 if the text is malformed.
+ */
+int thread_sched_parse(struct thread_sched_config * p_config, char const * psz_text);
+
+/*!
+ * @brief Returns the name of the role, as used in the environment variable, e.g. 'SEND'.
+ */
+char const * thread_sched_get_role_name(int role);
+
+/*!
+ * @brief Returns the name of the policy, as used by thread_sched_parse.
+ */
+char const * thread_sched_get_policy_name(int policy);
+
+/*!
+ * @brief Schedules the calling thread.
+ * @details The thread is pinned first, so that the real time policy is never in force on a core it is not meant
+ * to run on. Without the privileges for the policy the priority is lowered to RLIMIT_RTPRIO, and the thread stays
+ * time shared if even that is not allowed. The stack is prefaulted in any case.
+ * @param[in] p_config how the thread is to be scheduled.
+ * @param[out] p_result how the thread has been scheduled, as reported by the system.
+ * @return returns non zero if the thread has got what was asked for, 0 otherwise.
+ */
+int thread_sched_apply(struct thread_sched_config const * p_config, struct thread_sched_result * p_result);
+
+/*!
+ * @brief Schedules the calling thread as given by the environment variable of its role, and logs the outcome.
+ * @details Threads created afterwards by this thread inherit its scheduling, so it is best called once the helper
+ * threads, e.g. the logging one, are already running.
+ * @param[in] role one of THREAD_ROLE_CAPTURE, THREAD_ROLE_SEND, THREAD_ROLE_RECEIVE or THREAD_ROLE_PLAYOUT.
+ * @param[out] p_result how the thread has been scheduled; filled in even if the variable is not set.
+ * @return returns non zero if the variable is set and the thread has got what it asks for, 0 otherwise.
+ */
+int thread_sched_apply_from_env(int role, struct thread_sched_result * p_result);
+
+/*!
+ * @brief Touches THREAD_SCHED_STACK_PREFAULT bytes of the calling thread's stack.
+ */
+void thread_sched_prefault_stack(void);
+
+/*!
+ * @brief Locks all the current and future pages of the process in memory.
+ * @return returns non zero on success, 0 if the process lacks the privileges or RLIMIT_MEMLOCK is too low.
+ */
+int thread_sched_lock_memory(void);
+
+/*!
+ * @brief Locks the memory if the THREAD_SCHED_LOCK_VARIABLE environment variable asks for it, and logs the outcome.
+ * @return returns non zero if the memory has been locked, 0 otherwise.
+ */
+int thread_sched_lock_memory_from_env(void);
+
+/*!
+ * @brief Prints how a thread of the given role has been scheduled.
+ */
+void thread_sched_dump(FILE * fp, int role, struct thread_sched_result const * p_result);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* THREAD_SCHED_H_5021DAAC_0771_45EF_B485_2AF3F90C2D35 */
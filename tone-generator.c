@@ -0,0 +1,510 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file tone-generator.c
+ * @brief Procedural test signal generator.
+ * @details The oscillators are evaluated four samples at a time with a polynomial sine, using SSE2 where available, with a scalar fallback.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include "tone-generator.h"
+#include "audio-codec.h"
+#include "wave-reader.h"
+
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#   define TONE_GENERATOR_SSE2
+#   include <emmintrin.h>
+#endif
+
+/*!
+ * @brief Number of frames generated in one go.
+ * @details The vector oscillators run in single precision, so they are set again from the double precision state
+ * at the start of each chunk, which keeps the phase and the frequency from drifting.
+ */
+#define TONE_CHUNK (256)
+
+/*!
+ * @brief Number of lanes of the vector oscillators and of the noise generators.
+ */
+#define TONE_LANES (4)
+
+/*!
+ * @brief Scales the pink noise filter output, so that its peaks stay within the amplitude.
+ */
+#define PINK_GAIN (0.1f)
+
+/*!
+ * @brief Taylor coefficients of the sine, which is only evaluated within [-pi/2, pi/2].
+ */
+#define SIN_C3 (-1.0f / 6.0f)
+#define SIN_C5 (1.0f / 120.0f)
+#define SIN_C7 (-1.0f / 5040.0f)
+#define SIN_C9 (1.0f / 362880.0f)
+
+/*!
+ * @brief 2 * pi, in single precision.
+ */
+#define TWO_PI_F (6.28318530717958647692f)
+
+/*!
+ * @brief A single sine oscillator.
+ */
+struct tone_oscillator {
+    double phase_; /*!< Phase of the next sample, in cycles, within [0, 1). */
+    double increment_; /*!< Phase increment from the next sample to the one after, in cycles. */
+    double chirp_; /*!< Change of the increment from one sample to the next, non-zero only for the sweep. */
+    float amplitude_; /*!< Peak amplitude. */
+};
+
+/*!
+ * @brief The generator.
+ */
+struct tone_generator {
+    struct tone_generator_config config_; /*!< Configuration the generator was created with. */
+    unsigned int oscillators_count_; /*!< Number of valid entries in the oscillators_ array. */
+    struct tone_oscillator oscillators_[TONE_GENERATOR_MAX_TONES]; /*!< The oscillators, unused for the noise. */
+    uint64_t position_; /*!< Number of frames generated so far. */
+    uint64_t sweep_frames_; /*!< Length of a single sweep, in frames. */
+    uint32_t noise_[TONE_LANES]; /*!< States of the xorshift generators, one per lane. */
+    float pink_[3]; /*!< States of the three poles of the pink noise filter. */
+};
+
+/*!
+ * @brief Returns the phase of the oscillator the given number of samples ahead, within [0, 1).
+ */
+static double phase_at(struct tone_oscillator const * p_osc, size_t offset)
+{
+    double const n = (double)offset;
+    double phase = p_osc->phase_ + p_osc->increment_ * n + p_osc->chirp_ * 0.5 * n * (n - 1.0);
+    return phase - floor(phase);
+}
+
+/*!
+ * @brief Computes sin(2 * pi * phase) for the phase within [0, 1].
+ * @details The phase is folded into [-1/4, 1/4], where the Taylor series up to the 9th power is accurate to a few
+ * parts per million, far below the resolution of 16-bit samples.
+ */
+static float sine_cycles(float phase)
+{
+    float t = phase >= 0.5f ? phase - 1.0f : phase;
+    float y;
+    float y2;
+    t = t < 0.5f - t ? t : 0.5f - t;
+    t = t > -0.5f - t ? t : -0.5f - t;
+    y = TWO_PI_F * t;
+    y2 = y * y;
+    return y * (1.0f + y2 * (SIN_C3 + y2 * (SIN_C5 + y2 * (SIN_C7 + y2 * SIN_C9))));
+}
+
+#if defined TONE_GENERATOR_SSE2
+/*!
+ * @brief Four lane variant of sine_cycles().
+ */
+static __m128 sine_cycles_sse2(__m128 phase)
+{
+    __m128 const half = _mm_set1_ps(0.5f);
+    __m128 t = _mm_sub_ps(phase, _mm_and_ps(_mm_cmpge_ps(phase, half), _mm_set1_ps(1.0f)));
+    __m128 y;
+    __m128 y2;
+    __m128 poly;
+    t = _mm_min_ps(t, _mm_sub_ps(half, t));
+    t = _mm_max_ps(t, _mm_sub_ps(_mm_set1_ps(-0.5f), t));
+    y = _mm_mul_ps(_mm_set1_ps(TWO_PI_F), t);
+    y2 = _mm_mul_ps(y, y);
+    poly = _mm_add_ps(_mm_set1_ps(SIN_C7), _mm_mul_ps(y2, _mm_set1_ps(SIN_C9)));
+    poly = _mm_add_ps(_mm_set1_ps(SIN_C5), _mm_mul_ps(y2, poly));
+    poly = _mm_add_ps(_mm_set1_ps(SIN_C3), _mm_mul_ps(y2, poly));
+    poly = _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(y2, poly));
+    return _mm_mul_ps(y, poly);
+}
+#endif
+
+/*!
+ * @brief Adds the next samples of the oscillator to the output.
+ * @details Each of the four lanes follows every fourth sample. For the sweep the increment grows by chirp_ per
+ * sample, so a lane advances by 4 times its own increment plus 6 times the chirp, and its increment by 4 times the chirp.
+ */
+static void render_oscillator(struct tone_oscillator * p_osc, float * p_output, size_t frames)
+{
+    size_t idx = 0;
+#if defined TONE_GENERATOR_SSE2
+    if (frames >= TONE_LANES)
+    {
+        float phases[TONE_LANES];
+        float increments[TONE_LANES];
+        unsigned int lane;
+        __m128 phase;
+        __m128 increment;
+        __m128 const amplitude = _mm_set1_ps(p_osc->amplitude_);
+        __m128 const four = _mm_set1_ps(4.0f);
+        __m128 const chirp4 = _mm_set1_ps((float)(4.0 * p_osc->chirp_));
+        __m128 const chirp6 = _mm_set1_ps((float)(6.0 * p_osc->chirp_));
+        for (lane = 0; lane < TONE_LANES; ++lane)
+        {
+            phases[lane] = (float)phase_at(p_osc, lane);
+            increments[lane] = (float)(p_osc->increment_ + p_osc->chirp_ * lane);
+        }
+        phase = _mm_loadu_ps(phases);
+        increment = _mm_loadu_ps(increments);
+        for (; idx + TONE_LANES <= frames; idx += TONE_LANES)
+        {
+            __m128 sum = _mm_add_ps(_mm_loadu_ps(&p_output[idx]), _mm_mul_ps(amplitude, sine_cycles_sse2(phase)));
+            _mm_storeu_ps(&p_output[idx], sum);
+            phase = _mm_add_ps(phase, _mm_add_ps(_mm_mul_ps(four, increment), chirp6));
+            increment = _mm_add_ps(increment, chirp4);
+            /* The phase is never negative, so the truncation is the floor. */
+            phase = _mm_sub_ps(phase, _mm_cvtepi32_ps(_mm_cvttps_epi32(phase)));
+        }
+    }
+#endif
+    for (; idx < frames; ++idx)
+        p_output[idx] += p_osc->amplitude_ * sine_cycles((float)phase_at(p_osc, idx));
+    p_osc->phase_ = phase_at(p_osc, frames);
+    p_osc->increment_ += p_osc->chirp_ * (double)frames;
+}
+
+/*!
+ * @brief Writes white noise, uniform within [-1, 1), rounded up to a multiple of TONE_LANES samples.
+ * @details Lane k of the xorshift32 generators gives the samples k, k + 4, k + 8 and so on.
+ */
+static void render_white(uint32_t * p_state, float * p_output, size_t frames)
+{
+    size_t idx = 0;
+#if defined TONE_GENERATOR_SSE2
+    __m128i x = _mm_loadu_si128((__m128i const *)p_state);
+    __m128 const scale = _mm_set1_ps(1.0f / 2147483648.0f);
+    for (; idx < frames; idx += TONE_LANES)
+    {
+        x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+        x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+        x = _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+        _mm_storeu_ps(&p_output[idx], _mm_mul_ps(_mm_cvtepi32_ps(x), scale));
+    }
+    _mm_storeu_si128((__m128i *)p_state, x);
+#else
+    for (; idx < frames; idx += TONE_LANES)
+    {
+        unsigned int lane;
+        for (lane = 0; lane < TONE_LANES; ++lane)
+        {
+            uint32_t x = p_state[lane];
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            p_state[lane] = x;
+            p_output[idx + lane] = (float)(int32_t)x * (1.0f / 2147483648.0f);
+        }
+    }
+#endif
+}
+
+/*!
+ * @brief Writes the next samples of the pink noise.
+ * @details White noise filtered by the three pole approximation of the -3 dB/octave slope by Paul Kellet.
+ */
+static void render_pink(struct tone_generator * p_generator, float * p_output, size_t frames)
+{
+    float white[TONE_CHUNK];
+    float const gain = p_generator->config_.amplitude_ * PINK_GAIN;
+    float b0 = p_generator->pink_[0];
+    float b1 = p_generator->pink_[1];
+    float b2 = p_generator->pink_[2];
+    size_t idx;
+    assert(frames <= TONE_CHUNK);
+    render_white(p_generator->noise_, white, frames);
+    for (idx = 0; idx < frames; ++idx)
+    {
+        float const w = white[idx];
+        b0 = 0.99765f * b0 + w * 0.0990460f;
+        b1 = 0.96300f * b1 + w * 0.2965164f;
+        b2 = 0.57000f * b2 + w * 1.0526913f;
+        p_output[idx] = gain * (b0 + b1 + b2 + w * 0.1848f);
+    }
+    p_generator->pink_[0] = b0;
+    p_generator->pink_[1] = b1;
+    p_generator->pink_[2] = b2;
+}
+
+int tone_generator_parse(struct tone_generator_config * p_config, char const * psz_spec)
+{
+    char name[8];
+    int consumed = 0;
+    memset(p_config, 0, sizeof(struct tone_generator_config));
+    p_config->sample_rate_ = 44100;
+    p_config->channels_ = 2;
+    p_config->amplitude_ = 0.5f;
+    p_config->seed_ = 1;
+    p_config->packet_frames_ = TONE_GENERATOR_DEFAULT_PACKET_FRAMES;
+    if (1 != sscanf(psz_spec, "%7[a-z]%n", name, &consumed))
+        return 0;
+    /* All the parameters are numbers, each preceded by a colon. */
+    for (psz_spec += consumed; ':' == *psz_spec; psz_spec += consumed)
+    {
+        float value;
+        if (p_config->tones_count_ >= TONE_GENERATOR_MAX_TONES || 1 != sscanf(psz_spec, ":%f%n", &value, &consumed))
+            return 0;
+        p_config->frequencies_[p_config->tones_count_++] = value;
+    }
+    if ('\0' != *psz_spec)
+        return 0;
+    if (0 == strcmp(name, "sine") && 1 == p_config->tones_count_)
+        p_config->type_ = TONE_GENERATOR_SINE;
+    else if (0 == strcmp(name, "sweep") && 3 == p_config->tones_count_)
+    {
+        p_config->type_ = TONE_GENERATOR_SWEEP;
+        p_config->sweep_seconds_ = p_config->frequencies_[2];
+        p_config->frequencies_[2] = 0.0f;
+        p_config->tones_count_ = 2;
+    }
+    else if (0 == strcmp(name, "multi") && p_config->tones_count_ > 0)
+        p_config->type_ = TONE_GENERATOR_MULTI;
+    else if (0 == strcmp(name, "pink") && p_config->tones_count_ <= 1)
+    {
+        p_config->type_ = TONE_GENERATOR_PINK;
+        if (1 == p_config->tones_count_)
+            p_config->seed_ = (uint32_t)p_config->frequencies_[0];
+        p_config->frequencies_[0] = 0.0f;
+        p_config->tones_count_ = 0;
+    }
+    else if (0 == strcmp(name, "seq") && 2 == p_config->tones_count_)
+        p_config->type_ = TONE_GENERATOR_SEQUENCE;
+    else
+        return 0;
+    return 1;
+}
+
+float tone_generator_sequence_frequency(struct tone_generator_config const * p_config, uint64_t sequence)
+{
+    return p_config->frequencies_[0] + (float)(sequence % TONE_GENERATOR_SEQUENCE_SLOTS) * p_config->frequencies_[1];
+}
+
+/*!
+ * @brief Checks that the frequency can be represented at the given sampling rate.
+ */
+static int is_valid_frequency(float frequency, unsigned int sample_rate)
+{
+    return frequency > 0.0f && 2.0f * frequency < (float)sample_rate;
+}
+
+struct tone_generator * tone_generator_create(struct tone_generator_config const * p_config)
+{
+    struct tone_generator * p_generator;
+    unsigned int idx;
+    if (0 == p_config->sample_rate_ || 0 == p_config->channels_
+            || !(p_config->amplitude_ > 0.0f && p_config->amplitude_ <= 1.0f)
+            || p_config->tones_count_ > TONE_GENERATOR_MAX_TONES)
+        return NULL;
+    switch (p_config->type_)
+    {
+        case TONE_GENERATOR_SINE:
+        case TONE_GENERATOR_MULTI:
+            if (0 == p_config->tones_count_)
+                return NULL;
+            for (idx = 0; idx < p_config->tones_count_; ++idx)
+                if (!is_valid_frequency(p_config->frequencies_[idx], p_config->sample_rate_))
+                    return NULL;
+            break;
+        case TONE_GENERATOR_SWEEP:
+            if (!is_valid_frequency(p_config->frequencies_[0], p_config->sample_rate_)
+                    || !is_valid_frequency(p_config->frequencies_[1], p_config->sample_rate_)
+                    || !(p_config->sweep_seconds_ * p_config->sample_rate_ >= 1.0f))
+                return NULL;
+            break;
+        case TONE_GENERATOR_PINK:
+            break;
+        case TONE_GENERATOR_SEQUENCE:
+            if (0 == p_config->packet_frames_ || p_config->frequencies_[1] < 0.0f
+                    || !is_valid_frequency(p_config->frequencies_[0], p_config->sample_rate_)
+                    || !is_valid_frequency(tone_generator_sequence_frequency(p_config, TONE_GENERATOR_SEQUENCE_SLOTS - 1), p_config->sample_rate_))
+                return NULL;
+            break;
+        default:
+            return NULL;
+    }
+    p_generator = (struct tone_generator *)calloc(1, sizeof(struct tone_generator));
+    if (NULL == p_generator)
+        return NULL;
+    p_generator->config_ = *p_config;
+    switch (p_config->type_)
+    {
+        case TONE_GENERATOR_SINE:
+        case TONE_GENERATOR_MULTI:
+            p_generator->oscillators_count_ = p_config->tones_count_;
+            for (idx = 0; idx < p_config->tones_count_; ++idx)
+            {
+                p_generator->oscillators_[idx].increment_ = (double)p_config->frequencies_[idx] / p_config->sample_rate_;
+                p_generator->oscillators_[idx].amplitude_ = p_config->amplitude_ / (float)p_config->tones_count_;
+            }
+            break;
+        case TONE_GENERATOR_SWEEP:
+            p_generator->oscillators_count_ = 1;
+            p_generator->sweep_frames_ = (uint64_t)(p_config->sweep_seconds_ * p_config->sample_rate_);
+            p_generator->oscillators_[0].chirp_ = ((double)p_config->frequencies_[1] - p_config->frequencies_[0])
+                / p_config->sample_rate_ / (double)p_generator->sweep_frames_;
+            p_generator->oscillators_[0].amplitude_ = p_config->amplitude_;
+            break;
+        case TONE_GENERATOR_SEQUENCE:
+            /* The increment is set at the start of each packet. */
+            p_generator->oscillators_count_ = 1;
+            p_generator->oscillators_[0].amplitude_ = p_config->amplitude_;
+            break;
+        default:
+            break;
+    }
+    /* The lanes must differ, and none may be 0, where xorshift would stay forever. */
+    for (idx = 0; idx < TONE_LANES; ++idx)
+    {
+        p_generator->noise_[idx] = p_config->seed_ ^ (0x9E3779B9u * (idx + 1));
+        if (0 == p_generator->noise_[idx])
+            p_generator->noise_[idx] = idx + 1;
+    }
+    return p_generator;
+}
+
+struct tone_generator_config const * tone_generator_get_config(struct tone_generator const * p_generator)
+{
+    return &p_generator->config_;
+}
+
+uint64_t tone_generator_get_position(struct tone_generator const * p_generator)
+{
+    return p_generator->position_;
+}
+
+void tone_generator_fill_float(struct tone_generator * p_generator, float * p_output, size_t frames)
+{
+    struct tone_generator_config const * p_config = &p_generator->config_;
+    while (frames > 0)
+    {
+        size_t count = frames < TONE_CHUNK ? frames : TONE_CHUNK;
+        unsigned int idx;
+        /* A chunk never crosses the end of a sweep, or a packet of the sequence tone. */
+        if (TONE_GENERATOR_SWEEP == p_config->type_)
+        {
+            uint64_t const offset = p_generator->position_ % p_generator->sweep_frames_;
+            if (0 == offset)
+                p_generator->oscillators_[0].increment_ = (double)p_config->frequencies_[0] / p_config->sample_rate_;
+            if (count > p_generator->sweep_frames_ - offset)
+                count = (size_t)(p_generator->sweep_frames_ - offset);
+        }
+        else if (TONE_GENERATOR_SEQUENCE == p_config->type_)
+        {
+            uint64_t const offset = p_generator->position_ % p_config->packet_frames_;
+            if (0 == offset)
+                p_generator->oscillators_[0].increment_ = (double)tone_generator_sequence_frequency(p_config,
+                        p_generator->position_ / p_config->packet_frames_) / p_config->sample_rate_;
+            if (count > p_config->packet_frames_ - offset)
+                count = (size_t)(p_config->packet_frames_ - offset);
+        }
+        if (TONE_GENERATOR_PINK == p_config->type_)
+            render_pink(p_generator, p_output, count);
+        else
+        {
+            memset(p_output, 0, count * sizeof(float));
+            for (idx = 0; idx < p_generator->oscillators_count_; ++idx)
+                render_oscillator(&p_generator->oscillators_[idx], p_output, count);
+        }
+        p_generator->position_ += count;
+        p_output += count;
+        frames -= count;
+    }
+}
+
+void tone_generator_fill(struct tone_generator * p_generator, int16_t * p_output, size_t frames)
+{
+    float samples[TONE_CHUNK];
+    int16_t mono[TONE_CHUNK];
+    unsigned int const channels = p_generator->config_.channels_;
+    while (frames > 0)
+    {
+        size_t const count = frames < TONE_CHUNK ? frames : TONE_CHUNK;
+        size_t idx;
+        tone_generator_fill_float(p_generator, samples, count);
+        audio_codec_float_to_int16(samples, mono, count);
+        if (1 == channels)
+            memcpy(p_output, mono, count * sizeof(int16_t));
+        else
+        {
+            for (idx = 0; idx < count; ++idx)
+            {
+                unsigned int channel;
+                for (channel = 0; channel < channels; ++channel)
+                    p_output[idx * channels + channel] = mono[idx];
+            }
+        }
+        p_output += count * channels;
+        frames -= count;
+    }
+}
+
+unsigned int tone_generator_decode_sequence(struct tone_generator_config const * p_config, int16_t const * p_samples, size_t frames)
+{
+    unsigned int best_slot = 0;
+    double best_power = -1.0;
+    unsigned int slot;
+    for (slot = 0; slot < TONE_GENERATOR_SEQUENCE_SLOTS; ++slot)
+    {
+        /* Goertzel filter tuned to the frequency of the slot. */
+        double const coeff = 2.0 * cos(2.0 * M_PI * tone_generator_sequence_frequency(p_config, slot) / p_config->sample_rate_);
+        double s1 = 0.0;
+        double s2 = 0.0;
+        double power;
+        size_t idx;
+        for (idx = 0; idx < frames; ++idx)
+        {
+            double const s0 = p_samples[idx * p_config->channels_] + coeff * s1 - s2;
+            s2 = s1;
+            s1 = s0;
+        }
+        power = s1 * s1 + s2 * s2 - coeff * s1 * s2;
+        if (power > best_power)
+        {
+            best_power = power;
+            best_slot = slot;
+        }
+    }
+    return best_slot;
+}
+
+void * tone_generator_render_wave(struct tone_generator * p_generator, size_t frames, size_t * p_size)
+{
+    struct tone_generator_config const * p_config = &p_generator->config_;
+    uint32_t const block_align = p_config->channels_ * sizeof(int16_t);
+    uint8_t * p_image;
+    size_t data_size;
+    if (frames > (UINT32_MAX - WAVE_READER_HEADER_SIZE) / block_align)
+        return NULL;
+    data_size = frames * block_align;
+    p_image = (uint8_t *)malloc(WAVE_READER_HEADER_SIZE + data_size);
+    if (NULL == p_image)
+        return NULL;
+    wave_reader_make_header(p_image, p_config->sample_rate_, p_config->channels_, frames);
+    tone_generator_fill(p_generator, (int16_t *)&p_image[WAVE_READER_HEADER_SIZE], frames);
+    *p_size = WAVE_READER_HEADER_SIZE + data_size;
+    return p_image;
+}
+
+void tone_generator_destroy(struct tone_generator * p_generator)
+{
+    free(p_generator);
+}
@@ -0,0 +1,195 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+
+/**
+ * @file tone-generator.h
+ * @brief Procedural test signal generator.
+ * @details Generates sines, sweeps, multi-tones, pink noise and sequence-encoded tones, so that no WAV files are needed to feed the sender.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+#if !defined TONE_GENERATOR_H_342327F6_8048_4D6D_8FED_0B033E497505
+#define TONE_GENERATOR_H_342327F6_8048_4D6D_8FED_0B033E497505
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+#include "std-int.h"
+#include <stddef.h>
+
+/*!
+ * @brief A single sine, e.g. "sine:440".
+ */
+#define TONE_GENERATOR_SINE (0)
+
+/*!
+ * @brief A linear sweep that starts over when it reaches the end frequency, e.g. "sweep:100:8000:5" for 5 seconds.
+ */
+#define TONE_GENERATOR_SWEEP (1)
+
+/*!
+ * @brief Sum of several sines of equal amplitude, e.g. "multi:440:660:880".
+ */
+#define TONE_GENERATOR_MULTI (2)
+
+/*!
+ * @brief Pink noise, optionally with the seed, e.g. "pink" or "pink:7".
+ */
+#define TONE_GENERATOR_PINK (3)
+
+/*!
+ * @brief A sine whose frequency tells the sequence number of the packet, e.g. "seq:1000:250".
+ * @details Packet n has the frequency base + (n % TONE_GENERATOR_SEQUENCE_SLOTS) * step, so a receiver can tell
+ * from the samples alone which packets were lost or reordered.
+ */
+#define TONE_GENERATOR_SEQUENCE (4)
+
+/*!
+ * @brief Maximum number of sines of the multi-tone.
+ */
+#define TONE_GENERATOR_MAX_TONES (8)
+
+/*!
+ * @brief Number of distinct frequencies used by the sequence tone.
+ */
+#define TONE_GENERATOR_SEQUENCE_SLOTS (16)
+
+/*!
+ * @brief Number of frames in a single packet of the sequence tone, unless set otherwise.
+ */
+#define TONE_GENERATOR_DEFAULT_PACKET_FRAMES (256)
+
+/*!
+ * @brief Length of the WAV image rendered by tone_generator_render_wave() for the abstract tone, in seconds.
+ */
+#define TONE_GENERATOR_WAVE_SECONDS (10)
+
+/*!
+ * @brief Describes the signal.
+ */
+struct tone_generator_config {
+    unsigned int type_; /*!< One of the TONE_GENERATOR_* types. */
+    unsigned int sample_rate_; /*!< Sampling rate, in Hz. */
+    unsigned int channels_; /*!< Number of interleaved channels written by tone_generator_fill(). All carry the same signal. */
+    float amplitude_; /*!< Peak amplitude, as a fraction of the full scale. */
+    unsigned int tones_count_; /*!< Number of valid entries in the frequencies_ array. */
+    float frequencies_[TONE_GENERATOR_MAX_TONES]; /*!< The frequencies in Hz. For the sweep: start and end. For the sequence: base and step. */
+    float sweep_seconds_; /*!< Duration of a single sweep. */
+    uint32_t seed_; /*!< Seed of the noise. */
+    unsigned int packet_frames_; /*!< Number of frames in a single packet of the sequence tone. */
+};
+
+/*!
+ * @brief Forward declaration.
+ */
+struct tone_generator;
+
+/*!
+ * @brief Parses the signal description.
+ * @details The configuration is reset to 44100 Hz, 2 channels, half of the full scale and
+ * TONE_GENERATOR_DEFAULT_PACKET_FRAMES frames per packet. Then the type and its parameters are taken from the
+ * description, see the TONE_GENERATOR_* types for the syntax. The defaults may be changed before the configuration
+ * is passed to tone_generator_create().
+ * @param[out] p_config this structure will be written with the parsed description.
+ * @param[in] psz_spec the description.
+ * @return returns non-zero on success, 0 if the description is malformed.
+ */
+int tone_generator_parse(struct tone_generator_config * p_config, char const * psz_spec);
+
+/*!
+ * @brief Creates the generator.
+ * @details The generator takes a few hundred bytes and needs no files, so thousands of them, each with its own
+ * frequencies or seed, may be created for load tests.
+ * @param[in] p_config the configuration.
+ * @return returns a handle to the generator, or NULL if the configuration is invalid, e.g. a frequency is above the
+ * Nyquist frequency.
+ */
+struct tone_generator * tone_generator_create(struct tone_generator_config const * p_config);
+
+/*!
+ * @brief Returns the configuration the generator was created with.
+ */
+struct tone_generator_config const * tone_generator_get_config(struct tone_generator const * p_generator);
+
+/*!
+ * @brief Returns number of frames generated so far.
+ */
+uint64_t tone_generator_get_position(struct tone_generator const * p_generator);
+
+/*!
+ * @brief Generates the next frames of the signal as a single channel of floats.
+ * @details The oscillators and the noise are computed four samples at a time with SSE2 where available, with a
+ * scalar fallback.
+ * @param[in] p_generator a handle to the generator.
+ * @param[out] p_output the samples, in the range [-1, 1].
+ * @param[in] frames number of frames to generate.
+ */
+void tone_generator_fill_float(struct tone_generator * p_generator, float * p_output, size_t frames);
+
+/*!
+ * @brief Generates the next frames of the signal as interleaved 16-bit samples.
+ * @param[in] p_generator a handle to the generator.
+ * @param[out] p_output the samples, channels_ per frame.
+ * @param[in] frames number of frames to generate.
+ */
+void tone_generator_fill(struct tone_generator * p_generator, int16_t * p_output, size_t frames);
+
+/*!
+ * @brief Returns the frequency the sequence tone uses for the given packet.
+ * @param[in] p_config configuration of the sequence tone.
+ * @param[in] sequence number of the packet.
+ * @return returns the frequency, in Hz.
+ */
+float tone_generator_sequence_frequency(struct tone_generator_config const * p_config, uint64_t sequence);
+
+/*!
+ * @brief Tells which slot of the sequence tone the samples of a single packet carry.
+ * @details Measures the energy at each of the TONE_GENERATOR_SEQUENCE_SLOTS frequencies in the first channel.
+ * @param[in] p_config configuration of the sequence tone.
+ * @param[in] p_samples interleaved samples of a single packet.
+ * @param[in] frames number of frames in the packet.
+ * @return returns the sequence number of the packet modulo TONE_GENERATOR_SEQUENCE_SLOTS.
+ */
+unsigned int tone_generator_decode_sequence(struct tone_generator_config const * p_config, int16_t const * p_samples, size_t frames);
+
+/*!
+ * @brief Renders the next frames as a 16-bit PCM WAV image.
+ * @details The image is a canonical RIFF WAVE file, i.e. a fmt chunk followed by the data chunk, so it can stand in
+ * for a WAV file loaded from the disk or from the resources.
+ * @param[in] p_generator a handle to the generator.
+ * @param[in] frames number of frames to render.
+ * @param[out] p_size this location will be written with the size of the image.
+ * @return returns the image, to be released with free(), or NULL if there is not enough memory.
+ */
+void * tone_generator_render_wave(struct tone_generator * p_generator, size_t frames, size_t * p_size);
+
+/*!
+ * @brief Destroys the generator.
+ * @param[in] p_generator a handle to the generator obtained via call to tone_generator_create.
+ */
+void tone_generator_destroy(struct tone_generator * p_generator);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* TONE_GENERATOR_H_342327F6_8048_4D6D_8FED_0B033E497505 */
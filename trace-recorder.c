@@ -0,0 +1,217 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file trace-recorder.c
+ * @brief Low overhead recorder of the pipeline spans.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include "trace-recorder.h"
+#include "debug_helpers.h"
+#include "perf-counter-itf.h"
+#if !defined WIN32
+#   include <sys/syscall.h>
+#endif
+
+#if defined _MSC_VER
+#   define TRACE_LOAD_ACQUIRE(x) (*(uint64_t volatile const *)&(x))
+#   define TRACE_STORE_RELEASE(x, v) (*(uint64_t volatile *)&(x) = (v))
+#else
+#   define TRACE_LOAD_ACQUIRE(x) __atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+#   define TRACE_STORE_RELEASE(x, v) __atomic_store_n(&(x), (v), __ATOMIC_RELEASE)
+#endif
+
+/*!
+ * @brief A single event.
+ */
+struct trace_event {
+    char const * psz_name_; /*!< Name of the span. */
+    uint64_t time_; /*!< When the event happened, in nanoseconds of the monotonic clock. */
+    char phase_; /*!< Either 'B' or 'E'. */
+};
+
+/*!
+ * @brief Events of a single thread.
+ * @details Only the owning thread writes the events. The dumping thread reads head_ before and after copying
+ * the events, and drops the ones that might have been overwritten in between.
+ */
+struct trace_ring {
+    struct trace_ring * p_next_; /*!< Next ring on the list of all the rings. */
+    unsigned long tid_; /*!< Identifier of the owning thread. */
+    uint64_t head_; /*!< Free running number of events recorded. */
+    struct trace_event events_[TRACE_RECORDER_RING_EVENTS]; /*!< The events. */
+};
+
+int g_trace_enabled;
+
+/*!
+ * @brief All the rings ever allocated.
+ * @details The rings are never freed, so that the events of the threads that have already exited are still dumped.
+ */
+static struct trace_ring * g_rings;
+
+static THREAD_LOCAL struct trace_ring * g_thread_ring;
+
+void trace_recorder_enable(int enabled)
+{
+    g_trace_enabled = enabled;
+}
+
+int trace_recorder_is_enabled(void)
+{
+    return g_trace_enabled;
+}
+
+char const * trace_recorder_enable_from_env(void)
+{
+    char const * psz_path = getenv(TRACE_RECORDER_PATH_VARIABLE);
+    if (NULL != psz_path && '\0' != *psz_path)
+    {
+        trace_recorder_enable(1);
+        return psz_path;
+    }
+    return NULL;
+}
+
+/*!
+ * @brief Returns the calling thread's ring, allocates it on the first call.
+ */
+static struct trace_ring * get_ring(void)
+{
+    struct trace_ring * p_ring = g_thread_ring;
+    if (NULL == p_ring)
+    {
+        p_ring = (struct trace_ring *)calloc(1, sizeof(struct trace_ring));
+        if (NULL == p_ring)
+            return NULL;
+#if defined WIN32
+        p_ring->tid_ = GetCurrentThreadId();
+        do {
+            p_ring->p_next_ = g_rings;
+        } while (p_ring->p_next_ != InterlockedCompareExchangePointer((PVOID volatile *)&g_rings, p_ring, p_ring->p_next_));
+#else
+        p_ring->tid_ = (unsigned long)syscall(SYS_gettid);
+        p_ring->p_next_ = __atomic_load_n(&g_rings, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&g_rings, &p_ring->p_next_, p_ring, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+            ;
+#endif
+        g_thread_ring = p_ring;
+    }
+    return p_ring;
+}
+
+static void record(char const * psz_name, char phase)
+{
+    struct trace_ring * p_ring = get_ring();
+    if (NULL != p_ring)
+    {
+        uint64_t head = p_ring->head_;
+        struct trace_event * p_event = &p_ring->events_[head & (TRACE_RECORDER_RING_EVENTS - 1)];
+        p_event->psz_name_ = psz_name;
+        p_event->time_ = perf_counter_get_monotonic_ns();
+        p_event->phase_ = phase;
+        TRACE_STORE_RELEASE(p_ring->head_, head + 1);
+    }
+}
+
+void trace_recorder_begin(char const * psz_name)
+{
+    record(psz_name, 'B');
+}
+
+void trace_recorder_end(char const * psz_name)
+{
+    record(psz_name, 'E');
+}
+
+/*!
+ * @brief Writes the events of a single ring.
+ * @return returns number of events written.
+ */
+static size_t dump_ring(FILE * fp, struct trace_ring const * p_ring, struct trace_event * p_copy, unsigned long pid, size_t written)
+{
+    uint64_t head = TRACE_LOAD_ACQUIRE(p_ring->head_);
+    uint64_t copied = head > TRACE_RECORDER_RING_EVENTS ? head - TRACE_RECORDER_RING_EVENTS : 0;
+    uint64_t first = copied;
+    uint64_t new_head;
+    uint64_t idx;
+    for (idx = copied; idx < head; ++idx)
+        p_copy[idx - copied] = p_ring->events_[idx & (TRACE_RECORDER_RING_EVENTS - 1)];
+    /* Whatever the owner recorded in the meantime, including the event it may be writing right now,
+     * went over the oldest copied events. The calling thread's own ring is not being written to. */
+    new_head = TRACE_LOAD_ACQUIRE(p_ring->head_);
+    if (p_ring != g_thread_ring)
+        ++new_head;
+    if (new_head > first + TRACE_RECORDER_RING_EVENTS)
+        first = min(new_head - TRACE_RECORDER_RING_EVENTS, head);
+    for (idx = first; idx < head; ++idx)
+    {
+        struct trace_event const * p_event = &p_copy[idx - copied];
+        fprintf(fp, "%s\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%llu.%3.3u,\"pid\":%lu,\"tid\":%lu}",
+                0 == written ? "" : ",",
+                p_event->psz_name_,
+                p_event->phase_,
+                (unsigned long long)(p_event->time_ / 1000),
+                (unsigned int)(p_event->time_ % 1000),
+                pid,
+                p_ring->tid_);
+        ++written;
+    }
+    return written;
+}
+
+int trace_recorder_dump(char const * psz_path)
+{
+    struct trace_ring const * p_ring;
+    struct trace_event * p_copy;
+    size_t written = 0;
+    unsigned long pid;
+    FILE * fp = fopen(psz_path, "w");
+    if (NULL == fp)
+    {
+        debug_log_error(DEBUG_CATEGORY_ALL, "%s %4.4u : %s %d %s", __FILE__, __LINE__, psz_path, errno, strerror(errno));
+        return 0;
+    }
+    p_copy = (struct trace_event *)malloc(TRACE_RECORDER_RING_EVENTS * sizeof(struct trace_event));
+    if (NULL == p_copy)
+    {
+        fclose(fp);
+        return 0;
+    }
+#if defined WIN32
+    pid = GetCurrentProcessId();
+    p_ring = (struct trace_ring const *)InterlockedCompareExchangePointer((PVOID volatile *)&g_rings, NULL, NULL);
+#else
+    pid = (unsigned long)getpid();
+    p_ring = __atomic_load_n(&g_rings, __ATOMIC_ACQUIRE);
+#endif
+    fprintf(fp, "{\"traceEvents\":[");
+    for (; NULL != p_ring; p_ring = p_ring->p_next_)
+        written = dump_ring(fp, p_ring, p_copy, pid, written);
+    fprintf(fp, "\n],\"displayTimeUnit\":\"ns\"}\n");
+    free(p_copy);
+    if (0 != fclose(fp))
+        return 0;
+    debug_log_info(DEBUG_CATEGORY_ALL, "%s %4.4u : %lu events written to %s", __FILE__, __LINE__, (unsigned long)written, psz_path);
+    return 1;
+}
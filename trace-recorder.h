@@ -0,0 +1,111 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+
+/**
+ * @file trace-recorder.h
+ * @brief Low overhead recorder of the pipeline spans.
+ * @details Each thread records begin and end events into a ring of its own. The rings are dumped on demand in the Chrome trace_event format.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+#if !defined TRACE_RECORDER_H_5B94E0C2_7D31_4A6F_B8E5_1C0F3D92A746
+#define TRACE_RECORDER_H_5B94E0C2_7D31_4A6F_B8E5_1C0F3D92A746
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * @brief Number of events each thread keeps. When a thread records more, its oldest events are overwritten.
+ */
+#define TRACE_RECORDER_RING_EVENTS (16384)
+
+/*!
+ * @brief Name of the environment variable that enables the recording and tells where to dump it.
+ */
+#define TRACE_RECORDER_PATH_VARIABLE "MCAST_TRACE"
+
+/*!
+ * @brief Enables or disables the recording.
+ * @details The recording is disabled by default. Events recorded so far are kept when the recording is disabled.
+ * @param[in] enabled non-zero to enable the recording, 0 to disable it.
+ */
+void trace_recorder_enable(int enabled);
+
+/*!
+ * @brief Returns non-zero if the recording is enabled.
+ */
+int trace_recorder_is_enabled(void);
+
+/*!
+ * @brief Enables the recording if the TRACE_RECORDER_PATH_VARIABLE environment variable is set.
+ * @return returns the value of the variable, i.e. path to dump the trace to, or NULL if the variable is not set.
+ */
+char const * trace_recorder_enable_from_env(void);
+
+/*!
+ * @brief Records the beginning of a span on the calling thread's ring.
+ * @details The first event recorded by a thread allocates the thread's ring. Later ones take no locks
+ * and make no system calls other than reading the clock.
+ * @param[in] psz_name name of the span. Only the pointer is recorded, so it must be a string literal.
+ */
+void trace_recorder_begin(char const * psz_name);
+
+/*!
+ * @brief Records the end of a span on the calling thread's ring.
+ * @param[in] psz_name name of the span, the same as given to trace_recorder_begin.
+ */
+void trace_recorder_end(char const * psz_name);
+
+/*!
+ * @brief Writes all the recorded events as a Chrome trace_event JSON file.
+ * @details May be called at any time, from any thread. The file can be opened with chrome://tracing or Perfetto.
+ * @param[in] psz_path path of the file to write.
+ * @return returns non-zero on success, 0 if the file could not be written.
+ */
+int trace_recorder_dump(char const * psz_path);
+
+#if defined WIN32
+/* The flag lives in the DLL, so it is read through the function. */
+#   define TRACE_RECORDER_ENABLED() trace_recorder_is_enabled()
+#else
+/*!
+ * @brief Non-zero if the recording is enabled. Use trace_recorder_enable to change it.
+ */
+extern int g_trace_enabled;
+#   define TRACE_RECORDER_ENABLED() (0 != g_trace_enabled)
+#endif
+
+/*!
+ * @brief Marks the beginning of a span. Costs a single branch when the recording is disabled.
+ */
+#define TRACE_BEGIN(name) do { if (TRACE_RECORDER_ENABLED()) trace_recorder_begin(name); } while (0)
+
+/*!
+ * @brief Marks the end of a span.
+ */
+#define TRACE_END(name) do { if (TRACE_RECORDER_ENABLED()) trace_recorder_end(name); } while (0)
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* TRACE_RECORDER_H_5B94E0C2_7D31_4A6F_B8E5_1C0F3D92A746 */
@@ -27,14 +27,21 @@
  * @details 
  */
 #include "pcc.h"
-#include <mmsystem.h>
 #include "abstract-tone.h"
-#include "sender-res.h"
+#include "tone-generator.h"
+#include "wave-reader.h"
+#if defined WIN32
+#   include <mmsystem.h>
+#   include "sender-res.h"
+#   define TEST_TONE_NAME MAKEINTRESOURCE(IDR_0_1)
+#else
+#   define TEST_TONE_NAME NULL
+#endif
 
 void test_00(void)
 {
 	struct abstract_tone * p_tone;
-	p_tone = abstract_tone_create(EMBEDDED_TEST_TONE, MAKEINTRESOURCE(IDR_0_1));
+	p_tone = abstract_tone_create(EMBEDDED_TEST_TONE, TEST_TONE_NAME);
 	assert(p_tone);
 	abstract_tone_destroy(p_tone);
 }
@@ -44,7 +51,7 @@ void test_01(void)
 	struct abstract_tone * p_tone;
     uint8_t const * p_data;
     size_t data_size = 0;
-	p_tone = abstract_tone_create(EMBEDDED_TEST_TONE, MAKEINTRESOURCE(IDR_0_1));
+	p_tone = abstract_tone_create(EMBEDDED_TEST_TONE, TEST_TONE_NAME);
 	assert(p_tone);
     p_data = (uint8_t const *)abstract_tone_get_wave_data(p_tone, &data_size);
     assert(p_data);
@@ -55,16 +62,59 @@ void test_01(void)
 void test_02(void)
 {
 	struct abstract_tone * p_tone;
-	p_tone = abstract_tone_create(EMBEDDED_TEST_TONE, MAKEINTRESOURCE(IDR_0_1));
+	p_tone = abstract_tone_create(EMBEDDED_TEST_TONE, TEST_TONE_NAME);
 	assert(p_tone);
 	abstract_tone_destroy(p_tone);
 }
 
+void test_03(void)
+{
+	struct abstract_tone * p_tone;
+    size_t data_size = 0;
+	p_tone = abstract_tone_create(GENERATED_TONE, "sweep:100:8000:5");
+	assert(p_tone);
+    assert(abstract_tone_get_wave_data(p_tone, &data_size));
+    assert(TONE_GENERATOR_WAVE_SECONDS * 44100 * 2 * sizeof(int16_t) == data_size);
+	abstract_tone_destroy(p_tone);
+	assert(NULL == abstract_tone_create(GENERATED_TONE, "sweep:100"));
+}
+
+void test_04(void)
+{
+	struct abstract_tone * p_tone;
+    struct wave_reader_format const * p_format;
+    size_t data_size = 0;
+	p_tone = abstract_tone_create(EXTERNAL_WAV_TONE, "sin250Hz.wav");
+	assert(p_tone);
+    p_format = abstract_tone_get_format(p_tone);
+    assert(8000 == p_format->sample_rate_ && 1 == p_format->channels_ && 16 == p_format->bits_per_sample_);
+    assert(abstract_tone_get_wave_data(p_tone, &data_size));
+    assert(wave_reader_get_frames_count(abstract_tone_get_reader(p_tone)) * sizeof(int16_t) == data_size);
+    assert(0 != data_size);
+	abstract_tone_destroy(p_tone);
+	assert(NULL == abstract_tone_create(EXTERNAL_WAV_TONE, "no-such-file.wav"));
+}
+
+void test_05(void)
+{
+	struct abstract_tone * p_tone;
+    char buffer[128];
+	p_tone = abstract_tone_create(EMBEDDED_TEST_TONE, TEST_TONE_NAME);
+	assert(p_tone);
+    assert(8000 == abstract_tone_get_format(p_tone)->sample_rate_);
+    assert(0 != abstract_tone_dump(p_tone, buffer, sizeof(buffer)));
+    assert(NULL != strstr(buffer, "8000 Hz"));
+	abstract_tone_destroy(p_tone);
+}
+
 int main(int argc, char ** argv)
 {
 	test_00();
 	test_01();
 	test_02();
+	test_03();
+	test_04();
+	test_05();
 	return 0;
 }
 
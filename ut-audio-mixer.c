@@ -0,0 +1,310 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file ut-audio-mixer.c
+ * @brief Unit tests for the jitter buffer and the mixer.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include <stdlib.h>
+#include <string.h>
+#include "jitter-buffer.h"
+#include "audio-mixer.h"
+#include "mcast-packet.h"
+#include "latency-histogram.h"
+
+/*!
+ * @brief An assert macro that works with RELEASE builds.
+ */
+#define MY_ASSERT(cond) do { if(!(cond)) fprintf(stderr, "%s %u\n", __FILE__, __LINE__), abort(); } while(0)
+
+#define PACKET_SAMPLES (160)
+
+static void fill(int16_t * p_samples, size_t count, int16_t value)
+{
+    size_t idx;
+    for (idx = 0; idx < count; ++idx)
+        p_samples[idx] = value;
+}
+
+static int all_equal(int16_t const * p_samples, size_t count, int16_t value)
+{
+    size_t idx;
+    for (idx = 0; idx < count; ++idx)
+        if (p_samples[idx] != value)
+            return 0;
+    return 1;
+}
+
+static void test_jitter_buffer_create(void)
+{
+    struct jitter_buffer * p_jb;
+    MY_ASSERT(NULL == jitter_buffer_create(0, PACKET_SAMPLES, 1));
+    MY_ASSERT(NULL == jitter_buffer_create(16, PACKET_SAMPLES, 1));
+    MY_ASSERT(NULL == jitter_buffer_create(2, 0, 1));
+    MY_ASSERT(NULL == jitter_buffer_create(2, PACKET_SAMPLES, 5));
+    p_jb = jitter_buffer_create(4, PACKET_SAMPLES, 2);
+    MY_ASSERT(NULL != p_jb);
+    MY_ASSERT(0 == jitter_buffer_get_available(p_jb));
+    jitter_buffer_destroy(p_jb);
+}
+
+static void test_jitter_buffer_reorder(void)
+{
+    int16_t in[PACKET_SAMPLES];
+    int16_t out[PACKET_SAMPLES];
+    struct jitter_buffer * p_jb = jitter_buffer_create(4, PACKET_SAMPLES, 3);
+    MY_ASSERT(NULL != p_jb);
+    /* Packets 10, 12, 11 arrive in that order, but have to be played as 10, 11, 12. */
+    fill(in, PACKET_SAMPLES, 10);
+    MY_ASSERT(jitter_buffer_put(p_jb, 10, in, PACKET_SAMPLES));
+    fill(in, PACKET_SAMPLES, 12);
+    MY_ASSERT(jitter_buffer_put(p_jb, 12, in, PACKET_SAMPLES));
+    MY_ASSERT(0 == jitter_buffer_get_available(p_jb));
+    fill(in, PACKET_SAMPLES, 11);
+    MY_ASSERT(jitter_buffer_put(p_jb, 11, in, PACKET_SAMPLES));
+    MY_ASSERT(3*PACKET_SAMPLES == jitter_buffer_get_available(p_jb));
+    MY_ASSERT(PACKET_SAMPLES == jitter_buffer_read(p_jb, out, PACKET_SAMPLES));
+    MY_ASSERT(all_equal(out, PACKET_SAMPLES, 10));
+    MY_ASSERT(PACKET_SAMPLES == jitter_buffer_read(p_jb, out, PACKET_SAMPLES));
+    MY_ASSERT(all_equal(out, PACKET_SAMPLES, 11));
+    MY_ASSERT(PACKET_SAMPLES == jitter_buffer_read(p_jb, out, PACKET_SAMPLES));
+    MY_ASSERT(all_equal(out, PACKET_SAMPLES, 12));
+    MY_ASSERT(0 == jitter_buffer_get_lost(p_jb));
+    /* Packet 11 arriving again is late now. */
+    MY_ASSERT(!jitter_buffer_put(p_jb, 11, in, PACKET_SAMPLES));
+    MY_ASSERT(1 == jitter_buffer_get_dropped(p_jb));
+    jitter_buffer_destroy(p_jb);
+}
+
+static void test_jitter_buffer_loss(void)
+{
+    int16_t in[PACKET_SAMPLES];
+    int16_t out[2*PACKET_SAMPLES];
+    struct jitter_buffer * p_jb = jitter_buffer_create(4, PACKET_SAMPLES, 2);
+    MY_ASSERT(NULL != p_jb);
+    fill(in, PACKET_SAMPLES, 1);
+    MY_ASSERT(jitter_buffer_put(p_jb, 0xfffe, in, PACKET_SAMPLES));
+    /* 0xffff is lost, the sequence number wraps around. */
+    fill(in, PACKET_SAMPLES, 3);
+    MY_ASSERT(jitter_buffer_put(p_jb, 0x0000, in, PACKET_SAMPLES));
+    MY_ASSERT(2*PACKET_SAMPLES == jitter_buffer_read(p_jb, out, 2*PACKET_SAMPLES));
+    MY_ASSERT(all_equal(out, PACKET_SAMPLES, 1));
+    MY_ASSERT(all_equal(&out[PACKET_SAMPLES], PACKET_SAMPLES, 3));
+    MY_ASSERT(1 == jitter_buffer_get_lost(p_jb));
+    /* Nothing left - silence and an underrun. */
+    MY_ASSERT(0 == jitter_buffer_read(p_jb, out, PACKET_SAMPLES));
+    MY_ASSERT(all_equal(out, PACKET_SAMPLES, 0));
+    MY_ASSERT(1 == jitter_buffer_get_underruns(p_jb));
+    jitter_buffer_destroy(p_jb);
+}
+
+static void test_mixer_two_sources(void)
+{
+    int16_t in[PACKET_SAMPLES];
+    int16_t out[PACKET_SAMPLES];
+    struct audio_mixer * p_mixer = audio_mixer_create(4, 3, PACKET_SAMPLES, 1);
+    MY_ASSERT(NULL != p_mixer);
+    fill(in, PACKET_SAMPLES, 1000);
+    MY_ASSERT(audio_mixer_push(p_mixer, 0x1111, 0, in, PACKET_SAMPLES));
+    fill(in, PACKET_SAMPLES, -300);
+    MY_ASSERT(audio_mixer_push(p_mixer, 0x2222, 7, in, PACKET_SAMPLES));
+    MY_ASSERT(2 == audio_mixer_get_sources_count(p_mixer));
+    MY_ASSERT(PACKET_SAMPLES == audio_mixer_get_available(p_mixer));
+    MY_ASSERT(2 == audio_mixer_mix(p_mixer, out, PACKET_SAMPLES));
+    MY_ASSERT(all_equal(out, PACKET_SAMPLES, 700));
+    audio_mixer_destroy(p_mixer);
+}
+
+static void test_mixer_saturation(void)
+{
+    int16_t in[PACKET_SAMPLES];
+    int16_t out[PACKET_SAMPLES];
+    struct audio_mixer * p_mixer = audio_mixer_create(4, 3, PACKET_SAMPLES, 1);
+    MY_ASSERT(NULL != p_mixer);
+    fill(in, PACKET_SAMPLES, 30000);
+    MY_ASSERT(audio_mixer_push(p_mixer, 1, 0, in, PACKET_SAMPLES));
+    MY_ASSERT(audio_mixer_push(p_mixer, 2, 0, in, PACKET_SAMPLES));
+    audio_mixer_mix(p_mixer, out, PACKET_SAMPLES);
+    MY_ASSERT(all_equal(out, PACKET_SAMPLES, INT16_MAX));
+    fill(in, PACKET_SAMPLES, -30000);
+    MY_ASSERT(audio_mixer_push(p_mixer, 1, 1, in, PACKET_SAMPLES));
+    MY_ASSERT(audio_mixer_push(p_mixer, 2, 1, in, PACKET_SAMPLES));
+    audio_mixer_mix(p_mixer, out, PACKET_SAMPLES);
+    MY_ASSERT(all_equal(out, PACKET_SAMPLES, INT16_MIN));
+    audio_mixer_destroy(p_mixer);
+}
+
+static void test_mixer_gain(void)
+{
+    int16_t in[PACKET_SAMPLES];
+    int16_t out[PACKET_SAMPLES];
+    struct audio_mixer * p_mixer = audio_mixer_create(2, 3, PACKET_SAMPLES, 1);
+    MY_ASSERT(NULL != p_mixer);
+    MY_ASSERT(!audio_mixer_set_gain(p_mixer, 5, 0.5f));
+    fill(in, PACKET_SAMPLES, -4000);
+    MY_ASSERT(audio_mixer_push(p_mixer, 5, 0, in, PACKET_SAMPLES));
+    MY_ASSERT(audio_mixer_set_gain(p_mixer, 5, 0.5f));
+    audio_mixer_mix(p_mixer, out, PACKET_SAMPLES);
+    MY_ASSERT(all_equal(out, PACKET_SAMPLES, -2000));
+    MY_ASSERT(audio_mixer_push(p_mixer, 5, 1, in, PACKET_SAMPLES));
+    MY_ASSERT(audio_mixer_set_gain(p_mixer, 5, 0.0f));
+    audio_mixer_mix(p_mixer, out, PACKET_SAMPLES);
+    MY_ASSERT(all_equal(out, PACKET_SAMPLES, 0));
+    audio_mixer_destroy(p_mixer);
+}
+
+static void test_mixer_sources_limit(void)
+{
+    int16_t in[PACKET_SAMPLES];
+    int16_t out[PACKET_SAMPLES];
+    unsigned int idx;
+    struct audio_mixer * p_mixer = audio_mixer_create(2, 3, PACKET_SAMPLES, 1);
+    MY_ASSERT(NULL != p_mixer);
+    fill(in, PACKET_SAMPLES, 1);
+    MY_ASSERT(audio_mixer_push_unsequenced(p_mixer, 1, in, PACKET_SAMPLES));
+    MY_ASSERT(audio_mixer_push_unsequenced(p_mixer, 2, in, PACKET_SAMPLES));
+    MY_ASSERT(!audio_mixer_push_unsequenced(p_mixer, 3, in, PACKET_SAMPLES));
+    /* Once the sources go silent for long enough, their slots become free. */
+    for (idx = 0; idx <= AUDIO_MIXER_IDLE_ROUNDS + 1; ++idx)
+        audio_mixer_mix(p_mixer, out, PACKET_SAMPLES);
+    MY_ASSERT(0 == audio_mixer_get_sources_count(p_mixer));
+    MY_ASSERT(audio_mixer_push_unsequenced(p_mixer, 3, in, PACKET_SAMPLES));
+    audio_mixer_destroy(p_mixer);
+}
+
+static void test_packet_header(void)
+{
+    uint8_t buffer[MCAST_PACKET_HEADER_SIZE + 4];
+    struct mcast_packet_header in, out;
+    memset(&in, 0, sizeof(in));
+    in.version_ = MCAST_PACKET_VERSION;
+    in.seq_ = 0xbeef;
+    in.timestamp_ = 0x01020304;
+    in.ssrc_ = 0xcafebabe;
+    MY_ASSERT(0 == mcast_packet_header_encode(&in, buffer, MCAST_PACKET_HEADER_SIZE - 1));
+    MY_ASSERT(MCAST_PACKET_HEADER_SIZE == mcast_packet_header_encode(&in, buffer, sizeof(buffer)));
+    MY_ASSERT(MCAST_PACKET_HEADER_SIZE == mcast_packet_header_decode(&out, buffer, sizeof(buffer)));
+    MY_ASSERT(in.seq_ == out.seq_ && in.timestamp_ == out.timestamp_ && in.ssrc_ == out.ssrc_);
+    /* A raw PCM datagram is not mistaken for one with the header. */
+    memset(buffer, 0, sizeof(buffer));
+    MY_ASSERT(0 == mcast_packet_header_decode(&out, buffer, sizeof(buffer)));
+}
+
+static void test_jitter_buffer_residency(void)
+{
+    int16_t in[PACKET_SAMPLES];
+    int16_t out[PACKET_SAMPLES];
+    static struct latency_histogram residency;
+    struct jitter_buffer * p_jb = jitter_buffer_create(3, PACKET_SAMPLES, 2);
+    MY_ASSERT(NULL != p_jb);
+    latency_histogram_reset(&residency);
+    jitter_buffer_set_residency_histogram(p_jb, &residency);
+    fill(in, PACKET_SAMPLES, 1);
+    MY_ASSERT(jitter_buffer_put_at(p_jb, 0, in, PACKET_SAMPLES, 1000));
+    MY_ASSERT(jitter_buffer_put_at(p_jb, 1, in, PACKET_SAMPLES, 3000));
+    /* A packet is accounted once, when its playout starts. */
+    MY_ASSERT(PACKET_SAMPLES/2 == jitter_buffer_read_at(p_jb, out, PACKET_SAMPLES/2, 5000));
+    MY_ASSERT(PACKET_SAMPLES == jitter_buffer_read_at(p_jb, out, PACKET_SAMPLES, 6000));
+    MY_ASSERT(2 == residency.count_);
+    MY_ASSERT(3000 == residency.min_ && 4000 == residency.max_);
+    /* Packets with unknown arrival time are not accounted. */
+    MY_ASSERT(jitter_buffer_put(p_jb, 2, in, PACKET_SAMPLES));
+    MY_ASSERT(jitter_buffer_put(p_jb, 3, in, PACKET_SAMPLES));
+    jitter_buffer_read_at(p_jb, out, PACKET_SAMPLES, 7000);
+    MY_ASSERT(2 == residency.count_);
+    jitter_buffer_destroy(p_jb);
+}
+
+static void test_packet_send_time(void)
+{
+    uint8_t buffer[MCAST_PACKET_HEADER_SIZE + 4*(MCAST_PACKET_SEND_TIME_WORDS + MCAST_PACKET_FORMAT_WORDS)];
+    struct mcast_packet_header in, out;
+    uint64_t send_time = 0;
+    uint32_t sample_rate = 0;
+    unsigned int channels = 0;
+    memset(&in, 0, sizeof(in));
+    in.version_ = MCAST_PACKET_VERSION;
+    in.flags_ = 2;
+    in.seq_ = 7;
+    MY_ASSERT(0 == mcast_packet_header_encode_timed(&in, 0x0123456789abcdefULL, buffer, MCAST_PACKET_HEADER_SIZE + 4));
+    MY_ASSERT(MCAST_PACKET_HEADER_SIZE + 8 == mcast_packet_header_encode_timed(&in, 0x0123456789abcdefULL, buffer, sizeof(buffer)));
+    MY_ASSERT(MCAST_PACKET_HEADER_SIZE + 8 == mcast_packet_header_decode(&out, buffer, sizeof(buffer)));
+    MY_ASSERT(2 == (out.flags_ & MCAST_PACKET_FLAGS_CODEC_MASK) && 7 == out.seq_);
+    MY_ASSERT(mcast_packet_header_get_send_time(&out, buffer, &send_time));
+    MY_ASSERT(0x0123456789abcdefULL == send_time);
+    /* Plain headers carry no send time. */
+    MY_ASSERT(MCAST_PACKET_HEADER_SIZE == mcast_packet_header_encode(&in, buffer, sizeof(buffer)));
+    MY_ASSERT(MCAST_PACKET_HEADER_SIZE == mcast_packet_header_decode(&out, buffer, sizeof(buffer)));
+    MY_ASSERT(!mcast_packet_header_get_send_time(&out, buffer, &send_time));
+    MY_ASSERT(!mcast_packet_header_get_format(&out, buffer, &sample_rate, &channels));
+    /* The format follows the send time. */
+    MY_ASSERT(0 == mcast_packet_header_encode_stream(&in, 1, 48000, 2, buffer, MCAST_PACKET_HEADER_SIZE + 8));
+    MY_ASSERT(MCAST_PACKET_HEADER_SIZE + 12 == mcast_packet_header_encode_stream(&in, 0x0123456789abcdefULL, 48000, 2, buffer, sizeof(buffer)));
+    MY_ASSERT(MCAST_PACKET_HEADER_SIZE + 12 == mcast_packet_header_decode(&out, buffer, sizeof(buffer)));
+    MY_ASSERT(2 == (out.flags_ & MCAST_PACKET_FLAGS_CODEC_MASK));
+    MY_ASSERT(mcast_packet_header_get_send_time(&out, buffer, &send_time));
+    MY_ASSERT(0x0123456789abcdefULL == send_time);
+    MY_ASSERT(mcast_packet_header_get_format(&out, buffer, &sample_rate, &channels));
+    MY_ASSERT(48000 == sample_rate && 2 == channels);
+}
+
+/*!
+ * @brief The datagrams without the packet header are told apart by the address and the port of the sender.
+ */
+static void test_packet_source_key(void)
+{
+    struct sockaddr_storage a, b;
+    ZeroMemory(&a, sizeof(a));
+    ((struct sockaddr_in *)&a)->sin_family = AF_INET;
+    ((struct sockaddr_in *)&a)->sin_port = 4000;
+    ((struct sockaddr_in *)&a)->sin_addr.s_addr = 0x0302010a;
+    b = a;
+    MY_ASSERT(mcast_packet_source_key(&a) == mcast_packet_source_key(&b));
+    /* Two senders on the same host are two sources. */
+    ((struct sockaddr_in *)&b)->sin_port = 4001;
+    MY_ASSERT(mcast_packet_source_key(&a) != mcast_packet_source_key(&b));
+    ZeroMemory(&b, sizeof(b));
+    ((struct sockaddr_in6 *)&b)->sin6_family = AF_INET6;
+    ((struct sockaddr_in6 *)&b)->sin6_port = 4000;
+    ((struct sockaddr_in6 *)&b)->sin6_addr.s6_addr[0] = 0xfe;
+    ((struct sockaddr_in6 *)&b)->sin6_addr.s6_addr[1] = 0x80;
+    ((struct sockaddr_in6 *)&b)->sin6_addr.s6_addr[15] = 1;
+    MY_ASSERT(mcast_packet_source_key(&a) != mcast_packet_source_key(&b));
+}
+
+int main(int argc, char ** argv)
+{
+    test_jitter_buffer_create();
+    test_jitter_buffer_reorder();
+    test_jitter_buffer_loss();
+    test_mixer_two_sources();
+    test_mixer_saturation();
+    test_mixer_gain();
+    test_mixer_sources_limit();
+    test_packet_header();
+    test_jitter_buffer_residency();
+    test_packet_send_time();
+    test_packet_source_key();
+    return 0;
+}
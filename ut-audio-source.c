@@ -0,0 +1,155 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file ut-audio-source.c
+ * @brief Unit tests of the audio sources.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include "audio-source.h"
+#include "tone-generator.h"
+#include "wave-reader.h"
+#include "file-source.h"
+
+#define MY_ASSERT(cond) do { if(!(cond)) fprintf(stderr, "%s %u\n", __FILE__, __LINE__), abort(); } while(0)
+
+#define BLOCK_FRAMES (256)
+
+/*!
+ * @brief What the routine has been given.
+ */
+struct capture {
+    uint64_t blocks_; /*!< Number of blocks. */
+    uint64_t bytes_; /*!< Number of bytes of all the blocks. */
+    size_t last_size_; /*!< Size of the last block. */
+    int16_t first_sample_; /*!< First sample of the first block. */
+    struct tone_generator_config const * p_sequence_; /*!< If set, the slot of each block of the sequence tone is checked. */
+    unsigned int bad_slots_; /*!< Number of blocks of the sequence tone that carried a wrong slot. */
+};
+
+static void capture_block(void * p_context, void * data, size_t data_size)
+{
+    struct capture * p_capture = (struct capture *)p_context;
+    if (0 == p_capture->blocks_)
+        p_capture->first_sample_ = *(int16_t const *)data;
+    if (NULL != p_capture->p_sequence_ &&
+            p_capture->blocks_ % TONE_GENERATOR_SEQUENCE_SLOTS != tone_generator_decode_sequence(p_capture->p_sequence_, (int16_t const *)data, BLOCK_FRAMES))
+        ++p_capture->bad_slots_;
+    ++p_capture->blocks_;
+    p_capture->bytes_ += data_size;
+    p_capture->last_size_ = data_size;
+}
+
+static void test_generator(void)
+{
+    struct audio_source_config config = { BLOCK_FRAMES, AUDIO_SOURCE_AS_FAST_AS_POSSIBLE, 0 };
+    struct tone_generator_config sequence;
+    struct audio_source_stats stats;
+    struct capture capture;
+    struct audio_source * p_source;
+    memset(&capture, 0, sizeof(capture));
+    MY_ASSERT(tone_generator_parse(&sequence, "seq:1000:250"));
+    sequence.packet_frames_ = BLOCK_FRAMES;
+    capture.p_sequence_ = &sequence;
+    p_source = audio_source_create_generator("seq:1000:250", &config, &capture, &capture_block);
+    MY_ASSERT(NULL != p_source && 44100 == audio_source_get_sample_rate(p_source) && 2 == audio_source_get_channels(p_source));
+    /* The generated signals never end. */
+    MY_ASSERT(40 == audio_source_run(p_source, 40));
+    MY_ASSERT(40 == capture.blocks_ && BLOCK_FRAMES * 2 * sizeof(int16_t) == capture.last_size_ && 0 == capture.bad_slots_);
+    audio_source_get_stats(p_source, &stats);
+    MY_ASSERT(40 == stats.blocks_ && 40 * BLOCK_FRAMES == stats.frames_ && 0 == stats.late_);
+    audio_source_destroy(p_source);
+    MY_ASSERT(NULL == audio_source_create_generator("sine", &config, &capture, &capture_block));
+    config.block_frames_ = 0;
+    MY_ASSERT(NULL == audio_source_create_generator("sine:440", &config, &capture, &capture_block));
+}
+
+static void test_tone(void)
+{
+    struct audio_source_config config = { BLOCK_FRAMES, AUDIO_SOURCE_AS_FAST_AS_POSSIBLE, 0 };
+    struct wave_reader * p_reader = wave_reader_open("sin250Hz.wav", FILE_SOURCE_PREAD);
+    struct capture capture;
+    struct audio_source * p_source;
+    uint64_t frames, blocks;
+    int16_t first_sample;
+    MY_ASSERT(NULL != p_reader && 1 == wave_reader_read_frames(p_reader, &first_sample, 1));
+    frames = wave_reader_get_frames_count(p_reader);
+    blocks = (frames + BLOCK_FRAMES - 1) / BLOCK_FRAMES;
+    wave_reader_close(p_reader);
+    memset(&capture, 0, sizeof(capture));
+    p_source = audio_source_create_tone(EXTERNAL_WAV_TONE, "sin250Hz.wav", &config, &capture, &capture_block);
+    MY_ASSERT(NULL != p_source && 8000 == audio_source_get_sample_rate(p_source) && 1 == audio_source_get_channels(p_source));
+    /* The whole file, the last block is shorter. */
+    MY_ASSERT(blocks == audio_source_run(p_source, UINT64_MAX));
+    MY_ASSERT(blocks == capture.blocks_ && frames * sizeof(int16_t) == capture.bytes_ && first_sample == capture.first_sample_);
+    MY_ASSERT(0 == audio_source_run(p_source, 1));
+    audio_source_destroy(p_source);
+    /* Started over at the end. */
+    memset(&capture, 0, sizeof(capture));
+    config.loop_ = 1;
+    p_source = audio_source_create_tone(EXTERNAL_WAV_TONE, "sin250Hz.wav", &config, &capture, &capture_block);
+    MY_ASSERT(NULL != p_source && 3 * blocks == audio_source_run(p_source, 3 * blocks));
+    MY_ASSERT(3 * frames * sizeof(int16_t) == capture.bytes_);
+    audio_source_destroy(p_source);
+    MY_ASSERT(NULL == audio_source_create_tone(EXTERNAL_WAV_TONE, "no-such-file.wav", &config, &capture, &capture_block));
+}
+
+static void test_realtime(void)
+{
+    /* 10 ms blocks at 44.1 kHz. */
+    struct audio_source_config config = { 441, AUDIO_SOURCE_REALTIME, 0 };
+    struct audio_source_stats stats;
+    struct capture capture;
+    struct audio_source * p_source;
+    memset(&capture, 0, sizeof(capture));
+    p_source = audio_source_create_generator("pink", &config, &capture, &capture_block);
+    MY_ASSERT(NULL != p_source && 0 == audio_source_stop(p_source));
+    /* 20 blocks take 200 ms of the emulated capture. */
+    MY_ASSERT(audio_source_start(p_source) && 0 == audio_source_start(p_source));
+    usleep(200000);
+    MY_ASSERT(audio_source_stop(p_source));
+    audio_source_get_stats(p_source, &stats);
+    MY_ASSERT(stats.blocks_ >= 15 && stats.blocks_ <= 21 && capture.blocks_ == stats.blocks_);
+    /* The thread can be started again, and is stopped by destroy. */
+    MY_ASSERT(audio_source_start(p_source));
+    audio_source_destroy(p_source);
+    /* Running from the calling thread is paced too. */
+    memset(&capture, 0, sizeof(capture));
+    p_source = audio_source_create_generator("pink", &config, &capture, &capture_block);
+    {
+        struct timespec start, stop;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        MY_ASSERT(10 == audio_source_run(p_source, 10));
+        clock_gettime(CLOCK_MONOTONIC, &stop);
+        MY_ASSERT((stop.tv_sec - start.tv_sec) * 1000 + (stop.tv_nsec - start.tv_nsec) / 1000000 >= 99);
+    }
+    audio_source_destroy(p_source);
+}
+
+int main(int argc, char ** argv)
+{
+    test_generator();
+    test_tone();
+    test_realtime();
+    return 0;
+}
@@ -28,13 +28,126 @@
  */
 #include "pcc.h"
 #include "debug_helpers.h"
+#include "trace-recorder.h"
+
+/*!
+ * @brief An assert macro that works with RELEASE builds.
+ */
+#define MY_ASSERT(cond) do { if(!(cond)) fprintf(stderr, "%s %u\n", __FILE__, __LINE__), abort(); } while(0)
 
 void test_00(void)
 {
+#if defined WIN32
    OutputDebugString( __FILE__); 
+#endif
     debug_outputlnA(__FILE__);
 }
 
+#if !defined WIN32
+
+/*!
+ * @brief Number of records logged by the drop test.
+ */
+#define FLOOD_RECORDS (10000)
+
+/*!
+ * @brief Redirects stderr to a temporary file.
+ * @return returns the descriptor of the original stderr.
+ */
+static int capture_stderr(FILE * fp_capture)
+{
+    int saved;
+    fflush(stderr);
+    saved = dup(STDERR_FILENO);
+    dup2(fileno(fp_capture), STDERR_FILENO);
+    return saved;
+}
+
+static void restore_stderr(int saved)
+{
+    fflush(stderr);
+    dup2(saved, STDERR_FILENO);
+    close(saved);
+}
+
+void test_01(void)
+{
+    char expected[256];
+    char line[256];
+    char const * psz_name = "abc";
+    FILE * fp_capture = tmpfile();
+    int saved;
+    MY_ASSERT(NULL != fp_capture);
+    snprintf(expected, sizeof(expected), "%s %4.4u : %d %lu %zu %llx %5.2f %c %% [%-6s] %.*s\n",
+            "file.c", 42u, -7, 123456789ul, (size_t)99, 0xdeadbeefcafeull, 3.14159, 'x', psz_name, 2, "xyz");
+    saved = capture_stderr(fp_capture);
+    MY_ASSERT(debug_output_async_start());
+    debug_outputlnA("%s %4.4u : %d %lu %zu %llx %5.2f %c %% [%-6s] %.*s",
+            "file.c", 42u, -7, 123456789ul, (size_t)99, 0xdeadbeefcafeull, 3.14159, 'x', psz_name, 2, "xyz");
+    /* A conversion that cannot be captured is formatted right away. */
+    debug_outputlnA("%Lf", (long double)1.5);
+    debug_output_async_stop();
+    restore_stderr(saved);
+    rewind(fp_capture);
+    MY_ASSERT(NULL != fgets(line, sizeof(line), fp_capture));
+    MY_ASSERT(0 == strcmp(line, expected));
+    MY_ASSERT(NULL != fgets(line, sizeof(line), fp_capture));
+    MY_ASSERT(0 == strcmp(line, "1.500000\n"));
+    fclose(fp_capture);
+}
+
+void test_02(void)
+{
+    char line[256];
+    unsigned int idx;
+    unsigned int written = 0;
+    FILE * fp_capture = tmpfile();
+    int saved;
+    MY_ASSERT(NULL != fp_capture);
+    saved = capture_stderr(fp_capture);
+    MY_ASSERT(debug_output_async_start());
+    for (idx = 0; idx < FLOOD_RECORDS; ++idx)
+        debug_outputlnA("record %u", idx);
+    debug_output_async_stop();
+    restore_stderr(saved);
+    /* A full ring drops the records, but every single one is either written or counted. */
+    rewind(fp_capture);
+    while (NULL != fgets(line, sizeof(line), fp_capture))
+        written += (0 == strncmp(line, "record ", 7));
+    MY_ASSERT(FLOOD_RECORDS == written + debug_output_async_get_dropped());
+    fclose(fp_capture);
+}
+
+/*!
+ * @brief Checks the synchronous mode: every line ends with a new line, long ones are cut short.
+ */
+void test_05(void)
+{
+    char long_argument[1024];
+    char line[2048];
+    FILE * fp_capture = tmpfile();
+    int saved;
+    MY_ASSERT(NULL != fp_capture);
+    memset(long_argument, 'a', sizeof(long_argument) - 1);
+    long_argument[sizeof(long_argument) - 1] = '\0';
+    saved = capture_stderr(fp_capture);
+    MY_ASSERT(debug_outputlnA("%s %4.4u : %d", "file.c", 42u, -7));
+    MY_ASSERT(debug_outputlnA("%s", long_argument));
+    MY_ASSERT(debug_outputlnA("last"));
+    restore_stderr(saved);
+    rewind(fp_capture);
+    MY_ASSERT(NULL != fgets(line, sizeof(line), fp_capture));
+    MY_ASSERT(0 == strcmp(line, "file.c 0042 : -7\n"));
+    MY_ASSERT(NULL != fgets(line, sizeof(line), fp_capture));
+    MY_ASSERT(strlen(line) > 1 && strlen(line) < sizeof(long_argument) && '\n' == line[strlen(line) - 1]);
+    MY_ASSERT(NULL != fgets(line, sizeof(line), fp_capture));
+    MY_ASSERT(0 == strcmp(line, "last\n"));
+    MY_ASSERT(NULL == fgets(line, sizeof(line), fp_capture));
+    fclose(fp_capture);
+}
+
+#else
+
 void test_01(void)
 {
 }
@@ -43,11 +156,92 @@ void test_02(void)
 {
 }
 
+void test_05(void)
+{
+}
+
+#endif
+
+/*!
+ * @brief Counts the calls, so that the test can tell whether a logging macro evaluated its arguments.
+ */
+static int count_call(int * p_calls)
+{
+    return ++*p_calls;
+}
+
+void test_03(void)
+{
+    int calls = 0;
+    /* Below the compile time threshold, the arguments are not even evaluated. */
+    debug_log_trace(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %d", __FILE__, __LINE__, count_call(&calls));
+    MY_ASSERT((DEBUG_LEVEL_THRESHOLD <= DEBUG_LEVEL_TRACE) == (1 == calls));
+    calls = 0;
+    /* A category disabled at run time costs the check only. */
+    MY_ASSERT(DEBUG_CATEGORY_ALL == debug_get_categories());
+    debug_set_categories(DEBUG_CATEGORY_ALL & ~DEBUG_CATEGORY_NETWORK);
+    MY_ASSERT(!DEBUG_CATEGORY_ENABLED(DEBUG_CATEGORY_NETWORK) && DEBUG_CATEGORY_ENABLED(DEBUG_CATEGORY_AUDIO));
+    debug_log_error(DEBUG_CATEGORY_NETWORK, "%s %4.4u : %d", __FILE__, __LINE__, count_call(&calls));
+    MY_ASSERT(0 == calls);
+    debug_log_error(DEBUG_CATEGORY_AUDIO, "%s %4.4u : %d", __FILE__, __LINE__, count_call(&calls));
+    MY_ASSERT(1 == calls);
+    debug_set_categories(DEBUG_CATEGORY_ALL);
+}
+
+/*!
+ * @brief Name of the file the trace test dumps to.
+ */
+#define TRACE_FILE_NAME "ut-debug-helpers-trace.json"
+
+/*!
+ * @brief Dumps the trace and counts the events with the given name.
+ */
+static unsigned int count_trace_events(char const * psz_name)
+{
+    char pattern[64];
+    char line[256];
+    unsigned int count = 0;
+    FILE * fp;
+    MY_ASSERT(trace_recorder_dump(TRACE_FILE_NAME));
+    fp = fopen(TRACE_FILE_NAME, "r");
+    MY_ASSERT(NULL != fp);
+    snprintf(pattern, sizeof(pattern), "{\"name\":\"%s\",", psz_name);
+    MY_ASSERT(NULL != fgets(line, sizeof(line), fp));
+    MY_ASSERT(0 == strcmp(line, "{\"traceEvents\":[\n"));
+    while (NULL != fgets(line, sizeof(line), fp))
+        count += (NULL != strstr(line, pattern));
+    fclose(fp);
+    remove(TRACE_FILE_NAME);
+    return count;
+}
+
+void test_04(void)
+{
+    unsigned int idx;
+    /* Nothing is recorded until the recording is enabled. */
+    MY_ASSERT(!trace_recorder_is_enabled());
+    TRACE_BEGIN("off");
+    TRACE_END("off");
+    MY_ASSERT(0 == count_trace_events("off"));
+    trace_recorder_enable(1);
+    TRACE_BEGIN("span");
+    TRACE_END("span");
+    MY_ASSERT(2 == count_trace_events("span"));
+    /* The ring keeps the most recent events only. */
+    for (idx = 0; idx < TRACE_RECORDER_RING_EVENTS; ++idx)
+        TRACE_BEGIN("wrap");
+    MY_ASSERT(0 == count_trace_events("span"));
+    MY_ASSERT(TRACE_RECORDER_RING_EVENTS == count_trace_events("wrap"));
+    trace_recorder_enable(0);
+}
+
 int main(int argc, char ** argv)
 {
 	test_00();
 	test_01();
 	test_02();
+	test_03();
+	test_04();
+	test_05();
 	return 0;
 }
-
@@ -0,0 +1,154 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file ut-file-source.c
+ * @brief Unit test for the file source.
+ * @details Reads the same file with each of the strategies, and checks the buffer pool, the copying reads and the memory sources.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include "file-source.h"
+
+#define MY_ASSERT(cond) do { if(!(cond)) fprintf(stderr, "%s %u\n", __FILE__, __LINE__), abort(); } while(0)
+
+#define SOURCE_PATH "ut-file-source.dat"
+
+/*!
+ * @brief Size of the test file: several windows, and not a multiple of the page nor of a buffer.
+ */
+#define SOURCE_SIZE (5 * FILE_SOURCE_WINDOW + 12345)
+
+/*!
+ * @brief Value of the byte at the given offset of the test file.
+ */
+static uint8_t byte_at(uint64_t offset)
+{
+    return (uint8_t)(offset * 7 + (offset >> 12));
+}
+
+static int check_bytes(uint8_t const * p_bytes, uint64_t offset, size_t size)
+{
+    size_t idx;
+    for (idx = 0; idx < size; ++idx)
+    {
+        if (p_bytes[idx] != byte_at(offset + idx))
+            return 0;
+    }
+    return 1;
+}
+
+static void write_source(void)
+{
+    static uint8_t bytes[SOURCE_SIZE];
+    size_t idx;
+    FILE * fp = fopen(SOURCE_PATH, "wb");
+    MY_ASSERT(NULL != fp);
+    for (idx = 0; idx < SOURCE_SIZE; ++idx)
+        bytes[idx] = byte_at(idx);
+    MY_ASSERT(1 == fwrite(bytes, sizeof(bytes), 1, fp));
+    fclose(fp);
+}
+
+static void test_sequential(int strategy)
+{
+    struct file_source * p_source = file_source_open(SOURCE_PATH, strategy);
+    uint8_t const * p_bytes;
+    uint64_t offset = 0;
+    size_t size;
+    MY_ASSERT(NULL != p_source && strategy == file_source_get_strategy(p_source) && SOURCE_SIZE == file_source_get_size(p_source));
+    MY_ASSERT((FILE_SOURCE_MMAP == strategy) == (NULL != file_source_get_mapping(p_source)));
+    /* Odd sized steps, so that the requests straddle the buffers. */
+    while (NULL != (p_bytes = (uint8_t const *)file_source_get(p_source, offset, 10007, &size)))
+    {
+        MY_ASSERT(size > 0 && size <= 10007 && check_bytes(p_bytes, offset, size));
+        offset += size;
+    }
+    MY_ASSERT(SOURCE_SIZE == offset && 0 == size);
+    /* Back to the start, as when the file is looped. */
+    p_bytes = (uint8_t const *)file_source_get(p_source, 0, 100, &size);
+    MY_ASSERT(NULL != p_bytes && 100 == size && check_bytes(p_bytes, 0, size));
+    /* Asking for more than a buffer holds. */
+    p_bytes = (uint8_t const *)file_source_get(p_source, 1, SOURCE_SIZE, &size);
+    MY_ASSERT(NULL != p_bytes && size > 0 && check_bytes(p_bytes, 1, size));
+    MY_ASSERT(FILE_SOURCE_MMAP == strategy ? SOURCE_SIZE - 1 == size : size <= FILE_SOURCE_WINDOW);
+    file_source_close(p_source);
+}
+
+static void test_pool(void)
+{
+    struct file_source * p_source = file_source_open(SOURCE_PATH, FILE_SOURCE_PREAD);
+    uint8_t const * p_first;
+    uint8_t const * p_bytes;
+    unsigned int idx;
+    size_t size;
+    MY_ASSERT(NULL != p_source);
+    p_first = (uint8_t const *)file_source_get(p_source, 0, 1000, &size);
+    MY_ASSERT(NULL != p_first && 1000 == size);
+    /* The first bytes stay valid while the other buffers of the pool are filled. */
+    for (idx = 1; idx < FILE_SOURCE_BUFFERS_COUNT; ++idx)
+    {
+        p_bytes = (uint8_t const *)file_source_get(p_source, (uint64_t)idx * FILE_SOURCE_BUFFER_SIZE, 1000, &size);
+        MY_ASSERT(NULL != p_bytes && 1000 == size && check_bytes(p_bytes, (uint64_t)idx * FILE_SOURCE_BUFFER_SIZE, size));
+    }
+    MY_ASSERT(check_bytes(p_first, 0, 1000));
+    /* And are handed out again without reading. */
+    MY_ASSERT(p_first + 10 == file_source_get(p_source, 10, 100, &size) && 100 == size);
+    file_source_close(p_source);
+}
+
+static void test_read(void)
+{
+    static uint8_t const memory[] = { 1, 2, 3, 4, 5 };
+    struct file_source * p_source = file_source_open(SOURCE_PATH, FILE_SOURCE_READAHEAD);
+    uint8_t bytes[64];
+    size_t size;
+    MY_ASSERT(NULL != p_source);
+    MY_ASSERT(sizeof(bytes) == file_source_read(p_source, 3 * FILE_SOURCE_WINDOW - 5, bytes, sizeof(bytes)));
+    MY_ASSERT(check_bytes(bytes, 3 * FILE_SOURCE_WINDOW - 5, sizeof(bytes)));
+    MY_ASSERT(10 == file_source_read(p_source, SOURCE_SIZE - 10, bytes, sizeof(bytes)));
+    MY_ASSERT(0 == file_source_read(p_source, SOURCE_SIZE, bytes, sizeof(bytes)));
+    MY_ASSERT(NULL == file_source_get(p_source, SOURCE_SIZE, 1, &size) && 0 == size);
+    file_source_close(p_source);
+    /* Small files are mapped. */
+    p_source = file_source_open(SOURCE_PATH, FILE_SOURCE_AUTO);
+    MY_ASSERT(NULL != p_source && FILE_SOURCE_MMAP == file_source_get_strategy(p_source));
+    file_source_close(p_source);
+    MY_ASSERT(NULL == file_source_open("ut-file-source.missing", FILE_SOURCE_AUTO));
+    p_source = file_source_open_memory(memory, sizeof(memory));
+    MY_ASSERT(NULL != p_source && memory == file_source_get_mapping(p_source));
+    MY_ASSERT(memory + 3 == file_source_get(p_source, 3, 10, &size) && 2 == size);
+    file_source_close(p_source);
+    MY_ASSERT(0 == strcmp("readahead", file_source_get_strategy_name(FILE_SOURCE_READAHEAD)));
+}
+
+int main(int argc, char ** argv)
+{
+    write_source();
+    test_sequential(FILE_SOURCE_MMAP);
+    test_sequential(FILE_SOURCE_READAHEAD);
+    test_sequential(FILE_SOURCE_PREAD);
+    test_pool();
+    test_read();
+    unlink(SOURCE_PATH);
+    return 0;
+}
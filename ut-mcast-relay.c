@@ -0,0 +1,218 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file ut-mcast-relay.c
+ * @brief Unit tests for the stream table parser.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include "mcast-relay.h"
+#include "mcast_setup.h"
+#include "mcast_utils.h"
+
+/*!
+ * @brief An assert macro that works with RELEASE builds.
+ */
+#define MY_ASSERT(cond) do { if(!(cond)) fprintf(stderr, "%s %u\n", __FILE__, __LINE__), abort(); } while(0)
+
+static void test_parse_valid_table(void)
+{
+    struct mcast_relay_table table;
+    static char const text[] =
+        "# name  dir  group        port   ttl  rate\n"
+        "\n"
+        "voice   in   239.0.0.1    25000  1\n"
+        "voice   out  239.1.0.1    25000  16   256\n"
+        "  music in   239.0.0.2    25010\n"
+        "voice   out  239.192.0.1  25002  32\n"
+        "music   out  239.1.0.2    25010  8    1000";
+    MY_ASSERT(mcast_relay_table_parse(&table, text));
+    MY_ASSERT(2 == table.streams_count_);
+    MY_ASSERT(0 == strcmp("voice", table.streams_[0].name_));
+    MY_ASSERT(2 == table.streams_[0].destinations_count_);
+    MY_ASSERT(25000 == mcast_settings_get_port(&table.streams_[0].source_));
+    MY_ASSERT(16 == table.streams_[0].destinations_[0].settings_.nTTL_);
+    MY_ASSERT(32000 == table.streams_[0].destinations_[0].rate_);
+    MY_ASSERT(0 == table.streams_[0].destinations_[1].rate_);
+    MY_ASSERT(htonl(0xefc00001) == ((struct sockaddr_in const *)&table.streams_[0].destinations_[1].settings_.mcast_addr_)->sin_addr.s_addr);
+    MY_ASSERT(1 == table.streams_[1].destinations_count_);
+    MY_ASSERT(125000 == table.streams_[1].destinations_[0].rate_);
+    MY_ASSERT(!mcast_settings_is_source_specific(&table.streams_[0].source_));
+}
+
+static void test_parse_source_specific(void)
+{
+    struct mcast_relay_table table;
+    static char const text[] =
+        "voice in  10.1.2.3,232.1.1.1 25000\n"
+        "voice out 239.1.0.1          25000 16\n";
+    MY_ASSERT(mcast_relay_table_parse(&table, text));
+    MY_ASSERT(mcast_settings_is_source_specific(&table.streams_[0].source_));
+    MY_ASSERT(htonl(0x0a010203) == ((struct sockaddr_in const *)&table.streams_[0].source_.source_addr_)->sin_addr.s_addr);
+    MY_ASSERT(htonl(0xe8010101) == ((struct sockaddr_in const *)&table.streams_[0].source_.mcast_addr_)->sin_addr.s_addr);
+    /* The source must be a unicast address. */
+    MY_ASSERT(!mcast_relay_table_parse(&table, "a in 239.9.9.9,232.1.1.1 25000\na out 239.0.0.3 25000 1\n"));
+    MY_ASSERT(!mcast_relay_table_parse(&table, "a in 0.0.0.0,232.1.1.1 25000\na out 239.0.0.3 25000 1\n"));
+    MY_ASSERT(!mcast_relay_table_parse(&table, "a in 10.1.2.3,10.1.1.1 25000\na out 239.0.0.3 25000 1\n"));
+}
+
+static void test_parse_ipv6(void)
+{
+    struct mcast_relay_table table;
+    char group[MCAST_SETTINGS_ADDRESS_LENGTH];
+    static char const text[] =
+        "voice in  2001:db8::1,ff3e::8000:1 25000\n"
+        "voice out ff12::1                  25000 16\n"
+        "voice out 239.1.0.1                25002 16\n";
+    MY_ASSERT(mcast_relay_table_parse(&table, text));
+    MY_ASSERT(AF_INET6 == table.streams_[0].source_.mcast_addr_.ss_family);
+    MY_ASSERT(mcast_settings_is_source_specific(&table.streams_[0].source_));
+    MY_ASSERT(25000 == mcast_settings_get_port(&table.streams_[0].destinations_[0].settings_));
+    MY_ASSERT(mcast_settings_format_address(&table.streams_[0].destinations_[0].settings_.mcast_addr_, group, sizeof(group)));
+    MY_ASSERT(0 == strcmp("ff12::1", group));
+    MY_ASSERT(AF_INET == table.streams_[0].destinations_[1].settings_.mcast_addr_.ss_family);
+    /* Unicast group, multicast source, and a source of the other family. */
+    MY_ASSERT(!mcast_relay_table_parse(&table, "a in 2001:db8::2 25000\na out ff12::1 25000 1\n"));
+    MY_ASSERT(!mcast_relay_table_parse(&table, "a in ff12::2,ff3e::1 25000\na out ff12::1 25000 1\n"));
+    MY_ASSERT(!mcast_relay_table_parse(&table, "a in 10.1.2.3,ff3e::1 25000\na out ff12::1 25000 1\n"));
+}
+
+static void test_parse_invalid_tables(void)
+{
+    struct mcast_relay_table table;
+    /* Empty table. */
+    MY_ASSERT(!mcast_relay_table_parse(&table, "# nothing\n"));
+    /* No destination. */
+    MY_ASSERT(!mcast_relay_table_parse(&table, "a in 239.0.0.1 25000\n"));
+    /* No source. */
+    MY_ASSERT(!mcast_relay_table_parse(&table, "a out 239.0.0.1 25000 1\n"));
+    /* Two sources. */
+    MY_ASSERT(!mcast_relay_table_parse(&table, "a in 239.0.0.1 25000\na in 239.0.0.2 25000\na out 239.0.0.3 25000 1\n"));
+    /* Not a multicast group. */
+    MY_ASSERT(!mcast_relay_table_parse(&table, "a in 10.0.0.1 25000\na out 239.0.0.3 25000 1\n"));
+    /* Destination without the TTL. */
+    MY_ASSERT(!mcast_relay_table_parse(&table, "a in 239.0.0.1 25000\na out 239.0.0.3 25000\n"));
+    /* Unknown direction. */
+    MY_ASSERT(!mcast_relay_table_parse(&table, "a sideways 239.0.0.1 25000 1\n"));
+    /* A rate whose bytes per second do not fit 32 bits. */
+    MY_ASSERT(!mcast_relay_table_parse(&table, "a in 239.0.0.1 25000\na out 239.0.0.3 25000 1 40000000\n"));
+    MY_ASSERT(mcast_relay_table_parse(&table, "a in 239.0.0.1 25000\na out 239.0.0.3 25000 1 34000000\n"));
+}
+
+/*!
+ * @brief The output group uses the same port as the input group, and a receiver of this host listens on it.
+ * @details The relay must not read back what it has sent, so one datagram in gives exactly one datagram out.
+ */
+static void test_forward_once(void)
+{
+    struct mcast_relay_table table;
+    struct mcast_relay * p_relay;
+    struct mcast_settings settings;
+    struct mcast_connection injector, listener;
+    struct mcast_relay_stats stats;
+    static char const datagram[] = "one";
+    int idx;
+    MY_ASSERT(mcast_relay_table_parse(&table,
+        "voice in  239.0.0.1 25990 1\n"
+        "voice out 239.1.0.1 25990 1\n"));
+    p_relay = mcast_relay_create(&table);
+    if (NULL == p_relay)
+    {
+        fprintf(stderr, "%s %u : no multicast capable interface, skipped\n", __FILE__, __LINE__);
+        return;
+    }
+    MY_ASSERT(setup_multicast_indirect(&table.streams_[0].destinations_[0].settings_, &listener));
+    settings = table.streams_[0].source_;
+    MY_ASSERT(setup_multicast_sender(&settings, &injector));
+    /* The relay runs on this very host, so the injected datagram must be looped back. */
+    MY_ASSERT(SOCKET_ERROR != SetMulticastLoopBack(injector.socket_, AF_INET, 1));
+    if (sizeof(datagram) != mcast_sendto(&injector, datagram, sizeof(datagram)))
+    {
+        fprintf(stderr, "%s %u : cannot send to the group, skipped\n", __FILE__, __LINE__);
+    }
+    else
+    {
+        for (idx = 0; idx < 10; ++idx)
+            mcast_relay_run_once(p_relay, 20);
+        MY_ASSERT(mcast_relay_get_stats(p_relay, 0, 0, &stats));
+        MY_ASSERT(1 == stats.received_);
+        MY_ASSERT(1 == stats.sent_);
+        MY_ASSERT(0 == stats.dropped_);
+    }
+    close_multicast(&injector);
+    close_multicast(&listener);
+    mcast_relay_destroy(p_relay);
+}
+
+/*!
+ * @brief A datagram too large for the relay is dropped and counted, not forwarded cut short.
+ */
+static void test_oversized(void)
+{
+    struct mcast_relay_table table;
+    struct mcast_relay * p_relay;
+    struct mcast_settings settings;
+    struct mcast_connection injector;
+    struct mcast_relay_stats stats;
+    static uint8_t datagram[4096];
+    int idx;
+    MY_ASSERT(mcast_relay_table_parse(&table,
+        "voice in  239.0.0.1 25994 1\n"
+        "voice out 239.1.0.1 25994 1\n"));
+    p_relay = mcast_relay_create(&table);
+    if (NULL == p_relay)
+    {
+        fprintf(stderr, "%s %u : no multicast capable interface, skipped\n", __FILE__, __LINE__);
+        return;
+    }
+    settings = table.streams_[0].source_;
+    MY_ASSERT(setup_multicast_sender(&settings, &injector));
+    MY_ASSERT(SOCKET_ERROR != SetMulticastLoopBack(injector.socket_, AF_INET, 1));
+    if (sizeof(datagram) != mcast_sendto(&injector, datagram, sizeof(datagram))
+            || 16 != mcast_sendto(&injector, datagram, 16))
+    {
+        fprintf(stderr, "%s %u : cannot send to the group, skipped\n", __FILE__, __LINE__);
+    }
+    else
+    {
+        for (idx = 0; idx < 10; ++idx)
+            mcast_relay_run_once(p_relay, 20);
+        MY_ASSERT(mcast_relay_get_stats(p_relay, 0, 0, &stats));
+        MY_ASSERT(1 == stats.truncated_);
+        MY_ASSERT(1 == stats.received_);
+        MY_ASSERT(1 == stats.sent_);
+    }
+    close_multicast(&injector);
+    mcast_relay_destroy(p_relay);
+}
+
+int main(int argc, char ** argv)
+{
+    test_parse_valid_table();
+    test_parse_invalid_tables();
+    test_parse_source_specific();
+    test_parse_ipv6();
+    test_forward_once();
+    test_oversized();
+    return 0;
+}
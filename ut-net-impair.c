@@ -0,0 +1,218 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file ut-net-impair.c
+ * @brief Unit tests for the network impairment shim.
+ * @details Checks the parsing, the ordering of the released datagrams, the reproducibility and the statistics of the loss models.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include "net-impair.h"
+
+/*!
+ * @brief Number of datagrams the statistical tests submit.
+ */
+#define PACKETS (100000)
+
+#define MY_ASSERT(cond) do { if(!(cond)) fprintf(stderr, "%s %u\n", __FILE__, __LINE__), abort(); } while(0)
+
+static void test_parse(void)
+{
+    struct net_impair_config config;
+    MY_ASSERT(net_impair_parse(&config, ""));
+    MY_ASSERT(0 == config.seed_ && 0.0 == config.loss_ && 0 == config.delay_);
+    MY_ASSERT(net_impair_parse(&config, "seed=7,loss=1.5,dup=2,delay=20,jitter=5"));
+    MY_ASSERT(7 == config.seed_);
+    MY_ASSERT(fabs(config.loss_ - 0.015) < 1e-9 && fabs(config.duplicate_ - 0.02) < 1e-9);
+    MY_ASSERT(20000000 == config.delay_ && 5000000 == config.jitter_);
+    MY_ASSERT(net_impair_parse(&config, "ge=1:25"));
+    MY_ASSERT(fabs(config.ge_enter_bad_ - 0.01) < 1e-9 && fabs(config.ge_leave_bad_ - 0.25) < 1e-9);
+    MY_ASSERT(0.0 == config.ge_loss_good_ && 1.0 == config.ge_loss_bad_);
+    MY_ASSERT(net_impair_parse(&config, "ge=1:25:0.5:80,reorder=10"));
+    MY_ASSERT(fabs(config.ge_loss_good_ - 0.005) < 1e-9 && fabs(config.ge_loss_bad_ - 0.8) < 1e-9);
+    MY_ASSERT(fabs(config.reorder_ - 0.1) < 1e-9 && 10000000 == config.reorder_gap_);
+    MY_ASSERT(net_impair_parse(&config, "reorder=10:2"));
+    MY_ASSERT(2000000 == config.reorder_gap_);
+    MY_ASSERT(!net_impair_parse(&config, "loss"));
+    MY_ASSERT(!net_impair_parse(&config, "loss=1x"));
+    MY_ASSERT(!net_impair_parse(&config, "ge=1:2:3"));
+    MY_ASSERT(!net_impair_parse(&config, "delay=-1"));
+    MY_ASSERT(!net_impair_parse(&config, "bandwidth=1"));
+}
+
+/*!
+ * @brief Submits the numbered datagrams one millisecond apart, then releases them all.
+ * @return returns number of datagrams released, their numbers are written to p_order.
+ */
+static unsigned int run(struct net_impair * p_impair, uint32_t * p_order, unsigned int count)
+{
+    unsigned int released = 0;
+    uint32_t number;
+    uint64_t now = 0;
+    unsigned int idx;
+    for (idx = 0; idx < count; ++idx, now += 1000000)
+    {
+        net_impair_submit(p_impair, &idx, sizeof(idx), now);
+        while (released < 2 * count && 0 != net_impair_release(p_impair, now, &number, sizeof(number)))
+            p_order[released++] = number;
+    }
+    while (released < 2 * count && 0 != net_impair_release(p_impair, UINT64_MAX, &number, sizeof(number)))
+        p_order[released++] = number;
+    return released;
+}
+
+static void test_perfect(void)
+{
+    static uint32_t order[2 * 1000];
+    struct net_impair_config config;
+    struct net_impair * p_impair;
+    unsigned int idx;
+    ZeroMemory(&config, sizeof(config));
+    p_impair = net_impair_create(&config);
+    MY_ASSERT(NULL != p_impair);
+    MY_ASSERT(UINT64_MAX == net_impair_get_next_due(p_impair));
+    MY_ASSERT(1000 == run(p_impair, order, 1000));
+    for (idx = 0; idx < 1000; ++idx)
+        MY_ASSERT(idx == order[idx]);
+    net_impair_destroy(p_impair);
+}
+
+static void test_delay(void)
+{
+    struct net_impair_config config;
+    struct net_impair * p_impair;
+    uint8_t buffer[16];
+    ZeroMemory(&config, sizeof(config));
+    config.delay_ = 5000;
+    p_impair = net_impair_create(&config);
+    MY_ASSERT(1 == net_impair_submit(p_impair, "abc", 3, 1000));
+    MY_ASSERT(6000 == net_impair_get_next_due(p_impair));
+    MY_ASSERT(0 == net_impair_release(p_impair, 5999, buffer, sizeof(buffer)));
+    MY_ASSERT(3 == net_impair_release(p_impair, 6000, buffer, sizeof(buffer)));
+    MY_ASSERT(0 == memcmp(buffer, "abc", 3));
+    MY_ASSERT(UINT64_MAX == net_impair_get_next_due(p_impair));
+    /* Too large to be held back. */
+    MY_ASSERT(0 == net_impair_submit(p_impair, buffer, NET_IMPAIR_MAX_PACKET + 1, 0));
+    net_impair_destroy(p_impair);
+}
+
+/*!
+ * @brief The same seed impairs the same datagrams, a different seed does not.
+ */
+static void test_seed(void)
+{
+    static uint32_t first[2 * 1000];
+    static uint32_t second[2 * 1000];
+    struct net_impair_config config;
+    struct net_impair * p_impair;
+    unsigned int first_count, second_count;
+    MY_ASSERT(net_impair_parse(&config, "seed=42,loss=5,ge=2:30,dup=3,reorder=5:3,delay=10,jitter=4"));
+    p_impair = net_impair_create(&config);
+    first_count = run(p_impair, first, 1000);
+    net_impair_destroy(p_impair);
+    p_impair = net_impair_create(&config);
+    second_count = run(p_impair, second, 1000);
+    net_impair_destroy(p_impair);
+    MY_ASSERT(first_count == second_count);
+    MY_ASSERT(0 == memcmp(first, second, first_count * sizeof(first[0])));
+    config.seed_ = 43;
+    p_impair = net_impair_create(&config);
+    second_count = run(p_impair, second, 1000);
+    net_impair_destroy(p_impair);
+    MY_ASSERT(first_count != second_count || 0 != memcmp(first, second, first_count * sizeof(first[0])));
+}
+
+static void test_bernoulli(void)
+{
+    static uint32_t order[2 * PACKETS];
+    struct net_impair_config config;
+    struct net_impair_stats stats;
+    struct net_impair * p_impair;
+    unsigned int count;
+    MY_ASSERT(net_impair_parse(&config, "seed=1,loss=10,dup=5"));
+    p_impair = net_impair_create(&config);
+    count = run(p_impair, order, PACKETS);
+    net_impair_get_stats(p_impair, &stats);
+    MY_ASSERT(PACKETS == stats.submitted_);
+    MY_ASSERT(stats.lost_ > 9500 && stats.lost_ < 10500);
+    MY_ASSERT(stats.duplicated_ > 4000 && stats.duplicated_ < 5000);
+    MY_ASSERT(count == PACKETS - stats.lost_ + stats.duplicated_);
+    MY_ASSERT(count == stats.released_ && 0 == stats.overflows_);
+    net_impair_destroy(p_impair);
+}
+
+/*!
+ * @brief The losses come in bursts whose mean length is the inverse of the chance to leave the bad state.
+ */
+static void test_gilbert_elliott(void)
+{
+    static uint32_t order[2 * PACKETS];
+    struct net_impair_config config;
+    struct net_impair_stats stats;
+    struct net_impair * p_impair;
+    unsigned int count, idx, bursts = 0;
+    MY_ASSERT(net_impair_parse(&config, "seed=3,ge=1:25"));
+    p_impair = net_impair_create(&config);
+    count = run(p_impair, order, PACKETS);
+    net_impair_get_stats(p_impair, &stats);
+    for (idx = 1; idx < count; ++idx)
+        if (order[idx] != order[idx - 1] + 1)
+            ++bursts;
+    /* Stationary loss p / (p + r) = 1 / 26, mean burst 1 / r = 4. */
+    MY_ASSERT(stats.lost_ > 3400 && stats.lost_ < 4300);
+    MY_ASSERT(bursts > 0 && (double)stats.lost_ / bursts > 3.5 && (double)stats.lost_ / bursts < 4.5);
+    net_impair_destroy(p_impair);
+}
+
+static void test_reorder(void)
+{
+    static uint32_t order[2 * 1000];
+    struct net_impair_config config;
+    struct net_impair_stats stats;
+    struct net_impair * p_impair;
+    unsigned int count, idx, late = 0;
+    /* Held back by 2.5 packets. */
+    MY_ASSERT(net_impair_parse(&config, "seed=9,reorder=10:2.5"));
+    p_impair = net_impair_create(&config);
+    count = run(p_impair, order, 1000);
+    net_impair_get_stats(p_impair, &stats);
+    MY_ASSERT(1000 == count);
+    for (idx = 1; idx < count; ++idx)
+        if (order[idx] < order[idx - 1])
+            ++late;
+    MY_ASSERT(stats.reordered_ > 50 && stats.reordered_ < 150);
+    MY_ASSERT(late > 0 && late <= stats.reordered_);
+    net_impair_destroy(p_impair);
+}
+
+int main(int argc, char ** argv)
+{
+    test_parse();
+    test_perfect();
+    test_delay();
+    test_seed();
+    test_bernoulli();
+    test_gilbert_elliott();
+    test_reorder();
+    return 0;
+}
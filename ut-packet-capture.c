@@ -0,0 +1,175 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file ut-packet-capture.c
+ * @brief Unit tests for the capture file.
+ * @details Writes, appends, maps and walks a capture file, including one cut short by a crash, and appends to such a file.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include "mcast-settings.h"
+#include "packet-capture.h"
+
+#define MY_ASSERT(cond) do { if(!(cond)) fprintf(stderr, "%s %u\n", __FILE__, __LINE__), abort(); } while(0)
+
+#define CAPTURE_PATH "ut-packet-capture.dat"
+
+static void test_round_trip(void)
+{
+    struct packet_capture_writer * p_writer;
+    struct packet_capture_reader * p_reader;
+    struct packet_capture_record const * p_record;
+    struct sockaddr_storage from4, from6, source;
+    uint8_t const * p_data;
+    char host[NI_MAXHOST];
+    unlink(CAPTURE_PATH);
+    ZeroMemory(&from4, sizeof(from4));
+    ((struct sockaddr_in *)&from4)->sin_family = AF_INET;
+    ((struct sockaddr_in *)&from4)->sin_port = htons(4000);
+    inet_pton(AF_INET, "10.1.2.3", &((struct sockaddr_in *)&from4)->sin_addr);
+    ZeroMemory(&from6, sizeof(from6));
+    ((struct sockaddr_in6 *)&from6)->sin6_family = AF_INET6;
+    ((struct sockaddr_in6 *)&from6)->sin6_port = htons(6000);
+    inet_pton(AF_INET6, "fe80::1", &((struct sockaddr_in6 *)&from6)->sin6_addr);
+    p_writer = packet_capture_writer_open(CAPTURE_PATH);
+    MY_ASSERT(NULL != p_writer);
+    MY_ASSERT(packet_capture_writer_append(p_writer, 1000, &from4, "abc", 3));
+    MY_ASSERT(packet_capture_writer_append(p_writer, 2000, &from6, "0123456789", 10));
+    packet_capture_writer_close(p_writer);
+    /* Reopening appends after the records already there. */
+    p_writer = packet_capture_writer_open(CAPTURE_PATH);
+    MY_ASSERT(NULL != p_writer);
+    MY_ASSERT(packet_capture_writer_append(p_writer, 3000, NULL, "", 0));
+    MY_ASSERT(packet_capture_writer_flush(p_writer));
+    packet_capture_writer_close(p_writer);
+
+    p_reader = packet_capture_reader_open(CAPTURE_PATH);
+    MY_ASSERT(NULL != p_reader);
+    p_record = packet_capture_reader_next(p_reader, &p_data);
+    MY_ASSERT(NULL != p_record && packet_capture_record_is_session(p_record) && 1000 == p_record->timestamp_ && 0 == p_record->size_);
+    MY_ASSERT(!packet_capture_record_get_source(p_record, &source));
+    p_record = packet_capture_reader_next(p_reader, &p_data);
+    MY_ASSERT(NULL != p_record && !packet_capture_record_is_session(p_record));
+    MY_ASSERT(1000 == p_record->timestamp_ && 3 == p_record->size_ && 0 == memcmp(p_data, "abc", 3));
+    MY_ASSERT(packet_capture_record_get_source(p_record, &source));
+    MY_ASSERT(mcast_settings_format_address(&source, host, sizeof(host)) && 0 == strcmp(host, "10.1.2.3"));
+    MY_ASSERT(htons(4000) == ((struct sockaddr_in *)&source)->sin_port);
+    p_record = packet_capture_reader_next(p_reader, &p_data);
+    MY_ASSERT(NULL != p_record && 2000 == p_record->timestamp_ && 10 == p_record->size_ && 0 == memcmp(p_data, "0123456789", 10));
+    MY_ASSERT(0 == ((uintptr_t)p_record % 8));
+    MY_ASSERT(packet_capture_record_get_source(p_record, &source) && AF_INET6 == source.ss_family);
+    MY_ASSERT(htons(6000) == ((struct sockaddr_in6 *)&source)->sin6_port);
+    /* The second writer starts a session of its own. */
+    p_record = packet_capture_reader_next(p_reader, &p_data);
+    MY_ASSERT(NULL != p_record && packet_capture_record_is_session(p_record) && 3000 == p_record->timestamp_);
+    p_record = packet_capture_reader_next(p_reader, &p_data);
+    MY_ASSERT(NULL != p_record && !packet_capture_record_is_session(p_record) && 3000 == p_record->timestamp_ && 0 == p_record->size_);
+    MY_ASSERT(!packet_capture_record_get_source(p_record, &source));
+    MY_ASSERT(NULL == packet_capture_reader_next(p_reader, &p_data));
+    packet_capture_reader_rewind(p_reader);
+    p_record = packet_capture_reader_next(p_reader, &p_data);
+    MY_ASSERT(NULL != p_record && packet_capture_record_is_session(p_record) && 1000 == p_record->timestamp_);
+    packet_capture_reader_close(p_reader);
+}
+
+/*!
+ * @brief A record cut short by a crash of the writer ends the capture, it is not read past the end of the file.
+ */
+static void test_truncated(void)
+{
+    struct packet_capture_reader * p_reader;
+    uint8_t const * p_data;
+    struct stat st_file;
+    unsigned int count = 0;
+    MY_ASSERT(0 == stat(CAPTURE_PATH, &st_file));
+    /* Drops the last, empty, record, the session marker before it, and the padding and the last 4 bytes of the one before. */
+    MY_ASSERT(0 == truncate(CAPTURE_PATH, st_file.st_size - 2 * sizeof(struct packet_capture_record) - 6 - 4));
+    p_reader = packet_capture_reader_open(CAPTURE_PATH);
+    MY_ASSERT(NULL != p_reader);
+    while (NULL != packet_capture_reader_next(p_reader, &p_data))
+        ++count;
+    MY_ASSERT(2 == count);
+    packet_capture_reader_close(p_reader);
+}
+
+/*!
+ * @brief The writer cuts off the record left incomplete, so that the records it appends can be read back.
+ */
+static void test_append_after_crash(void)
+{
+    struct packet_capture_writer * p_writer;
+    struct packet_capture_reader * p_reader;
+    struct packet_capture_record const * p_record;
+    uint8_t const * p_data;
+    struct stat st_file;
+    p_writer = packet_capture_writer_open(CAPTURE_PATH);
+    MY_ASSERT(NULL != p_writer);
+    MY_ASSERT(packet_capture_writer_append(p_writer, 4000, NULL, "xyz", 3));
+    packet_capture_writer_close(p_writer);
+    /* Only the padding of the last record is missing, the record itself is kept. */
+    MY_ASSERT(0 == stat(CAPTURE_PATH, &st_file));
+    MY_ASSERT(0 == truncate(CAPTURE_PATH, st_file.st_size - 5));
+    p_writer = packet_capture_writer_open(CAPTURE_PATH);
+    MY_ASSERT(NULL != p_writer);
+    MY_ASSERT(packet_capture_writer_append(p_writer, 5000, NULL, "de", 2));
+    packet_capture_writer_close(p_writer);
+
+    p_reader = packet_capture_reader_open(CAPTURE_PATH);
+    MY_ASSERT(NULL != p_reader);
+    p_record = packet_capture_reader_next(p_reader, &p_data);
+    MY_ASSERT(NULL != p_record && packet_capture_record_is_session(p_record));
+    p_record = packet_capture_reader_next(p_reader, &p_data);
+    MY_ASSERT(NULL != p_record && 1000 == p_record->timestamp_);
+    p_record = packet_capture_reader_next(p_reader, &p_data);
+    MY_ASSERT(NULL != p_record && packet_capture_record_is_session(p_record) && 4000 == p_record->timestamp_);
+    p_record = packet_capture_reader_next(p_reader, &p_data);
+    MY_ASSERT(NULL != p_record && 4000 == p_record->timestamp_ && 3 == p_record->size_ && 0 == memcmp(p_data, "xyz", 3));
+    p_record = packet_capture_reader_next(p_reader, &p_data);
+    MY_ASSERT(NULL != p_record && packet_capture_record_is_session(p_record) && 5000 == p_record->timestamp_);
+    MY_ASSERT(0 == ((uintptr_t)p_record % 8));
+    p_record = packet_capture_reader_next(p_reader, &p_data);
+    MY_ASSERT(NULL != p_record && 5000 == p_record->timestamp_ && 2 == p_record->size_ && 0 == memcmp(p_data, "de", 2));
+    MY_ASSERT(NULL == packet_capture_reader_next(p_reader, &p_data));
+    packet_capture_reader_close(p_reader);
+}
+
+static void test_not_a_capture(void)
+{
+    FILE * fp = fopen(CAPTURE_PATH, "wb");
+    MY_ASSERT(NULL != fp);
+    fputs("RIFF....WAVEfmt ", fp);
+    fclose(fp);
+    MY_ASSERT(NULL == packet_capture_reader_open(CAPTURE_PATH));
+    MY_ASSERT(NULL == packet_capture_writer_open(CAPTURE_PATH));
+    MY_ASSERT(NULL == packet_capture_reader_open("ut-packet-capture.missing"));
+    unlink(CAPTURE_PATH);
+}
+
+int main(int argc, char ** argv)
+{
+    test_round_trip();
+    test_truncated();
+    test_append_after_crash();
+    test_not_a_capture();
+    return 0;
+}
@@ -0,0 +1,137 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file ut-packet-index.c
+ * @brief Unit test for the packet index.
+ * @details Checks the entries against the file, and that the sidecar is reused, and rebuilt when the file or the packet size changes.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include "wave-reader.h"
+#include "packet-index.h"
+
+#define MY_ASSERT(cond) do { if(!(cond)) fprintf(stderr, "%s %u\n", __FILE__, __LINE__), abort(); } while(0)
+
+#define WAVE_PATH "ut-packet-index.wav"
+#define INDEX_PATH WAVE_PATH PACKET_INDEX_SUFFIX
+
+/*!
+ * @brief Writes a 16-bit stereo file of the given number of frames, with a LIST chunk before the data.
+ */
+static void write_wave(uint32_t frames_count)
+{
+    static uint8_t const header[] = {
+        'R', 'I', 'F', 'F', 0, 0, 0, 0, 'W', 'A', 'V', 'E',
+        'f', 'm', 't', ' ', 16, 0, 0, 0, 1, 0, 2, 0, 0x80, 0x3e, 0, 0, 0, 0xfa, 0, 0, 4, 0, 16, 0,
+        'L', 'I', 'S', 'T', 6, 0, 0, 0, 'I', 'N', 'F', 'O', 0, 0,
+        'd', 'a', 't', 'a', 0, 0, 0, 0 };
+    uint32_t idx;
+    FILE * fp = fopen(WAVE_PATH, "wb");
+    MY_ASSERT(NULL != fp);
+    MY_ASSERT(1 == fwrite(header, sizeof(header), 1, fp));
+    for (idx = 0; idx < frames_count; ++idx)
+        MY_ASSERT(1 == fwrite(&idx, sizeof(idx), 1, fp));
+    fclose(fp);
+}
+
+static void test_build(void)
+{
+    struct wave_reader * p_reader;
+    struct packet_index * p_index;
+    struct packet_index_entry const * p_entry;
+    uint32_t frame;
+    write_wave(1000);
+    p_reader = wave_reader_open(WAVE_PATH, FILE_SOURCE_PREAD);
+    MY_ASSERT(NULL != p_reader && 58 == wave_reader_get_data_offset(p_reader));
+    MY_ASSERT(NULL == packet_index_build(p_reader, 0));
+    /* The last 40 frames do not make a whole packet. */
+    p_index = packet_index_build(p_reader, 64);
+    MY_ASSERT(NULL != p_index && 15 == packet_index_get_count(p_index) && 64 == packet_index_get_frames_per_packet(p_index));
+    p_entry = packet_index_get(p_index, 7);
+    MY_ASSERT(NULL != p_entry && 7 * 64 == p_entry->timestamp_ && 58 + 7 * 64 * 4 == p_entry->offset_);
+    MY_ASSERT(NULL == packet_index_get(p_index, 15));
+    MY_ASSERT(0 == packet_index_find(p_index, 63) && 1 == packet_index_find(p_index, 64) && 15 == packet_index_find(p_index, 5000));
+    /* The entry leads to the right frame, whichever way the file is read. */
+    wave_reader_seek(p_reader, p_entry->timestamp_);
+    MY_ASSERT(1 == wave_reader_read_frames(p_reader, &frame, 1) && 7 * 64 == frame);
+    {
+        FILE * fp = fopen(WAVE_PATH, "rb");
+        MY_ASSERT(NULL != fp && 0 == fseek(fp, (long)p_entry->offset_, SEEK_SET) && 1 == fread(&frame, sizeof(frame), 1, fp));
+        MY_ASSERT(7 * 64 == frame);
+        fclose(fp);
+    }
+    packet_index_destroy(p_index);
+    wave_reader_close(p_reader);
+}
+
+static void test_sidecar(void)
+{
+    struct wave_reader * p_reader;
+    struct packet_index * p_index;
+    struct stat st_index;
+    time_t written;
+    unlink(INDEX_PATH);
+    write_wave(1000);
+    p_reader = wave_reader_open(WAVE_PATH, FILE_SOURCE_MMAP);
+    MY_ASSERT(NULL != p_reader);
+    MY_ASSERT(NULL == packet_index_load(INDEX_PATH, WAVE_PATH, 64));
+    p_index = packet_index_open(WAVE_PATH, p_reader, 64);
+    MY_ASSERT(NULL != p_index && 15 == packet_index_get_count(p_index));
+    packet_index_destroy(p_index);
+    MY_ASSERT(0 == stat(INDEX_PATH, &st_index));
+    MY_ASSERT(sizeof(struct packet_index_header) + 15 * sizeof(struct packet_index_entry) == (size_t)st_index.st_size);
+    written = st_index.st_mtime;
+    /* The second time the sidecar is used. */
+    p_index = packet_index_load(INDEX_PATH, WAVE_PATH, 64);
+    MY_ASSERT(NULL != p_index && 15 == packet_index_get_count(p_index));
+    MY_ASSERT(58 + 14 * 64 * 4 == packet_index_get(p_index, 14)->offset_);
+    packet_index_destroy(p_index);
+    /* A different packet size is a different index. */
+    MY_ASSERT(NULL == packet_index_load(INDEX_PATH, WAVE_PATH, 32));
+    p_index = packet_index_open(WAVE_PATH, p_reader, 32);
+    MY_ASSERT(NULL != p_index && 31 == packet_index_get_count(p_index));
+    packet_index_destroy(p_index);
+    wave_reader_close(p_reader);
+    MY_ASSERT(written == st_index.st_mtime);
+    /* A changed file makes the index stale. */
+    write_wave(2000);
+    MY_ASSERT(NULL == packet_index_load(INDEX_PATH, WAVE_PATH, 32));
+    p_reader = wave_reader_open(WAVE_PATH, FILE_SOURCE_PREAD);
+    MY_ASSERT(NULL != p_reader);
+    p_index = packet_index_open(WAVE_PATH, p_reader, 32);
+    MY_ASSERT(NULL != p_index && 62 == packet_index_get_count(p_index));
+    packet_index_destroy(p_index);
+    wave_reader_close(p_reader);
+    /* A truncated sidecar is not used. */
+    MY_ASSERT(0 == truncate(INDEX_PATH, sizeof(struct packet_index_header) + 10));
+    MY_ASSERT(NULL == packet_index_load(INDEX_PATH, WAVE_PATH, 32));
+    unlink(INDEX_PATH);
+}
+
+int main(int argc, char ** argv)
+{
+    test_build();
+    test_sidecar();
+    unlink(WAVE_PATH);
+    return 0;
+}
@@ -0,0 +1,152 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file ut-perf-counter.c
+ * @brief Unit tests for the latency histogram and the performance counter.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include "latency-histogram.h"
+#include "perf-counter-itf.h"
+#include "latency-probe.h"
+
+/*!
+ * @brief An assert macro that works with RELEASE builds.
+ */
+#define MY_ASSERT(cond) do { if(!(cond)) fprintf(stderr, "%s %u\n", __FILE__, __LINE__), abort(); } while(0)
+
+/*!
+ * @brief Checks that the reported value is within the histogram's resolution of the expected one.
+ */
+static int is_close(uint64_t value, uint64_t expected)
+{
+    uint64_t error = value > expected ? value - expected : expected - value;
+    return error * LATENCY_HISTOGRAM_SUB_COUNT <= expected;
+}
+
+static void test_histogram_percentiles(void)
+{
+    static struct latency_histogram histogram;
+    uint64_t value;
+    latency_histogram_reset(&histogram);
+    MY_ASSERT(0 == latency_histogram_get_percentile(&histogram, 50.0));
+    MY_ASSERT(0 == latency_histogram_get_mean(&histogram));
+    /* 1..100000, so the percentiles are known. */
+    for (value = 1; value <= 100000; ++value)
+        latency_histogram_record(&histogram, value);
+    MY_ASSERT(100000 == histogram.count_);
+    MY_ASSERT(1 == histogram.min_);
+    MY_ASSERT(100000 == histogram.max_);
+    MY_ASSERT(50000 == latency_histogram_get_mean(&histogram));
+    MY_ASSERT(is_close(latency_histogram_get_percentile(&histogram, 50.0), 50000));
+    MY_ASSERT(is_close(latency_histogram_get_percentile(&histogram, 99.0), 99000));
+    MY_ASSERT(is_close(latency_histogram_get_percentile(&histogram, 99.9), 99900));
+    MY_ASSERT(1 == latency_histogram_get_percentile(&histogram, 0.0));
+    MY_ASSERT(100000 == latency_histogram_get_percentile(&histogram, 100.0));
+}
+
+static void test_histogram_extremes(void)
+{
+    static struct latency_histogram histogram;
+    latency_histogram_reset(&histogram);
+    /* Small values are counted exactly. */
+    latency_histogram_record(&histogram, 0);
+    latency_histogram_record(&histogram, 7);
+    latency_histogram_record(&histogram, 15);
+    MY_ASSERT(7 == latency_histogram_get_percentile(&histogram, 50.0));
+    MY_ASSERT(15 == latency_histogram_get_percentile(&histogram, 100.0));
+    /* The largest values must not overflow the buckets. */
+    latency_histogram_record(&histogram, ~(uint64_t)0);
+    MY_ASSERT(~(uint64_t)0 == latency_histogram_get_percentile(&histogram, 100.0));
+    /* A single outlier shows in p99.9, but not in the median. */
+    latency_histogram_reset(&histogram);
+    {
+        unsigned int idx;
+        for (idx = 0; idx < 999; ++idx)
+            latency_histogram_record(&histogram, 1000);
+        latency_histogram_record(&histogram, 1000000);
+    }
+    MY_ASSERT(is_close(latency_histogram_get_percentile(&histogram, 50.0), 1000));
+    MY_ASSERT(is_close(latency_histogram_get_percentile(&histogram, 99.0), 1000));
+    MY_ASSERT(1000000 == latency_histogram_get_percentile(&histogram, 100.0));
+}
+
+static void test_perf_counter(void)
+{
+    struct perf_counter * p_counter = perf_counter_create();
+    struct perf_counter_stats stats;
+    int64_t total, avg;
+    unsigned int idx;
+    MY_ASSERT(NULL != p_counter);
+    MY_ASSERT(perf_counter_get_freq(p_counter) > 0);
+    MY_ASSERT(!perf_counter_get_stats(p_counter, &stats));
+    MY_ASSERT(!perf_counter_get_duration(p_counter, &total, &avg));
+    for (idx = 0; idx < 100; ++idx)
+    {
+        perf_counter_mark_before(p_counter);
+        usleep(idx == 50 ? 20000 : 100);
+        perf_counter_mark_after(p_counter);
+    }
+    MY_ASSERT(perf_counter_get_stats(p_counter, &stats));
+    MY_ASSERT(100 == stats.count_);
+    MY_ASSERT(stats.min_ >= 100000);
+    MY_ASSERT(stats.min_ <= stats.p50_ && stats.p50_ <= stats.p99_ && stats.p99_ <= stats.p999_ && stats.p999_ <= stats.max_);
+    /* The one long sleep is the maximum, but it does not move the median. */
+    MY_ASSERT(stats.max_ >= 20000000);
+    MY_ASSERT(stats.p50_ < 20000000);
+    MY_ASSERT(perf_counter_get_duration(p_counter, &total, &avg));
+    MY_ASSERT(total >= 100 * avg && total < 101 * avg);
+    perf_counter_reset(p_counter);
+    MY_ASSERT(!perf_counter_get_stats(p_counter, &stats));
+    perf_counter_destroy(p_counter);
+}
+
+static void test_latency_probe(void)
+{
+    uint64_t now = latency_probe_get_time();
+    struct latency_probe * p_probe = latency_probe_create();
+    MY_ASSERT(NULL != p_probe);
+    /* The clock counts from the Unix epoch, i.e. it is comparable between hosts. */
+    MY_ASSERT(now > 1500000000ULL * 1000000000ULL);
+    latency_probe_record_transit(p_probe, now, now + 250000);
+    latency_probe_record_transit(p_probe, now, now + 750000);
+    latency_probe_record_transit(p_probe, now + 1000, now);
+    MY_ASSERT(2 == latency_probe_get_transit(p_probe)->count_);
+    MY_ASSERT(250000 == latency_probe_get_transit(p_probe)->min_);
+    MY_ASSERT(750000 == latency_probe_get_transit(p_probe)->max_);
+    MY_ASSERT(1 == latency_probe_get_skewed(p_probe));
+    MY_ASSERT(0 == latency_probe_get_residency(p_probe)->count_);
+    latency_probe_dump(p_probe);
+    latency_probe_reset(p_probe);
+    MY_ASSERT(0 == latency_probe_get_transit(p_probe)->count_ && 0 == latency_probe_get_skewed(p_probe));
+    latency_probe_destroy(p_probe);
+}
+
+int main(int argc, char ** argv)
+{
+    test_histogram_percentiles();
+    test_histogram_extremes();
+    test_perf_counter();
+    test_latency_probe();
+    return 0;
+}
@@ -0,0 +1,224 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file ut-pipeline.c
+ * @brief Unit tests of the multi-stage pipeline.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include "pipeline.h"
+
+#define MY_ASSERT(cond) do { if(!(cond)) fprintf(stderr, "%s %u\n", __FILE__, __LINE__), abort(); } while(0)
+
+#define MESSAGES_COUNT (10000)
+
+/*!
+ * @brief Adds a constant to the number, optionally sleeping first to emulate a slow stage.
+ */
+struct add {
+    uint32_t constant_; /*!< Added to each number. */
+    unsigned int sleep_us_; /*!< Slept for before each number. */
+};
+
+static size_t add_number(void * p_context, void const * p_input, size_t input_size, void * p_output)
+{
+    struct add const * p_add = (struct add const *)p_context;
+    uint32_t number;
+    assert(sizeof(number) == input_size);
+    memcpy(&number, p_input, sizeof(number));
+    if (0 != p_add->sleep_us_)
+        usleep(p_add->sleep_us_);
+    number += p_add->constant_;
+    memcpy(p_output, &number, sizeof(number));
+    /* The odd numbers are not handed on. */
+    return 0 == (number & 1) ? sizeof(number) : 0;
+}
+
+/*!
+ * @brief Checks the numbers that come out of the pipeline.
+ */
+struct collect {
+    uint32_t count_; /*!< Number of numbers seen. */
+    uint32_t last_; /*!< The number seen most recently. */
+    unsigned int out_of_order_; /*!< Number of numbers that were not larger than the one before. */
+};
+
+static size_t collect_number(void * p_context, void const * p_input, size_t input_size, void * p_output)
+{
+    struct collect * p_collect = (struct collect *)p_context;
+    uint32_t number;
+    memcpy(&number, p_input, sizeof(number));
+    if (0 != p_collect->count_ && number <= p_collect->last_)
+        ++p_collect->out_of_order_;
+    p_collect->last_ = number;
+    ++p_collect->count_;
+    MY_ASSERT(NULL == p_output);
+    return 0;
+}
+
+static void push_numbers(struct pipeline * p_pipeline, uint32_t count, uint32_t * p_taken)
+{
+    uint32_t idx;
+    for (idx = 0; idx < count; ++idx)
+        *p_taken += pipeline_push(p_pipeline, &idx, sizeof(idx));
+}
+
+static void test_malformed(void)
+{
+    struct add add = { 0, 0 };
+    struct pipeline_stage_config stages[2] = {
+        { "add", &add_number, &add, sizeof(uint32_t), PIPELINE_EXTERNAL, 4, PIPELINE_BLOCK, -1 },
+        { "add", &add_number, &add, sizeof(uint32_t), PIPELINE_INLINE, 0, PIPELINE_BLOCK, -1 },
+    };
+    /* Only the last stage may be external. */
+    MY_ASSERT(NULL == pipeline_create(stages, 2));
+    MY_ASSERT(NULL == pipeline_create(stages, 0));
+    stages[0].mode_ = PIPELINE_THREAD;
+    stages[0].ring_slots_ = 3;
+    MY_ASSERT(NULL == pipeline_create(stages, 2));
+    stages[0].ring_slots_ = 4;
+    stages[1].input_size_ = 0;
+    MY_ASSERT(NULL == pipeline_create(stages, 2));
+}
+
+static void test_inline(void)
+{
+    struct add add = { 1, 0 };
+    struct collect collect = { 0, 0, 0 };
+    struct pipeline_stage_config const stages[2] = {
+        { "add", &add_number, &add, sizeof(uint32_t), PIPELINE_INLINE, 0, PIPELINE_BLOCK, -1 },
+        { "collect", &collect_number, &collect, sizeof(uint32_t), PIPELINE_INLINE, 0, PIPELINE_BLOCK, -1 },
+    };
+    struct pipeline_stage_stats stats;
+    struct pipeline * p_pipeline = pipeline_create(stages, 2);
+    uint32_t taken = 0;
+    MY_ASSERT(NULL != p_pipeline && -1 == pipeline_get_fd(p_pipeline));
+    push_numbers(p_pipeline, 100, &taken);
+    /* All run before the push returns. */
+    MY_ASSERT(100 == taken && 50 == collect.count_ && 100 == collect.last_ && 0 == collect.out_of_order_);
+    pipeline_get_stats(p_pipeline, 0, &stats);
+    MY_ASSERT(100 == stats.messages_ && 0 == stats.wait_.count_ && 100 == stats.service_.count_);
+    pipeline_destroy(p_pipeline);
+}
+
+static void test_threads(void)
+{
+    struct add add[2] = { { 1, 0 }, { 2, 0 } };
+    struct collect collect = { 0, 0, 0 };
+    struct pipeline_stage_config const stages[3] = {
+        { "first", &add_number, &add[0], sizeof(uint32_t), PIPELINE_THREAD, 8, PIPELINE_BLOCK, -1 },
+        { "second", &add_number, &add[1], sizeof(uint32_t), PIPELINE_THREAD, 4, PIPELINE_BLOCK, -1 },
+        { "collect", &collect_number, &collect, sizeof(uint32_t), PIPELINE_INLINE, 0, PIPELINE_BLOCK, -1 },
+    };
+    struct pipeline_stage_stats stats;
+    struct pipeline * p_pipeline = pipeline_create(stages, 3);
+    uint32_t taken = 0;
+    MY_ASSERT(NULL != p_pipeline);
+    push_numbers(p_pipeline, MESSAGES_COUNT, &taken);
+    /* Nothing dropped, nothing reordered, and everything processed once the threads are stopped. */
+    pipeline_stop(p_pipeline);
+    MY_ASSERT(MESSAGES_COUNT == taken);
+    pipeline_get_stats(p_pipeline, 0, &stats);
+    MY_ASSERT(MESSAGES_COUNT == stats.messages_ && 0 == stats.dropped_ && MESSAGES_COUNT == stats.wait_.count_);
+    MY_ASSERT(stats.max_queued_ >= 1 && stats.max_queued_ <= 8);
+    pipeline_get_stats(p_pipeline, 1, &stats);
+    MY_ASSERT(MESSAGES_COUNT / 2 == stats.messages_ && stats.max_queued_ <= 4);
+    /* The first stage passes the odd numbers plus one, the second one keeps all of them. */
+    MY_ASSERT(MESSAGES_COUNT / 2 == collect.count_ && MESSAGES_COUNT + 2 == collect.last_ && 0 == collect.out_of_order_);
+    pipeline_dump(stderr, p_pipeline);
+    pipeline_destroy(p_pipeline);
+}
+
+static void test_backpressure(void)
+{
+    /* The slow stage takes 1 ms, and the numbers are pushed as fast as possible. */
+    struct add add = { 0, 1000 };
+    struct collect collect = { 0, 0, 0 };
+    struct pipeline_stage_config stages[2] = {
+        { "slow", &add_number, &add, sizeof(uint32_t), PIPELINE_THREAD, 4, PIPELINE_DROP, -1 },
+        { "collect", &collect_number, &collect, sizeof(uint32_t), PIPELINE_INLINE, 0, PIPELINE_BLOCK, -1 },
+    };
+    struct pipeline_stage_stats stats;
+    struct pipeline * p_pipeline = pipeline_create(stages, 2);
+    uint32_t taken = 0;
+    MY_ASSERT(NULL != p_pipeline);
+    push_numbers(p_pipeline, 100, &taken);
+    pipeline_stop(p_pipeline);
+    pipeline_get_stats(p_pipeline, 0, &stats);
+    /* The pusher never waited, so most of the numbers did not fit. */
+    MY_ASSERT(taken < 100 && 100 == taken + stats.dropped_ && taken == stats.messages_ && 0 == stats.blocked_);
+    MY_ASSERT(stats.service_.min_ >= 1000000);
+    pipeline_destroy(p_pipeline);
+    /* Held back instead, so nothing is lost. */
+    memset(&collect, 0, sizeof(collect));
+    stages[0].overflow_ = PIPELINE_BLOCK;
+    p_pipeline = pipeline_create(stages, 2);
+    taken = 0;
+    MY_ASSERT(NULL != p_pipeline);
+    push_numbers(p_pipeline, 100, &taken);
+    pipeline_stop(p_pipeline);
+    pipeline_get_stats(p_pipeline, 0, &stats);
+    MY_ASSERT(100 == taken && 100 == stats.messages_ && 0 == stats.dropped_ && stats.blocked_ > 0);
+    MY_ASSERT(50 == collect.count_ && 98 == collect.last_);
+    /* The queue was full most of the time, so the numbers waited about 3 ms in it. */
+    MY_ASSERT(latency_histogram_get_percentile(&stats.wait_, 50.0) >= 2000000);
+    pipeline_destroy(p_pipeline);
+}
+
+static void test_external(void)
+{
+    struct add add = { 1, 0 };
+    struct collect collect = { 0, 0, 0 };
+    struct pipeline_stage_config const stages[2] = {
+        { "add", &add_number, &add, sizeof(uint32_t), PIPELINE_THREAD, 16, PIPELINE_BLOCK, -1 },
+        { "collect", &collect_number, &collect, sizeof(uint32_t), PIPELINE_EXTERNAL, 64, PIPELINE_DROP, -1 },
+    };
+    struct pipeline * p_pipeline = pipeline_create(stages, 2);
+    uint32_t taken = 0;
+    unsigned int serviced = 0;
+    MY_ASSERT(NULL != p_pipeline && pipeline_get_fd(p_pipeline) >= 0);
+    MY_ASSERT(0 == pipeline_service(p_pipeline));
+    push_numbers(p_pipeline, 100, &taken);
+    /* Serviced from the select loop, as the receiver does. */
+    while (serviced < 50)
+    {
+        fd_set read_fd;
+        struct timeval timeout = { 1, 0 };
+        FD_ZERO(&read_fd);
+        FD_SET(pipeline_get_fd(p_pipeline), &read_fd);
+        MY_ASSERT(1 == select(pipeline_get_fd(p_pipeline) + 1, &read_fd, NULL, NULL, &timeout));
+        serviced += pipeline_service(p_pipeline);
+    }
+    MY_ASSERT(50 == serviced && 50 == collect.count_ && 100 == collect.last_ && 0 == collect.out_of_order_);
+    pipeline_destroy(p_pipeline);
+}
+
+int main(int argc, char ** argv)
+{
+    test_malformed();
+    test_inline();
+    test_threads();
+    test_backpressure();
+    test_external();
+    return 0;
+}
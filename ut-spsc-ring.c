@@ -0,0 +1,108 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file ut-spsc-ring.c
+ * @brief Unit tests of the single producer, single consumer ring.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include <pthread.h>
+#include "spsc-ring.h"
+
+#define MY_ASSERT(cond) do { if(!(cond)) fprintf(stderr, "%s %u\n", __FILE__, __LINE__), abort(); } while(0)
+
+#define TRANSFER_COUNT (1000000)
+
+static void test_single_thread(void)
+{
+    struct spsc_ring * p_ring = spsc_ring_create(4, 20);
+    uint32_t idx;
+    MY_ASSERT(NULL == spsc_ring_create(3, 20) && NULL == spsc_ring_create(0, 20) && NULL == spsc_ring_create(4, 0));
+    MY_ASSERT(NULL != p_ring && 4 == spsc_ring_get_slots_count(p_ring) && 20 == spsc_ring_get_slot_size(p_ring));
+    MY_ASSERT(NULL == spsc_ring_begin_read(p_ring) && 0 == spsc_ring_get_count(p_ring));
+    for (idx = 0; idx < 4; ++idx)
+    {
+        uint32_t * p_slot = (uint32_t *)spsc_ring_begin_write(p_ring);
+        MY_ASSERT(NULL != p_slot);
+        /* Not committed, so the same slot again. */
+        MY_ASSERT(p_slot == spsc_ring_begin_write(p_ring));
+        *p_slot = idx;
+        spsc_ring_commit_write(p_ring);
+    }
+    MY_ASSERT(NULL == spsc_ring_begin_write(p_ring) && 4 == spsc_ring_get_count(p_ring));
+    /* Wraps around the end of the slots, and around the end of the indices. */
+    for (idx = 0; idx < 100000; ++idx)
+    {
+        uint32_t * p_slot = (uint32_t *)spsc_ring_begin_read(p_ring);
+        MY_ASSERT(NULL != p_slot && idx == *p_slot);
+        spsc_ring_commit_read(p_ring);
+        p_slot = (uint32_t *)spsc_ring_begin_write(p_ring);
+        MY_ASSERT(NULL != p_slot);
+        *p_slot = idx + 4;
+        spsc_ring_commit_write(p_ring);
+    }
+    spsc_ring_destroy(p_ring);
+}
+
+static void * produce(void * p_param)
+{
+    struct spsc_ring * p_ring = (struct spsc_ring *)p_param;
+    uint64_t idx;
+    for (idx = 0; idx < TRANSFER_COUNT; ++idx)
+    {
+        uint64_t * p_slot;
+        while (NULL == (p_slot = (uint64_t *)spsc_ring_begin_write(p_ring)))
+            sched_yield();
+        p_slot[0] = idx;
+        p_slot[1] = ~idx;
+        spsc_ring_commit_write(p_ring);
+    }
+    return NULL;
+}
+
+static void test_two_threads(void)
+{
+    struct spsc_ring * p_ring = spsc_ring_create(64, 2 * sizeof(uint64_t));
+    pthread_t producer;
+    uint64_t idx;
+    MY_ASSERT(NULL != p_ring && 0 == pthread_create(&producer, NULL, &produce, p_ring));
+    /* Each message is seen once, in order, and whole. */
+    for (idx = 0; idx < TRANSFER_COUNT; ++idx)
+    {
+        uint64_t const * p_slot;
+        while (NULL == (p_slot = (uint64_t const *)spsc_ring_begin_read(p_ring)))
+            sched_yield();
+        MY_ASSERT(idx == p_slot[0] && ~idx == p_slot[1]);
+        spsc_ring_commit_read(p_ring);
+    }
+    MY_ASSERT(0 == pthread_join(producer, NULL));
+    MY_ASSERT(NULL == spsc_ring_begin_read(p_ring));
+    spsc_ring_destroy(p_ring);
+}
+
+int main(int argc, char ** argv)
+{
+    test_single_thread();
+    test_two_threads();
+    return 0;
+}
@@ -0,0 +1,217 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file ut-stream-stats.c
+ * @brief Unit tests for the stream counters and the stats server.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include <pthread.h>
+#include <sys/un.h>
+#include "stream-stats.h"
+#include "stats-server.h"
+
+/*!
+ * @brief An assert macro that works with RELEASE builds.
+ */
+#define MY_ASSERT(cond) do { if(!(cond)) fprintf(stderr, "%s %u\n", __FILE__, __LINE__), abort(); } while(0)
+
+#define SOCKET_PATH "/tmp/ut-stream-stats.sock"
+#define PACKETS_PER_THREAD (100000)
+
+static struct stream_stats_stream const * find_stream(struct stream_stats_stream const * p_streams, unsigned int count, uint32_t ssrc)
+{
+    unsigned int idx;
+    for (idx = 0; idx < count; ++idx)
+        if (ssrc == p_streams[idx].ssrc_)
+            return &p_streams[idx];
+    return NULL;
+}
+
+static void test_loss_and_reorder(void)
+{
+    struct stream_stats * p_stats = stream_stats_create();
+    struct stream_stats_writer * p_writer;
+    struct stream_stats_stream streams[4];
+    static uint16_t const seqs[] = { 65530, 65531, 65533, 65532, 65535, 1, 2, 3 };
+    unsigned int idx;
+    MY_ASSERT(NULL != p_stats);
+    p_writer = stream_stats_add_writer(p_stats);
+    MY_ASSERT(NULL != p_writer);
+    MY_ASSERT(0 == stream_stats_snapshot(p_stats, streams, COUNTOF_ARRAY(streams)));
+    /* Across the wrap around: 65534 and 0 are lost, 65532 is late. */
+    for (idx = 0; idx < COUNTOF_ARRAY(seqs); ++idx)
+        stream_stats_on_packet(p_writer, 7, seqs[idx], 100);
+    stream_stats_on_unsequenced(p_writer, 9, 50);
+    stream_stats_set_fifo(p_writer, 7, 512, 3);
+    stream_stats_on_lateness(p_writer, 9, 0);
+    stream_stats_on_lateness(p_writer, 9, 1000);
+    stream_stats_on_lateness(p_writer, 9, 3000);
+    MY_ASSERT(2 == stream_stats_snapshot(p_stats, streams, COUNTOF_ARRAY(streams)));
+    MY_ASSERT(7 == streams[0].ssrc_);
+    MY_ASSERT(8 == streams[0].packets_ && 800 == streams[0].bytes_);
+    MY_ASSERT(2 == streams[0].lost_);
+    MY_ASSERT(1 == streams[0].reordered_);
+    MY_ASSERT(512 == streams[0].fifo_fill_ && 3 == streams[0].underruns_);
+    MY_ASSERT(9 == streams[1].ssrc_);
+    MY_ASSERT(1 == streams[1].packets_ && 50 == streams[1].bytes_ && 0 == streams[1].lost_);
+    MY_ASSERT(2 == streams[1].late_ && 3000 == streams[1].lateness_max_ && 4000 == streams[1].lateness_sum_);
+    /* Duplicates do not make the loss negative. */
+    stream_stats_on_packet(p_writer, 7, 3, 100);
+    stream_stats_on_packet(p_writer, 7, 3, 100);
+    stream_stats_snapshot(p_stats, streams, COUNTOF_ARRAY(streams));
+    MY_ASSERT(0 == streams[0].lost_);
+    /* Truncated snapshot. */
+    MY_ASSERT(1 == stream_stats_snapshot(p_stats, streams, 1));
+    stream_stats_destroy(p_stats);
+}
+
+static void * writer_routine(void * p_param)
+{
+    struct stream_stats_writer * p_writer = stream_stats_add_writer((struct stream_stats *)p_param);
+    unsigned int idx;
+    MY_ASSERT(NULL != p_writer);
+    for (idx = 0; idx < PACKETS_PER_THREAD; ++idx)
+        stream_stats_on_unsequenced(p_writer, 1 + (idx & 1), 10);
+    return NULL;
+}
+
+static void test_writers(void)
+{
+    struct stream_stats * p_stats = stream_stats_create();
+    struct stream_stats_stream streams[4];
+    pthread_t threads[2];
+    unsigned int idx;
+    unsigned int count;
+    uint64_t previous = 0;
+    MY_ASSERT(NULL != p_stats);
+    for (idx = 0; idx < COUNTOF_ARRAY(threads); ++idx)
+        MY_ASSERT(0 == pthread_create(&threads[idx], NULL, &writer_routine, p_stats));
+    /* Snapshots taken while the writers run never go backwards. */
+    for (idx = 0; idx < 100; ++idx)
+    {
+        struct stream_stats_stream const * p_stream;
+        count = stream_stats_snapshot(p_stats, streams, COUNTOF_ARRAY(streams));
+        p_stream = find_stream(streams, count, 1);
+        if (NULL != p_stream)
+        {
+            MY_ASSERT(p_stream->packets_ >= previous);
+            previous = p_stream->packets_;
+        }
+    }
+    for (idx = 0; idx < COUNTOF_ARRAY(threads); ++idx)
+        pthread_join(threads[idx], NULL);
+    count = stream_stats_snapshot(p_stats, streams, COUNTOF_ARRAY(streams));
+    MY_ASSERT(2 == count);
+    /* Both writers' counters of the same stream are summed up. */
+    MY_ASSERT(PACKETS_PER_THREAD == find_stream(streams, count, 1)->packets_);
+    MY_ASSERT(PACKETS_PER_THREAD == find_stream(streams, count, 2)->packets_);
+    MY_ASSERT(10 * PACKETS_PER_THREAD == find_stream(streams, count, 2)->bytes_);
+    for (idx = COUNTOF_ARRAY(threads); idx < STREAM_STATS_MAX_WRITERS; ++idx)
+        MY_ASSERT(NULL != stream_stats_add_writer(p_stats));
+    MY_ASSERT(NULL == stream_stats_add_writer(p_stats));
+    stream_stats_destroy(p_stats);
+}
+
+static void test_format(void)
+{
+    struct stream_stats * p_stats = stream_stats_create();
+    struct stream_stats_writer * p_writer = stream_stats_add_writer(p_stats);
+    char buffer[4096];
+    size_t length;
+    stream_stats_on_packet(p_writer, 42, 0, 1000);
+    stream_stats_on_packet(p_writer, 42, 2, 1000);
+    length = stream_stats_format_json(p_stats, buffer, sizeof(buffer));
+    MY_ASSERT(0 != length && strlen(buffer) == length);
+    MY_ASSERT(NULL != strstr(buffer, "{\"streams\":[{\"ssrc\":42,\"packets\":2,\"bytes\":2000,\"lost\":1,"));
+    length = stream_stats_format_prometheus(p_stats, buffer, sizeof(buffer));
+    MY_ASSERT(0 != length && strlen(buffer) == length);
+    MY_ASSERT(NULL != strstr(buffer, "# TYPE mcast_packets_total counter\nmcast_packets_total{ssrc=\"42\"} 2\n"));
+    MY_ASSERT(NULL != strstr(buffer, "mcast_lost_packets_total{ssrc=\"42\"} 1\n"));
+    /* Too small a buffer. */
+    MY_ASSERT(0 == stream_stats_format_json(p_stats, buffer, 16));
+    MY_ASSERT(0 == stream_stats_format_prometheus(p_stats, buffer, 16));
+    stream_stats_destroy(p_stats);
+}
+
+/*!
+ * @brief Sends the request to the server and reads the whole response.
+ */
+static size_t query(char const * psz_request, char * p_buffer, size_t buffer_size)
+{
+    struct sockaddr_un address;
+    size_t length = 0;
+    ssize_t result;
+    int s = socket(AF_UNIX, SOCK_STREAM, 0);
+    MY_ASSERT(s >= 0);
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, SOCKET_PATH);
+    MY_ASSERT(0 == connect(s, (struct sockaddr const *)&address, sizeof(address)));
+    if (NULL != psz_request)
+        MY_ASSERT((ssize_t)strlen(psz_request) == send(s, psz_request, strlen(psz_request), 0));
+    while (length < buffer_size - 1 && (result = recv(s, p_buffer + length, buffer_size - 1 - length, 0)) > 0)
+        length += (size_t)result;
+    p_buffer[length] = '\0';
+    close(s);
+    return length;
+}
+
+static void test_server(void)
+{
+    struct stream_stats * p_stats = stream_stats_create();
+    struct stream_stats_writer * p_writer = stream_stats_add_writer(p_stats);
+    struct stats_server * p_server;
+    FILE * fp_file;
+    char buffer[4096];
+    unsetenv(STATS_SERVER_PATH_VARIABLE);
+    stream_stats_on_packet(p_writer, 5, 10, 200);
+    p_server = stats_server_create(p_stats, SOCKET_PATH);
+    MY_ASSERT(NULL != p_server);
+    MY_ASSERT(0 != query("json\n", buffer, sizeof(buffer)));
+    MY_ASSERT(0 == strncmp(buffer, "{\"streams\":[{\"ssrc\":5,\"packets\":1,", 34));
+    MY_ASSERT(0 != query("prometheus\n", buffer, sizeof(buffer)));
+    MY_ASSERT(NULL != strstr(buffer, "mcast_bytes_total{ssrc=\"5\"} 200\n"));
+    /* A client that sends nothing gets JSON. */
+    MY_ASSERT(0 != query(NULL, buffer, sizeof(buffer)));
+    MY_ASSERT('{' == buffer[0]);
+    stats_server_destroy(p_server);
+    MY_ASSERT(0 != access(SOCKET_PATH, F_OK));
+    /* A file that is not a socket is not removed to make room for one. */
+    fp_file = fopen(SOCKET_PATH, "w");
+    MY_ASSERT(NULL != fp_file);
+    fclose(fp_file);
+    MY_ASSERT(NULL == stats_server_create(p_stats, SOCKET_PATH));
+    MY_ASSERT(0 == access(SOCKET_PATH, F_OK));
+    unlink(SOCKET_PATH);
+    stream_stats_destroy(p_stats);
+}
+
+int main(int argc, char ** argv)
+{
+    test_loss_and_reorder();
+    test_writers();
+    test_format();
+    test_server();
+    return 0;
+}
@@ -0,0 +1,128 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file ut-thread-sched.c
+ * @brief Unit tests of the real time scheduling.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include "thread-sched.h"
+
+#define MY_ASSERT(cond) do { if(!(cond)) fprintf(stderr, "%s %u\n", __FILE__, __LINE__), abort(); } while(0)
+
+static void test_parse(void)
+{
+    struct thread_sched_config config;
+    MY_ASSERT(thread_sched_parse(&config, "fifo:80@2"));
+    MY_ASSERT(THREAD_SCHED_FIFO == config.policy_ && 80 == config.priority_ && 2 == config.cpu_);
+    MY_ASSERT(thread_sched_parse(&config, "rr"));
+    MY_ASSERT(THREAD_SCHED_RR == config.policy_ && THREAD_SCHED_DEFAULT_PRIORITY == config.priority_ && -1 == config.cpu_);
+    MY_ASSERT(thread_sched_parse(&config, "other@0"));
+    MY_ASSERT(THREAD_SCHED_OTHER == config.policy_ && 0 == config.priority_ && 0 == config.cpu_);
+    MY_ASSERT(!thread_sched_parse(&config, "other:10"));
+    MY_ASSERT(!thread_sched_parse(&config, "fifo:0"));
+    MY_ASSERT(!thread_sched_parse(&config, "fifo:100"));
+    MY_ASSERT(!thread_sched_parse(&config, "fifo:"));
+    MY_ASSERT(!thread_sched_parse(&config, "fifo@"));
+    MY_ASSERT(!thread_sched_parse(&config, "fifo@2x"));
+    MY_ASSERT(!thread_sched_parse(&config, "deadline"));
+    MY_ASSERT(!thread_sched_parse(&config, "fif"));
+    MY_ASSERT(0 == strcmp("PLAYOUT", thread_sched_get_role_name(THREAD_ROLE_PLAYOUT)));
+    MY_ASSERT(0 == strcmp("rr", thread_sched_get_policy_name(THREAD_SCHED_RR)));
+}
+
+/*!
+ * @brief Applies the configuration given and checks the result against what the system reports.
+ */
+static void * apply_thread(void * p_param)
+{
+    struct thread_sched_config const * p_config = (struct thread_sched_config const *)p_param;
+    struct thread_sched_result result;
+    struct sched_param param;
+    int policy;
+    int got = thread_sched_apply(p_config, &result);
+    MY_ASSERT(0 == pthread_getschedparam(pthread_self(), &policy, &param));
+    MY_ASSERT(param.sched_priority == result.priority_);
+    MY_ASSERT((SCHED_OTHER == policy && THREAD_SCHED_OTHER == result.policy_) || (SCHED_FIFO == policy && THREAD_SCHED_FIFO == result.policy_)
+            || (SCHED_RR == policy && THREAD_SCHED_RR == result.policy_));
+    if (got)
+        MY_ASSERT(p_config->policy_ == result.policy_ && p_config->priority_ == result.priority_);
+    else
+        /* Without the privileges the thread is either on a lower priority or stays time shared. */
+        MY_ASSERT(result.priority_ < p_config->priority_ || THREAD_SCHED_OTHER == result.policy_ || p_config->cpu_ != result.cpu_);
+    return got ? p_param : NULL;
+}
+
+static int run_apply(struct thread_sched_config const * p_config)
+{
+    pthread_t thread;
+    void * p_got;
+    MY_ASSERT(0 == pthread_create(&thread, NULL, &apply_thread, (void *)p_config));
+    MY_ASSERT(0 == pthread_join(thread, &p_got));
+    return NULL != p_got;
+}
+
+static void test_apply(void)
+{
+    struct thread_sched_config config;
+    /* Pinning needs no privileges, and the first core is always there. */
+    MY_ASSERT(thread_sched_parse(&config, "other@0"));
+    MY_ASSERT(run_apply(&config));
+    /* Whether it is granted depends on the privileges, but the outcome is reported either way. */
+    MY_ASSERT(thread_sched_parse(&config, "fifo:10"));
+    run_apply(&config);
+    MY_ASSERT(thread_sched_parse(&config, "rr:20@0"));
+    run_apply(&config);
+    /* No such core. */
+    MY_ASSERT(thread_sched_parse(&config, "other@1023"));
+    MY_ASSERT(!run_apply(&config));
+}
+
+static void test_env(void)
+{
+    struct thread_sched_result result;
+    unsetenv(THREAD_SCHED_VARIABLE_PREFIX "CAPTURE");
+    MY_ASSERT(!thread_sched_apply_from_env(THREAD_ROLE_CAPTURE, &result));
+    MY_ASSERT(THREAD_SCHED_OTHER == result.policy_);
+    setenv(THREAD_SCHED_VARIABLE_PREFIX "CAPTURE", "bogus", 1);
+    MY_ASSERT(!thread_sched_apply_from_env(THREAD_ROLE_CAPTURE, &result));
+    setenv(THREAD_SCHED_VARIABLE_PREFIX "CAPTURE", "other", 1);
+    MY_ASSERT(thread_sched_apply_from_env(THREAD_ROLE_CAPTURE, &result));
+    unsetenv(THREAD_SCHED_VARIABLE_PREFIX "CAPTURE");
+    unsetenv(THREAD_SCHED_LOCK_VARIABLE);
+    MY_ASSERT(!thread_sched_lock_memory_from_env());
+    /* Locking may not be allowed, but must not fail any other way. */
+    if (thread_sched_lock_memory())
+        munlockall();
+}
+
+int main(int argc, char ** argv)
+{
+    test_parse();
+    test_apply();
+    test_env();
+    return 0;
+}
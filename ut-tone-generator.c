@@ -0,0 +1,250 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file ut-tone-generator.c
+ * @brief Unit test for the tone generator.
+ * @details Compares the oscillators against the libm sine, and checks the noise, the sequence tone and the rendered WAV image.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include "tone-generator.h"
+#include "wave_utils.h"
+#include "wave-reader.h"
+
+#define MY_ASSERT(cond) do { if(!(cond)) fprintf(stderr, "%s %u\n", __FILE__, __LINE__), abort(); } while(0)
+
+#define RATE (44100)
+
+/*!
+ * @brief Number of frames generated by each test, not a multiple of the internal chunk nor of the lanes.
+ */
+#define FRAMES (3001)
+
+/*!
+ * @brief Largest difference allowed between the polynomial and the libm sine.
+ */
+#define SINE_TOLERANCE (1e-4)
+
+static float g_samples[FRAMES];
+
+/*!
+ * @brief Generates FRAMES frames in uneven pieces, so that the lanes and the chunks restart at odd places.
+ */
+static void fill_in_pieces(struct tone_generator * p_generator, float * p_output)
+{
+    static size_t const pieces[] = { 1, 3, 7, 250, 257, 1000 };
+    size_t done = 0;
+    unsigned int idx = 0;
+    while (done < FRAMES)
+    {
+        size_t count = pieces[idx++ % COUNTOF_ARRAY(pieces)];
+        if (count > FRAMES - done)
+            count = FRAMES - done;
+        tone_generator_fill_float(p_generator, &p_output[done], count);
+        done += count;
+    }
+}
+
+static void test_parse(void)
+{
+    struct tone_generator_config config;
+    MY_ASSERT(tone_generator_parse(&config, "sine:440"));
+    MY_ASSERT(TONE_GENERATOR_SINE == config.type_ && 1 == config.tones_count_ && 440.0f == config.frequencies_[0]);
+    MY_ASSERT(RATE == config.sample_rate_ && 2 == config.channels_ && TONE_GENERATOR_DEFAULT_PACKET_FRAMES == config.packet_frames_);
+    MY_ASSERT(tone_generator_parse(&config, "sweep:100:8000:2.5"));
+    MY_ASSERT(TONE_GENERATOR_SWEEP == config.type_ && 2 == config.tones_count_ && 2.5f == config.sweep_seconds_);
+    MY_ASSERT(tone_generator_parse(&config, "multi:440:660:880"));
+    MY_ASSERT(TONE_GENERATOR_MULTI == config.type_ && 3 == config.tones_count_ && 880.0f == config.frequencies_[2]);
+    MY_ASSERT(tone_generator_parse(&config, "pink"));
+    MY_ASSERT(TONE_GENERATOR_PINK == config.type_ && 1 == config.seed_);
+    MY_ASSERT(tone_generator_parse(&config, "pink:7"));
+    MY_ASSERT(7 == config.seed_ && 0 == config.tones_count_);
+    MY_ASSERT(tone_generator_parse(&config, "seq:1000:250"));
+    MY_ASSERT(TONE_GENERATOR_SEQUENCE == config.type_ && 1250.0f == tone_generator_sequence_frequency(&config, 17));
+    MY_ASSERT(!tone_generator_parse(&config, ""));
+    MY_ASSERT(!tone_generator_parse(&config, "sine"));
+    MY_ASSERT(!tone_generator_parse(&config, "sine:"));
+    MY_ASSERT(!tone_generator_parse(&config, "sine:440:880"));
+    MY_ASSERT(!tone_generator_parse(&config, "sine:440x"));
+    MY_ASSERT(!tone_generator_parse(&config, "sweep:100:8000"));
+    MY_ASSERT(!tone_generator_parse(&config, "multi:1:2:3:4:5:6:7:8:9"));
+    MY_ASSERT(!tone_generator_parse(&config, "noise"));
+}
+
+static void test_create(void)
+{
+    struct tone_generator_config config;
+    MY_ASSERT(tone_generator_parse(&config, "sine:22050"));
+    MY_ASSERT(NULL == tone_generator_create(&config));
+    MY_ASSERT(tone_generator_parse(&config, "sine:440"));
+    config.amplitude_ = 0.0f;
+    MY_ASSERT(NULL == tone_generator_create(&config));
+    config.amplitude_ = 1.0f;
+    config.channels_ = 0;
+    MY_ASSERT(NULL == tone_generator_create(&config));
+    /* The highest slot, 1000 + 15 * 1500 Hz, is above the Nyquist frequency. */
+    MY_ASSERT(tone_generator_parse(&config, "seq:1000:1500"));
+    MY_ASSERT(NULL == tone_generator_create(&config));
+    MY_ASSERT(tone_generator_parse(&config, "sweep:100:8000:0"));
+    MY_ASSERT(NULL == tone_generator_create(&config));
+}
+
+static void test_sine(void)
+{
+    struct tone_generator_config config;
+    struct tone_generator * p_generator;
+    size_t idx;
+    MY_ASSERT(tone_generator_parse(&config, "multi:440:1234.5:20000"));
+    p_generator = tone_generator_create(&config);
+    MY_ASSERT(NULL != p_generator);
+    fill_in_pieces(p_generator, g_samples);
+    MY_ASSERT(FRAMES == tone_generator_get_position(p_generator));
+    for (idx = 0; idx < FRAMES; ++idx)
+    {
+        double expected = 0.0;
+        unsigned int tone;
+        for (tone = 0; tone < config.tones_count_; ++tone)
+            expected += config.amplitude_ / config.tones_count_ * sin(2.0 * M_PI * config.frequencies_[tone] * idx / RATE);
+        MY_ASSERT(fabs(expected - g_samples[idx]) < SINE_TOLERANCE);
+    }
+    tone_generator_destroy(p_generator);
+}
+
+static void test_sweep(void)
+{
+    struct tone_generator_config config;
+    struct tone_generator * p_generator;
+    double chirp;
+    size_t idx;
+    /* A sweep of 1000 frames, so that it starts over three times within the test. */
+    MY_ASSERT(tone_generator_parse(&config, "sweep:100:10000:0.0226758"));
+    p_generator = tone_generator_create(&config);
+    MY_ASSERT(NULL != p_generator);
+    fill_in_pieces(p_generator, g_samples);
+    chirp = (10000.0 - 100.0) / RATE / 1000.0;
+    for (idx = 0; idx < FRAMES; ++idx)
+    {
+        /* The phase carries on where the previous sweep has ended. */
+        double const n = idx % 1000;
+        double const sweeps = idx / 1000;
+        double const full_sweep = 100.0 / RATE * 1000.0 + chirp * 0.5 * 1000.0 * 999.0;
+        double const phase = sweeps * full_sweep + 100.0 / RATE * n + chirp * 0.5 * n * (n - 1.0);
+        MY_ASSERT(fabs(config.amplitude_ * sin(2.0 * M_PI * phase) - g_samples[idx]) < SINE_TOLERANCE);
+    }
+    tone_generator_destroy(p_generator);
+}
+
+static void test_pink(void)
+{
+    static float other[FRAMES];
+    struct tone_generator_config config;
+    struct tone_generator * p_generator;
+    double energy = 0.0;
+    double difference = 0.0;
+    size_t idx;
+    MY_ASSERT(tone_generator_parse(&config, "pink:3"));
+    p_generator = tone_generator_create(&config);
+    MY_ASSERT(NULL != p_generator);
+    tone_generator_fill_float(p_generator, g_samples, FRAMES);
+    tone_generator_destroy(p_generator);
+    /* The same seed gives the same noise, another seed another one. */
+    p_generator = tone_generator_create(&config);
+    tone_generator_fill_float(p_generator, other, FRAMES);
+    MY_ASSERT(0 == memcmp(g_samples, other, sizeof(other)));
+    tone_generator_destroy(p_generator);
+    config.seed_ = 4;
+    p_generator = tone_generator_create(&config);
+    tone_generator_fill_float(p_generator, other, FRAMES);
+    MY_ASSERT(0 != memcmp(g_samples, other, sizeof(other)));
+    tone_generator_destroy(p_generator);
+    for (idx = 1; idx < FRAMES; ++idx)
+    {
+        MY_ASSERT(fabs(g_samples[idx]) <= 1.0f);
+        energy += g_samples[idx] * g_samples[idx];
+        difference += (g_samples[idx] - g_samples[idx - 1]) * (g_samples[idx] - g_samples[idx - 1]);
+    }
+    MY_ASSERT(energy > 0.0);
+    /* For white noise the difference of the neighbours has twice the energy of the samples; pink noise is dominated by
+     * the low frequencies, so the neighbours are alike. */
+    MY_ASSERT(difference < energy);
+}
+
+static void test_sequence(void)
+{
+    int16_t packet[2 * TONE_GENERATOR_DEFAULT_PACKET_FRAMES];
+    struct tone_generator_config config;
+    struct tone_generator * p_generator;
+    unsigned int idx;
+    MY_ASSERT(tone_generator_parse(&config, "seq:1000:250"));
+    p_generator = tone_generator_create(&config);
+    MY_ASSERT(NULL != p_generator);
+    for (idx = 0; idx < 3 * TONE_GENERATOR_SEQUENCE_SLOTS; ++idx)
+    {
+        tone_generator_fill(p_generator, packet, config.packet_frames_);
+        MY_ASSERT(packet[0] == packet[1] && packet[100] == packet[101]);
+        MY_ASSERT(idx % TONE_GENERATOR_SEQUENCE_SLOTS == tone_generator_decode_sequence(&config, packet, config.packet_frames_));
+    }
+    tone_generator_destroy(p_generator);
+}
+
+static void test_render_wave(void)
+{
+    static int16_t expected[2 * FRAMES];
+    static int16_t actual[2 * FRAMES];
+    struct tone_generator_config config;
+    struct tone_generator * p_generator;
+    struct wave_reader * p_reader;
+    struct wave_reader_format const * p_format;
+    void * p_image;
+    size_t size = 0;
+    MY_ASSERT(tone_generator_parse(&config, "sine:250"));
+    p_generator = tone_generator_create(&config);
+    MY_ASSERT(NULL != p_generator);
+    tone_generator_fill(p_generator, expected, FRAMES);
+    tone_generator_destroy(p_generator);
+    p_generator = tone_generator_create(&config);
+    p_image = tone_generator_render_wave(p_generator, FRAMES, &size);
+    MY_ASSERT(NULL != p_image && 44 + sizeof(expected) == size);
+    p_reader = wave_reader_open_memory(p_image, size);
+    MY_ASSERT(NULL != p_reader);
+    p_format = wave_reader_get_format(p_reader);
+    MY_ASSERT(WAVE_FORMAT_PCM == p_format->format_tag_ && 2 == p_format->channels_ && RATE == p_format->sample_rate_);
+    MY_ASSERT(16 == p_format->bits_per_sample_ && FRAMES == wave_reader_get_frames_count(p_reader));
+    MY_ASSERT(FRAMES == wave_reader_read_frames(p_reader, actual, FRAMES));
+    MY_ASSERT(0 == memcmp(expected, actual, sizeof(actual)));
+    wave_reader_close(p_reader);
+    free(p_image);
+    tone_generator_destroy(p_generator);
+}
+
+int main(int argc, char ** argv)
+{
+    test_parse();
+    test_create();
+    test_sine();
+    test_sweep();
+    test_pink();
+    test_sequence();
+    test_render_wave();
+    return 0;
+}
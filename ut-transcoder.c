@@ -0,0 +1,409 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file ut-transcoder.c
+ * @brief Unit tests for the codecs, the resampler, the thread pool and the transcoder configuration.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include <math.h>
+#include "audio-codec.h"
+#include "resampler.h"
+#include "thread-pool.h"
+#include "mcast-transcoder.h"
+#include "mcast-packet.h"
+
+/*!
+ * @brief An assert macro that works with RELEASE builds.
+ */
+#define MY_ASSERT(cond) do { if(!(cond)) fprintf(stderr, "%s %u\n", __FILE__, __LINE__), abort(); } while(0)
+
+#define TONE_SAMPLES (4400)
+
+static void make_tone(int16_t * p_samples, size_t count, double frequency, unsigned int rate, double amplitude)
+{
+    size_t idx;
+    for (idx = 0; idx < count; ++idx)
+        p_samples[idx] = (int16_t)(amplitude * sin(2.0 * 3.14159265358979323846 * frequency * idx / rate));
+}
+
+static void test_g711_round_trip(void)
+{
+    static int16_t const samples[] = { 0, 1, -1, 100, -100, 1000, -1000, 8000, -8000, 32767, -32768 };
+    uint8_t encoded[COUNTOF_ARRAY(samples)];
+    int16_t decoded[COUNTOF_ARRAY(samples)];
+    unsigned int codec;
+    size_t idx;
+    for (codec = AUDIO_CODEC_ULAW; codec <= AUDIO_CODEC_ALAW; ++codec)
+    {
+        MY_ASSERT(COUNTOF_ARRAY(samples) == audio_codec_encode(codec, NULL, samples, COUNTOF_ARRAY(samples), encoded, sizeof(encoded)));
+        MY_ASSERT(COUNTOF_ARRAY(samples) == audio_codec_decode(codec, encoded, sizeof(encoded), decoded, COUNTOF_ARRAY(decoded)));
+        for (idx = 0; idx < COUNTOF_ARRAY(samples); ++idx)
+        {
+            /* Companding keeps at least 4 significant bits. */
+            int32_t error = abs(samples[idx] - decoded[idx]);
+            MY_ASSERT(error <= 16 || error * 16 <= abs(samples[idx]));
+        }
+    }
+    /* Well known code points. */
+    MY_ASSERT(1 == audio_codec_encode(AUDIO_CODEC_ULAW, NULL, samples, 1, encoded, 1));
+    MY_ASSERT(0xff == encoded[0]);
+    MY_ASSERT(1 == audio_codec_encode(AUDIO_CODEC_ALAW, NULL, samples, 1, encoded, 1));
+    MY_ASSERT(0xd5 == encoded[0]);
+    /* Too small buffer. */
+    MY_ASSERT(0 == audio_codec_encode(AUDIO_CODEC_ULAW, NULL, samples, 2, encoded, 1));
+}
+
+static void test_sample_conversions(void)
+{
+    static uint8_t const packed[] = { 0x00, 0x00, 0x00, 0xff, 0xff, 0x7f, 0x00, 0x00, 0x80, 0x01, 0x00, 0x00, 0xff, 0xff, 0xff };
+    static float const floats[] = { 0.0f, 0.5f, -0.5f, 0.25f, 2.0f, -2.0f };
+    int32_t wide[COUNTOF_ARRAY(packed) / 3];
+    uint8_t repacked[COUNTOF_ARRAY(packed)];
+    float converted[COUNTOF_ARRAY(packed) / 3];
+    int16_t narrow[1000];
+    float constant[COUNTOF_ARRAY(narrow)];
+    uint32_t dither = 1;
+    int64_t sum = 0;
+    size_t idx;
+    audio_codec_int24_to_int32(packed, wide, COUNTOF_ARRAY(wide));
+    MY_ASSERT(0 == wide[0] && 0x7fffff00 == wide[1] && INT32_MIN == wide[2] && 0x100 == wide[3] && -256 == wide[4]);
+    audio_codec_int32_to_int24(wide, repacked, COUNTOF_ARRAY(wide));
+    MY_ASSERT(0 == memcmp(packed, repacked, sizeof(packed)));
+    audio_codec_int24_to_float(packed, converted, COUNTOF_ARRAY(converted));
+    MY_ASSERT(0.0f == converted[0] && converted[1] < 1.0f && converted[1] > 0.9999f && -1.0f == converted[2]);
+    audio_codec_float_to_int24(converted, repacked, COUNTOF_ARRAY(converted));
+    MY_ASSERT(0 == memcmp(packed, repacked, sizeof(packed)));
+    audio_codec_float_to_int24(floats, repacked, 3);
+    MY_ASSERT(0x00 == repacked[3] && 0x00 == repacked[4] && 0x40 == repacked[5]);
+    MY_ASSERT(0x00 == repacked[6] && 0x00 == repacked[7] && 0xc0 == repacked[8]);
+    /* Clipping. */
+    audio_codec_float_to_int16_dither(floats, narrow, COUNTOF_ARRAY(floats), &dither);
+    MY_ASSERT(32767 == narrow[4] && -32768 == narrow[5]);
+    MY_ASSERT(abs(narrow[1] - 16384) <= 1 && abs(narrow[2] + 16384) <= 1 && abs(narrow[3] - 8192) <= 1);
+    /* A level between two steps comes out as a mix of both, with the right mean. */
+    for (idx = 0; idx < COUNTOF_ARRAY(constant); ++idx)
+        constant[idx] = 100.25f / 32768.0f;
+    audio_codec_float_to_int16_dither(constant, narrow, COUNTOF_ARRAY(narrow), &dither);
+    for (idx = 0; idx < COUNTOF_ARRAY(narrow); ++idx)
+    {
+        MY_ASSERT(narrow[idx] >= 99 && narrow[idx] <= 102);
+        sum += narrow[idx];
+    }
+    MY_ASSERT(sum > 100 * 1000 && sum < 101 * 1000);
+}
+
+/*!
+ * @brief Checks the block conversions against the per sample formulas, for every length up to a few blocks.
+ */
+static void test_block_conversions(void)
+{
+    uint8_t packed[3 * 23];
+    uint8_t repacked[sizeof(packed)];
+    int32_t wide[COUNTOF_ARRAY(packed) / 3];
+    float converted[COUNTOF_ARRAY(wide)];
+    int16_t narrow[COUNTOF_ARRAY(wide)];
+    uint32_t random = 12345;
+    size_t count;
+    size_t idx;
+    for (idx = 0; idx < sizeof(packed); ++idx)
+    {
+        random = random * 22695477u + 1u;
+        packed[idx] = (uint8_t)(random >> 16);
+    }
+    for (count = 0; count <= COUNTOF_ARRAY(wide); ++count)
+    {
+        uint32_t dither = 7;
+        uint32_t expected_dither = dither;
+        memset(wide, 0, sizeof(wide));
+        memset(repacked, 0, sizeof(repacked));
+        audio_codec_int24_to_int32(packed, wide, count);
+        audio_codec_int24_to_float(packed, converted, count);
+        for (idx = 0; idx < count; ++idx)
+        {
+            int32_t sample = (int32_t)(((uint32_t)packed[3*idx] << 8) | ((uint32_t)packed[3*idx + 1] << 16) | ((uint32_t)packed[3*idx + 2] << 24));
+            MY_ASSERT(sample == wide[idx]);
+            MY_ASSERT((float)sample * (1.0f / 2147483648.0f) == converted[idx]);
+        }
+        MY_ASSERT(0 == wide[count % COUNTOF_ARRAY(wide)] || count == COUNTOF_ARRAY(wide));
+        audio_codec_int32_to_int24(wide, repacked, count);
+        MY_ASSERT(0 == memcmp(packed, repacked, 3 * count));
+        MY_ASSERT(count == COUNTOF_ARRAY(wide) || 0 == repacked[3 * count]);
+        memset(repacked, 0, sizeof(repacked));
+        audio_codec_float_to_int24(converted, repacked, count);
+        MY_ASSERT(0 == memcmp(packed, repacked, 3 * count));
+        audio_codec_float_to_int16_dither(converted, narrow, count, &dither);
+        for (idx = 0; idx < count; ++idx)
+        {
+            float sample;
+            float noise;
+            expected_dither = expected_dither * 1664525u + 1013904223u;
+            noise = (float)(expected_dither >> 8) * (1.0f / 16777216.0f);
+            expected_dither = expected_dither * 1664525u + 1013904223u;
+            noise += (float)(expected_dither >> 8) * (1.0f / 16777216.0f);
+            sample = converted[idx] * 32768.0f + noise - 1.0f;
+            sample = sample >= 32767.0f ? 32767.0f : (sample <= -32768.0f ? -32768.0f : sample);
+            MY_ASSERT((int16_t)lrintf(sample) == narrow[idx]);
+        }
+        MY_ASSERT(expected_dither == dither);
+    }
+}
+
+static void test_adpcm_round_trip(void)
+{
+    int16_t samples[TONE_SAMPLES];
+    int16_t decoded[TONE_SAMPLES];
+    uint8_t encoded[AUDIO_CODEC_IMA_ADPCM_HEADER_SIZE + TONE_SAMPLES / 2];
+    struct audio_codec_state state;
+    size_t idx;
+    size_t offset;
+    double error = 0.0;
+    double energy = 0.0;
+    make_tone(samples, TONE_SAMPLES, 440.0, 44100, 10000.0);
+    ZeroMemory(&state, sizeof(state));
+    MY_ASSERT(sizeof(encoded) == audio_codec_get_encoded_size(AUDIO_CODEC_IMA_ADPCM, TONE_SAMPLES));
+    MY_ASSERT(0 == audio_codec_encode(AUDIO_CODEC_IMA_ADPCM, NULL, samples, TONE_SAMPLES, encoded, sizeof(encoded)));
+    /* Two blocks, the second one starts from the state the first one left. */
+    for (offset = 0; offset < TONE_SAMPLES; offset += TONE_SAMPLES / 2)
+    {
+        size_t size = audio_codec_encode(AUDIO_CODEC_IMA_ADPCM, &state, &samples[offset], TONE_SAMPLES / 2, encoded, sizeof(encoded));
+        MY_ASSERT(AUDIO_CODEC_IMA_ADPCM_HEADER_SIZE + TONE_SAMPLES / 4 == size);
+        MY_ASSERT(TONE_SAMPLES / 2 == audio_codec_decode(AUDIO_CODEC_IMA_ADPCM, encoded, size, &decoded[offset], TONE_SAMPLES / 2));
+    }
+    for (idx = 0; idx < TONE_SAMPLES; ++idx)
+    {
+        error += (double)(samples[idx] - decoded[idx]) * (samples[idx] - decoded[idx]);
+        energy += (double)samples[idx] * samples[idx];
+    }
+    /* At least 20 dB signal to noise ratio. */
+    MY_ASSERT(error * 100.0 < energy);
+    /* An odd count decodes its last sample, but not the padding nibble after it. */
+    ZeroMemory(&state, sizeof(state));
+    MY_ASSERT(AUDIO_CODEC_IMA_ADPCM_HEADER_SIZE + 3 == audio_codec_encode(AUDIO_CODEC_IMA_ADPCM, &state, samples, 5, encoded, sizeof(encoded)));
+    decoded[5] = 12345;
+    MY_ASSERT(5 == audio_codec_decode(AUDIO_CODEC_IMA_ADPCM, encoded, AUDIO_CODEC_IMA_ADPCM_HEADER_SIZE + 3, decoded, 5));
+    MY_ASSERT(state.predictor_ == decoded[4] && 12345 == decoded[5]);
+    /* Malformed block. */
+    encoded[2] = 89;
+    MY_ASSERT(0 == audio_codec_decode(AUDIO_CODEC_IMA_ADPCM, encoded, sizeof(encoded), decoded, TONE_SAMPLES));
+}
+
+static void test_codec_names(void)
+{
+    unsigned int codec;
+    MY_ASSERT(audio_codec_from_name("adpcm", &codec));
+    MY_ASSERT(AUDIO_CODEC_IMA_ADPCM == codec);
+    MY_ASSERT(audio_codec_from_name("pcm", &codec));
+    MY_ASSERT(AUDIO_CODEC_PCM16 == codec);
+    MY_ASSERT(!audio_codec_from_name("mp3", &codec));
+    MY_ASSERT(NULL == audio_codec_get_name(AUDIO_CODEC_IMA_ADPCM + 1));
+}
+
+/*!
+ * @brief Returns the power of the given frequency in the signal, using the Goertzel algorithm.
+ */
+static double goertzel(float const * p_samples, size_t count, double frequency, unsigned int rate)
+{
+    double coefficient = 2.0 * cos(2.0 * 3.14159265358979323846 * frequency / rate);
+    double s1 = 0.0, s2 = 0.0;
+    size_t idx;
+    for (idx = 0; idx < count; ++idx)
+    {
+        double s0 = p_samples[idx] + coefficient * s1 - s2;
+        s2 = s1;
+        s1 = s0;
+    }
+    return (s1 * s1 + s2 * s2 - coefficient * s1 * s2) / ((double)count * count);
+}
+
+static void test_resampler(void)
+{
+    static float input[44100];
+    static float output[8192];
+    struct resampler * p_resampler;
+    size_t idx;
+    size_t produced = 0;
+    double pass, stop;
+    MY_ASSERT(NULL == resampler_create(0, 8000));
+    /* 1 kHz passes, 6 kHz is above the 4 kHz Nyquist frequency of the output and must be removed. */
+    for (idx = 0; idx < COUNTOF_ARRAY(input); ++idx)
+        input[idx] = (float)(0.5 * sin(2.0 * 3.14159265358979323846 * 1000.0 * idx / 44100)
+                + 0.5 * sin(2.0 * 3.14159265358979323846 * 6000.0 * idx / 44100));
+    p_resampler = resampler_create(44100, 8000);
+    MY_ASSERT(NULL != p_resampler);
+    /* Feed it in uneven pieces, as the datagrams would. */
+    for (idx = 0; idx < COUNTOF_ARRAY(input); idx += 441)
+    {
+        size_t count = min((size_t)441, COUNTOF_ARRAY(input) - idx);
+        MY_ASSERT(resampler_get_output_size(p_resampler, count) <= COUNTOF_ARRAY(output) - produced);
+        produced += resampler_process(p_resampler, &input[idx], count, &output[produced], COUNTOF_ARRAY(output) - produced);
+    }
+    MY_ASSERT(produced >= 7990 && produced <= 8000);
+    /* Skip the filter's settling time. */
+    pass = goertzel(&output[1000], 4000, 1000.0, 8000);
+    stop = goertzel(&output[1000], 4000, 2000.0, 8000);
+    MY_ASSERT(pass > 0.04);
+    /* 6 kHz would alias to 2 kHz. */
+    MY_ASSERT(stop * 1000.0 < pass);
+    resampler_destroy(p_resampler);
+}
+
+static void add_one(void * p_argument)
+{
+    __sync_fetch_and_add((int *)p_argument, 1);
+}
+
+static void test_thread_pool(void)
+{
+    int counter = 0;
+    unsigned int threads;
+    unsigned int idx;
+    for (threads = 0; threads <= 4; threads += 4)
+    {
+        struct thread_pool * p_pool = thread_pool_create(threads);
+        MY_ASSERT(NULL != p_pool);
+        counter = 0;
+        /* More tasks than the queue holds, so that the submit has to wait. */
+        for (idx = 0; idx < 2 * THREAD_POOL_MAX_TASKS + 1; ++idx)
+            MY_ASSERT(thread_pool_submit(p_pool, &add_one, &counter));
+        thread_pool_wait(p_pool);
+        MY_ASSERT(2 * THREAD_POOL_MAX_TASKS + 1 == counter);
+        thread_pool_destroy(p_pool);
+    }
+    MY_ASSERT(NULL == thread_pool_create(THREAD_POOL_MAX_THREADS + 1));
+}
+
+static void test_parse_output(void)
+{
+    struct mcast_transcoder_output output;
+    MY_ASSERT(mcast_transcoder_parse_output(&output, "239.1.0.1:25000:8000:ulaw"));
+    MY_ASSERT(8000 == output.rate_);
+    MY_ASSERT(AUDIO_CODEC_ULAW == output.codec_);
+    MY_ASSERT(1 == output.settings_.nTTL_);
+    MY_ASSERT(25000 == mcast_settings_get_port(&output.settings_));
+    MY_ASSERT(mcast_transcoder_parse_output(&output, "239.1.0.2:25002:16000:adpcm:16"));
+    MY_ASSERT(16 == output.settings_.nTTL_);
+    MY_ASSERT(AUDIO_CODEC_IMA_ADPCM == output.codec_);
+    MY_ASSERT(!mcast_transcoder_parse_output(&output, "239.1.0.1:25000:8000"));
+    MY_ASSERT(!mcast_transcoder_parse_output(&output, "239.1.0.1:25000:8000:gsm"));
+    MY_ASSERT(!mcast_transcoder_parse_output(&output, "10.0.0.1:25000:8000:ulaw"));
+    MY_ASSERT(!mcast_transcoder_parse_output(&output, "239.1.0.1:25000:0:ulaw"));
+    /* IPv6 groups go in brackets. */
+    MY_ASSERT(mcast_transcoder_parse_output(&output, "[ff12::1]:25004:8000:alaw:4"));
+    MY_ASSERT(AF_INET6 == output.settings_.mcast_addr_.ss_family);
+    MY_ASSERT(25004 == mcast_settings_get_port(&output.settings_));
+    MY_ASSERT(4 == output.settings_.nTTL_);
+    MY_ASSERT(!mcast_transcoder_parse_output(&output, "[ff12::1:25004:8000:alaw"));
+    MY_ASSERT(!mcast_transcoder_parse_output(&output, "ff12::1:25004:8000:alaw"));
+    MY_ASSERT(!mcast_transcoder_parse_output(&output, "[2001:db8::1]:25004:8000:alaw"));
+}
+
+static void test_output_is_input(void)
+{
+    struct mcast_transcoder_config config;
+    ZeroMemory(&config, sizeof(config));
+    config.input_rate_ = 16000;
+    config.input_channels_ = 1;
+    config.outputs_count_ = 2;
+    MY_ASSERT(mcast_settings_set_group(&config.input_, "239.0.0.1", 25000));
+    MY_ASSERT(mcast_transcoder_parse_output(&config.outputs_[0], "239.1.0.1:25000:8000:ulaw"));
+    MY_ASSERT(mcast_transcoder_parse_output(&config.outputs_[1], "239.0.0.1:25000:8000:alaw"));
+    MY_ASSERT(NULL == mcast_transcoder_create(&config));
+}
+
+/*!
+ * @brief The output packets carry the output rate, so that the receivers play them out at the right speed.
+ * @details The output is sent to a port of this host rather than to a group, so that it is received although the
+ * outputs do not loop back.
+ */
+static void test_output_format(void)
+{
+    struct mcast_transcoder_config config;
+    struct mcast_transcoder * p_transcoder;
+    struct mcast_packet_header header;
+    struct sockaddr_in address;
+    struct timeval timeout = { 2, 0 };
+    static int16_t input[320];
+    uint8_t packet[2048];
+    uint32_t sample_rate = 0;
+    unsigned int channels = 0;
+    uint64_t send_time = 0;
+    ssize_t received;
+    size_t offset;
+    SOCKET s;
+    make_tone(input, COUNTOF_ARRAY(input), 1000.0, 16000, 8000.0);
+    s = socket(AF_INET, SOCK_DGRAM, 0);
+    MY_ASSERT(INVALID_SOCKET != s);
+    ZeroMemory(&address, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    MY_ASSERT(0 == bind(s, (struct sockaddr *)&address, sizeof(address)));
+    MY_ASSERT(0 == setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)));
+    {
+        socklen_t address_size = sizeof(address);
+        MY_ASSERT(0 == getsockname(s, (struct sockaddr *)&address, &address_size));
+    }
+    ZeroMemory(&config, sizeof(config));
+    config.input_rate_ = 16000;
+    config.input_channels_ = 1;
+    config.outputs_count_ = 1;
+    MY_ASSERT(mcast_settings_set_group(&config.input_, "239.0.0.1", 25992));
+    config.outputs_[0].rate_ = 8000;
+    config.outputs_[0].codec_ = AUDIO_CODEC_ULAW;
+    config.outputs_[0].settings_.nTTL_ = 1;
+    MY_ASSERT(mcast_settings_set_group(&config.outputs_[0].settings_, "127.0.0.1", ntohs(address.sin_port)));
+    p_transcoder = mcast_transcoder_create(&config);
+    if (NULL == p_transcoder)
+    {
+        fprintf(stderr, "%s %u : no multicast capable interface, skipped\n", __FILE__, __LINE__);
+        closesocket(s);
+        return;
+    }
+    MY_ASSERT(mcast_transcoder_process(p_transcoder, (uint8_t const *)input, sizeof(input)));
+    received = recv(s, packet, sizeof(packet), 0);
+    MY_ASSERT(received > 0);
+    offset = mcast_packet_header_decode(&header, packet, (size_t)received);
+    MY_ASSERT(0 != offset && AUDIO_CODEC_ULAW == (header.flags_ & MCAST_PACKET_FLAGS_CODEC_MASK));
+    MY_ASSERT(mcast_packet_header_get_format(&header, packet, &sample_rate, &channels));
+    MY_ASSERT(8000 == sample_rate && 1 == channels);
+    MY_ASSERT(mcast_packet_header_get_send_time(&header, packet, &send_time) && 0 != send_time);
+    /* Half the input rate, one byte per sample. */
+    MY_ASSERT(offset + COUNTOF_ARRAY(input) / 2 == (size_t)received);
+    mcast_transcoder_destroy(p_transcoder);
+    closesocket(s);
+}
+
+int main(int argc, char ** argv)
+{
+    test_g711_round_trip();
+    test_adpcm_round_trip();
+    test_sample_conversions();
+    test_block_conversions();
+    test_codec_names();
+    test_resampler();
+    test_thread_pool();
+    test_parse_output();
+    test_output_is_input();
+    test_output_format();
+    return 0;
+}
@@ -0,0 +1,330 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file ut-wave-reader.c
+ * @brief Unit test for the WAV reader.
+ * @details Covers extra chunks before the data, all the file source strategies, reads across the buffers, seeking, truncated and malformed files.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include "wave-reader.h"
+#include "wave_utils.h"
+
+#define MY_ASSERT(cond) do { if(!(cond)) fprintf(stderr, "%s %u\n", __FILE__, __LINE__), abort(); } while(0)
+
+#define WAVE_PATH "ut-wave-reader.wav"
+
+/*!
+ * @brief Number of frames of the test file, more than fits into the buffers of the file source.
+ */
+#define FRAMES_COUNT (100003)
+
+static size_t put_le16(uint8_t * p_bytes, uint16_t value)
+{
+    p_bytes[0] = (uint8_t)value;
+    p_bytes[1] = (uint8_t)(value >> 8);
+    return 2;
+}
+
+static size_t put_le32(uint8_t * p_bytes, uint32_t value)
+{
+    put_le16(p_bytes, (uint16_t)value);
+    put_le16(p_bytes + 2, (uint16_t)(value >> 16));
+    return 4;
+}
+
+static size_t put_chunk(uint8_t * p_bytes, char const * psz_id, void const * p_data, uint32_t size)
+{
+    memcpy(p_bytes, psz_id, 4);
+    put_le32(p_bytes + 4, size);
+    memcpy(p_bytes + 8, p_data, size);
+    if (size & 1)
+        p_bytes[8 + size++] = 0;
+    return 8 + size;
+}
+
+/*!
+ * @brief Builds a 16 bit stereo file, with LIST, fact and odd sized cue chunks between the format and the data.
+ * @details Left channel of the frame N is N, right channel is ~N.
+ */
+static uint8_t * make_wave(size_t * p_size, uint32_t declared_data_size)
+{
+    uint8_t format[16];
+    size_t offset = 0;
+    size_t idx;
+    uint8_t * p_bytes = (uint8_t *)malloc(1024 + 4 * FRAMES_COUNT);
+    MY_ASSERT(NULL != p_bytes);
+    put_le16(&format[0], 1);
+    put_le16(&format[2], 2);
+    put_le32(&format[4], 16000);
+    put_le32(&format[8], 16000 * 4);
+    put_le16(&format[12], 4);
+    put_le16(&format[14], 16);
+    memcpy(p_bytes, "RIFF", 4);
+    memcpy(p_bytes + 8, "WAVE", 4);
+    offset = 12;
+    offset += put_chunk(p_bytes + offset, "fmt ", format, sizeof(format));
+    offset += put_chunk(p_bytes + offset, "LIST", "INFOISFT\x06\x00\x00\x00mcast\x00", 18);
+    offset += put_chunk(p_bytes + offset, "fact", "\x01\x02\x03\x04", 4);
+    offset += put_chunk(p_bytes + offset, "cue ", "odd", 3);
+    memcpy(p_bytes + offset, "data", 4);
+    put_le32(p_bytes + offset + 4, declared_data_size);
+    offset += 8;
+    for (idx = 0; idx < FRAMES_COUNT; ++idx)
+    {
+        offset += put_le16(p_bytes + offset, (uint16_t)idx);
+        offset += put_le16(p_bytes + offset, (uint16_t)~idx);
+    }
+    put_le32(p_bytes + 4, (uint32_t)(offset - 8));
+    *p_size = offset;
+    return p_bytes;
+}
+
+/*!
+ * @brief Builds a file with the given format and data in the buffer, then opens it.
+ * @details The format is 40 bytes long when extensible, i.e. when the sub format is not 0.
+ */
+static struct wave_reader * open_format(uint8_t * p_bytes, uint16_t tag, uint16_t channels, uint16_t bits, uint16_t valid_bits,
+        uint16_t sub_format, void const * p_data, uint32_t data_size)
+{
+    static uint8_t const guid_tail[14] = { 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xaa, 0x00, 0x38, 0x9b, 0x71 };
+    uint8_t format[40];
+    uint16_t const block_align = channels * (bits / 8);
+    size_t offset = 12;
+    put_le16(&format[0], tag);
+    put_le16(&format[2], channels);
+    put_le32(&format[4], 48000);
+    put_le32(&format[8], 48000 * block_align);
+    put_le16(&format[12], block_align);
+    put_le16(&format[14], bits);
+    put_le16(&format[16], 22);
+    put_le16(&format[18], valid_bits);
+    put_le32(&format[20], 3);
+    put_le16(&format[24], sub_format);
+    memcpy(&format[26], guid_tail, sizeof(guid_tail));
+    memcpy(p_bytes, "RIFFxxxxWAVE", 12);
+    offset += put_chunk(p_bytes + offset, "fmt ", format, 0 != sub_format ? 40 : 16);
+    offset += put_chunk(p_bytes + offset, "data", p_data, data_size);
+    put_le32(p_bytes + 4, (uint32_t)(offset - 8));
+    return wave_reader_open_memory(p_bytes, offset);
+}
+
+static void test_formats(void)
+{
+    static uint8_t const packed24[] = { 0x00, 0x00, 0x40, 0x00, 0x00, 0xc0, 0xff, 0xff, 0x7f, 0x00, 0x00, 0x80 };
+    static uint8_t const packed8[] = { 0x80, 0xc0, 0x00 };
+    static int32_t const wide32[] = { 0x40000000, -0x40000000 };
+    static float const floats[] = { 0.25f, -0.5f };
+    static double const doubles[] = { 0.125, -0.75 };
+    uint8_t bytes[256];
+    float samples[8];
+    struct wave_reader * p_reader;
+    p_reader = open_format(bytes, WAVE_FORMAT_EXTENSIBLE, 2, 24, 24, WAVE_FORMAT_PCM, packed24, sizeof(packed24));
+    MY_ASSERT(NULL != p_reader);
+    MY_ASSERT(WAVE_FORMAT_PCM == wave_reader_get_format(p_reader)->sub_format_ && 3 == wave_reader_get_format(p_reader)->channel_mask_);
+    MY_ASSERT(2 == wave_reader_get_frames_count(p_reader) && wave_reader_format_is_convertible(wave_reader_get_format(p_reader)));
+    MY_ASSERT(2 == wave_reader_read_float(p_reader, samples, 4));
+    MY_ASSERT(0.5f == samples[0] && -0.5f == samples[1] && samples[2] > 0.9999f && samples[2] < 1.0f && -1.0f == samples[3]);
+    wave_reader_close(p_reader);
+    p_reader = open_format(bytes, WAVE_FORMAT_EXTENSIBLE, 1, 32, 24, WAVE_FORMAT_PCM, wide32, sizeof(wide32));
+    MY_ASSERT(NULL != p_reader && 24 == wave_reader_get_format(p_reader)->valid_bits_per_sample_);
+    MY_ASSERT(2 == wave_reader_read_float(p_reader, samples, 4) && 0.5f == samples[0] && -0.5f == samples[1]);
+    wave_reader_close(p_reader);
+    p_reader = open_format(bytes, WAVE_FORMAT_IEEE_FLOAT, 1, 32, 32, 0, floats, sizeof(floats));
+    MY_ASSERT(NULL != p_reader && WAVE_FORMAT_IEEE_FLOAT == wave_reader_get_format(p_reader)->sub_format_);
+    MY_ASSERT(2 == wave_reader_read_float(p_reader, samples, 4) && 0.25f == samples[0] && -0.5f == samples[1]);
+    wave_reader_close(p_reader);
+    p_reader = open_format(bytes, WAVE_FORMAT_EXTENSIBLE, 2, 64, 64, WAVE_FORMAT_IEEE_FLOAT, doubles, sizeof(doubles));
+    MY_ASSERT(NULL != p_reader && 1 == wave_reader_get_frames_count(p_reader));
+    MY_ASSERT(1 == wave_reader_read_float(p_reader, samples, 4) && 0.125f == samples[0] && -0.75f == samples[1]);
+    wave_reader_close(p_reader);
+    p_reader = open_format(bytes, WAVE_FORMAT_PCM, 1, 8, 8, 0, packed8, sizeof(packed8));
+    MY_ASSERT(NULL != p_reader);
+    MY_ASSERT(3 == wave_reader_read_float(p_reader, samples, 4) && 0.0f == samples[0] && 0.5f == samples[1] && -1.0f == samples[2]);
+    wave_reader_close(p_reader);
+    /* Formats that are read, but not converted. */
+    p_reader = open_format(bytes, 0x0002, 1, 8, 8, 0, packed8, sizeof(packed8));
+    MY_ASSERT(NULL != p_reader && !wave_reader_format_is_convertible(wave_reader_get_format(p_reader)));
+    MY_ASSERT(0 == wave_reader_read_float(p_reader, samples, 4) && 0 == wave_reader_tell(p_reader));
+    wave_reader_close(p_reader);
+    /* More valid bits than there are, and a sub format GUID that is not one of the WAVE_FORMAT_* ones. */
+    MY_ASSERT(NULL == open_format(bytes, WAVE_FORMAT_EXTENSIBLE, 2, 24, 32, WAVE_FORMAT_PCM, packed24, sizeof(packed24)));
+    bytes[12 + 8 + 39] = 0;
+    MY_ASSERT(NULL == wave_reader_open_memory(bytes, 12 + 8 + 40 + 8 + sizeof(packed24)));
+}
+
+static void write_file(void const * p_data, size_t size)
+{
+    FILE * fp = fopen(WAVE_PATH, "wb");
+    MY_ASSERT(NULL != fp);
+    MY_ASSERT(size == fwrite(p_data, 1, size, fp));
+    fclose(fp);
+}
+
+static int check_frames(int16_t const * p_frames, size_t first, size_t count)
+{
+    size_t idx;
+    for (idx = 0; idx < count; ++idx)
+    {
+        if (p_frames[2*idx] != (int16_t)(first + idx) || p_frames[2*idx + 1] != (int16_t)~(first + idx))
+            return 0;
+    }
+    return 1;
+}
+
+static void test_read(int strategy)
+{
+    static int16_t frames[2 * 1000];
+    struct wave_reader * p_reader = wave_reader_open(WAVE_PATH, strategy);
+    struct wave_reader_format const * p_format;
+    size_t total = 0;
+    size_t count;
+    MY_ASSERT(NULL != p_reader);
+    p_format = wave_reader_get_format(p_reader);
+    MY_ASSERT(1 == p_format->format_tag_ && 2 == p_format->channels_ && 16000 == p_format->sample_rate_);
+    MY_ASSERT(4 == p_format->block_align_ && 16 == p_format->bits_per_sample_);
+    MY_ASSERT(FRAMES_COUNT == wave_reader_get_frames_count(p_reader));
+    MY_ASSERT((FILE_SOURCE_MMAP == strategy || FILE_SOURCE_AUTO == strategy) == (NULL != wave_reader_get_data(p_reader)));
+    /* 1000 frames at a time do not divide the buffers, so some reads straddle two of them. */
+    while (0 != (count = wave_reader_read_frames(p_reader, frames, COUNTOF_ARRAY(frames) / 2)))
+    {
+        MY_ASSERT(check_frames(frames, total, count));
+        total += count;
+        MY_ASSERT(total == wave_reader_tell(p_reader));
+    }
+    MY_ASSERT(FRAMES_COUNT == total);
+    wave_reader_seek(p_reader, 70000);
+    MY_ASSERT(10 == wave_reader_read_frames(p_reader, frames, 10) && check_frames(frames, 70000, 10));
+    wave_reader_seek(p_reader, 5);
+    MY_ASSERT(3 == wave_reader_read_frames(p_reader, frames, 3) && check_frames(frames, 5, 3));
+    wave_reader_seek(p_reader, FRAMES_COUNT + 10);
+    MY_ASSERT(FRAMES_COUNT == wave_reader_tell(p_reader));
+    MY_ASSERT(0 == wave_reader_read_frames(p_reader, frames, 10));
+    wave_reader_close(p_reader);
+}
+
+static void test_next_frames(void)
+{
+    struct wave_reader * p_reader = wave_reader_open(WAVE_PATH, FILE_SOURCE_PREAD);
+    int16_t const * p_frames;
+    size_t total = 0;
+    size_t count;
+    MY_ASSERT(NULL != p_reader);
+    /* A request larger than a buffer is cut to the whole frames in it. */
+    while (NULL != (p_frames = (int16_t const *)wave_reader_next_frames(p_reader, FRAMES_COUNT, &count)))
+    {
+        MY_ASSERT(count > 0 && count <= FILE_SOURCE_BUFFER_SIZE / 4 && check_frames(p_frames, total, count));
+        total += count;
+    }
+    MY_ASSERT(FRAMES_COUNT == total && 0 == count);
+    wave_reader_close(p_reader);
+}
+
+static void test_truncated(void)
+{
+    size_t size;
+    uint8_t * p_bytes = make_wave(&size, 0xffffffff);
+    struct wave_reader * p_reader;
+    /* The data size is far too large and the file ends in the middle of a frame. */
+    write_file(p_bytes, size - 3);
+    p_reader = wave_reader_open(WAVE_PATH, FILE_SOURCE_PREAD);
+    MY_ASSERT(NULL != p_reader && FRAMES_COUNT - 1 == wave_reader_get_frames_count(p_reader));
+    wave_reader_close(p_reader);
+    free(p_bytes);
+    /* Streaming recorders may leave the size at 0. */
+    p_bytes = make_wave(&size, 0);
+    p_reader = wave_reader_open_memory(p_bytes, size);
+    MY_ASSERT(NULL != p_reader && FRAMES_COUNT == wave_reader_get_frames_count(p_reader));
+    wave_reader_close(p_reader);
+    free(p_bytes);
+}
+
+/*!
+ * @brief The header written is read back, and the sizes that do not fit 32 bits are cut to whole frames.
+ */
+static void test_make_header(void)
+{
+    uint8_t bytes[WAVE_READER_HEADER_SIZE + 3 * 2 * sizeof(int16_t)];
+    struct wave_reader * p_reader;
+    struct wave_reader_format const * p_format;
+    ZeroMemory(bytes, sizeof(bytes));
+    MY_ASSERT(3 * 2 * sizeof(int16_t) == wave_reader_make_header(bytes, 48000, 2, 3));
+    p_reader = wave_reader_open_memory(bytes, sizeof(bytes));
+    MY_ASSERT(NULL != p_reader);
+    p_format = wave_reader_get_format(p_reader);
+    MY_ASSERT(WAVE_FORMAT_PCM == p_format->format_tag_ && 2 == p_format->channels_ && 48000 == p_format->sample_rate_);
+    MY_ASSERT(4 == p_format->block_align_ && 16 == p_format->bits_per_sample_ && 48000 * 4 == p_format->byte_rate_);
+    MY_ASSERT(3 == wave_reader_get_frames_count(p_reader) && WAVE_READER_HEADER_SIZE == wave_reader_get_data_offset(p_reader));
+    wave_reader_close(p_reader);
+    MY_ASSERT(0 == wave_reader_make_header(bytes, 8000, 3, 0x100000000ULL) % 6);
+}
+
+static void test_invalid(void)
+{
+    size_t size;
+    uint8_t * p_bytes = make_wave(&size, 4 * FRAMES_COUNT);
+    struct wave_reader * p_reader;
+    MY_ASSERT(NULL == wave_reader_open("ut-wave-reader.missing", FILE_SOURCE_PREAD));
+    MY_ASSERT(NULL == wave_reader_open_memory(p_bytes, 11));
+    /* No data chunk. */
+    MY_ASSERT(NULL == wave_reader_open_memory(p_bytes, 60));
+    /* Block align that does not match the channels and the bits. */
+    p_bytes[12 + 8 + 12] = 3;
+    MY_ASSERT(NULL == wave_reader_open_memory(p_bytes, size));
+    p_bytes[12 + 8 + 12] = 4;
+    /* No channels. */
+    p_bytes[12 + 8 + 2] = 0;
+    MY_ASSERT(NULL == wave_reader_open_memory(p_bytes, size));
+    p_bytes[12 + 8 + 2] = 2;
+    /* A chunk before the data that goes past the end of the file. */
+    put_le32(p_bytes + 12 + 8 + 16 + 4, 0x7fffffff);
+    MY_ASSERT(NULL == wave_reader_open_memory(p_bytes, size));
+    put_le32(p_bytes + 12 + 8 + 16 + 4, 18);
+    memcpy(p_bytes, "RIFX", 4);
+    MY_ASSERT(NULL == wave_reader_open_memory(p_bytes, size));
+    memcpy(p_bytes, "RIFF", 4);
+    p_reader = wave_reader_open_memory(p_bytes, size);
+    MY_ASSERT(NULL != p_reader);
+    MY_ASSERT(check_frames((int16_t const *)wave_reader_get_data(p_reader), 0, FRAMES_COUNT));
+    wave_reader_close(p_reader);
+    free(p_bytes);
+}
+
+int main(int argc, char ** argv)
+{
+    size_t size;
+    uint8_t * p_bytes = make_wave(&size, 4 * FRAMES_COUNT);
+    write_file(p_bytes, size);
+    free(p_bytes);
+    test_read(FILE_SOURCE_AUTO);
+    test_read(FILE_SOURCE_MMAP);
+    test_read(FILE_SOURCE_READAHEAD);
+    test_read(FILE_SOURCE_PREAD);
+    test_next_frames();
+    test_truncated();
+    test_make_header();
+    test_invalid();
+    test_formats();
+    unlink(WAVE_PATH);
+    return 0;
+}
@@ -0,0 +1,373 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+/**
+ * @file wave-reader.c
+ * @brief Streaming reader of WAV files.
+ * @details The chunks are walked with positioned reads, so a file is never cast to a fixed layout.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+
+#include "pcc.h"
+#include "wave-reader.h"
+#include "wave_utils.h"
+#include "audio-codec.h"
+#include "file-source.h"
+#include "debug_helpers.h"
+
+/*!
+ * @brief Size of the chunk header: 4 bytes of the identifier and 4 bytes of the size.
+ */
+#define CHUNK_HEADER_SIZE (8)
+
+/*!
+ * @brief Largest part of the "fmt " chunk that is looked at.
+ */
+#define FORMAT_CHUNK_MAX (40)
+
+/*!
+ * @brief Bytes 2 to 15 of the sub format GUIDs of WAVE_FORMAT_EXTENSIBLE, the first 2 bytes are the format tag.
+ */
+static uint8_t const g_sub_format_base[14] = { 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xaa, 0x00, 0x38, 0x9b, 0x71 };
+
+/*!
+ * @brief The reader.
+ */
+struct wave_reader {
+    struct file_source * p_source_; /*!< The file. */
+    struct wave_reader_format format_; /*!< Format of the samples. */
+    uint64_t file_size_; /*!< Size of the file. */
+    uint64_t data_offset_; /*!< Offset of the first frame in the file. */
+    uint64_t data_size_; /*!< Size of the data, whole frames only. */
+    uint64_t position_; /*!< Offset of the next frame from data_offset_. */
+};
+
+static uint16_t get_le16(uint8_t const * p_bytes)
+{
+    return (uint16_t)(p_bytes[0] | (p_bytes[1] << 8));
+}
+
+static uint32_t get_le32(uint8_t const * p_bytes)
+{
+    return (uint32_t)p_bytes[0] | ((uint32_t)p_bytes[1] << 8) | ((uint32_t)p_bytes[2] << 16) | ((uint32_t)p_bytes[3] << 24);
+}
+
+static void put_le16(uint8_t * p_bytes, uint16_t value)
+{
+    p_bytes[0] = (uint8_t)value;
+    p_bytes[1] = (uint8_t)(value >> 8);
+}
+
+static void put_le32(uint8_t * p_bytes, uint32_t value)
+{
+    put_le16(p_bytes, (uint16_t)value);
+    put_le16(p_bytes + 2, (uint16_t)(value >> 16));
+}
+
+static int parse_format(struct wave_reader * p_reader, uint8_t const * p_chunk, uint32_t chunk_size)
+{
+    struct wave_reader_format * p_format = &p_reader->format_;
+    if (chunk_size < 16)
+        return 0;
+    p_format->format_tag_ = get_le16(&p_chunk[0]);
+    p_format->channels_ = get_le16(&p_chunk[2]);
+    p_format->sample_rate_ = get_le32(&p_chunk[4]);
+    p_format->byte_rate_ = get_le32(&p_chunk[8]);
+    p_format->block_align_ = get_le16(&p_chunk[12]);
+    p_format->bits_per_sample_ = get_le16(&p_chunk[14]);
+    p_format->valid_bits_per_sample_ = p_format->bits_per_sample_;
+    p_format->channel_mask_ = 0;
+    p_format->sub_format_ = p_format->format_tag_;
+    if (0 == p_format->channels_ || 0 == p_format->sample_rate_ || 0 == p_format->block_align_ || 0 == p_format->bits_per_sample_)
+        return 0;
+    if (WAVE_FORMAT_EXTENSIBLE == p_format->format_tag_)
+    {
+        /* WAVEFORMATEX, with cbSize of at least 22, then valid bits, channel mask and the sub format GUID. */
+        if (chunk_size < 40 || get_le16(&p_chunk[16]) < 22 || 0 != memcmp(&p_chunk[26], g_sub_format_base, sizeof(g_sub_format_base)))
+            return 0;
+        p_format->valid_bits_per_sample_ = get_le16(&p_chunk[18]);
+        p_format->channel_mask_ = get_le32(&p_chunk[20]);
+        p_format->sub_format_ = get_le16(&p_chunk[24]);
+        if (0 == p_format->valid_bits_per_sample_ || p_format->valid_bits_per_sample_ > p_format->bits_per_sample_)
+            return 0;
+    }
+    if ((WAVE_FORMAT_PCM == p_format->sub_format_ || WAVE_FORMAT_IEEE_FLOAT == p_format->sub_format_)
+            && p_format->block_align_ != p_format->channels_ * ((p_format->bits_per_sample_ + 7) / 8))
+        return 0;
+    return 1;
+}
+
+/*!
+ * @brief Walks the chunks, fills in the format and finds the data.
+ */
+static int walk_chunks(struct wave_reader * p_reader)
+{
+    uint8_t header[12];
+    uint64_t offset;
+    int has_format = 0;
+    int has_data = 0;
+    if (sizeof(header) != file_source_read(p_reader->p_source_, 0, header, sizeof(header))
+            || 0 != memcmp(&header[0], "RIFF", 4) || 0 != memcmp(&header[8], "WAVE", 4))
+    {
+        debug_log_error(DEBUG_CATEGORY_AUDIO, "%s %4.4u : not a RIFF WAVE file", __FILE__, __LINE__);
+        return 0;
+    }
+    /* The RIFF size is not looked at: it is often wrong in files written by streaming recorders, the file size is the real limit. */
+    for (offset = sizeof(header); offset + CHUNK_HEADER_SIZE <= p_reader->file_size_ && !(has_format && has_data); )
+    {
+        uint8_t chunk[CHUNK_HEADER_SIZE];
+        uint32_t chunk_size;
+        uint64_t available;
+        if (CHUNK_HEADER_SIZE != file_source_read(p_reader->p_source_, offset, chunk, sizeof(chunk)))
+            return 0;
+        chunk_size = get_le32(&chunk[4]);
+        available = p_reader->file_size_ - offset - CHUNK_HEADER_SIZE;
+        if (0 == memcmp(chunk, "data", 4))
+        {
+            uint64_t size = chunk_size;
+            if (size > available || 0 == size)
+            {
+                /* Recorders that stream the data often never come back to fix the size, and may leave it 0. */
+                debug_log_warning(DEBUG_CATEGORY_AUDIO, "%s %4.4u : data chunk of %u bytes cut to %llu", __FILE__, __LINE__,
+                        chunk_size, (unsigned long long)available);
+                size = available;
+            }
+            p_reader->data_offset_ = offset + CHUNK_HEADER_SIZE;
+            p_reader->data_size_ = size;
+            has_data = 1;
+        }
+        else if (chunk_size > available)
+        {
+            debug_log_error(DEBUG_CATEGORY_AUDIO, "%s %4.4u : %.4s chunk of %u bytes past the end of the file", __FILE__, __LINE__,
+                    (char const *)chunk, chunk_size);
+            return 0;
+        }
+        else if (0 == memcmp(chunk, "fmt ", 4))
+        {
+            uint8_t format[FORMAT_CHUNK_MAX];
+            uint32_t size = min(chunk_size, (uint32_t)sizeof(format));
+            if (has_format || size != file_source_read(p_reader->p_source_, offset + CHUNK_HEADER_SIZE, format, size) || !parse_format(p_reader, format, size))
+            {
+                debug_log_error(DEBUG_CATEGORY_AUDIO, "%s %4.4u : bad fmt chunk", __FILE__, __LINE__);
+                return 0;
+            }
+            has_format = 1;
+        }
+        else
+            debug_log_debug(DEBUG_CATEGORY_AUDIO, "%s %4.4u : skipping %.4s chunk of %u bytes", __FILE__, __LINE__, (char const *)chunk, chunk_size);
+        /* The chunks are padded to an even size. */
+        offset += CHUNK_HEADER_SIZE + (uint64_t)chunk_size + (chunk_size & 1);
+    }
+    if (!has_format || !has_data)
+    {
+        debug_log_error(DEBUG_CATEGORY_AUDIO, "%s %4.4u : fmt:%d data:%d", __FILE__, __LINE__, has_format, has_data);
+        return 0;
+    }
+    p_reader->data_size_ -= p_reader->data_size_ % p_reader->format_.block_align_;
+    return 1;
+}
+
+static struct wave_reader * reader_create(struct file_source * p_source)
+{
+    struct wave_reader * p_reader;
+    if (NULL == p_source)
+        return NULL;
+    p_reader = (struct wave_reader *)calloc(1, sizeof(struct wave_reader));
+    if (NULL == p_reader)
+    {
+        file_source_close(p_source);
+        return NULL;
+    }
+    p_reader->p_source_ = p_source;
+    p_reader->file_size_ = file_source_get_size(p_source);
+    if (!walk_chunks(p_reader))
+    {
+        wave_reader_close(p_reader);
+        return NULL;
+    }
+    return p_reader;
+}
+
+struct wave_reader * wave_reader_open(char const * psz_path, int strategy)
+{
+    return reader_create(file_source_open(psz_path, strategy));
+}
+
+struct wave_reader * wave_reader_open_memory(void const * p_data, size_t data_size)
+{
+    return reader_create(file_source_open_memory(p_data, data_size));
+}
+
+void wave_reader_close(struct wave_reader * p_reader)
+{
+    if (NULL != p_reader)
+    {
+        file_source_close(p_reader->p_source_);
+        free(p_reader);
+    }
+}
+
+struct wave_reader_format const * wave_reader_get_format(struct wave_reader const * p_reader)
+{
+    return &p_reader->format_;
+}
+
+uint64_t wave_reader_get_frames_count(struct wave_reader const * p_reader)
+{
+    return p_reader->data_size_ / p_reader->format_.block_align_;
+}
+
+void const * wave_reader_get_data(struct wave_reader const * p_reader)
+{
+    uint8_t const * p_map = (uint8_t const *)file_source_get_mapping(p_reader->p_source_);
+    return NULL != p_map ? &p_map[p_reader->data_offset_] : NULL;
+}
+
+uint64_t wave_reader_get_data_offset(struct wave_reader const * p_reader)
+{
+    return p_reader->data_offset_;
+}
+
+void const * wave_reader_next_frames(struct wave_reader * p_reader, size_t max_frames, size_t * p_frames)
+{
+    uint64_t const block_align = p_reader->format_.block_align_;
+    uint64_t frames = min((uint64_t)max_frames, (p_reader->data_size_ - p_reader->position_) / block_align);
+    size_t size = 0;
+    void const * p_result = NULL;
+    if (0 != frames)
+    {
+        p_result = file_source_get(p_reader->p_source_, p_reader->data_offset_ + p_reader->position_,
+                (size_t)min(frames * block_align, (uint64_t)SIZE_MAX), &size);
+        /* The source hands out less only at the end of the file or of its buffer, whole frames are taken. */
+        frames = size / block_align;
+    }
+    p_reader->position_ += frames * block_align;
+    *p_frames = (size_t)frames;
+    return 0 == frames ? NULL : p_result;
+}
+
+size_t wave_reader_read_frames(struct wave_reader * p_reader, void * p_buffer, size_t max_frames)
+{
+    size_t const block_align = p_reader->format_.block_align_;
+    size_t done = 0;
+    while (done < max_frames)
+    {
+        size_t frames;
+        void const * p_frames = wave_reader_next_frames(p_reader, max_frames - done, &frames);
+        if (NULL == p_frames)
+            break;
+        CopyMemory((uint8_t *)p_buffer + done * block_align, p_frames, frames * block_align);
+        done += frames;
+    }
+    return done;
+}
+
+int wave_reader_format_is_convertible(struct wave_reader_format const * p_format)
+{
+    unsigned int const sample_size = p_format->block_align_ / p_format->channels_;
+    switch (p_format->sub_format_)
+    {
+        case WAVE_FORMAT_PCM:
+            return sample_size >= 1 && sample_size <= 4;
+        case WAVE_FORMAT_IEEE_FLOAT:
+            return 4 == sample_size || 8 == sample_size;
+        default:
+            return 0;
+    }
+}
+
+size_t wave_reader_read_float(struct wave_reader * p_reader, float * p_samples, size_t max_frames)
+{
+    struct wave_reader_format const * p_format = &p_reader->format_;
+    unsigned int const sample_size = p_format->block_align_ / p_format->channels_;
+    size_t done = 0;
+    if (!wave_reader_format_is_convertible(p_format))
+        return 0;
+    while (done < max_frames)
+    {
+        size_t frames;
+        size_t idx;
+        size_t samples_count;
+        float * p_output = &p_samples[done * p_format->channels_];
+        void const * p_frames = wave_reader_next_frames(p_reader, max_frames - done, &frames);
+        if (NULL == p_frames)
+            break;
+        samples_count = frames * p_format->channels_;
+        /* The container size decides, e.g. 20 valid bits in 3 bytes are converted as 24-bit samples. */
+        switch (WAVE_FORMAT_PCM == p_format->sub_format_ ? sample_size : 0x10 | sample_size)
+        {
+            case 1:
+                for (idx = 0; idx < samples_count; ++idx)
+                    p_output[idx] = (float)((int)((uint8_t const *)p_frames)[idx] - 128) * (1.0f / 128.0f);
+                break;
+            case 2:
+                audio_codec_int16_to_float((int16_t const *)p_frames, p_output, samples_count);
+                break;
+            case 3:
+                audio_codec_int24_to_float((uint8_t const *)p_frames, p_output, samples_count);
+                break;
+            case 4:
+                audio_codec_int32_to_float((int32_t const *)p_frames, p_output, samples_count);
+                break;
+            case 0x14:
+                CopyMemory(p_output, p_frames, samples_count * sizeof(float));
+                break;
+            case 0x18:
+                for (idx = 0; idx < samples_count; ++idx)
+                    p_output[idx] = (float)((double const *)p_frames)[idx];
+                break;
+        }
+        done += frames;
+    }
+    return done;
+}
+
+void wave_reader_seek(struct wave_reader * p_reader, uint64_t frame)
+{
+    p_reader->position_ = min(frame, wave_reader_get_frames_count(p_reader)) * p_reader->format_.block_align_;
+}
+
+uint64_t wave_reader_tell(struct wave_reader const * p_reader)
+{
+    return p_reader->position_ / p_reader->format_.block_align_;
+}
+
+uint32_t wave_reader_make_header(void * p_header, uint32_t sample_rate, unsigned int channels, uint64_t frames)
+{
+    uint8_t * p_bytes = (uint8_t *)p_header;
+    uint32_t const block_align = channels * sizeof(int16_t);
+    uint64_t data_size = frames * block_align;
+    if (data_size > UINT32_MAX - WAVE_READER_HEADER_SIZE)
+        data_size = (UINT32_MAX - WAVE_READER_HEADER_SIZE) / block_align * block_align;
+    memcpy(&p_bytes[0], "RIFF", 4);
+    put_le32(&p_bytes[4], (uint32_t)(WAVE_READER_HEADER_SIZE - 8 + data_size));
+    memcpy(&p_bytes[8], "WAVEfmt ", 8);
+    put_le32(&p_bytes[16], 16);
+    put_le16(&p_bytes[20], WAVE_FORMAT_PCM);
+    put_le16(&p_bytes[22], (uint16_t)channels);
+    put_le32(&p_bytes[24], sample_rate);
+    put_le32(&p_bytes[28], sample_rate * block_align);
+    put_le16(&p_bytes[32], (uint16_t)block_align);
+    put_le16(&p_bytes[34], 16);
+    memcpy(&p_bytes[36], "data", 4);
+    put_le32(&p_bytes[40], (uint32_t)data_size);
+    return (uint32_t)data_size;
+}
@@ -0,0 +1,182 @@
+/* ex: set shiftwidth=4 tabstop=4 expandtab: */
+
+/**
+ * @file wave-reader.h
+ * @brief Streaming reader of WAV files.
+ * @details Walks the RIFF chunks, validates the format and hands out the sample frames through a file source, i.e. either from a mapping of the file or from read buffers.
+ * @par License
+ * @code Copyright 2012 Tomasz Ostaszewski. All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *	2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * 	and/or other materials provided with the distribution.
+ * THIS SOFTWARE IS PROVIDED BY Tomasz Ostaszewski AS IS AND ANY 
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL Tomasz Ostaszewski OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+ * SUCH DAMAGE.
+ * The views and conclusions contained in the software and documentation are those of the 
+ * authors and should not be interpreted as representing official policies, 
+ * either expressed or implied, of Tomasz Ostaszewski.
+ * @endcode
+ * @date 19-Oct-2026
+ */
+#if !defined WAVE_READER_H_2C6E9A41_D35B_4F07_8E1A_B49F06C7D823
+#define WAVE_READER_H_2C6E9A41_D35B_4F07_8E1A_B49F06C7D823
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+#include "std-int.h"
+#include <stddef.h>
+#include "file-source.h"
+
+/*!
+ * @brief Format of the samples, as given by the "fmt " chunk.
+ */
+struct wave_reader_format {
+    uint16_t format_tag_; /*!< WAVE_FORMAT_PCM, WAVE_FORMAT_IEEE_FLOAT, WAVE_FORMAT_EXTENSIBLE, etc. */
+    uint16_t channels_; /*!< Number of interleaved channels. */
+    uint32_t sample_rate_; /*!< Frames per second. */
+    uint32_t byte_rate_; /*!< Bytes per second, as written in the file. */
+    uint16_t block_align_; /*!< Size of a single frame, i.e. of one sample of each channel, in bytes. */
+    uint16_t bits_per_sample_; /*!< Size of a single sample, in bits. */
+    uint16_t valid_bits_per_sample_; /*!< Number of significant bits of each sample, the rest are 0. Same as bits_per_sample_ unless given by WAVE_FORMAT_EXTENSIBLE. */
+    uint32_t channel_mask_; /*!< Speaker positions of the channels, 0 unless given by WAVE_FORMAT_EXTENSIBLE. */
+    uint16_t sub_format_; /*!< Format of the samples: format_tag_, or the tag from the sub format GUID of WAVE_FORMAT_EXTENSIBLE. */
+};
+
+/*!
+ * @brief Size of the header of the canonical WAV file, i.e. of the RIFF, fmt and data chunk headers.
+ */
+#define WAVE_READER_HEADER_SIZE (44)
+
+/*!
+ * @brief Forward declaration.
+ */
+struct wave_reader;
+
+/*!
+ * @brief Opens the WAV file and walks its chunks up to the "data" chunk.
+ * @details The chunks other than "fmt " and "data", e.g. LIST, fact or cue, are skipped. A "data" chunk that
+ * claims more bytes than the file has, as written by a recorder that was killed, is cut to the end of the file.
+ * @param[in] psz_path path of the file.
+ * @param[in] strategy how the file is read, one of the FILE_SOURCE_* strategies.
+ * @return returns a handle to the reader, or NULL if the file cannot be read or is not a valid WAV file.
+ * @sa wave_reader_close
+ */
+struct wave_reader * wave_reader_open(char const * psz_path, int strategy);
+
+/*!
+ * @brief Walks the chunks of a WAV file that is already in the memory, e.g. a resource.
+ * @param[in] p_data the file. Must stay valid until the reader is closed.
+ * @param[in] data_size size of the file.
+ * @return returns a handle to the reader, or NULL if the memory does not hold a valid WAV file.
+ */
+struct wave_reader * wave_reader_open_memory(void const * p_data, size_t data_size);
+
+/*!
+ * @brief Closes the reader.
+ * @param[in] p_reader a handle to the reader obtained via call to wave_reader_open or wave_reader_open_memory.
+ */
+void wave_reader_close(struct wave_reader * p_reader);
+
+/*!
+ * @brief Returns the format of the samples.
+ * @param[in] p_reader a handle to the reader.
+ */
+struct wave_reader_format const * wave_reader_get_format(struct wave_reader const * p_reader);
+
+/*!
+ * @brief Returns number of frames in the "data" chunk. A partial frame at the end is not counted.
+ * @param[in] p_reader a handle to the reader.
+ */
+uint64_t wave_reader_get_frames_count(struct wave_reader const * p_reader);
+
+/*!
+ * @brief Returns the whole "data" chunk.
+ * @param[in] p_reader a handle to the reader.
+ * @return returns a pointer to the first frame, or NULL unless the file is read with the FILE_SOURCE_MMAP strategy.
+ */
+void const * wave_reader_get_data(struct wave_reader const * p_reader);
+
+/*!
+ * @brief Returns offset of the first frame in the file.
+ * @param[in] p_reader a handle to the reader.
+ */
+uint64_t wave_reader_get_data_offset(struct wave_reader const * p_reader);
+
+/*!
+ * @brief Returns the next frames, without copying them if possible.
+ * @details Fewer than max_frames frames are returned only at the end of the data, or if max_frames frames do not
+ * fit into a single buffer of the file source.
+ * @param[in] p_reader a handle to the reader.
+ * @param[in] max_frames maximum number of frames to return.
+ * @param[out] p_frames this will be written with the number of frames returned, 0 at the end of the data.
+ * @return returns a pointer to the frames, valid until the next call on the reader, or NULL at the end of the data.
+ */
+void const * wave_reader_next_frames(struct wave_reader * p_reader, size_t max_frames, size_t * p_frames);
+
+/*!
+ * @brief Copies the next frames.
+ * @param[in] p_reader a handle to the reader.
+ * @param[out] p_buffer this buffer will be written with the frames.
+ * @param[in] max_frames number of frames that fit into the buffer.
+ * @return returns number of frames copied, fewer than max_frames only at the end of the data.
+ */
+size_t wave_reader_read_frames(struct wave_reader * p_reader, void * p_buffer, size_t max_frames);
+
+/*!
+ * @brief Converts the next frames to floats in the [-1, 1) range.
+ * @details 8, 16, 24 and 32-bit PCM as well as 32 and 64-bit float samples are converted, in the plain and in
+ * the WAVE_FORMAT_EXTENSIBLE form.
+ * @param[in] p_reader a handle to the reader.
+ * @param[out] p_samples this buffer will be written with the samples, channels interleaved.
+ * @param[in] max_frames number of frames that fit into the buffer.
+ * @return returns number of frames converted, fewer than max_frames only at the end of the data. Returns 0 if
+ * the samples cannot be converted.
+ */
+size_t wave_reader_read_float(struct wave_reader * p_reader, float * p_samples, size_t max_frames);
+
+/*!
+ * @brief Tells if the samples can be converted by wave_reader_read_float.
+ * @param[in] p_format format of the samples.
+ * @return returns non-zero if the samples can be converted, 0 otherwise.
+ */
+int wave_reader_format_is_convertible(struct wave_reader_format const * p_format);
+
+/*!
+ * @brief Moves to the given frame.
+ * @param[in] p_reader a handle to the reader.
+ * @param[in] frame index of the frame, past the end moves to the end.
+ */
+void wave_reader_seek(struct wave_reader * p_reader, uint64_t frame);
+
+/*!
+ * @brief Returns index of the frame that is returned next.
+ * @param[in] p_reader a handle to the reader.
+ */
+uint64_t wave_reader_tell(struct wave_reader const * p_reader);
+
+/*!
+ * @brief Writes the header of the canonical WAV file of 16 bit PCM samples, which the data follows right away.
+ * @details The sizes written are cut to the whole frames that fit the 32 bit chunk sizes.
+ * @param[out] p_header the header, WAVE_READER_HEADER_SIZE bytes.
+ * @param[in] sample_rate frames per second.
+ * @param[in] channels number of interleaved channels.
+ * @param[in] frames number of frames of the data.
+ * @return returns the size of the data, as written in the header.
+ */
+uint32_t wave_reader_make_header(void * p_header, uint32_t sample_rate, unsigned int channels, uint64_t frames);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* WAVE_READER_H_2C6E9A41_D35B_4F07_8E1A_B49F06C7D823 */
@@ -30,6 +30,7 @@
 
 #include "pcc.h"
 #include "wave_utils.h"
+#include "wave-reader.h"
 #include "debug_helpers.h"
 
 typedef struct wavinoutcaps_dwFormat_2_textDescription {
@@ -185,26 +186,29 @@ int LoadWavFromResoure(P_MASTER_RIFF_CONST * pp_chunk, HINSTANCE hModule, LPCTST
 
 int16_t const * get_wave_data(P_MASTER_RIFF_CONST p_master_riff)
 {
-    switch (p_master_riff->format_chunk_2_.wFormatTag_)
+    /* The chunks are walked, so that a LIST, fact or cue chunk before the data does not get in the way. */
+    struct wave_reader * p_reader = wave_reader_open_memory(p_master_riff, p_master_riff->cksize_ + 8);
+    int16_t const * p_result = NULL;
+    if (NULL != p_reader)
     {
-        case WAVE_FORMAT_PCM:
-            return &p_master_riff->format_chunk_2_.plain_wav_.subchunk_.samples16_[0];
-            break;
-        default:
-            return NULL;
+        if (WAVE_FORMAT_PCM == wave_reader_get_format(p_reader)->format_tag_)
+            p_result = (int16_t const *)wave_reader_get_data(p_reader);
+        wave_reader_close(p_reader);
     }
+    return p_result;
 }
 
 uint32_t get_wave_data_size(P_MASTER_RIFF_CONST p_master_riff)
 {
-    switch (p_master_riff->format_chunk_2_.wFormatTag_)
+    struct wave_reader * p_reader = wave_reader_open_memory(p_master_riff, p_master_riff->cksize_ + 8);
+    uint32_t result = 0;
+    if (NULL != p_reader)
     {
-        case WAVE_FORMAT_PCM:
-            return p_master_riff->format_chunk_2_.plain_wav_.subchunk_.subchunk_size_;
-            break;
-        default:
-            return 0;
+        if (WAVE_FORMAT_PCM == wave_reader_get_format(p_reader)->format_tag_)
+            result = (uint32_t)(wave_reader_get_frames_count(p_reader) * wave_reader_get_format(p_reader)->block_align_);
+        wave_reader_close(p_reader);
     }
+    return result;
 }
 
 void get_waveformat(P_MASTER_RIFF_CONST p_master_riff, WAVEFORMAT * p_output)
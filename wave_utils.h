@@ -262,6 +262,16 @@ typedef WAVEFORMAT FAR  *LPWAVEFORMAT;
 
 #endif /* WAVE_FORMAT_PCM */
 
+#if !defined WAVE_FORMAT_IEEE_FLOAT
+/*! 32 or 64 bit IEEE floating point samples. */
+#define WAVE_FORMAT_IEEE_FLOAT 0x0003
+#endif /* WAVE_FORMAT_IEEE_FLOAT */
+
+#if !defined WAVE_FORMAT_EXTENSIBLE
+/*! The actual format is given by the sub format GUID of the WAVEFORMATEXTENSIBLE structure. */
+#define WAVE_FORMAT_EXTENSIBLE 0xFFFE
+#endif /* WAVE_FORMAT_EXTENSIBLE */
+
 /*!
  * @brief A sub-chunk header
  * @details This is the last header, what follows is data. 